@@ -50,6 +50,10 @@ int main(int argc, char** argv)
     OptionParser opt(app, oskar_version_string(), oskar_app_settings(app));
     opt.add_settings_options();
     opt.add_flag("-q", "Suppress printing.", false, "--quiet");
+    opt.add_flag("--dry-run", "Estimate the run time and exit "
+            "without running the simulation.");
+    opt.add_flag("--estimate", "Estimate the run time before running "
+            "the simulation, and compare it with the measured times.");
     if (!opt.check_options(argc, argv)) return EXIT_FAILURE;
     const char* settings = opt.get_arg(0);
     int status = 0;
@@ -132,13 +136,20 @@ int main(int argc, char** argv)
     oskar_sky_free(sky, &status);
     oskar_telescope_free(tel, &status);
 
-    // Run simulation.
+    // Run simulation, estimating the run time first if required.
+    const bool dry_run = opt.is_set("--dry-run");
     oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
     oskar_timer_resume(tmr);
-    oskar_interferometer_run(sim, &status);
+    if (sim && (dry_run || opt.is_set("--estimate")))
+        oskar_interferometer_estimate_run_time(sim, &status);
+    if (!dry_run)
+        oskar_interferometer_run(sim, &status);
 
     // Check for errors.
-    if (!status)
+    if (!status && dry_run)
+        oskar_log_message(log, 'M', 0, "Dry run completed in %.3f sec.",
+                oskar_timer_elapsed(tmr));
+    else if (!status)
         oskar_log_message(log, 'M', 0, "Run completed in %.3f sec.",
                 oskar_timer_elapsed(tmr));
     else
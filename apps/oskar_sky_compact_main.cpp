@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "apps/oskar_option_parser.h"
+#include "log/oskar_log.h"
+#include "math/oskar_cmath.h"
+#include "sky/oskar_sky.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_version_string.h"
+
+#include <cstdio>
+#include <string>
+
+#define C_0 299792458.0
+#define R2D (180.0 / M_PI)
+
+static double max_baseline_length(const char* dir, int* status)
+{
+    double max_length = 0.0;
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU, 0,
+            status);
+    oskar_telescope_load(tel, dir, 0, status);
+    const int num_stations = oskar_telescope_num_stations(tel);
+    const double* x = oskar_mem_double_const(
+            oskar_telescope_station_true_x_offset_ecef_metres_const(tel),
+            status);
+    const double* y = oskar_mem_double_const(
+            oskar_telescope_station_true_y_offset_ecef_metres_const(tel),
+            status);
+    const double* z = oskar_mem_double_const(
+            oskar_telescope_station_true_z_offset_ecef_metres_const(tel),
+            status);
+    for (int p = 0; p < num_stations && !*status; ++p)
+    {
+        for (int q = p + 1; q < num_stations; ++q)
+        {
+            const double dx = x[q] - x[p], dy = y[q] - y[p], dz = z[q] - z[p];
+            const double len = sqrt(dx * dx + dy * dy + dz * dz);
+            if (len > max_length) max_length = len;
+        }
+    }
+    oskar_telescope_free(tel, status);
+    return max_length;
+}
+
+int main(int argc, char** argv)
+{
+    int status = 0;
+    oskar::OptionParser opt("oskar_sky_compact", oskar_version_string());
+    opt.set_description("Merges sky model components that are unresolved "
+            "by the telescope, preserving total flux, flux-weighted position, "
+            "polarisation and (fitted) spectral index. Components closer "
+            "than a fraction of the resolution at the highest frequency on "
+            "the longest baseline are merged.");
+    opt.add_required("input sky model", "Path to an OSKAR sky model.");
+    opt.add_required("output sky model", "Path of the sky model to write.");
+    opt.add_flag("-t", "Telescope model directory, used to find the longest "
+            "baseline", 1, "", false, "--telescope");
+    opt.add_flag("-b", "Longest baseline length, in metres (if no telescope "
+            "model is given)", 1, "0", false, "--max-baseline");
+    opt.add_flag("-f", "Highest frequency, in Hz", 1, "", true,
+            "--freq-max");
+    opt.add_flag("-m", "Lowest frequency, in Hz, used to fit spectral "
+            "indices (default = highest frequency)", 1, "", false,
+            "--freq-min");
+    opt.add_flag("-r", "Merging radius, as a fraction of the resolution", 1,
+            "0.1", false, "--fraction");
+    if (!opt.check_options(argc, argv)) return EXIT_FAILURE;
+
+    // Parse command line.
+    double max_baseline_m = 0.0, freq_max_hz = 0.0, freq_min_hz = 0.0;
+    double fraction = 0.0;
+    opt.get("-b")->getDouble(max_baseline_m);
+    opt.get("-f")->getDouble(freq_max_hz);
+    if (opt.is_set("-m")) opt.get("-m")->getDouble(freq_min_hz);
+    opt.get("-r")->getDouble(fraction);
+    if (opt.is_set("-t"))
+    {
+        std::string dir;
+        opt.get("-t")->getString(dir);
+        max_baseline_m = max_baseline_length(dir.c_str(), &status);
+        if (status)
+        {
+            oskar_log_error(0, "Cannot load telescope model '%s': %s",
+                    dir.c_str(), oskar_get_error_string(status));
+            return EXIT_FAILURE;
+        }
+    }
+    if (max_baseline_m <= 0.0 || freq_max_hz <= 0.0)
+    {
+        oskar_log_error(0, "A baseline length and frequency are required.");
+        return EXIT_FAILURE;
+    }
+
+    // Load the sky model.
+    oskar_Sky* sky = oskar_sky_load(opt.get_arg(0), OSKAR_DOUBLE, &status);
+    if (status)
+    {
+        oskar_sky_free(sky, &status);
+        oskar_log_error(0, "Cannot load sky model %s", opt.get_arg(0));
+        return EXIT_FAILURE;
+    }
+
+    // Merge components.
+    const double resolution_rad = C_0 / (freq_max_hz * max_baseline_m);
+    double error_jy = 0.0, total_flux = 0.0;
+    oskar_Sky* out = oskar_sky_compact(sky, fraction * resolution_rad,
+            freq_min_hz, freq_max_hz, max_baseline_m, &error_jy, &status);
+    const int num_in = oskar_sky_num_sources(sky);
+    const int num_out = oskar_sky_num_sources(out);
+    const double* I = oskar_mem_double_const(oskar_sky_I_const(sky), &status);
+    for (int i = 0; i < num_in && !status; ++i)
+        if (I[i] > 0.0) total_flux += I[i];
+
+    // Write out the sky model and report the reduction.
+    oskar_sky_save(opt.get_arg(1), out, &status);
+    if (!status)
+    {
+        oskar_log_message(0, 'M', 0, "Longest baseline: %.1f m",
+                max_baseline_m);
+        oskar_log_message(0, 'M', 0, "Resolution: %.3f arcsec; "
+                "merging radius: %.3f arcsec", resolution_rad * R2D * 3600.0,
+                fraction * resolution_rad * R2D * 3600.0);
+        oskar_log_message(0, 'M', 0, "Components: %d input, %d output "
+                "(reduction factor %.2f)", num_in, num_out,
+                num_out > 0 ? (double)num_in / num_out : 0.0);
+        oskar_log_message(0, 'M', 0, "Predicted visibility error: %.3e Jy "
+                "(%.3e of total flux)", error_jy,
+                total_flux > 0.0 ? error_jy / total_flux : 0.0);
+    }
+    oskar_sky_free(out, &status);
+    oskar_sky_free(sky, &status);
+    if (status)
+    {
+        oskar_log_error(0, oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
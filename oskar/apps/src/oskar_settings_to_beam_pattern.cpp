@@ -27,6 +27,7 @@
  */
 
 #include "apps/oskar_settings_to_beam_pattern.h"
+#include "math/oskar_cmath.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -48,6 +49,8 @@ oskar_BeamPattern* oskar_settings_to_beam_pattern(oskar::SettingsTree* s,
     oskar_beam_pattern_set_log(h, log);
     oskar_beam_pattern_set_max_chunk_size(h,
             s->to_int("max_sources_per_chunk", status));
+    oskar_beam_pattern_set_max_host_memory_gb(h,
+            s->to_double("max_host_memory_gb", status));
     if (!s->to_int("use_gpus", status))
         oskar_beam_pattern_set_gpus(h, 0, 0, status);
     else
@@ -65,6 +68,12 @@ oskar_BeamPattern* oskar_settings_to_beam_pattern(oskar::SettingsTree* s,
         oskar_beam_pattern_set_num_devices(h, -1);
     else
         oskar_beam_pattern_set_num_devices(h, s->to_int("num_devices", status));
+    if (!s->starts_with("cpu_affinity", "none", status))
+    {
+        int size = 0;
+        const int* ids = s->to_int_list("cpu_affinity", &size, status);
+        oskar_beam_pattern_set_cpu_affinity(h, size, ids);
+    }
     oskar_log_set_keep_file(log, s->to_int("keep_log_file", status));
     oskar_log_set_file_priority(log,
             s->to_int("write_status_to_log_file", status) ?
@@ -152,6 +161,19 @@ oskar_BeamPattern* oskar_settings_to_beam_pattern(oskar::SettingsTree* s,
     oskar_beam_pattern_set_cross_power_raw_text(h,
             s->to_int("telescope_outputs/text_file/cross_power_raw_complex",
                     status));
+    oskar_beam_pattern_set_tied_array_power_fits(h,
+            s->to_int("telescope_outputs/fits_image/tied_array_power",
+                    status));
+    oskar_beam_pattern_set_tied_array_power_text(h,
+            s->to_int("telescope_outputs/text_file/tied_array_power",
+                    status));
+    oskar_beam_pattern_set_tied_array_raw_text(h,
+            s->to_int("telescope_outputs/text_file/tied_array_raw_complex",
+                    status));
+    if (s->starts_with("tied_array/pointing", "S", status))
+        oskar_beam_pattern_set_tied_array_pointing(h,
+                s->to_double("tied_array/ra_deg", status) * M_PI / 180.0,
+                s->to_double("tied_array/dec_deg", status) * M_PI / 180.0);
     s->end_group();
 
     // Return handle to beam pattern simulator.
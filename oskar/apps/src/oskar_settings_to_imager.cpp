@@ -27,6 +27,7 @@
  */
 
 #include "apps/oskar_settings_to_imager.h"
+#include "mem/oskar_mem_read_fits_image_plane.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -65,6 +66,14 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
         oskar_imager_set_num_devices(h, -1);
     else
         oskar_imager_set_num_devices(h, s->to_int("num_devices", status));
+    if (!s->starts_with("cpu_affinity", "none", status))
+    {
+        int size = 0;
+        const int* ids = s->to_int_list("cpu_affinity", &size, status);
+        oskar_imager_set_cpu_affinity(h, size, ids);
+    }
+    oskar_imager_set_max_host_memory_gb(h,
+            s->to_double("max_host_memory_gb", status));
 
     // Set input and output files.
     int num_files = 0;
@@ -104,6 +113,24 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
                 s->to_string("fft/kernel_type", status),
                 s->to_int("fft/support", status),
                 s->to_int("fft/oversample", status), status);
+        oskar_imager_set_grid_kernel_accuracy(h,
+                s->to_double("fft/kernel_accuracy", status));
+    }
+    if (s->starts_with("algorithm", "IDG", status))
+    {
+        oskar_imager_set_idg_subgrid_size(h,
+                s->to_int("idg/subgrid_size", status));
+        const char* aterm_file = s->to_string("idg/aterm_file", status);
+        if (aterm_file && strlen(aterm_file) > 0)
+        {
+            int size[2] = {0, 0};
+            oskar_Mem* aterm = oskar_mem_read_fits_image_plane(aterm_file,
+                    0, 0, 0, size, 0, 0, 0, 0, 0, 0, 0, status);
+            if (!*status && size[0] != size[1])
+                *status = OSKAR_ERR_DIMENSION_MISMATCH;
+            oskar_imager_set_idg_aterm(h, size[0], aterm, status);
+            oskar_mem_free(aterm, status);
+        }
     }
     if (!s->starts_with("wproj/num_w_planes", "auto", status))
         oskar_imager_set_num_w_planes(h,
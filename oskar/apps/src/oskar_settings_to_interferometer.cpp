@@ -27,9 +27,11 @@
  */
 
 #include "apps/oskar_settings_to_interferometer.h"
+#include "math/oskar_cmath.h"
 
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 
 using namespace std;
 
@@ -47,6 +49,8 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
     oskar_interferometer_set_log(h, log);
     oskar_interferometer_set_max_sources_per_chunk(h,
             s->to_int("max_sources_per_chunk", status));
+    oskar_interferometer_set_max_host_memory_gb(h,
+            s->to_double("max_host_memory_gb", status));
     oskar_interferometer_set_settings_path(h, s->file_name());
     if (!s->to_int("use_gpus", status))
         oskar_interferometer_set_gpus(h, 0, 0, status);
@@ -67,6 +71,12 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
     else
         oskar_interferometer_set_num_devices(h,
                 s->to_int("num_devices", status));
+    if (!s->starts_with("cpu_affinity", "none", status))
+    {
+        int size = 0;
+        const int* ids = s->to_int_list("cpu_affinity", &size, status);
+        oskar_interferometer_set_cpu_affinity(h, size, ids);
+    }
     oskar_log_set_keep_file(log, s->to_int("keep_log_file", status));
     oskar_log_set_file_priority(log,
             s->to_int("write_status_to_log_file", status) ?
@@ -94,6 +104,24 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
             s->to_double("start_frequency_hz", status),
             s->to_double("frequency_inc_hz", status),
             s->to_int("num_channels", status));
+    int num_ra = 0, num_dec = 0;
+    const double* ra_deg = s->to_double_list("phase_centre_ra_deg",
+            &num_ra, status);
+    const double* dec_deg = s->to_double_list("phase_centre_dec_deg",
+            &num_dec, status);
+    int num_beams = num_ra > num_dec ? num_ra : num_dec;
+    if (num_beams > 1 && !*status)
+    {
+        // Each extra phase centre is simulated as an additional beam.
+        vector<double> ra(num_beams - 1), dec(num_beams - 1);
+        for (int i = 1; i < num_beams; ++i)
+        {
+            ra[i - 1] = ra_deg[i < num_ra ? i : num_ra - 1] * M_PI / 180.0;
+            dec[i - 1] = dec_deg[i < num_dec ? i : num_dec - 1] * M_PI / 180.0;
+        }
+        oskar_interferometer_set_additional_beams(h, num_beams - 1,
+                &ra[0], &dec[0], status);
+    }
     s->end_group();
 
     // Set interferometer settings.
@@ -102,12 +130,39 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
             s->to_string("correlation_type", status), status);
     oskar_interferometer_set_max_times_per_block(h,
             s->to_int("max_time_samples_per_block", status));
+    if (!s->starts_with("station_ids", "all", status))
+    {
+        int num_stations = 0;
+        const int* ids = s->to_int_list("station_ids", &num_stations, status);
+        oskar_interferometer_set_station_subset(h, num_stations, ids, status);
+    }
     oskar_interferometer_set_output_vis_file(h,
             s->to_string("oskar_vis_filename", status));
     oskar_interferometer_set_output_measurement_set(h,
             s->to_string("ms_filename", status));
     oskar_interferometer_set_force_polarised_ms(h,
             s->to_int("force_polarised_ms", status));
+    oskar_interferometer_set_source_aggregation(h,
+            s->to_int("source_aggregation/enable", status),
+            s->to_double("source_aggregation/tolerance", status));
+    oskar_interferometer_set_nufft(h,
+            s->to_int("nufft/enable", status),
+            s->to_double("nufft/tolerance", status));
+    if (s->to_int("station_beam_interpolation/enable", status))
+        oskar_interferometer_set_station_beam_interpolation(h,
+                s->starts_with("station_beam_interpolation/method",
+                        "L", status) ?
+                        OSKAR_BEAM_INTERP_LINEAR : OSKAR_BEAM_INTERP_CUBIC,
+                s->to_double("station_beam_interpolation/max_drift_deg",
+                        status) * M_PI / 180.0);
+    oskar_interferometer_set_station_beam_low_rank(h,
+            s->to_int("station_beam_low_rank/enable", status),
+            s->to_double("station_beam_low_rank/tolerance", status));
+    oskar_interferometer_set_baseline_interpolation(h,
+            s->to_int("baseline_time_interpolation/enable", status),
+            s->to_double("baseline_time_interpolation/tolerance", status));
+    oskar_interferometer_set_vis_cache_directory(h,
+            s->to_string("visibility_cache_directory", status));
     s->end_group();
 
     // Return handle to interferometer simulator.
@@ -53,6 +53,10 @@ static void load_gsm(oskar_Sky* sky, oskar_Log* log, SettingsTree* s,
         double ra0, double dec0, int* status);
 static void load_fits_image(oskar_Sky* sky, oskar_Log* log, SettingsTree* s,
         double ra0, double dec0, int* status);
+static void load_fits_cube(oskar_Sky* sky, oskar_Log* log, SettingsTree* s,
+        int* status);
+static void load_fits_table(oskar_Sky* sky, oskar_Log* log, SettingsTree* s,
+        double ra0, double dec0, int* status);
 static void load_healpix_fits(oskar_Sky* sky, oskar_Log* log, SettingsTree* s,
         double ra0, double dec0, int* status);
 
@@ -91,6 +95,8 @@ oskar_Sky* oskar_settings_to_sky(SettingsTree* s, oskar_Log* log, int* status)
     load_osm(sky, log, s, ra0, dec0, status);
     load_gsm(sky, log, s, ra0, dec0, status);
     load_fits_image(sky, log, s, ra0, dec0, status);
+    load_fits_cube(sky, log, s, status);
+    load_fits_table(sky, log, s, ra0, dec0, status);
     load_healpix_fits(sky, log, s, ra0, dec0, status);
 
     /* Generate sky models from generator parameters. */
@@ -286,6 +292,89 @@ static void load_fits_image(oskar_Sky* sky, oskar_Log* log, SettingsTree* s,
 }
 
 
+static void load_fits_cube(oskar_Sky* sky, oskar_Log* log, SettingsTree* s,
+        int* status)
+{
+    int num_files = 0;
+    s->begin_group("fits_cube");
+    const char* const* files = s->to_string_list("file", &num_files, status);
+    const char* default_map_units = s->to_string("default_map_units", status);
+    int override_map_units = s->to_int("override_map_units", status);
+    double min_abs_val = s->to_double("min_abs_val", status);
+    for (int i = 0; i < num_files; ++i)
+    {
+        if (*status) break;
+        if (!files[i] || strlen(files[i]) == 0) continue;
+        if (log) oskar_log_message(log, 'M', 0,
+                "Loading FITS cube '%s' ...", files[i]);
+
+        /* Convert the cube into a sky model with tabulated spectra. */
+        oskar_Sky* t = oskar_sky_from_fits_cube(oskar_sky_precision(sky),
+                files[i], min_abs_val, default_map_units,
+                override_map_units, status);
+        if (*status == OSKAR_ERR_BAD_UNITS)
+            oskar_log_error(log, "Units error: Need K, mK, Jy/pixel or "
+                    "Jy/beam and beam size.");
+
+        /* Append to sky model. */
+        if (!*status)
+        {
+            oskar_sky_append(sky, t, status);
+            if (log) oskar_log_message(log, 'M', 1, "done (%d channels).",
+                    oskar_sky_num_spectral_channels(t));
+        }
+        oskar_sky_free(t, status);
+    }
+    s->end_group();
+}
+
+
+static void load_fits_table(oskar_Sky* sky, oskar_Log* log, SettingsTree* s,
+        double ra0, double dec0, int* status)
+{
+    int num_files = 0;
+    const char* keys[] = {"columns/ra", "columns/dec", "columns/I",
+            "columns/Q", "columns/U", "columns/V", "columns/ref_freq",
+            "columns/spectral_index", "columns/rm", "columns/fwhm_major",
+            "columns/fwhm_minor", "columns/position_angle"};
+    const char* columns[12];
+    s->begin_group("fits_table");
+    const char* const* files = s->to_string_list("file", &num_files, status);
+    double ref_freq_hz = s->to_double("default_ref_freq_hz", status);
+    for (int i = 0; i < 12; ++i)
+        columns[i] = s->to_string(keys[i], status);
+    for (int i = 0; i < num_files; ++i)
+    {
+        if (*status) break;
+        if (!files[i] || strlen(files[i]) == 0) continue;
+        if (log) oskar_log_message(log, 'M', 0,
+                "Loading FITS table '%s' ...", files[i]);
+
+        /* Read the catalogue into a temporary sky model. */
+        oskar_Sky* t = oskar_sky_from_fits_table(oskar_sky_precision(sky),
+                files[i], columns, ref_freq_hz, 0, status);
+        if (*status == OSKAR_ERR_BAD_SKY_FILE)
+            oskar_log_error(log, "Required catalogue column not found.");
+        else if (*status == OSKAR_ERR_BAD_UNITS)
+            oskar_log_error(log, "Unknown catalogue column units.");
+
+        /* Apply filters and extended source over-ride. */
+        set_up_filter(t, s, ra0, dec0, status);
+        set_up_extended(t, s, status);
+
+        /* Append to sky model. */
+        if (!*status)
+        {
+            oskar_sky_append(sky, t, status);
+            if (log) oskar_log_message(log, 'M', 1, "done (%d sources).",
+                    oskar_sky_num_sources(t));
+        }
+        oskar_sky_free(t, status);
+    }
+    s->end_group();
+}
+
+
 static void load_healpix_fits(oskar_Sky* sky, oskar_Log* log, SettingsTree* s,
         double ra0, double dec0, int* status)
 {
@@ -248,6 +248,9 @@ void set_station_data(oskar_Station* station, SettingsTree* s, int* status)
             s->to_int("enable", status));
     oskar_station_set_normalise_array_pattern(station,
             s->to_int("normalise", status));
+    oskar_station_set_array_pattern_nufft_tolerance(station,
+            s->to_int("nufft/enable", status) ?
+                    s->to_double("nufft/tolerance", status) : 0.0);
     oskar_station_set_seed_time_variable_errors(station,
             (unsigned int) s->to_int(
                     "element/seed_time_variable_errors", status));
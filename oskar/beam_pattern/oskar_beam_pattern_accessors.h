@@ -58,6 +58,10 @@ OSKAR_EXPORT
 void oskar_beam_pattern_set_average_single_axis(oskar_BeamPattern* h,
         char option);
 
+OSKAR_EXPORT
+void oskar_beam_pattern_set_cache_time_invariant_beams(oskar_BeamPattern* h,
+        int flag);
+
 OSKAR_EXPORT
 void oskar_beam_pattern_set_cross_power_amp_fits(oskar_BeamPattern* h,
         int flag);
@@ -74,6 +78,22 @@ OSKAR_EXPORT
 void oskar_beam_pattern_set_cross_power_phase_text(oskar_BeamPattern* h,
         int flag);
 
+/**
+ * @brief Sets the CPUs to which the worker threads are bound.
+ *
+ * @details
+ * Worker thread \p i is bound to CPU \p cpu_ids[i % num_cpus].
+ * If \p num_cpus is zero, the operating system schedules the threads
+ * on any CPU. A warning is logged if the affinity cannot be set.
+ *
+ * @param[in,out] h          Handle to beam pattern simulator.
+ * @param[in]     num_cpus   Number of CPU IDs in the list.
+ * @param[in]     cpu_ids    List of CPU IDs to use.
+ */
+OSKAR_EXPORT
+void oskar_beam_pattern_set_cpu_affinity(oskar_BeamPattern* h, int num_cpus,
+        const int* cpu_ids);
+
 OSKAR_EXPORT
 void oskar_beam_pattern_set_cross_power_raw_text(oskar_BeamPattern* h,
         int flag);
@@ -102,6 +122,10 @@ void oskar_beam_pattern_set_log(oskar_BeamPattern* h, oskar_Log* log);
 OSKAR_EXPORT
 void oskar_beam_pattern_set_max_chunk_size(oskar_BeamPattern* h, int value);
 
+OSKAR_EXPORT
+void oskar_beam_pattern_set_max_host_memory_gb(oskar_BeamPattern* h,
+        double value);
+
 OSKAR_EXPORT
 void oskar_beam_pattern_set_num_devices(oskar_BeamPattern* h, int value);
 
@@ -135,6 +159,26 @@ OSKAR_EXPORT
 void oskar_beam_pattern_set_telescope_model(oskar_BeamPattern* h,
         const oskar_Telescope* model, int* status);
 
+OSKAR_EXPORT
+void oskar_beam_pattern_set_tied_array_pointing(oskar_BeamPattern* h,
+        double ra_rad, double dec_rad);
+
+OSKAR_EXPORT
+void oskar_beam_pattern_set_tied_array_power_fits(oskar_BeamPattern* h,
+        int flag);
+
+OSKAR_EXPORT
+void oskar_beam_pattern_set_tied_array_power_text(oskar_BeamPattern* h,
+        int flag);
+
+OSKAR_EXPORT
+void oskar_beam_pattern_set_tied_array_raw_text(oskar_BeamPattern* h,
+        int flag);
+
+OSKAR_EXPORT
+void oskar_beam_pattern_set_tied_array_weights(oskar_BeamPattern* h,
+        int num_weights, const double* weights);
+
 OSKAR_EXPORT
 void oskar_beam_pattern_set_voltage_amp_fits(oskar_BeamPattern* h, int flag);
 
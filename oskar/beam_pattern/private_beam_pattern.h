@@ -58,6 +58,14 @@ struct DeviceData
     oskar_Mem* cross_power_channel_avg[4];
     oskar_Mem* cross_power_channel_and_time_avg[4];
 
+    /* Tied-array beam has dimension max_chunk_size. */
+    oskar_Mem* tied_jones_cpu[2]; /* On host, accumulated in place. */
+    oskar_Mem* tied_power_cpu[4][2];
+    oskar_Mem* tied_power_time_avg[4];
+    oskar_Mem* tied_power_channel_avg[4];
+    oskar_Mem* tied_power_channel_and_time_avg[4];
+    oskar_Mem *tied_beam, *tied_x, *tied_y, *tied_z; /* Scratch. */
+
     /* Device memory. */
     int previous_chunk_index;
     oskar_Telescope* tel;
@@ -65,6 +73,12 @@ struct DeviceData
     oskar_Mem *x, *y, *z, *jones_data;
     oskar_Mem *auto_power[4], *cross_power[4];
 
+    /* Beams cached for each channel, if they do not change in time. */
+    int num_cache_slots, *cache_chunk, *cache_channel;
+    double* cache_amp;          /* Normalisation when cached, per station. */
+    oskar_Mem* jones_cache;     /* On host. */
+    oskar_Mem *norm_beam, *norm_x, *norm_y, *norm_z; /* Normalisation point. */
+
     /* Timers. */
     oskar_Timer* tmr_compute;   /* Total time spent calculating pixels. */
 };
@@ -86,8 +100,9 @@ typedef struct DataProduct DataProduct;
 struct oskar_BeamPattern
 {
     /* Settings. */
-    int prec, num_devices, num_gpus, *gpu_ids;
+    int prec, num_devices, num_gpus, *gpu_ids, num_cpu_ids, *cpu_ids;
     int coord_type, max_chunk_size;
+    double max_host_memory_gb;
     int num_time_steps, num_channels, num_chunks;
     int pol_mode, width, height, num_pixels, nside;
     int num_active_stations, *station_ids;
@@ -95,17 +110,24 @@ struct oskar_BeamPattern
     int voltage_amp_fits, voltage_phase_fits, auto_power_fits;
     int cross_power_amp_txt, cross_power_phase_txt, cross_power_raw_txt;
     int cross_power_amp_fits, cross_power_phase_fits, ixr_txt, ixr_fits;
+    int tied_array_raw_txt, tied_array_power_txt, tied_array_power_fits;
+    int tied_array_pointing_set, num_tied_array_weights;
+    double tied_array_ra_rad, tied_array_dec_rad, *tied_array_weights;
     int average_time_and_channel, separate_time_and_channel, stokes[4];
     double lon0, lat0, phase_centre_deg[2], fov_deg[2];
     double time_start_mjd_utc, time_inc_sec, length_sec;
     double freq_start_hz, freq_inc_hz;
+    int cache_time_invariant;
     char average_single_axis, coord_frame_type, coord_grid_type;
     char *root_path, *sky_model_file;
 
     /* State. */
     oskar_Mutex* mutex;
     oskar_Barrier* barrier;
-    int i_global, status;
+    oskar_ThreadPool* thread_pool;
+    int i_global, status, time_invariant;
+    int tied_array, separate_station_beams;
+    int num_station_classes, *station_class, *class_station;
 
     /* Input data. */
     oskar_Mem *x, *y, *z;
@@ -144,14 +166,18 @@ enum OSKAR_BEAM_PATTERN_DATA_PRODUCT_TYPE
     CROSS_POWER_RAW_COMPLEX,
     CROSS_POWER_AMP,
     CROSS_POWER_PHASE,
-    IXR
+    IXR,
+    TIED_ARRAY_RAW_COMPLEX,
+    TIED_ARRAY_POWER
 };
 
 enum OSKAR_BEAM_DATA_TYPE
 {
     JONES_DATA,
     AUTO_POWER_DATA,
-    CROSS_POWER_DATA
+    CROSS_POWER_DATA,
+    TIED_ARRAY_JONES_DATA,
+    TIED_ARRAY_POWER_DATA
 };
 
 enum OSKAR_STOKES
@@ -73,6 +73,13 @@ void oskar_beam_pattern_set_average_single_axis(oskar_BeamPattern* h,
 }
 
 
+void oskar_beam_pattern_set_cache_time_invariant_beams(oskar_BeamPattern* h,
+        int flag)
+{
+    h->cache_time_invariant = flag;
+}
+
+
 void oskar_beam_pattern_set_coordinate_frame(oskar_BeamPattern* h, char option)
 {
     h->coord_frame_type = option;
@@ -85,6 +92,30 @@ void oskar_beam_pattern_set_coordinate_type(oskar_BeamPattern* h, char option)
 }
 
 
+void oskar_beam_pattern_set_cpu_affinity(oskar_BeamPattern* h, int num_cpus,
+        const int* cpu_ids)
+{
+    int i;
+    free(h->cpu_ids);
+    h->cpu_ids = 0;
+    h->num_cpu_ids = 0;
+    if (num_cpus > 0)
+    {
+        h->cpu_ids = (int*) calloc(num_cpus, sizeof(int));
+        if (h->cpu_ids)
+        {
+            h->num_cpu_ids = num_cpus;
+            for (i = 0; i < num_cpus; ++i)
+                h->cpu_ids[i] = cpu_ids[i];
+        }
+    }
+
+    /* Re-create the worker threads with the new affinity when next used. */
+    oskar_thread_pool_free(h->thread_pool);
+    h->thread_pool = 0;
+}
+
+
 void oskar_beam_pattern_set_cross_power_amp_fits(oskar_BeamPattern* h, int flag)
 {
     h->cross_power_amp_fits = flag;
@@ -188,6 +219,13 @@ void oskar_beam_pattern_set_max_chunk_size(oskar_BeamPattern* h, int value)
 }
 
 
+void oskar_beam_pattern_set_max_host_memory_gb(oskar_BeamPattern* h,
+        double value)
+{
+    h->max_host_memory_gb = value;
+}
+
+
 void oskar_beam_pattern_set_num_devices(oskar_BeamPattern* h, int value)
 {
     int status = 0;
@@ -300,6 +338,47 @@ void oskar_beam_pattern_set_telescope_model(oskar_BeamPattern* h,
 }
 
 
+void oskar_beam_pattern_set_tied_array_pointing(oskar_BeamPattern* h,
+        double ra_rad, double dec_rad)
+{
+    h->tied_array_pointing_set = 1;
+    h->tied_array_ra_rad = ra_rad;
+    h->tied_array_dec_rad = dec_rad;
+}
+
+
+void oskar_beam_pattern_set_tied_array_power_fits(oskar_BeamPattern* h,
+        int flag)
+{
+    h->tied_array_power_fits = flag;
+}
+
+
+void oskar_beam_pattern_set_tied_array_power_text(oskar_BeamPattern* h,
+        int flag)
+{
+    h->tied_array_power_txt = flag;
+}
+
+
+void oskar_beam_pattern_set_tied_array_raw_text(oskar_BeamPattern* h,
+        int flag)
+{
+    h->tied_array_raw_txt = flag;
+}
+
+
+void oskar_beam_pattern_set_tied_array_weights(oskar_BeamPattern* h,
+        int num_weights, const double* weights)
+{
+    h->num_tied_array_weights = num_weights > 0 ? num_weights : 0;
+    h->tied_array_weights = (double*) realloc(h->tied_array_weights,
+            h->num_tied_array_weights * sizeof(double));
+    if (h->num_tied_array_weights > 0)
+        memcpy(h->tied_array_weights, weights, num_weights * sizeof(double));
+}
+
+
 void oskar_beam_pattern_set_voltage_amp_fits(oskar_BeamPattern* h, int flag)
 {
     h->voltage_amp_fits = flag;
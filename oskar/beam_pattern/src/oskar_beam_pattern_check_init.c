@@ -49,11 +49,31 @@
 extern "C" {
 #endif
 
-
+/* Estimated memory requirements, in bytes. */
+struct MemoryEstimate
+{
+    size_t coords;     /* Pixel coordinates (host memory). */
+    size_t tel;        /* Telescope model (host memory). */
+    size_t host_beams; /* Host beam and output buffers, per device. */
+    size_t cache;      /* Time-invariant beam cache, per CPU device. */
+    size_t tel_copy;   /* Telescope model copy, per device. */
+    size_t beams;      /* Beam buffers, per device. */
+    size_t work;       /* Station work buffers, per device. */
+    size_t device;     /* Memory required on each device. */
+    size_t host;       /* Memory required on the host, including CPU devices. */
+};
+typedef struct MemoryEstimate MemoryEstimate;
+
+static void set_up_memory_budget(oskar_BeamPattern* h, int* status);
+static void estimate_memory(const oskar_BeamPattern* h, int max_src,
+        MemoryEstimate* m);
 static void set_up_host_data(oskar_BeamPattern* h, int *status);
 static void create_averaged_products(oskar_BeamPattern* h, int ta, int ca,
         int* status);
 static void set_up_device_data(oskar_BeamPattern* h, int* status);
+static void set_up_station_classes(oskar_BeamPattern* h, int* status);
+static int is_time_invariant(const oskar_BeamPattern* h, int* status);
+static int station_is_time_invariant(const oskar_Station* s, int* status);
 static void write_axis(fitsfile* fptr, int axis_id, const char* ctype,
         const char* ctype_comment, double crval, double cdelt, double crpix,
         int* status);
@@ -91,8 +111,27 @@ void oskar_beam_pattern_check_init(oskar_BeamPattern* h, int* status)
         return;
     }
 
+    /* Check the tied-array weights, if given. */
+    if (h->num_tied_array_weights > 0 &&
+            h->num_tied_array_weights != h->num_active_stations)
+    {
+        oskar_log_error(h->log, "Number of tied-array weights (%d) does "
+                "not match the number of active stations (%d).",
+                h->num_tied_array_weights, h->num_active_stations);
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
     /* Check that each compute device has been set up. */
     set_up_host_data(h, status);
+    set_up_station_classes(h, status);
+    h->time_invariant = h->cache_time_invariant &&
+            is_time_invariant(h, status);
+    if (h->time_invariant && h->num_time_steps > 1)
+        oskar_log_message(h->log, 'M', 0, "Station beams do not change "
+                "in time: evaluating them once per channel.");
+    if (!h->d || !h->d[0].tel)
+        set_up_memory_budget(h, status);
     set_up_device_data(h, status);
 }
 
@@ -182,6 +221,10 @@ static void set_up_host_data(oskar_BeamPattern* h, int *status)
             if (h->ixr_fits && h->pol_mode == OSKAR_POL_MODE_FULL)
                 new_fits_file(h, IXR, -1, -1, i, 0, 0, status);
         }
+
+        /* Create telescope-level data products. */
+        if (h->tied_array_raw_txt)
+            new_text_file(h, TIED_ARRAY_RAW_COMPLEX, -1, -1, -1, 0, 0, status);
     }
 
     /* Create data products that can be averaged. */
@@ -238,6 +281,8 @@ static void create_averaged_products(oskar_BeamPattern* h, int ta, int ca,
                 new_text_file(h, CROSS_POWER_AMP, i, o, -1, ta, ca, status);
             if (h->cross_power_phase_txt)
                 new_text_file(h, CROSS_POWER_PHASE, i, o, -1, ta, ca, status);
+            if (h->tied_array_power_txt)
+                new_text_file(h, TIED_ARRAY_POWER, i, o, -1, ta, ca, status);
         }
     }
 
@@ -253,6 +298,8 @@ static void create_averaged_products(oskar_BeamPattern* h, int ta, int ca,
                 new_fits_file(h, CROSS_POWER_AMP, i, o, -1, ta, ca, status);
             if (h->cross_power_phase_fits)
                 new_fits_file(h, CROSS_POWER_PHASE, i, o, -1, ta, ca, status);
+            if (h->tied_array_power_fits)
+                new_fits_file(h, TIED_ARRAY_POWER, i, o, -1, ta, ca, status);
         }
     }
 }
@@ -496,6 +543,9 @@ static void new_text_file(oskar_BeamPattern* h, int data_product_type,
     if (i_station >= 0)
         fprintf(f, "# Beam pixel list for station %d\n",
                 h->station_ids[i_station]);
+    else if (data_product_type == TIED_ARRAY_RAW_COMPLEX ||
+            data_product_type == TIED_ARRAY_POWER)
+        fprintf(f, "# Beam pixel list for tied-array beam\n");
     else
         fprintf(f, "# Beam pixel list for telescope (interferometer)\n");
     fprintf(f, "# Filename is '%s'\n", name);
@@ -530,6 +580,8 @@ static const char* data_type_to_string(int type)
     case CROSS_POWER_AMP:            return "CROSS_POWER_AMP";
     case CROSS_POWER_PHASE:          return "CROSS_POWER_PHASE";
     case IXR:                        return "IXR";
+    case TIED_ARRAY_RAW_COMPLEX:     return "TIED_ARRAY_RAW_COMPLEX";
+    case TIED_ARRAY_POWER:           return "TIED_ARRAY_POWER";
     default:                         return "";
     }
 }
@@ -552,9 +604,157 @@ static const char* stokes_type_to_string(int type)
 }
 
 
+static void set_up_memory_budget(oskar_BeamPattern* h, int* status)
+{
+    int i, max_src, over_host = 0, over_device = 0;
+    size_t host_limit = 0, device_limit = 0, mem_free = 0, mem_total = 0;
+    const double gigabyte = 1024.0 * 1024.0 * 1024.0;
+    const double megabyte = 1024.0 * 1024.0;
+    MemoryEstimate m;
+    if (*status) return;
+
+    /* Get the memory limits. */
+    if (h->max_host_memory_gb > 0.0)
+        host_limit = (size_t) (h->max_host_memory_gb * gigabyte);
+    for (i = 0; i < h->num_gpus; ++i)
+    {
+        oskar_device_set(h->gpu_ids[i], status);
+        oskar_device_mem_info(&mem_free, &mem_total);
+        if (i == 0 || mem_free < device_limit)
+            device_limit = mem_free;
+    }
+
+    /* Halve the chunk size until the estimate fits. */
+    max_src = h->max_chunk_size > 0 ? h->max_chunk_size : 1;
+    for (;;)
+    {
+        estimate_memory(h, max_src, &m);
+        over_host = (host_limit > 0 && m.host > host_limit);
+        over_device = (device_limit > 0 && m.device > device_limit);
+        if ((!over_host && !over_device) || max_src == 1) break;
+        max_src = (max_src + 1) / 2;
+    }
+
+    /* Write the estimate to the log. */
+    oskar_log_section(h->log, 'M', "Memory estimate");
+    oskar_log_value(h->log, 'M', 0, "Pixel coordinates", "%.1f MB",
+            m.coords / megabyte);
+    oskar_log_value(h->log, 'M', 0, "Telescope model", "%.1f MB",
+            m.tel / megabyte);
+    oskar_log_value(h->log, 'M', 0, "Host output buffers per device",
+            "%.1f MB", m.host_beams / megabyte);
+    if (m.cache > 0)
+        oskar_log_value(h->log, 'M', 0, "Beam cache per CPU device",
+                "%.1f MB", m.cache / megabyte);
+    oskar_log_message(h->log, 'M', 0, "Per compute device:");
+    oskar_log_value(h->log, 'M', 1, "Telescope model copy", "%.1f MB",
+            m.tel_copy / megabyte);
+    oskar_log_value(h->log, 'M', 1, "Beam buffers", "%.1f MB",
+            m.beams / megabyte);
+    oskar_log_value(h->log, 'M', 1, "Station work buffers", "%.1f MB",
+            m.work / megabyte);
+    if (h->num_gpus > 0)
+        oskar_log_value(h->log, 'M', 0, "Total per GPU", "%.1f MB",
+                m.device / megabyte);
+    oskar_log_value(h->log, 'M', 0, "Total host", "%.1f MB",
+            m.host / megabyte);
+    if (over_host || over_device)
+    {
+        if (over_host)
+            oskar_log_error(h->log, "Estimated host memory (%.3f GB) "
+                    "exceeds the limit of %.3f GB.",
+                    m.host / gigabyte, host_limit / gigabyte);
+        if (over_device)
+            oskar_log_error(h->log, "Estimated GPU memory (%.3f GB) "
+                    "exceeds the free memory of %.3f GB.",
+                    m.device / gigabyte, device_limit / gigabyte);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+
+    /* Apply the new chunk size. */
+    if (max_src != h->max_chunk_size)
+    {
+        oskar_log_warning(h->log, "Reducing maximum pixels per chunk "
+                "from %d to %d to fit in available memory.",
+                h->max_chunk_size, max_src);
+        h->max_chunk_size = max_src;
+        h->num_chunks = (h->num_pixels + max_src - 1) / max_src;
+    }
+}
+
+
+static void estimate_memory(const oskar_BeamPattern* h, int max_src,
+        MemoryEstimate* m)
+{
+    int i, num_devices, num_stokes = 0, num_avg = 0, raw_data;
+    int auto_power, cross_power, tied_power, tied_array;
+    size_t real_size, beam_size, max_size;
+    memset(m, 0, sizeof(MemoryEstimate));
+    num_devices = h->num_devices > h->num_gpus ? h->num_devices : h->num_gpus;
+    real_size = oskar_mem_element_size(h->prec);
+    beam_size = 2 * real_size;
+    if (h->pol_mode == OSKAR_POL_MODE_FULL)
+        beam_size *= 4;
+    raw_data = h->ixr_txt || h->ixr_fits ||
+            h->voltage_raw_txt || h->voltage_amp_txt || h->voltage_phase_txt ||
+            h->voltage_amp_fits || h->voltage_phase_fits;
+    auto_power = h->auto_power_fits || h->auto_power_txt;
+    cross_power = h->cross_power_raw_txt ||
+            h->cross_power_amp_fits || h->cross_power_phase_fits ||
+            h->cross_power_amp_txt || h->cross_power_phase_txt;
+    tied_power = h->tied_array_power_txt || h->tied_array_power_fits;
+    tied_array = tied_power || h->tied_array_raw_txt;
+    for (i = 0; i < 4; ++i)
+        if (h->stokes[i]) num_stokes++;
+    if (h->average_single_axis == 'T' || h->average_single_axis == 'C')
+        num_avg++;
+    if (h->average_time_and_channel)
+        num_avg++;
+    max_size = (size_t) max_src;
+    if (raw_data || auto_power || cross_power)
+        max_size *= h->num_active_stations;
+
+    /* Host memory. */
+    m->coords = 3 * (size_t) h->num_pixels * real_size;
+    m->tel = oskar_telescope_memory_bytes(h->tel);
+    if (raw_data)
+        m->host_beams += 2 * max_size * beam_size;
+    if (tied_array)
+        m->host_beams += (size_t) max_src * (3 * beam_size + 3 * real_size);
+    if (auto_power)
+        m->host_beams += num_stokes * (2 + num_avg) * max_size * beam_size;
+    if (cross_power)
+        m->host_beams += num_stokes * (2 + num_avg) * max_src * beam_size;
+    if (tied_power)
+        m->host_beams += num_stokes * (2 + num_avg) * max_src * beam_size;
+    if (h->time_invariant)
+        m->cache = (h->average_single_axis == 'T' ? 1 : h->num_channels) *
+                (size_t) h->num_active_stations * max_src * beam_size;
+
+    /* Memory per compute device. */
+    m->tel_copy = m->tel;
+    m->beams = max_size * beam_size + 3 * (1 + (size_t) max_src) * real_size;
+    if (auto_power)
+        m->beams += num_stokes * max_size * beam_size;
+    if (cross_power)
+        m->beams += num_stokes * max_src * beam_size;
+    m->work = (size_t) max_src * (8 * real_size + 2 * sizeof(int) +
+            2 * real_size + oskar_telescope_max_station_depth(h->tel) *
+            beam_size) + 2 * (size_t) oskar_telescope_max_station_size(h->tel) *
+            2 * real_size;
+
+    /* Totals. */
+    m->device = m->tel_copy + m->beams + m->work;
+    m->host = m->coords + m->tel + num_devices * m->host_beams +
+            (num_devices - h->num_gpus) * (m->device + m->cache);
+}
+
+
 static void set_up_device_data(oskar_BeamPattern* h, int* status)
 {
     int i, beam_type, max_src, max_size, auto_power, cross_power, raw_data;
+    int tied_power;
     if (*status) return;
 
     /* Get local variables. */
@@ -570,6 +770,14 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
     cross_power = h->cross_power_raw_txt ||
             h->cross_power_amp_fits || h->cross_power_phase_fits ||
             h->cross_power_amp_txt || h->cross_power_phase_txt;
+    tied_power = h->tied_array_power_txt || h->tied_array_power_fits;
+    h->tied_array = tied_power || h->tied_array_raw_txt;
+
+    /* Station beams are not kept separately if only the tied-array beam
+     * is needed: they are accumulated one at a time instead. */
+    h->separate_station_beams = raw_data || auto_power || cross_power;
+    if (!h->separate_station_beams)
+        max_size = max_src;
 
     /* Expand the number of devices to the number of selected GPUs,
      * if required. */
@@ -614,6 +822,19 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
             d->jones_data_cpu[1] = oskar_mem_create(beam_type, OSKAR_CPU,
                     max_size, status);
         }
+        if (!d->tied_jones_cpu[0] && h->tied_array)
+        {
+            d->tied_jones_cpu[0] = oskar_mem_create(beam_type, OSKAR_CPU,
+                    max_src, status);
+            d->tied_jones_cpu[1] = oskar_mem_create(beam_type, OSKAR_CPU,
+                    max_src, status);
+            d->tied_x = oskar_mem_create(h->prec, OSKAR_CPU, max_src, status);
+            d->tied_y = oskar_mem_create(h->prec, OSKAR_CPU, max_src, status);
+            d->tied_z = oskar_mem_create(h->prec, OSKAR_CPU, max_src, status);
+            if (dev_loc != OSKAR_CPU)
+                d->tied_beam = oskar_mem_create(beam_type, OSKAR_CPU,
+                        max_src, status);
+        }
 
         /* Auto-correlation beam output arrays. */
         for (i_stokes = 0; i_stokes < 4; ++i_stokes)
@@ -675,18 +896,151 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
                             oskar_mem_create(beam_type, OSKAR_CPU,
                                     max_src, status);
             }
+
+            /* Tied-array beam output arrays (host memory). */
+            if (!d->tied_power_cpu[i_stokes][0] && tied_power)
+            {
+                d->tied_power_cpu[i_stokes][0] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_src, status);
+                d->tied_power_cpu[i_stokes][1] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_src, status);
+                if (h->average_single_axis == 'T')
+                    d->tied_power_time_avg[i_stokes] = oskar_mem_create(
+                            beam_type, OSKAR_CPU, max_src, status);
+                if (h->average_single_axis == 'C')
+                    d->tied_power_channel_avg[i_stokes] = oskar_mem_create(
+                            beam_type, OSKAR_CPU, max_src, status);
+                if (h->average_time_and_channel)
+                    d->tied_power_channel_and_time_avg[i_stokes] =
+                            oskar_mem_create(beam_type, OSKAR_CPU,
+                                    max_src, status);
+            }
             if (d->auto_power[i_stokes])
                 oskar_mem_clear_contents(d->auto_power[i_stokes], status);
             if (d->cross_power[i_stokes])
                 oskar_mem_clear_contents(d->cross_power[i_stokes], status);
         }
 
+        /* Cache for time-invariant beams (host memory only). */
+        if (h->time_invariant && dev_loc == OSKAR_CPU && !d->jones_cache)
+        {
+            int j;
+
+            /* Only one channel is needed at a time if time is the
+             * inner loop; otherwise keep all of them. */
+            d->num_cache_slots =
+                    h->average_single_axis == 'T' ? 1 : h->num_channels;
+            d->jones_cache = oskar_mem_create(beam_type, OSKAR_CPU,
+                    d->num_cache_slots * h->num_active_stations * max_src,
+                    status);
+            d->cache_amp = (double*) calloc(
+                    d->num_cache_slots * h->num_active_stations,
+                    sizeof(double));
+            d->cache_chunk = (int*) malloc(d->num_cache_slots * sizeof(int));
+            d->cache_channel = (int*) malloc(d->num_cache_slots * sizeof(int));
+            for (j = 0; j < d->num_cache_slots; ++j)
+                d->cache_chunk[j] = d->cache_channel[j] = -1;
+            d->norm_beam = oskar_mem_create(beam_type, OSKAR_CPU, 1, status);
+            d->norm_x = oskar_mem_create(h->prec, OSKAR_CPU, 1, status);
+            d->norm_y = oskar_mem_create(h->prec, OSKAR_CPU, 1, status);
+            d->norm_z = oskar_mem_create(h->prec, OSKAR_CPU, 1, status);
+        }
+
         /* Timers. */
         if (!d->tmr_compute)
             d->tmr_compute = oskar_timer_create(OSKAR_TIMER_NATIVE);
     }
 }
 
+
+/* Groups active stations with identical beams into classes, so that
+ * each beam only needs to be evaluated once. */
+static void set_up_station_classes(oskar_BeamPattern* h, int* status)
+{
+    int i, j, duplicate;
+    if (*status || h->station_class) return;
+    h->station_class = (int*) calloc(h->num_active_stations, sizeof(int));
+    h->class_station = (int*) calloc(h->num_active_stations, sizeof(int));
+    h->num_station_classes = 0;
+    duplicate = oskar_telescope_allow_station_beam_duplication(h->tel);
+    for (i = 0; i < h->num_active_stations; ++i)
+    {
+        const oskar_Station *a, *b;
+        a = oskar_telescope_station_const(h->tel, h->station_ids[i]);
+        j = h->num_station_classes;
+        if (duplicate && oskar_telescope_identical_stations(h->tel))
+            j = (i > 0) ? 0 : j;
+        else if (duplicate)
+        {
+            for (j = 0; j < h->num_station_classes; ++j)
+            {
+                b = oskar_telescope_station_const(h->tel,
+                        h->station_ids[h->class_station[j]]);
+                if (oskar_station_lon_rad(a) == oskar_station_lon_rad(b) &&
+                        oskar_station_lat_rad(a) == oskar_station_lat_rad(b) &&
+                        !oskar_station_different(a, b, status))
+                    break;
+            }
+        }
+        if (j == h->num_station_classes)
+            h->class_station[(h->num_station_classes)++] = i;
+        h->station_class[i] = j;
+    }
+}
+
+
+/* Returns true if the station beams in the horizon frame are the same at
+ * every time step, so that they can be evaluated once per channel. */
+static int is_time_invariant(const oskar_BeamPattern* h, int* status)
+{
+    int i;
+    if (*status || h->coord_frame_type != 'H') return 0;
+    for (i = 0; i < h->num_active_stations; ++i)
+    {
+        if (!station_is_time_invariant(oskar_telescope_station_const(h->tel,
+                h->station_ids[i]), status))
+            return 0;
+    }
+    return 1;
+}
+
+
+static int station_is_time_invariant(const oskar_Station* s, int* status)
+{
+    int i, num_elements;
+    if (oskar_station_type(s) == OSKAR_STATION_TYPE_ISOTROPIC) return 1;
+    if (oskar_station_type(s) != OSKAR_STATION_TYPE_AA) return 0;
+
+    /* The beam must be fixed in azimuth and elevation. */
+    if (oskar_station_beam_coord_type(s) != OSKAR_SPHERICAL_TYPE_AZEL)
+        return 0;
+
+    /* There must be no time-variable element errors. */
+    num_elements = oskar_station_num_elements(s);
+    if (oskar_station_apply_element_errors(s))
+    {
+        const oskar_Mem *gain_error, *phase_error;
+        gain_error = oskar_station_element_gain_error_const(s);
+        phase_error = oskar_station_element_phase_error_rad_const(s);
+        for (i = 0; i < num_elements; ++i)
+        {
+            if (oskar_mem_get_element(gain_error, i, status) != 0.0 ||
+                    oskar_mem_get_element(phase_error, i, status) != 0.0)
+                return 0;
+        }
+    }
+
+    /* Check child stations. */
+    if (oskar_station_has_child(s))
+    {
+        for (i = 0; i < num_elements; ++i)
+            if (!station_is_time_invariant(oskar_station_child_const(s, i),
+                    status))
+                return 0;
+    }
+    return 1;
+}
+
 #ifdef __cplusplus
 }
 #endif
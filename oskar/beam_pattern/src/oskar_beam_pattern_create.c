@@ -57,6 +57,7 @@ oskar_BeamPattern* oskar_beam_pattern_create(int precision, int* status)
     oskar_beam_pattern_set_image_size(h, 256, 256);
     oskar_beam_pattern_set_image_fov(h, 2.0, 2.0);
     oskar_beam_pattern_set_separate_time_and_channel(h, 1);
+    oskar_beam_pattern_set_cache_time_invariant_beams(h, 1);
     return h;
 }
 
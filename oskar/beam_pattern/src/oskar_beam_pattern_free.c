@@ -38,6 +38,7 @@ extern "C" {
 void oskar_beam_pattern_free(oskar_BeamPattern* h, int* status)
 {
     if (!h) return;
+    oskar_thread_pool_free(h->thread_pool);
     oskar_beam_pattern_reset_cache(h, status);
     oskar_telescope_free(h->tel, status);
     oskar_timer_free(h->tmr_sim);
@@ -49,6 +50,8 @@ void oskar_beam_pattern_free(oskar_BeamPattern* h, int* status)
     free(h->sky_model_file);
     free(h->settings_log);
     free(h->station_ids);
+    free(h->cpu_ids);
+    free(h->tied_array_weights);
     free(h);
 }
 
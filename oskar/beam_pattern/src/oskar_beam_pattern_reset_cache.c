@@ -49,6 +49,10 @@ void oskar_beam_pattern_reset_cache(oskar_BeamPattern* h, int* status)
     oskar_mem_free(h->pix, status);
     oskar_mem_free(h->ctemp, status);
     h->x = h->y = h->z = h->pix = h->ctemp = NULL;
+    free(h->station_class);
+    free(h->class_station);
+    h->station_class = h->class_station = NULL;
+    h->num_station_classes = 0;
 
     /* Close files and free data products. */
     for (i = 0; i < h->num_data_products; ++i)
@@ -29,9 +29,11 @@
 #include "beam_pattern/oskar_beam_pattern.h"
 #include "beam_pattern/private_beam_pattern.h"
 #include "convert/oskar_convert_mjd_to_gast_fast.h"
+#include "convert/oskar_convert_relative_directions_to_enu_directions.h"
 #include "correlate/oskar_evaluate_auto_power.h"
 #include "correlate/oskar_evaluate_cross_power.h"
 #include "telescope/station/oskar_evaluate_station_beam.h"
+#include "telescope/station/oskar_evaluate_station_beam_aperture_array.h"
 #include "math/oskar_cmath.h"
 #include "math/private_cond2_2x2.h"
 #include "utility/oskar_cuda_mem_log.h"
@@ -56,8 +58,29 @@ extern "C" {
 static void* run_blocks(void* arg);
 static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
         int i_channel, int i_active, int device_id, int* status);
+static void evaluate_beam(oskar_BeamPattern* h, DeviceData* d,
+        oskar_Mem* beam, int i_station, int chunk_size, int slot, int cached,
+        int i_time, double freq_hz, double gast, int* status);
+static void evaluate_cached_station_beam(oskar_BeamPattern* h,
+        DeviceData* d, oskar_Mem* beam, int i_station, int chunk_size,
+        int slot, int cached, int i_time, double freq_hz, double gast,
+        int* status);
+static void set_up_tied_array(const oskar_BeamPattern* h, DeviceData* d,
+        int i_chunk, int chunk_size, int i_active, double gast,
+        double dir0[3], int* status);
+static void add_to_tied_array(const oskar_BeamPattern* h, DeviceData* d,
+        const oskar_Mem* beam, int i_station, int num_points, double freq_hz,
+        const double dir0[3], int i_active, int* status);
+static double normalisation_amp(DeviceData* d,
+        const oskar_Station* station, int i_time, double freq_hz,
+        double gast, int* status);
 static void write_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
         int i_channel, int i_active, int* status);
+static void write_power(oskar_BeamPattern* h, int i_chunk, int i_time,
+        int i_channel, int num_pix, int num_points, const oskar_Mem* in,
+        oskar_Mem* time_avg, oskar_Mem* channel_avg,
+        oskar_Mem* channel_and_time_avg, int chunk_desc, int stokes_in,
+        int* status);
 static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
         int i_channel, int num_pix, int channel_average, int time_average,
         const oskar_Mem* in, int chunk_desc, int stokes_in, int* status);
@@ -88,8 +111,7 @@ typedef struct ThreadArgs ThreadArgs;
 
 void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
 {
-    int i, num_threads;
-    oskar_Thread** threads = 0;
+    int i, num_threads, submit_error = 0;
     ThreadArgs* args = 0;
     if (*status || !h) return;
 
@@ -107,7 +129,20 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
     /* Set up worker threads. */
     num_threads = h->num_devices + 1;
     oskar_barrier_set_num_threads(h->barrier, num_threads);
-    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+    if (oskar_thread_pool_num_threads(h->thread_pool) != num_threads)
+    {
+        oskar_thread_pool_free(h->thread_pool);
+        h->thread_pool = oskar_thread_pool_create(num_threads);
+        if (h->num_cpu_ids > 0 && oskar_thread_pool_set_affinity(
+                h->thread_pool, h->num_cpu_ids, h->cpu_ids))
+            oskar_log_warning(h->log,
+                    "Unable to set the CPU affinity of worker threads.");
+    }
+    if (!h->thread_pool)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
     args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
     for (i = 0; i < num_threads; ++i)
     {
@@ -135,19 +170,18 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
 
     /* Start the worker threads. */
     for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+        if (oskar_thread_pool_submit(h->thread_pool, run_blocks,
+                (void*)&args[i]))
+            submit_error = 1;
 
     /* Wait for worker threads to finish. */
-    for (i = 0; i < num_threads; ++i)
-    {
-        oskar_thread_join(threads[i]);
-        oskar_thread_free(threads[i]);
-    }
-    free(threads);
+    oskar_thread_pool_wait(h->thread_pool);
     free(args);
 
     /* Get status code. */
     *status = h->status;
+    if (!*status && submit_error)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
 
     /* Record memory usage. */
     if (h->log && !*status)
@@ -262,8 +296,8 @@ static void* run_blocks(void* arg)
 static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
         int i_channel, int i_active, int device_id, int* status)
 {
-    int chunk_size, i_chunk, i;
-    double dt_dump, mjd, gast, freq_hz;
+    int chunk_size, i_chunk, i, c, slot = 0, cached = 0;
+    double dt_dump, mjd, gast, freq_hz, tied_dir[3];
     oskar_Mem *input_alias, *output_alias;
     DeviceData* d;
 
@@ -300,21 +334,38 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
                 i_chunk * h->max_chunk_size, chunk_size, status);
     }
 
+    /* Check if time-invariant beams for this chunk are already cached. */
+    if (d->jones_cache)
+    {
+        slot = (d->num_cache_slots == 1) ? 0 : i_channel;
+        cached = (d->cache_chunk[slot] == i_chunk &&
+                d->cache_channel[slot] == i_channel);
+    }
+
+    /* Clear the tied-array beam for this chunk, if required. */
+    if (h->tied_array)
+        set_up_tied_array(h, d, i_chunk, chunk_size, i_active, gast,
+                tied_dir, status);
+
     /* Generate beam for this pixel chunk, for all active stations. */
     input_alias  = oskar_mem_create_alias(0, 0, 0, status);
     output_alias = oskar_mem_create_alias(0, 0, 0, status);
-    for (i = 0; i < h->num_active_stations; ++i)
+    for (i = 0; i < h->num_active_stations && h->separate_station_beams; ++i)
     {
+        const int i_class = h->class_station[h->station_class[i]];
         oskar_mem_set_alias(input_alias, d->jones_data,
                 i * chunk_size, chunk_size, status);
         oskar_mem_set_alias(output_alias, d->jones_data,
                 i * chunk_size, chunk_size, status);
-        oskar_evaluate_station_beam(output_alias, chunk_size,
-                h->coord_type, d->x, d->y, d->z,
-                oskar_telescope_phase_centre_ra_rad(d->tel),
-                oskar_telescope_phase_centre_dec_rad(d->tel),
-                oskar_telescope_station_const(d->tel, h->station_ids[i]),
-                d->work, i_time, freq_hz, gast, status);
+        if (i_class != i)
+            oskar_mem_copy_contents(output_alias, d->jones_data,
+                    0, i_class * chunk_size, chunk_size, status);
+        else
+            evaluate_beam(h, d, output_alias, i, chunk_size,
+                    slot, cached, i_time, freq_hz, gast, status);
+        if (h->tied_array)
+            add_to_tied_array(h, d, output_alias, i, chunk_size, freq_hz,
+                    tied_dir, i_active, status);
         if (d->auto_power[I])
         {
             oskar_mem_set_alias(output_alias, d->auto_power[I],
@@ -339,11 +390,33 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
         }
 #endif
     }
+
+    /* If only the tied-array beam is needed, evaluate the beam for each
+     * class of station once, and add it for all stations in the class. */
+    for (c = 0; c < h->num_station_classes && !h->separate_station_beams; ++c)
+    {
+        oskar_mem_set_alias(output_alias, d->jones_data, 0, chunk_size,
+                status);
+        evaluate_beam(h, d, output_alias, h->class_station[c], chunk_size,
+                slot, cached, i_time, freq_hz, gast, status);
+        for (i = h->class_station[c]; i < h->num_active_stations; ++i)
+            if (h->station_class[i] == c)
+                add_to_tied_array(h, d, output_alias, i, chunk_size,
+                        freq_hz, tied_dir, i_active, status);
+    }
+    if (d->tied_power_cpu[I][i_active])
+        oskar_evaluate_auto_power(chunk_size, d->tied_jones_cpu[i_active],
+                d->tied_power_cpu[I][i_active], status);
     if (d->cross_power[I])
         oskar_evaluate_cross_power(chunk_size, h->num_active_stations,
                 d->jones_data, d->cross_power[I], status);
     oskar_mem_free(input_alias, status);
     oskar_mem_free(output_alias, status);
+    if (d->jones_cache && !*status)
+    {
+        d->cache_chunk[slot] = i_chunk;
+        d->cache_channel[slot] = i_channel;
+    }
 
     /* Copy the output data into host memory. */
     if (d->jones_data_cpu[i_active])
@@ -375,6 +448,238 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
 }
 
 
+static void evaluate_beam(oskar_BeamPattern* h, DeviceData* d,
+        oskar_Mem* beam, int i_station, int chunk_size, int slot, int cached,
+        int i_time, double freq_hz, double gast, int* status)
+{
+    if (d->jones_cache)
+        evaluate_cached_station_beam(h, d, beam, i_station, chunk_size,
+                slot, cached, i_time, freq_hz, gast, status);
+    else
+        oskar_evaluate_station_beam(beam, chunk_size,
+                h->coord_type, d->x, d->y, d->z,
+                oskar_telescope_phase_centre_ra_rad(d->tel),
+                oskar_telescope_phase_centre_dec_rad(d->tel),
+                oskar_telescope_station_const(d->tel,
+                        h->station_ids[i_station]),
+                d->work, i_time, freq_hz, gast, status);
+}
+
+
+/* Copies a station beam from the cache, evaluating it first if required.
+ * Only the normalisation can change in time, so the cached beam is
+ * rescaled by the ratio of the normalisation values. */
+static void evaluate_cached_station_beam(oskar_BeamPattern* h,
+        DeviceData* d, oskar_Mem* beam, int i_station, int chunk_size,
+        int slot, int cached, int i_time, double freq_hz, double gast,
+        int* status)
+{
+    double amp, *amp_cached;
+    oskar_Mem* cache_alias;
+    const oskar_Station* station;
+    if (*status) return;
+    station = oskar_telescope_station_const(d->tel, h->station_ids[i_station]);
+    amp = normalisation_amp(d, station, i_time, freq_hz, gast, status);
+    amp_cached = &d->cache_amp[slot * h->num_active_stations + i_station];
+    cache_alias = oskar_mem_create_alias(d->jones_cache,
+            slot * h->max_chunk_size * h->num_active_stations +
+            i_station * chunk_size, chunk_size, status);
+    if (!cached)
+    {
+        oskar_evaluate_station_beam(cache_alias, chunk_size,
+                h->coord_type, d->x, d->y, d->z,
+                oskar_telescope_phase_centre_ra_rad(d->tel),
+                oskar_telescope_phase_centre_dec_rad(d->tel),
+                station, d->work, i_time, freq_hz, gast, status);
+        *amp_cached = amp;
+    }
+    oskar_mem_copy_contents(beam, cache_alias, 0, 0, chunk_size, status);
+    if (amp != *amp_cached)
+        oskar_mem_scale_real(beam, *amp_cached / amp, status);
+    oskar_mem_free(cache_alias, status);
+}
+
+
+/* Returns the amplitude used to normalise the station beam at this time,
+ * which is the beam evaluated in the direction of the phase centre. */
+static double normalisation_amp(DeviceData* d,
+        const oskar_Station* station, int i_time, double freq_hz,
+        double gast, int* status)
+{
+    double ha0, c_x = 0.0, c_y = 0.0, c_z = 1.0, t_x, t_y, t_z;
+    if (*status || !oskar_station_normalise_final_beam(station) ||
+            oskar_station_type(station) == OSKAR_STATION_TYPE_ISOTROPIC)
+        return 1.0;
+
+    /* Evaluate the beam in the direction of the phase centre. */
+    ha0 = (gast + oskar_station_lon_rad(station)) -
+            oskar_telescope_phase_centre_ra_rad(d->tel);
+    oskar_convert_relative_directions_to_enu_directions_d(
+            &t_x, &t_y, &t_z, 1, &c_x, &c_y, &c_z, ha0,
+            oskar_telescope_phase_centre_dec_rad(d->tel),
+            oskar_station_lat_rad(station));
+    oskar_mem_set_element_real(d->norm_x, 0, t_x, status);
+    oskar_mem_set_element_real(d->norm_y, 0, t_y, status);
+    oskar_mem_set_element_real(d->norm_z, 0, t_z, status);
+    oskar_evaluate_station_beam_aperture_array(d->norm_beam, station, 1,
+            d->norm_x, d->norm_y, d->norm_z, gast, freq_hz, d->work,
+            i_time, status);
+
+    /* Convert to amplitude, as in oskar_evaluate_station_beam(). */
+    if (oskar_mem_is_matrix(d->norm_beam))
+    {
+        double4c val;
+        val = oskar_mem_get_element_matrix(d->norm_beam, 0, status);
+        return sqrt(0.5 * (val.a.x * val.a.x + val.a.y * val.a.y +
+                val.b.x * val.b.x + val.b.y * val.b.y +
+                val.c.x * val.c.x + val.c.y * val.c.y +
+                val.d.x * val.d.x + val.d.y * val.d.y));
+    }
+    else
+    {
+        double2 val;
+        val = oskar_mem_get_element_complex(d->norm_beam, 0, status);
+        return sqrt(val.x * val.x + val.y * val.y);
+    }
+}
+
+
+/* Clears the tied-array beam, and gets the ENU directions of the pixels
+ * in the chunk and of the tied-array pointing at the current time. */
+static void set_up_tied_array(const oskar_BeamPattern* h, DeviceData* d,
+        int i_chunk, int chunk_size, int i_active, double gast,
+        double dir0[3], int* status)
+{
+    int offset;
+    double ra0, dec0, lon, lat, c_x = 0.0, c_y = 0.0, c_z = 1.0;
+    if (*status) return;
+    oskar_mem_clear_contents(d->tied_jones_cpu[i_active], status);
+
+    /* Get the tied-array pointing direction. */
+    lon = oskar_telescope_lon_rad(h->tel);
+    lat = oskar_telescope_lat_rad(h->tel);
+    ra0 = oskar_telescope_phase_centre_ra_rad(h->tel);
+    dec0 = oskar_telescope_phase_centre_dec_rad(h->tel);
+    if (h->tied_array_pointing_set)
+        oskar_convert_relative_directions_to_enu_directions_d(
+                &dir0[0], &dir0[1], &dir0[2], 1, &c_x, &c_y, &c_z,
+                (gast + lon) - h->tied_array_ra_rad, h->tied_array_dec_rad,
+                lat);
+    else
+        oskar_convert_relative_directions_to_enu_directions_d(
+                &dir0[0], &dir0[1], &dir0[2], 1, &c_x, &c_y, &c_z,
+                (gast + lon) - ra0, dec0, lat);
+
+    /* Get the pixel directions from host memory. */
+    offset = i_chunk * h->max_chunk_size;
+    if (h->coord_type == OSKAR_ENU_DIRECTIONS)
+    {
+        oskar_mem_copy_contents(d->tied_x, h->x, 0, offset, chunk_size, status);
+        oskar_mem_copy_contents(d->tied_y, h->y, 0, offset, chunk_size, status);
+        oskar_mem_copy_contents(d->tied_z, h->z, 0, offset, chunk_size, status);
+    }
+    else
+    {
+        oskar_Mem *l, *m, *n;
+        l = oskar_mem_create_alias(h->x, offset, chunk_size, status);
+        m = oskar_mem_create_alias(h->y, offset, chunk_size, status);
+        n = oskar_mem_create_alias(h->z, offset, chunk_size, status);
+        oskar_convert_relative_directions_to_enu_directions(
+                d->tied_x, d->tied_y, d->tied_z, chunk_size, l, m, n,
+                (gast + lon) - ra0, dec0, lat, status);
+        oskar_mem_free(l, status);
+        oskar_mem_free(m, status);
+        oskar_mem_free(n, status);
+    }
+}
+
+
+/* Adds a weighted station beam to the tied-array beam, with the geometric
+ * phase of the station relative to the tied-array pointing direction. */
+static void add_to_tied_array(const oskar_BeamPattern* h, DeviceData* d,
+        const oskar_Mem* beam, int i_station, int num_points, double freq_hz,
+        const double dir0[3], int i_active, int* status)
+{
+    int i, j, id, num_pol;
+    double weight, wavenumber, u, v, w;
+    if (*status) return;
+
+    /* Copy the station beam to host memory if required. */
+    if (oskar_mem_location(beam) != OSKAR_CPU)
+    {
+        oskar_mem_copy_contents(d->tied_beam, beam, 0, 0, num_points, status);
+        beam = d->tied_beam;
+    }
+
+    /* Get the station weight and position in wavenumbers. */
+    id = h->station_ids[i_station];
+    weight = (h->num_tied_array_weights > 0) ?
+            h->tied_array_weights[i_station] : 1.0 / h->num_active_stations;
+    wavenumber = 2.0 * M_PI * freq_hz / 299792458.0;
+    u = wavenumber * oskar_mem_get_element(
+            oskar_telescope_station_true_x_enu_metres_const(h->tel),
+            id, status);
+    v = wavenumber * oskar_mem_get_element(
+            oskar_telescope_station_true_y_enu_metres_const(h->tel),
+            id, status);
+    w = wavenumber * oskar_mem_get_element(
+            oskar_telescope_station_true_z_enu_metres_const(h->tel),
+            id, status);
+    if (*status) return;
+
+    /* Add the phased beam, using the same phase for all polarisations. */
+    num_pol = oskar_mem_is_matrix(beam) ? 4 : 1;
+    if (oskar_mem_precision(beam) == OSKAR_DOUBLE)
+    {
+        double2* out;
+        const double2* in;
+        const double *x, *y, *z;
+        out = (double2*) oskar_mem_void(d->tied_jones_cpu[i_active]);
+        in = (const double2*) oskar_mem_void_const(beam);
+        x = oskar_mem_double_const(d->tied_x, status);
+        y = oskar_mem_double_const(d->tied_y, status);
+        z = oskar_mem_double_const(d->tied_z, status);
+        for (i = 0; i < num_points; ++i)
+        {
+            double phase, re, im;
+            phase = u * (x[i] - dir0[0]) + v * (y[i] - dir0[1]) +
+                    w * (z[i] - dir0[2]);
+            re = weight * cos(phase);
+            im = weight * sin(phase);
+            for (j = i * num_pol; j < (i + 1) * num_pol; ++j)
+            {
+                out[j].x += in[j].x * re - in[j].y * im;
+                out[j].y += in[j].x * im + in[j].y * re;
+            }
+        }
+    }
+    else
+    {
+        float2* out;
+        const float2* in;
+        const float *x, *y, *z;
+        out = (float2*) oskar_mem_void(d->tied_jones_cpu[i_active]);
+        in = (const float2*) oskar_mem_void_const(beam);
+        x = oskar_mem_float_const(d->tied_x, status);
+        y = oskar_mem_float_const(d->tied_y, status);
+        z = oskar_mem_float_const(d->tied_z, status);
+        for (i = 0; i < num_points; ++i)
+        {
+            float phase, re, im;
+            phase = (float) (u * (x[i] - dir0[0]) + v * (y[i] - dir0[1]) +
+                    w * (z[i] - dir0[2]));
+            re = (float) weight * cosf(phase);
+            im = (float) weight * sinf(phase);
+            for (j = i * num_pol; j < (i + 1) * num_pol; ++j)
+            {
+                out[j].x += in[j].x * re - in[j].y * im;
+                out[j].y += in[j].x * im + in[j].y * re;
+            }
+        }
+    }
+}
+
+
 static void write_chunks(oskar_BeamPattern* h, int i_chunk_start,
         int i_time, int i_channel, int i_active, int* status)
 {
@@ -400,136 +705,88 @@ static void write_chunks(oskar_BeamPattern* h, int i_chunk_start,
         /* Write non-averaged raw data, if required. */
         write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
                 d->jones_data_cpu[!i_active], JONES_DATA, -1, status);
+        write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
+                d->tied_jones_cpu[!i_active], TIED_ARRAY_JONES_DATA, -1,
+                status);
 
         /* Loop over Stokes parameters. */
         for (stokes = 0; stokes < 4; ++stokes)
         {
-            /* Write non-averaged data, if required. */
-            write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
-                    d->auto_power_cpu[stokes][!i_active],
+            write_power(h, i_chunk, i_time, i_channel, chunk_sources,
+                    chunk_size, d->auto_power_cpu[stokes][!i_active],
+                    d->auto_power_time_avg[stokes],
+                    d->auto_power_channel_avg[stokes],
+                    d->auto_power_channel_and_time_avg[stokes],
                     AUTO_POWER_DATA, stokes, status);
-            write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
-                    d->cross_power_cpu[stokes][!i_active],
+            write_power(h, i_chunk, i_time, i_channel, chunk_sources,
+                    chunk_sources, d->cross_power_cpu[stokes][!i_active],
+                    d->cross_power_time_avg[stokes],
+                    d->cross_power_channel_avg[stokes],
+                    d->cross_power_channel_and_time_avg[stokes],
                     CROSS_POWER_DATA, stokes, status);
+            write_power(h, i_chunk, i_time, i_channel, chunk_sources,
+                    chunk_sources, d->tied_power_cpu[stokes][!i_active],
+                    d->tied_power_time_avg[stokes],
+                    d->tied_power_channel_avg[stokes],
+                    d->tied_power_channel_and_time_avg[stokes],
+                    TIED_ARRAY_POWER_DATA, stokes, status);
+        }
+    }
+    oskar_timer_pause(h->tmr_write);
+}
 
-            /* Time-average the data if required. */
-            if (d->auto_power_time_avg[stokes])
-                oskar_mem_add(d->auto_power_time_avg[stokes],
-                        d->auto_power_time_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active], chunk_size,
-                        status);
-            if (d->cross_power_time_avg[stokes])
-                oskar_mem_add(d->cross_power_time_avg[stokes],
-                        d->cross_power_time_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active], chunk_sources,
-                        status);
-
-            /* Channel-average the data if required. */
-            if (d->auto_power_channel_avg[stokes])
-                oskar_mem_add(d->auto_power_channel_avg[stokes],
-                        d->auto_power_channel_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active], chunk_size,
-                        status);
-            if (d->cross_power_channel_avg[stokes])
-                oskar_mem_add(d->cross_power_channel_avg[stokes],
-                        d->cross_power_channel_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active], chunk_sources,
-                        status);
-
-            /* Channel- and time-average the data if required. */
-            if (d->auto_power_channel_and_time_avg[stokes])
-                oskar_mem_add(d->auto_power_channel_and_time_avg[stokes],
-                        d->auto_power_channel_and_time_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active], chunk_size,
-                        status);
-            if (d->cross_power_channel_and_time_avg[stokes])
-                oskar_mem_add(d->cross_power_channel_and_time_avg[stokes],
-                        d->cross_power_channel_and_time_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active], chunk_sources,
-                        status);
-
-            /* Write time-averaged data. */
-            if (i_time == h->num_time_steps - 1)
-            {
-                if (d->auto_power_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->auto_power_time_avg[stokes],
-                            1.0 / h->num_time_steps, status);
-                    write_pixels(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
-                            d->auto_power_time_avg[stokes],
-                            AUTO_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(d->auto_power_time_avg[stokes],
-                            status);
-                }
-                if (d->cross_power_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->cross_power_time_avg[stokes],
-                            1.0 / h->num_time_steps, status);
-                    write_pixels(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
-                            d->cross_power_time_avg[stokes],
-                            CROSS_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(d->cross_power_time_avg[stokes],
-                            status);
-                }
-            }
 
-            /* Write channel-averaged data. */
-            if (i_channel == h->num_channels - 1)
-            {
-                if (d->auto_power_channel_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->auto_power_channel_avg[stokes],
-                            1.0 / h->num_channels, status);
-                    write_pixels(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
-                            d->auto_power_channel_avg[stokes],
-                            AUTO_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(d->auto_power_channel_avg[stokes],
-                            status);
-                }
-                if (d->cross_power_channel_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->cross_power_channel_avg[stokes],
-                            1.0 / h->num_channels, status);
-                    write_pixels(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
-                            d->cross_power_channel_avg[stokes],
-                            CROSS_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(
-                            d->cross_power_channel_avg[stokes], status);
-                }
-            }
+/* Writes power data, and accumulates the averages over time and/or
+ * channel if required, writing them when they are complete. */
+static void write_power(oskar_BeamPattern* h, int i_chunk, int i_time,
+        int i_channel, int num_pix, int num_points, const oskar_Mem* in,
+        oskar_Mem* time_avg, oskar_Mem* channel_avg,
+        oskar_Mem* channel_and_time_avg, int chunk_desc, int stokes_in,
+        int* status)
+{
+    if (!in) return;
 
-            /* Write channel- and time-averaged data. */
-            if ((i_time == h->num_time_steps - 1) &&
-                    (i_channel == h->num_channels - 1))
-            {
-                if (d->auto_power_channel_and_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(
-                            d->auto_power_channel_and_time_avg[stokes],
-                            1.0 / (h->num_channels * h->num_time_steps), status);
-                    write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
-                            d->auto_power_channel_and_time_avg[stokes],
-                            AUTO_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(
-                            d->auto_power_channel_and_time_avg[stokes],
-                            status);
-                }
-                if (d->cross_power_channel_and_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(
-                            d->cross_power_channel_and_time_avg[stokes],
-                            1.0 / (h->num_channels * h->num_time_steps), status);
-                    write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
-                            d->cross_power_channel_and_time_avg[stokes],
-                            CROSS_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(
-                            d->cross_power_channel_and_time_avg[stokes],
-                            status);
-                }
-            }
-        }
+    /* Write non-averaged data, if required. */
+    write_pixels(h, i_chunk, i_time, i_channel, num_pix, 0, 0,
+            in, chunk_desc, stokes_in, status);
+
+    /* Accumulate the averages if required. */
+    if (time_avg)
+        oskar_mem_add(time_avg, time_avg, in, num_points, status);
+    if (channel_avg)
+        oskar_mem_add(channel_avg, channel_avg, in, num_points, status);
+    if (channel_and_time_avg)
+        oskar_mem_add(channel_and_time_avg, channel_and_time_avg, in,
+                num_points, status);
+
+    /* Write time-averaged data. */
+    if (time_avg && i_time == h->num_time_steps - 1)
+    {
+        oskar_mem_scale_real(time_avg, 1.0 / h->num_time_steps, status);
+        write_pixels(h, i_chunk, 0, i_channel, num_pix, 0, 1,
+                time_avg, chunk_desc, stokes_in, status);
+        oskar_mem_clear_contents(time_avg, status);
+    }
+
+    /* Write channel-averaged data. */
+    if (channel_avg && i_channel == h->num_channels - 1)
+    {
+        oskar_mem_scale_real(channel_avg, 1.0 / h->num_channels, status);
+        write_pixels(h, i_chunk, i_time, 0, num_pix, 1, 0,
+                channel_avg, chunk_desc, stokes_in, status);
+        oskar_mem_clear_contents(channel_avg, status);
+    }
+
+    /* Write channel- and time-averaged data. */
+    if (channel_and_time_avg && (i_time == h->num_time_steps - 1) &&
+            (i_channel == h->num_channels - 1))
+    {
+        oskar_mem_scale_real(channel_and_time_avg,
+                1.0 / (h->num_channels * h->num_time_steps), status);
+        write_pixels(h, i_chunk, 0, 0, num_pix, 1, 1,
+                channel_and_time_avg, chunk_desc, stokes_in, status);
+        oskar_mem_clear_contents(channel_and_time_avg, status);
     }
-    oskar_timer_pause(h->tmr_write);
 }
 
 
@@ -571,8 +828,10 @@ static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
             oskar_mem_free(station_data, status);
             continue;
         }
-        if (dp == CROSS_POWER_RAW_COMPLEX &&
-                chunk_desc == CROSS_POWER_DATA && t)
+        if ((dp == CROSS_POWER_RAW_COMPLEX &&
+                chunk_desc == CROSS_POWER_DATA && t) ||
+                (dp == TIED_ARRAY_RAW_COMPLEX &&
+                chunk_desc == TIED_ARRAY_JONES_DATA && t))
         {
             oskar_mem_save_ascii(t, 1, num_pix, status, in);
             continue;
@@ -609,15 +868,19 @@ static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
         else if (chunk_desc == JONES_DATA && dp == IXR)
             jones_to_ixr(in, i_station * num_pix, num_pix, h->pix, status);
         else if (chunk_desc == AUTO_POWER_DATA ||
-                chunk_desc == CROSS_POWER_DATA)
+                chunk_desc == CROSS_POWER_DATA ||
+                chunk_desc == TIED_ARRAY_POWER_DATA)
         {
             off = i_station * num_pix; /* Station offset. */
-            if (off < 0 || chunk_desc == CROSS_POWER_DATA) off = 0;
+            if (off < 0 || chunk_desc != AUTO_POWER_DATA) off = 0;
             if (chunk_desc == CROSS_POWER_DATA && dp == AUTO_POWER)
                 continue;
             if (chunk_desc == AUTO_POWER_DATA &&
                     (dp == CROSS_POWER_AMP || dp == CROSS_POWER_PHASE))
                 continue;
+            if ((chunk_desc == TIED_ARRAY_POWER_DATA) !=
+                    (dp == TIED_ARRAY_POWER))
+                continue;
             if (stokes_out == I)
                 power_to_stokes_I(in, off, num_pix, h->ctemp, status);
             else if (stokes_out == Q)
@@ -627,7 +890,8 @@ static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
             else if (stokes_out == V)
                 power_to_stokes_V(in, off, num_pix, h->ctemp, status);
             else continue;
-            if (dp == AUTO_POWER || dp == CROSS_POWER_AMP)
+            if (dp == AUTO_POWER || dp == CROSS_POWER_AMP ||
+                    dp == TIED_ARRAY_POWER)
                 complex_to_amp(h->ctemp, 0, 1, num_pix, h->pix, status);
             else if (dp == CROSS_POWER_PHASE)
                 complex_to_phase(h->ctemp, 0, 1, num_pix, h->pix, status);
@@ -30,6 +30,7 @@
 #include "beam_pattern/private_beam_pattern_free_device_data.h"
 #include "utility/oskar_device_utils.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef __cplusplus
@@ -65,7 +66,26 @@ void oskar_beam_pattern_free_device_data(oskar_BeamPattern* h, int* status)
             oskar_mem_free(d->cross_power_channel_avg[j], status);
             oskar_mem_free(d->cross_power_channel_and_time_avg[j], status);
             oskar_mem_free(d->cross_power[j], status);
+            oskar_mem_free(d->tied_power_cpu[j][0], status);
+            oskar_mem_free(d->tied_power_cpu[j][1], status);
+            oskar_mem_free(d->tied_power_time_avg[j], status);
+            oskar_mem_free(d->tied_power_channel_avg[j], status);
+            oskar_mem_free(d->tied_power_channel_and_time_avg[j], status);
         }
+        oskar_mem_free(d->tied_jones_cpu[0], status);
+        oskar_mem_free(d->tied_jones_cpu[1], status);
+        oskar_mem_free(d->tied_beam, status);
+        oskar_mem_free(d->tied_x, status);
+        oskar_mem_free(d->tied_y, status);
+        oskar_mem_free(d->tied_z, status);
+        oskar_mem_free(d->jones_cache, status);
+        oskar_mem_free(d->norm_beam, status);
+        oskar_mem_free(d->norm_x, status);
+        oskar_mem_free(d->norm_y, status);
+        oskar_mem_free(d->norm_z, status);
+        free(d->cache_chunk);
+        free(d->cache_channel);
+        free(d->cache_amp);
         oskar_telescope_free(d->tel, status);
         oskar_station_work_free(d->work, status);
         oskar_timer_free(d->tmr_compute);
@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "beam_pattern/oskar_beam_pattern.h"
+#include "beam_pattern/private_beam_pattern.h"
+#include "convert/oskar_convert_mjd_to_gast_fast.h"
+#include "convert/oskar_convert_relative_directions_to_enu_directions.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#define D2R (M_PI / 180.0)
+
+static const double lat_rad = -30.0 * D2R;
+static const double mjd_start = 57000.0;
+static const int num_stations = 3;
+
+static oskar_Telescope* create_telescope(double gain_error, int* status)
+{
+    // Create stations of dipoles with different layouts, fixed in
+    // azimuth and elevation.
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_stations, status);
+    srand(2);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        const int num_elements = 16;
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        oskar_station_resize(s, num_elements, status);
+        oskar_station_resize_element_types(s, 1, status);
+        oskar_element_set_element_type(oskar_station_element(s, 0),
+                "Dipole", status);
+        oskar_station_set_position(s, 1e-4 * i, lat_rad, 0.0);
+        oskar_station_set_normalise_final_beam(s, 1);
+        for (int j = 0; j < num_elements; ++j)
+        {
+            double enu[3];
+            enu[0] = 10.0 * ((double)rand() / RAND_MAX - 0.5);
+            enu[1] = 10.0 * ((double)rand() / RAND_MAX - 0.5);
+            enu[2] = 0.0;
+            oskar_station_set_element_coords(s, j, enu, enu, status);
+            oskar_station_set_element_errors(s, j,
+                    1.0 + 0.01 * j, gain_error, 0.5 * j, 0.0, status);
+        }
+    }
+    oskar_telescope_set_station_ids(tel);
+
+    // Put the phase centre (used for normalisation) near the zenith.
+    oskar_telescope_set_phase_centre(tel, OSKAR_SPHERICAL_TYPE_EQUATORIAL,
+            oskar_convert_mjd_to_gast_fast(mjd_start), lat_rad);
+    for (int i = 0; i < num_stations; ++i)
+        oskar_station_set_phase_centre(oskar_telescope_station(tel, i),
+                OSKAR_SPHERICAL_TYPE_AZEL, 30.0 * D2R, 60.0 * D2R);
+    oskar_telescope_analyse(tel, status);
+    return tel;
+}
+
+static oskar_BeamPattern* create_beam_pattern(const oskar_Telescope* tel,
+        const char* root_path, int* status)
+{
+    const int ids[] = {0, 1, 2};
+    oskar_BeamPattern* h = oskar_beam_pattern_create(OSKAR_DOUBLE, status);
+    oskar_beam_pattern_set_num_devices(h, 1);
+    oskar_beam_pattern_set_coordinate_frame(h, 'H');
+    oskar_beam_pattern_set_image_size(h, 9, 9);
+    oskar_beam_pattern_set_max_chunk_size(h, 50);
+    oskar_beam_pattern_set_observation_time(h, mjd_start, 1800.0, 3);
+    oskar_beam_pattern_set_observation_frequency(h, 100e6, 5e6, 2);
+    oskar_beam_pattern_set_station_ids(h, num_stations, ids);
+    oskar_beam_pattern_set_telescope_model(h, tel, status);
+    oskar_beam_pattern_set_root_path(h, root_path);
+    oskar_beam_pattern_set_voltage_raw_text(h, 1);
+    return h;
+}
+
+static std::string station_file(const char* root_path, int station)
+{
+    char buf[32];
+    sprintf(buf, "_S%04d", station);
+    return std::string(root_path) + buf +
+            "_TIME_SEP_CHAN_SEP_RAW_COMPLEX.txt";
+}
+
+static std::vector<double> read_values(const std::string& filename)
+{
+    // Read all numbers from the file, skipping comment lines.
+    std::vector<double> values;
+    FILE* f = fopen(filename.c_str(), "r");
+    if (!f) return values;
+    char line[1024];
+    while (fgets(line, sizeof(line), f))
+    {
+        if (line[0] == '#') continue;
+        char *p = line, *end = 0;
+        for (double val = strtod(p, &end); end != p; val = strtod(p, &end))
+        {
+            values.push_back(val);
+            p = end;
+        }
+    }
+    fclose(f);
+    return values;
+}
+
+// Pixels in the corners of the all-sky image are not valid directions,
+// and are written as NaN.
+static bool is_nan(double val)
+{
+    return val != val;
+}
+
+static void check_same(const std::vector<double>& a,
+        const std::vector<double>& b)
+{
+    double diff = 0.0, max_abs = 0.0;
+    ASSERT_EQ(a.size(), b.size());
+    ASSERT_GT(a.size(), 0u);
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        ASSERT_EQ(is_nan(a[i]), is_nan(b[i])) << "At index " << i;
+        if (is_nan(a[i])) continue;
+        if (fabs(a[i] - b[i]) > diff) diff = fabs(a[i] - b[i]);
+        if (fabs(a[i]) > max_abs) max_abs = fabs(a[i]);
+    }
+    EXPECT_GT(max_abs, 0.0);
+    EXPECT_LT(diff, 1e-10 * max_abs);
+}
+
+TEST(beam_pattern, time_invariant_beams_match_direct_evaluation)
+{
+    int status = 0;
+    const char* root[] = {"temp_test_beam_pattern_cached",
+            "temp_test_beam_pattern_direct"};
+    oskar_Telescope* tel = create_telescope(0.0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Evaluate the beams with and without the per-channel cache.
+    for (int i = 0; i < 2; ++i)
+    {
+        oskar_BeamPattern* h = create_beam_pattern(tel, root[i], &status);
+        oskar_beam_pattern_set_cache_time_invariant_beams(h, i == 0);
+        oskar_beam_pattern_check_init(h, &status);
+        EXPECT_EQ(i == 0, h->time_invariant);
+        oskar_beam_pattern_run(h, &status);
+        oskar_beam_pattern_free(h, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+
+    // Compare the station beams at all times and channels.
+    for (int i = 0; i < num_stations; ++i)
+    {
+        check_same(read_values(station_file(root[0], i)),
+                read_values(station_file(root[1], i)));
+        remove(station_file(root[0], i).c_str());
+        remove(station_file(root[1], i).c_str());
+    }
+    oskar_telescope_free(tel, &status);
+}
+
+TEST(beam_pattern, time_variable_errors_disable_beam_cache)
+{
+    int status = 0;
+    const char* root = "temp_test_beam_pattern_errors";
+
+    // Check the cache is used without time-variable errors.
+    oskar_Telescope* tel = create_telescope(0.0, &status);
+    oskar_BeamPattern* h = create_beam_pattern(tel, root, &status);
+    oskar_beam_pattern_check_init(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_TRUE(h->time_invariant);
+    oskar_beam_pattern_free(h, &status);
+    oskar_telescope_free(tel, &status);
+
+    // Check the cache is not used with time-variable errors.
+    tel = create_telescope(0.1, &status);
+    h = create_beam_pattern(tel, root, &status);
+    oskar_beam_pattern_check_init(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_FALSE(h->time_invariant);
+
+    // Check the beams change in time.
+    oskar_beam_pattern_run(h, &status);
+    oskar_beam_pattern_free(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    // The first chunk of 50 pixels is written for each time and channel.
+    std::vector<double> values = read_values(station_file(root, 0));
+    ASSERT_EQ(0u, values.size() % (81 * 3 * 2));
+    const size_t chunk = 50 * (values.size() / (81 * 3 * 2));
+    double diff = 0.0;
+    for (size_t i = 0; i < chunk; ++i)
+        if (!is_nan(values[i]))
+            diff += fabs(values[i] - values[i + 2 * chunk]);
+    EXPECT_GT(diff, 0.0);
+    for (int i = 0; i < num_stations; ++i)
+        remove(station_file(root, i).c_str());
+    oskar_telescope_free(tel, &status);
+}
+
+static oskar_Telescope* create_tied_array_telescope(int num, int* status)
+{
+    // Create stations with two different layouts at the same longitude
+    // and latitude, so that the beam of each layout is evaluated once.
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num, status);
+    oskar_Mem *x, *y, *z, *err;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num, status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num, status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num, status);
+    err = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num, status);
+    oskar_mem_clear_contents(z, status);
+    oskar_mem_clear_contents(err, status);
+    srand(3);
+    for (int i = 0; i < num; ++i)
+    {
+        oskar_mem_set_element_real(x, i,
+                60.0 * ((double)rand() / RAND_MAX - 0.5), status);
+        oskar_mem_set_element_real(y, i,
+                60.0 * ((double)rand() / RAND_MAX - 0.5), status);
+    }
+    oskar_telescope_set_station_coords_enu(tel, 0.0, lat_rad, 0.0, num,
+            x, y, z, err, err, err, status);
+    for (int i = 0; i < num; ++i)
+    {
+        const int num_elements = 16;
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        oskar_station_resize(s, num_elements, status);
+        oskar_station_resize_element_types(s, 1, status);
+        oskar_element_set_element_type(oskar_station_element(s, 0),
+                "Dipole", status);
+        oskar_station_set_position(s, 0.0, lat_rad, 0.0);
+        srand(4 + (i % 2));
+        for (int j = 0; j < num_elements; ++j)
+        {
+            double enu[3];
+            enu[0] = 10.0 * ((double)rand() / RAND_MAX - 0.5);
+            enu[1] = 10.0 * ((double)rand() / RAND_MAX - 0.5);
+            enu[2] = 0.0;
+            oskar_station_set_element_coords(s, j, enu, enu, status);
+        }
+    }
+    oskar_telescope_set_phase_centre(tel, OSKAR_SPHERICAL_TYPE_EQUATORIAL,
+            oskar_convert_mjd_to_gast_fast(mjd_start) + 0.1, lat_rad + 0.1);
+    oskar_telescope_set_allow_station_beam_duplication(tel, OSKAR_TRUE);
+    oskar_telescope_analyse(tel, status);
+    oskar_mem_free(x, status);
+    oskar_mem_free(y, status);
+    oskar_mem_free(z, status);
+    oskar_mem_free(err, status);
+    return tel;
+}
+
+TEST(beam_pattern, tied_array_matches_weighted_sum_of_station_beams)
+{
+    int status = 0;
+    const int num = 4, ids[] = {0, 1, 2, 3};
+    const double weights[] = {0.1, 0.2, 0.3, 0.4}, freq_hz = 100e6;
+    const double inc_sec = 600.0;
+    const char* root[] = {"temp_test_beam_pattern_tied_separate",
+            "temp_test_beam_pattern_tied_classes"};
+    const std::string tied = "_TIME_SEP_CHAN_SEP_TIED_ARRAY_RAW_COMPLEX.txt";
+    std::vector<double> pix_x, pix_y, pix_z;
+    oskar_Telescope* tel = create_tied_array_telescope(num, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_FALSE(oskar_telescope_identical_stations(tel));
+
+    // Form the tied-array beam from the separate station beams, and
+    // from the beam of each class of station.
+    for (int i = 0; i < 2; ++i)
+    {
+        oskar_BeamPattern* h = oskar_beam_pattern_create(OSKAR_DOUBLE,
+                &status);
+        oskar_beam_pattern_set_num_devices(h, 1);
+        oskar_beam_pattern_set_coordinate_frame(h, 'H');
+        oskar_beam_pattern_set_image_size(h, 9, 9);
+        oskar_beam_pattern_set_max_chunk_size(h, 50);
+        oskar_beam_pattern_set_observation_time(h, mjd_start, inc_sec, 1);
+        oskar_beam_pattern_set_observation_frequency(h, freq_hz, 0.0, 1);
+        oskar_beam_pattern_set_station_ids(h, num, ids);
+        oskar_beam_pattern_set_telescope_model(h, tel, &status);
+        oskar_beam_pattern_set_root_path(h, root[i]);
+        oskar_beam_pattern_set_tied_array_weights(h, num, weights);
+        oskar_beam_pattern_set_tied_array_raw_text(h, 1);
+        oskar_beam_pattern_set_voltage_raw_text(h, i == 0);
+        if (i == 1)
+        {
+            // Binding the worker threads must not change the results.
+            const int cpu_ids[] = {0};
+            oskar_beam_pattern_set_cpu_affinity(h, 1, cpu_ids);
+        }
+        oskar_beam_pattern_check_init(h, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_EQ(i == 0, h->separate_station_beams);
+        EXPECT_EQ(2, h->num_station_classes);
+        if (i == 0)
+        {
+            // Get the pixel directions in the horizon frame.
+            for (int j = 0; j < h->num_pixels; ++j)
+            {
+                pix_x.push_back(oskar_mem_get_element(h->x, j, &status));
+                pix_y.push_back(oskar_mem_get_element(h->y, j, &status));
+                pix_z.push_back(oskar_mem_get_element(h->z, j, &status));
+            }
+        }
+        oskar_beam_pattern_run(h, &status);
+        oskar_beam_pattern_free(h, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+
+    // Get the tied-array pointing direction at the centre of the time step.
+    double dir0[3], c_x = 0.0, c_y = 0.0, c_z = 1.0;
+    const double gast = oskar_convert_mjd_to_gast_fast(
+            mjd_start + 0.5 * inc_sec / 86400.0);
+    oskar_convert_relative_directions_to_enu_directions_d(
+            &dir0[0], &dir0[1], &dir0[2], 1, &c_x, &c_y, &c_z,
+            gast + oskar_telescope_lon_rad(tel) -
+            oskar_telescope_phase_centre_ra_rad(tel),
+            oskar_telescope_phase_centre_dec_rad(tel),
+            oskar_telescope_lat_rad(tel));
+
+    // Sum the weighted station beams, with the geometric phase of each.
+    const size_t num_pixels = pix_x.size();
+    std::vector<double> expected(8 * num_pixels, 0.0);
+    const double k = 2.0 * M_PI * freq_hz / 299792458.0;
+    for (int i = 0; i < num; ++i)
+    {
+        std::vector<double> beam = read_values(station_file(root[0], i));
+        ASSERT_EQ(expected.size(), beam.size());
+        const double u = k * oskar_mem_get_element(
+                oskar_telescope_station_true_x_enu_metres_const(tel), i,
+                &status);
+        const double v = k * oskar_mem_get_element(
+                oskar_telescope_station_true_y_enu_metres_const(tel), i,
+                &status);
+        const double w = k * oskar_mem_get_element(
+                oskar_telescope_station_true_z_enu_metres_const(tel), i,
+                &status);
+        for (size_t p = 0; p < num_pixels; ++p)
+        {
+            const double phase = u * (pix_x[p] - dir0[0]) +
+                    v * (pix_y[p] - dir0[1]) + w * (pix_z[p] - dir0[2]);
+            const double re = weights[i] * cos(phase);
+            const double im = weights[i] * sin(phase);
+            for (size_t j = 8 * p; j < 8 * (p + 1); j += 2)
+            {
+                expected[j] += beam[j] * re - beam[j + 1] * im;
+                expected[j + 1] += beam[j] * im + beam[j + 1] * re;
+            }
+        }
+        remove(station_file(root[0], i).c_str());
+    }
+
+    // Check both tied-array beams against the explicit sum.
+    for (int i = 0; i < 2; ++i)
+    {
+        const std::string filename = std::string(root[i]) + tied;
+        check_same(expected, read_values(filename));
+        remove(filename.c_str());
+    }
+    oskar_telescope_free(tel, &status);
+}
@@ -54,6 +54,13 @@ extern "C" {
  * The Jones matrices should have dimensions corresponding to the number of
  * sources in the brightness matrix and the number of stations.
  *
+ * On the CPU, if bandwidth and time-average smearing are both disabled,
+ * point sources are correlated using a matrix-matrix product.
+ *
+ * If \p baseline_mask is given, the visibilities on baselines where it is
+ * zero are not updated when correlating on the CPU. The mask is ignored
+ * on other devices, where all baselines are evaluated.
+ *
  * @param[out] vis          Output visibility amplitudes.
  * @param[in]  n_sources    Number of sources to use.
  * @param[in]  jones        Set of Jones matrices.
@@ -62,6 +69,7 @@ extern "C" {
  * @param[in]  u            Station u coordinates, in metres.
  * @param[in]  v            Station v coordinates, in metres.
  * @param[in]  w            Station w coordinates, in metres.
+ * @param[in]  baseline_mask Integer flag per baseline to evaluate, or NULL.
  * @param[in]  gast         Greenwich apparent sidereal time, in radians.
  * @param[in]  frequency_hz Current observation frequency, in Hz.
  * @param[in,out] status    Status return code.
@@ -70,7 +78,8 @@ OSKAR_EXPORT
 void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
         const oskar_Jones* jones, const oskar_Sky* sky,
         const oskar_Telescope* tel, const oskar_Mem* u, const oskar_Mem* v,
-        const oskar_Mem* w, double gast, double frequency_hz, int* status);
+        const oskar_Mem* w, const oskar_Mem* baseline_mask, double gast,
+        double frequency_hz, int* status);
 
 #ifdef __cplusplus
 }
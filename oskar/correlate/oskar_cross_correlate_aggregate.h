@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_CROSS_CORRELATE_AGGREGATE_H_
+#define OSKAR_CROSS_CORRELATE_AGGREGATE_H_
+
+/**
+ * @file oskar_cross_correlate_aggregate.h
+ */
+
+#include <oskar_global.h>
+#include <correlate/oskar_source_tree.h>
+#include <interferometer/oskar_jones.h>
+#include <sky/oskar_sky.h>
+#include <telescope/oskar_telescope.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Cross-correlates point sources using hierarchical source aggregation.
+ *
+ * @details
+ * This function forms visibilities for stations with identical beams,
+ * using a spatial tree of the sources (built with oskar_source_tree_build())
+ * to avoid summing each source individually on short baselines.
+ *
+ * The apparent brightness E B E^H of each source is evaluated once using
+ * the beam of the first station, and the monopole, dipole and quadrupole
+ * moments of the apparent brightness about the flux-weighted centroid of
+ * each cell in the tree are accumulated.
+ *
+ * On each baseline, the tree is traversed from the root, and the second-order
+ * expansion of the fringe phase about the cell centroid is used for a cell if
+ * the truncation error, (2 pi |uvw| r)^3 / 6, is less than the tolerance,
+ * where r is the cell radius and |uvw| is the baseline length in
+ * wavelengths. Otherwise the children of the cell are visited,
+ * or, for a leaf cell, its sources are summed directly. The tolerance
+ * is therefore a bound on the error relative to the total apparent flux
+ * in each aggregated cell. A tolerance of zero gives the direct sum.
+ *
+ * Smearing terms are not evaluated, and only point sources are supported.
+ *
+ * The visibilities are accumulated into the output array.
+ * If \p baseline_mask is given, baselines where it is zero are skipped.
+ *
+ * @param[in,out] vis          Output visibilities, in CPU memory.
+ * @param[in] n_sources        Number of sources to use.
+ * @param[in] beam             Station beam Jones matrices (station 0 is used).
+ * @param[in,out] tree         Source tree built for the same sources.
+ * @param[in] sky              Sky model.
+ * @param[in] tel              Telescope model.
+ * @param[in] u                Station u-coordinates, in metres.
+ * @param[in] v                Station v-coordinates, in metres.
+ * @param[in] w                Station w-coordinates, in metres.
+ * @param[in] baseline_mask    Integer flag per baseline to evaluate, or NULL.
+ * @param[in] frequency_hz     Current observing frequency, in Hz.
+ * @param[in] source_min_jy    Minimum Stokes I flux of sources to include.
+ * @param[in] source_max_jy    Maximum Stokes I flux of sources to include.
+ * @param[in] tolerance        Maximum relative error allowed in a cell.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_aggregate(oskar_Mem* vis, int n_sources,
+        const oskar_Jones* beam, oskar_SourceTree* tree, const oskar_Sky* sky,
+        const oskar_Telescope* tel, const oskar_Mem* u, const oskar_Mem* v,
+        const oskar_Mem* w, const oskar_Mem* baseline_mask,
+        double frequency_hz, double source_min_jy, double source_max_jy,
+        double tolerance, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_CROSS_CORRELATE_AGGREGATE_H_ */
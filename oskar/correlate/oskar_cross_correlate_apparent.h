@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_CROSS_CORRELATE_APPARENT_H_
+#define OSKAR_CROSS_CORRELATE_APPARENT_H_
+
+/**
+ * @file oskar_cross_correlate_apparent.h
+ */
+
+#include <oskar_global.h>
+#include <interferometer/oskar_jones.h>
+#include <sky/oskar_sky.h>
+#include <telescope/oskar_telescope.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Cross-correlates sources seen by stations with identical beams.
+ *
+ * @details
+ * This function forms the same visibilities as oskar_cross_correlate(),
+ * but for stations with identical beams, so that the visibility on
+ * baseline p-q is the sum over sources of K_p K_q^* (E B E^H).
+ *
+ * The apparent brightness E B E^H of each source is evaluated once using
+ * the beam of the first station. As it is Hermitian, only four real values
+ * are stored per source, and the work on each baseline reduces to scaling
+ * it by the complex phase factor K_p K_q^* and any smearing terms.
+ *
+ * The interferometer phase K is supplied separately from the station beam,
+ * and should have been evaluated using oskar_evaluate_jones_K() for the
+ * same station coordinates, frequency and source flux range.
+ *
+ * Bandwidth and time-average smearing and Gaussian sources are supported.
+ *
+ * The visibilities are accumulated into the output array.
+ * If \p baseline_mask is given, baselines where it is zero are skipped.
+ *
+ * @param[in,out] vis       Output visibilities, in CPU memory.
+ * @param[in] n_sources     Number of sources to use.
+ * @param[in] beam          Station beam Jones matrices (station 0 is used).
+ * @param[in] K             Interferometer phase Jones scalars.
+ * @param[in] sky           Sky model.
+ * @param[in] tel           Telescope model.
+ * @param[in] u             Station u-coordinates, in metres.
+ * @param[in] v             Station v-coordinates, in metres.
+ * @param[in] w             Station w-coordinates, in metres.
+ * @param[in] baseline_mask Integer flag per baseline to evaluate, or NULL.
+ * @param[in] gast          Greenwich apparent sidereal time, in radians.
+ * @param[in] frequency_hz  Current observing frequency, in Hz.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_apparent(oskar_Mem* vis, int n_sources,
+        const oskar_Jones* beam, const oskar_Jones* K, const oskar_Sky* sky,
+        const oskar_Telescope* tel, const oskar_Mem* u, const oskar_Mem* v,
+        const oskar_Mem* w, const oskar_Mem* baseline_mask, double gast,
+        double frequency_hz, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_CROSS_CORRELATE_APPARENT_H_ */
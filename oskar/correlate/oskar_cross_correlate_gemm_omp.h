@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_CROSS_CORRELATE_GEMM_OMP_H_
+#define OSKAR_CROSS_CORRELATE_GEMM_OMP_H_
+
+/**
+ * @file oskar_cross_correlate_gemm_omp.h
+ */
+
+#include <oskar_global.h>
+#include <utility/oskar_vector_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Correlate function for unsmeared point sources, using a matrix-matrix
+ * product (single precision).
+ *
+ * @details
+ * Forms visibilities on all baselines by evaluating the upper triangle of
+ * the product J B J^H, where J is the (2 * num_stations) by
+ * (2 * num_sources) complex matrix of station Jones matrices and B is
+ * the block-diagonal matrix of source brightness matrices.
+ *
+ * The brightness matrices are applied once per station and source, and
+ * the product is then accumulated over tiles of sources using a
+ * cache- and register-blocked kernel, or as a Hermitian rank-k update
+ * using a BLAS library if OSKAR was built with one.
+ *
+ * This function gives the same result as oskar_cross_correlate_point_omp_f()
+ * when bandwidth and time-average smearing are both disabled.
+ *
+ * @param[in] num_sources    Number of sources.
+ * @param[in] num_stations   Number of stations.
+ * @param[in] jones          Matrix of Jones matrices to correlate.
+ * @param[in] I              Source Stokes I values, in Jy.
+ * @param[in] Q              Source Stokes Q values, in Jy.
+ * @param[in] U              Source Stokes U values, in Jy.
+ * @param[in] V              Source Stokes V values, in Jy.
+ * @param[in] station_u      Station u-coordinates, in metres.
+ * @param[in] station_v      Station v-coordinates, in metres.
+ * @param[in] uv_min_lambda  Minimum allowed UV length, in wavelengths.
+ * @param[in] uv_max_lambda  Maximum allowed UV length, in wavelengths.
+ * @param[in] inv_wavelength Inverse of the wavelength, in metres.
+ * @param[in] baseline_mask  If set, baselines with a zero value are skipped.
+ * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_point_gemm_omp_f(
+        int num_sources, int num_stations, const float4c* jones,
+        const float* I, const float* Q, const float* U, const float* V,
+        const float* station_u, const float* station_v,
+        float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
+        const int* baseline_mask, float4c* vis, int* status);
+
+/**
+ * @brief
+ * Correlate function for unsmeared point sources, using a matrix-matrix
+ * product (double precision).
+ *
+ * @details
+ * Forms visibilities on all baselines by evaluating the upper triangle of
+ * the product J B J^H, where J is the (2 * num_stations) by
+ * (2 * num_sources) complex matrix of station Jones matrices and B is
+ * the block-diagonal matrix of source brightness matrices.
+ *
+ * The brightness matrices are applied once per station and source, and
+ * the product is then accumulated over tiles of sources using a
+ * cache- and register-blocked kernel, or as a Hermitian rank-k update
+ * using a BLAS library if OSKAR was built with one.
+ *
+ * This function gives the same result as oskar_cross_correlate_point_omp_d()
+ * when bandwidth and time-average smearing are both disabled.
+ *
+ * @param[in] num_sources    Number of sources.
+ * @param[in] num_stations   Number of stations.
+ * @param[in] jones          Matrix of Jones matrices to correlate.
+ * @param[in] I              Source Stokes I values, in Jy.
+ * @param[in] Q              Source Stokes Q values, in Jy.
+ * @param[in] U              Source Stokes U values, in Jy.
+ * @param[in] V              Source Stokes V values, in Jy.
+ * @param[in] station_u      Station u-coordinates, in metres.
+ * @param[in] station_v      Station v-coordinates, in metres.
+ * @param[in] uv_min_lambda  Minimum allowed UV length, in wavelengths.
+ * @param[in] uv_max_lambda  Maximum allowed UV length, in wavelengths.
+ * @param[in] inv_wavelength Inverse of the wavelength, in metres.
+ * @param[in] baseline_mask  If set, baselines with a zero value are skipped.
+ * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_point_gemm_omp_d(
+        int num_sources, int num_stations, const double4c* jones,
+        const double* I, const double* Q, const double* U, const double* V,
+        const double* station_u, const double* station_v,
+        double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
+        const int* baseline_mask, double4c* vis, int* status);
+
+/**
+ * @brief
+ * Correlate function for unsmeared point sources, scalar version, using a
+ * matrix-matrix product (single precision).
+ *
+ * @details
+ * Forms visibilities on all baselines by evaluating the upper triangle of
+ * the product J diag(I) J^H, where J is the num_stations by num_sources
+ * complex matrix of station Jones scalars.
+ *
+ * @param[in] num_sources    Number of sources.
+ * @param[in] num_stations   Number of stations.
+ * @param[in] jones          Matrix of Jones scalars to correlate.
+ * @param[in] I              Source Stokes I values, in Jy.
+ * @param[in] station_u      Station u-coordinates, in metres.
+ * @param[in] station_v      Station v-coordinates, in metres.
+ * @param[in] uv_min_lambda  Minimum allowed UV length, in wavelengths.
+ * @param[in] uv_max_lambda  Maximum allowed UV length, in wavelengths.
+ * @param[in] inv_wavelength Inverse of the wavelength, in metres.
+ * @param[in] baseline_mask  If set, baselines with a zero value are skipped.
+ * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_scalar_point_gemm_omp_f(
+        int num_sources, int num_stations, const float2* jones,
+        const float* I, const float* station_u, const float* station_v,
+        float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
+        const int* baseline_mask, float2* vis, int* status);
+
+/**
+ * @brief
+ * Correlate function for unsmeared point sources, scalar version, using a
+ * matrix-matrix product (double precision).
+ *
+ * @details
+ * Forms visibilities on all baselines by evaluating the upper triangle of
+ * the product J diag(I) J^H, where J is the num_stations by num_sources
+ * complex matrix of station Jones scalars.
+ *
+ * @param[in] num_sources    Number of sources.
+ * @param[in] num_stations   Number of stations.
+ * @param[in] jones          Matrix of Jones scalars to correlate.
+ * @param[in] I              Source Stokes I values, in Jy.
+ * @param[in] station_u      Station u-coordinates, in metres.
+ * @param[in] station_v      Station v-coordinates, in metres.
+ * @param[in] uv_min_lambda  Minimum allowed UV length, in wavelengths.
+ * @param[in] uv_max_lambda  Maximum allowed UV length, in wavelengths.
+ * @param[in] inv_wavelength Inverse of the wavelength, in metres.
+ * @param[in] baseline_mask  If set, baselines with a zero value are skipped.
+ * @param[in,out] vis        Modified output complex visibilities.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_scalar_point_gemm_omp_d(
+        int num_sources, int num_stations, const double2* jones,
+        const double* I, const double* station_u, const double* station_v,
+        double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
+        const int* baseline_mask, double2* vis, int* status);
+
+/**
+ * @brief
+ * Returns the memory needed by the matrix-product correlate functions.
+ *
+ * @details
+ * Returns the number of bytes of work arrays allocated by the
+ * matrix-product correlate functions for the given number of stations.
+ * This does not depend on the number of sources, which are processed in
+ * tiles of fixed size.
+ *
+ * @param[in] vis_type       Enumerated visibility data type.
+ * @param[in] num_stations   Number of stations.
+ */
+OSKAR_EXPORT
+size_t oskar_cross_correlate_gemm_omp_memory_bytes(int vis_type,
+        int num_stations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_CROSS_CORRELATE_GEMM_OMP_H_ */
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_CROSS_CORRELATE_NUFFT_H_
+#define OSKAR_CROSS_CORRELATE_NUFFT_H_
+
+/**
+ * @file oskar_cross_correlate_nufft.h
+ */
+
+#include <oskar_global.h>
+#include <interferometer/oskar_jones.h>
+#include <sky/oskar_sky.h>
+#include <telescope/oskar_telescope.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Cross-correlates point sources seen by stations with identical beams,
+ * using a non-uniform FFT.
+ *
+ * @details
+ * For stations with identical beams, the visibility on each baseline is
+ * the Fourier sum of the apparent brightness E B E^H of each source
+ * from the source direction cosines (l, m, n - 1) to the baseline
+ * coordinates (u, v, w). This function evaluates that sum for all baselines
+ * at once using a type-3 non-uniform FFT (see oskar_nufft3()), to within
+ * a relative error given by \p tolerance, instead of summing over sources
+ * on each baseline.
+ *
+ * The apparent brightness of each source is evaluated using the beam of
+ * the first station. Only point sources are supported, and bandwidth and
+ * time-average smearing are not applied. Sources with a Stokes I flux
+ * outside the range given by \p source_min_jy and \p source_max_jy
+ * are ignored, as in oskar_evaluate_jones_K().
+ *
+ * The visibilities are accumulated into the output array.
+ * If \p baseline_mask is given, baselines where it is zero are skipped.
+ *
+ * @param[in,out] vis          Output visibilities, in CPU memory.
+ * @param[in] n_sources        Number of sources to use.
+ * @param[in] beam             Station beam Jones matrices (station 0 used).
+ * @param[in] sky              Sky model.
+ * @param[in] tel              Telescope model.
+ * @param[in] u                Station u-coordinates, in metres.
+ * @param[in] v                Station v-coordinates, in metres.
+ * @param[in] w                Station w-coordinates, in metres.
+ * @param[in] baseline_mask    Integer flag per baseline to evaluate, or NULL.
+ * @param[in] frequency_hz     Current observing frequency, in Hz.
+ * @param[in] source_min_jy    Minimum Stokes I flux of sources to include.
+ * @param[in] source_max_jy    Maximum Stokes I flux of sources to include.
+ * @param[in] tolerance        Required relative accuracy.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_nufft(oskar_Mem* vis, int n_sources,
+        const oskar_Jones* beam, const oskar_Sky* sky,
+        const oskar_Telescope* tel, const oskar_Mem* u, const oskar_Mem* v,
+        const oskar_Mem* w, const oskar_Mem* baseline_mask,
+        double frequency_hz, double source_min_jy, double source_max_jy,
+        double tolerance, int* status);
+
+/**
+ * @brief
+ * Returns the estimated cost of oskar_cross_correlate_nufft().
+ *
+ * @details
+ * Returns the estimated cost of oskar_cross_correlate_nufft() relative to
+ * summing over sources on each baseline (see oskar_nufft3_cost()).
+ * The cost depends on the area of sky covered by the sources and the
+ * length of the baselines, as well as on the number of each.
+ *
+ * @param[in] vis_type         Enumerated visibility data type.
+ * @param[in] n_sources        Number of sources to use.
+ * @param[in] sky              Sky model.
+ * @param[in] tel              Telescope model.
+ * @param[in] u                Station u-coordinates, in metres.
+ * @param[in] v                Station v-coordinates, in metres.
+ * @param[in] w                Station w-coordinates, in metres.
+ * @param[in] frequency_hz     Current observing frequency, in Hz.
+ * @param[in] tolerance        Required relative accuracy.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+double oskar_cross_correlate_nufft_cost(int vis_type, int n_sources,
+        const oskar_Sky* sky, const oskar_Telescope* tel,
+        const oskar_Mem* u, const oskar_Mem* v, const oskar_Mem* w,
+        double frequency_hz, double tolerance, int* status);
+
+/**
+ * @brief
+ * Returns the memory needed by oskar_cross_correlate_nufft().
+ *
+ * @details
+ * Returns the number of bytes allocated by oskar_cross_correlate_nufft()
+ * to correlate \p n_sources sources on \p n_baselines baselines, given
+ * upper bounds on the extent of the source direction cosines (l, m, n - 1)
+ * and of the station (u, v, w) coordinates in wavelengths.
+ *
+ * Zero is returned if the non-uniform FFT is not expected to be faster than
+ * summing over sources on each baseline, as it would not then be used.
+ *
+ * @param[in] vis_type         Enumerated visibility data type.
+ * @param[in] n_sources        Number of sources.
+ * @param[in] n_baselines      Number of baselines.
+ * @param[in] source_range     Extent of the source direction cosines.
+ * @param[in] station_range    Extent of the station coordinates,
+ *                             in wavelengths.
+ * @param[in] tolerance        Required relative accuracy.
+ */
+OSKAR_EXPORT
+size_t oskar_cross_correlate_nufft_memory_bytes(int vis_type, int n_sources,
+        int n_baselines, const double source_range[3],
+        const double station_range[3], double tolerance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_CROSS_CORRELATE_NUFFT_H_ */
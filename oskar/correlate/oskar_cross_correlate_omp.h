@@ -72,6 +72,7 @@ extern "C" {
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] baseline_mask  If set, baselines with a zero value are skipped.
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -85,7 +86,7 @@ void oskar_cross_correlate_point_omp_f(
         const float* station_x, const float* station_y,
         float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
         float frac_bandwidth, float time_int_sec, float gha0_rad,
-        float dec0_rad, float4c* vis);
+        float dec0_rad, const int* baseline_mask, float4c* vis);
 
 /**
  * @brief
@@ -119,6 +120,7 @@ void oskar_cross_correlate_point_omp_f(
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] baseline_mask  If set, baselines with a zero value are skipped.
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -132,7 +134,7 @@ void oskar_cross_correlate_point_omp_d(
         const double* station_x, const double* station_y,
         double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
         double frac_bandwidth, double time_int_sec, double gha0_rad,
-        double dec0_rad, double4c* vis);
+        double dec0_rad, const int* baseline_mask, double4c* vis);
 
 /**
  * @brief
@@ -172,6 +174,7 @@ void oskar_cross_correlate_point_omp_d(
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] baseline_mask  If set, baselines with a zero value are skipped.
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -186,7 +189,7 @@ void oskar_cross_correlate_gaussian_omp_f(
         const float* station_w, const float* station_x,
         const float* station_y, float uv_min_lambda, float uv_max_lambda,
         float inv_wavelength, float frac_bandwidth, float time_int_sec,
-        float gha0_rad, float dec0_rad, float4c* vis);
+        float gha0_rad, float dec0_rad, const int* baseline_mask, float4c* vis);
 
 /**
  * @brief
@@ -226,6 +229,7 @@ void oskar_cross_correlate_gaussian_omp_f(
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] baseline_mask  If set, baselines with a zero value are skipped.
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -240,7 +244,8 @@ void oskar_cross_correlate_gaussian_omp_d(
         const double* station_w, const double* station_x,
         const double* station_y, double uv_min_lambda, double uv_max_lambda,
         double inv_wavelength, double frac_bandwidth, double time_int_sec,
-        double gha0_rad, double dec0_rad, double4c* vis);
+        double gha0_rad, double dec0_rad,
+        const int* baseline_mask, double4c* vis);
 
 #ifdef __cplusplus
 }
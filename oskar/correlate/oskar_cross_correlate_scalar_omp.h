@@ -69,6 +69,7 @@ extern "C" {
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] baseline_mask  If set, baselines with a zero value are skipped.
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -80,7 +81,8 @@ void oskar_cross_correlate_scalar_point_omp_f(
         const float* station_w, const float* station_x,
         const float* station_y, float uv_min_lambda, float uv_max_lambda,
         float inv_wavelength, float frac_bandwidth, const float time_int_sec,
-        const float gha0_rad, const float dec0_rad, float2* vis);
+        const float gha0_rad, const float dec0_rad,
+        const int* baseline_mask, float2* vis);
 
 /**
  * @brief
@@ -111,6 +113,7 @@ void oskar_cross_correlate_scalar_point_omp_f(
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] baseline_mask  If set, baselines with a zero value are skipped.
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -122,7 +125,8 @@ void oskar_cross_correlate_scalar_point_omp_d(
         const double* station_w, const double* station_x,
         const double* station_y, double uv_min_lambda, double uv_max_lambda,
         double inv_wavelength, double frac_bandwidth, const double time_int_sec,
-        const double gha0_rad, const double dec0_rad, double2* vis);
+        const double gha0_rad, const double dec0_rad,
+        const int* baseline_mask, double2* vis);
 
 /**
  * @brief
@@ -159,6 +163,7 @@ void oskar_cross_correlate_scalar_point_omp_d(
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] baseline_mask  If set, baselines with a zero value are skipped.
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -172,7 +177,7 @@ void oskar_cross_correlate_scalar_gaussian_omp_f(
         const float* station_x, const float* station_y,
         float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
         float frac_bandwidth, float time_int_sec, float gha0_rad,
-        float dec0_rad, float2* vis);
+        float dec0_rad, const int* baseline_mask, float2* vis);
 
 /**
  * @brief
@@ -209,6 +214,7 @@ void oskar_cross_correlate_scalar_gaussian_omp_f(
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] baseline_mask  If set, baselines with a zero value are skipped.
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -222,7 +228,7 @@ void oskar_cross_correlate_scalar_gaussian_omp_d(
         const double* station_x, const double* station_y,
         double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
         double frac_bandwidth, double time_int_sec, double gha0_rad,
-        double dec0_rad, double2* vis);
+        double dec0_rad, const int* baseline_mask, double2* vis);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SOURCE_TREE_H_
+#define OSKAR_SOURCE_TREE_H_
+
+/**
+ * @file oskar_source_tree.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_SourceTree;
+#ifndef OSKAR_SOURCE_TREE_TYPEDEF_
+#define OSKAR_SOURCE_TREE_TYPEDEF_
+typedef struct oskar_SourceTree oskar_SourceTree;
+#endif /* OSKAR_SOURCE_TREE_TYPEDEF_ */
+
+/**
+ * @brief Creates a spatial tree used to aggregate sources.
+ *
+ * @details
+ * Creates an empty quad-tree used to group sources that are close together
+ * on the sky, so that their contributions to the visibilities on short
+ * baselines can be evaluated using aggregated cell moments.
+ *
+ * The tree is held in host memory.
+ *
+ * @param[in] max_sources_per_leaf  Maximum number of sources in a leaf cell.
+ * @param[in,out] status            Status return code.
+ */
+OSKAR_EXPORT
+oskar_SourceTree* oskar_source_tree_create(int max_sources_per_leaf,
+        int* status);
+
+/**
+ * @brief Builds the spatial tree from source direction cosines.
+ *
+ * @details
+ * Recursively subdivides the bounding box of the source (l, m) positions
+ * into quadrants, until each leaf cell contains at most the
+ * maximum number of sources specified when the tree was created.
+ *
+ * The direction cosine arrays must be in CPU memory.
+ *
+ * @param[in,out] tree    Tree to build.
+ * @param[in] num_sources Number of sources to use.
+ * @param[in] l           Source l-direction cosines relative to phase centre.
+ * @param[in] m           Source m-direction cosines relative to phase centre.
+ * @param[in] n           Source n-direction cosines relative to phase centre.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_source_tree_build(oskar_SourceTree* tree, int num_sources,
+        const oskar_Mem* l, const oskar_Mem* m, const oskar_Mem* n,
+        int* status);
+
+/**
+ * @brief Frees memory held by the spatial tree.
+ *
+ * @param[in,out] tree    Tree to free.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_source_tree_free(oskar_SourceTree* tree, int* status);
+
+/**
+ * @brief Returns the memory needed to aggregate sources using a tree.
+ *
+ * @details
+ * Returns an estimate of the number of bytes held by a tree built from
+ * \p num_sources sources, including the station phase factors evaluated
+ * by oskar_cross_correlate_aggregate() for \p num_stations stations.
+ *
+ * The number of nodes depends on how the sources are clustered, so
+ * this assumes that sources are spread evenly over the sky.
+ *
+ * @param[in] max_sources_per_leaf  Maximum number of sources in a leaf cell.
+ * @param[in] num_sources           Number of sources.
+ * @param[in] num_stations          Number of stations.
+ */
+OSKAR_EXPORT
+size_t oskar_source_tree_memory_bytes(int max_sources_per_leaf,
+        int num_sources, int num_stations);
+
+/* Accessors. */
+
+OSKAR_EXPORT
+int oskar_source_tree_num_sources(const oskar_SourceTree* tree);
+
+OSKAR_EXPORT
+int oskar_source_tree_num_nodes(const oskar_SourceTree* tree);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SOURCE_TREE_H_ */
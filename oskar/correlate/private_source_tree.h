@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_PRIVATE_SOURCE_TREE_H_
+#define OSKAR_PRIVATE_SOURCE_TREE_H_
+
+#include <utility/oskar_vector_types.h>
+
+/* Number of moment terms per node: 1 monopole, 3 dipole, 6 quadrupole. */
+#define OSKAR_SOURCE_TREE_NUM_MOMENTS 10
+
+struct oskar_SourceTreeNode
+{
+    int start;          /* Index of first source in the node (tree order). */
+    int count;          /* Number of sources in the node. */
+    int child;          /* Index of first child node. */
+    int num_children;   /* Number of child nodes (0 for a leaf). */
+    double centre[3];   /* Expansion centre (l, m, n). */
+    double radius;      /* Distance from centre to furthest source. */
+    double abs_flux;    /* Sum of apparent brightness magnitudes. */
+};
+typedef struct oskar_SourceTreeNode oskar_SourceTreeNode;
+
+struct oskar_SourceTree
+{
+    int max_sources_per_leaf;
+    int num_sources, capacity_sources;
+    int num_nodes, capacity_nodes;
+    int* order;                 /* Sky source index at each tree position. */
+    int* scratch;               /* Work array used for partitioning. */
+    double *l, *m, *n;          /* Source direction cosines, in tree order. */
+    double4c* brightness;       /* Apparent brightness, in tree order. */
+    double2* phasors;           /* Station phase factors, in tree order. */
+    size_t capacity_phasors;
+    oskar_SourceTreeNode* nodes;
+    double4c* moments;          /* Cell moments, 10 per node. */
+};
+
+#ifndef OSKAR_SOURCE_TREE_TYPEDEF_
+#define OSKAR_SOURCE_TREE_TYPEDEF_
+typedef struct oskar_SourceTree oskar_SourceTree;
+#endif /* OSKAR_SOURCE_TREE_TYPEDEF_ */
+
+#endif /* OSKAR_PRIVATE_SOURCE_TREE_H_ */
@@ -28,6 +28,7 @@
 
 #include "correlate/oskar_cross_correlate.h"
 #include "correlate/oskar_cross_correlate_cuda.h"
+#include "correlate/oskar_cross_correlate_gemm_omp.h"
 #include "correlate/oskar_cross_correlate_omp.h"
 #include "correlate/oskar_cross_correlate_scalar_cuda.h"
 #include "correlate/oskar_cross_correlate_scalar_omp.h"
@@ -43,12 +44,14 @@ extern "C" {
 void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
         const oskar_Jones* jones, const oskar_Sky* sky,
         const oskar_Telescope* tel, const oskar_Mem* u, const oskar_Mem* v,
-        const oskar_Mem* w, double gast, double frequency_hz, int* status)
+        const oskar_Mem* w, const oskar_Mem* baseline_mask, double gast,
+        double frequency_hz, int* status)
 {
     int jones_type, base_type, location, n_stations, use_extended;
     double inv_wavelength, frac_bandwidth, time_avg, gha0, dec0;
     double uv_filter_max, uv_filter_min;
     const oskar_Mem *J, *a, *b, *c, *l, *m, *n, *I, *Q, *U, *V, *x, *y;
+    const int* mask = 0;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -132,6 +135,24 @@ void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
         return;
     }
 
+    /* Get the baseline mask, if given. It is only used on the CPU. */
+    if (baseline_mask && location == OSKAR_CPU)
+    {
+        if (oskar_mem_location(baseline_mask) != OSKAR_CPU)
+        {
+            *status = OSKAR_ERR_BAD_LOCATION;
+            return;
+        }
+        if ((int)oskar_mem_length(baseline_mask) <
+                oskar_telescope_num_baselines(tel))
+        {
+            *status = OSKAR_ERR_DIMENSION_MISMATCH;
+            return;
+        }
+        mask = oskar_mem_int_const(baseline_mask, status);
+        if (*status) return;
+    }
+
     /* Get handles to arrays. */
     J = oskar_jones_mem_const(jones);
     I = oskar_sky_I_const(sky);
@@ -175,7 +196,7 @@ void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
                         oskar_mem_float_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_float4c(vis, status));
+                        mask, oskar_mem_float4c(vis, status));
                 break;
             case OSKAR_DOUBLE_COMPLEX_MATRIX:
                 oskar_cross_correlate_gaussian_omp_d(
@@ -198,7 +219,7 @@ void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
                         oskar_mem_double_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_double4c(vis, status));
+                        mask, oskar_mem_double4c(vis, status));
                 break;
             case OSKAR_SINGLE_COMPLEX:
                 oskar_cross_correlate_scalar_gaussian_omp_f(
@@ -218,7 +239,7 @@ void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
                         oskar_mem_float_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_float2(vis, status));
+                        mask, oskar_mem_float2(vis, status));
                 break;
             case OSKAR_DOUBLE_COMPLEX:
                 oskar_cross_correlate_scalar_gaussian_omp_d(
@@ -238,7 +259,63 @@ void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
                         oskar_mem_double_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_double2(vis, status));
+                        mask, oskar_mem_double2(vis, status));
+                break;
+            default:
+                *status = OSKAR_ERR_BAD_DATA_TYPE;
+                return;
+            }
+        }
+        else if (frac_bandwidth == 0.0 && time_avg == 0.0)
+        {
+            /* Without smearing, the visibilities are a matrix product. */
+            switch (oskar_mem_type(vis))
+            {
+            case OSKAR_SINGLE_COMPLEX_MATRIX:
+                oskar_cross_correlate_point_gemm_omp_f(
+                        n_sources, n_stations,
+                        oskar_mem_float4c_const(J, status),
+                        oskar_mem_float_const(I, status),
+                        oskar_mem_float_const(Q, status),
+                        oskar_mem_float_const(U, status),
+                        oskar_mem_float_const(V, status),
+                        oskar_mem_float_const(u, status),
+                        oskar_mem_float_const(v, status),
+                        uv_filter_min, uv_filter_max, inv_wavelength,
+                        mask, oskar_mem_float4c(vis, status), status);
+                break;
+            case OSKAR_DOUBLE_COMPLEX_MATRIX:
+                oskar_cross_correlate_point_gemm_omp_d(
+                        n_sources, n_stations,
+                        oskar_mem_double4c_const(J, status),
+                        oskar_mem_double_const(I, status),
+                        oskar_mem_double_const(Q, status),
+                        oskar_mem_double_const(U, status),
+                        oskar_mem_double_const(V, status),
+                        oskar_mem_double_const(u, status),
+                        oskar_mem_double_const(v, status),
+                        uv_filter_min, uv_filter_max, inv_wavelength,
+                        mask, oskar_mem_double4c(vis, status), status);
+                break;
+            case OSKAR_SINGLE_COMPLEX:
+                oskar_cross_correlate_scalar_point_gemm_omp_f(
+                        n_sources, n_stations,
+                        oskar_mem_float2_const(J, status),
+                        oskar_mem_float_const(I, status),
+                        oskar_mem_float_const(u, status),
+                        oskar_mem_float_const(v, status),
+                        uv_filter_min, uv_filter_max, inv_wavelength,
+                        mask, oskar_mem_float2(vis, status), status);
+                break;
+            case OSKAR_DOUBLE_COMPLEX:
+                oskar_cross_correlate_scalar_point_gemm_omp_d(
+                        n_sources, n_stations,
+                        oskar_mem_double2_const(J, status),
+                        oskar_mem_double_const(I, status),
+                        oskar_mem_double_const(u, status),
+                        oskar_mem_double_const(v, status),
+                        uv_filter_min, uv_filter_max, inv_wavelength,
+                        mask, oskar_mem_double2(vis, status), status);
                 break;
             default:
                 *status = OSKAR_ERR_BAD_DATA_TYPE;
@@ -267,7 +344,7 @@ void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
                         oskar_mem_float_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_float4c(vis, status));
+                        mask, oskar_mem_float4c(vis, status));
                 break;
             case OSKAR_DOUBLE_COMPLEX_MATRIX:
                 oskar_cross_correlate_point_omp_d(
@@ -287,7 +364,7 @@ void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
                         oskar_mem_double_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_double4c(vis, status));
+                        mask, oskar_mem_double4c(vis, status));
                 break;
             case OSKAR_SINGLE_COMPLEX:
                 oskar_cross_correlate_scalar_point_omp_f(
@@ -304,7 +381,7 @@ void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
                         oskar_mem_float_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_float2(vis, status));
+                        mask, oskar_mem_float2(vis, status));
                 break;
             case OSKAR_DOUBLE_COMPLEX:
                 oskar_cross_correlate_scalar_point_omp_d(
@@ -321,7 +398,7 @@ void oskar_cross_correlate(oskar_Mem* vis, int n_sources,
                         oskar_mem_double_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
-                        oskar_mem_double2(vis, status));
+                        mask, oskar_mem_double2(vis, status));
                 break;
             default:
                 *status = OSKAR_ERR_BAD_DATA_TYPE;
@@ -0,0 +1,552 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "correlate/oskar_cross_correlate_aggregate.h"
+#include "correlate/private_correlate_functions_inline.h"
+#include "correlate/private_source_tree.h"
+#include "math/oskar_add_inline.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+
+/*
+ * Each aggregated cell stores the moments of the apparent brightness X
+ * about its centre c, with d = (l, m, n) - c:
+ *
+ *   M0 = sum X, M1_j = sum X d_j, M2_jk = sum X d_j d_k.
+ *
+ * For a baseline with a = 2 pi (uu, vv, ww), the cell then contributes
+ *
+ *   exp(i a.(c - (0, 0, 1))) * (M0 + i a_j M1_j - (1/2) a_j a_k M2_jk),
+ *
+ * which is exact up to the third-order term in the expansion of the fringe
+ * phase. The moments are stored in the order:
+ *   M0, M1_l, M1_m, M1_n, M2_ll, M2_mm, M2_nn, M2_lm, M2_ln, M2_mn.
+ */
+
+/* Maximum depth of the traversal stack. */
+#define STACK_SIZE 128
+
+static inline void load_beam(const float4c& in, double4c& out)
+{
+    out.a.x = in.a.x; out.a.y = in.a.y; out.b.x = in.b.x; out.b.y = in.b.y;
+    out.c.x = in.c.x; out.c.y = in.c.y; out.d.x = in.d.x; out.d.y = in.d.y;
+}
+
+static inline void load_beam(const double4c& in, double4c& out)
+{
+    out = in;
+}
+
+static inline void load_beam(const float2& in, double4c& out)
+{
+    out.a.x = out.d.x = in.x; out.a.y = out.d.y = in.y;
+    out.b.x = out.b.y = out.c.x = out.c.y = 0.0;
+}
+
+static inline void load_beam(const double2& in, double4c& out)
+{
+    out.a = out.d = in;
+    out.b.x = out.b.y = out.c.x = out.c.y = 0.0;
+}
+
+static inline void add_vis(float4c& vis, const double4c& sum)
+{
+    vis.a.x += (float) sum.a.x; vis.a.y += (float) sum.a.y;
+    vis.b.x += (float) sum.b.x; vis.b.y += (float) sum.b.y;
+    vis.c.x += (float) sum.c.x; vis.c.y += (float) sum.c.y;
+    vis.d.x += (float) sum.d.x; vis.d.y += (float) sum.d.y;
+}
+
+static inline void add_vis(double4c& vis, const double4c& sum)
+{
+    OSKAR_ADD_COMPLEX_MATRIX_IN_PLACE(vis, sum)
+}
+
+static inline void add_vis(float2& vis, const double4c& sum)
+{
+    vis.x += (float) sum.a.x; vis.y += (float) sum.a.y;
+}
+
+static inline void add_vis(double2& vis, const double4c& sum)
+{
+    vis.x += sum.a.x; vis.y += sum.a.y;
+}
+
+/* Evaluates the apparent brightness of each source, in tree order. */
+template <typename REAL, typename JONES>
+static void evaluate_brightness(oskar_SourceTree* tree, const JONES* beam,
+        const REAL* I, const REAL* Q, const REAL* U, const REAL* V,
+        double source_min_jy, double source_max_jy)
+{
+    const int num_sources = tree->num_sources;
+#pragma omp parallel for
+    for (int i = 0; i < num_sources; ++i)
+    {
+        double4c b, m1, m2;
+        const int s = tree->order[i];
+        if (!(I[s] > source_min_jy && I[s] <= source_max_jy))
+        {
+            OSKAR_CLEAR_COMPLEX_MATRIX(double, tree->brightness[i])
+            continue;
+        }
+        OSKAR_CONSTRUCT_B(double, b, I[s], Q ? Q[s] : 0, U ? U[s] : 0,
+                V ? V[s] : 0)
+        load_beam(beam[s], m1);
+        m2 = m1;
+        OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(double2, m1, b)
+        OSKAR_MUL_COMPLEX_MATRIX_CONJUGATE_TRANSPOSE_IN_PLACE(double2, m1, m2)
+        tree->brightness[i] = m1;
+    }
+}
+
+/* Evaluates the centre, radius and moments of every cell in the tree. */
+static void evaluate_moments(oskar_SourceTree* tree)
+{
+    const int num_nodes = tree->num_nodes;
+    const double *l = tree->l, *m = tree->m, *n = tree->n;
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int k = 0; k < num_nodes; ++k)
+    {
+        oskar_SourceTreeNode* node = &tree->nodes[k];
+        double4c* mom = &tree->moments[k * OSKAR_SOURCE_TREE_NUM_MOMENTS];
+        const int start = node->start, end = node->start + node->count;
+        double c[3] = {0.0, 0.0, 0.0}, sum_w = 0.0, r2_max = 0.0;
+
+        /* Find the flux-weighted centroid. */
+        for (int i = start; i < end; ++i)
+        {
+            const double4c* x = &tree->brightness[i];
+            const double w_ = fabs(x->a.x) + fabs(x->d.x);
+            c[0] += w_ * l[i]; c[1] += w_ * m[i]; c[2] += w_ * n[i];
+            sum_w += w_;
+        }
+        if (sum_w > 0.0)
+        {
+            c[0] /= sum_w; c[1] /= sum_w; c[2] /= sum_w;
+        }
+        else
+        {
+            c[0] = l[start]; c[1] = m[start]; c[2] = n[start];
+        }
+        node->centre[0] = c[0];
+        node->centre[1] = c[1];
+        node->centre[2] = c[2];
+        node->abs_flux = sum_w;
+
+        /* Accumulate the moments about the centroid. */
+        for (int j = 0; j < OSKAR_SOURCE_TREE_NUM_MOMENTS; ++j)
+            OSKAR_CLEAR_COMPLEX_MATRIX(double, mom[j])
+        if (sum_w == 0.0)
+        {
+            node->radius = 0.0;
+            continue;
+        }
+        for (int i = start; i < end; ++i)
+        {
+            const double4c x = tree->brightness[i];
+            const double d[3] = {l[i] - c[0], m[i] - c[1], n[i] - c[2]};
+            const double r2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+            if (r2 > r2_max) r2_max = r2;
+            OSKAR_ADD_COMPLEX_MATRIX_IN_PLACE(mom[0], x)
+            OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(mom[1], x, d[0])
+            OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(mom[2], x, d[1])
+            OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(mom[3], x, d[2])
+            OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(mom[4], x, d[0] * d[0])
+            OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(mom[5], x, d[1] * d[1])
+            OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(mom[6], x, d[2] * d[2])
+            OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(mom[7], x, d[0] * d[1])
+            OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(mom[8], x, d[0] * d[2])
+            OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(mom[9], x, d[1] * d[2])
+        }
+        node->radius = sqrt(r2_max);
+    }
+}
+
+/* Accumulates sum += x * t. */
+static inline void add_weighted(double4c& sum, const double4c& x,
+        const double2& t)
+{
+    OSKAR_MUL_ADD_COMPLEX(sum.a, x.a, t)
+    OSKAR_MUL_ADD_COMPLEX(sum.b, x.b, t)
+    OSKAR_MUL_ADD_COMPLEX(sum.c, x.c, t)
+    OSKAR_MUL_ADD_COMPLEX(sum.d, x.d, t)
+}
+
+/* Evaluates the phase factor of each source at each station, in tree order,
+ * so that sources in leaf cells can be summed without evaluating the
+ * fringe phase on every baseline. Leaf cells that are always aggregated,
+ * even on the longest baseline, are skipped. */
+template <typename REAL>
+static void evaluate_phasors(oskar_SourceTree* tree, int num_stations,
+        const REAL* station_u, const REAL* station_v, const REAL* station_w,
+        double inv_wavelength, double max_ar)
+{
+    double min_uvw[3], max_uvw[3], a_max;
+    const size_t num_sources = tree->num_sources;
+    const int num_nodes = tree->num_nodes;
+    const double wavenumber = 2.0 * M_PI * inv_wavelength;
+
+    /* Get an upper bound on the baseline length, with a margin for
+     * rounding errors. */
+    min_uvw[0] = max_uvw[0] = station_u[0];
+    min_uvw[1] = max_uvw[1] = station_v[0];
+    min_uvw[2] = max_uvw[2] = station_w[0];
+    for (int a = 1; a < num_stations; ++a)
+    {
+        const double uvw[3] = {station_u[a], station_v[a], station_w[a]};
+        for (int j = 0; j < 3; ++j)
+        {
+            if (uvw[j] < min_uvw[j]) min_uvw[j] = uvw[j];
+            if (uvw[j] > max_uvw[j]) max_uvw[j] = uvw[j];
+        }
+    }
+    a_max = wavenumber * sqrt(
+            (max_uvw[0] - min_uvw[0]) * (max_uvw[0] - min_uvw[0]) +
+            (max_uvw[1] - min_uvw[1]) * (max_uvw[1] - min_uvw[1]) +
+            (max_uvw[2] - min_uvw[2]) * (max_uvw[2] - min_uvw[2])) * 1.001;
+
+#pragma omp parallel for
+    for (int a = 0; a < num_stations; ++a)
+    {
+        const double us = wavenumber * station_u[a];
+        const double vs = wavenumber * station_v[a];
+        const double ws = wavenumber * station_w[a];
+        double2* p = &tree->phasors[a * num_sources];
+        for (int k = 0; k < num_nodes; ++k)
+        {
+            const oskar_SourceTreeNode* node = &tree->nodes[k];
+            if (node->num_children > 0 || node->abs_flux == 0.0 ||
+                    a_max * node->radius <= max_ar)
+                continue;
+            const int end = node->start + node->count;
+            for (int i = node->start; i < end; ++i)
+            {
+                const double phase = us * tree->l[i] + vs * tree->m[i] +
+                        ws * (tree->n[i] - 1.0);
+                p[i].x = cos(phase);
+                p[i].y = sin(phase);
+            }
+        }
+    }
+}
+
+template <typename REAL, typename VIS>
+static void correlate_tree(const oskar_SourceTree* tree, int num_stations,
+        const REAL* station_u, const REAL* station_v, const REAL* station_w,
+        double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
+        double max_ar, const int* baseline_mask, VIS* vis)
+{
+    const double4c* x = tree->brightness;
+    const size_t num_sources = tree->num_sources;
+    if (tree->num_nodes == 0) return;
+
+    // Loop over stations.
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int SQ = 0; SQ < num_stations; ++SQ)
+    {
+        int stack[STACK_SIZE];
+        const double2* phasor_q = &tree->phasors[SQ * num_sources];
+
+        // Loop over baselines for this station.
+        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        {
+            double4c sum;
+            OSKAR_CLEAR_COMPLEX_MATRIX(double, sum)
+
+            // Get baseline coordinates in wavelengths.
+            const double uu = (station_u[SP] - station_u[SQ]) * inv_wavelength;
+            const double vv = (station_v[SP] - station_v[SQ]) * inv_wavelength;
+            const double ww = (station_w[SP] - station_w[SQ]) * inv_wavelength;
+            const double uv_len = sqrt(uu * uu + vv * vv);
+
+            // Apply the baseline length filter and the baseline mask.
+            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+            if (baseline_mask && !baseline_mask[
+                    oskar_evaluate_baseline_index_inline(num_stations, SP, SQ)])
+                continue;
+            const double a[3] = {2.0 * M_PI * uu, 2.0 * M_PI * vv,
+                    2.0 * M_PI * ww};
+            const double a_len = sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+            const double2* phasor_p = &tree->phasors[SP * num_sources];
+
+            // Traverse the tree.
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0)
+            {
+                const oskar_SourceTreeNode* node = &tree->nodes[stack[--top]];
+                if (node->abs_flux == 0.0) continue;
+                if (a_len * node->radius <= max_ar)
+                {
+                    // Use the cell moments.
+                    const double4c* mom = &tree->moments[
+                            (node - tree->nodes) * OSKAR_SOURCE_TREE_NUM_MOMENTS];
+                    double4c s = mom[0], t;
+                    OSKAR_CLEAR_COMPLEX_MATRIX(double, t)
+                    OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(t, mom[1], a[0])
+                    OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(t, mom[2], a[1])
+                    OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(t, mom[3], a[2])
+                    s.a.x -= t.a.y; s.a.y += t.a.x;
+                    s.b.x -= t.b.y; s.b.y += t.b.x;
+                    s.c.x -= t.c.y; s.c.y += t.c.x;
+                    s.d.x -= t.d.y; s.d.y += t.d.x;
+                    OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(s, mom[4],
+                            -0.5 * a[0] * a[0])
+                    OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(s, mom[5],
+                            -0.5 * a[1] * a[1])
+                    OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(s, mom[6],
+                            -0.5 * a[2] * a[2])
+                    OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(s, mom[7], -a[0] * a[1])
+                    OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(s, mom[8], -a[0] * a[2])
+                    OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(s, mom[9], -a[1] * a[2])
+                    const double phase = a[0] * node->centre[0] +
+                            a[1] * node->centre[1] +
+                            a[2] * (node->centre[2] - 1.0);
+                    double2 weight;
+                    weight.x = cos(phase);
+                    weight.y = sin(phase);
+                    add_weighted(sum, s, weight);
+                }
+                else if (node->num_children == 0)
+                {
+                    // Sum the sources in the leaf directly.
+                    const int end = node->start + node->count;
+                    for (int i = node->start; i < end; ++i)
+                    {
+                        double2 weight;
+                        OSKAR_MUL_COMPLEX_CONJUGATE(weight, phasor_p[i],
+                                phasor_q[i])
+                        add_weighted(sum, x[i], weight);
+                    }
+                }
+                else
+                {
+                    // Visit the children.
+                    for (int j = 0; j < node->num_children; ++j)
+                        stack[top++] = node->child + j;
+                }
+            }
+
+            // Add result to the baseline visibility.
+            int i = oskar_evaluate_baseline_index_inline(num_stations, SP, SQ);
+            add_vis(vis[i], sum);
+        }
+    }
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_cross_correlate_aggregate(oskar_Mem* vis, int n_sources,
+        const oskar_Jones* beam, oskar_SourceTree* tree, const oskar_Sky* sky,
+        const oskar_Telescope* tel, const oskar_Mem* u, const oskar_Mem* v,
+        const oskar_Mem* w, const oskar_Mem* baseline_mask,
+        double frequency_hz, double source_min_jy, double source_max_jy,
+        double tolerance, int* status)
+{
+    int type, n_stations;
+    double inv_wavelength, uv_filter_min, uv_filter_max, max_ar;
+    const oskar_Mem *E, *I, *Q, *U, *V;
+    const int* mask = 0;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Check data locations. */
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU ||
+            oskar_jones_mem_location(beam) != OSKAR_CPU ||
+            oskar_mem_location(vis) != OSKAR_CPU ||
+            oskar_mem_location(u) != OSKAR_CPU ||
+            oskar_mem_location(v) != OSKAR_CPU ||
+            oskar_mem_location(w) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Check data types. */
+    type = oskar_mem_type(vis);
+    if (oskar_jones_type(beam) != type ||
+            oskar_sky_precision(sky) != oskar_type_precision(type) ||
+            oskar_mem_type(u) != oskar_type_precision(type) ||
+            oskar_mem_type(v) != oskar_type_precision(type) ||
+            oskar_mem_type(w) != oskar_type_precision(type))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+
+    /* Check dimensions. */
+    n_stations = oskar_telescope_num_stations(tel);
+    if (oskar_source_tree_num_sources(tree) != n_sources ||
+            oskar_jones_num_sources(beam) < n_sources ||
+            (int)oskar_mem_length(u) != n_stations ||
+            (int)oskar_mem_length(v) != n_stations ||
+            (int)oskar_mem_length(w) != n_stations ||
+            (int)oskar_mem_length(vis) < oskar_telescope_num_baselines(tel))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (baseline_mask)
+    {
+        if (oskar_mem_location(baseline_mask) != OSKAR_CPU)
+        {
+            *status = OSKAR_ERR_BAD_LOCATION;
+            return;
+        }
+        if ((int)oskar_mem_length(baseline_mask) <
+                oskar_telescope_num_baselines(tel))
+        {
+            *status = OSKAR_ERR_DIMENSION_MISMATCH;
+            return;
+        }
+        mask = oskar_mem_int_const(baseline_mask, status);
+        if (*status) return;
+    }
+    if (n_sources == 0) return;
+
+    /* Get UV filter parameters in wavelengths. */
+    inv_wavelength = fabs(frequency_hz) / 299792458.0;
+    uv_filter_min = oskar_telescope_uv_filter_min(tel);
+    uv_filter_max = oskar_telescope_uv_filter_max(tel);
+    if (oskar_telescope_uv_filter_units(tel) == OSKAR_METRES)
+    {
+        uv_filter_min *= inv_wavelength;
+        uv_filter_max *= inv_wavelength;
+    }
+    if (uv_filter_max < 0.0 || uv_filter_max > FLT_MAX)
+        uv_filter_max = FLT_MAX;
+
+    /* Get the maximum value of (a r) for a cell to be aggregated. */
+    max_ar = tolerance > 0.0 ? cbrt(6.0 * tolerance) : 0.0;
+
+    /* Evaluate apparent source brightness and cell moments. */
+    E = oskar_jones_mem_const(beam);
+    I = oskar_sky_I_const(sky);
+    Q = oskar_sky_Q_const(sky);
+    U = oskar_sky_U_const(sky);
+    V = oskar_sky_V_const(sky);
+    switch (type)
+    {
+    case OSKAR_SINGLE_COMPLEX_MATRIX:
+        evaluate_brightness(tree, oskar_mem_float4c_const(E, status),
+                oskar_mem_float_const(I, status),
+                oskar_mem_float_const(Q, status),
+                oskar_mem_float_const(U, status),
+                oskar_mem_float_const(V, status),
+                source_min_jy, source_max_jy);
+        break;
+    case OSKAR_DOUBLE_COMPLEX_MATRIX:
+        evaluate_brightness(tree, oskar_mem_double4c_const(E, status),
+                oskar_mem_double_const(I, status),
+                oskar_mem_double_const(Q, status),
+                oskar_mem_double_const(U, status),
+                oskar_mem_double_const(V, status),
+                source_min_jy, source_max_jy);
+        break;
+    case OSKAR_SINGLE_COMPLEX:
+        evaluate_brightness(tree, oskar_mem_float2_const(E, status),
+                oskar_mem_float_const(I, status),
+                (const float*)0, (const float*)0, (const float*)0,
+                source_min_jy, source_max_jy);
+        break;
+    case OSKAR_DOUBLE_COMPLEX:
+        evaluate_brightness(tree, oskar_mem_double2_const(E, status),
+                oskar_mem_double_const(I, status),
+                (const double*)0, (const double*)0, (const double*)0,
+                source_min_jy, source_max_jy);
+        break;
+    default:
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    evaluate_moments(tree);
+
+    /* Evaluate station phase factors for the sources. */
+    if ((size_t) n_stations * n_sources > tree->capacity_phasors)
+    {
+        tree->capacity_phasors = (size_t) n_stations * n_sources;
+        tree->phasors = (double2*) realloc(tree->phasors,
+                tree->capacity_phasors * sizeof(double2));
+        if (!tree->phasors)
+        {
+            tree->capacity_phasors = 0;
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+    }
+    if (oskar_type_is_double(type))
+        evaluate_phasors(tree, n_stations, oskar_mem_double_const(u, status),
+                oskar_mem_double_const(v, status),
+                oskar_mem_double_const(w, status), inv_wavelength, max_ar);
+    else
+        evaluate_phasors(tree, n_stations, oskar_mem_float_const(u, status),
+                oskar_mem_float_const(v, status),
+                oskar_mem_float_const(w, status), inv_wavelength, max_ar);
+
+    /* Correlate. */
+    switch (type)
+    {
+    case OSKAR_SINGLE_COMPLEX_MATRIX:
+        correlate_tree(tree, n_stations, oskar_mem_float_const(u, status),
+                oskar_mem_float_const(v, status),
+                oskar_mem_float_const(w, status), uv_filter_min,
+                uv_filter_max, inv_wavelength, max_ar, mask,
+                oskar_mem_float4c(vis, status));
+        break;
+    case OSKAR_DOUBLE_COMPLEX_MATRIX:
+        correlate_tree(tree, n_stations, oskar_mem_double_const(u, status),
+                oskar_mem_double_const(v, status),
+                oskar_mem_double_const(w, status), uv_filter_min,
+                uv_filter_max, inv_wavelength, max_ar, mask,
+                oskar_mem_double4c(vis, status));
+        break;
+    case OSKAR_SINGLE_COMPLEX:
+        correlate_tree(tree, n_stations, oskar_mem_float_const(u, status),
+                oskar_mem_float_const(v, status),
+                oskar_mem_float_const(w, status), uv_filter_min,
+                uv_filter_max, inv_wavelength, max_ar, mask,
+                oskar_mem_float2(vis, status));
+        break;
+    case OSKAR_DOUBLE_COMPLEX:
+        correlate_tree(tree, n_stations, oskar_mem_double_const(u, status),
+                oskar_mem_double_const(v, status),
+                oskar_mem_double_const(w, status), uv_filter_min,
+                uv_filter_max, inv_wavelength, max_ar, mask,
+                oskar_mem_double2(vis, status));
+        break;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "correlate/oskar_cross_correlate_apparent.h"
+#include "correlate/private_correlate_functions_inline.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+
+/* Number of sources in each tile. */
+#define TILE_SRC 128
+
+/*
+ * The apparent brightness X = E B E^H of each source is Hermitian, so for
+ * matrices only the values (X_xx, Re X_xy, Im X_xy, X_yy) are stored.
+ * With the phase factor t = K_p K_q^* (times any smearing terms), the
+ * source contributes
+ *
+ *   [t X_xx, t X_xy; t X_xy^*, t X_yy]
+ *
+ * to the visibility on baseline p-q. The real and imaginary parts of the
+ * products of t with X_xy are accumulated separately, so that both
+ * off-diagonal terms can be formed from the same four sums.
+ * For scalars, X = |E|^2 I is real.
+ */
+
+static inline void add_vis(float4c& vis, const double4c& sum)
+{
+    vis.a.x += (float) sum.a.x; vis.a.y += (float) sum.a.y;
+    vis.b.x += (float) sum.b.x; vis.b.y += (float) sum.b.y;
+    vis.c.x += (float) sum.c.x; vis.c.y += (float) sum.c.y;
+    vis.d.x += (float) sum.d.x; vis.d.y += (float) sum.d.y;
+}
+
+static inline void add_vis(double4c& vis, const double4c& sum)
+{
+    vis.a.x += sum.a.x; vis.a.y += sum.a.y;
+    vis.b.x += sum.b.x; vis.b.y += sum.b.y;
+    vis.c.x += sum.c.x; vis.c.y += sum.c.y;
+    vis.d.x += sum.d.x; vis.d.y += sum.d.y;
+}
+
+static inline void add_vis(float2& vis, const double4c& sum)
+{
+    vis.x += (float) sum.a.x; vis.y += (float) sum.a.y;
+}
+
+static inline void add_vis(double2& vis, const double4c& sum)
+{
+    vis.x += sum.a.x; vis.y += sum.a.y;
+}
+
+/* Evaluates the apparent brightness of each source for matrix beams. */
+template <typename REAL, typename REAL2, typename REAL8>
+static void evaluate_brightness(const int num_sources,
+        const REAL8* restrict beam, const REAL* restrict I,
+        const REAL* restrict Q, const REAL* restrict U,
+        const REAL* restrict V, REAL* restrict x)
+{
+#pragma omp parallel for
+    for (int i = 0; i < num_sources; ++i)
+    {
+        REAL8 m1, m2, b;
+        OSKAR_CONSTRUCT_B(REAL, b, I[i], Q[i], U[i], V[i])
+        m1 = beam[i];
+        m2 = m1;
+        OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(REAL2, m1, b)
+        OSKAR_MUL_COMPLEX_MATRIX_CONJUGATE_TRANSPOSE_IN_PLACE(REAL2, m1, m2)
+        x[4 * i + 0] = m1.a.x;
+        x[4 * i + 1] = m1.b.x;
+        x[4 * i + 2] = m1.b.y;
+        x[4 * i + 3] = m1.d.x;
+    }
+}
+
+/* Evaluates the apparent brightness of each source for scalar beams. */
+template <typename REAL, typename REAL2>
+static void evaluate_brightness(const int num_sources,
+        const REAL2* restrict beam, const REAL* restrict I,
+        REAL* restrict x)
+{
+#pragma omp parallel for
+    for (int i = 0; i < num_sources; ++i)
+    {
+        const REAL2 e = beam[i];
+        x[i] = (e.x * e.x + e.y * e.y) * I[i];
+    }
+}
+
+template
+<
+// Compile-time parameters.
+bool BANDWIDTH_SMEARING, bool TIME_SMEARING, bool GAUSSIAN, bool MATRIX,
+typename REAL, typename REAL2, typename VIS
+>
+static void xcorr_apparent(
+        const int                   num_sources,
+        const int                   num_stations,
+        const REAL2* const restrict phase,
+        const REAL*  const restrict x,
+        const REAL*  const restrict source_l,
+        const REAL*  const restrict source_m,
+        const REAL*  const restrict source_n,
+        const REAL*  const restrict source_a,
+        const REAL*  const restrict source_b,
+        const REAL*  const restrict source_c,
+        const REAL*  const restrict station_u,
+        const REAL*  const restrict station_v,
+        const REAL*  const restrict station_w,
+        const REAL*  const restrict station_x,
+        const REAL*  const restrict station_y,
+        const REAL                  uv_min_lambda,
+        const REAL                  uv_max_lambda,
+        const REAL                  inv_wavelength,
+        const REAL                  frac_bandwidth,
+        const REAL                  time_int_sec,
+        const REAL                  gha0_rad,
+        const REAL                  dec0_rad,
+        const int*   const restrict baseline_mask,
+        VIS*               restrict vis)
+{
+    // Loop over stations.
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int SQ = 0; SQ < num_stations; ++SQ)
+    {
+        // Pointer to phase factors for station q.
+        const REAL2* const phase_q = &phase[SQ * num_sources];
+
+        // Loop over baselines for this station.
+        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        {
+            REAL uv_len, uu, vv, ww, uu2, vv2, uuvv, du, dv, dw;
+            double xx_re = 0.0, xx_im = 0.0, yy_re = 0.0, yy_im = 0.0;
+            double p = 0.0, q = 0.0, r = 0.0, s = 0.0;
+            double4c sum;
+
+            // Pointer to phase factors for station p.
+            const REAL2* const phase_p = &phase[SP * num_sources];
+
+            // Get common baseline values.
+            OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],
+                    station_v[SP], station_v[SQ], station_w[SP], station_w[SQ],
+                    uu, vv, ww, uu2, vv2, uuvv, uv_len);
+
+            // Apply the baseline length filter and the baseline mask.
+            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+            if (baseline_mask && !baseline_mask[
+                    oskar_evaluate_baseline_index_inline(num_stations, SP, SQ)])
+                continue;
+
+            // Compute the deltas for time-average smearing.
+            if (TIME_SMEARING)
+                OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],
+                        station_y[SP], station_y[SQ], du, dv, dw);
+
+            // Loop over sources in tiles, accumulating each tile in the
+            // working precision and the totals in double precision.
+            for (int start = 0; start < num_sources; start += TILE_SRC)
+            {
+                const int end = (start + TILE_SRC < num_sources) ?
+                        start + TILE_SRC : num_sources;
+                REAL t_xx_re = 0, t_xx_im = 0, t_yy_re = 0, t_yy_im = 0;
+                REAL t_p = 0, t_q = 0, t_r = 0, t_s = 0;
+                for (int i = start; i < end; ++i)
+                {
+                    // Form the phase factor K_p K_q^*.
+                    const REAL2 kp = phase_p[i], kq = phase_q[i];
+                    REAL t_re = kp.x * kq.x + kp.y * kq.y;
+                    REAL t_im = kp.y * kq.x - kp.x * kq.y;
+
+                    // Apply the smearing terms.
+                    if (GAUSSIAN || BANDWIDTH_SMEARING || TIME_SMEARING)
+                    {
+                        REAL smearing;
+                        if (GAUSSIAN)
+                        {
+                            const REAL t = source_a[i] * uu2 +
+                                    source_b[i] * uuvv + source_c[i] * vv2;
+                            smearing = exp((REAL) -t);
+                        }
+                        else
+                        {
+                            smearing = (REAL) 1;
+                        }
+                        if (BANDWIDTH_SMEARING || TIME_SMEARING)
+                        {
+                            const REAL l = source_l[i];
+                            const REAL m = source_m[i];
+                            const REAL n = source_n[i] - (REAL) 1;
+                            if (BANDWIDTH_SMEARING)
+                            {
+                                const REAL t = uu * l + vv * m + ww * n;
+                                smearing *= oskar_sinc<REAL>(t);
+                            }
+                            if (TIME_SMEARING)
+                            {
+                                const REAL t = du * l + dv * m + dw * n;
+                                smearing *= oskar_sinc<REAL>(t);
+                            }
+                        }
+                        t_re *= smearing;
+                        t_im *= smearing;
+                    }
+
+                    // Scale the apparent brightness and accumulate.
+                    if (MATRIX)
+                    {
+                        const REAL* const x_ = &x[4 * i];
+                        t_xx_re += t_re * x_[0];
+                        t_xx_im += t_im * x_[0];
+                        t_p += t_re * x_[1];
+                        t_q += t_im * x_[2];
+                        t_r += t_re * x_[2];
+                        t_s += t_im * x_[1];
+                        t_yy_re += t_re * x_[3];
+                        t_yy_im += t_im * x_[3];
+                    }
+                    else
+                    {
+                        t_xx_re += t_re * x[i];
+                        t_xx_im += t_im * x[i];
+                    }
+                }
+                xx_re += t_xx_re; xx_im += t_xx_im;
+                yy_re += t_yy_re; yy_im += t_yy_im;
+                p += t_p; q += t_q; r += t_r; s += t_s;
+            }
+
+            // Add result to the baseline visibility.
+            sum.a.x = xx_re; sum.a.y = xx_im;
+            sum.b.x = p - q; sum.b.y = r + s;
+            sum.c.x = p + q; sum.c.y = s - r;
+            sum.d.x = yy_re; sum.d.y = yy_im;
+            int i = oskar_evaluate_baseline_index_inline(num_stations, SP, SQ);
+            add_vis(vis[i], sum);
+        }
+    }
+}
+
+#define XCORR_KERNEL(BS, TS, GAUSSIAN, MATRIX, REAL, REAL2, VIS)           \
+        xcorr_apparent<BS, TS, GAUSSIAN, MATRIX, REAL, REAL2, VIS>          \
+        (num_sources, num_stations, d_phase, d_x, d_l, d_m, d_n,            \
+                d_a, d_b, d_c, d_station_u, d_station_v, d_station_w,       \
+                d_station_x, d_station_y, uv_min_lambda, uv_max_lambda,     \
+                inv_wavelength, frac_bandwidth, time_int_sec,               \
+                gha0_rad, dec0_rad, baseline_mask, d_vis);
+
+#define XCORR_SELECT(GAUSSIAN, MATRIX, REAL, REAL2, VIS)                   \
+        if (frac_bandwidth == (REAL)0 && time_int_sec == (REAL)0)           \
+            XCORR_KERNEL(false, false, GAUSSIAN, MATRIX, REAL, REAL2, VIS)  \
+        else if (frac_bandwidth != (REAL)0 && time_int_sec == (REAL)0)      \
+            XCORR_KERNEL(true, false, GAUSSIAN, MATRIX, REAL, REAL2, VIS)   \
+        else if (frac_bandwidth == (REAL)0 && time_int_sec != (REAL)0)      \
+            XCORR_KERNEL(false, true, GAUSSIAN, MATRIX, REAL, REAL2, VIS)   \
+        else if (frac_bandwidth != (REAL)0 && time_int_sec != (REAL)0)      \
+            XCORR_KERNEL(true, true, GAUSSIAN, MATRIX, REAL, REAL2, VIS)
+
+template <bool MATRIX, typename REAL, typename REAL2, typename VIS>
+static void xcorr_select(int use_extended, int num_sources, int num_stations,
+        const REAL2* d_phase, const REAL* d_x,
+        const REAL* d_l, const REAL* d_m, const REAL* d_n,
+        const REAL* d_a, const REAL* d_b, const REAL* d_c,
+        const REAL* d_station_u, const REAL* d_station_v,
+        const REAL* d_station_w, const REAL* d_station_x,
+        const REAL* d_station_y, REAL uv_min_lambda, REAL uv_max_lambda,
+        REAL inv_wavelength, REAL frac_bandwidth, REAL time_int_sec,
+        REAL gha0_rad, REAL dec0_rad, const int* baseline_mask, VIS* d_vis)
+{
+    if (use_extended)
+    {
+        XCORR_SELECT(true, MATRIX, REAL, REAL2, VIS)
+    }
+    else
+    {
+        XCORR_SELECT(false, MATRIX, REAL, REAL2, VIS)
+    }
+}
+
+template <bool MATRIX, typename REAL, typename REAL2, typename VIS>
+static void correlate(const oskar_Sky* sky, const oskar_Telescope* tel,
+        int n_sources, const oskar_Mem* K, const REAL* x,
+        const oskar_Mem* u, const oskar_Mem* v, const oskar_Mem* w,
+        double uv_filter_min, double uv_filter_max, double inv_wavelength,
+        double frac_bandwidth, double time_avg, double gha0, double dec0,
+        const int* baseline_mask, VIS* vis)
+{
+    const oskar_Mem *x_, *y_;
+    x_ = oskar_telescope_station_true_x_offset_ecef_metres_const(tel);
+    y_ = oskar_telescope_station_true_y_offset_ecef_metres_const(tel);
+    xcorr_select<MATRIX>(oskar_sky_use_extended(sky), n_sources,
+            oskar_telescope_num_stations(tel),
+            (const REAL2*) oskar_mem_void_const(K), x,
+            (const REAL*) oskar_mem_void_const(oskar_sky_l_const(sky)),
+            (const REAL*) oskar_mem_void_const(oskar_sky_m_const(sky)),
+            (const REAL*) oskar_mem_void_const(oskar_sky_n_const(sky)),
+            (const REAL*) oskar_mem_void_const(
+                    oskar_sky_gaussian_a_const(sky)),
+            (const REAL*) oskar_mem_void_const(
+                    oskar_sky_gaussian_b_const(sky)),
+            (const REAL*) oskar_mem_void_const(
+                    oskar_sky_gaussian_c_const(sky)),
+            (const REAL*) oskar_mem_void_const(u),
+            (const REAL*) oskar_mem_void_const(v),
+            (const REAL*) oskar_mem_void_const(w),
+            (const REAL*) oskar_mem_void_const(x_),
+            (const REAL*) oskar_mem_void_const(y_),
+            (REAL) uv_filter_min, (REAL) uv_filter_max,
+            (REAL) inv_wavelength, (REAL) frac_bandwidth, (REAL) time_avg,
+            (REAL) gha0, (REAL) dec0, baseline_mask, vis);
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_cross_correlate_apparent(oskar_Mem* vis, int n_sources,
+        const oskar_Jones* beam, const oskar_Jones* K, const oskar_Sky* sky,
+        const oskar_Telescope* tel, const oskar_Mem* u, const oskar_Mem* v,
+        const oskar_Mem* w, const oskar_Mem* baseline_mask, double gast,
+        double frequency_hz, int* status)
+{
+    int type, prec, n_stations;
+    double inv_wavelength, frac_bandwidth, time_avg, gha0, dec0;
+    double uv_filter_min, uv_filter_max;
+    const oskar_Mem *E, *I, *Q, *U, *V;
+    const int* mask = 0;
+    void* x = 0;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Check data locations. */
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU ||
+            oskar_jones_mem_location(beam) != OSKAR_CPU ||
+            oskar_jones_mem_location(K) != OSKAR_CPU ||
+            oskar_telescope_mem_location(tel) != OSKAR_CPU ||
+            oskar_mem_location(vis) != OSKAR_CPU ||
+            oskar_mem_location(u) != OSKAR_CPU ||
+            oskar_mem_location(v) != OSKAR_CPU ||
+            oskar_mem_location(w) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Check data types. */
+    type = oskar_mem_type(vis);
+    prec = oskar_type_precision(type);
+    if (oskar_jones_type(beam) != type ||
+            oskar_jones_type(K) != (prec | OSKAR_COMPLEX) ||
+            oskar_sky_precision(sky) != prec ||
+            oskar_mem_type(u) != prec || oskar_mem_type(v) != prec ||
+            oskar_mem_type(w) != prec)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (prec != OSKAR_SINGLE && prec != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+
+    /* Check dimensions. */
+    n_stations = oskar_telescope_num_stations(tel);
+    if (oskar_jones_num_sources(beam) < n_sources ||
+            oskar_jones_num_sources(K) != n_sources ||
+            oskar_jones_num_stations(K) != n_stations ||
+            (int)oskar_mem_length(u) != n_stations ||
+            (int)oskar_mem_length(v) != n_stations ||
+            (int)oskar_mem_length(w) != n_stations ||
+            (int)oskar_mem_length(vis) < oskar_telescope_num_baselines(tel))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (baseline_mask)
+    {
+        if (oskar_mem_location(baseline_mask) != OSKAR_CPU)
+        {
+            *status = OSKAR_ERR_BAD_LOCATION;
+            return;
+        }
+        if ((int)oskar_mem_length(baseline_mask) <
+                oskar_telescope_num_baselines(tel))
+        {
+            *status = OSKAR_ERR_DIMENSION_MISMATCH;
+            return;
+        }
+        mask = oskar_mem_int_const(baseline_mask, status);
+        if (*status) return;
+    }
+    if (n_sources == 0) return;
+
+    /* Get bandwidth-smearing terms. */
+    frequency_hz = fabs(frequency_hz);
+    inv_wavelength = frequency_hz / 299792458.0;
+    frac_bandwidth = oskar_telescope_channel_bandwidth_hz(tel) / frequency_hz;
+
+    /* Get time-average smearing term and Greenwich hour angle. */
+    time_avg = oskar_telescope_time_average_sec(tel);
+    gha0 = gast - oskar_telescope_phase_centre_ra_rad(tel);
+    dec0 = oskar_telescope_phase_centre_dec_rad(tel);
+
+    /* Get UV filter parameters in wavelengths. */
+    uv_filter_min = oskar_telescope_uv_filter_min(tel);
+    uv_filter_max = oskar_telescope_uv_filter_max(tel);
+    if (oskar_telescope_uv_filter_units(tel) == OSKAR_METRES)
+    {
+        uv_filter_min *= inv_wavelength;
+        uv_filter_max *= inv_wavelength;
+    }
+    if (uv_filter_max < 0.0 || uv_filter_max > FLT_MAX)
+        uv_filter_max = FLT_MAX;
+
+    /* Evaluate the apparent brightness of each source. */
+    x = malloc((oskar_type_is_matrix(type) ? 4 : 1) * (size_t) n_sources *
+            oskar_mem_element_size(prec));
+    if (!x)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    E = oskar_jones_mem_const(beam);
+    I = oskar_sky_I_const(sky);
+    Q = oskar_sky_Q_const(sky);
+    U = oskar_sky_U_const(sky);
+    V = oskar_sky_V_const(sky);
+    switch (type)
+    {
+    case OSKAR_SINGLE_COMPLEX_MATRIX:
+        evaluate_brightness<float, float2, float4c>(n_sources,
+                oskar_mem_float4c_const(E, status),
+                oskar_mem_float_const(I, status),
+                oskar_mem_float_const(Q, status),
+                oskar_mem_float_const(U, status),
+                oskar_mem_float_const(V, status), (float*) x);
+        correlate<true, float, float2>(sky, tel, n_sources,
+                oskar_jones_mem_const(K), (const float*) x, u, v, w,
+                uv_filter_min, uv_filter_max, inv_wavelength,
+                frac_bandwidth, time_avg, gha0, dec0, mask,
+                oskar_mem_float4c(vis, status));
+        break;
+    case OSKAR_DOUBLE_COMPLEX_MATRIX:
+        evaluate_brightness<double, double2, double4c>(n_sources,
+                oskar_mem_double4c_const(E, status),
+                oskar_mem_double_const(I, status),
+                oskar_mem_double_const(Q, status),
+                oskar_mem_double_const(U, status),
+                oskar_mem_double_const(V, status), (double*) x);
+        correlate<true, double, double2>(sky, tel, n_sources,
+                oskar_jones_mem_const(K), (const double*) x, u, v, w,
+                uv_filter_min, uv_filter_max, inv_wavelength,
+                frac_bandwidth, time_avg, gha0, dec0, mask,
+                oskar_mem_double4c(vis, status));
+        break;
+    case OSKAR_SINGLE_COMPLEX:
+        evaluate_brightness<float, float2>(n_sources,
+                oskar_mem_float2_const(E, status),
+                oskar_mem_float_const(I, status), (float*) x);
+        correlate<false, float, float2>(sky, tel, n_sources,
+                oskar_jones_mem_const(K), (const float*) x, u, v, w,
+                uv_filter_min, uv_filter_max, inv_wavelength,
+                frac_bandwidth, time_avg, gha0, dec0, mask,
+                oskar_mem_float2(vis, status));
+        break;
+    case OSKAR_DOUBLE_COMPLEX:
+        evaluate_brightness<double, double2>(n_sources,
+                oskar_mem_double2_const(E, status),
+                oskar_mem_double_const(I, status), (double*) x);
+        correlate<false, double, double2>(sky, tel, n_sources,
+                oskar_jones_mem_const(K), (const double*) x, u, v, w,
+                uv_filter_min, uv_filter_max, inv_wavelength,
+                frac_bandwidth, time_avg, gha0, dec0, mask,
+                oskar_mem_double2(vis, status));
+        break;
+    default:
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        break;
+    }
+    free(x);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,489 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "correlate/private_correlate_functions_inline.h"
+#include "correlate/oskar_cross_correlate_gemm_omp.h"
+#include "mem/oskar_mem.h"
+
+#include <cstdlib>
+
+/*
+ * The visibilities for all baselines are the upper triangle of J B J^H.
+ * The brightness matrices are multiplied into the Jones matrices of each
+ * station once per source tile (giving A = J B), and the product A J^H is
+ * then formed tile by tile, accumulating the partial sums for each baseline
+ * in double precision.
+ *
+ * With a BLAS library, the product is instead formed as a Hermitian
+ * rank-k update. Each brightness matrix is split into its eigenvalues and
+ * eigenvectors, B = sum_k lambda_k v_k v_k^H, so that J B J^H = X X^H - Y Y^H,
+ * where the columns of X are sqrt(lambda_k) J v_k for the positive
+ * eigenvalues, and those of Y are sqrt(-lambda_k) J v_k for the negative
+ * ones. Y is needed only if a source in the tile is not physical
+ * (I^2 < Q^2 + U^2 + V^2 or I < 0), and only one triangle is evaluated.
+ *
+ * The in-tree kernel packs the Jones matrices of BLOCK_Q stations so that
+ * the innermost loop runs over the stations in the block: this loop carries
+ * no dependency and is vectorised by the compiler, while the accumulators
+ * for the block stay in registers. Stations are processed in blocks of
+ * BLOCK_P so that each packed panel is reused while it is in cache.
+ */
+
+/* Number of sources in each tile. */
+#define TILE_SRC 128
+
+/* Number of stations in a register block. */
+#define BLOCK_Q 4
+
+/* Number of stations in a cache block. */
+#define BLOCK_P 8
+
+#ifdef OSKAR_HAVE_BLAS
+/* Number of sources in each tile when using BLAS. */
+#define TILE_SRC_BLAS 512
+
+extern "C" {
+void cherk_(const char* uplo, const char* trans, const int* n, const int* k,
+        const float* alpha, const float* a, const int* lda,
+        const float* beta, float* c, const int* ldc);
+void zherk_(const char* uplo, const char* trans, const int* n, const int* k,
+        const double* alpha, const double* a, const int* lda,
+        const double* beta, double* c, const int* ldc);
+}
+
+/* Evaluates the lower triangle of C = alpha A A^H + beta C. */
+static void herk_ln(int m, int k, float alpha, const float* a, float beta,
+        float* c)
+{
+    cherk_("L", "N", &m, &k, &alpha, a, &m, &beta, c, &m);
+}
+
+static void herk_ln(int m, int k, double alpha, const double* a, double beta,
+        double* c)
+{
+    zherk_("L", "N", &m, &k, &alpha, a, &m, &beta, c, &m);
+}
+
+/* Evaluates the eigenvalues and unit eigenvectors of the brightness matrix
+ * B = [I + Q, U + iV; U - iV, I - Q]. */
+template <typename REAL>
+OSKAR_INLINE void brightness_eigen(const REAL I, const REAL Q,
+        const REAL U, const REAL V, REAL lambda[2], REAL vec[2][4])
+{
+    const REAL P = sqrt(Q * Q + U * U + V * V);
+    lambda[0] = I + P;
+    lambda[1] = I - P;
+    if (P == (REAL) 0)
+    {
+        vec[0][0] = (REAL) 1; vec[0][1] = vec[0][2] = vec[0][3] = (REAL) 0;
+        vec[1][2] = (REAL) 1; vec[1][0] = vec[1][1] = vec[1][3] = (REAL) 0;
+        return;
+    }
+
+    /* Choose the form of the eigenvector that avoids cancellation. */
+    if (Q >= (REAL) 0)
+    {
+        const REAL s = (REAL) 1 / sqrt((REAL) 2 * P * (P + Q));
+        vec[0][0] = (P + Q) * s; vec[0][1] = (REAL) 0;
+        vec[0][2] = U * s;       vec[0][3] = -V * s;
+    }
+    else
+    {
+        const REAL s = (REAL) 1 / sqrt((REAL) 2 * P * (P - Q));
+        vec[0][0] = U * s;       vec[0][1] = V * s;
+        vec[0][2] = (P - Q) * s; vec[0][3] = (REAL) 0;
+    }
+
+    /* The second eigenvector is orthogonal to the first. */
+    vec[1][0] = -vec[0][2]; vec[1][1] = vec[0][3];
+    vec[1][2] = vec[0][0];  vec[1][3] = -vec[0][1];
+}
+#endif
+
+/* Evaluates A = J B for one station and source. */
+template <typename REAL, int MATRIX>
+OSKAR_INLINE void apply_brightness(const REAL* j, const REAL I,
+        const REAL Q, const REAL U, const REAL V, REAL* a)
+{
+    if (MATRIX)
+    {
+        /* B = [I + Q, U + iV; U - iV, I - Q] */
+        const REAL xx = I + Q, yy = I - Q;
+        a[0] = j[0] * xx + j[2] * U + j[3] * V;
+        a[1] = j[1] * xx + j[3] * U - j[2] * V;
+        a[2] = j[0] * U - j[1] * V + j[2] * yy;
+        a[3] = j[1] * U + j[0] * V + j[3] * yy;
+        a[4] = j[4] * xx + j[6] * U + j[7] * V;
+        a[5] = j[5] * xx + j[7] * U - j[6] * V;
+        a[6] = j[4] * U - j[5] * V + j[6] * yy;
+        a[7] = j[5] * U + j[4] * V + j[7] * yy;
+    }
+    else
+    {
+        a[0] = j[0] * I;
+        a[1] = j[1] * I;
+    }
+}
+
+/* Multiplies A for one station with J^H for a block of stations. */
+template <typename REAL, int MATRIX>
+OSKAR_INLINE void block_product(const int num_src,
+        const REAL* restrict a, const REAL* restrict t,
+        REAL acc[][BLOCK_Q])
+{
+    const int NC = MATRIX ? 8 : 2;
+    for (int k = 0; k < NC; ++k)
+        for (int q = 0; q < BLOCK_Q; ++q)
+            acc[k][q] = (REAL) 0;
+    for (int s = 0; s < num_src; ++s, a += NC, t += NC * BLOCK_Q)
+    {
+        if (MATRIX)
+        {
+            const REAL a0r = a[0], a0i = a[1], a1r = a[2], a1i = a[3];
+            const REAL a2r = a[4], a2i = a[5], a3r = a[6], a3i = a[7];
+            for (int q = 0; q < BLOCK_Q; ++q)
+            {
+                const REAL b0r = t[0 * BLOCK_Q + q], b0i = t[1 * BLOCK_Q + q];
+                const REAL b1r = t[2 * BLOCK_Q + q], b1i = t[3 * BLOCK_Q + q];
+                const REAL b2r = t[4 * BLOCK_Q + q], b2i = t[5 * BLOCK_Q + q];
+                const REAL b3r = t[6 * BLOCK_Q + q], b3i = t[7 * BLOCK_Q + q];
+                acc[0][q] += a0r * b0r + a0i * b0i + a1r * b1r + a1i * b1i;
+                acc[1][q] += a0i * b0r - a0r * b0i + a1i * b1r - a1r * b1i;
+                acc[2][q] += a0r * b2r + a0i * b2i + a1r * b3r + a1i * b3i;
+                acc[3][q] += a0i * b2r - a0r * b2i + a1i * b3r - a1r * b3i;
+                acc[4][q] += a2r * b0r + a2i * b0i + a3r * b1r + a3i * b1i;
+                acc[5][q] += a2i * b0r - a2r * b0i + a3i * b1r - a3r * b1i;
+                acc[6][q] += a2r * b2r + a2i * b2i + a3r * b3r + a3i * b3i;
+                acc[7][q] += a2i * b2r - a2r * b2i + a3i * b3r - a3r * b3i;
+            }
+        }
+        else
+        {
+            const REAL ar = a[0], ai = a[1];
+            for (int q = 0; q < BLOCK_Q; ++q)
+            {
+                const REAL br = t[q], bi = t[BLOCK_Q + q];
+                acc[0][q] += ar * br + ai * bi;
+                acc[1][q] += ai * br - ar * bi;
+            }
+        }
+    }
+}
+
+template <typename REAL, int MATRIX>
+static void oskar_xcorr_gemm_omp(
+        const int                   num_sources,
+        const int                   num_stations,
+        const REAL*  const restrict jones,
+        const REAL*  const restrict source_I,
+        const REAL*  const restrict source_Q,
+        const REAL*  const restrict source_U,
+        const REAL*  const restrict source_V,
+        const REAL*  const restrict station_u,
+        const REAL*  const restrict station_v,
+        const REAL                  uv_min_lambda,
+        const REAL                  uv_max_lambda,
+        const REAL                  inv_wavelength,
+        const int*   const restrict baseline_mask,
+        REAL*              restrict vis,
+        int*                        status)
+{
+    const int NC = MATRIX ? 8 : 2; /* Number of reals per Jones term. */
+    if (*status || num_sources == 0 || num_stations < 2) return;
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    double* sum = (double*) calloc((size_t) num_baselines * NC, sizeof(double));
+#ifdef OSKAR_HAVE_BLAS
+    /* Pack tiles into column-major matrices and use the BLAS library. */
+    const int NP = MATRIX ? 2 : 1; /* Number of polarisations. */
+    const int m = NP * num_stations;
+    REAL *x_cm, *y_cm, *c;
+    x_cm = (REAL*) malloc((size_t) 2 * m * NP * TILE_SRC_BLAS * sizeof(REAL));
+    y_cm = (REAL*) malloc((size_t) 2 * m * NP * TILE_SRC_BLAS * sizeof(REAL));
+    c = (REAL*) malloc((size_t) 2 * m * m * sizeof(REAL));
+    if (!sum || !x_cm || !y_cm || !c)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        free(x_cm);
+        free(y_cm);
+        free(c);
+        free(sum);
+        return;
+    }
+    for (int s0 = 0; s0 < num_sources; s0 += TILE_SRC_BLAS)
+    {
+        int negative = 0;
+        const int num_src = (num_sources - s0 < TILE_SRC_BLAS) ?
+                num_sources - s0 : TILE_SRC_BLAS;
+#pragma omp parallel for schedule(static) reduction(|:negative)
+        for (int p = 0; p < num_stations; ++p)
+        {
+            for (int s = 0; s < num_src; ++s)
+            {
+                REAL lambda[2], vec[2][4];
+                const int i_src = s0 + s;
+                const REAL* j = &jones[((size_t) p * num_sources + i_src) * NC];
+                if (MATRIX)
+                    brightness_eigen<REAL>(source_I[i_src], source_Q[i_src],
+                            source_U[i_src], source_V[i_src], lambda, vec);
+                else
+                {
+                    lambda[0] = source_I[i_src];
+                    vec[0][0] = (REAL) 1; vec[0][1] = (REAL) 0;
+                }
+                for (int k = 0; k < NP; ++k)
+                {
+                    const REAL scale = sqrt(fabs(lambda[k]));
+                    REAL *x, *y;
+                    if (lambda[k] < (REAL) 0)
+                    {
+                        x = y_cm; y = x_cm;
+                        negative = 1;
+                    }
+                    else
+                    {
+                        x = x_cm; y = y_cm;
+                    }
+                    for (int i = 0; i < NP; ++i)
+                    {
+                        /* Row i of J_p multiplied by eigenvector k. */
+                        REAL re = (REAL) 0, im = (REAL) 0;
+                        for (int l = 0; l < NP; ++l)
+                        {
+                            const REAL jr = j[2 * (i * NP + l)];
+                            const REAL ji = j[2 * (i * NP + l) + 1];
+                            const REAL vr = vec[k][2 * l];
+                            const REAL vi = vec[k][2 * l + 1];
+                            re += jr * vr - ji * vi;
+                            im += jr * vi + ji * vr;
+                        }
+                        const size_t o = 2 * ((size_t)(s * NP + k) * m +
+                                p * NP + i);
+                        x[o] = scale * re; x[o + 1] = scale * im;
+                        y[o] = y[o + 1] = (REAL) 0;
+                    }
+                }
+            }
+        }
+        herk_ln(m, NP * num_src, (REAL) 1, x_cm, (REAL) 0, c);
+        if (negative)
+            herk_ln(m, NP * num_src, (REAL) -1, y_cm, (REAL) 1, c);
+#pragma omp parallel for schedule(static)
+        for (int p = 1; p < num_stations; ++p)
+        {
+            for (int q = 0; q < p; ++q)
+            {
+                double* t = &sum[(size_t) NC *
+                        oskar_evaluate_baseline_index_inline(
+                                num_stations, p, q)];
+                for (int i = 0; i < NP; ++i)
+                {
+                    for (int j = 0; j < NP; ++j)
+                    {
+                        const size_t o = 2 * ((size_t)(q * NP + j) * m +
+                                p * NP + i);
+                        t[2 * (i * NP + j)]     += c[o];
+                        t[2 * (i * NP + j) + 1] += c[o + 1];
+                    }
+                }
+            }
+        }
+    }
+    free(x_cm);
+    free(y_cm);
+    free(c);
+#else
+    /* Use the blocked kernel. */
+    const int num_blocks_p = (num_stations + BLOCK_P - 1) / BLOCK_P;
+    const int num_blocks_q = (num_stations + BLOCK_Q - 1) / BLOCK_Q;
+    REAL *a_tile, *j_tile;
+    a_tile = (REAL*) malloc((size_t) num_stations * TILE_SRC * NC *
+            sizeof(REAL));
+    j_tile = (REAL*) calloc((size_t) num_blocks_q * BLOCK_Q * TILE_SRC * NC,
+            sizeof(REAL));
+    if (!sum || !a_tile || !j_tile)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        free(a_tile);
+        free(j_tile);
+        free(sum);
+        return;
+    }
+#pragma omp parallel
+    {
+        for (int s0 = 0; s0 < num_sources; s0 += TILE_SRC)
+        {
+            const int num_src = (num_sources - s0 < TILE_SRC) ?
+                    num_sources - s0 : TILE_SRC;
+
+            /* Pack the tile. */
+#pragma omp for schedule(static)
+            for (int p = 0; p < num_stations; ++p)
+            {
+                const int b = p / BLOCK_Q, q = p - b * BLOCK_Q;
+                for (int s = 0; s < num_src; ++s)
+                {
+                    const int i_src = s0 + s;
+                    const REAL* j =
+                            &jones[((size_t) p * num_sources + i_src) * NC];
+                    REAL* t = &j_tile[((size_t) b * TILE_SRC + s) *
+                            NC * BLOCK_Q + q];
+                    for (int k = 0; k < NC; ++k)
+                        t[k * BLOCK_Q] = j[k];
+                    apply_brightness<REAL, MATRIX>(j, source_I[i_src],
+                            MATRIX ? source_Q[i_src] : 0,
+                            MATRIX ? source_U[i_src] : 0,
+                            MATRIX ? source_V[i_src] : 0,
+                            &a_tile[((size_t) p * TILE_SRC + s) * NC]);
+                }
+            }
+
+            /* Multiply the tile, starting with the largest blocks. */
+#pragma omp for schedule(dynamic, 1)
+            for (int bp = num_blocks_p - 1; bp >= 0; --bp)
+            {
+                REAL acc[8][BLOCK_Q];
+                const int p_start = bp * BLOCK_P;
+                const int p_end = (p_start + BLOCK_P < num_stations) ?
+                        p_start + BLOCK_P : num_stations;
+                for (int bq = 0; bq * BLOCK_Q < p_end - 1; ++bq)
+                {
+                    const int q_start = bq * BLOCK_Q;
+                    const REAL* t =
+                            &j_tile[(size_t) bq * TILE_SRC * NC * BLOCK_Q];
+                    for (int p = (p_start > q_start) ? p_start : q_start + 1;
+                            p < p_end; ++p)
+                    {
+                        block_product<REAL, MATRIX>(num_src,
+                                &a_tile[(size_t) p * TILE_SRC * NC], t, acc);
+                        for (int q = 0; q < BLOCK_Q && q_start + q < p; ++q)
+                        {
+                            double* out = &sum[(size_t) NC *
+                                    oskar_evaluate_baseline_index_inline(
+                                            num_stations, p, q_start + q)];
+                            for (int k = 0; k < NC; ++k)
+                                out[k] += acc[k][q];
+                        }
+                    }
+                }
+            }
+        }
+    }
+    free(a_tile);
+    free(j_tile);
+#endif
+
+    /* Apply the baseline filter and mask, and add to the visibilities. */
+#pragma omp parallel for schedule(static)
+    for (int q = 0; q < num_stations; ++q)
+    {
+        for (int p = q + 1; p < num_stations; ++p)
+        {
+            const REAL uu = (station_u[p] - station_u[q]) * inv_wavelength;
+            const REAL vv = (station_v[p] - station_v[q]) * inv_wavelength;
+            const REAL uv_len = sqrt(uu * uu + vv * vv);
+            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+            const int b =
+                    oskar_evaluate_baseline_index_inline(num_stations, p, q);
+            if (baseline_mask && !baseline_mask[b]) continue;
+            const size_t i = (size_t) NC * b;
+            for (int k = 0; k < NC; ++k)
+                vis[i + k] += (REAL) sum[i + k];
+        }
+    }
+    free(sum);
+}
+
+void oskar_cross_correlate_point_gemm_omp_f(
+        int num_sources, int num_stations, const float4c* jones,
+        const float* I, const float* Q, const float* U, const float* V,
+        const float* station_u, const float* station_v,
+        float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
+        const int* baseline_mask, float4c* vis, int* status)
+{
+    oskar_xcorr_gemm_omp<float, 1>(num_sources, num_stations,
+            (const float*) jones, I, Q, U, V, station_u, station_v,
+            uv_min_lambda, uv_max_lambda, inv_wavelength, baseline_mask,
+            (float*) vis, status);
+}
+
+void oskar_cross_correlate_point_gemm_omp_d(
+        int num_sources, int num_stations, const double4c* jones,
+        const double* I, const double* Q, const double* U, const double* V,
+        const double* station_u, const double* station_v,
+        double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
+        const int* baseline_mask, double4c* vis, int* status)
+{
+    oskar_xcorr_gemm_omp<double, 1>(num_sources, num_stations,
+            (const double*) jones, I, Q, U, V, station_u, station_v,
+            uv_min_lambda, uv_max_lambda, inv_wavelength, baseline_mask,
+            (double*) vis, status);
+}
+
+void oskar_cross_correlate_scalar_point_gemm_omp_f(
+        int num_sources, int num_stations, const float2* jones,
+        const float* I, const float* station_u, const float* station_v,
+        float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
+        const int* baseline_mask, float2* vis, int* status)
+{
+    oskar_xcorr_gemm_omp<float, 0>(num_sources, num_stations,
+            (const float*) jones, I, 0, 0, 0, station_u, station_v,
+            uv_min_lambda, uv_max_lambda, inv_wavelength, baseline_mask,
+            (float*) vis, status);
+}
+
+void oskar_cross_correlate_scalar_point_gemm_omp_d(
+        int num_sources, int num_stations, const double2* jones,
+        const double* I, const double* station_u, const double* station_v,
+        double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
+        const int* baseline_mask, double2* vis, int* status)
+{
+    oskar_xcorr_gemm_omp<double, 0>(num_sources, num_stations,
+            (const double*) jones, I, 0, 0, 0, station_u, station_v,
+            uv_min_lambda, uv_max_lambda, inv_wavelength, baseline_mask,
+            (double*) vis, status);
+}
+
+size_t oskar_cross_correlate_gemm_omp_memory_bytes(int vis_type,
+        int num_stations)
+{
+    const int NP = oskar_type_is_matrix(vis_type) ? 2 : 1;
+    const int NC = 2 * NP * NP;
+    const size_t real_size = oskar_type_is_double(vis_type) ?
+            sizeof(double) : sizeof(float);
+    const size_t n = (size_t) num_stations;
+    if (num_stations < 2) return 0;
+    size_t bytes = n * (n - 1) / 2 * NC * sizeof(double);
+#ifdef OSKAR_HAVE_BLAS
+    const size_t m = NP * n;
+    bytes += (4 * m * NP * TILE_SRC_BLAS + 2 * m * m) * real_size;
+#else
+    const size_t num_blocks_q = (n + BLOCK_Q - 1) / BLOCK_Q;
+    bytes += (n + num_blocks_q * BLOCK_Q) * TILE_SRC * NC * real_size;
+#endif
+    return bytes;
+}
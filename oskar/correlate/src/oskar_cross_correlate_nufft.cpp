@@ -0,0 +1,441 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "correlate/oskar_cross_correlate_nufft.h"
+#include "correlate/private_correlate_functions_inline.h"
+#include "math/oskar_nufft3.h"
+
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+using std::vector;
+
+/*
+ * With a common beam, the visibility on baseline p-q is
+ *
+ *   V_pq = sum_s X_s exp(2 pi i (u_pq l_s + v_pq m_s + w_pq (n_s - 1)))
+ *
+ * where X = E B E^H is the apparent brightness of source s and
+ * (u_pq, v_pq, w_pq) is the baseline in wavelengths. For matrices, each of
+ * the four elements of X is the strength of a separate transform: as only
+ * baselines with p > q are evaluated, the off-diagonal terms can not be
+ * obtained from each other.
+ */
+
+/* Gets the positions and apparent brightness of sources for matrix beams. */
+template <typename REAL, typename REAL2, typename REAL8>
+static void get_sources(const int num_sources, const REAL8* beam,
+        const REAL* I, const REAL* Q, const REAL* U, const REAL* V,
+        const REAL* l, const REAL* m, const REAL* n,
+        double min_jy, double max_jy, vector<double>& x, vector<double>& y,
+        vector<double>& z, vector<double2>& c)
+{
+    for (int i = 0; i < num_sources; ++i)
+    {
+        REAL8 m1, m2, b;
+        double2 t;
+        if (!(I[i] > min_jy && I[i] <= max_jy)) continue;
+        OSKAR_CONSTRUCT_B(REAL, b, I[i], Q[i], U[i], V[i])
+        m1 = beam[i];
+        m2 = m1;
+        OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(REAL2, m1, b)
+        OSKAR_MUL_COMPLEX_MATRIX_CONJUGATE_TRANSPOSE_IN_PLACE(REAL2, m1, m2)
+        x.push_back(l[i]);
+        y.push_back(m[i]);
+        z.push_back(n[i] - 1.0);
+        t.x = m1.a.x; t.y = 0.0; c.push_back(t);
+        t.x = m1.b.x; t.y = m1.b.y; c.push_back(t);
+        t.y = -t.y; c.push_back(t);
+        t.x = m1.d.x; t.y = 0.0; c.push_back(t);
+    }
+}
+
+/* Gets the positions and apparent brightness of sources for scalar beams. */
+template <typename REAL, typename REAL2>
+static void get_sources(const int num_sources, const REAL2* beam,
+        const REAL* I, const REAL* l, const REAL* m, const REAL* n,
+        double min_jy, double max_jy, vector<double>& x, vector<double>& y,
+        vector<double>& z, vector<double2>& c)
+{
+    for (int i = 0; i < num_sources; ++i)
+    {
+        double2 t;
+        if (!(I[i] > min_jy && I[i] <= max_jy)) continue;
+        const REAL2 e = beam[i];
+        x.push_back(l[i]);
+        y.push_back(m[i]);
+        z.push_back(n[i] - 1.0);
+        t.x = (e.x * e.x + e.y * e.y) * I[i]; t.y = 0.0;
+        c.push_back(t);
+    }
+}
+
+/* Gets the coordinates of baselines that pass the UV filter and are not
+ * masked out, as angular frequencies. */
+template <typename REAL>
+static void get_baselines(const int num_stations, const REAL* u,
+        const REAL* v, const REAL* w, double inv_wavelength,
+        double uv_min_lambda, double uv_max_lambda, const int* baseline_mask,
+        vector<double>& s, vector<double>& t, vector<double>& q,
+        vector<int>& index)
+{
+    const double f = 2.0 * M_PI * inv_wavelength;
+    for (int SQ = 0; SQ < num_stations; ++SQ)
+    {
+        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        {
+            const double uu = (u[SP] - u[SQ]) * inv_wavelength;
+            const double vv = (v[SP] - v[SQ]) * inv_wavelength;
+            const double uv_len = sqrt(uu * uu + vv * vv);
+            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+            const int b = oskar_evaluate_baseline_index_inline(
+                    num_stations, SP, SQ);
+            if (baseline_mask && !baseline_mask[b]) continue;
+            s.push_back(f * (u[SP] - u[SQ]));
+            t.push_back(f * (v[SP] - v[SQ]));
+            q.push_back(f * (w[SP] - w[SQ]));
+            index.push_back(b);
+        }
+    }
+}
+
+static inline void add_vis(float4c& vis, const double2* f)
+{
+    vis.a.x += (float) f[0].x; vis.a.y += (float) f[0].y;
+    vis.b.x += (float) f[1].x; vis.b.y += (float) f[1].y;
+    vis.c.x += (float) f[2].x; vis.c.y += (float) f[2].y;
+    vis.d.x += (float) f[3].x; vis.d.y += (float) f[3].y;
+}
+
+static inline void add_vis(double4c& vis, const double2* f)
+{
+    vis.a.x += f[0].x; vis.a.y += f[0].y;
+    vis.b.x += f[1].x; vis.b.y += f[1].y;
+    vis.c.x += f[2].x; vis.c.y += f[2].y;
+    vis.d.x += f[3].x; vis.d.y += f[3].y;
+}
+
+static inline void add_vis(float2& vis, const double2* f)
+{
+    vis.x += (float) f[0].x; vis.y += (float) f[0].y;
+}
+
+static inline void add_vis(double2& vis, const double2* f)
+{
+    vis.x += f[0].x; vis.y += f[0].y;
+}
+
+template <typename REAL, typename VIS>
+static void correlate(int num_sources, const vector<double>& x,
+        const vector<double>& y, const vector<double>& z,
+        int num_trans, const vector<double2>& c, const oskar_Telescope* tel,
+        const oskar_Mem* u, const oskar_Mem* v, const oskar_Mem* w,
+        double inv_wavelength, double uv_min_lambda, double uv_max_lambda,
+        double tolerance, const int* baseline_mask, VIS* vis, int* status)
+{
+    vector<double> s, t, q;
+    vector<int> index;
+    get_baselines(oskar_telescope_num_stations(tel),
+            (const REAL*) oskar_mem_void_const(u),
+            (const REAL*) oskar_mem_void_const(v),
+            (const REAL*) oskar_mem_void_const(w), inv_wavelength,
+            uv_min_lambda, uv_max_lambda, baseline_mask, s, t, q, index);
+    const int num_baselines = (int) index.size();
+    if (num_sources == 0 || num_baselines == 0) return;
+    vector<double2> f(num_baselines * num_trans);
+    oskar_nufft3(num_sources, &x[0], &y[0], &z[0], num_trans, &c[0],
+            num_baselines, &s[0], &t[0], &q[0], 1, tolerance, &f[0], status);
+    if (*status) return;
+    for (int i = 0; i < num_baselines; ++i)
+        add_vis(vis[index[i]], &f[i * num_trans]);
+}
+
+template <typename REAL>
+static void get_range(int num, const REAL* a, double offset, double* range)
+{
+    if (num == 0)
+    {
+        range[0] = range[1] = 0.0;
+        return;
+    }
+    range[0] = range[1] = a[0] + offset;
+    for (int i = 1; i < num; ++i)
+    {
+        const double val = a[i] + offset;
+        if (val < range[0]) range[0] = val;
+        if (val > range[1]) range[1] = val;
+    }
+}
+
+template <typename REAL>
+static double cost(int num_sources, int num_trans, const oskar_Sky* sky,
+        const oskar_Telescope* tel, const oskar_Mem* u, const oskar_Mem* v,
+        const oskar_Mem* w, double inv_wavelength, double tolerance)
+{
+    double point_range[3], target_range[3], r[2];
+    const oskar_Mem* station[] = {u, v, w};
+    const oskar_Mem* source[] = {oskar_sky_l_const(sky),
+            oskar_sky_m_const(sky), oskar_sky_n_const(sky)};
+    const int num_stations = oskar_telescope_num_stations(tel);
+    for (int d = 0; d < 3; ++d)
+    {
+        get_range(num_sources, (const REAL*) oskar_mem_void_const(source[d]),
+                d == 2 ? -1.0 : 0.0, r);
+        point_range[d] = r[1] - r[0];
+        get_range(num_stations,
+                (const REAL*) oskar_mem_void_const(station[d]), 0.0, r);
+        target_range[d] = 4.0 * M_PI * inv_wavelength * (r[1] - r[0]);
+    }
+
+    // The direct sum uses phase factors evaluated once per station, so each
+    // source on each baseline costs less than a term of a direct transform.
+    return oskar_nufft3_cost(num_sources,
+            oskar_telescope_num_baselines(tel), num_trans,
+            point_range, target_range, tolerance, 0) *
+            (20.0 + 4.0 * num_trans) / (4.0 + 4.0 * num_trans);
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_cross_correlate_nufft(oskar_Mem* vis, int n_sources,
+        const oskar_Jones* beam, const oskar_Sky* sky,
+        const oskar_Telescope* tel, const oskar_Mem* u, const oskar_Mem* v,
+        const oskar_Mem* w, const oskar_Mem* baseline_mask,
+        double frequency_hz, double source_min_jy, double source_max_jy,
+        double tolerance, int* status)
+{
+    int type, prec, n_stations;
+    double inv_wavelength, uv_filter_min, uv_filter_max;
+    const oskar_Mem *E, *I, *Q, *U, *V, *l, *m, *n;
+    const int* mask = 0;
+    vector<double> x, y, z;
+    vector<double2> c;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Check data locations. */
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU ||
+            oskar_jones_mem_location(beam) != OSKAR_CPU ||
+            oskar_telescope_mem_location(tel) != OSKAR_CPU ||
+            oskar_mem_location(vis) != OSKAR_CPU ||
+            oskar_mem_location(u) != OSKAR_CPU ||
+            oskar_mem_location(v) != OSKAR_CPU ||
+            oskar_mem_location(w) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Check data types. */
+    type = oskar_mem_type(vis);
+    prec = oskar_type_precision(type);
+    if (oskar_jones_type(beam) != type ||
+            oskar_sky_precision(sky) != prec ||
+            oskar_mem_type(u) != prec || oskar_mem_type(v) != prec ||
+            oskar_mem_type(w) != prec)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (prec != OSKAR_SINGLE && prec != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+
+    /* Check dimensions. */
+    n_stations = oskar_telescope_num_stations(tel);
+    if (oskar_jones_num_sources(beam) < n_sources ||
+            oskar_sky_num_sources(sky) < n_sources ||
+            (int)oskar_mem_length(u) != n_stations ||
+            (int)oskar_mem_length(v) != n_stations ||
+            (int)oskar_mem_length(w) != n_stations ||
+            (int)oskar_mem_length(vis) < oskar_telescope_num_baselines(tel))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (baseline_mask)
+    {
+        if (oskar_mem_location(baseline_mask) != OSKAR_CPU)
+        {
+            *status = OSKAR_ERR_BAD_LOCATION;
+            return;
+        }
+        if ((int)oskar_mem_length(baseline_mask) <
+                oskar_telescope_num_baselines(tel))
+        {
+            *status = OSKAR_ERR_DIMENSION_MISMATCH;
+            return;
+        }
+        mask = oskar_mem_int_const(baseline_mask, status);
+        if (*status) return;
+    }
+    if (n_sources == 0) return;
+
+    /* Get UV filter parameters in wavelengths. */
+    inv_wavelength = fabs(frequency_hz) / 299792458.0;
+    uv_filter_min = oskar_telescope_uv_filter_min(tel);
+    uv_filter_max = oskar_telescope_uv_filter_max(tel);
+    if (oskar_telescope_uv_filter_units(tel) == OSKAR_METRES)
+    {
+        uv_filter_min *= inv_wavelength;
+        uv_filter_max *= inv_wavelength;
+    }
+    if (uv_filter_max < 0.0 || uv_filter_max > FLT_MAX)
+        uv_filter_max = FLT_MAX;
+
+    /* Get the positions and apparent brightness of each source. */
+    E = oskar_jones_mem_const(beam);
+    I = oskar_sky_I_const(sky);
+    Q = oskar_sky_Q_const(sky);
+    U = oskar_sky_U_const(sky);
+    V = oskar_sky_V_const(sky);
+    l = oskar_sky_l_const(sky);
+    m = oskar_sky_m_const(sky);
+    n = oskar_sky_n_const(sky);
+    switch (type)
+    {
+    case OSKAR_SINGLE_COMPLEX_MATRIX:
+        get_sources<float, float2, float4c>(n_sources,
+                oskar_mem_float4c_const(E, status),
+                oskar_mem_float_const(I, status),
+                oskar_mem_float_const(Q, status),
+                oskar_mem_float_const(U, status),
+                oskar_mem_float_const(V, status),
+                oskar_mem_float_const(l, status),
+                oskar_mem_float_const(m, status),
+                oskar_mem_float_const(n, status),
+                source_min_jy, source_max_jy, x, y, z, c);
+        correlate<float>((int) x.size(), x, y, z, 4, c, tel, u, v, w,
+                inv_wavelength, uv_filter_min, uv_filter_max, tolerance, mask,
+                oskar_mem_float4c(vis, status), status);
+        break;
+    case OSKAR_DOUBLE_COMPLEX_MATRIX:
+        get_sources<double, double2, double4c>(n_sources,
+                oskar_mem_double4c_const(E, status),
+                oskar_mem_double_const(I, status),
+                oskar_mem_double_const(Q, status),
+                oskar_mem_double_const(U, status),
+                oskar_mem_double_const(V, status),
+                oskar_mem_double_const(l, status),
+                oskar_mem_double_const(m, status),
+                oskar_mem_double_const(n, status),
+                source_min_jy, source_max_jy, x, y, z, c);
+        correlate<double>((int) x.size(), x, y, z, 4, c, tel, u, v, w,
+                inv_wavelength, uv_filter_min, uv_filter_max, tolerance, mask,
+                oskar_mem_double4c(vis, status), status);
+        break;
+    case OSKAR_SINGLE_COMPLEX:
+        get_sources<float, float2>(n_sources,
+                oskar_mem_float2_const(E, status),
+                oskar_mem_float_const(I, status),
+                oskar_mem_float_const(l, status),
+                oskar_mem_float_const(m, status),
+                oskar_mem_float_const(n, status),
+                source_min_jy, source_max_jy, x, y, z, c);
+        correlate<float>((int) x.size(), x, y, z, 1, c, tel, u, v, w,
+                inv_wavelength, uv_filter_min, uv_filter_max, tolerance, mask,
+                oskar_mem_float2(vis, status), status);
+        break;
+    case OSKAR_DOUBLE_COMPLEX:
+        get_sources<double, double2>(n_sources,
+                oskar_mem_double2_const(E, status),
+                oskar_mem_double_const(I, status),
+                oskar_mem_double_const(l, status),
+                oskar_mem_double_const(m, status),
+                oskar_mem_double_const(n, status),
+                source_min_jy, source_max_jy, x, y, z, c);
+        correlate<double>((int) x.size(), x, y, z, 1, c, tel, u, v, w,
+                inv_wavelength, uv_filter_min, uv_filter_max, tolerance, mask,
+                oskar_mem_double2(vis, status), status);
+        break;
+    default:
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        break;
+    }
+}
+
+double oskar_cross_correlate_nufft_cost(int vis_type, int n_sources,
+        const oskar_Sky* sky, const oskar_Telescope* tel,
+        const oskar_Mem* u, const oskar_Mem* v, const oskar_Mem* w,
+        double frequency_hz, double tolerance, int* status)
+{
+    const int num_trans = oskar_type_is_matrix(vis_type) ? 4 : 1;
+    const double inv_wavelength = fabs(frequency_hz) / 299792458.0;
+    if (*status) return DBL_MAX;
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU ||
+            oskar_mem_location(u) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return DBL_MAX;
+    }
+    switch (oskar_sky_precision(sky))
+    {
+    case OSKAR_SINGLE:
+        return cost<float>(n_sources, num_trans, sky, tel, u, v, w,
+                inv_wavelength, tolerance);
+    case OSKAR_DOUBLE:
+        return cost<double>(n_sources, num_trans, sky, tel, u, v, w,
+                inv_wavelength, tolerance);
+    default:
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return DBL_MAX;
+    }
+}
+
+size_t oskar_cross_correlate_nufft_memory_bytes(int vis_type, int n_sources,
+        int n_baselines, const double source_range[3],
+        const double station_range[3], double tolerance)
+{
+    double target_range[3];
+    const int num_trans = oskar_type_is_matrix(vis_type) ? 4 : 1;
+    for (int d = 0; d < 3; ++d)
+        target_range[d] = 4.0 * M_PI * station_range[d];
+    if (oskar_nufft3_cost(n_sources, n_baselines, num_trans, source_range,
+            target_range, tolerance, 0) *
+            (20.0 + 4.0 * num_trans) / (4.0 + 4.0 * num_trans) >= 1.0)
+        return 0;
+
+    // Source coordinates and strengths, baseline coordinates, indices
+    // and transformed values, and the grids used by the transform.
+    return (size_t) n_sources * (3 * sizeof(double) +
+            num_trans * sizeof(double2)) +
+            (size_t) n_baselines * (3 * sizeof(double) + sizeof(int) +
+            num_trans * sizeof(double2)) +
+            oskar_nufft3_memory_bytes(n_sources, num_trans, source_range,
+                    target_range, tolerance);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -77,6 +77,7 @@ void oskar_xcorr_omp(
         const REAL                  time_int_sec,
         const REAL                  gha0_rad,
         const REAL                  dec0_rad,
+        const int*   const restrict baseline_mask,
         REAL8*             restrict vis)
 {
     // Loop over stations.
@@ -102,8 +103,11 @@ void oskar_xcorr_omp(
                     station_v[SP], station_v[SQ], station_w[SP], station_w[SQ],
                     uu, vv, ww, uu2, vv2, uuvv, uv_len);
 
-            // Apply the baseline length filter.
+            // Apply the baseline length filter and the baseline mask.
             if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+            if (baseline_mask && !baseline_mask[
+                    oskar_evaluate_baseline_index_inline(num_stations, SP, SQ)])
+                continue;
 
             // Compute the deltas for time-average smearing.
             if (TIME_SMEARING)
@@ -179,7 +183,7 @@ void oskar_xcorr_omp(
                 d_station_u, d_station_v, d_station_w,                      \
                 d_station_x, d_station_y, uv_min_lambda, uv_max_lambda,     \
                 inv_wavelength, frac_bandwidth, time_int_sec,               \
-                gha0_rad, dec0_rad, d_vis);
+                gha0_rad, dec0_rad, baseline_mask, d_vis);
 
 #define XCORR_SELECT(GAUSSIAN, REAL, REAL2, REAL8)                          \
         if (frac_bandwidth == (REAL)0 && time_int_sec == (REAL)0)           \
@@ -201,7 +205,7 @@ void oskar_cross_correlate_point_omp_f(
         const float* d_station_x, const float* d_station_y,
         float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
         float frac_bandwidth, float time_int_sec, float gha0_rad,
-        float dec0_rad, float4c* d_vis)
+        float dec0_rad, const int* baseline_mask, float4c* d_vis)
 {
     const float *d_a = 0, *d_b = 0, *d_c = 0;
     XCORR_SELECT(false, float, float2, float4c)
@@ -217,7 +221,7 @@ void oskar_cross_correlate_point_omp_d(
         const double* d_station_x, const double* d_station_y,
         double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
         double frac_bandwidth, double time_int_sec, double gha0_rad,
-        double dec0_rad, double4c* d_vis)
+        double dec0_rad, const int* baseline_mask, double4c* d_vis)
 {
     const double *d_a = 0, *d_b = 0, *d_c = 0;
     XCORR_SELECT(false, double, double2, double4c)
@@ -233,7 +237,8 @@ void oskar_cross_correlate_gaussian_omp_f(
         const float* d_station_w, const float* d_station_x,
         const float* d_station_y, float uv_min_lambda, float uv_max_lambda,
         float inv_wavelength, float frac_bandwidth, float time_int_sec,
-        float gha0_rad, float dec0_rad, float4c* d_vis)
+        float gha0_rad, float dec0_rad,
+        const int* baseline_mask, float4c* d_vis)
 {
     XCORR_SELECT(true, float, float2, float4c)
 }
@@ -248,7 +253,8 @@ void oskar_cross_correlate_gaussian_omp_d(
         const double* d_station_w, const double* d_station_x,
         const double* d_station_y, double uv_min_lambda, double uv_max_lambda,
         double inv_wavelength, double frac_bandwidth, double time_int_sec,
-        double gha0_rad, double dec0_rad, double4c* d_vis)
+        double gha0_rad, double dec0_rad,
+        const int* baseline_mask, double4c* d_vis)
 {
     XCORR_SELECT(true, double, double2, double4c)
 }
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "correlate/oskar_source_tree.h"
+#include "correlate/private_source_tree.h"
+
+#include <stdlib.h>
+
+#define MAX_DEPTH 24
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static void resize_sources(oskar_SourceTree* tree, int num_sources,
+        int* status);
+static int add_node(oskar_SourceTree* tree, int start, int count,
+        int* status);
+
+oskar_SourceTree* oskar_source_tree_create(int max_sources_per_leaf,
+        int* status)
+{
+    oskar_SourceTree* tree;
+    tree = (oskar_SourceTree*) calloc(1, sizeof(oskar_SourceTree));
+    if (!tree)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    tree->max_sources_per_leaf =
+            max_sources_per_leaf > 0 ? max_sources_per_leaf : 1;
+    return tree;
+}
+
+void oskar_source_tree_build(oskar_SourceTree* tree, int num_sources,
+        const oskar_Mem* l, const oskar_Mem* m, const oskar_Mem* n,
+        int* status)
+{
+    int i, type, *depth = 0;
+    double *l_in = 0, *m_in = 0, *n_in = 0;
+    if (*status || !tree) return;
+
+    /* Check data location and type. */
+    type = oskar_mem_type(l);
+    if (oskar_mem_location(l) != OSKAR_CPU ||
+            oskar_mem_location(m) != OSKAR_CPU ||
+            oskar_mem_location(n) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_mem_type(m) != type || oskar_mem_type(n) != type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (type != OSKAR_SINGLE && type != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if ((int)oskar_mem_length(l) < num_sources ||
+            (int)oskar_mem_length(m) < num_sources ||
+            (int)oskar_mem_length(n) < num_sources)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Copy source coordinates, in input order. */
+    resize_sources(tree, num_sources, status);
+    if (*status) return;
+    tree->num_nodes = 0;
+    tree->num_sources = num_sources;
+    if (num_sources == 0) return;
+    l_in = (double*) malloc(num_sources * sizeof(double));
+    m_in = (double*) malloc(num_sources * sizeof(double));
+    n_in = (double*) malloc(num_sources * sizeof(double));
+    if (!l_in || !m_in || !n_in)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        goto fail;
+    }
+    if (type == OSKAR_DOUBLE)
+    {
+        const double *l_, *m_, *n_;
+        l_ = oskar_mem_double_const(l, status);
+        m_ = oskar_mem_double_const(m, status);
+        n_ = oskar_mem_double_const(n, status);
+        for (i = 0; i < num_sources; ++i)
+        {
+            l_in[i] = l_[i]; m_in[i] = m_[i]; n_in[i] = n_[i];
+        }
+    }
+    else
+    {
+        const float *l_, *m_, *n_;
+        l_ = oskar_mem_float_const(l, status);
+        m_ = oskar_mem_float_const(m, status);
+        n_ = oskar_mem_float_const(n, status);
+        for (i = 0; i < num_sources; ++i)
+        {
+            l_in[i] = l_[i]; m_in[i] = m_[i]; n_in[i] = n_[i];
+        }
+    }
+    for (i = 0; i < num_sources; ++i)
+        tree->order[i] = i;
+
+    /* Create the root node, then split nodes breadth-first.
+     * Child nodes are appended to the node list, so this loop also
+     * visits every node created while it runs. */
+    add_node(tree, 0, num_sources, status);
+    depth = (int*) malloc(tree->capacity_nodes * sizeof(int));
+    if (!depth)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        goto fail;
+    }
+    depth[0] = 0;
+    for (i = 0; i < tree->num_nodes && !*status; ++i)
+    {
+        int j, k, start, count, offset, counts[4];
+        double l_min, l_max, m_min, m_max, l_mid, m_mid;
+        int* order = tree->order;
+        start = tree->nodes[i].start;
+        count = tree->nodes[i].count;
+        if (count <= tree->max_sources_per_leaf || depth[i] >= MAX_DEPTH)
+            continue;
+
+        /* Find the bounding box of the sources in the node. */
+        l_min = l_max = l_in[order[start]];
+        m_min = m_max = m_in[order[start]];
+        for (j = start + 1; j < start + count; ++j)
+        {
+            const double l_ = l_in[order[j]], m_ = m_in[order[j]];
+            if (l_ < l_min) l_min = l_;
+            if (l_ > l_max) l_max = l_;
+            if (m_ < m_min) m_min = m_;
+            if (m_ > m_max) m_max = m_;
+        }
+        if (l_max == l_min && m_max == m_min)
+            continue;
+        l_mid = 0.5 * (l_min + l_max);
+        m_mid = 0.5 * (m_min + m_max);
+
+        /* Partition sources into quadrants using a counting sort. */
+        counts[0] = counts[1] = counts[2] = counts[3] = 0;
+        for (j = start; j < start + count; ++j)
+        {
+            const int s = order[j];
+            ++counts[(l_in[s] > l_mid ? 1 : 0) + (m_in[s] > m_mid ? 2 : 0)];
+        }
+        for (k = 0, offset = 0; k < 4; ++k)
+        {
+            const int c = counts[k];
+            counts[k] = offset;
+            offset += c;
+        }
+        for (j = start; j < start + count; ++j)
+        {
+            const int s = order[j];
+            const int q = (l_in[s] > l_mid ? 1 : 0) + (m_in[s] > m_mid ? 2 : 0);
+            tree->scratch[counts[q]++] = s;
+        }
+        for (j = 0; j < count; ++j)
+            order[start + j] = tree->scratch[j];
+
+        /* Create child nodes for non-empty quadrants. */
+        tree->nodes[i].child = tree->num_nodes;
+        for (k = 0, offset = 0; k < 4; ++k)
+        {
+            const int c = counts[k] - offset;
+            if (c == 0) continue;
+            add_node(tree, start + offset, c, status);
+            if (*status) break;
+            depth = (int*) realloc(depth, tree->capacity_nodes * sizeof(int));
+            if (!depth)
+            {
+                *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+                goto fail;
+            }
+            depth[tree->num_nodes - 1] = depth[i] + 1;
+            tree->nodes[i].num_children++;
+            offset = counts[k];
+        }
+    }
+
+    /* Store coordinates in tree order. */
+    for (i = 0; i < num_sources; ++i)
+    {
+        const int s = tree->order[i];
+        tree->l[i] = l_in[s];
+        tree->m[i] = m_in[s];
+        tree->n[i] = n_in[s];
+    }
+
+fail:
+    free(depth);
+    free(l_in);
+    free(m_in);
+    free(n_in);
+}
+
+void oskar_source_tree_free(oskar_SourceTree* tree, int* status)
+{
+    (void) status;
+    if (!tree) return;
+    free(tree->order);
+    free(tree->scratch);
+    free(tree->l);
+    free(tree->m);
+    free(tree->n);
+    free(tree->brightness);
+    free(tree->phasors);
+    free(tree->nodes);
+    free(tree->moments);
+    free(tree);
+}
+
+int oskar_source_tree_num_sources(const oskar_SourceTree* tree)
+{
+    return tree->num_sources;
+}
+
+int oskar_source_tree_num_nodes(const oskar_SourceTree* tree)
+{
+    return tree->num_nodes;
+}
+
+size_t oskar_source_tree_memory_bytes(int max_sources_per_leaf,
+        int num_sources, int num_stations)
+{
+    size_t num_nodes;
+    if (max_sources_per_leaf < 1) max_sources_per_leaf = 1;
+
+    /* Each split node holds more sources than a leaf and has up to four
+     * children. For evenly spread sources, the split nodes on each level
+     * hold about a quarter as many sources as those on the level below,
+     * and the node capacity may be up to twice the number used. */
+    num_nodes = 2 * (1 + (16 * (size_t) num_sources) /
+            (3 * ((size_t) max_sources_per_leaf + 1)));
+    return (size_t) num_sources * (2 * sizeof(int) + 3 * sizeof(double) +
+            sizeof(double4c) + (size_t) num_stations * sizeof(double2)) +
+            num_nodes * (sizeof(oskar_SourceTreeNode) + sizeof(int) +
+            OSKAR_SOURCE_TREE_NUM_MOMENTS * sizeof(double4c));
+}
+
+static void resize_sources(oskar_SourceTree* tree, int num_sources,
+        int* status)
+{
+    if (num_sources <= tree->capacity_sources) return;
+    tree->order = (int*) realloc(tree->order, num_sources * sizeof(int));
+    tree->scratch = (int*) realloc(tree->scratch, num_sources * sizeof(int));
+    tree->l = (double*) realloc(tree->l, num_sources * sizeof(double));
+    tree->m = (double*) realloc(tree->m, num_sources * sizeof(double));
+    tree->n = (double*) realloc(tree->n, num_sources * sizeof(double));
+    tree->brightness = (double4c*) realloc(tree->brightness,
+            num_sources * sizeof(double4c));
+    if (!tree->order || !tree->scratch || !tree->l || !tree->m ||
+            !tree->n || !tree->brightness)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    tree->capacity_sources = num_sources;
+}
+
+static int add_node(oskar_SourceTree* tree, int start, int count,
+        int* status)
+{
+    oskar_SourceTreeNode* node;
+    if (*status) return -1;
+    if (tree->num_nodes == tree->capacity_nodes)
+    {
+        const int capacity = tree->capacity_nodes > 0 ?
+                2 * tree->capacity_nodes : 64;
+        tree->nodes = (oskar_SourceTreeNode*) realloc(tree->nodes,
+                capacity * sizeof(oskar_SourceTreeNode));
+        tree->moments = (double4c*) realloc(tree->moments,
+                capacity * OSKAR_SOURCE_TREE_NUM_MOMENTS * sizeof(double4c));
+        if (!tree->nodes || !tree->moments)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return -1;
+        }
+        tree->capacity_nodes = capacity;
+    }
+    node = &tree->nodes[tree->num_nodes];
+    node->start = start;
+    node->count = count;
+    node->child = 0;
+    node->num_children = 0;
+    node->centre[0] = node->centre[1] = node->centre[2] = 0.0;
+    node->radius = 0.0;
+    node->abs_flux = 0.0;
+    return tree->num_nodes++;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -31,14 +31,18 @@
 #include "utility/oskar_timer.h"
 
 #include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_omp.h"
+#include "correlate/oskar_cross_correlate_scalar_omp.h"
 #include "utility/oskar_get_error_string.h"
 #include "math/oskar_kahan_sum.h"
+#include <cfloat>
 #include <cstdlib>
 
 // Comment out this line to disable benchmark timer printing.
  #define ALLOW_PRINTING 1
 
-static void check_values(const oskar_Mem* approx, const oskar_Mem* accurate)
+static void check_values(const oskar_Mem* approx, const oskar_Mem* accurate,
+        double avg_tol_single = 1e-5)
 {
     int status = 0;
     double min_rel_error, max_rel_error, avg_rel_error, std_rel_error, tol;
@@ -52,7 +56,7 @@ static void check_values(const oskar_Mem* approx, const oskar_Mem* accurate)
             " MIN: " << min_rel_error << " MAX: " << max_rel_error <<
             " AVG: " << avg_rel_error << " STD: " << std_rel_error;
     tol = oskar_mem_is_double(approx) &&
-            oskar_mem_is_double(accurate) ? 1e-12 : 1e-5;
+            oskar_mem_is_double(accurate) ? 1e-12 : avg_tol_single;
     EXPECT_LT(avg_rel_error, tol) << std::setprecision(5) <<
             "RELATIVE ERROR" <<
             " MIN: " << min_rel_error << " MAX: " << max_rel_error <<
@@ -162,7 +166,7 @@ protected:
         oskar_telescope_set_time_average(tel, time_average);
         oskar_timer_start(timer1);
         oskar_cross_correlate(vis1, oskar_sky_num_sources(sky), jones, sky,
-                tel, u_, v_, w_, 1.0, frequency, &status);
+                tel, u_, v_, w_, 0, 1.0, frequency, &status);
         time1 = oskar_timer_elapsed(timer1);
         destroyTestData();
         ASSERT_EQ(0, status) << oskar_get_error_string(status);
@@ -180,7 +184,7 @@ protected:
         oskar_telescope_set_time_average(tel, time_average);
         oskar_timer_start(timer2);
         oskar_cross_correlate(vis2, oskar_sky_num_sources(sky), jones, sky,
-                tel, u_, v_, w_, 1.0, frequency, &status);
+                tel, u_, v_, w_, 0, 1.0, frequency, &status);
         time2 = oskar_timer_elapsed(timer2);
         destroyTestData();
         ASSERT_EQ(0, status) << oskar_get_error_string(status);
@@ -223,10 +227,223 @@ protected:
                 time2 * 1000.0);
 #endif
     }
+
+    // Sets Stokes parameters of either sign, including sources that are
+    // not physical (I^2 < Q^2 + U^2 + V^2).
+    void setSignedStokes()
+    {
+        int status = 0;
+        srand(3);
+        oskar_mem_random_range(oskar_sky_I(sky), -0.5, 2.0, &status);
+        oskar_mem_random_range(oskar_sky_Q(sky), -1.0, 1.0, &status);
+        oskar_mem_random_range(oskar_sky_U(sky), -1.0, 1.0, &status);
+        oskar_mem_random_range(oskar_sky_V(sky), -1.0, 1.0, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+
+    void runGemmTest(int prec1, int prec2, int matrix,
+            int signed_stokes = 0)
+    {
+        int num_baselines, status = 0, type;
+        oskar_Mem *vis1, *vis2;
+        oskar_Timer *timer1, *timer2;
+        double time1, time2, frequency = 100e6;
+        const double inv_wavelength = frequency / 299792458.0;
+
+        // Create the timers.
+        timer1 = oskar_timer_create(OSKAR_TIMER_NATIVE);
+        timer2 = oskar_timer_create(OSKAR_TIMER_NATIVE);
+
+        // Evaluate unsmeared visibilities using the matrix product.
+        createTestData(prec1, OSKAR_CPU, matrix);
+        if (signed_stokes) setSignedStokes();
+        num_baselines = oskar_telescope_num_baselines(tel);
+        type = prec1 | OSKAR_COMPLEX;
+        if (matrix) type |= OSKAR_MATRIX;
+        vis1 = oskar_mem_create(type, OSKAR_CPU, num_baselines, &status);
+        oskar_mem_clear_contents(vis1, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        oskar_telescope_set_channel_bandwidth(tel, 0.0);
+        oskar_telescope_set_time_average(tel, 0.0);
+        oskar_timer_start(timer1);
+        oskar_cross_correlate(vis1, num_sources, jones, sky, tel,
+                u_, v_, w_, 0, 1.0, frequency, &status);
+        time1 = oskar_timer_elapsed(timer1);
+        destroyTestData();
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Evaluate the same visibilities using the direct kernel.
+        createTestData(prec2, OSKAR_CPU, matrix);
+        if (signed_stokes) setSignedStokes();
+        type = prec2 | OSKAR_COMPLEX;
+        if (matrix) type |= OSKAR_MATRIX;
+        vis2 = oskar_mem_create(type, OSKAR_CPU, num_baselines, &status);
+        oskar_mem_clear_contents(vis2, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const oskar_Mem* J = oskar_jones_mem_const(jones);
+        const oskar_Mem* x =
+                oskar_telescope_station_true_x_offset_ecef_metres_const(tel);
+        const oskar_Mem* y =
+                oskar_telescope_station_true_y_offset_ecef_metres_const(tel);
+        oskar_timer_start(timer2);
+        if (prec2 == OSKAR_DOUBLE && matrix)
+            oskar_cross_correlate_point_omp_d(num_sources, num_stations,
+                    oskar_mem_double4c_const(J, &status),
+                    oskar_mem_double_const(oskar_sky_I_const(sky), &status),
+                    oskar_mem_double_const(oskar_sky_Q_const(sky), &status),
+                    oskar_mem_double_const(oskar_sky_U_const(sky), &status),
+                    oskar_mem_double_const(oskar_sky_V_const(sky), &status),
+                    oskar_mem_double_const(oskar_sky_l_const(sky), &status),
+                    oskar_mem_double_const(oskar_sky_m_const(sky), &status),
+                    oskar_mem_double_const(oskar_sky_n_const(sky), &status),
+                    oskar_mem_double_const(u_, &status),
+                    oskar_mem_double_const(v_, &status),
+                    oskar_mem_double_const(w_, &status),
+                    oskar_mem_double_const(x, &status),
+                    oskar_mem_double_const(y, &status),
+                    0.0, FLT_MAX, inv_wavelength, 0.0, 0.0, 0.0, 0.0, 0,
+                    oskar_mem_double4c(vis2, &status));
+        else if (prec2 == OSKAR_DOUBLE)
+            oskar_cross_correlate_scalar_point_omp_d(num_sources,
+                    num_stations, oskar_mem_double2_const(J, &status),
+                    oskar_mem_double_const(oskar_sky_I_const(sky), &status),
+                    oskar_mem_double_const(oskar_sky_l_const(sky), &status),
+                    oskar_mem_double_const(oskar_sky_m_const(sky), &status),
+                    oskar_mem_double_const(oskar_sky_n_const(sky), &status),
+                    oskar_mem_double_const(u_, &status),
+                    oskar_mem_double_const(v_, &status),
+                    oskar_mem_double_const(w_, &status),
+                    oskar_mem_double_const(x, &status),
+                    oskar_mem_double_const(y, &status),
+                    0.0, FLT_MAX, inv_wavelength, 0.0, 0.0, 0.0, 0.0, 0,
+                    oskar_mem_double2(vis2, &status));
+        else
+            status = OSKAR_ERR_BAD_DATA_TYPE;
+        time2 = oskar_timer_elapsed(timer2);
+        destroyTestData();
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Compare results. Without smearing, some visibilities are
+        // close to zero, so allow for single-precision input rounding.
+        check_values(vis1, vis2, 5e-5);
+
+        // Free memory.
+        oskar_timer_free(timer1);
+        oskar_timer_free(timer2);
+        oskar_mem_free(vis1, &status);
+        oskar_mem_free(vis2, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+#ifdef ALLOW_PRINTING
+        // Print times.
+        printf("  > %s. Unsmeared point sources.\n",
+                matrix ? "Matrix" : "Scalar");
+        printf("    %s precision matrix product: %.2f ms, "
+                "%s precision direct: %.2f ms\n",
+                prec1 == OSKAR_SINGLE ? "Single" : "Double", time1 * 1000.0,
+                prec2 == OSKAR_SINGLE ? "Single" : "Double", time2 * 1000.0);
+#endif
+    }
+
+    void runMaskTest(int gemm)
+    {
+        int i, num_baselines, status = 0;
+        oskar_Mem *vis1, *vis2, *mask;
+
+        // Evaluate all baselines, then every other baseline.
+        createTestData(OSKAR_DOUBLE, OSKAR_CPU, 1);
+        num_baselines = oskar_telescope_num_baselines(tel);
+        if (gemm)
+        {
+            oskar_telescope_set_channel_bandwidth(tel, 0.0);
+            oskar_telescope_set_time_average(tel, 0.0);
+        }
+        else
+        {
+            oskar_telescope_set_channel_bandwidth(tel, bandwidth);
+        }
+        vis1 = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+                num_baselines, &status);
+        vis2 = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+                num_baselines, &status);
+        mask = oskar_mem_create(OSKAR_INT, OSKAR_CPU, num_baselines, &status);
+        oskar_mem_clear_contents(vis1, &status);
+        oskar_mem_clear_contents(vis2, &status);
+        for (i = 0; i < num_baselines; ++i)
+            oskar_mem_int(mask, &status)[i] = i % 2;
+        oskar_cross_correlate(vis1, num_sources, jones, sky, tel,
+                u_, v_, w_, 0, 1.0, 100e6, &status);
+        oskar_cross_correlate(vis2, num_sources, jones, sky, tel,
+                u_, v_, w_, mask, 1.0, 100e6, &status);
+        destroyTestData();
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Check that masked baselines are untouched and others are equal.
+        const double4c* v1 = oskar_mem_double4c_const(vis1, &status);
+        const double4c* v2 = oskar_mem_double4c_const(vis2, &status);
+        for (i = 0; i < num_baselines; ++i)
+        {
+            if (i % 2)
+            {
+                EXPECT_DOUBLE_EQ(v1[i].a.x, v2[i].a.x);
+                EXPECT_DOUBLE_EQ(v1[i].d.y, v2[i].d.y);
+            }
+            else
+            {
+                EXPECT_EQ(0.0, v2[i].a.x);
+                EXPECT_EQ(0.0, v2[i].d.y);
+            }
+        }
+        oskar_mem_free(vis1, &status);
+        oskar_mem_free(vis2, &status);
+        oskar_mem_free(mask, &status);
+    }
 };
 
 const double cross_correlate::bandwidth = 1e4;
 
+// Baselines excluded by the mask are not updated (CPU only).
+TEST_F(cross_correlate, baseline_mask_direct)
+{
+    runMaskTest(0);
+}
+
+TEST_F(cross_correlate, baseline_mask_gemm)
+{
+    runMaskTest(1);
+}
+
+// Unsmeared point sources using the matrix product (CPU only).
+TEST_F(cross_correlate, matrix_point_gemm_doubleCPU_doubleCPU)
+{
+    runGemmTest(OSKAR_DOUBLE, OSKAR_DOUBLE, 1);
+}
+
+TEST_F(cross_correlate, matrix_point_gemm_singleCPU_doubleCPU)
+{
+    runGemmTest(OSKAR_SINGLE, OSKAR_DOUBLE, 1);
+}
+
+TEST_F(cross_correlate, scalar_point_gemm_doubleCPU_doubleCPU)
+{
+    runGemmTest(OSKAR_DOUBLE, OSKAR_DOUBLE, 0);
+}
+
+TEST_F(cross_correlate, matrix_point_gemm_signed_stokes)
+{
+    runGemmTest(OSKAR_DOUBLE, OSKAR_DOUBLE, 1, 1);
+}
+
+TEST_F(cross_correlate, scalar_point_gemm_signed_stokes)
+{
+    runGemmTest(OSKAR_DOUBLE, OSKAR_DOUBLE, 0, 1);
+}
+
+TEST_F(cross_correlate, scalar_point_gemm_singleCPU_doubleCPU)
+{
+    runGemmTest(OSKAR_SINGLE, OSKAR_DOUBLE, 0);
+}
+
 // CPU only.
 TEST_F(cross_correlate, matrix_point_singleCPU_doubleCPU)
 {
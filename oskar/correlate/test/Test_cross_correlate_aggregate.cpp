@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_aggregate.h"
+#include "correlate/oskar_source_tree.h"
+#include "interferometer/oskar_evaluate_jones_K.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Comment out this line to disable benchmark timer printing.
+// #define ALLOW_PRINTING 1
+
+static const int num_stations = 40;
+static const int num_sources = 3000;
+static const double freq_hz = 100e6;
+
+class cross_correlate_aggregate : public ::testing::Test
+{
+protected:
+    oskar_Mem *u, *v, *w;
+    oskar_Telescope* tel;
+    oskar_Sky* sky;
+    oskar_Jones *E, *K, *J;
+    double abs_flux;
+
+    void createTestData(int precision, int matrix)
+    {
+        int status = 0, type;
+        type = precision | OSKAR_COMPLEX;
+        if (matrix) type |= OSKAR_MATRIX;
+        E = oskar_jones_create(type, OSKAR_CPU, num_stations, num_sources,
+                &status);
+        J = oskar_jones_create(type, OSKAR_CPU, num_stations, num_sources,
+                &status);
+        K = oskar_jones_create(precision | OSKAR_COMPLEX, OSKAR_CPU,
+                num_stations, num_sources, &status);
+        u = oskar_mem_create(precision, OSKAR_CPU, num_stations, &status);
+        v = oskar_mem_create(precision, OSKAR_CPU, num_stations, &status);
+        w = oskar_mem_create(precision, OSKAR_CPU, num_stations, &status);
+        sky = oskar_sky_create(precision, OSKAR_CPU, num_sources, &status);
+        tel = oskar_telescope_create(precision, OSKAR_CPU,
+                num_stations, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Compact array observing a cluster of sources near the
+        // phase centre, so that most baselines are short.
+        srand(3);
+        oskar_mem_random_range(u, -40.0, 40.0, &status);
+        oskar_mem_random_range(v, -40.0, 40.0, &status);
+        oskar_mem_random_range(w, -1.0, 1.0, &status);
+        oskar_mem_random_range(oskar_sky_I(sky), 1.0, 2.0, &status);
+        oskar_mem_random_range(oskar_sky_Q(sky), 0.1, 0.3, &status);
+        oskar_mem_random_range(oskar_sky_U(sky), 0.1, 0.3, &status);
+        oskar_mem_random_range(oskar_sky_V(sky), 0.1, 0.3, &status);
+        oskar_mem_random_range(oskar_sky_l(sky), -0.01, 0.01, &status);
+        oskar_mem_random_range(oskar_sky_m(sky), -0.01, 0.01, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        for (int i = 0; i < num_sources; ++i)
+        {
+            const double l = oskar_mem_get_element(oskar_sky_l(sky), i,
+                    &status);
+            const double m = oskar_mem_get_element(oskar_sky_m(sky), i,
+                    &status);
+            oskar_mem_set_element_real(oskar_sky_n(sky), i,
+                    sqrt(1.0 - l * l - m * m), &status);
+        }
+
+        // Identical station beams.
+        oskar_Mem* E0 = oskar_mem_create_alias(oskar_jones_mem(E), 0,
+                num_sources, &status);
+        oskar_mem_random_range(E0, -1.0, 1.0, &status);
+        for (int i = 1; i < num_stations; ++i)
+            oskar_mem_copy_contents(oskar_jones_mem(E), E0,
+                    i * num_sources, 0, num_sources, &status);
+        oskar_mem_free(E0, &status);
+
+        // Full Jones matrices for the direct sum.
+        oskar_evaluate_jones_K(K, num_sources, oskar_sky_l_const(sky),
+                oskar_sky_m_const(sky), oskar_sky_n_const(sky), u, v, w,
+                freq_hz, oskar_sky_I_const(sky), 0.0, 1e10, &status);
+        oskar_jones_join(J, K, E, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+
+    void destroyTestData()
+    {
+        int status = 0;
+        oskar_jones_free(E, &status);
+        oskar_jones_free(K, &status);
+        oskar_jones_free(J, &status);
+        oskar_mem_free(u, &status);
+        oskar_mem_free(v, &status);
+        oskar_mem_free(w, &status);
+        oskar_sky_free(sky, &status);
+        oskar_telescope_free(tel, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+
+    // Returns the sum over sources of the trace of the apparent brightness.
+    double sumApparentFlux(int matrix)
+    {
+        int status = 0;
+        double sum = 0.0;
+        oskar_Mem* t = oskar_mem_convert_precision(oskar_jones_mem(E),
+                OSKAR_DOUBLE, &status);
+        oskar_Mem* I = oskar_mem_convert_precision(oskar_sky_I(sky),
+                OSKAR_DOUBLE, &status);
+        const double* I_ = oskar_mem_double_const(I, &status);
+        for (int i = 0; i < num_sources; ++i)
+        {
+            if (matrix)
+            {
+                const double4c e = oskar_mem_double4c_const(t, &status)[i];
+                const double t1 = e.a.x * e.a.x + e.a.y * e.a.y +
+                        e.b.x * e.b.x + e.b.y * e.b.y;
+                const double t2 = e.c.x * e.c.x + e.c.y * e.c.y +
+                        e.d.x * e.d.x + e.d.y * e.d.y;
+                // The brightness matrices have I > |(Q, U, V)|,
+                // so 2 I is an upper bound on their largest eigenvalue.
+                sum += 2.0 * I_[i] * (t1 + t2);
+            }
+            else
+            {
+                const double2 e = oskar_mem_double2_const(t, &status)[i];
+                sum += I_[i] * (e.x * e.x + e.y * e.y);
+            }
+        }
+        oskar_mem_free(t, &status);
+        oskar_mem_free(I, &status);
+        return sum;
+    }
+
+    void runTest(int precision, int matrix, double tolerance, double max_err)
+    {
+        int status = 0, type;
+        double max_diff = 0.0;
+        createTestData(precision, matrix);
+        type = oskar_jones_type(J);
+        int num_baselines = oskar_telescope_num_baselines(tel);
+        oskar_Mem* vis1 = oskar_mem_create(type, OSKAR_CPU,
+                num_baselines, &status);
+        oskar_Mem* vis2 = oskar_mem_create(type, OSKAR_CPU,
+                num_baselines, &status);
+        oskar_mem_clear_contents(vis1, &status);
+        oskar_mem_clear_contents(vis2, &status);
+        oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+
+        // Direct sum.
+        oskar_timer_start(timer);
+        oskar_cross_correlate(vis1, num_sources, J, sky, tel, u, v, w,
+                0, 0.0, freq_hz, &status);
+        double t_direct = oskar_timer_elapsed(timer);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Aggregated sum.
+        oskar_SourceTree* tree = oskar_source_tree_create(8, &status);
+        oskar_timer_start(timer);
+        oskar_source_tree_build(tree, num_sources, oskar_sky_l_const(sky),
+                oskar_sky_m_const(sky), oskar_sky_n_const(sky), &status);
+        oskar_cross_correlate_aggregate(vis2, num_sources, E, tree, sky, tel,
+                u, v, w, 0, freq_hz, 0.0, 1e10, tolerance, &status);
+        double t_aggregate = oskar_timer_elapsed(timer);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_EQ(num_sources, oskar_source_tree_num_sources(tree));
+        EXPECT_GT(oskar_source_tree_num_nodes(tree), 1);
+
+        // Compare element by element against the error bound.
+        oskar_Mem* d1 = oskar_mem_convert_precision(vis1, OSKAR_DOUBLE,
+                &status);
+        oskar_Mem* d2 = oskar_mem_convert_precision(vis2, OSKAR_DOUBLE,
+                &status);
+        const double* p1 = oskar_mem_double_const(d1, &status);
+        const double* p2 = oskar_mem_double_const(d2, &status);
+        const size_t n = oskar_mem_length(d1) * (matrix ? 8 : 2);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double diff = fabs(p1[i] - p2[i]);
+            if (diff > max_diff) max_diff = diff;
+        }
+        double bound = max_err * sumApparentFlux(matrix);
+        EXPECT_LE(max_diff, bound);
+#ifdef ALLOW_PRINTING
+        printf("Direct: %.3f s, aggregated: %.3f s, "
+                "max diff %.3e (bound %.3e)\n",
+                t_direct, t_aggregate, max_diff, bound);
+#else
+        (void) t_direct;
+        (void) t_aggregate;
+#endif
+
+        // Clean up.
+        oskar_mem_free(d1, &status);
+        oskar_mem_free(d2, &status);
+        oskar_mem_free(vis1, &status);
+        oskar_mem_free(vis2, &status);
+        oskar_source_tree_free(tree, &status);
+        oskar_timer_free(timer);
+        destroyTestData();
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+};
+
+TEST_F(cross_correlate_aggregate, matrix_exact_double)
+{
+    runTest(OSKAR_DOUBLE, 1, 0.0, 1e-13);
+}
+
+TEST_F(cross_correlate_aggregate, matrix_double)
+{
+    runTest(OSKAR_DOUBLE, 1, 1e-4, 1e-4);
+}
+
+TEST_F(cross_correlate_aggregate, scalar_double)
+{
+    runTest(OSKAR_DOUBLE, 0, 1e-4, 1e-4);
+}
+
+TEST_F(cross_correlate_aggregate, matrix_single)
+{
+    runTest(OSKAR_SINGLE, 1, 1e-3, 1e-3);
+}
+
+TEST_F(cross_correlate_aggregate, scalar_single)
+{
+    runTest(OSKAR_SINGLE, 0, 1e-3, 1e-3);
+}
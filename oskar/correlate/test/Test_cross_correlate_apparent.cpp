@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_apparent.h"
+#include "interferometer/oskar_evaluate_jones_K.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Comment out this line to disable benchmark timer printing.
+// #define ALLOW_PRINTING 1
+
+static const int num_stations = 50;
+static const int num_sources = 2000;
+static const double freq_hz = 100e6;
+
+class cross_correlate_apparent : public ::testing::Test
+{
+protected:
+    oskar_Mem *u, *v, *w;
+    oskar_Telescope* tel;
+    oskar_Sky* sky;
+    oskar_Jones *E, *K, *J;
+
+    void createTestData(int precision, int matrix, int extended,
+            int smearing)
+    {
+        int status = 0, type;
+        type = precision | OSKAR_COMPLEX;
+        if (matrix) type |= OSKAR_MATRIX;
+        E = oskar_jones_create(type, OSKAR_CPU, num_stations, num_sources,
+                &status);
+        J = oskar_jones_create(type, OSKAR_CPU, num_stations, num_sources,
+                &status);
+        K = oskar_jones_create(precision | OSKAR_COMPLEX, OSKAR_CPU,
+                num_stations, num_sources, &status);
+        u = oskar_mem_create(precision, OSKAR_CPU, num_stations, &status);
+        v = oskar_mem_create(precision, OSKAR_CPU, num_stations, &status);
+        w = oskar_mem_create(precision, OSKAR_CPU, num_stations, &status);
+        sky = oskar_sky_create(precision, OSKAR_CPU, num_sources, &status);
+        tel = oskar_telescope_create(precision, OSKAR_CPU,
+                num_stations, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Random station and source coordinates.
+        srand(2);
+        oskar_mem_random_range(u, -500.0, 500.0, &status);
+        oskar_mem_random_range(v, -500.0, 500.0, &status);
+        oskar_mem_random_range(w, -10.0, 10.0, &status);
+        oskar_mem_random_range(
+                oskar_telescope_station_true_x_offset_ecef_metres(tel),
+                -500.0, 500.0, &status);
+        oskar_mem_random_range(
+                oskar_telescope_station_true_y_offset_ecef_metres(tel),
+                -500.0, 500.0, &status);
+        oskar_mem_random_range(oskar_sky_I(sky), 1.0, 2.0, &status);
+        oskar_mem_random_range(oskar_sky_Q(sky), 0.1, 0.3, &status);
+        oskar_mem_random_range(oskar_sky_U(sky), 0.1, 0.3, &status);
+        oskar_mem_random_range(oskar_sky_V(sky), 0.1, 0.3, &status);
+        oskar_mem_random_range(oskar_sky_l(sky), -0.1, 0.1, &status);
+        oskar_mem_random_range(oskar_sky_m(sky), -0.1, 0.1, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        for (int i = 0; i < num_sources; ++i)
+        {
+            const double l = oskar_mem_get_element(oskar_sky_l(sky), i,
+                    &status);
+            const double m = oskar_mem_get_element(oskar_sky_m(sky), i,
+                    &status);
+            oskar_mem_set_element_real(oskar_sky_n(sky), i,
+                    sqrt(1.0 - l * l - m * m), &status);
+        }
+        if (extended)
+        {
+            oskar_mem_random_range(oskar_sky_gaussian_a(sky),
+                    1e-7, 2e-7, &status);
+            oskar_mem_random_range(oskar_sky_gaussian_b(sky),
+                    -1e-8, 1e-8, &status);
+            oskar_mem_random_range(oskar_sky_gaussian_c(sky),
+                    1e-7, 2e-7, &status);
+            oskar_sky_set_use_extended(sky, 1);
+        }
+        if (smearing)
+        {
+            oskar_telescope_set_channel_bandwidth(tel, 1e6);
+            oskar_telescope_set_time_average(tel, 10.0);
+        }
+
+        // Identical station beams.
+        oskar_Mem* E0 = oskar_mem_create_alias(oskar_jones_mem(E), 0,
+                num_sources, &status);
+        oskar_mem_random_range(E0, -1.0, 1.0, &status);
+        for (int i = 1; i < num_stations; ++i)
+            oskar_mem_copy_contents(oskar_jones_mem(E), E0,
+                    i * num_sources, 0, num_sources, &status);
+        oskar_mem_free(E0, &status);
+
+        // Full Jones matrices for the direct sum.
+        oskar_evaluate_jones_K(K, num_sources, oskar_sky_l_const(sky),
+                oskar_sky_m_const(sky), oskar_sky_n_const(sky), u, v, w,
+                freq_hz, oskar_sky_I_const(sky), 0.0, 1e10, &status);
+        oskar_jones_join(J, K, E, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+
+    void destroyTestData()
+    {
+        int status = 0;
+        oskar_jones_free(E, &status);
+        oskar_jones_free(K, &status);
+        oskar_jones_free(J, &status);
+        oskar_mem_free(u, &status);
+        oskar_mem_free(v, &status);
+        oskar_mem_free(w, &status);
+        oskar_sky_free(sky, &status);
+        oskar_telescope_free(tel, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+
+    void runTest(int precision, int matrix, int extended, int smearing,
+            double tol)
+    {
+        int status = 0, type;
+        double max_diff = 0.0, max_abs = 0.0;
+        createTestData(precision, matrix, extended, smearing);
+        type = oskar_jones_type(J);
+        int num_baselines = oskar_telescope_num_baselines(tel);
+        oskar_Mem* vis1 = oskar_mem_create(type, OSKAR_CPU,
+                num_baselines, &status);
+        oskar_Mem* vis2 = oskar_mem_create(type, OSKAR_CPU,
+                num_baselines, &status);
+        oskar_mem_clear_contents(vis1, &status);
+        oskar_mem_clear_contents(vis2, &status);
+        oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+
+        // Direct sum.
+        oskar_timer_start(timer);
+        oskar_cross_correlate(vis1, num_sources, J, sky, tel, u, v, w,
+                0, 1.0, freq_hz, &status);
+        double t_direct = oskar_timer_elapsed(timer);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Sum using apparent brightness.
+        oskar_timer_start(timer);
+        oskar_cross_correlate_apparent(vis2, num_sources, E, K, sky, tel,
+                u, v, w, 0, 1.0, freq_hz, &status);
+        double t_apparent = oskar_timer_elapsed(timer);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Compare element by element, relative to the largest value.
+        oskar_Mem* d1 = oskar_mem_convert_precision(vis1, OSKAR_DOUBLE,
+                &status);
+        oskar_Mem* d2 = oskar_mem_convert_precision(vis2, OSKAR_DOUBLE,
+                &status);
+        const double* p1 = oskar_mem_double_const(d1, &status);
+        const double* p2 = oskar_mem_double_const(d2, &status);
+        const size_t n = oskar_mem_length(d1) * (matrix ? 8 : 2);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double diff = fabs(p1[i] - p2[i]);
+            if (diff > max_diff) max_diff = diff;
+            if (fabs(p1[i]) > max_abs) max_abs = fabs(p1[i]);
+        }
+        EXPECT_GT(max_abs, 0.0);
+        EXPECT_LE(max_diff, tol * max_abs);
+#ifdef ALLOW_PRINTING
+        printf("Direct: %.3f s, apparent: %.3f s, max rel. diff %.3e\n",
+                t_direct, t_apparent, max_diff / max_abs);
+#else
+        (void) t_direct;
+        (void) t_apparent;
+#endif
+
+        // Clean up.
+        oskar_mem_free(d1, &status);
+        oskar_mem_free(d2, &status);
+        oskar_mem_free(vis1, &status);
+        oskar_mem_free(vis2, &status);
+        oskar_timer_free(timer);
+        destroyTestData();
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+};
+
+TEST_F(cross_correlate_apparent, matrix_point_double)
+{
+    runTest(OSKAR_DOUBLE, 1, 0, 0, 1e-12);
+}
+
+TEST_F(cross_correlate_apparent, matrix_gaussian_smearing_double)
+{
+    runTest(OSKAR_DOUBLE, 1, 1, 1, 1e-12);
+}
+
+TEST_F(cross_correlate_apparent, scalar_gaussian_smearing_double)
+{
+    runTest(OSKAR_DOUBLE, 0, 1, 1, 1e-12);
+}
+
+TEST_F(cross_correlate_apparent, matrix_point_smearing_single)
+{
+    runTest(OSKAR_SINGLE, 1, 0, 1, 1e-4);
+}
+
+TEST_F(cross_correlate_apparent, scalar_point_single)
+{
+    runTest(OSKAR_SINGLE, 0, 0, 0, 1e-4);
+}
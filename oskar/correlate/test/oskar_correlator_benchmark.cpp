@@ -272,7 +272,7 @@ void benchmark(int num_stations, int num_sources, int type,
         oskar_mem_clear_contents(vis, status);
         oskar_timer_start(timer);
         oskar_cross_correlate(vis, oskar_sky_num_sources(sky), J, sky, tel,
-                u, v, w, 0.0, 100e6, status);
+                u, v, w, 0, 0.0, 100e6, status);
         times[i] = oskar_timer_elapsed(timer);
     }
 
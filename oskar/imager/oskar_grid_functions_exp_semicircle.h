@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_GRID_FUNCTIONS_EXP_SEMICIRCLE_H_
+#define OSKAR_GRID_FUNCTIONS_EXP_SEMICIRCLE_H_
+
+/**
+ * @file oskar_grid_functions_exp_semicircle.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Generates "exponential of semicircle" (ES) grid convolution function (GCF).
+ *
+ * @details
+ * Generates the "exponential of semicircle" grid convolution function
+ *
+ * \f[
+ * \phi(z) = \exp\left(\beta \left(\sqrt{1 - z^2} - 1\right)\right)
+ * \f]
+ *
+ * where z is the distance from the centre of the kernel in units of its
+ * half-width, which is (support + 0.5) grid cells, so that the kernel uses
+ * all (2 * support + 1) points of the support in each dimension.
+ * The shape parameter beta depends on the full width w of the kernel and
+ * the grid padding factor sigma (the ratio of grid size to image size),
+ * using the expression from Barnett et al. (2019, SIAM J. Sci. Comput.,
+ * 41, C479):
+ *
+ * \f[
+ * \beta = 0.97 \pi w \left(1 - \frac{1}{2 \sigma}\right)
+ * \f]
+ *
+ * @param[in] support    GCF support size (width = 2 * support + 1).
+ * @param[in] padding    Grid padding factor (grid size / image size).
+ * @param[in] oversample GCF oversample factor, or values per grid cell.
+ * @param[in,out] fn     GCF array, length oversample * (support + 1).
+ */
+OSKAR_EXPORT
+void oskar_grid_convolution_function_exp_semicircle(const int support,
+        const double padding, const int oversample, double* fn);
+
+/**
+ * @brief
+ * Generates grid correction function for ES convolution function.
+ *
+ * @details
+ * There is no closed-form expression for the Fourier transform of the
+ * ES kernel, so it is evaluated by numerical quadrature at each pixel.
+ *
+ * @param[in] image_size Side length of (padded) image.
+ * @param[in] support    GCF support size (width = 2 * support + 1).
+ * @param[in] padding    Grid padding factor (grid size / image size).
+ * @param[in,out] fn     Array holding correction function, length image_size.
+ */
+OSKAR_EXPORT
+void oskar_grid_correction_function_exp_semicircle(const int image_size,
+        const int support, const double padding, double* fn);
+
+/**
+ * @brief
+ * Returns the value of the ES kernel at a given distance from its centre.
+ *
+ * @param[in] support    GCF support size (width = 2 * support + 1).
+ * @param[in] padding    Grid padding factor (grid size / image size).
+ * @param[in] u          Distance from the kernel centre, in grid cells.
+ */
+OSKAR_EXPORT
+double oskar_grid_function_exp_semicircle(const int support,
+        const double padding, const double u);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_GRID_FUNCTIONS_EXP_SEMICIRCLE_H_ */
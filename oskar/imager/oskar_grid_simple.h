@@ -114,6 +114,128 @@ void oskar_grid_simple_f(
         double* restrict norm,
         float* restrict grid);
 
+/**
+ * @brief
+ * Multi-frequency synthesis gridding function (double precision).
+ *
+ * @details
+ * Grids the visibilities from a set of channels, using baseline coordinates
+ * in metres. The coordinates of each row are read once and scaled by the
+ * inverse wavelength of each channel inside the gridder, so they do not
+ * need to be copied and scaled for every channel first.
+ *
+ * The visibility data are in (row, channel, polarisation) order, and the
+ * weights are in (row, polarisation) order. Visibilities with a baseline
+ * length outside the range [\p uv_min, \p uv_max] (in wavelengths)
+ * are ignored.
+ *
+ * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
+ * @param[in] oversample    GCF oversample factor, or values per grid cell.
+ * @param[in] conv_func     GCF array, length oversample * (support + 1).
+ * @param[in] num_rows      Number of baseline coordinate rows.
+ * @param[in] num_channels  Number of channels to grid.
+ * @param[in] chan_index    Index of each channel to grid in \p vis.
+ * @param[in] inv_wavelength Inverse wavelength of each channel, in 1/m.
+ * @param[in] vis_num_channels Number of channels in \p vis.
+ * @param[in] num_pols      Number of polarisations in \p vis and \p weight.
+ * @param[in] pol           Index of the polarisation to grid.
+ * @param[in] uu            Baseline uu coordinates for each row, in metres.
+ * @param[in] vv            Baseline vv coordinates for each row, in metres.
+ * @param[in] vis           Complex visibilities, or NULL to use 1.
+ * @param[in] weight        Visibility weights.
+ * @param[in] uv_min        Minimum baseline length to grid, in wavelengths.
+ * @param[in] uv_max        Maximum baseline length to grid, in wavelengths.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] grid_size     Side length of image and grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[in,out] norm      Updated grid normalisation factor.
+ * @param[in,out] grid      Updated complex visibility grid.
+ */
+OSKAR_EXPORT
+void oskar_grid_simple_mfs_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const size_t num_rows,
+        const int num_channels,
+        const int* restrict chan_index,
+        const double* restrict inv_wavelength,
+        const int vis_num_channels,
+        const int num_pols,
+        const int pol,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* restrict vis,
+        const double* restrict weight,
+        const double uv_min,
+        const double uv_max,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* restrict grid);
+
+/**
+ * @brief
+ * Multi-frequency synthesis gridding function (single precision).
+ *
+ * @details
+ * Grids the visibilities from a set of channels, using baseline coordinates
+ * in metres. The coordinates of each row are read once and scaled by the
+ * inverse wavelength of each channel inside the gridder, so they do not
+ * need to be copied and scaled for every channel first.
+ *
+ * The visibility data are in (row, channel, polarisation) order, and the
+ * weights are in (row, polarisation) order. Visibilities with a baseline
+ * length outside the range [\p uv_min, \p uv_max] (in wavelengths)
+ * are ignored.
+ *
+ * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
+ * @param[in] oversample    GCF oversample factor, or values per grid cell.
+ * @param[in] conv_func     GCF array, length oversample * (support + 1).
+ * @param[in] num_rows      Number of baseline coordinate rows.
+ * @param[in] num_channels  Number of channels to grid.
+ * @param[in] chan_index    Index of each channel to grid in \p vis.
+ * @param[in] inv_wavelength Inverse wavelength of each channel, in 1/m.
+ * @param[in] vis_num_channels Number of channels in \p vis.
+ * @param[in] num_pols      Number of polarisations in \p vis and \p weight.
+ * @param[in] pol           Index of the polarisation to grid.
+ * @param[in] uu            Baseline uu coordinates for each row, in metres.
+ * @param[in] vv            Baseline vv coordinates for each row, in metres.
+ * @param[in] vis           Complex visibilities, or NULL to use 1.
+ * @param[in] weight        Visibility weights.
+ * @param[in] uv_min        Minimum baseline length to grid, in wavelengths.
+ * @param[in] uv_max        Maximum baseline length to grid, in wavelengths.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] grid_size     Side length of image and grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[in,out] norm      Updated grid normalisation factor.
+ * @param[in,out] grid      Updated complex visibility grid.
+ */
+OSKAR_EXPORT
+void oskar_grid_simple_mfs_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const size_t num_rows,
+        const int num_channels,
+        const int* restrict chan_index,
+        const double* restrict inv_wavelength,
+        const int vis_num_channels,
+        const int num_pols,
+        const int pol,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* restrict vis,
+        const float* restrict weight,
+        const double uv_min,
+        const double uv_max,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* restrict grid);
+
 #ifdef __cplusplus
 }
 #endif
@@ -35,6 +35,7 @@
 
 #include <oskar_global.h>
 #include <log/oskar_log.h>
+#include <mem/oskar_mem.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -150,6 +151,16 @@ double oskar_imager_freq_min_hz(const oskar_Imager* h);
 OSKAR_EXPORT
 int oskar_imager_generate_w_kernels_on_gpu(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the minimum subgrid size used by the IDG algorithm.
+ *
+ * @details
+ * Returns the minimum subgrid size used by the IDG algorithm.
+ */
+OSKAR_EXPORT
+int oskar_imager_idg_subgrid_size(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the image side length.
@@ -244,13 +255,26 @@ int oskar_imager_num_w_planes(const oskar_Imager* h);
 OSKAR_EXPORT
 const char* oskar_imager_output_root(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the oversample factor of the gridding kernel.
+ *
+ * @details
+ * Returns the oversample factor of the gridding kernel.
+ * If the kernel parameters are chosen from a target accuracy, this is
+ * only known after the imager has been initialised.
+ */
+OSKAR_EXPORT
+int oskar_imager_oversample(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the grid size required by the algorithm.
  *
  * @details
  * Returns the grid size required by the algorithm.
- * This will be different to the image size when using W-projection.
+ * This will be different to the image size when using W-projection,
+ * or when using the ES or Kaiser-Bessel kernels with the FFT algorithm.
  */
 OSKAR_EXPORT
 int oskar_imager_plane_size(oskar_Imager* h);
@@ -285,6 +309,18 @@ int oskar_imager_precision(const oskar_Imager* h);
 OSKAR_EXPORT
 int oskar_imager_scale_norm_with_num_input_files(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the support size of the gridding kernel.
+ *
+ * @details
+ * Returns the support size of the gridding kernel.
+ * If the kernel parameters are chosen from a target accuracy, this is
+ * only known after the imager has been initialised.
+ */
+OSKAR_EXPORT
+int oskar_imager_support(const oskar_Imager* h);
+
 /**
  * @brief
  * Sets the algorithm used by the imager.
@@ -297,6 +333,7 @@ int oskar_imager_scale_norm_with_num_input_files(const oskar_Imager* h);
  * - "W-projection" to use W-projection gridding followed by a FFT.
  * - "DFT 2D" to use a 2D Direct Fourier Transform, without gridding.
  * - "DFT 3D" to use a 3D Direct Fourier Transform, without gridding.
+ * - "IDG" to use image-domain gridding followed by a FFT.
  *
  * This function also sets the default gridding parameters.
  * Call oskar_imager_set_grid_kernel() or oskar_imager_set_oversample()
@@ -368,6 +405,23 @@ void oskar_imager_set_channel_snapshots(oskar_Imager* h, int value);
 OSKAR_EXPORT
 void oskar_imager_set_coords_only(oskar_Imager* h, int flag);
 
+/**
+ * @brief
+ * Sets the CPUs to which the worker threads are bound.
+ *
+ * @details
+ * Worker thread \p i is bound to CPU \p cpu_ids[i % num_cpus].
+ * If \p num_cpus is zero, the operating system schedules the threads
+ * on any CPU. A warning is logged if the affinity cannot be set.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     num_cpus   Number of CPU IDs in the list.
+ * @param[in]     cpu_ids    List of CPU IDs to use.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_cpu_affinity(oskar_Imager* h, int num_cpus,
+        const int* cpu_ids);
+
 /**
  * @brief
  * Clears any direction override.
@@ -486,6 +540,14 @@ void oskar_imager_set_gpus(oskar_Imager* h, int num, const int* ids,
  *
  * The \p type string can be:
  * - "Spheroidal" to use the spheroidal kernel from CASA.
+ * - "Pillbox" to use a pillbox kernel.
+ * - "Exponential of semicircle" to use the "ES" kernel.
+ * - "Kaiser-Bessel" to use a Kaiser-Bessel kernel.
+ *
+ * The width of the kernel is (2 * support + 1) grid cells.
+ * The ES and Kaiser-Bessel kernels are used with a grid padded by a
+ * factor of 1.25, so that the whole image is accurate, and their shape
+ * parameters are set from the padding factor.
  *
  * @param[in,out] h          Handle to imager.
  * @param[in]     type       Type of kernel to use.
@@ -497,6 +559,70 @@ OSKAR_EXPORT
 void oskar_imager_set_grid_kernel(oskar_Imager* h, const char* type,
         int support, int oversample, int* status);
 
+/**
+ * @brief
+ * Sets the target accuracy of the gridding kernel.
+ *
+ * @details
+ * If set to a value greater than zero, the support size and oversample
+ * factor of the "Exponential of semicircle" and "Kaiser-Bessel" gridding
+ * kernels are chosen automatically when the imager is initialised,
+ * overriding the values passed to oskar_imager_set_grid_kernel().
+ *
+ * The support is chosen from the grid padding factor so that the relative
+ * error over the whole image is approximately \p value, and the oversample
+ * factor so that the kernel look-up error is no larger than this
+ * (up to a maximum of 4096).
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     value      Target relative accuracy (e.g. 1e-4), or 0.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_grid_kernel_accuracy(oskar_Imager* h, double value);
+
+/**
+ * @brief
+ * Sets the A-term used by the IDG algorithm.
+ *
+ * @details
+ * Sets an optional direction-dependent gain (A-term) to apply to every
+ * subgrid when using the IDG algorithm, for example a station beam.
+ *
+ * The A-term is given as a square image of \p size by \p size pixels,
+ * which must cover the same field of view, and have the same orientation,
+ * as the output image. It can be real or complex. Its complex conjugate
+ * multiplies each subgrid image before the subgrid is transformed and
+ * added to the grid.
+ *
+ * Pass a NULL pointer to remove the A-term.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     size       Side length of the A-term image, in pixels.
+ * @param[in]     aterm      The A-term image, or NULL.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_idg_aterm(oskar_Imager* h, int size,
+        const oskar_Mem* aterm, int* status);
+
+/**
+ * @brief
+ * Sets the minimum subgrid size used by the IDG algorithm.
+ *
+ * @details
+ * Sets the minimum subgrid size used by the IDG algorithm.
+ * Visibilities are grouped by their position on the grid into tiles,
+ * and the visibilities in each tile are gridded onto a subgrid of this
+ * size using a direct Fourier transform. The subgrid is made larger
+ * automatically if needed to hold the W-term for the largest baseline
+ * W-coordinate.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     value      Minimum subgrid size.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_idg_subgrid_size(oskar_Imager* h, int value);
+
 /**
  * @brief
  * Sets image side length.
@@ -570,6 +696,23 @@ void oskar_imager_set_input_files(oskar_Imager* h, int num_files,
 OSKAR_EXPORT
 void oskar_imager_set_log(oskar_Imager* h, oskar_Log* log);
 
+/**
+ * @brief
+ * Sets the maximum amount of host memory to use.
+ *
+ * @details
+ * Sets the maximum amount of host memory to use, in GB.
+ * The memory needed for the image planes, weights grids and kernels is
+ * estimated after the algorithm has been initialised, and the imager
+ * fails with OSKAR_ERR_MEMORY_ALLOC_FAILURE if it exceeds this limit.
+ * A value less than or equal to zero means no limit.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     value      Maximum host memory, in GB.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_max_host_memory_gb(oskar_Imager* h, double value);
+
 /**
  * @brief
  * Sets the data column to use from a Measurement Set.
@@ -58,6 +58,7 @@ struct oskar_Imager
 
     /* Settings parameters. */
     int imager_prec, num_devices, num_gpus, *gpu_ids, fft_on_gpu;
+    int num_cpu_ids, *cpu_ids;
     int chan_snaps, im_type, num_im_channels, num_im_pols, pol_offset;
     int algorithm, image_size, use_stokes, support, oversample;
     int generate_w_kernels_on_gpu, set_cellsize, set_fov, weighting;
@@ -65,6 +66,7 @@ struct oskar_Imager
     char direction_type, kernel_type;
     char **input_files, *input_root, *output_root, *ms_column;
     double cellsize_rad, fov_deg, image_padding, im_centre_deg[2];
+    double kernel_accuracy, max_host_memory_gb;
     double uv_filter_min, uv_filter_max;
     double time_min_utc, time_max_utc, freq_min_hz, freq_max_hz;
 
@@ -76,6 +78,7 @@ struct oskar_Imager
     /* State. */
     int status, i_block;
     oskar_Mutex* mutex;
+    oskar_ThreadPool* thread_pool;
 
     /* Scratch data. */
     oskar_Mem *uu_im, *vv_im, *ww_im, *vis_im, *weight_im, *time_im;
@@ -101,6 +104,10 @@ struct oskar_Imager
     double w_scale, ww_min, ww_max, ww_rms;
     oskar_Mem *w_kernels, *w_support, *w_kernels_compact, *w_kernel_start;
 
+    /* Image-domain gridding (IDG) imager data. */
+    int idg_subgrid_size, idg_size, idg_aterm_size;
+    oskar_Mem *idg_aterm, *idg_gain, *idg_nm1, *idg_wsave;
+
     /* Memory allocated per GPU (array of DeviceData structures). */
     DeviceData* d;
 };
@@ -41,6 +41,12 @@ void oskar_imager_update_plane_fft(oskar_Imager* h, size_t num_vis,
         const oskar_Mem* weight, oskar_Mem* plane, double* plane_norm,
         size_t* num_skipped, int* status);
 
+void oskar_imager_update_plane_fft_mfs(oskar_Imager* h, size_t num_rows,
+        int start_chan, int end_chan, int num_pols, int im_pol,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* amps,
+        const oskar_Mem* weight, oskar_Mem* plane, double* plane_norm,
+        size_t* num_skipped, int* status);
+
 #ifdef __cplusplus
 }
 #endif
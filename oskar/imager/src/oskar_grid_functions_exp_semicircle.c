@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/oskar_grid_functions_exp_semicircle.h"
+
+#include "math/oskar_cmath.h"
+
+#define NUM_QUADRATURE_POINTS 1024
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static double beta_exp_semicircle(const int support, const double padding)
+{
+    const double width = 2 * support + 1;
+    return 0.97 * M_PI * width * (1.0 - 0.5 / padding);
+}
+
+void oskar_grid_convolution_function_exp_semicircle(const int support,
+        const double padding, const int oversample, double* fn)
+{
+    int i, gcf_size;
+    gcf_size = oversample * (support + 1);
+    for (i = 0; i < gcf_size; ++i)
+        fn[i] = oskar_grid_function_exp_semicircle(support, padding,
+                (double)i / (double)oversample);
+}
+
+
+void oskar_grid_correction_function_exp_semicircle(const int image_size,
+        const int support, const double padding, double* fn)
+{
+    int i, j, extent;
+    double du, sum, sum0 = 0.0, x, val, k[NUM_QUADRATURE_POINTS];
+    const double half_width = support + 0.5;
+    extent = image_size / 2;
+    du = half_width / NUM_QUADRATURE_POINTS;
+
+    /* Evaluate the (real, even) Fourier transform of the kernel using
+     * the midpoint rule: the kernel is negligible at the end points. */
+    for (j = 0; j < NUM_QUADRATURE_POINTS; ++j)
+    {
+        k[j] = oskar_grid_function_exp_semicircle(support, padding,
+                (j + 0.5) * du);
+        sum0 += k[j];
+    }
+    for (i = 0; i < image_size; ++i)
+    {
+        x = 2.0 * M_PI * du * (double)(i - extent) / (double)image_size;
+        sum = 0.0;
+        for (j = 0; j < NUM_QUADRATURE_POINTS; ++j)
+            sum += k[j] * cos(x * (j + 0.5));
+        val = sum / sum0;
+        fn[i] = (val != 0.0) ? 1.0 / val : 1.0;
+    }
+}
+
+
+double oskar_grid_function_exp_semicircle(const int support,
+        const double padding, const double u)
+{
+    const double half_width = support + 0.5;
+    const double beta = beta_exp_semicircle(support, padding);
+    const double z = u / half_width;
+    if (z >= 1.0) return 0.0;
+    return exp(beta * (sqrt(1.0 - z * z) - 1.0));
+}
+
+#ifdef __cplusplus
+}
+#endif
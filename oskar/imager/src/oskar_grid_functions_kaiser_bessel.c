@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/oskar_grid_functions_kaiser_bessel.h"
+
+#include "math/oskar_cmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static double beta_kaiser_bessel(const int support, const double padding)
+{
+    const double width = 2 * support + 1;
+    const double t = (padding - 0.5) / padding;
+    return M_PI * sqrt(t * t * width * width - 0.8);
+}
+
+/* Modified Bessel function of the first kind, order zero.
+ * All terms of the series are positive, so it is well-conditioned. */
+static double bessel_i0(const double x)
+{
+    int k;
+    double term = 1.0, sum = 1.0;
+    const double t = 0.25 * x * x;
+    for (k = 1; k < 500; ++k)
+    {
+        term *= t / ((double)k * (double)k);
+        sum += term;
+        if (term < sum * 1e-17) break;
+    }
+    return sum;
+}
+
+void oskar_grid_convolution_function_kaiser_bessel(const int support,
+        const double padding, const int oversample, double* fn)
+{
+    int i, gcf_size;
+    gcf_size = oversample * (support + 1);
+    for (i = 0; i < gcf_size; ++i)
+        fn[i] = oskar_grid_function_kaiser_bessel(support, padding,
+                (double)i / (double)oversample);
+}
+
+
+void oskar_grid_correction_function_kaiser_bessel(const int image_size,
+        const int support, const double padding, double* fn)
+{
+    int i, extent;
+    double t, val, val0;
+    const double beta = beta_kaiser_bessel(support, padding);
+    const double half_width = support + 0.5;
+    extent = image_size / 2;
+
+    /* The Fourier transform of the kernel is proportional to
+     * sinh(sqrt(beta^2 - t^2)) / sqrt(beta^2 - t^2),
+     * where t = 2 pi x * half_width, and x is in cycles per grid cell. */
+    val0 = sinh(beta) / beta;
+    for (i = 0; i < image_size; ++i)
+    {
+        t = 2.0 * M_PI * half_width * (double)(i - extent) / (double)image_size;
+        t = beta * beta - t * t;
+        if (t > 0.0)
+        {
+            t = sqrt(t);
+            val = sinh(t) / t;
+        }
+        else if (t < 0.0)
+        {
+            t = sqrt(-t);
+            val = sin(t) / t;
+        }
+        else val = 1.0;
+        val /= val0;
+        fn[i] = (val != 0.0) ? 1.0 / val : 1.0;
+    }
+}
+
+
+double oskar_grid_function_kaiser_bessel(const int support,
+        const double padding, const double u)
+{
+    const double half_width = support + 0.5;
+    const double beta = beta_kaiser_bessel(support, padding);
+    const double z = u / half_width;
+    if (z >= 1.0) return 0.0;
+    return bessel_i0(beta * sqrt(1.0 - z * z)) / bessel_i0(beta);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -332,6 +332,206 @@ void oskar_grid_simple_f(
     }
 }
 
+
+void oskar_grid_simple_mfs_d(
+        const int support,
+        const int oversample,
+        const double* restrict conv_func,
+        const size_t num_rows,
+        const int num_channels,
+        const int* restrict chan_index,
+        const double* restrict inv_wavelength,
+        const int vis_num_channels,
+        const int num_pols,
+        const int pol,
+        const double* restrict uu,
+        const double* restrict vv,
+        const double* restrict vis,
+        const double* restrict weight,
+        const double uv_min,
+        const double uv_max,
+        const double cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        double* restrict grid)
+{
+    size_t r;
+    const int grid_centre = grid_size / 2;
+    const double grid_scale = grid_size * cell_size_rad;
+    const double uv_min_sq = uv_min * uv_min, uv_max_sq = uv_max * uv_max;
+
+    /* Loop over baseline coordinate rows. */
+    *num_skipped = 0;
+    for (r = 0; r < num_rows; ++r)
+    {
+        int c;
+        const double uu_r = uu[r], vv_r = vv[r];
+        const double uv_sq_r = uu_r * uu_r + vv_r * vv_r;
+        const double weight_i = weight[num_pols * r + pol];
+
+        /* Loop over channels. */
+        for (c = 0; c < num_channels; ++c)
+        {
+            double sum = 0.0, v_re = weight_i, v_im = 0.0;
+            int j, k;
+            const double s = inv_wavelength[c];
+
+            /* Check the baseline length. */
+            const double uv_sq = uv_sq_r * s * s;
+            if (uv_sq < uv_min_sq || uv_sq > uv_max_sq) continue;
+
+            /* Convert UV coordinates to grid coordinates. */
+            const double pos_u = -uu_r * s * grid_scale;
+            const double pos_v = vv_r * s * grid_scale;
+            const int grid_u = (int)round(pos_u) + grid_centre;
+            const int grid_v = (int)round(pos_v) + grid_centre;
+
+            /* Scaled distance from nearest grid point. */
+            const int off_u = (int)round((round(pos_u) - pos_u) * oversample);
+            const int off_v = (int)round((round(pos_v) - pos_v) * oversample);
+
+            /* Catch points that would lie outside the grid. */
+            if (grid_u + support >= grid_size || grid_u - support < 0 ||
+                    grid_v + support >= grid_size || grid_v - support < 0)
+            {
+                *num_skipped += 1;
+                continue;
+            }
+
+            /* Get visibility data. */
+            if (vis)
+            {
+                const size_t i = num_pols *
+                        (vis_num_channels * r + chan_index[c]) + pol;
+                v_re = weight_i * vis[2 * i];
+                v_im = weight_i * vis[2 * i + 1];
+            }
+
+            /* Convolve this point onto the grid. */
+            for (j = -support; j <= support; ++j)
+            {
+                size_t p1;
+                const double c1 = conv_func[abs(off_v + j * oversample)];
+                p1 = grid_v + j;
+                p1 *= grid_size; /* Tested to avoid int overflow. */
+                p1 += grid_u;
+                for (k = -support; k <= support; ++k)
+                {
+                    const size_t p = (p1 + k) << 1;
+                    const double cv =
+                            conv_func[abs(off_u + k * oversample)] * c1;
+                    grid[p]     += v_re * cv;
+                    grid[p + 1] += v_im * cv;
+                    sum += cv;
+                }
+            }
+            *norm += sum * weight_i;
+        }
+    }
+}
+
+
+void oskar_grid_simple_mfs_f(
+        const int support,
+        const int oversample,
+        const float* restrict conv_func,
+        const size_t num_rows,
+        const int num_channels,
+        const int* restrict chan_index,
+        const double* restrict inv_wavelength,
+        const int vis_num_channels,
+        const int num_pols,
+        const int pol,
+        const float* restrict uu,
+        const float* restrict vv,
+        const float* restrict vis,
+        const float* restrict weight,
+        const double uv_min,
+        const double uv_max,
+        const float cell_size_rad,
+        const int grid_size,
+        size_t* restrict num_skipped,
+        double* restrict norm,
+        float* restrict grid)
+{
+    size_t r;
+    const int grid_centre = grid_size / 2;
+    const float grid_scale = grid_size * cell_size_rad;
+    const float uv_min_sq = (float) (uv_min * uv_min);
+    const float uv_max_sq = (float) (uv_max * uv_max);
+
+    /* Loop over baseline coordinate rows. */
+    *num_skipped = 0;
+    for (r = 0; r < num_rows; ++r)
+    {
+        int c;
+        const float uu_r = uu[r], vv_r = vv[r];
+        const float uv_sq_r = uu_r * uu_r + vv_r * vv_r;
+        const float weight_i = weight[num_pols * r + pol];
+
+        /* Loop over channels. */
+        for (c = 0; c < num_channels; ++c)
+        {
+            double sum = 0.0;
+            float v_re = weight_i, v_im = 0.0f;
+            int j, k;
+            const float s = (float) inv_wavelength[c];
+
+            /* Check the baseline length. */
+            const float uv_sq = uv_sq_r * s * s;
+            if (uv_sq < uv_min_sq || uv_sq > uv_max_sq) continue;
+
+            /* Convert UV coordinates to grid coordinates. */
+            const float pos_u = -uu_r * s * grid_scale;
+            const float pos_v = vv_r * s * grid_scale;
+            const int grid_u = (int)roundf(pos_u) + grid_centre;
+            const int grid_v = (int)roundf(pos_v) + grid_centre;
+
+            /* Scaled distance from nearest grid point. */
+            const int off_u = (int)roundf((roundf(pos_u) - pos_u) * oversample);
+            const int off_v = (int)roundf((roundf(pos_v) - pos_v) * oversample);
+
+            /* Catch points that would lie outside the grid. */
+            if (grid_u + support >= grid_size || grid_u - support < 0 ||
+                    grid_v + support >= grid_size || grid_v - support < 0)
+            {
+                *num_skipped += 1;
+                continue;
+            }
+
+            /* Get visibility data. */
+            if (vis)
+            {
+                const size_t i = num_pols *
+                        (vis_num_channels * r + chan_index[c]) + pol;
+                v_re = weight_i * vis[2 * i];
+                v_im = weight_i * vis[2 * i + 1];
+            }
+
+            /* Convolve this point onto the grid. */
+            for (j = -support; j <= support; ++j)
+            {
+                size_t p1;
+                const float c1 = conv_func[abs(off_v + j * oversample)];
+                p1 = grid_v + j;
+                p1 *= grid_size; /* Tested to avoid int overflow. */
+                p1 += grid_u;
+                for (k = -support; k <= support; ++k)
+                {
+                    const size_t p = (p1 + k) << 1;
+                    const float cv =
+                            conv_func[abs(off_u + k * oversample)] * c1;
+                    grid[p]     += v_re * cv;
+                    grid[p + 1] += v_im * cv;
+                    sum += cv;
+                }
+            }
+            *norm += sum * weight_i;
+        }
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
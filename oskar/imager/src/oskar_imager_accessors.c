@@ -57,6 +57,7 @@ const char* oskar_imager_algorithm(const oskar_Imager* h)
     case OSKAR_ALGORITHM_WPROJ:  return "W-projection";
     case OSKAR_ALGORITHM_DFT_2D: return "DFT 2D";
     case OSKAR_ALGORITHM_DFT_3D: return "DFT 3D";
+    case OSKAR_ALGORITHM_IDG:    return "IDG";
     default:                     return "";
     }
 }
@@ -110,6 +111,12 @@ int oskar_imager_generate_w_kernels_on_gpu(const oskar_Imager* h)
 }
 
 
+int oskar_imager_idg_subgrid_size(const oskar_Imager* h)
+{
+    return h->idg_subgrid_size;
+}
+
+
 int oskar_imager_image_size(const oskar_Imager* h)
 {
     return h->image_size;
@@ -172,11 +179,18 @@ const char* oskar_imager_output_root(const oskar_Imager* h)
 }
 
 
+int oskar_imager_oversample(const oskar_Imager* h)
+{
+    return h->oversample;
+}
+
+
 int oskar_imager_plane_size(oskar_Imager* h)
 {
     if (h->grid_size == 0)
     {
-        if (h->algorithm == OSKAR_ALGORITHM_WPROJ)
+        if (h->algorithm == OSKAR_ALGORITHM_WPROJ ||
+                (h->algorithm == OSKAR_ALGORITHM_FFT && h->image_padding > 1.0))
         {
             (void) oskar_imager_composite_nearest_even(h->image_padding *
                     ((double)(h->image_size)) - 0.5, 0, &h->grid_size);
@@ -215,6 +229,12 @@ int oskar_imager_scale_norm_with_num_input_files(const oskar_Imager* h)
 }
 
 
+int oskar_imager_support(const oskar_Imager* h)
+{
+    return h->support;
+}
+
+
 void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
         int* status)
 {
@@ -237,6 +257,8 @@ void oskar_imager_set_algorithm(oskar_Imager* h, const char* type,
         h->algorithm = OSKAR_ALGORITHM_DFT_2D;
     else if (!strncmp(type, "DFT 3", 5) || !strncmp(type, "dft 3", 5))
         h->algorithm = OSKAR_ALGORITHM_DFT_3D;
+    else if (!strncmp(type, "IDG", 3) || !strncmp(type, "idg", 3))
+        h->algorithm = OSKAR_ALGORITHM_IDG;
     else *status = OSKAR_ERR_INVALID_ARGUMENT;
 
     /* Recalculate grid plane size. */
@@ -296,6 +318,30 @@ void oskar_imager_set_coords_only(oskar_Imager* h, int flag)
 }
 
 
+void oskar_imager_set_cpu_affinity(oskar_Imager* h, int num_cpus,
+        const int* cpu_ids)
+{
+    int i;
+    free(h->cpu_ids);
+    h->cpu_ids = 0;
+    h->num_cpu_ids = 0;
+    if (num_cpus > 0)
+    {
+        h->cpu_ids = (int*) calloc(num_cpus, sizeof(int));
+        if (h->cpu_ids)
+        {
+            h->num_cpu_ids = num_cpus;
+            for (i = 0; i < num_cpus; ++i)
+                h->cpu_ids[i] = cpu_ids[i];
+        }
+    }
+
+    /* Re-create the worker threads with the new affinity when next used. */
+    oskar_thread_pool_free(h->thread_pool);
+    h->thread_pool = 0;
+}
+
+
 void oskar_imager_set_default_direction(oskar_Imager* h)
 {
     h->direction_type = 'O';
@@ -400,7 +446,78 @@ void oskar_imager_set_grid_kernel(oskar_Imager* h, const char* type,
         h->kernel_type = 'G';
     else if (!strncmp(type, "P", 1) || !strncmp(type, "p", 1))
         h->kernel_type = 'P';
+    else if (!strncmp(type, "E", 1) || !strncmp(type, "e", 1))
+        h->kernel_type = 'E';
+    else if (!strncmp(type, "K", 1) || !strncmp(type, "k", 1))
+        h->kernel_type = 'K';
     else *status = OSKAR_ERR_INVALID_ARGUMENT;
+
+    /* The ES and Kaiser-Bessel kernels are only accurate over the whole
+     * image if the grid is padded, so use a padding factor of 1.25. */
+    if (h->algorithm == OSKAR_ALGORITHM_FFT)
+    {
+        h->image_padding =
+                (h->kernel_type == 'E' || h->kernel_type == 'K') ? 1.25 : 1.0;
+        h->grid_size = 0;
+        oskar_imager_reset_cache(h, status);
+        (void) oskar_imager_plane_size(h);
+    }
+}
+
+
+void oskar_imager_set_grid_kernel_accuracy(oskar_Imager* h, double value)
+{
+    h->kernel_accuracy = value;
+}
+
+
+void oskar_imager_set_idg_aterm(oskar_Imager* h, int size,
+        const oskar_Mem* aterm, int* status)
+{
+    if (*status) return;
+    oskar_mem_free(h->idg_aterm, status);
+    oskar_mem_free(h->idg_gain, status);
+    h->idg_aterm = 0;
+    h->idg_gain = 0;
+    h->idg_aterm_size = 0;
+    if (!aterm || size <= 0) return;
+    if (oskar_mem_length(aterm) < (size_t)size * size)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Store the A-term as a complex double-precision image. */
+    h->idg_aterm_size = size;
+    h->idg_aterm = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            size * size, status);
+    if (oskar_mem_is_complex(aterm))
+        oskar_mem_copy_contents(h->idg_aterm, aterm, 0, 0,
+                size * size, status);
+    else
+    {
+        int i;
+        oskar_Mem* t;
+        double *out;
+        t = oskar_mem_convert_precision(aterm, OSKAR_DOUBLE, status);
+        out = oskar_mem_double(h->idg_aterm, status);
+        if (!*status)
+        {
+            const double* in = oskar_mem_double_const(t, status);
+            for (i = 0; i < size * size; ++i)
+            {
+                out[2 * i]     = in[i];
+                out[2 * i + 1] = 0.0;
+            }
+        }
+        oskar_mem_free(t, status);
+    }
+}
+
+
+void oskar_imager_set_idg_subgrid_size(oskar_Imager* h, int value)
+{
+    h->idg_subgrid_size = value;
 }
 
 
@@ -494,6 +611,12 @@ void oskar_imager_set_log(oskar_Imager* h, oskar_Log* log)
 }
 
 
+void oskar_imager_set_max_host_memory_gb(oskar_Imager* h, double value)
+{
+    h->max_host_memory_gb = value;
+}
+
+
 void oskar_imager_set_ms_column(oskar_Imager* h, const char* column,
         int* status)
 {
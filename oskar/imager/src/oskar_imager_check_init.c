@@ -31,6 +31,7 @@
 
 #include "imager/private_imager_init_dft.h"
 #include "imager/private_imager_init_fft.h"
+#include "imager/private_imager_init_idg.h"
 #include "imager/private_imager_init_wproj.h"
 #include "utility/oskar_timer.h"
 
@@ -67,6 +68,12 @@ void oskar_imager_check_init(oskar_Imager* h, int* status)
             oskar_imager_init_wproj(h, status);
         break;
     }
+    case OSKAR_ALGORITHM_IDG:
+    {
+        if (!h->idg_gain)
+            oskar_imager_init_idg(h, h->idg_subgrid_size, status);
+        break;
+    }
     default:
         *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
     }
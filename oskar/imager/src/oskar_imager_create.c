@@ -82,6 +82,7 @@ oskar_Imager* oskar_imager_create(int imager_precision, int* status)
     oskar_imager_set_ms_column(h, "DATA", status);
     oskar_imager_set_default_direction(h);
     oskar_imager_set_generate_w_kernels_on_gpu(h, 1);
+    oskar_imager_set_idg_subgrid_size(h, 32);
     oskar_imager_set_fov(h, 1.0);
     oskar_imager_set_size(h, 256, status);
     oskar_imager_set_uv_filter_max(h, DBL_MAX);
@@ -34,6 +34,8 @@
 #include "imager/oskar_imager.h"
 
 #include "imager/oskar_grid_correction.h"
+#include "imager/oskar_grid_functions_exp_semicircle.h"
+#include "imager/oskar_grid_functions_kaiser_bessel.h"
 #include "imager/oskar_grid_functions_pillbox.h"
 #include "imager/oskar_grid_functions_spheroidal.h"
 #include "math/oskar_fftpack_cfft.h"
@@ -278,7 +280,10 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
     if (!h->corr_func)
     {
         h->corr_func = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, size, status);
-        if (h->algorithm != OSKAR_ALGORITHM_FFT)
+        if (h->algorithm == OSKAR_ALGORITHM_IDG)
+            oskar_grid_correction_function_spheroidal(size, 0,
+                    oskar_mem_double(h->corr_func, status));
+        else if (h->algorithm != OSKAR_ALGORITHM_FFT)
             oskar_grid_correction_function_spheroidal(size, h->oversample,
                     oskar_mem_double(h->corr_func, status));
         else
@@ -289,6 +294,14 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
             else if (h->kernel_type == 'P')
                 oskar_grid_correction_function_pillbox(size,
                         oskar_mem_double(h->corr_func, status));
+            else if (h->kernel_type == 'E')
+                oskar_grid_correction_function_exp_semicircle(size,
+                        h->support, (double)size / (double)h->image_size,
+                        oskar_mem_double(h->corr_func, status));
+            else if (h->kernel_type == 'K')
+                oskar_grid_correction_function_kaiser_bessel(size,
+                        h->support, (double)size / (double)h->image_size,
+                        oskar_mem_double(h->corr_func, status));
         }
     }
 
@@ -43,6 +43,7 @@ void oskar_imager_free(oskar_Imager* h, int* status)
 {
     int i;
     if (!h) return;
+    oskar_thread_pool_free(h->thread_pool);
     oskar_imager_reset_cache(h, status);
     oskar_mem_free(h->uu_im, status);
     oskar_mem_free(h->vv_im, status);
@@ -54,6 +55,7 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     oskar_mem_free(h->weight_im, status);
     oskar_mem_free(h->weight_tmp, status);
     oskar_mem_free(h->time_im, status);
+    oskar_mem_free(h->idg_aterm, status);
     oskar_timer_free(h->tmr_grid_finalise);
     oskar_timer_free(h->tmr_grid_update);
     oskar_timer_free(h->tmr_init);
@@ -74,6 +76,7 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     free(h->output_root);
     free(h->ms_column);
     free(h->gpu_ids);
+    free(h->cpu_ids);
     free(h->d);
     free(h);
 }
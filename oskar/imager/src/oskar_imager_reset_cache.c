@@ -73,6 +73,10 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     oskar_mem_free(h->w_support, status); h->w_support = 0;
     oskar_mem_free(h->w_kernels_compact, status); h->w_kernels_compact = 0;
     oskar_mem_free(h->w_kernel_start, status); h->w_kernel_start = 0;
+    oskar_mem_free(h->idg_gain, status); h->idg_gain = 0;
+    oskar_mem_free(h->idg_nm1, status); h->idg_nm1 = 0;
+    oskar_mem_free(h->idg_wsave, status); h->idg_wsave = 0;
+    h->idg_size = 0;
 
     /* Free the image planes. */
     if (h->planes)
@@ -27,6 +27,7 @@
  */
 
 #include "imager/private_imager.h"
+#include "imager/private_imager_check_memory.h"
 #include "imager/private_imager_read_coords.h"
 #include "imager/private_imager_read_data.h"
 #include "imager/private_imager_read_dims.h"
@@ -151,8 +152,10 @@ void oskar_imager_run(oskar_Imager* h,
             oskar_log_message(h->log, 'M', 0, "Using %d W-planes.",
                     oskar_imager_num_w_planes(h));
         }
-        oskar_log_section(h->log, 'M', "Reading visibility data...");
     }
+    oskar_imager_check_memory(h, status);
+    if (h->log && !*status)
+        oskar_log_section(h->log, 'M', "Reading visibility data...");
 
     /* Loop over input files. */
     percent_done = 0; percent_next = 10;
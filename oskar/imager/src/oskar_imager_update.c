@@ -38,6 +38,7 @@
 #include "imager/private_imager_select_data.h"
 #include "imager/private_imager_update_plane_dft.h"
 #include "imager/private_imager_update_plane_fft.h"
+#include "imager/private_imager_update_plane_idg.h"
 #include "imager/private_imager_update_plane_wproj.h"
 #include "imager/private_imager_weight_radial.h"
 #include "imager/private_imager_weight_uniform.h"
@@ -179,7 +180,7 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
         const oskar_Mem* ww, const oskar_Mem* amps, const oskar_Mem* weight,
         const oskar_Mem* time_centroid, int* status)
 {
-    int c, p, plane;
+    int c, p, plane, use_mfs;
     size_t max_num_vis;
     oskar_Mem *tu = 0, *tv = 0, *tw = 0, *ta = 0, *th = 0;
     const oskar_Mem *u_in, *v_in, *w_in, *amp_in = 0, *weight_in;
@@ -247,9 +248,21 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
         weight_in = th;
     }
 
+    /* Grid all channels directly from the input baseline coordinates
+     * if possible, rather than copying and scaling them for each channel.
+     * This needs a gridder which does not modify the weights, and no
+     * per-visibility phase rotation or time filtering. */
+    use_mfs = !h->chan_snaps && !h->coords_only &&
+            h->algorithm == OSKAR_ALGORITHM_FFT &&
+            h->weighting == OSKAR_WEIGHTING_NATURAL &&
+            h->direction_type != 'R' &&
+            (!time_centroid || (h->time_min_utc <= 0.0 &&
+                    h->time_max_utc <= 0.0));
+
     /* Ensure work arrays are large enough. */
     max_num_vis = num_rows;
     if (!h->chan_snaps) max_num_vis *= (1 + end_chan - start_chan);
+    if (use_mfs) max_num_vis = 0;
     oskar_mem_realloc(h->uu_im, max_num_vis, status);
     oskar_mem_realloc(h->vv_im, max_num_vis, status);
     oskar_mem_realloc(h->ww_im, max_num_vis, status);
@@ -271,6 +284,24 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
             size_t num_vis = 0;
             if (*status) break;
 
+            /* Grid all channels at once if possible. */
+            plane = h->num_im_pols * c + p;
+            if (use_mfs)
+            {
+                size_t num_skipped = 0;
+                oskar_timer_resume(h->tmr_grid_update);
+                oskar_imager_update_plane_fft_mfs(h, num_rows, start_chan,
+                        end_chan, num_pols, p, u_in, v_in,
+                        h->im_type == OSKAR_IMAGE_TYPE_PSF ? 0 : amp_in,
+                        weight_in, h->planes[plane], &h->plane_norm[plane],
+                        &num_skipped, status);
+                oskar_timer_pause(h->tmr_grid_update);
+                if (num_skipped > 0)
+                    printf("WARNING: Skipped %lu visibility points.\n",
+                            (unsigned long) num_skipped);
+                continue;
+            }
+
             /* Get all visibility data needed to update this plane. */
             pu = h->uu_im; pv = h->vv_im; pw = h->ww_im;
             if (h->direction_type == 'R')
@@ -306,7 +337,6 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
                     h->ww_im, h->vis_im, h->weight_im, status);
 
             /* Update this image plane with the visibilities. */
-            plane = h->num_im_pols * c + p;
             if (h->coords_only)
                 oskar_imager_update_plane(h, num_vis, h->uu_im, h->vv_im,
                         h->ww_im, 0, h->weight_im, 0, 0,
@@ -419,6 +449,10 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
             oskar_imager_update_plane_wproj(h, num_vis, pu, pv, pw, pa, ph,
                     plane, plane_norm, &num_skipped, status);
             break;
+        case OSKAR_ALGORITHM_IDG:
+            oskar_imager_update_plane_idg(h, num_vis, pu, pv, pw, pa, ph,
+                    plane, plane_norm, &num_skipped, status);
+            break;
         default:
             *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
             break;
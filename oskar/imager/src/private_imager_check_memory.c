@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_check_memory.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static size_t mem_bytes(const oskar_Mem* mem)
+{
+    if (!mem) return 0;
+    return oskar_mem_length(mem) * oskar_mem_element_size(oskar_mem_type(mem));
+}
+
+void oskar_imager_check_memory(oskar_Imager* h, int* status)
+{
+    size_t planes, weights = 0, kernels = 0, total, plane_cells;
+    const double gigabyte = 1024.0 * 1024.0 * 1024.0;
+    const double megabyte = 1024.0 * 1024.0;
+    if (*status) return;
+
+    /* Image or visibility planes, one per output channel and polarisation. */
+    plane_cells = (size_t) oskar_imager_plane_size(h) *
+            (size_t) oskar_imager_plane_size(h);
+    planes = h->num_planes * plane_cells *
+            oskar_mem_element_size(oskar_imager_plane_type(h));
+
+    /* Grids of weights, if using uniform weighting. */
+    if (h->weighting == OSKAR_WEIGHTING_UNIFORM)
+        weights = h->num_planes * plane_cells *
+                oskar_mem_element_size(h->imager_prec);
+
+    /* Kernels and other algorithm data, which have already been set up. */
+    kernels += mem_bytes(h->l) + mem_bytes(h->m) + mem_bytes(h->n);
+    kernels += mem_bytes(h->conv_func) + mem_bytes(h->corr_func);
+    kernels += mem_bytes(h->fftpack_wsave) + mem_bytes(h->fftpack_work);
+    kernels += mem_bytes(h->w_kernels) + mem_bytes(h->w_support);
+    kernels += mem_bytes(h->w_kernels_compact);
+    kernels += mem_bytes(h->w_kernel_start);
+    kernels += mem_bytes(h->idg_aterm) + mem_bytes(h->idg_gain);
+    kernels += mem_bytes(h->idg_nm1) + mem_bytes(h->idg_wsave);
+    total = planes + weights + kernels;
+
+    /* Write the estimate to the log. */
+    oskar_log_message(h->log, 'M', 0, "Memory estimate:");
+    oskar_log_value(h->log, 'M', 1, "Image planes", "%d x %.1f MB",
+            h->num_planes, h->num_planes > 0 ?
+                    planes / (megabyte * h->num_planes) : 0.0);
+    if (weights > 0)
+        oskar_log_value(h->log, 'M', 1, "Weights grids", "%.1f MB",
+                weights / megabyte);
+    oskar_log_value(h->log, 'M', 1, "Kernels", "%.1f MB",
+            kernels / megabyte);
+    oskar_log_value(h->log, 'M', 1, "Total", "%.1f MB", total / megabyte);
+
+    /* All planes must be held in memory at once, so fail now if they
+     * will not fit. */
+    if (h->max_host_memory_gb > 0.0 &&
+            total > (size_t) (h->max_host_memory_gb * gigabyte))
+    {
+        oskar_log_error(h->log, "Estimated memory (%.3f GB) exceeds the "
+                "limit of %.3f GB: reduce the image size, or the number "
+                "of channels or polarisations imaged together.",
+                total / gigabyte, h->max_host_memory_gb);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -29,18 +29,36 @@
 #include "imager/private_imager.h"
 
 #include "imager/private_imager_init_fft.h"
+#include "imager/oskar_imager_accessors.h"
 #include "imager/oskar_grid_functions_spheroidal.h"
 #include "imager/oskar_grid_functions_pillbox.h"
+#include "imager/oskar_grid_functions_exp_semicircle.h"
+#include "imager/oskar_grid_functions_kaiser_bessel.h"
+
+#include "math/oskar_cmath.h"
+
+#define MAX_OVERSAMPLE 4096
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+static void set_kernel_parameters(oskar_Imager* h, double padding);
+
 void oskar_imager_init_fft(oskar_Imager* h, int* status)
 {
     oskar_Mem* tmp = 0;
+    double padding;
     if (*status) return;
 
+    /* Get the actual grid padding factor. */
+    padding = (double)oskar_imager_plane_size(h) / (double)h->image_size;
+
+    /* Choose the kernel size from the target accuracy, if required. */
+    if (h->kernel_accuracy > 0.0 &&
+            (h->kernel_type == 'E' || h->kernel_type == 'K'))
+        set_kernel_parameters(h, padding);
+
     /* Generate the convolution function. */
     tmp = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
             h->oversample * (h->support + 1), status);
@@ -54,6 +72,14 @@ void oskar_imager_init_fft(oskar_Imager* h, int* status)
         oskar_grid_convolution_function_pillbox(h->support, h->oversample,
                 oskar_mem_double(tmp, status));
         break;
+    case 'E':
+        oskar_grid_convolution_function_exp_semicircle(h->support, padding,
+                h->oversample, oskar_mem_double(tmp, status));
+        break;
+    case 'K':
+        oskar_grid_convolution_function_kaiser_bessel(h->support, padding,
+                h->oversample, oskar_mem_double(tmp, status));
+        break;
     default:
         *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
         break;
@@ -65,6 +91,46 @@ void oskar_imager_init_fft(oskar_Imager* h, int* status)
     oskar_mem_free(tmp, status);
 }
 
+static void set_kernel_parameters(oskar_Imager* h, double padding)
+{
+    int i, width;
+    double val, prev, max_step = 0.0;
+    const double accuracy = h->kernel_accuracy;
+
+    /* The error of the ES and Kaiser-Bessel kernels falls exponentially
+     * with the kernel width, at a rate that depends on the grid padding
+     * (Barnett et al., 2019, SIAM J. Sci. Comput., 41, C479). */
+    if (padding <= 1.0) padding = 1.25;
+    width = (int) ceil(-log(accuracy) / (M_PI * sqrt(1.0 - 1.0 / padding)));
+    h->support = width / 2;
+    if (h->support < 1) h->support = 1;
+
+    /* Find the largest change in the kernel between points of a finely
+     * sampled look-up table, and choose the oversample factor so that the
+     * error from the nearest table entry is below the target accuracy. */
+    prev = (h->kernel_type == 'E') ?
+            oskar_grid_function_exp_semicircle(h->support, padding, 0.0) :
+            oskar_grid_function_kaiser_bessel(h->support, padding, 0.0);
+    for (i = 1; i <= MAX_OVERSAMPLE * (h->support + 1); ++i)
+    {
+        const double u = (double)i / MAX_OVERSAMPLE;
+        val = (h->kernel_type == 'E') ?
+                oskar_grid_function_exp_semicircle(h->support, padding, u) :
+                oskar_grid_function_kaiser_bessel(h->support, padding, u);
+        if (fabs(val - prev) > max_step) max_step = fabs(val - prev);
+        prev = val;
+    }
+    h->oversample = (int) ceil(0.5 * max_step * MAX_OVERSAMPLE / accuracy);
+    if (h->oversample > MAX_OVERSAMPLE)
+    {
+        h->oversample = MAX_OVERSAMPLE;
+        oskar_log_warning(h->log, "Grid kernel accuracy %.3g cannot be "
+                "reached: oversample limited to %d, giving accuracy %.3g.",
+                accuracy, MAX_OVERSAMPLE, 0.5 * max_step);
+    }
+    if (h->oversample < 1) h->oversample = 1;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/private_imager_init_idg.h"
+#include "imager/oskar_imager_accessors.h"
+#include "imager/oskar_grid_functions_spheroidal.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_fftpack_cfft.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_imager_init_idg(oskar_Imager* h, int subgrid_size, int* status)
+{
+    int i, j, len, grid_size;
+    double *gain, *nm1, *taper, l_inc, scale;
+    const double *aterm = 0;
+    if (*status) return;
+
+    /* Free any existing subgrid data. */
+    oskar_mem_free(h->idg_gain, status);
+    oskar_mem_free(h->idg_nm1, status);
+    oskar_mem_free(h->idg_wsave, status);
+    h->idg_size = subgrid_size;
+    h->idg_gain = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            subgrid_size * subgrid_size, status);
+    h->idg_nm1 = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            subgrid_size * subgrid_size, status);
+    len = 4 * subgrid_size + 2 * (int)(log((double)subgrid_size) /
+            log(2.0)) + 8;
+    h->idg_wsave = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, len, status);
+    if (*status) return;
+    oskar_fftpack_cfft2i(subgrid_size, subgrid_size,
+            oskar_mem_double(h->idg_wsave, status));
+
+    /* Each subgrid covers the whole field of view of the grid, so the
+     * subgrid pixel separation in direction cosines is larger than the
+     * image cell size by the ratio of the grid and subgrid sizes. */
+    grid_size = oskar_imager_plane_size(h);
+    l_inc = h->cellsize_rad * grid_size / subgrid_size;
+
+    /* Evaluate the taper. Its Fourier transform is the spheroidal
+     * convolution function, so the standard grid correction applies. */
+    taper = (double*) calloc(subgrid_size, sizeof(double));
+    if (!taper)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    for (i = 0; i < subgrid_size; ++i)
+        taper[i] = oskar_grid_function_spheroidal(
+                fabs((double)(i - subgrid_size / 2) / (subgrid_size / 2)));
+
+    /* Evaluate the pixel gains and the (n - 1) term for each pixel.
+     * The gain includes the normalisation of the inverse FFT. */
+    if (h->idg_aterm)
+        aterm = oskar_mem_double_const(h->idg_aterm, status);
+    gain = oskar_mem_double(h->idg_gain, status);
+    nm1 = oskar_mem_double(h->idg_nm1, status);
+    scale = 1.0 / ((double)subgrid_size * subgrid_size);
+    for (j = 0; j < subgrid_size; ++j)
+    {
+        const double m = (j - subgrid_size / 2) * l_inc;
+        for (i = 0; i < subgrid_size; ++i)
+        {
+            const int p = j * subgrid_size + i;
+            const double l = (i - subgrid_size / 2) * l_inc;
+            const double r2 = l * l + m * m;
+            double re = taper[i] * taper[j] * scale, im = 0.0;
+            if (aterm)
+            {
+                /* Use the A-term pixel containing the centre of the
+                 * subgrid pixel, and apply its complex conjugate. */
+                const int n = h->idg_aterm_size;
+                int ia, ja, k;
+                ia = (int) floor((i + 0.5) * n / subgrid_size);
+                ja = (int) floor((j + 0.5) * n / subgrid_size);
+                if (ia > n - 1) ia = n - 1;
+                if (ja > n - 1) ja = n - 1;
+                k = 2 * (ja * n + ia);
+                im = -re * aterm[k + 1];
+                re *= aterm[k];
+            }
+            if (r2 < 1.0)
+                nm1[p] = sqrt(1.0 - r2) - 1.0;
+            else
+            {
+                nm1[p] = -1.0;
+                re = im = 0.0;
+            }
+            gain[2 * p]     = re;
+            gain[2 * p + 1] = im;
+        }
+    }
+    free(taper);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -60,7 +60,7 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
         double* plane_norm, int* status)
 {
     size_t i, num_pixels, num_threads;
-    oskar_Thread** threads = 0;
+    int submit_error = 0;
     ThreadArgs* args = 0;
     if (*status) return;
 
@@ -90,7 +90,20 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
     }
 
     /* Set up worker threads. */
-    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+    if (oskar_thread_pool_num_threads(h->thread_pool) != (int) num_threads)
+    {
+        oskar_thread_pool_free(h->thread_pool);
+        h->thread_pool = oskar_thread_pool_create((int) num_threads);
+        if (h->num_cpu_ids > 0 && oskar_thread_pool_set_affinity(
+                h->thread_pool, h->num_cpu_ids, h->cpu_ids))
+            oskar_log_warning(h->log,
+                    "Unable to set the CPU affinity of worker threads.");
+    }
+    if (!h->thread_pool)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
     args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
     for (i = 0; i < num_threads; ++i)
     {
@@ -106,19 +119,18 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
     /* Start the worker threads. */
     h->i_block = 0;
     for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+        if (oskar_thread_pool_submit(h->thread_pool, run_blocks,
+                (void*)&args[i]))
+            submit_error = 1;
 
     /* Wait for worker threads to finish. */
-    for (i = 0; i < num_threads; ++i)
-    {
-        oskar_thread_join(threads[i]);
-        oskar_thread_free(threads[i]);
-    }
-    free(threads);
+    oskar_thread_pool_wait(h->thread_pool);
     free(args);
 
     /* Get status code. */
     *status = h->status;
+    if (!*status && submit_error)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
 
     /* Update normalisation. */
     if (oskar_mem_precision(weight) == OSKAR_DOUBLE)
@@ -32,10 +32,16 @@
 #include "imager/private_imager_update_plane_fft.h"
 #include "imager/oskar_grid_simple.h"
 
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define C0 299792458.0
+
 void oskar_imager_update_plane_fft(oskar_Imager* h, size_t num_vis,
         const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* amps,
         const oskar_Mem* weight, oskar_Mem* plane, double* plane_norm,
@@ -71,6 +77,88 @@ void oskar_imager_update_plane_fft(oskar_Imager* h, size_t num_vis,
                 oskar_mem_float(plane, status));
 }
 
+
+void oskar_imager_update_plane_fft_mfs(oskar_Imager* h, size_t num_rows,
+        int start_chan, int end_chan, int num_pols, int im_pol,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* amps,
+        const oskar_Mem* weight, oskar_Mem* plane, double* plane_norm,
+        size_t* num_skipped, int* status)
+{
+    int c, i, p, grid_size, num_channels = 0, *chan_index;
+    size_t num_cells;
+    double *inv_wavelength, uv_max;
+    const double s = 0.05;
+    const double df = h->freq_inc_hz != 0.0 ? h->freq_inc_hz : 1.0;
+    const double f0 = h->vis_freq_start_hz;
+    if (*status) return;
+    grid_size = oskar_imager_plane_size(h);
+    num_cells = grid_size * grid_size;
+    if (oskar_mem_precision(plane) != h->imager_prec)
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+    if (oskar_mem_length(plane) < num_cells)
+        oskar_mem_realloc(plane, num_cells, status);
+    if (*status) return;
+
+    /* Get the polarisation to use. */
+    p = h->pol_offset;
+    if (h->im_type == OSKAR_IMAGE_TYPE_STOKES ||
+            h->im_type == OSKAR_IMAGE_TYPE_LINEAR)
+        p = im_pol;
+    if (num_pols == 1) p = 0;
+
+    /* Find the selected channels in the block, and their wavelengths. */
+    chan_index = (int*) malloc(h->num_sel_freqs * sizeof(int));
+    inv_wavelength = (double*) malloc(h->num_sel_freqs * sizeof(double));
+    if (h->num_sel_freqs > 0 && (!chan_index || !inv_wavelength))
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        free(chan_index);
+        free(inv_wavelength);
+        return;
+    }
+    for (i = 0; i < h->num_sel_freqs; ++i)
+    {
+        c = (int) round((h->sel_freqs[i] - f0) / df);
+        if (c < start_chan || c > end_chan) continue;
+        if (fabs((h->sel_freqs[i] - f0) - c * df) > s * df) continue;
+        chan_index[num_channels] = c - start_chan;
+        inv_wavelength[num_channels] = (f0 + c * df) / C0;
+        num_channels++;
+    }
+
+    /* Grid all the channels at once. */
+    uv_max = (h->uv_filter_max < 0.0) ? (double) FLT_MAX : h->uv_filter_max;
+    if (num_channels > 0)
+    {
+        if (h->imager_prec == OSKAR_DOUBLE)
+            oskar_grid_simple_mfs_d(h->support, h->oversample,
+                    oskar_mem_double_const(h->conv_func, status), num_rows,
+                    num_channels, chan_index, inv_wavelength,
+                    1 + end_chan - start_chan, num_pols, p,
+                    oskar_mem_double_const(uu, status),
+                    oskar_mem_double_const(vv, status),
+                    amps ? oskar_mem_double_const(amps, status) : 0,
+                    oskar_mem_double_const(weight, status),
+                    h->uv_filter_min, uv_max, h->cellsize_rad, grid_size,
+                    num_skipped, plane_norm,
+                    oskar_mem_double(plane, status));
+        else
+            oskar_grid_simple_mfs_f(h->support, h->oversample,
+                    oskar_mem_float_const(h->conv_func, status), num_rows,
+                    num_channels, chan_index, inv_wavelength,
+                    1 + end_chan - start_chan, num_pols, p,
+                    oskar_mem_float_const(uu, status),
+                    oskar_mem_float_const(vv, status),
+                    amps ? oskar_mem_float_const(amps, status) : 0,
+                    oskar_mem_float_const(weight, status),
+                    h->uv_filter_min, uv_max, (float) (h->cellsize_rad),
+                    grid_size, num_skipped, plane_norm,
+                    oskar_mem_float(plane, status));
+    }
+    free(chan_index);
+    free(inv_wavelength);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_init_idg.h"
+#include "imager/private_imager_update_plane_idg.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_fftpack_cfft.h"
+#include "math/oskar_fftphase.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Half-width of the spheroidal kernel, plus one cell for rounding. */
+#define TAPER_SUPPORT 4
+
+static void grid_subgrids(oskar_Imager* h, int num_active,
+        const int* active, const int* tile_start, const int* order,
+        int num_tiles, int tile, int margin, const double* pos_u,
+        const double* pos_v, const double* pos_w, const double* vis,
+        int grid_size, oskar_Mem* plane, int* status);
+static void subgrid_dft(const int subgrid_size, const int num_vis,
+        const double* restrict du, const double* restrict dv,
+        const double* restrict ww, const double* restrict vis,
+        const double* restrict nm1, const double* restrict gain,
+        double* restrict subgrid);
+
+void oskar_imager_update_plane_idg(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, oskar_Mem* plane,
+        double* plane_norm, size_t* num_skipped, int* status)
+{
+    size_t i, num_cells;
+    int t, grid_size, subgrid_size, margin, tile, num_tiles, num_active = 0;
+    int *tile_index, *tile_start, *order, *active;
+    double *pos_u, *pos_v, *pos_w, *vis, *wt;
+    double grid_scale, l_max, r2, n_corner, max_w = 0.0;
+    if (*status) return;
+
+    /* Check the plane. */
+    grid_size = oskar_imager_plane_size(h);
+    num_cells = grid_size * grid_size;
+    if (oskar_mem_precision(plane) != h->imager_prec)
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+    if (oskar_mem_length(plane) < num_cells)
+        oskar_mem_realloc(plane, num_cells, status);
+    if (*status || num_vis == 0) return;
+
+    /* Convert the baseline coordinates to grid positions, relative to the
+     * grid corner, and apply the weights to the visibilities. */
+    pos_u = (double*) malloc(num_vis * sizeof(double));
+    pos_v = (double*) malloc(num_vis * sizeof(double));
+    pos_w = (double*) malloc(num_vis * sizeof(double));
+    wt    = (double*) malloc(num_vis * sizeof(double));
+    vis   = (double*) malloc(2 * num_vis * sizeof(double));
+    if (!pos_u || !pos_v || !pos_w || !wt || !vis)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        free(pos_u);
+        free(pos_v);
+        free(pos_w);
+        free(wt);
+        free(vis);
+        return;
+    }
+    grid_scale = grid_size * h->cellsize_rad;
+#define CONVERT_LOOP \
+        for (i = 0; i < num_vis; ++i)                                    \
+        {                                                                \
+            pos_u[i] = -u_[i] * grid_scale + grid_size / 2;              \
+            pos_v[i] = v_[i] * grid_scale + grid_size / 2;               \
+            pos_w[i] = w_[i];                                            \
+            wt[i] = h_[i];                                               \
+            vis[2 * i]     = h_[i] * a_[2 * i];                          \
+            vis[2 * i + 1] = h_[i] * a_[2 * i + 1];                      \
+        }
+    if (h->imager_prec == OSKAR_DOUBLE)
+    {
+        const double *u_, *v_, *w_, *a_, *h_;
+        u_ = oskar_mem_double_const(uu, status);
+        v_ = oskar_mem_double_const(vv, status);
+        w_ = oskar_mem_double_const(ww, status);
+        a_ = oskar_mem_double_const(amps, status);
+        h_ = oskar_mem_double_const(weight, status);
+        CONVERT_LOOP
+    }
+    else
+    {
+        const float *u_, *v_, *w_, *a_, *h_;
+        u_ = oskar_mem_float_const(uu, status);
+        v_ = oskar_mem_float_const(vv, status);
+        w_ = oskar_mem_float_const(ww, status);
+        a_ = oskar_mem_float_const(amps, status);
+        h_ = oskar_mem_float_const(weight, status);
+        CONVERT_LOOP
+    }
+#undef CONVERT_LOOP
+    for (i = 0; i < num_vis; ++i)
+        if (fabs(pos_w[i]) > max_w) max_w = fabs(pos_w[i]);
+
+    /* Each visibility must be at least the extent of its kernel away from
+     * the edge of its subgrid. The W-term kernel is widest for the
+     * largest W, and its extent is set by the phase gradient at the
+     * corner of the field. */
+    l_max = 0.5 * grid_scale;
+    r2 = 2.0 * l_max * l_max;
+    n_corner = (r2 < 0.99) ? sqrt(1.0 - r2) : 0.1;
+    margin = TAPER_SUPPORT + (int) ceil(max_w * r2 / n_corner);
+    subgrid_size = h->idg_subgrid_size;
+    if (subgrid_size < 2 * margin + 8)
+        subgrid_size = 2 * margin + 8;
+    subgrid_size += (subgrid_size & 1);
+    if (subgrid_size != h->idg_size || !h->idg_gain)
+        oskar_imager_init_idg(h, subgrid_size, status);
+
+    /* Assign each visibility to a tile, using a counting sort.
+     * The subgrid for each tile extends beyond it by the margin. */
+    tile = subgrid_size - 2 * margin;
+    num_tiles = (grid_size + tile - 1) / tile;
+    tile_index = (int*) malloc(num_vis * sizeof(int));
+    tile_start = (int*) calloc(num_tiles * num_tiles + 1, sizeof(int));
+    order      = (int*) malloc(num_vis * sizeof(int));
+    active     = (int*) malloc(num_tiles * num_tiles * sizeof(int));
+    if (!tile_index || !tile_start || !order || !active)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    for (i = 0; !*status && i < num_vis; ++i)
+    {
+        const double pu = pos_u[i], pv = pos_v[i];
+        if (pu - margin < 0.0 || pu + margin >= grid_size - 1 ||
+                pv - margin < 0.0 || pv + margin >= grid_size - 1)
+        {
+            tile_index[i] = -1;
+            *num_skipped += 1;
+            continue;
+        }
+        tile_index[i] = ((int)(pv / tile)) * num_tiles + (int)(pu / tile);
+        tile_start[tile_index[i] + 1]++;
+        *plane_norm += wt[i];
+    }
+    if (!*status)
+    {
+        for (t = 0; t < num_tiles * num_tiles; ++t)
+        {
+            if (tile_start[t + 1] > 0) active[num_active++] = t;
+            tile_start[t + 1] += tile_start[t];
+        }
+        for (i = 0; i < num_vis; ++i)
+        {
+            const int k = tile_index[i];
+            if (k >= 0) order[tile_start[k]++] = (int) i;
+        }
+        for (t = num_tiles * num_tiles; t > 0; --t)
+            tile_start[t] = tile_start[t - 1];
+        tile_start[0] = 0;
+    }
+
+    /* Grid the visibilities in each subgrid. */
+    grid_subgrids(h, num_active, active, tile_start, order, num_tiles,
+            tile, margin, pos_u, pos_v, pos_w, vis, grid_size, plane, status);
+
+    /* Clean up. */
+    free(pos_u);
+    free(pos_v);
+    free(pos_w);
+    free(wt);
+    free(vis);
+    free(tile_index);
+    free(tile_start);
+    free(order);
+    free(active);
+}
+
+
+static void grid_subgrids(oskar_Imager* h, int num_active,
+        const int* active, const int* tile_start, const int* order,
+        int num_tiles, int tile, int margin, const double* pos_u,
+        const double* pos_v, const double* pos_w, const double* vis,
+        int grid_size, oskar_Mem* plane, int* status)
+{
+    int a;
+    const int subgrid_size = h->idg_size;
+    const int num_pixels = subgrid_size * subgrid_size;
+    const double *gain, *nm1;
+    double *wsave;
+    double* grid_d = 0;
+    float* grid_f = 0;
+    if (*status) return;
+    gain  = oskar_mem_double_const(h->idg_gain, status);
+    nm1   = oskar_mem_double_const(h->idg_nm1, status);
+    wsave = oskar_mem_double(h->idg_wsave, status);
+    if (oskar_mem_precision(plane) == OSKAR_DOUBLE)
+        grid_d = oskar_mem_double(plane, status);
+    else
+        grid_f = oskar_mem_float(plane, status);
+
+    /* Each thread computes whole subgrids. */
+#pragma omp parallel private(a)
+    {
+        int max_vis = 0, ok;
+        double *subgrid, *work, *du = 0, *dv = 0, *dw = 0, *dvis = 0;
+        subgrid = (double*) malloc(2 * num_pixels * sizeof(double));
+        work    = (double*) malloc(2 * num_pixels * sizeof(double));
+        ok = subgrid && work;
+#pragma omp for schedule(dynamic, 1)
+        for (a = 0; a < num_active; ++a)
+        {
+            int j, k, x, y, x0, y0;
+            const int t = active[a];
+            const int start = tile_start[t];
+            const int num = tile_start[t + 1] - start;
+            if (!ok) continue;
+
+            /* Get the corner of the subgrid on the grid. */
+            x0 = (t % num_tiles) * tile - margin;
+            y0 = (t / num_tiles) * tile - margin;
+
+            /* Gather the visibilities, relative to the subgrid centre. */
+            if (num > max_vis)
+            {
+                max_vis = num;
+                free(du);
+                free(dv);
+                free(dw);
+                free(dvis);
+                du   = (double*) malloc(max_vis * sizeof(double));
+                dv   = (double*) malloc(max_vis * sizeof(double));
+                dw   = (double*) malloc(max_vis * sizeof(double));
+                dvis = (double*) malloc(2 * max_vis * sizeof(double));
+                ok = du && dv && dw && dvis;
+                if (!ok) continue;
+            }
+            for (j = 0; j < num; ++j)
+            {
+                const int i = order[start + j];
+                du[j] = pos_u[i] - (x0 + subgrid_size / 2);
+                dv[j] = pos_v[i] - (y0 + subgrid_size / 2);
+                dw[j] = pos_w[i];
+                dvis[2 * j]     = vis[2 * i];
+                dvis[2 * j + 1] = vis[2 * i + 1];
+            }
+
+            /* Form the subgrid image, and transform it to the subgrid. */
+            subgrid_dft(subgrid_size, num, du, dv, dw, dvis, nm1, gain,
+                    subgrid);
+            oskar_fftphase_cd(subgrid_size, subgrid_size, subgrid);
+            oskar_fftpack_cfft2b(subgrid_size, subgrid_size, subgrid_size,
+                    subgrid, wsave, work);
+            oskar_fftphase_cd(subgrid_size, subgrid_size, subgrid);
+
+            /* Add the subgrid to the grid. */
+#pragma omp critical (oskar_imager_idg_add)
+            for (y = 0; y < subgrid_size; ++y)
+            {
+                size_t p1;
+                const int gy = y0 + y;
+                if (gy < 0 || gy >= grid_size) continue;
+                p1 = gy;
+                p1 *= grid_size;
+                for (x = 0; x < subgrid_size; ++x)
+                {
+                    size_t p;
+                    const int gx = x0 + x;
+                    if (gx < 0 || gx >= grid_size) continue;
+                    p = (p1 + gx) << 1;
+                    k = (y * subgrid_size + x) << 1;
+                    if (grid_d)
+                    {
+                        grid_d[p]     += subgrid[k];
+                        grid_d[p + 1] += subgrid[k + 1];
+                    }
+                    else
+                    {
+                        grid_f[p]     += (float) subgrid[k];
+                        grid_f[p + 1] += (float) subgrid[k + 1];
+                    }
+                }
+            }
+        }
+        if (!ok)
+        {
+#pragma omp critical (oskar_imager_idg_status)
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        }
+        free(subgrid);
+        free(work);
+        free(du);
+        free(dv);
+        free(dw);
+        free(dvis);
+    }
+}
+
+
+static void subgrid_dft(const int subgrid_size, const int num_vis,
+        const double* restrict du, const double* restrict dv,
+        const double* restrict ww, const double* restrict vis,
+        const double* restrict nm1, const double* restrict gain,
+        double* restrict subgrid)
+{
+    int i, j, k;
+    const double inc = 2.0 * M_PI / subgrid_size;
+    for (j = 0; j < subgrid_size; ++j)
+    {
+        const double y = (j - subgrid_size / 2) * inc;
+        for (i = 0; i < subgrid_size; ++i)
+        {
+            double sum_re = 0.0, sum_im = 0.0;
+            const int p = j * subgrid_size + i;
+            const double x = (i - subgrid_size / 2) * inc;
+            const double z = 2.0 * M_PI * nm1[p];
+            const double g_re = gain[2 * p], g_im = gain[2 * p + 1];
+            if (g_re == 0.0 && g_im == 0.0)
+            {
+                subgrid[2 * p] = subgrid[2 * p + 1] = 0.0;
+                continue;
+            }
+
+            /* Sum the visibilities in the direction of this pixel. */
+            for (k = 0; k < num_vis; ++k)
+            {
+                const double phase = -z * ww[k] - x * du[k] - y * dv[k];
+                const double re = cos(phase), im = sin(phase);
+                sum_re += vis[2 * k] * re - vis[2 * k + 1] * im;
+                sum_im += vis[2 * k] * im + vis[2 * k + 1] * re;
+            }
+
+            /* Apply the taper and A-term. */
+            subgrid[2 * p]     = sum_re * g_re - sum_im * g_im;
+            subgrid[2 * p + 1] = sum_re * g_im + sum_im * g_re;
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
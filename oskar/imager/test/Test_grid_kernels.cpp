@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "imager/oskar_imager.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdlib>
+
+// Generates visibilities for a set of point sources.
+static void generate_vis(int num_vis, double uv_max, oskar_Mem* uu,
+        oskar_Mem* vv, oskar_Mem* ww, oskar_Mem* vis, oskar_Mem* weight)
+{
+    int status = 0;
+    const double l[] = {0.0, 0.003, -0.005, 0.0071};
+    const double m[] = {0.0, -0.002, 0.0042, 0.0063};
+    const double flux[] = {1.0, 0.5, 0.7, 0.3};
+    oskar_mem_realloc(uu, num_vis, &status);
+    oskar_mem_realloc(vv, num_vis, &status);
+    oskar_mem_realloc(ww, num_vis, &status);
+    oskar_mem_realloc(vis, num_vis, &status);
+    oskar_mem_realloc(weight, num_vis, &status);
+    double *u_ = oskar_mem_double(uu, &status);
+    double *v_ = oskar_mem_double(vv, &status);
+    double *w_ = oskar_mem_double(ww, &status);
+    double *a_ = oskar_mem_double(vis, &status);
+    double *h_ = oskar_mem_double(weight, &status);
+    srand(1);
+    for (int i = 0; i < num_vis; ++i)
+    {
+        u_[i] = uv_max * (2.0 * rand() / (double)RAND_MAX - 1.0);
+        v_[i] = uv_max * (2.0 * rand() / (double)RAND_MAX - 1.0);
+        w_[i] = 0.0;
+        h_[i] = 1.0;
+        a_[2*i] = a_[2*i + 1] = 0.0;
+        for (int s = 0; s < 4; ++s)
+        {
+            const double phase = 2.0 * M_PI * (u_[i] * l[s] + v_[i] * m[s]);
+            a_[2*i] += flux[s] * cos(phase);
+            a_[2*i + 1] += flux[s] * sin(phase);
+        }
+    }
+}
+
+struct KernelResult
+{
+    int support, oversample, plane_size;
+    double max_error;
+};
+
+// Images the visibilities with the given kernel, and compares the whole
+// image with the reference image made using a DFT.
+static KernelResult image_with_kernel(const char* type, int support,
+        int oversample, double accuracy, int size, double fov,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* vis, const oskar_Mem* weight, const double* ref)
+{
+    KernelResult r;
+    int status = 0;
+    double norm = 0.0, ref_max = 0.0;
+    oskar_Imager* im = oskar_imager_create(OSKAR_DOUBLE, &status);
+    oskar_imager_set_fov(im, fov);
+    oskar_imager_set_size(im, size, &status);
+    oskar_imager_set_grid_kernel(im, type, support, oversample, &status);
+    oskar_imager_set_grid_kernel_accuracy(im, accuracy);
+    r.plane_size = oskar_imager_plane_size(im);
+    oskar_Mem* plane = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            r.plane_size * r.plane_size, &status);
+    oskar_mem_clear_contents(plane, &status);
+    oskar_imager_update_plane(im, oskar_mem_length(uu), uu, vv, ww, vis,
+            weight, plane, &norm, 0, &status);
+    oskar_imager_finalise_plane(im, plane, norm, &status);
+    oskar_imager_trim_image(im, plane, r.plane_size, size, &status);
+    EXPECT_EQ(0, status);
+    r.support = oskar_imager_support(im);
+    r.oversample = oskar_imager_oversample(im);
+
+    // Find the maximum error over the whole image, relative to the peak.
+    const double* p = oskar_mem_double_const(plane, &status);
+    r.max_error = 0.0;
+    for (int i = 0; i < size * size; ++i)
+    {
+        const double err = fabs(p[i] - ref[i]);
+        if (err > r.max_error) r.max_error = err;
+        if (fabs(ref[i]) > ref_max) ref_max = fabs(ref[i]);
+    }
+    r.max_error /= ref_max;
+    oskar_mem_free(plane, &status);
+    oskar_imager_free(im, &status);
+    return r;
+}
+
+TEST(imager, grid_kernels_accuracy)
+{
+    int status = 0, size = 128;
+    double fov = 2.0;
+    double cell_rad = (fov * M_PI / 180.0) / size;
+    double uv_max = 0.4 / cell_rad;
+
+    // Create visibility data.
+    oskar_Mem *uu, *vv, *ww, *vis, *weight;
+    uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, 0, &status);
+    weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    generate_vis(4000, uv_max, uu, vv, ww, vis, weight);
+
+    // Make the reference image using a DFT.
+    double norm = 0.0;
+    oskar_Imager* im = oskar_imager_create(OSKAR_DOUBLE, &status);
+    oskar_imager_set_algorithm(im, "DFT 2D", &status);
+    oskar_imager_set_fov(im, fov);
+    oskar_imager_set_size(im, size, &status);
+    oskar_Mem* ref = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            size * size, &status);
+    oskar_mem_clear_contents(ref, &status);
+    oskar_imager_update_plane(im, oskar_mem_length(uu), uu, vv, ww, vis,
+            weight, ref, &norm, 0, &status);
+    oskar_imager_finalise_plane(im, ref, norm, &status);
+    oskar_imager_free(im, &status);
+    ASSERT_EQ(0, status);
+    const double* r = oskar_mem_double_const(ref, &status);
+
+    // The spheroidal kernel does not use a padded grid.
+    KernelResult s = image_with_kernel("Spheroidal", 3, 100, 0.0,
+            size, fov, uu, vv, ww, vis, weight, r);
+    EXPECT_EQ(size, s.plane_size);
+
+    // The ES and Kaiser-Bessel kernels should meet the target accuracy
+    // over the whole image.
+    const char* types[] = {"Exp", "Kaiser"};
+    const double accuracy[] = {1e-2, 1e-3, 1e-4};
+    for (int t = 0; t < 2; ++t)
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            KernelResult k = image_with_kernel(types[t], 0, 0, accuracy[a],
+                    size, fov, uu, vv, ww, vis, weight, r);
+            EXPECT_GT(k.plane_size, size);
+            EXPECT_LT(k.max_error, accuracy[a]) << types[t] <<
+                    " kernel, target accuracy " << accuracy[a];
+
+            // A smaller kernel should be more accurate than the spheroidal.
+            if (accuracy[a] == 1e-3)
+            {
+                EXPECT_LT(k.support, s.support);
+                EXPECT_LT(k.max_error, s.max_error);
+            }
+        }
+    }
+
+    // Clean up.
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(weight, &status);
+    oskar_mem_free(ref, &status);
+}
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "imager/oskar_imager.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdlib>
+
+// Generates visibilities for a set of point sources, including the W-term.
+static void generate_vis(int num_vis, int num_sources, const double* l,
+        const double* m, const double* flux, double uv_max, double w_max,
+        oskar_Mem* uu, oskar_Mem* vv, oskar_Mem* ww, oskar_Mem* vis,
+        oskar_Mem* weight)
+{
+    int status = 0;
+    oskar_mem_realloc(uu, num_vis, &status);
+    oskar_mem_realloc(vv, num_vis, &status);
+    oskar_mem_realloc(ww, num_vis, &status);
+    oskar_mem_realloc(vis, num_vis, &status);
+    oskar_mem_realloc(weight, num_vis, &status);
+    double *u_ = oskar_mem_double(uu, &status);
+    double *v_ = oskar_mem_double(vv, &status);
+    double *w_ = oskar_mem_double(ww, &status);
+    double *a_ = oskar_mem_double(vis, &status);
+    double *h_ = oskar_mem_double(weight, &status);
+    srand(2);
+    for (int i = 0; i < num_vis; ++i)
+    {
+        u_[i] = uv_max * (2.0 * rand() / (double)RAND_MAX - 1.0);
+        v_[i] = uv_max * (2.0 * rand() / (double)RAND_MAX - 1.0);
+        w_[i] = w_max * (2.0 * rand() / (double)RAND_MAX - 1.0);
+        h_[i] = 1.0;
+        a_[2*i] = a_[2*i + 1] = 0.0;
+        for (int s = 0; s < num_sources; ++s)
+        {
+            const double n = sqrt(1.0 - l[s] * l[s] - m[s] * m[s]) - 1.0;
+            const double phase = 2.0 * M_PI *
+                    (u_[i] * l[s] + v_[i] * m[s] + w_[i] * n);
+            a_[2*i] += flux[s] * cos(phase);
+            a_[2*i + 1] += flux[s] * sin(phase);
+        }
+    }
+}
+
+// Makes an image of the visibilities using the given algorithm.
+static oskar_Mem* make_image(const char* algorithm, int size, double fov,
+        int aterm_size, const oskar_Mem* aterm, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* ww, const oskar_Mem* vis,
+        const oskar_Mem* weight, int* status)
+{
+    double norm = 0.0;
+    oskar_Imager* im = oskar_imager_create(OSKAR_DOUBLE, status);
+    oskar_imager_set_algorithm(im, algorithm, status);
+    oskar_imager_set_fov(im, fov);
+    oskar_imager_set_size(im, size, status);
+    if (aterm)
+        oskar_imager_set_idg_aterm(im, aterm_size, aterm, status);
+    oskar_Mem* plane = oskar_mem_create(oskar_imager_plane_type(im),
+            OSKAR_CPU, size * size, status);
+    oskar_mem_clear_contents(plane, status);
+    oskar_imager_update_plane(im, oskar_mem_length(uu), uu, vv, ww, vis,
+            weight, plane, &norm, 0, status);
+    oskar_imager_finalise_plane(im, plane, norm, status);
+    oskar_imager_trim_image(im, plane, size, size, status);
+    oskar_imager_free(im, status);
+    return plane;
+}
+
+// Returns the maximum difference between two images in the central half.
+static double max_error(int size, const oskar_Mem* a, const oskar_Mem* b)
+{
+    int status = 0;
+    double max_err = 0.0;
+    const double* p = oskar_mem_double_const(a, &status);
+    const double* q = oskar_mem_double_const(b, &status);
+    for (int j = size / 4; j < 3 * size / 4; ++j)
+    {
+        for (int i = size / 4; i < 3 * size / 4; ++i)
+        {
+            const double err = fabs(p[j * size + i] - q[j * size + i]);
+            if (err > max_err) max_err = err;
+        }
+    }
+    return max_err;
+}
+
+TEST(imager, idg_wide_field)
+{
+    int status = 0, size = 128;
+    const double fov = 8.0;
+    const double cell_rad = (fov * M_PI / 180.0) / size;
+    const double l[] = {0.0, 0.03, -0.025, 0.02};
+    const double m[] = {0.0, -0.02, 0.028, 0.03};
+    const double flux[] = {1.0, 0.5, 0.7, 0.3};
+
+    // Create visibility data with a large range of W.
+    oskar_Mem *uu, *vv, *ww, *vis, *weight;
+    uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, 0, &status);
+    weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    generate_vis(3000, 4, l, m, flux, 0.3 / cell_rad, 1000.0,
+            uu, vv, ww, vis, weight);
+
+    // Compare IDG and FFT images with a 3D DFT image.
+    oskar_Mem* ref = make_image("DFT 3D", size, fov, 0, 0,
+            uu, vv, ww, vis, weight, &status);
+    oskar_Mem* idg = make_image("IDG", size, fov, 0, 0,
+            uu, vv, ww, vis, weight, &status);
+    oskar_Mem* fft = make_image("FFT", size, fov, 0, 0,
+            uu, vv, ww, vis, weight, &status);
+    ASSERT_EQ(0, status);
+    const double err_idg = max_error(size, idg, ref);
+    const double err_fft = max_error(size, fft, ref);
+    EXPECT_LT(err_idg, 1e-3);
+    EXPECT_LT(err_idg, 0.1 * err_fft);
+
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(idg, &status);
+    oskar_mem_free(fft, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(weight, &status);
+}
+
+TEST(imager, idg_aterm)
+{
+    int status = 0, size = 128, aterm_size = 64;
+    const double fov = 4.0;
+    const double cell_rad = (fov * M_PI / 180.0) / size;
+    const double l[] = {0.0, 0.015, -0.012};
+    const double m[] = {0.0, -0.01, 0.014};
+    const double flux[] = {1.0, 1.0, 1.0};
+
+    // Create visibility data.
+    oskar_Mem *uu, *vv, *ww, *vis, *weight;
+    uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, 0, &status);
+    weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    generate_vis(3000, 3, l, m, flux, 0.4 / cell_rad, 0.0,
+            uu, vv, ww, vis, weight);
+
+    // Create an A-term which varies smoothly and asymmetrically.
+    oskar_Mem* aterm = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            aterm_size * aterm_size, &status);
+    double* a = oskar_mem_double(aterm, &status);
+    for (int j = 0; j < aterm_size; ++j)
+        for (int i = 0; i < aterm_size; ++i)
+            a[j * aterm_size + i] = 1.0 +
+                    0.4 * (i - aterm_size / 2) / aterm_size +
+                    0.2 * (j - aterm_size / 2) / aterm_size;
+
+    // Image with and without the A-term.
+    oskar_Mem* ref = make_image("DFT 2D", size, fov, 0, 0,
+            uu, vv, ww, vis, weight, &status);
+    oskar_Mem* idg = make_image("IDG", size, fov, aterm_size, aterm,
+            uu, vv, ww, vis, weight, &status);
+    ASSERT_EQ(0, status);
+
+    // Check the images agree near the source peaks, after scaling the
+    // reference image by the A-term at each pixel.
+    const double* r = oskar_mem_double_const(ref, &status);
+    const double* p = oskar_mem_double_const(idg, &status);
+    int num_checked = 0;
+    for (int j = 0; j < size; ++j)
+    {
+        for (int i = 0; i < size; ++i)
+        {
+            const int k = j * size + i;
+            if (r[k] < 0.5) continue;
+            const double x = (double)i * aterm_size / size;
+            const double y = (double)j * aterm_size / size;
+            const double gain = 1.0 +
+                    0.4 * (x - aterm_size / 2) / aterm_size +
+                    0.2 * (y - aterm_size / 2) / aterm_size;
+            EXPECT_NEAR(r[k] * gain, p[k], 0.01);
+            num_checked++;
+        }
+    }
+    EXPECT_GE(num_checked, 3);
+
+    oskar_mem_free(aterm, &status);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(idg, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(weight, &status);
+}
+
+TEST(imager, idg_aterm_small)
+{
+    // Use an A-term much smaller than the subgrid, so that several
+    // subgrid pixels map to each A-term pixel.
+    int status = 0, size = 128, aterm_size = 8;
+    const double fov = 4.0;
+    const double cell_rad = (fov * M_PI / 180.0) / size;
+    const double l[] = {0.0, 0.015, -0.012};
+    const double m[] = {0.0, -0.01, 0.014};
+    const double flux[] = {1.0, 1.0, 1.0};
+
+    // Create visibility data.
+    oskar_Mem *uu, *vv, *ww, *vis, *weight;
+    uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, 0, &status);
+    weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    generate_vis(3000, 3, l, m, flux, 0.4 / cell_rad, 0.0,
+            uu, vv, ww, vis, weight);
+
+    // Create a uniform A-term.
+    const double gain = 0.7;
+    oskar_Mem* aterm = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            aterm_size * aterm_size, &status);
+    oskar_mem_set_value_real(aterm, gain, 0, 0, &status);
+
+    // Every subgrid pixel, including those at the edges, must use a
+    // valid A-term pixel, so the whole image should simply be scaled.
+    oskar_Mem* ref = make_image("IDG", size, fov, 0, 0,
+            uu, vv, ww, vis, weight, &status);
+    oskar_Mem* idg = make_image("IDG", size, fov, aterm_size, aterm,
+            uu, vv, ww, vis, weight, &status);
+    ASSERT_EQ(0, status);
+    oskar_mem_scale_real(ref, gain, &status);
+    const double* r = oskar_mem_double_const(ref, &status);
+    const double* p = oskar_mem_double_const(idg, &status);
+    double max_err = 0.0;
+    for (int i = 0; i < size * size; ++i)
+    {
+        const double err = fabs(r[i] - p[i]);
+        if (err > max_err) max_err = err;
+    }
+    EXPECT_LT(max_err, 1e-10);
+
+    oskar_mem_free(aterm, &status);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(idg, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(weight, &status);
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "imager/oskar_imager.h"
+#include "utility/oskar_timer.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdio>
+#include <cstdlib>
+
+// Makes a multi-frequency synthesis image from the supplied data.
+// If a time filter is set, the imager selects and scales the coordinates
+// for each channel in turn, rather than gridding all channels at once.
+static oskar_Mem* make_mfs_image(int type, int size, int num_rows,
+        int num_channels, double freq_start_hz, double freq_inc_hz,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* vis, const oskar_Mem* weight,
+        const oskar_Mem* time_centroid, int use_time_filter,
+        double* time_sec, int* status)
+{
+    oskar_Mem* image = 0;
+    oskar_Imager* im = oskar_imager_create(type, status);
+    oskar_imager_set_fov(im, 4.0);
+    oskar_imager_set_size(im, size, status);
+    if (use_time_filter)
+    {
+        oskar_imager_set_time_min_utc(im, 1.0);
+        oskar_imager_set_time_max_utc(im, 1e6);
+    }
+    oskar_imager_set_vis_frequency(im, freq_start_hz, freq_inc_hz,
+            num_channels);
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(tmr);
+    oskar_imager_update(im, num_rows, 0, num_channels - 1, 1,
+            uu, vv, ww, vis, weight, time_centroid, status);
+    *time_sec = oskar_timer_elapsed(tmr);
+    oskar_timer_free(tmr);
+    oskar_imager_finalise(im, 1, &image, 0, 0, status);
+    oskar_imager_free(im, status);
+    return image;
+}
+
+TEST(imager, mfs_gridding)
+{
+    int status = 0, size = 256;
+    const int num_rows = 2000, num_channels = 200;
+    const double freq_start_hz = 100e6, freq_inc_hz = 100e3;
+    const double cell_rad = (4.0 * M_PI / 180.0) / size;
+    const double uv_max_m = 0.4 / cell_rad * 299792458.0 /
+            (freq_start_hz + num_channels * freq_inc_hz);
+
+    for (int prec = 0; prec < 2; ++prec)
+    {
+        const int type = prec ? OSKAR_DOUBLE : OSKAR_SINGLE;
+
+        // Create baseline coordinates in metres, and visibilities
+        // in each channel for a point source at the centre of a pixel.
+        oskar_Mem *uu, *vv, *ww, *vis, *weight, *time_centroid;
+        uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_rows, &status);
+        vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_rows, &status);
+        ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_rows, &status);
+        vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+                num_rows * num_channels, &status);
+        weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+                num_rows, &status);
+        time_centroid = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+                num_rows, &status);
+        double *u_ = oskar_mem_double(uu, &status);
+        double *v_ = oskar_mem_double(vv, &status);
+        double *w_ = oskar_mem_double(ww, &status);
+        double *a_ = oskar_mem_double(vis, &status);
+        double *h_ = oskar_mem_double(weight, &status);
+        double *t_ = oskar_mem_double(time_centroid, &status);
+        srand(3);
+        for (int r = 0; r < num_rows; ++r)
+        {
+            u_[r] = uv_max_m * (2.0 * rand() / (double)RAND_MAX - 1.0);
+            v_[r] = uv_max_m * (2.0 * rand() / (double)RAND_MAX - 1.0);
+            w_[r] = 0.0;
+            h_[r] = 1.0;
+            t_[r] = 58000.0 * 86400.0;
+            for (int c = 0; c < num_channels; ++c)
+            {
+                const double k = (freq_start_hz + c * freq_inc_hz) /
+                        299792458.0;
+                const double phase = 2.0 * M_PI * k * cell_rad *
+                        (u_[r] * 40.0 - v_[r] * 20.0);
+                a_[2 * (r * num_channels + c)]     = cos(phase);
+                a_[2 * (r * num_channels + c) + 1] = sin(phase);
+            }
+        }
+
+        // Make images by gridding all channels at once, and by selecting
+        // and scaling the coordinates for each channel.
+        double time_mfs = 0.0, time_chan = 0.0;
+        oskar_Mem* image_mfs = make_mfs_image(type, size, num_rows,
+                num_channels, freq_start_hz, freq_inc_hz, uu, vv, ww, vis,
+                weight, time_centroid, 0, &time_mfs, &status);
+        oskar_Mem* image_chan = make_mfs_image(type, size, num_rows,
+                num_channels, freq_start_hz, freq_inc_hz, uu, vv, ww, vis,
+                weight, time_centroid, 1, &time_chan, &status);
+        ASSERT_EQ(0, status);
+        printf("  %s precision: all channels %.3f s, per channel %.3f s\n",
+                prec ? "Double" : "Single", time_mfs, time_chan);
+
+        // Check the images are the same.
+        double max_diff = 0.0, peak = 0.0;
+        oskar_Mem* a = oskar_mem_convert_precision(image_mfs,
+                OSKAR_DOUBLE, &status);
+        oskar_Mem* b = oskar_mem_convert_precision(image_chan,
+                OSKAR_DOUBLE, &status);
+        const double* pa = oskar_mem_double_const(a, &status);
+        const double* pb = oskar_mem_double_const(b, &status);
+        for (int i = 0; i < size * size; ++i)
+        {
+            const double diff = fabs(pa[i] - pb[i]);
+            if (diff > max_diff) max_diff = diff;
+            if (pb[i] > peak) peak = pb[i];
+        }
+        EXPECT_NEAR(1.0, peak, 1e-3);
+        EXPECT_LT(max_diff, prec ? 1e-10 : 1e-3);
+
+        oskar_mem_free(a, &status);
+        oskar_mem_free(b, &status);
+        oskar_mem_free(image_mfs, &status);
+        oskar_mem_free(image_chan, &status);
+        oskar_mem_free(uu, &status);
+        oskar_mem_free(vv, &status);
+        oskar_mem_free(ww, &status);
+        oskar_mem_free(vis, &status);
+        oskar_mem_free(weight, &status);
+        oskar_mem_free(time_centroid, &status);
+    }
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "apps/oskar_option_parser.h"
+#include "imager/oskar_imager.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+
+struct KernelTiming
+{
+    int support, oversample, plane_size;
+    double max_error, grid_sec, fft_sec;
+};
+
+static void generate_vis(int num_vis, double uv_max, oskar_Mem* uu,
+        oskar_Mem* vv, oskar_Mem* ww, oskar_Mem* vis, oskar_Mem* weight,
+        int* status);
+static void run_kernel(const char* type, int support, int oversample,
+        double accuracy, int size, double fov, int niter,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* vis, const oskar_Mem* weight, const oskar_Mem* ref,
+        KernelTiming* r, int* status);
+static void print_row(const char* name, double accuracy,
+        const KernelTiming* r);
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_grid_kernel_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-nvis", "Number of visibilities.", 1, "20000", false);
+    opt.add_flag("-size", "Image size in pixels.", 1, "256", false);
+    opt.add_flag("-fov", "Field of view in degrees.", 1, "2.0", false);
+    opt.add_flag("-n", "Number of iterations", 1, "1", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int niter, num_vis, size, status = 0;
+    double fov_deg = 0.0;
+    opt.get("-nvis")->getInt(num_vis);
+    opt.get("-size")->getInt(size);
+    opt.get("-fov")->getDouble(fov_deg);
+    opt.get("-n")->getInt(niter);
+    if (num_vis < 1 || size < 2 || niter < 1)
+    {
+        opt.error("Number of visibilities, image size and iterations "
+                "must be positive");
+        return EXIT_FAILURE;
+    }
+
+    // Create visibility data for a few point sources.
+    const double cell_rad = (fov_deg * M_PI / 180.0) / size;
+    oskar_Mem *uu, *vv, *ww, *vis, *weight;
+    uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, 0, &status);
+    weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    generate_vis(num_vis, 0.4 / cell_rad, uu, vv, ww, vis, weight, &status);
+
+    // Make the reference image using a DFT.
+    double norm = 0.0;
+    oskar_Imager* im = oskar_imager_create(OSKAR_DOUBLE, &status);
+    oskar_imager_set_algorithm(im, "DFT 2D", &status);
+    oskar_imager_set_fov(im, fov_deg);
+    oskar_imager_set_size(im, size, &status);
+    oskar_Mem* ref = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            size * size, &status);
+    oskar_mem_clear_contents(ref, &status);
+    oskar_imager_update_plane(im, num_vis, uu, vv, ww, vis, weight,
+            ref, &norm, 0, &status);
+    oskar_imager_finalise_plane(im, ref, norm, &status);
+    oskar_imager_free(im, &status);
+
+    // Time the spheroidal kernel on the unpadded grid.
+    KernelTiming s;
+    run_kernel("Spheroidal", 3, 100, 0.0, size, fov_deg, niter,
+            uu, vv, ww, vis, weight, ref, &s, &status);
+    printf("%-12s %10s %8s %10s %6s %11s %10s %10s %10s\n", "Kernel",
+            "Target", "Support", "Oversample", "Grid", "Image error",
+            "Grid (s)", "FFT (s)", "Total (s)");
+    print_row("Spheroidal", 0.0, &s);
+
+    // For the ES and Kaiser-Bessel kernels, find the lowest accuracy that
+    // matches the image error of the spheroidal kernel, and time it with
+    // the larger padded grid.
+    const char* types[] = {"Exp", "Kaiser"};
+    for (int t = 0; t < 2 && !status; ++t)
+    {
+        for (double accuracy = 1e-1; accuracy >= 1e-7; accuracy /= 2.0)
+        {
+            KernelTiming k;
+            run_kernel(types[t], 0, 0, accuracy, size, fov_deg, niter,
+                    uu, vv, ww, vis, weight, ref, &k, &status);
+            if (status) break;
+            if (k.max_error <= s.max_error)
+            {
+                print_row(types[t], accuracy, &k);
+                break;
+            }
+        }
+    }
+
+    // Free memory.
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(weight, &status);
+    oskar_mem_free(ref, &status);
+
+    // Check for errors.
+    if (status)
+    {
+        fprintf(stderr, "ERROR: imaging failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+
+void generate_vis(int num_vis, double uv_max, oskar_Mem* uu,
+        oskar_Mem* vv, oskar_Mem* ww, oskar_Mem* vis, oskar_Mem* weight,
+        int* status)
+{
+    const double l[] = {0.0, 0.003, -0.005, 0.0071};
+    const double m[] = {0.0, -0.002, 0.0042, 0.0063};
+    const double flux[] = {1.0, 0.5, 0.7, 0.3};
+    oskar_mem_realloc(uu, num_vis, status);
+    oskar_mem_realloc(vv, num_vis, status);
+    oskar_mem_realloc(ww, num_vis, status);
+    oskar_mem_realloc(vis, num_vis, status);
+    oskar_mem_realloc(weight, num_vis, status);
+    if (*status) return;
+    double *u_ = oskar_mem_double(uu, status);
+    double *v_ = oskar_mem_double(vv, status);
+    double *w_ = oskar_mem_double(ww, status);
+    double *a_ = oskar_mem_double(vis, status);
+    double *h_ = oskar_mem_double(weight, status);
+    srand(1);
+    for (int i = 0; i < num_vis; ++i)
+    {
+        u_[i] = uv_max * (2.0 * rand() / (double)RAND_MAX - 1.0);
+        v_[i] = uv_max * (2.0 * rand() / (double)RAND_MAX - 1.0);
+        w_[i] = 0.0;
+        h_[i] = 1.0;
+        a_[2*i] = a_[2*i + 1] = 0.0;
+        for (int s = 0; s < 4; ++s)
+        {
+            const double phase = 2.0 * M_PI * (u_[i] * l[s] + v_[i] * m[s]);
+            a_[2*i] += flux[s] * cos(phase);
+            a_[2*i + 1] += flux[s] * sin(phase);
+        }
+    }
+}
+
+
+void run_kernel(const char* type, int support, int oversample,
+        double accuracy, int size, double fov, int niter,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* vis, const oskar_Mem* weight, const oskar_Mem* ref,
+        KernelTiming* r, int* status)
+{
+    double ref_max = 0.0;
+    if (*status) return;
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_Imager* im = oskar_imager_create(OSKAR_DOUBLE, status);
+    oskar_imager_set_fov(im, fov);
+    oskar_imager_set_size(im, size, status);
+    oskar_imager_set_grid_kernel(im, type, support, oversample, status);
+    oskar_imager_set_grid_kernel_accuracy(im, accuracy);
+    r->plane_size = oskar_imager_plane_size(im);
+    r->grid_sec = r->fft_sec = 0.0;
+    oskar_Mem* plane = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            r->plane_size * r->plane_size, status);
+
+    // Time gridding, and the FFT and grid correction of the padded grid.
+    for (int i = 0; i < niter && !*status; ++i)
+    {
+        double norm = 0.0;
+        oskar_mem_clear_contents(plane, status);
+        oskar_timer_start(timer);
+        oskar_imager_update_plane(im, (int) oskar_mem_length(uu),
+                uu, vv, ww, vis, weight, plane, &norm, 0, status);
+        r->grid_sec += oskar_timer_elapsed(timer);
+        oskar_timer_start(timer);
+        oskar_imager_finalise_plane(im, plane, norm, status);
+        r->fft_sec += oskar_timer_elapsed(timer);
+    }
+    r->grid_sec /= niter;
+    r->fft_sec /= niter;
+    oskar_imager_trim_image(im, plane, r->plane_size, size, status);
+    r->support = oskar_imager_support(im);
+    r->oversample = oskar_imager_oversample(im);
+
+    // Find the maximum error over the whole image, relative to the peak.
+    r->max_error = 0.0;
+    if (!*status)
+    {
+        const double* p = oskar_mem_double_const(plane, status);
+        const double* d = oskar_mem_double_const(ref, status);
+        for (int i = 0; i < size * size; ++i)
+        {
+            const double err = fabs(p[i] - d[i]);
+            if (err > r->max_error) r->max_error = err;
+            if (fabs(d[i]) > ref_max) ref_max = fabs(d[i]);
+        }
+        if (ref_max > 0.0) r->max_error /= ref_max;
+    }
+    oskar_mem_free(plane, status);
+    oskar_imager_free(im, status);
+    oskar_timer_free(timer);
+}
+
+
+void print_row(const char* name, double accuracy, const KernelTiming* r)
+{
+    printf("%-12s %10.3g %8d %10d %6d %11.3g %10.4f %10.4f %10.4f\n", name,
+            accuracy, r->support, r->oversample, r->plane_size, r->max_error,
+            r->grid_sec, r->fft_sec, r->grid_sec + r->fft_sec);
+}
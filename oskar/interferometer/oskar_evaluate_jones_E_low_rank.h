@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_EVALUATE_JONES_E_LOW_RANK_H_
+#define OSKAR_EVALUATE_JONES_E_LOW_RANK_H_
+
+/**
+ * @file oskar_evaluate_jones_E_low_rank.h
+ */
+
+#include <oskar_global.h>
+#include <telescope/oskar_telescope.h>
+#include <interferometer/oskar_jones.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns true if station beams can be evaluated using a low-rank
+ * decomposition of the element weights.
+ *
+ * @details
+ * This is possible if the telescope model is in CPU memory, and all stations
+ * are single-level aperture arrays with a single element type, a common
+ * element orientation, the same element pattern, and the same true element
+ * positions, so that their beams differ only in the element weights.
+ *
+ * @param[in] tel           Input telescope model.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+int oskar_evaluate_jones_E_low_rank_supported(const oskar_Telescope* tel,
+        int* status);
+
+/**
+ * @brief
+ * Evaluates E-Jones matrices using a low-rank decomposition of the
+ * element weight perturbations across stations.
+ *
+ * @details
+ * The beamforming weights of all stations are collected into a matrix,
+ * and the mean weights are used to evaluate a nominal array pattern.
+ * The differences from the mean are decomposed using a singular value
+ * decomposition, and the smallest number of modes is kept for which the
+ * Frobenius norm of the discarded part is no larger than \p tolerance
+ * times the Frobenius norm of the weight matrix.
+ *
+ * One extra array pattern is evaluated for each mode kept, and the beam of
+ * each station is formed as the nominal pattern plus a weighted sum of the
+ * mode patterns. The element pattern is evaluated only once.
+ * If \p tolerance is zero, all non-zero modes are kept and the result
+ * matches that of oskar_evaluate_jones_E() to rounding error.
+ *
+ * The telescope model must satisfy
+ * oskar_evaluate_jones_E_low_rank_supported(), and the direction cosines
+ * must be relative to the phase centre, with space for one more element
+ * at the end of each array.
+ *
+ * @param[out] E            Output set of Jones matrices.
+ * @param[in]  num_points   Number of direction cosines given.
+ * @param[in]  l            Relative direction cosines (x direction).
+ * @param[in]  m            Relative direction cosines (y direction).
+ * @param[in]  n            Relative direction cosines (z direction).
+ * @param[in]  tel          Input telescope model.
+ * @param[in]  gast         The Greenwich Apparent Sidereal Time, in radians.
+ * @param[in]  frequency_hz The observing frequency, in Hz.
+ * @param[in]  work         Pointer to structure holding work arrays.
+ * @param[in]  time_index   Simulation time index.
+ * @param[in]  tolerance    Relative truncation tolerance for the weights.
+ * @param[out] rank         Number of modes used (may be NULL).
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_jones_E_low_rank(oskar_Jones* E, int num_points,
+        oskar_Mem* l, oskar_Mem* m, oskar_Mem* n, const oskar_Telescope* tel,
+        double gast, double frequency_hz, oskar_StationWork* work,
+        int time_index, double tolerance, int* rank, int* status);
+
+/**
+ * @brief
+ * Returns the memory needed to evaluate E-Jones matrices using a low-rank
+ * decomposition of the element weights.
+ *
+ * @details
+ * Returns an upper bound on the number of bytes allocated by
+ * oskar_evaluate_jones_E_low_rank() for the weight matrix, its
+ * decomposition and the array pattern of each mode, assuming that all
+ * modes are kept.
+ *
+ * @param[in] tel           Input telescope model.
+ * @param[in] type          Enumerated data type of the E-Jones matrices.
+ * @param[in] num_points    Number of source directions.
+ */
+OSKAR_EXPORT
+size_t oskar_evaluate_jones_E_low_rank_memory_bytes(const oskar_Telescope* tel,
+        int type, int num_points);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_EVALUATE_JONES_E_LOW_RANK_H_ */
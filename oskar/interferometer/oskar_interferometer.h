@@ -35,6 +35,7 @@
 
 #include <oskar_global.h>
 #include <log/oskar_log.h>
+#include <interferometer/oskar_station_beam_cache.h>
 #include <sky/oskar_sky.h>
 #include <telescope/oskar_telescope.h>
 #include <vis/oskar_vis_block.h>
@@ -59,16 +60,70 @@ int oskar_interferometer_coords_only(const oskar_Interferometer* h);
 OSKAR_EXPORT
 oskar_Interferometer* oskar_interferometer_create(int precision, int* status);
 
+/**
+ * @brief Estimates the run time of the simulation without running it.
+ *
+ * @details
+ * Counts the work in the simulation (source correlations, interferometer
+ * phase, station beam and element evaluations, and the amount of data
+ * written) from the current telescope model, sky model and observation
+ * parameters, and times a single channel and time sample for a sample
+ * of up to 1024 sources on the first compute device. The measured costs
+ * are scaled to give the predicted compute time per device for each
+ * stage, which is written to the log.
+ *
+ * If sources are aggregated or predicted using the NUFFT, the correlation
+ * is also timed for an eighth of the sample, and its time per sky chunk
+ * is scaled as the fitted power of the number of sources.
+ *
+ * If oskar_interferometer_run() is called afterwards, the predicted times
+ * are compared with the measured ones in the timing summary.
+ *
+ * The simulator is initialised if necessary, but no output is written.
+ *
+ * @param[in] h            Handle to simulator.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_estimate_run_time(oskar_Interferometer* h,
+        int* status);
+
 OSKAR_EXPORT
 oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         int block_index, int* status);
 
+/**
+ * @brief Finalises the visibility block for one beam.
+ *
+ * @details
+ * This is the same as oskar_interferometer_finalise_block(), but returns
+ * the block for the given beam. Beam 0 is at the phase centre of the
+ * telescope model.
+ *
+ * @param[in] h            Handle to simulator.
+ * @param[in] beam_index   Index of the beam.
+ * @param[in] block_index  Index of the block.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+oskar_VisBlock* oskar_interferometer_finalise_beam_block(
+        oskar_Interferometer* h, int beam_index, int block_index, int* status);
+
 OSKAR_EXPORT
 void oskar_interferometer_finalise(oskar_Interferometer* h, int* status);
 
 OSKAR_EXPORT
 void oskar_interferometer_free(oskar_Interferometer* h, int* status);
 
+OSKAR_EXPORT
+int oskar_interferometer_max_sources_per_chunk(const oskar_Interferometer* h);
+
+OSKAR_EXPORT
+int oskar_interferometer_max_times_per_block(const oskar_Interferometer* h);
+
+OSKAR_EXPORT
+int oskar_interferometer_num_beams(const oskar_Interferometer* h);
+
 OSKAR_EXPORT
 int oskar_interferometer_num_devices(const oskar_Interferometer* h);
 
@@ -91,6 +146,58 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
 OSKAR_EXPORT
 void oskar_interferometer_run(oskar_Interferometer* h, int* status);
 
+/**
+ * @brief Sets additional beams to simulate in the same run.
+ *
+ * @details
+ * Each additional beam has its own phase centre, which is also used as
+ * the beam direction of every station. The sky model chunks, horizon clip
+ * and telescope model are shared by all beams, while the station beams,
+ * interferometer phase and correlation are evaluated for each beam.
+ *
+ * Beam 0 is always at the phase centre of the telescope model.
+ * The visibilities of beam i > 0 are written to output files with
+ * "_beam<i>" inserted before the file extension.
+ *
+ * Extended sources are only reprojected for each beam on the CPU.
+ *
+ * @param[in] h          Handle to simulator.
+ * @param[in] num_beams  Number of additional beams.
+ * @param[in] ra_rad     Right Ascension of each additional beam, in radians.
+ * @param[in] dec_rad    Declination of each additional beam, in radians.
+ * @param[in,out] status Status return code.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_additional_beams(oskar_Interferometer* h,
+        int num_beams, const double* ra_rad, const double* dec_rad,
+        int* status);
+
+/**
+ * @brief Sets whether short-baseline visibilities are interpolated in time.
+ *
+ * @details
+ * If enabled, cross-correlations on each baseline are evaluated directly
+ * only every few time samples within each visibility block, and the
+ * samples in between are filled by linear interpolation after stopping
+ * the fringe at the centre of the sky model.
+ *
+ * The interpolation stride of each baseline is the largest power of two
+ * for which the residual fringe phase of the most distant source changes
+ * slowly enough to keep the interpolation error below the given fraction
+ * of the source flux. Changes in the station beams are not included in
+ * this estimate.
+ *
+ * Interpolated baselines are only skipped by the correlator on CPU
+ * devices.
+ *
+ * @param[in] h          Handle to simulator.
+ * @param[in] value      If true, interpolate visibilities where possible.
+ * @param[in] tolerance  Allowed interpolation error, relative to source flux.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_baseline_interpolation(
+        oskar_Interferometer* h, int value, double tolerance);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
         int* status);
@@ -99,6 +206,23 @@ OSKAR_EXPORT
 void oskar_interferometer_set_correlation_type(oskar_Interferometer* h,
         const char* type, int* status);
 
+/**
+ * @brief
+ * Sets the CPUs to which the worker threads are bound.
+ *
+ * @details
+ * Worker thread \p i is bound to CPU \p cpu_ids[i % num_cpus].
+ * If \p num_cpus is zero, the operating system schedules the threads
+ * on any CPU. A warning is logged if the affinity cannot be set.
+ *
+ * @param[in,out] h          Handle to simulator.
+ * @param[in]     num_cpus   Number of CPU IDs in the list.
+ * @param[in]     cpu_ids    List of CPU IDs to use.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_cpu_affinity(oskar_Interferometer* h, int num_cpus,
+        const int* cpu_ids);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_force_polarised_ms(oskar_Interferometer* h,
         int value);
@@ -113,6 +237,27 @@ void oskar_interferometer_set_horizon_clip(oskar_Interferometer* h, int value);
 OSKAR_EXPORT
 void oskar_interferometer_set_log(oskar_Interferometer* h, oskar_Log* log);
 
+/**
+ * @brief Sets the maximum amount of host memory to use.
+ *
+ * @details
+ * Before the simulation starts, the memory required by the sky chunks,
+ * telescope model copies, Jones matrices, visibility blocks, station
+ * work buffers and station beam cache is estimated and written to the log.
+ *
+ * If the estimate exceeds the given limit, or the free memory on any GPU,
+ * then the number of sources per chunk and the number of times per block
+ * are reduced (whichever uses more memory first) until the estimate fits.
+ * If it cannot be made to fit, the simulation fails with
+ * OSKAR_ERR_MEMORY_ALLOC_FAILURE.
+ *
+ * @param[in] h          Handle to simulator.
+ * @param[in] value      Maximum host memory, in GB. If <= 0, there is no limit.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_max_host_memory_gb(oskar_Interferometer* h,
+        double value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_max_sources_per_chunk(oskar_Interferometer* h,
 int value);
@@ -148,14 +293,148 @@ OSKAR_EXPORT
 void oskar_interferometer_set_sky_model(oskar_Interferometer* h,
         const oskar_Sky* sky, int* status);
 
+/**
+ * @brief Sets the stations of the telescope model to simulate.
+ *
+ * @details
+ * If set, only the listed stations are copied from the telescope model,
+ * so station beams are evaluated only for these stations, and only the
+ * baselines between them are correlated and written out. Station numbers
+ * in the output refer to the position of each station in this list.
+ *
+ * This must be called before the telescope model is set.
+ * Set the number of stations to zero to use all stations.
+ *
+ * @param[in] h                Handle to simulator.
+ * @param[in] num_stations     Number of stations to use.
+ * @param[in] station_indices  Zero-based indices of stations in the model.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_station_subset(oskar_Interferometer* h,
+        int num_stations, const int* station_indices, int* status);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_telescope_model(oskar_Interferometer* h,
         const oskar_Telescope* model, int* status);
 
+/**
+ * @brief Sets whether sources are aggregated on short baselines.
+ *
+ * @details
+ * If enabled, sources are grouped into a spatial tree, and the moments
+ * of the apparent brightness in each cell are used instead of the
+ * individual sources on baselines where the error from the phase expansion
+ * is less than the given tolerance.
+ *
+ * This is only possible for CPU devices, and for telescope models with
+ * identical stations and no bandwidth or time-average smearing.
+ *
+ * @param[in] h          Handle to simulator.
+ * @param[in] value      If set, enable source aggregation.
+ * @param[in] tolerance  Maximum error relative to the flux in a cell.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_source_aggregation(oskar_Interferometer* h,
+        int value, double tolerance);
+
+/**
+ * @brief Sets whether visibilities are predicted using a non-uniform FFT.
+ *
+ * @details
+ * If enabled, cross-correlations for point sources are evaluated using
+ * a type-3 non-uniform FFT from the source direction cosines to the
+ * baseline coordinates, instead of summing over sources on each baseline.
+ * It is only used for sky chunks and times where it is expected to be
+ * faster than the direct sum.
+ *
+ * This is only possible for CPU devices, and for telescope models with
+ * identical stations and no bandwidth or time-average smearing.
+ *
+ * @param[in] h          Handle to simulator.
+ * @param[in] value      If set, enable non-uniform FFT prediction.
+ * @param[in] tolerance  Required accuracy relative to the visibility
+ *                       amplitude.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_nufft(oskar_Interferometer* h, int value,
+        double tolerance);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
         double min_jy, double max_jy);
 
+/**
+ * @brief Sets whether station beams are interpolated in time.
+ *
+ * @details
+ * If enabled, station beams are evaluated only at coarse epochs, and
+ * interpolated per source at the times in between. The epochs are spaced
+ * so that no source moves by more than the given angle relative to a
+ * station between them.
+ *
+ * The beams at each epoch are cached for each class of identical
+ * stations, and for each channel and sky chunk.
+ * This is only used for CPU devices.
+ *
+ * @param[in] h              Handle to simulator.
+ * @param[in] type           Interpolation type (OSKAR_BEAM_INTERP_NONE,
+ *                           OSKAR_BEAM_INTERP_LINEAR or
+ *                           OSKAR_BEAM_INTERP_CUBIC).
+ * @param[in] max_drift_rad  Maximum source drift between epochs, in radians.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_station_beam_interpolation(
+        oskar_Interferometer* h, int type, double max_drift_rad);
+
+/**
+ * @brief Sets whether perturbed station beams use a low-rank decomposition.
+ *
+ * @details
+ * If enabled, the element weights of all stations are decomposed into
+ * their mean and a truncated set of principal modes, so that only one
+ * array factor per retained mode needs to be evaluated, instead of one
+ * per station. The rank is chosen so that the Frobenius norm of the
+ * discarded weight deviations is no more than the given fraction of the
+ * norm of all the weights. A tolerance of zero keeps all modes.
+ *
+ * This is only used for CPU devices, and only if all stations are
+ * single-level aperture arrays with the same element positions and
+ * element pattern, differing only in their element errors.
+ *
+ * @param[in] h          Handle to simulator.
+ * @param[in] value      If true, use low-rank evaluation if possible.
+ * @param[in] tolerance  Relative error allowed in the element weights.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_station_beam_low_rank(oskar_Interferometer* h,
+        int value, double tolerance);
+
+/**
+ * @brief Sets the directory used to cache visibility contributions.
+ *
+ * @details
+ * If set, the visibility contribution from each sky chunk is stored in
+ * a binary file in the given directory, together with hashes of the
+ * telescope model, the observation parameters, the simulation settings
+ * and the sources in the chunk. A later simulation reads the stored
+ * contributions for chunks whose hashes all match, and simulates only
+ * the chunks that are new or have changed, so that a sky model can be
+ * updated without repeating the whole simulation.
+ *
+ * Sky chunks are formed from consecutive sources, so sources should be
+ * appended at the end of the sky model to keep earlier chunks unchanged.
+ * System noise is added after the contributions have been summed.
+ *
+ * This must be set before calling oskar_interferometer_check_init().
+ *
+ * @param[in] h    Handle to simulator.
+ * @param[in] dir  Path to the cache directory, or an empty string to disable.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_vis_cache_directory(oskar_Interferometer* h,
+        const char* dir);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_zero_failed_gaussians(oskar_Interferometer* h,
         int value);
@@ -167,6 +446,20 @@ OSKAR_EXPORT
 void oskar_interferometer_write_block(oskar_Interferometer* h,
         const oskar_VisBlock* block, int block_index, int* status);
 
+/**
+ * @brief Writes a finalised visibility block to the output files of a beam.
+ *
+ * @param[in] h            Handle to simulator.
+ * @param[in] beam_index   Index of the beam.
+ * @param[in] block        Visibility block to write.
+ * @param[in] block_index  Index of the block.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_write_beam_block(oskar_Interferometer* h,
+        int beam_index, const oskar_VisBlock* block, int block_index,
+        int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_STATION_BEAM_CACHE_H_
+#define OSKAR_STATION_BEAM_CACHE_H_
+
+/**
+ * @file oskar_station_beam_cache.h
+ */
+
+#include <oskar_global.h>
+#include <interferometer/oskar_jones.h>
+#include <sky/oskar_sky.h>
+#include <telescope/oskar_telescope.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_StationBeamCache;
+#ifndef OSKAR_STATION_BEAM_CACHE_TYPEDEF_
+#define OSKAR_STATION_BEAM_CACHE_TYPEDEF_
+typedef struct oskar_StationBeamCache oskar_StationBeamCache;
+#endif /* OSKAR_STATION_BEAM_CACHE_TYPEDEF_ */
+
+enum OSKAR_BEAM_INTERP_TYPE
+{
+    OSKAR_BEAM_INTERP_NONE,
+    OSKAR_BEAM_INTERP_LINEAR,
+    OSKAR_BEAM_INTERP_CUBIC
+};
+
+/**
+ * @brief
+ * Returns the number of time samples between station beam evaluations.
+ *
+ * @details
+ * Returns the largest number of time samples over which the direction
+ * of any source, as seen from a station, changes by no more than the
+ * given angle. This is used to set the interval between epochs at which
+ * the station beams are evaluated.
+ *
+ * The parallactic angle rotation is not included, as this is evaluated
+ * separately for every time sample.
+ *
+ * @param[in] max_drift_rad  Maximum source drift between epochs, in radians.
+ * @param[in] time_inc_sec   Time interval between samples, in seconds.
+ */
+OSKAR_EXPORT
+int oskar_station_beam_cache_epoch_interval(double max_drift_rad,
+        double time_inc_sec);
+
+/**
+ * @brief
+ * Creates a cache of station beams evaluated at coarse epochs.
+ *
+ * @details
+ * Stations are grouped into classes that have identical beams, and
+ * the beam of each class is cached for each sky chunk, channel and epoch,
+ * so that beams at intermediate times can be interpolated.
+ *
+ * The cache holds beams in CPU memory, and may be shared between threads.
+ * Cached beams are kept until the cache is freed, or until the number of
+ * unused entries exceeds the capacity, when the least recently used
+ * entries are replaced.
+ *
+ * @param[in] tel             Telescope model.
+ * @param[in] interp_type     Interpolation type (enumerator).
+ * @param[in] epoch_interval  Number of time samples between epochs.
+ * @param[in] capacity        Initial number of beams to hold in the cache.
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_EXPORT
+oskar_StationBeamCache* oskar_station_beam_cache_create(
+        const oskar_Telescope* tel, int interp_type, int epoch_interval,
+        int capacity, int* status);
+
+/**
+ * @brief
+ * Evaluates station beams by interpolating between cached epochs.
+ *
+ * @details
+ * Fills the E-Jones matrices for the given time sample by interpolating
+ * between station beams evaluated at the surrounding epochs.
+ * Beams for epochs that are not already in the cache are evaluated
+ * using the unclipped sky chunk, and stored.
+ *
+ * Interpolation is performed separately for each complex element, after
+ * unwrapping the phase between epochs: the amplitude and the unwrapped
+ * phase are interpolated linearly, or using a Catmull-Rom cubic spline.
+ * Elements that vanish at any of the epochs used, or whose phase changes
+ * by more than a quarter of a turn between epochs (close to a null),
+ * are interpolated as complex values instead.
+ *
+ * If the sources have been clipped, the source map gives the index of each
+ * clipped source in the chunk.
+ *
+ * @param[in] cache              The station beam cache.
+ * @param[out] E                 Output Jones matrices, in CPU memory.
+ * @param[in] num_sources        Number of sources to evaluate.
+ * @param[in] source_map         Chunk source index of each output source,
+ *                               or NULL if the chunk has not been clipped.
+ * @param[in] chunk              Unclipped sky chunk.
+ * @param[in] chunk_index        Index of the sky chunk.
+ * @param[in] channel_index      Index of the frequency channel.
+ * @param[in] frequency_hz       Frequency of the channel, in Hz.
+ * @param[in] tel                Telescope model.
+ * @param[in] time_start_mjd_utc Start time of the observation, as MJD(UTC).
+ * @param[in] time_inc_sec       Time interval between samples, in seconds.
+ * @param[in] num_time_steps     Number of time samples in the observation.
+ * @param[in] time_index         Time sample index to evaluate.
+ * @param[in] work               Station beam work arrays.
+ * @param[in,out] status         Status return code.
+ */
+OSKAR_EXPORT
+void oskar_station_beam_cache_evaluate(oskar_StationBeamCache* cache,
+        oskar_Jones* E, int num_sources, const oskar_Mem* source_map,
+        oskar_Sky* chunk, int chunk_index, int channel_index,
+        double frequency_hz, const oskar_Telescope* tel,
+        double time_start_mjd_utc, double time_inc_sec, int num_time_steps,
+        int time_index, oskar_StationWork* work, int* status);
+
+/**
+ * @brief
+ * Returns the number of station beam evaluations made by the cache.
+ *
+ * @param[in] cache  The station beam cache.
+ */
+OSKAR_EXPORT
+int oskar_station_beam_cache_num_evaluations(
+        const oskar_StationBeamCache* cache);
+
+/**
+ * @brief
+ * Frees memory held by the station beam cache.
+ *
+ * @param[in,out] cache   The station beam cache.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_station_beam_cache_free(oskar_StationBeamCache* cache,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_STATION_BEAM_CACHE_H_ */
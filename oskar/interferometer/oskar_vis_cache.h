@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_VIS_CACHE_H_
+#define OSKAR_VIS_CACHE_H_
+
+/**
+ * @file oskar_vis_cache.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+#include <sky/oskar_sky.h>
+#include <telescope/oskar_telescope.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_VisCache;
+#ifndef OSKAR_VIS_CACHE_TYPEDEF_
+#define OSKAR_VIS_CACHE_TYPEDEF_
+typedef struct oskar_VisCache oskar_VisCache;
+#endif /* OSKAR_VIS_CACHE_TYPEDEF_ */
+
+/**
+ * @brief
+ * Creates a cache of visibility contributions from each sky chunk.
+ *
+ * @details
+ * Visibilities are linear in the sky brightness, so the contribution
+ * from each sky chunk can be stored and summed with contributions from
+ * other chunks in a later simulation. The cache holds one OSKAR binary
+ * file per sky chunk in the given directory, which is created if required.
+ *
+ * Each file records hashes of the telescope model, the observation
+ * parameters and the simulation settings used to generate it, together
+ * with a hash of the sources in the chunk. Stored contributions are only
+ * used if all of these match the current simulation.
+ *
+ * Each chunk holds \p num_records records, one for each combination of
+ * time sample and beam. The cache may be shared between threads.
+ *
+ * @param[in] dir                Path to the cache directory.
+ * @param[in] num_chunks         Number of sky chunks.
+ * @param[in] num_records        Number of records in each chunk.
+ * @param[in] telescope_hash     Hash of the telescope model.
+ * @param[in] observation_hash   Hash of the observation parameters.
+ * @param[in] settings_hash      Hash of the simulation settings.
+ * @param[in,out] status         Status return code.
+ */
+OSKAR_EXPORT
+oskar_VisCache* oskar_vis_cache_create(const char* dir, int num_chunks,
+        int num_records, unsigned int telescope_hash,
+        unsigned int observation_hash, unsigned int settings_hash,
+        int* status);
+
+/**
+ * @brief
+ * Checks whether stored contributions can be used for a sky chunk.
+ *
+ * @details
+ * Compares the hashes in the file for the given chunk with those of the
+ * current simulation, and returns true if the file is complete and
+ * all hashes match. Otherwise, the contributions from the chunk must
+ * be simulated and written using oskar_vis_cache_write(), which replaces
+ * the file.
+ *
+ * This must be called for every chunk before the simulation starts.
+ *
+ * @param[in] cache        The visibility cache.
+ * @param[in] chunk_index  Index of the sky chunk.
+ * @param[in] chunk        The sky chunk, in CPU memory.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+int oskar_vis_cache_check_chunk(oskar_VisCache* cache, int chunk_index,
+        const oskar_Sky* chunk, int* status);
+
+/**
+ * @brief
+ * Returns true if stored contributions are used for a sky chunk.
+ *
+ * @param[in] cache        The visibility cache.
+ * @param[in] chunk_index  Index of the sky chunk.
+ */
+OSKAR_EXPORT
+int oskar_vis_cache_chunk_cached(const oskar_VisCache* cache,
+        int chunk_index);
+
+/**
+ * @brief
+ * Returns the number of sky chunks that use stored contributions.
+ *
+ * @param[in] cache  The visibility cache.
+ */
+OSKAR_EXPORT
+int oskar_vis_cache_num_cached(const oskar_VisCache* cache);
+
+/**
+ * @brief
+ * Reads a stored visibility contribution from a sky chunk.
+ *
+ * @details
+ * Reads the cross- and auto-correlations stored in the given record.
+ * The arrays are resized if necessary, and may be in any memory location.
+ * Either array may be NULL, if not required.
+ *
+ * @param[in] cache         The visibility cache.
+ * @param[in] chunk_index   Index of the sky chunk.
+ * @param[in] record_index  Index of the record in the chunk.
+ * @param[out] cross        Cross-correlations for the record.
+ * @param[out] autos        Auto-correlations for the record.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_cache_read(oskar_VisCache* cache, int chunk_index,
+        int record_index, oskar_Mem* cross, oskar_Mem* autos, int* status);
+
+/**
+ * @brief
+ * Stores a visibility contribution from a sky chunk.
+ *
+ * @details
+ * Writes the cross- and auto-correlations for the given record.
+ * The arrays may be in any memory location.
+ * Either array may be NULL, if not simulated.
+ *
+ * The file for the chunk is marked as complete when the cache is freed,
+ * if all its records have been written.
+ *
+ * @param[in] cache         The visibility cache.
+ * @param[in] chunk_index   Index of the sky chunk.
+ * @param[in] record_index  Index of the record in the chunk.
+ * @param[in] cross         Cross-correlations for the record.
+ * @param[in] autos         Auto-correlations for the record.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_cache_write(oskar_VisCache* cache, int chunk_index,
+        int record_index, const oskar_Mem* cross, const oskar_Mem* autos,
+        int* status);
+
+/**
+ * @brief
+ * Returns a hash of the sources in a sky model.
+ *
+ * @details
+ * Returns a CRC-32C hash of the source parameters, in CPU memory.
+ *
+ * @param[in] sky         The sky model.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+unsigned int oskar_vis_cache_hash_sky(const oskar_Sky* sky, int* status);
+
+/**
+ * @brief
+ * Returns a hash of the telescope model.
+ *
+ * @details
+ * Returns a CRC-32C hash of the telescope parameters that affect
+ * the simulated visibilities, including the station positions,
+ * the station and element data, and the smearing parameters.
+ * Numerical element patterns are identified by their file names.
+ * The measured station positions and the system noise are not included,
+ * as these are only applied after the contributions have been summed.
+ *
+ * @param[in] tel         The telescope model, in CPU memory.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+unsigned int oskar_vis_cache_hash_telescope(const oskar_Telescope* tel,
+        int* status);
+
+/**
+ * @brief
+ * Frees memory held by the visibility cache.
+ *
+ * @details
+ * Closes all files, and marks as complete those that hold all records,
+ * unless the status code is set.
+ *
+ * @param[in,out] cache   The visibility cache.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_cache_free(oskar_VisCache* cache, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_VIS_CACHE_H_ */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_VIS_INTERPOLATION_H_
+#define OSKAR_VIS_INTERPOLATION_H_
+
+/**
+ * @file oskar_vis_interpolation.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+#include <sky/oskar_sky.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns the centre and angular extent of a set of sky model chunks.
+ *
+ * @details
+ * Returns the direction cosines, relative to the given phase centre, of
+ * the flux-weighted mean direction of all sources in the sky model, and
+ * the largest chord distance on the unit sphere from there to any source.
+ *
+ * Visibilities are fringe-stopped at this centre before being
+ * interpolated, and the extent sets how quickly they can vary in time.
+ *
+ * @param[in] num_chunks  Number of sky model chunks.
+ * @param[in] chunks      Array of sky model chunks (in CPU memory).
+ * @param[in] ra0_rad     Right Ascension of the phase centre, in radians.
+ * @param[in] dec0_rad    Declination of the phase centre, in radians.
+ * @param[out] l_c        Direction cosine l of the sky centre.
+ * @param[out] m_c        Direction cosine m of the sky centre.
+ * @param[out] n_c        Direction cosine n of the sky centre.
+ * @param[out] radius     Chord distance to the furthest source.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_interpolation_sky_extent(int num_chunks,
+        oskar_Sky* const* chunks, double ra0_rad, double dec0_rad,
+        double* l_c, double* m_c, double* n_c, double* radius, int* status);
+
+/**
+ * @brief
+ * Returns the number of time samples between evaluations of each baseline.
+ *
+ * @details
+ * The maximum rate of change of the fringe-stopped phase of any source
+ * on a baseline of length |b| is 2 pi omega_E |b| r / lambda, where
+ * r is the sky extent returned by oskar_vis_interpolation_sky_extent().
+ * Linear interpolation of a unit phasor over a phase step d_phi has a
+ * maximum error of d_phi^2 / 8, so the interval is chosen to keep this
+ * below the tolerance.
+ *
+ * The stride of each baseline is a power of two, so that the baselines
+ * that must be evaluated at any time are, in practice, the longest ones.
+ *
+ * @param[in] num_stations     Number of stations.
+ * @param[in] x                Station x coordinates (ECEF offsets), in metres.
+ * @param[in] y                Station y coordinates (ECEF offsets), in metres.
+ * @param[in] z                Station z coordinates (ECEF offsets), in metres.
+ * @param[in] max_frequency_hz Highest frequency, in Hz.
+ * @param[in] radius           Sky extent (chord distance).
+ * @param[in] time_inc_sec     Time between samples, in seconds.
+ * @param[in] tolerance        Error allowed, relative to the total flux.
+ * @param[in] max_stride       Largest stride allowed.
+ * @param[out] stride          Stride for each baseline.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_interpolation_strides(int num_stations, const oskar_Mem* x,
+        const oskar_Mem* y, const oskar_Mem* z, double max_frequency_hz,
+        double radius, double time_inc_sec, double tolerance, int max_stride,
+        int* stride, int* status);
+
+/**
+ * @brief
+ * Returns true if a baseline must be evaluated at a time in a block.
+ *
+ * @details
+ * The first and last times in the block are always evaluated, as are all
+ * times that are a multiple of the baseline stride.
+ *
+ * @param[in] stride           Stride of the baseline.
+ * @param[in] time_index_block Time index within the block.
+ * @param[in] num_times_block  Number of times in the block.
+ */
+OSKAR_EXPORT
+int oskar_vis_interpolation_required(int stride, int time_index_block,
+        int num_times_block);
+
+/**
+ * @brief
+ * Fills cross-correlations that were not evaluated, by interpolation.
+ *
+ * @details
+ * For each baseline, every sample that is not required according to
+ * oskar_vis_interpolation_required() is overwritten by linear
+ * interpolation between the neighbouring required samples.
+ * The visibilities are rotated to the sky centre before interpolating,
+ * and rotated back to the phase centre afterwards.
+ *
+ * The cross-correlation array has dimensions (num_times, num_channels,
+ * num_baselines), with baseline fastest varying. The baseline coordinates
+ * have dimensions (num_times, num_baselines).
+ *
+ * @param[in,out] vis          Cross-correlations (in CPU memory).
+ * @param[in] num_times        Number of times in the block.
+ * @param[in] num_channels     Number of channels in the block.
+ * @param[in] num_baselines    Number of baselines.
+ * @param[in] stride           Stride for each baseline.
+ * @param[in] uu               Baseline u coordinates, in metres.
+ * @param[in] vv               Baseline v coordinates, in metres.
+ * @param[in] ww               Baseline w coordinates, in metres.
+ * @param[in] l_c              Direction cosine l of the sky centre.
+ * @param[in] m_c              Direction cosine m of the sky centre.
+ * @param[in] n_c              Direction cosine n of the sky centre.
+ * @param[in] freq_start_hz    Frequency of the first channel, in Hz.
+ * @param[in] freq_inc_hz      Frequency increment, in Hz.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_interpolation_fill(oskar_Mem* vis, int num_times,
+        int num_channels, int num_baselines, const int* stride,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        double l_c, double m_c, double n_c, double freq_start_hz,
+        double freq_inc_hz, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_VIS_INTERPOLATION_H_ */
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_PRIVATE_STATION_BEAM_CACHE_H_
+#define OSKAR_PRIVATE_STATION_BEAM_CACHE_H_
+
+#include <mem/oskar_mem.h>
+#include <utility/oskar_thread.h>
+
+/* States of cache entries. */
+enum OSKAR_BEAM_CACHE_STATE
+{
+    OSKAR_BEAM_CACHE_EMPTY,
+    OSKAR_BEAM_CACHE_PENDING,
+    OSKAR_BEAM_CACHE_READY
+};
+
+struct oskar_StationBeamCacheEntry
+{
+    int chunk, channel, station_class, epoch; /* Key. */
+    int state, refs;
+    unsigned long last_used;
+    oskar_Mem* beam;            /* Beam for all sources in the chunk. */
+};
+typedef struct oskar_StationBeamCacheEntry oskar_StationBeamCacheEntry;
+
+struct oskar_StationBeamCache
+{
+    int interp_type, epoch_interval;
+    int num_stations, num_classes;
+    int* station_class;         /* Class index of each station. */
+    int* class_station;         /* Representative station of each class. */
+    int num_entries, capacity, num_evaluations;
+    unsigned long counter;
+    oskar_StationBeamCacheEntry** entries; /* Entries do not move. */
+    oskar_Mutex* mutex;
+};
+
+#ifndef OSKAR_STATION_BEAM_CACHE_TYPEDEF_
+#define OSKAR_STATION_BEAM_CACHE_TYPEDEF_
+typedef struct oskar_StationBeamCache oskar_StationBeamCache;
+#endif /* OSKAR_STATION_BEAM_CACHE_TYPEDEF_ */
+
+#endif /* OSKAR_PRIVATE_STATION_BEAM_CACHE_H_ */
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_PRIVATE_VIS_CACHE_H_
+#define OSKAR_PRIVATE_VIS_CACHE_H_
+
+#include <binary/oskar_binary.h>
+#include <utility/oskar_thread.h>
+
+struct oskar_VisCacheChunk
+{
+    int cached;                 /* True if stored contributions are used. */
+    int created;                /* True if the file has been replaced. */
+    int num_written;            /* Number of records written. */
+    int num_sources;
+    unsigned int sky_hash;
+    char mode;                  /* Open mode of the file handle. */
+    oskar_Binary* file;         /* File handle, or NULL if closed. */
+};
+typedef struct oskar_VisCacheChunk oskar_VisCacheChunk;
+
+struct oskar_VisCache
+{
+    char* dir;
+    int num_chunks, num_records, num_cached, num_open;
+    unsigned int telescope_hash, observation_hash, settings_hash;
+    oskar_VisCacheChunk* chunks;
+    oskar_Mutex* mutex;         /* Serialises all file access. */
+};
+
+#ifndef OSKAR_VIS_CACHE_TYPEDEF_
+#define OSKAR_VIS_CACHE_TYPEDEF_
+typedef struct oskar_VisCache oskar_VisCache;
+#endif /* OSKAR_VIS_CACHE_TYPEDEF_ */
+
+#endif /* OSKAR_PRIVATE_VIS_CACHE_H_ */
@@ -83,7 +83,13 @@ void oskar_evaluate_jones_E(oskar_Jones* E, int num_points, int coord_type,
     }
     else
     {
-        /* Different stations. */
+        /* Different stations.
+         * Stations often still share the same element model and orientation,
+         * so share element patterns between them. If beam duplication is
+         * allowed, station locations are ignored as they are for identical
+         * stations. */
+        oskar_station_work_set_element_pattern_sharing(work, 1,
+                oskar_telescope_allow_station_beam_duplication(tel));
         for (i = 0; i < num_stations; ++i)
         {
             const oskar_Station* station;
@@ -94,6 +100,7 @@ void oskar_evaluate_jones_E(oskar_Jones* E, int num_points, int coord_type,
                     oskar_telescope_phase_centre_dec_rad(tel),
                     station, work, time_index, frequency_hz, gast, status);
         }
+        oskar_station_work_set_element_pattern_sharing(work, 0, 0);
     }
     oskar_mem_free(E_st, status);
 }
@@ -0,0 +1,623 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "interferometer/oskar_evaluate_jones_E_low_rank.h"
+#include "interferometer/oskar_jones_get_station_pointer.h"
+#include "convert/oskar_convert_relative_directions_to_enu_directions.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_dftw.h"
+#include "telescope/station/oskar_blank_below_horizon.h"
+#include "telescope/station/oskar_evaluate_beam_horizon_direction.h"
+#include "telescope/station/oskar_evaluate_element_weights.h"
+#include "telescope/station/element/oskar_element_evaluate.h"
+
+#include <float.h>
+#include <stdlib.h>
+
+#define MAX_SWEEPS 30
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static int same_beam_geometry(const oskar_Station* a, const oskar_Station* b,
+        int* status);
+static void rotate_directions(int num_points, oskar_Mem* x, oskar_Mem* y,
+        double angle_rad, int* status);
+static void jacobi_svd(int rows, int cols, double2* a, double2* v);
+static double beam_amplitude(const oskar_Mem* beam, int index, int* status);
+static int compare_descending(const void* a, const void* b);
+
+int oskar_evaluate_jones_E_low_rank_supported(const oskar_Telescope* tel,
+        int* status)
+{
+    int i, num_stations;
+    const oskar_Station* s0;
+    if (*status) return 0;
+    num_stations = oskar_telescope_num_stations(tel);
+    if (num_stations == 0 || oskar_telescope_mem_location(tel) != OSKAR_CPU)
+        return 0;
+    s0 = oskar_telescope_station_const(tel, 0);
+    if (oskar_station_type(s0) != OSKAR_STATION_TYPE_AA ||
+            oskar_station_has_child(s0) ||
+            !oskar_station_has_element(s0) ||
+            !oskar_station_enable_array_pattern(s0) ||
+            oskar_station_num_element_types(s0) != 1 ||
+            oskar_station_beam_coord_type(s0) !=
+                    OSKAR_SPHERICAL_TYPE_EQUATORIAL)
+        return 0;
+    if (!oskar_station_common_element_orientation(s0) &&
+            oskar_element_type(oskar_station_element_const(s0, 0)) !=
+                    OSKAR_ELEMENT_TYPE_ISOTROPIC)
+        return 0;
+    for (i = 1; i < num_stations; ++i)
+        if (!same_beam_geometry(s0, oskar_telescope_station_const(tel, i),
+                status))
+            return 0;
+    return 1;
+}
+
+
+size_t oskar_evaluate_jones_E_low_rank_memory_bytes(const oskar_Telescope* tel,
+        int type, int num_points)
+{
+    size_t bytes, num_stations, num_elements, cols, np, complex_size;
+    num_stations = (size_t) oskar_telescope_num_stations(tel);
+    if (num_stations == 0) return 0;
+    num_elements = (size_t) oskar_station_num_elements(
+            oskar_telescope_station_const(tel, 0));
+    cols = num_stations < num_elements ? num_stations : num_elements;
+    np = (size_t) num_points + 1;
+    complex_size = oskar_mem_element_size(oskar_type_precision(type) |
+            OSKAR_COMPLEX);
+
+    /* The weights, their mean and their decomposition. */
+    bytes = (2 * num_stations * num_elements + num_elements +
+            cols * cols + cols * num_stations) * sizeof(double2) +
+            2 * cols * sizeof(double);
+
+    /* The element pattern, the nominal and mode array patterns,
+     * and the array pattern and beam of each station in turn. */
+    bytes += np * (2 * oskar_mem_element_size(type) +
+            (cols + 2) * complex_size);
+    return bytes;
+}
+
+
+void oskar_evaluate_jones_E_low_rank(oskar_Jones* E, int num_points,
+        oskar_Mem* l, oskar_Mem* m, oskar_Mem* n, const oskar_Telescope* tel,
+        double gast, double frequency_hz, oskar_StationWork* work,
+        int time_index, double tolerance, int* rank, int* status)
+{
+    int i, j, k, p, np, num_stations, num_elements, rows, cols, r = 0;
+    int type, prec, transposed, normalise_beam;
+    double beam_x, beam_y, beam_z, wavenumber, ha0, dec0, lat, scale;
+    double rotation_rad;
+    double norm_w = 0.0, residual = 0.0;
+    double2 *w = 0, *w0 = 0, *a = 0, *v = 0, *d = 0;
+    double* sigma = 0;
+    const oskar_Station* s0;
+    oskar_Mem *x, *y, *z, *weights, *weights_error, *element, *theta, *phi;
+    oskar_Mem *beam = 0, *array = 0, *E_st = 0;
+    oskar_Mem** af = 0;
+    if (rank) *rank = 0;
+    if (*status) return;
+
+    /* Check the location of the data. */
+    if (oskar_jones_mem_location(E) != OSKAR_CPU ||
+            oskar_mem_location(l) != OSKAR_CPU ||
+            oskar_telescope_mem_location(tel) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Get dimensions. */
+    num_stations = oskar_telescope_num_stations(tel);
+    s0 = oskar_telescope_station_const(tel, 0);
+    num_elements = oskar_station_num_elements(s0);
+    type = oskar_mem_type(oskar_jones_mem(E));
+    prec = oskar_mem_precision(l);
+    wavenumber = 2.0 * M_PI * frequency_hz / 299792458.0;
+
+    /* Add the beam direction to the end of the arrays, if normalising. */
+    normalise_beam = oskar_station_normalise_final_beam(s0);
+    np = num_points + (normalise_beam ? 1 : 0);
+    if (normalise_beam)
+    {
+        if ((int)oskar_mem_length(l) < np || (int)oskar_mem_length(m) < np ||
+                (int)oskar_mem_length(n) < np)
+        {
+            *status = OSKAR_ERR_DIMENSION_MISMATCH;
+            return;
+        }
+        oskar_mem_set_element_real(l, np - 1, 0.0, status);
+        oskar_mem_set_element_real(m, np - 1, 0.0, status);
+        oskar_mem_set_element_real(n, np - 1, 1.0, status);
+    }
+
+    /* Convert to ENU directions (common to all stations). */
+    x = oskar_station_work_enu_direction_x(work);
+    y = oskar_station_work_enu_direction_y(work);
+    z = oskar_station_work_enu_direction_z(work);
+    if ((int)oskar_mem_length(x) < np) oskar_mem_realloc(x, np, status);
+    if ((int)oskar_mem_length(y) < np) oskar_mem_realloc(y, np, status);
+    if ((int)oskar_mem_length(z) < np) oskar_mem_realloc(z, np, status);
+    lat = oskar_station_lat_rad(s0);
+    ha0 = (gast + oskar_station_lon_rad(s0)) - oskar_station_beam_lon_rad(s0);
+    dec0 = oskar_station_beam_lat_rad(s0);
+    oskar_convert_relative_directions_to_enu_directions(
+            x, y, z, np, l, m, n, ha0, dec0, lat, status);
+
+    /* If the stations are rotated copies of a template, evaluate the
+     * template beam using direction cosines in the frame of the stations. */
+    rotation_rad = oskar_station_rotation_rad(s0);
+    if (rotation_rad != 0.0)
+        rotate_directions(np, x, y, -rotation_rad, status);
+
+    /* Evaluate the element pattern (common to all stations). */
+    element = oskar_mem_create(type, OSKAR_CPU, np, status);
+    theta = oskar_mem_create(prec, OSKAR_CPU, 0, status);
+    phi = oskar_mem_create(prec, OSKAR_CPU, 0, status);
+    oskar_element_evaluate(oskar_station_element_const(s0, 0), element,
+            oskar_station_element_x_alpha_eval_rad(s0, 0),
+            oskar_station_element_y_alpha_rad(s0, 0),
+            np, x, y, z, frequency_hz, theta, phi, status);
+
+    /* Collect the element weights of all stations. */
+    oskar_evaluate_beam_horizon_direction(&beam_x, &beam_y, &beam_z, s0,
+            gast, status);
+    if (rotation_rad != 0.0)
+    {
+        const double c = cos(rotation_rad), t = sin(rotation_rad);
+        const double bx = beam_x, by = beam_y;
+        beam_x = bx * c + by * t;
+        beam_y = -bx * t + by * c;
+    }
+    weights = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_elements, status);
+    weights_error = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_elements, status);
+    w = (double2*) calloc(num_stations * num_elements, sizeof(double2));
+    w0 = (double2*) calloc(num_elements, sizeof(double2));
+    if (!w || !w0)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        goto cleanup;
+    }
+    for (p = 0; p < num_stations; ++p)
+    {
+        double2* w_p = w + p * num_elements;
+        oskar_evaluate_element_weights(weights, weights_error, wavenumber,
+                oskar_telescope_station_const(tel, p), beam_x, beam_y, beam_z,
+                time_index, status);
+        if (*status) break;
+        for (j = 0; j < num_elements; ++j)
+        {
+            if (prec == OSKAR_DOUBLE)
+                w_p[j] = oskar_mem_double2_const(weights, status)[j];
+            else
+            {
+                const float2 t = oskar_mem_float2_const(weights, status)[j];
+                w_p[j].x = t.x;
+                w_p[j].y = t.y;
+            }
+            w0[j].x += w_p[j].x;
+            w0[j].y += w_p[j].y;
+            norm_w += w_p[j].x * w_p[j].x + w_p[j].y * w_p[j].y;
+        }
+    }
+
+    /* Subtract the mean weights to get the perturbations. */
+    for (j = 0; j < num_elements; ++j)
+    {
+        w0[j].x /= num_stations;
+        w0[j].y /= num_stations;
+    }
+    for (p = 0; p < num_stations; ++p)
+    {
+        for (j = 0; j < num_elements; ++j)
+        {
+            w[p * num_elements + j].x -= w0[j].x;
+            w[p * num_elements + j].y -= w0[j].y;
+        }
+    }
+
+    /* Orthogonalise the columns of the perturbation matrix (or its
+     * transpose), using the smaller dimension for the columns. */
+    transposed = (num_stations <= num_elements);
+    rows = transposed ? num_elements : num_stations;
+    cols = transposed ? num_stations : num_elements;
+    if (transposed)
+    {
+        a = w;
+        w = 0;
+    }
+    else
+    {
+        a = (double2*) malloc(rows * cols * sizeof(double2));
+        if (!a)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            goto cleanup;
+        }
+        for (p = 0; p < num_stations; ++p)
+            for (j = 0; j < num_elements; ++j)
+                a[j * rows + p] = w[p * num_elements + j];
+    }
+    v = (double2*) malloc(cols * cols * sizeof(double2));
+    sigma = (double*) malloc(2 * cols * sizeof(double));
+    if (!v || !sigma) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    if (*status) goto cleanup;
+    jacobi_svd(rows, cols, a, v);
+
+    /* Sort the singular values, and select the rank. */
+    for (k = 0; k < cols; ++k)
+    {
+        double t = 0.0;
+        for (i = 0; i < rows; ++i)
+            t += a[k * rows + i].x * a[k * rows + i].x +
+                    a[k * rows + i].y * a[k * rows + i].y;
+        sigma[2 * k] = t;
+        sigma[2 * k + 1] = (double) k;
+        residual += t;
+    }
+    qsort(sigma, cols, 2 * sizeof(double), compare_descending);
+    for (r = 0; r < cols; ++r)
+    {
+        /* Modes at the round-off level are never needed. */
+        if (residual <= tolerance * tolerance * norm_w ||
+                sigma[2 * r] <= DBL_EPSILON * DBL_EPSILON * norm_w) break;
+        residual -= sigma[2 * r];
+    }
+    if (rank) *rank = r;
+
+    /* Evaluate the nominal array pattern, and the pattern of each mode.
+     * Perturbation of station p is sum over modes k of d[k][p] * c[k]. */
+    af = (oskar_Mem**) calloc(r + 1, sizeof(oskar_Mem*));
+    d = (double2*) malloc((r > 0 ? r : 1) * num_stations * sizeof(double2));
+    if (!af || !d)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        goto cleanup;
+    }
+    for (k = 0; k <= r; ++k)
+    {
+        const int c = (k > 0) ? (int) sigma[2 * (k - 1) + 1] : 0;
+        for (j = 0; j < num_elements; ++j)
+        {
+            double2 t;
+            if (k == 0)
+                t = w0[j];
+            else if (transposed)
+                t = a[c * rows + j];
+            else
+            {
+                t.x = v[c * cols + j].x;
+                t.y = -v[c * cols + j].y;
+            }
+            if (prec == OSKAR_DOUBLE)
+                oskar_mem_double2(weights, status)[j] = t;
+            else
+            {
+                oskar_mem_float2(weights, status)[j].x = (float) t.x;
+                oskar_mem_float2(weights, status)[j].y = (float) t.y;
+            }
+        }
+        if (k > 0)
+        {
+            for (p = 0; p < num_stations; ++p)
+            {
+                double2* t = &d[(k - 1) * num_stations + p];
+                if (transposed)
+                {
+                    t->x = v[c * cols + p].x;
+                    t->y = -v[c * cols + p].y;
+                }
+                else
+                    *t = a[c * rows + p];
+            }
+        }
+        af[k] = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU, np, status);
+        oskar_dftw(num_elements, wavenumber,
+                oskar_station_element_true_x_enu_metres_const(s0),
+                oskar_station_element_true_y_enu_metres_const(s0),
+                oskar_station_element_true_z_enu_metres_const(s0),
+                weights, np, x, y,
+                (oskar_station_array_is_3d(s0) ? z : 0), 0, af[k], status);
+    }
+
+    /* Form the beam of each station. */
+    scale = oskar_station_normalise_array_pattern(s0) ?
+            1.0 / num_elements : 1.0;
+    array = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU, np, status);
+    beam = oskar_mem_create(type, OSKAR_CPU, np, status);
+    E_st = oskar_mem_create_alias(0, 0, 0, status);
+    for (p = 0; p < num_stations; ++p)
+    {
+        if (*status) break;
+        if (prec == OSKAR_DOUBLE)
+        {
+            double2* out = oskar_mem_double2(array, status);
+            const double2* in = oskar_mem_double2_const(af[0], status);
+            for (i = 0; i < np; ++i)
+                out[i] = in[i];
+            for (k = 1; k <= r; ++k)
+            {
+                const double2 c = d[(k - 1) * num_stations + p];
+                in = oskar_mem_double2_const(af[k], status);
+                for (i = 0; i < np; ++i)
+                {
+                    out[i].x += c.x * in[i].x - c.y * in[i].y;
+                    out[i].y += c.x * in[i].y + c.y * in[i].x;
+                }
+            }
+        }
+        else
+        {
+            float2* out = oskar_mem_float2(array, status);
+            const float2* in = oskar_mem_float2_const(af[0], status);
+            for (i = 0; i < np; ++i)
+                out[i] = in[i];
+            for (k = 1; k <= r; ++k)
+            {
+                const float c_x = (float) d[(k - 1) * num_stations + p].x;
+                const float c_y = (float) d[(k - 1) * num_stations + p].y;
+                in = oskar_mem_float2_const(af[k], status);
+                for (i = 0; i < np; ++i)
+                {
+                    out[i].x += c_x * in[i].x - c_y * in[i].y;
+                    out[i].y += c_x * in[i].y + c_y * in[i].x;
+                }
+            }
+        }
+        if (scale != 1.0)
+            oskar_mem_scale_real(array, scale, status);
+
+        /* Join with the element pattern, and blank below the horizon. */
+        oskar_mem_multiply(beam, element, array, np, status);
+        oskar_blank_below_horizon(np, z, beam, status);
+
+        /* Normalise to the value in the beam direction if required. */
+        if (normalise_beam)
+            oskar_mem_scale_real(beam,
+                    1.0 / beam_amplitude(beam, np - 1, status), status);
+        oskar_jones_get_station_pointer(E_st, E, p, status);
+        oskar_mem_copy_contents(E_st, beam, 0, 0, num_points, status);
+    }
+
+    /* Clean up. */
+cleanup:
+    if (af)
+        for (k = 0; k <= r; ++k)
+            oskar_mem_free(af[k], status);
+    oskar_mem_free(E_st, status);
+    oskar_mem_free(beam, status);
+    oskar_mem_free(array, status);
+    oskar_mem_free(weights, status);
+    oskar_mem_free(weights_error, status);
+    oskar_mem_free(element, status);
+    oskar_mem_free(theta, status);
+    oskar_mem_free(phi, status);
+    free(af);
+    free(a);
+    free(d);
+    free(v);
+    free(w);
+    free(w0);
+    free(sigma);
+}
+
+
+static int same_beam_geometry(const oskar_Station* a, const oskar_Station* b,
+        int* status)
+{
+    int n;
+    if (oskar_station_type(a) != oskar_station_type(b) ||
+            oskar_station_has_child(b) || !oskar_station_has_element(b) ||
+            oskar_station_lon_rad(a) != oskar_station_lon_rad(b) ||
+            oskar_station_lat_rad(a) != oskar_station_lat_rad(b) ||
+            oskar_station_rotation_rad(a) != oskar_station_rotation_rad(b) ||
+            oskar_station_beam_coord_type(a) !=
+                    oskar_station_beam_coord_type(b) ||
+            oskar_station_beam_lon_rad(a) != oskar_station_beam_lon_rad(b) ||
+            oskar_station_beam_lat_rad(a) != oskar_station_beam_lat_rad(b) ||
+            oskar_station_normalise_final_beam(a) !=
+                    oskar_station_normalise_final_beam(b) ||
+            oskar_station_normalise_array_pattern(a) !=
+                    oskar_station_normalise_array_pattern(b) ||
+            oskar_station_enable_array_pattern(a) !=
+                    oskar_station_enable_array_pattern(b) ||
+            oskar_station_array_is_3d(a) != oskar_station_array_is_3d(b) ||
+            oskar_station_num_elements(a) != oskar_station_num_elements(b) ||
+            oskar_station_num_element_types(a) !=
+                    oskar_station_num_element_types(b) ||
+            oskar_station_common_element_orientation(a) !=
+                    oskar_station_common_element_orientation(b))
+        return 0;
+    n = oskar_station_num_elements(a);
+    if (n > 0 && (oskar_station_element_x_alpha_rad(a, 0) !=
+            oskar_station_element_x_alpha_rad(b, 0) ||
+            oskar_station_element_y_alpha_rad(a, 0) !=
+            oskar_station_element_y_alpha_rad(b, 0)))
+        return 0;
+    if (oskar_mem_different(oskar_station_element_true_x_enu_metres_const(a),
+            oskar_station_element_true_x_enu_metres_const(b), n, status) ||
+            oskar_mem_different(
+            oskar_station_element_true_y_enu_metres_const(a),
+            oskar_station_element_true_y_enu_metres_const(b), n, status) ||
+            oskar_mem_different(
+            oskar_station_element_true_z_enu_metres_const(a),
+            oskar_station_element_true_z_enu_metres_const(b), n, status))
+        return 0;
+    return !oskar_element_different(oskar_station_element_const(a, 0),
+            oskar_station_element_const(b, 0), status);
+}
+
+
+/* Rotates direction cosines (x, y) in place about the zenith. */
+static void rotate_directions(int num_points, oskar_Mem* x, oskar_Mem* y,
+        double angle_rad, int* status)
+{
+    int i;
+    const double c = cos(angle_rad), t = sin(angle_rad);
+    if (*status) return;
+    if (oskar_mem_precision(x) == OSKAR_DOUBLE)
+    {
+        double *x_, *y_;
+        x_ = oskar_mem_double(x, status);
+        y_ = oskar_mem_double(y, status);
+        for (i = 0; i < num_points; ++i)
+        {
+            const double x0 = x_[i], y0 = y_[i];
+            x_[i] = x0 * c - y0 * t;
+            y_[i] = x0 * t + y0 * c;
+        }
+    }
+    else
+    {
+        float *x_, *y_;
+        x_ = oskar_mem_float(x, status);
+        y_ = oskar_mem_float(y, status);
+        for (i = 0; i < num_points; ++i)
+        {
+            const double x0 = x_[i], y0 = y_[i];
+            x_[i] = (float) (x0 * c - y0 * t);
+            y_[i] = (float) (x0 * t + y0 * c);
+        }
+    }
+}
+
+
+/* One-sided Jacobi SVD: on exit, the columns of the column-major matrix
+ * a (rows x cols) are mutually orthogonal, and a_in = a_out * v^H. */
+static void jacobi_svd(int rows, int cols, double2* a, double2* v)
+{
+    int i, j, k, sweep, rotated;
+    for (i = 0; i < cols * cols; ++i)
+        v[i].x = v[i].y = 0.0;
+    for (i = 0; i < cols; ++i)
+        v[i * cols + i].x = 1.0;
+    for (sweep = 0; sweep < MAX_SWEEPS; ++sweep)
+    {
+        rotated = 0;
+        for (i = 0; i < cols - 1; ++i)
+        {
+            for (j = i + 1; j < cols; ++j)
+            {
+                double alpha = 0.0, beta = 0.0, g, zeta, t, c, s;
+                double2 gamma, ph, *a_i, *a_j, *v_i, *v_j;
+                a_i = a + i * rows;
+                a_j = a + j * rows;
+                gamma.x = gamma.y = 0.0;
+                for (k = 0; k < rows; ++k)
+                {
+                    alpha += a_i[k].x * a_i[k].x + a_i[k].y * a_i[k].y;
+                    beta += a_j[k].x * a_j[k].x + a_j[k].y * a_j[k].y;
+                    gamma.x += a_i[k].x * a_j[k].x + a_i[k].y * a_j[k].y;
+                    gamma.y += a_i[k].x * a_j[k].y - a_i[k].y * a_j[k].x;
+                }
+                g = sqrt(gamma.x * gamma.x + gamma.y * gamma.y);
+                if (g == 0.0 || g <= DBL_EPSILON * sqrt(alpha * beta))
+                    continue;
+                rotated = 1;
+
+                /* Rotate column j to make the inner product real,
+                 * then apply a real Jacobi rotation. */
+                ph.x = gamma.x / g;
+                ph.y = -gamma.y / g;
+                zeta = (beta - alpha) / (2.0 * g);
+                t = (zeta >= 0.0 ? 1.0 : -1.0) /
+                        (fabs(zeta) + sqrt(1.0 + zeta * zeta));
+                c = 1.0 / sqrt(1.0 + t * t);
+                s = c * t;
+                for (k = 0; k < rows; ++k)
+                {
+                    const double2 p = a_i[k];
+                    double2 q;
+                    q.x = a_j[k].x * ph.x - a_j[k].y * ph.y;
+                    q.y = a_j[k].x * ph.y + a_j[k].y * ph.x;
+                    a_i[k].x = c * p.x - s * q.x;
+                    a_i[k].y = c * p.y - s * q.y;
+                    a_j[k].x = s * p.x + c * q.x;
+                    a_j[k].y = s * p.y + c * q.y;
+                }
+                v_i = v + i * cols;
+                v_j = v + j * cols;
+                for (k = 0; k < cols; ++k)
+                {
+                    const double2 p = v_i[k];
+                    double2 q;
+                    q.x = v_j[k].x * ph.x - v_j[k].y * ph.y;
+                    q.y = v_j[k].x * ph.y + v_j[k].y * ph.x;
+                    v_i[k].x = c * p.x - s * q.x;
+                    v_i[k].y = c * p.y - s * q.y;
+                    v_j[k].x = s * p.x + c * q.x;
+                    v_j[k].y = s * p.y + c * q.y;
+                }
+            }
+        }
+        if (!rotated) break;
+    }
+}
+
+
+/* Returns the amplitude used to normalise the station beam. */
+static double beam_amplitude(const oskar_Mem* beam, int index, int* status)
+{
+    double amp;
+    if (oskar_mem_is_matrix(beam))
+    {
+        double4c val;
+        val = oskar_mem_get_element_matrix(beam, index, status);
+        amp = val.a.x * val.a.x + val.a.y * val.a.y +
+                val.b.x * val.b.x + val.b.y * val.b.y +
+                val.c.x * val.c.x + val.c.y * val.c.y +
+                val.d.x * val.d.x + val.d.y * val.d.y;
+        amp = sqrt(0.5 * amp);
+    }
+    else
+    {
+        double2 val;
+        val = oskar_mem_get_element_complex(beam, index, status);
+        amp = sqrt(val.x * val.x + val.y * val.y);
+    }
+    return amp;
+}
+
+
+/* Sorts (value, index) pairs by value, largest first. */
+static int compare_descending(const void* a, const void* b)
+{
+    const double x = *((const double*)a), y = *((const double*)b);
+    return (x < y) ? 1 : ((x > y) ? -1 : 0);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -32,12 +32,22 @@
 #include "convert/oskar_convert_mjd_to_gast_fast.h"
 #include "correlate/oskar_auto_correlate.h"
 #include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_aggregate.h"
+#include "correlate/oskar_cross_correlate_nufft.h"
+#include "correlate/oskar_cross_correlate_apparent.h"
+#include "correlate/oskar_cross_correlate_gemm_omp.h"
+#include "correlate/oskar_source_tree.h"
 #include "interferometer/oskar_evaluate_jones_R.h"
 #include "interferometer/oskar_evaluate_jones_Z.h"
 #include "interferometer/oskar_evaluate_jones_E.h"
 #include "interferometer/oskar_evaluate_jones_K.h"
 #include "interferometer/oskar_jones.h"
 #include "interferometer/oskar_interferometer.h"
+#include "interferometer/oskar_evaluate_jones_E_low_rank.h"
+#include "interferometer/oskar_station_beam_cache.h"
+#include "interferometer/oskar_vis_cache.h"
+#include "interferometer/oskar_vis_interpolation.h"
+#include "binary/oskar_crc.h"
 #include "log/oskar_log.h"
 #include "sky/oskar_sky.h"
 #include "telescope/oskar_telescope.h"
@@ -69,17 +79,23 @@ extern "C" {
 struct DeviceData
 {
     /* Host memory. */
-    oskar_VisBlock* vis_block_cpu[2]; /* On host, for copy back & write. */
+    oskar_VisBlock** vis_block_cpu[2]; /* On host, for copy back & write. */
 
     /* Device memory. */
     int previous_chunk_index;
-    oskar_VisBlock* vis_block;  /* Device memory block. */
+    oskar_VisBlock** vis_block; /* Device memory block, one per beam. */
+    oskar_VisBlock** vis_chunk; /* Contribution from one chunk, if caching. */
+    oskar_Mem *cache_xc, *cache_ac; /* Cached contribution, if caching. */
     oskar_Mem *u, *v, *w;
     oskar_Sky* chunk;           /* The unmodified sky chunk being processed. */
     oskar_Sky* chunk_clip;      /* Copy of the chunk after horizon clipping. */
     oskar_Telescope* tel;       /* Telescope model, created as a copy. */
+    oskar_Telescope* beam_tel;  /* Copy used for additional beams. */
     oskar_Jones *J, *R, *E, *K, *Z;
     oskar_StationWork* station_work;
+    oskar_SourceTree* tree;     /* Source tree, if aggregating sources. */
+    oskar_Mem* source_map;      /* Chunk index of each clipped source. */
+    oskar_Mem* baseline_mask;   /* Baselines to correlate, if interpolating. */
 
     /* Timers. */
     oskar_Timer* tmr_compute;   /* Total time spent filling vis blocks. */
@@ -92,22 +108,76 @@ struct DeviceData
 };
 typedef struct DeviceData DeviceData;
 
+/* Estimated memory requirements, in bytes. */
+struct MemoryEstimate
+{
+    /* Host memory. */
+    size_t sky;       /* Sky model chunks. */
+    size_t tel;       /* Telescope model. */
+    size_t cache;     /* Station beam cache. */
+    size_t vis_host;  /* Host visibility blocks, per device. */
+
+    /* Memory per compute device (may be either CPU or GPU). */
+    size_t tel_copy;  /* Telescope model copies. */
+    size_t jones;     /* Jones matrices. */
+    size_t chunk;     /* Sky chunk buffers. */
+    size_t vis;       /* Device visibility blocks. */
+    size_t work;      /* Station beam work buffers. */
+
+    /* Memory per CPU device, if the mode is used. */
+    size_t tree;      /* Source aggregation tree and phase factors. */
+    size_t nufft;     /* Non-uniform FFT grids. */
+    size_t low_rank;  /* Low-rank station beam weights and patterns. */
+    size_t gemm;      /* Correlator tile buffers. */
+
+    /* Host memory for visibility interpolation. */
+    size_t interp;    /* True baseline coordinates, strides and masks. */
+
+    /* Totals. */
+    size_t device;    /* Memory required on each device. */
+    size_t host;      /* Memory required on the host, including CPU devices. */
+};
+typedef struct MemoryEstimate MemoryEstimate;
+
+/* Predicted compute time per device for each stage, in seconds. */
+struct RunTimeEstimate
+{
+    int valid;
+    double copy, clip, E, K, join, correlate, compute;
+};
+typedef struct RunTimeEstimate RunTimeEstimate;
+
 
 struct oskar_Interferometer
 {
     /* Settings. */
     int prec, num_devices, num_gpus, *gpu_ids, num_channels, num_time_steps;
+    int num_cpu_ids, *cpu_ids;
     int max_sources_per_chunk, max_times_per_block;
+    double max_host_memory_gb;
     int apply_horizon_clip, force_polarised_ms, zero_failed_gaussians;
-    int coords_only;
+    int coords_only, source_aggregation, nufft;
+    int beam_interp_type, beam_low_rank, vis_interp;
+    double aggregation_tolerance, beam_max_drift_rad, beam_low_rank_tolerance;
+    double nufft_tolerance;
+    double vis_interp_tolerance;
     double freq_start_hz, freq_inc_hz, time_start_mjd_utc, time_inc_sec;
     double source_min_jy, source_max_jy;
+    int num_beams, num_station_subset, *station_subset;
+    double *beam_ra_rad, *beam_dec_rad;
     char correlation_type, *vis_name, *ms_name, *settings_path;
+    char* vis_cache_dir;
 
     /* State. */
-    int init_sky, work_unit_index, status;
+    int init_sky, work_unit_index, status, use_beam_low_rank;
     oskar_Mutex* mutex;
     oskar_Barrier* barrier;
+    oskar_ThreadPool* thread_pool;
+    oskar_StationBeamCache* beam_cache;
+    oskar_VisCache* vis_cache;
+    int* interp_stride;         /* Time interpolation stride per baseline. */
+    double *interp_l, *interp_m, *interp_n; /* Sky centre, per beam. */
+    oskar_Mem *interp_uu, *interp_vv, *interp_ww; /* True baseline coords. */
 
     /* Sky model and telescope model. */
     int num_sources_total, num_sky_chunks;
@@ -116,12 +186,13 @@ struct oskar_Interferometer
 
     /* Output data and file handles. */
     oskar_Log* log;
-    oskar_VisHeader* header;
-    oskar_MeasurementSet* ms;
-    oskar_Binary* vis;
+    oskar_VisHeader** header;   /* One per beam. */
+    oskar_MeasurementSet** ms;  /* One per beam. */
+    oskar_Binary** vis;         /* One per beam. */
     oskar_Mem* temp;
     oskar_Timer* tmr_sim;   /* The total time for the simulation. */
     oskar_Timer* tmr_write; /* The time spent writing vis blocks. */
+    RunTimeEstimate estimate;
 
     /* Array of DeviceData structures, one per compute device. */
     DeviceData* d;
@@ -135,11 +206,45 @@ typedef struct oskar_Interferometer oskar_Interferometer;
 /* Private method prototypes. */
 
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
-        oskar_Sky* sky, int channel_index_block, int time_index_block,
+        oskar_Sky* sky, oskar_VisBlock* vis_block, int beam_index,
+        int chunk_index, int channel_index_block, int time_index_block,
         int time_index_simulation, int* status);
+static void read_cached_work_unit(oskar_Interferometer* h, DeviceData* d,
+        int chunk_index, int time_index_block, int time_index_simulation,
+        int* status);
+static void write_cached_work_unit(oskar_Interferometer* h, DeviceData* d,
+        int chunk_index, int time_index_block, int time_index_simulation,
+        int* status);
+static void time_row(const oskar_VisBlock* block, int cross,
+        int time_index_block, oskar_Mem* alias, int* status);
+static void set_up_vis_cache(oskar_Interferometer* h, int* status);
+static void set_beam_directions(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, int beam_index, int* status);
+static char* beam_file_name(const char* name, int beam_index);
 static void free_device_data(oskar_Interferometer* h, int* status);
+static int common_apparent_brightness(const oskar_Telescope* tel);
+static int fringe_phase_only(const oskar_Telescope* tel);
+static int can_aggregate_sources(const oskar_Interferometer* h);
+static void set_up_vis_interpolation(oskar_Interferometer* h, int* status);
+static void free_vis_interpolation(oskar_Interferometer* h);
+static int set_baseline_mask(const oskar_Interferometer* h, oskar_Mem* mask,
+        int time_index_block, int num_times_block, int* status);
 static void set_up_device_data(oskar_Interferometer* h, int* status);
+static void set_up_memory_budget(oskar_Interferometer* h, int* status);
+static void estimate_memory(const oskar_Interferometer* h, int num_src,
+        int num_times, const double nufft_range[6], MemoryEstimate* m);
+static void nufft_ranges(const oskar_Interferometer* h, double range[6],
+        int* status);
+static void memory_estimate_log(oskar_Log* log, const MemoryEstimate* m,
+        int num_gpus);
+static void rechunk_sky(oskar_Interferometer* h, int max_sources,
+        int* status);
 static void set_up_vis_header(oskar_Interferometer* h, int* status);
+static int time_sample(oskar_Interferometer* h, DeviceData* d,
+        const oskar_Sky* sample, int time_index, double gast, int num_reps,
+        oskar_Timer* tmr_tree, oskar_Timer* tmr_vis, int* status);
+static int num_leaf_elements(const oskar_Station* station);
+static void reset_device_timers(DeviceData* d);
 static void record_timing(oskar_Interferometer* h);
 static unsigned int disp_width(unsigned int value);
 static void system_mem_log(oskar_Log* log);
@@ -159,7 +264,31 @@ void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
         return;
     }
 
-    /* Create the visibility header if required. */
+    /* The first beam is always at the phase centre of the telescope model. */
+    h->beam_ra_rad[0] = oskar_telescope_phase_centre_ra_rad(h->tel);
+    h->beam_dec_rad[0] = oskar_telescope_phase_centre_dec_rad(h->tel);
+
+    /* Check that station beams can be evaluated using low-rank weights. */
+    h->use_beam_low_rank = 0;
+    if (h->beam_low_rank)
+    {
+        if (oskar_telescope_allow_station_beam_duplication(h->tel) &&
+                oskar_telescope_identical_stations(h->tel))
+            h->use_beam_low_rank = 0;
+        else if (oskar_evaluate_jones_E_low_rank_supported(h->tel, status))
+            h->use_beam_low_rank = 1;
+        else
+            oskar_log_warning(h->log, "Low-rank station beams require "
+                    "single-level aperture arrays with common element "
+                    "positions and patterns: using direct evaluation.");
+    }
+
+    /* Fit chunk and block sizes to the available memory, if required.
+     * This must be done before the visibility headers are created. */
+    if (!h->header)
+        set_up_memory_budget(h, status);
+
+    /* Create the visibility headers if required. */
     if (!h->header)
         set_up_vis_header(h, status);
 
@@ -195,8 +324,44 @@ void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
         h->init_sky = 1;
     }
 
+    /* Check that sources can be aggregated, if required. */
+    if (h->source_aggregation && !can_aggregate_sources(h))
+        oskar_log_warning(h->log, "Source aggregation requires identical "
+                "stations, a single beam and no bandwidth or time-average "
+                "smearing: using direct evaluation.");
+
+    /* Check that visibilities can be predicted using the NUFFT, if required. */
+    if (h->nufft && !fringe_phase_only(h->tel))
+        oskar_log_warning(h->log, "Non-uniform FFT prediction requires "
+                "identical stations and no bandwidth or time-average "
+                "smearing: using direct evaluation.");
+
     /* Check that each compute device has been set up. */
     set_up_device_data(h, status);
+
+    /* Work out which visibilities can be interpolated in time. */
+    if (h->vis_interp)
+        set_up_vis_interpolation(h, status);
+
+    /* Check which sky chunks have stored visibility contributions. */
+    if (h->vis_cache_dir && !h->vis_cache && !h->coords_only)
+        set_up_vis_cache(h, status);
+
+    /* Create the station beam cache if required. */
+    if (h->beam_interp_type != OSKAR_BEAM_INTERP_NONE && h->num_beams > 1)
+        oskar_log_warning(h->log, "Station beam interpolation is not "
+                "available with multiple beams: using direct evaluation.");
+    else if (h->beam_interp_type != OSKAR_BEAM_INTERP_NONE && !h->beam_cache)
+    {
+        int interval;
+        interval = oskar_station_beam_cache_epoch_interval(
+                h->beam_max_drift_rad, h->time_inc_sec);
+        h->beam_cache = oskar_station_beam_cache_create(h->tel,
+                h->beam_interp_type, interval,
+                4 * h->num_channels * (h->num_devices + 1), status);
+        oskar_log_message(h->log, 'M', 0, "Station beams evaluated "
+                "every %d time samples.", interval);
+    }
 }
 
 
@@ -216,6 +381,9 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
     h->temp      = oskar_mem_create(precision, OSKAR_CPU, 0, status);
     h->mutex     = oskar_mutex_create();
     h->barrier   = oskar_barrier_create(0);
+    h->num_beams = 1;
+    h->beam_ra_rad = (double*) calloc(1, sizeof(double));
+    h->beam_dec_rad = (double*) calloc(1, sizeof(double));
 
     /* Set sensible defaults. */
     h->max_sources_per_chunk = 16384;
@@ -229,19 +397,236 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
 }
 
 
+void oskar_interferometer_estimate_run_time(oskar_Interferometer* h,
+        int* status)
+{
+    int i, time_index, num_stations, num_baselines, num_corr = 0;
+    int num_beam_stations, num_blocks, num_copies, num_outputs = 0;
+    int num_cal = 0, num_cal_in = 0, num_small_in = 0, num_reps = 3;
+    int sub_linear;
+    double n_src, n_work, n_jones, frac = 1.0, elements = 0.0, mjd, gast;
+    double t_copy = 0., t_vis = 0., t_clip = 0., t_tree = 0., t_E = 0.;
+    double t_K = 0., t_join = 0., t_correlate = 0.;
+    double t_sample = 0., t_small = 0., t_chunks = 0., exponent = 1.0;
+    size_t real_size, vis_size, bytes;
+    oskar_StationBeamCache* cache = 0;
+    oskar_Timer *tmr_tree = 0, *tmr_vis = 0;
+    oskar_Sky* sample = 0;
+    RunTimeEstimate* e;
+    DeviceData* d;
+    const double megabyte = 1024.0 * 1024.0;
+    if (*status) return;
+
+    /* Initialise if required. */
+    oskar_interferometer_check_init(h, status);
+    if (*status) return;
+    e = &h->estimate;
+    memset(e, 0, sizeof(RunTimeEstimate));
+
+    /* Count the work. Station beams are evaluated only once if all
+     * stations are identical and duplication is allowed. */
+    num_stations = oskar_telescope_num_stations(h->tel);
+    num_baselines = oskar_telescope_num_baselines(h->tel);
+    num_blocks = oskar_interferometer_num_vis_blocks(h);
+    num_beam_stations = (oskar_telescope_allow_station_beam_duplication(
+            h->tel) && oskar_telescope_identical_stations(h->tel)) ?
+                    1 : num_stations;
+    for (i = 0; i < num_beam_stations; ++i)
+        elements += num_leaf_elements(
+                oskar_telescope_station_const(h->tel, i));
+    if (h->correlation_type != 'A') num_corr += num_baselines;
+    if (h->correlation_type != 'C') num_corr += num_stations;
+    n_src = (double) h->num_sources_total;
+    n_work = n_src * h->num_time_steps;
+    n_jones = n_work * h->num_channels * h->num_beams;
+
+    /* Count the bytes written, per output file type. */
+    real_size = oskar_mem_element_size(h->prec);
+    vis_size = 2 * real_size;
+    if (oskar_telescope_pol_mode(h->tel) == OSKAR_POL_MODE_FULL)
+        vis_size *= 4;
+    bytes = (size_t) h->num_beams * h->num_time_steps * (
+            (size_t) h->num_channels * num_corr * vis_size +
+            3 * (size_t) num_baselines * real_size);
+    if (h->vis_name) num_outputs++;
+    if (h->ms_name) num_outputs++;
+
+    /* Calibrate the kernels on the first device, using a sample of the
+     * first sky chunk at the middle of the observation. The station beam
+     * cache is detached so that it is not filled with sample data. */
+    d = &h->d[0];
+    if (h->num_gpus > 0)
+        oskar_device_set(h->gpu_ids[0], status);
+    if (h->num_sky_chunks > 0 && n_src > 0.0 && !h->coords_only)
+    {
+        cache = h->beam_cache;
+        h->beam_cache = 0;
+        tmr_tree = oskar_timer_create(OSKAR_TIMER_NATIVE);
+        tmr_vis = oskar_timer_create(h->num_gpus > 0 ?
+                OSKAR_TIMER_CUDA : OSKAR_TIMER_NATIVE);
+        sample = oskar_sky_create_copy(h->sky_chunks[0], OSKAR_CPU, status);
+        num_cal = oskar_sky_num_sources(sample);
+        if (num_cal > 1024) num_cal = 1024;
+        oskar_sky_resize(sample, num_cal, status);
+        time_index = h->num_time_steps / 2;
+        mjd = h->time_start_mjd_utc +
+                (time_index + 0.5) * h->time_inc_sec / 86400.0;
+        gast = oskar_convert_mjd_to_gast_fast(mjd);
+        oskar_vis_block_set_num_times(d->vis_block[0], 1, status);
+        num_cal_in = time_sample(h, d, sample, time_index, gast, num_reps,
+                tmr_tree, tmr_vis, status);
+        frac = (double) num_cal_in / num_cal;
+        t_copy = oskar_timer_elapsed(d->tmr_copy) / (num_reps * num_cal);
+        t_clip = oskar_timer_elapsed(d->tmr_clip) / (num_reps * num_cal);
+        t_tree = oskar_timer_elapsed(tmr_tree) / (num_reps * num_cal);
+        t_vis = oskar_timer_elapsed(tmr_vis) / num_reps;
+        t_sample = oskar_timer_elapsed(d->tmr_correlate) / num_reps;
+        if (num_cal_in > 0)
+        {
+            const double n = (double) num_reps * num_cal_in;
+            t_E = oskar_timer_elapsed(d->tmr_E) / n;
+            t_K = oskar_timer_elapsed(d->tmr_K) / n;
+            t_join = oskar_timer_elapsed(d->tmr_join) / n;
+            t_correlate = oskar_timer_elapsed(d->tmr_correlate) / n;
+        }
+
+        /* Source aggregation and the NUFFT cost less per source as the
+         * number of sources increases, so time the correlation again with
+         * an eighth of the sample, and fit a power law to the two times. */
+        sub_linear = d->tree || (h->nufft && fringe_phase_only(h->tel) &&
+                oskar_jones_mem_location(d->E) == OSKAR_CPU);
+        if (sub_linear && num_cal >= 64 && !*status)
+        {
+            oskar_sky_resize(sample, num_cal / 8, status);
+            num_small_in = time_sample(h, d, sample, time_index, gast,
+                    num_reps, tmr_tree, tmr_vis, status);
+            t_small = oskar_timer_elapsed(d->tmr_correlate) / num_reps;
+            if (num_small_in > 0 && num_small_in < num_cal_in &&
+                    t_small > 0.0 && t_sample > 0.0)
+            {
+                exponent = log(t_sample / t_small) /
+                        log((double) num_cal_in / num_small_in);
+                if (exponent < 0.0) exponent = 0.0;
+                if (exponent > 1.0) exponent = 1.0;
+            }
+        }
+
+        /* Restore the simulator state. */
+        h->beam_cache = cache;
+        d->previous_chunk_index = -1;
+        reset_device_timers(d);
+        oskar_vis_block_clear(d->vis_block[0], status);
+        oskar_vis_block_clear(d->vis_block_cpu[0][0], status);
+        oskar_sky_free(sample, status);
+        oskar_timer_free(tmr_tree);
+        oskar_timer_free(tmr_vis);
+    }
+    if (*status) return;
+
+    /* Scale the calibrated costs to the whole simulation. Work units are
+     * shared between devices, but each device copies back every block.
+     * A chunk is copied by up to one device per time in the block. */
+    num_copies = h->num_devices < h->max_times_per_block ?
+            h->num_devices : h->max_times_per_block;
+    e->copy = (t_copy * n_src * num_blocks * num_copies) / h->num_devices +
+            t_vis * num_blocks;
+    e->clip = (t_clip * n_work) / h->num_devices;
+    e->E = (t_E * frac * n_jones) / h->num_devices;
+    e->K = (t_K * frac * n_jones) / h->num_devices;
+    e->join = (t_join * frac * n_jones) / h->num_devices;
+    if (num_cal_in > 0)
+    {
+        /* The correlation time of each chunk scales as a power of the
+         * number of sources above the horizon (linearly, unless fitted). */
+        for (i = 0; i < h->num_sky_chunks; ++i)
+        {
+            const double n = frac * oskar_sky_num_sources(h->sky_chunks[i]);
+            if (n > 0.0)
+                t_chunks += t_sample * pow(n / num_cal_in, exponent);
+        }
+    }
+    e->correlate = (t_chunks * h->num_time_steps * h->num_channels *
+            h->num_beams + t_tree * n_work) / h->num_devices;
+    e->compute = e->copy + e->clip + e->E + e->K + e->join + e->correlate;
+    e->valid = 1;
+
+    /* Record the estimate. */
+    if (!h->log) return;
+    oskar_log_set_value_width(h->log, 25);
+    oskar_log_section(h->log, 'M', "Run time estimate");
+    oskar_log_message(h->log, 'M', 0, "Work to do:");
+    oskar_log_value(h->log, 'M', 1, "Sources", "%d", h->num_sources_total);
+    oskar_log_value(h->log, 'M', 1, "Baselines", "%d", num_baselines);
+    oskar_log_value(h->log, 'M', 1, "Channels", "%d", h->num_channels);
+    oskar_log_value(h->log, 'M', 1, "Times", "%d", h->num_time_steps);
+    oskar_log_value(h->log, 'M', 1, "Beams", "%d", h->num_beams);
+    oskar_log_value(h->log, 'M', 1, "Correlations", "%.3e",
+            n_jones * num_baselines);
+    oskar_log_value(h->log, 'M', 1, "Phase factors", "%.3e",
+            n_jones * num_stations);
+    oskar_log_value(h->log, 'M', 1, "Station beams", "%.3e",
+            n_jones * num_beam_stations);
+    oskar_log_value(h->log, 'M', 1, "Element terms", "%.3e",
+            n_jones * elements);
+    oskar_log_value(h->log, 'M', 1, "Data written", "%.1f MB",
+            num_outputs * bytes / megabyte);
+    if (num_cal > 0)
+    {
+        oskar_log_message(h->log, 'M', 0, "Calibration (%d sources, "
+                "%d above horizon, %d repeats):", num_cal, num_cal_in,
+                num_reps);
+        oskar_log_value(h->log, 'M', 1, "Jones E", "%.3e s/source", t_E);
+        oskar_log_value(h->log, 'M', 1, "Jones K", "%.3e s/source", t_K);
+        oskar_log_value(h->log, 'M', 1, "Jones correlate", "%.3e s/source",
+                t_correlate);
+        if (num_small_in > 0)
+            oskar_log_value(h->log, 'M', 1, "Correlate scaling",
+                    "sources^%.2f (from %d and %d sources)", exponent,
+                    num_small_in, num_cal_in);
+    }
+    oskar_log_message(h->log, 'M', 0, "Predicted compute time per device:");
+    oskar_log_value(h->log, 'M', 1, "Copy", "%.3f s", e->copy);
+    oskar_log_value(h->log, 'M', 1, "Horizon clip", "%.3f s", e->clip);
+    oskar_log_value(h->log, 'M', 1, "Jones E", "%.3f s", e->E);
+    oskar_log_value(h->log, 'M', 1, "Jones K", "%.3f s", e->K);
+    oskar_log_value(h->log, 'M', 1, "Jones join", "%.3f s", e->join);
+    oskar_log_value(h->log, 'M', 1, "Jones correlate", "%.3f s",
+            e->correlate);
+    oskar_log_value(h->log, 'M', 1, "Total", "%.3f s", e->compute);
+    if (cache)
+        oskar_log_warning(h->log, "Station beam interpolation is not "
+                "modelled: the Jones E time is an upper bound.");
+    if (h->interp_stride)
+        oskar_log_warning(h->log, "Baseline time interpolation is not "
+                "modelled: the correlation time is an upper bound.");
+}
+
+
 oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         int block_index, int* status)
+{
+    return oskar_interferometer_finalise_beam_block(h, 0, block_index, status);
+}
+
+
+oskar_VisBlock* oskar_interferometer_finalise_beam_block(
+        oskar_Interferometer* h, int beam_index, int block_index, int* status)
 {
     int i, i_active;
     oskar_VisBlock *b0 = 0, *b = 0;
     if (*status) return 0;
+    if (beam_index < 0 || beam_index >= h->num_beams)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return 0;
+    }
 
     /* The visibilities must be copied back
      * at the end of the block simulation. */
 
     /* Combine all vis blocks into the first one. */
     i_active = (block_index + 1) % 2;
-    b0 = h->d[0].vis_block_cpu[!i_active];
+    b0 = h->d[0].vis_block_cpu[!i_active][beam_index];
     if (!h->coords_only)
     {
         oskar_Mem *xc0 = 0, *ac0 = 0;
@@ -249,7 +634,7 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         ac0 = oskar_vis_block_auto_correlations(b0);
         for (i = 1; i < h->num_devices; ++i)
         {
-            b = h->d[i].vis_block_cpu[!i_active];
+            b = h->d[i].vis_block_cpu[!i_active][beam_index];
             if (oskar_vis_block_has_cross_correlations(b))
                 oskar_mem_add(xc0, xc0, oskar_vis_block_cross_correlations(b),
                         oskar_mem_length(xc0), status);
@@ -259,6 +644,34 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         }
     }
 
+    /* Interpolate visibilities on short baselines between computed times.
+     * This must use the true station positions, as in the simulation. */
+    if (h->interp_stride && !h->coords_only &&
+            oskar_vis_block_has_cross_correlations(b0))
+    {
+        const int num_stations = oskar_telescope_num_stations(h->tel);
+        const int num_times = oskar_vis_block_num_times(b0);
+        const int num_baselines = oskar_telescope_num_baselines(h->tel);
+        const oskar_Mem *x, *y, *z;
+        x = oskar_telescope_station_true_x_offset_ecef_metres_const(h->tel);
+        y = oskar_telescope_station_true_y_offset_ecef_metres_const(h->tel);
+        z = oskar_telescope_station_true_z_offset_ecef_metres_const(h->tel);
+        oskar_mem_realloc(h->interp_uu, num_times * num_baselines, status);
+        oskar_mem_realloc(h->interp_vv, num_times * num_baselines, status);
+        oskar_mem_realloc(h->interp_ww, num_times * num_baselines, status);
+        oskar_convert_ecef_to_baseline_uvw(num_stations, x, y, z,
+                h->beam_ra_rad[beam_index], h->beam_dec_rad[beam_index],
+                num_times, h->time_start_mjd_utc, h->time_inc_sec / 86400.0,
+                oskar_vis_block_start_time_index(b0), h->interp_uu,
+                h->interp_vv, h->interp_ww, h->temp, status);
+        oskar_vis_interpolation_fill(oskar_vis_block_cross_correlations(b0),
+                num_times, oskar_vis_block_num_channels(b0), num_baselines,
+                h->interp_stride, h->interp_uu, h->interp_vv, h->interp_ww,
+                h->interp_l[beam_index], h->interp_m[beam_index],
+                h->interp_n[beam_index], h->freq_start_hz, h->freq_inc_hz,
+                status);
+    }
+
     /* Calculate baseline uvw coordinates for the block. */
     if (oskar_vis_block_has_cross_correlations(b0))
     {
@@ -268,11 +681,10 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         z = oskar_telescope_station_measured_z_offset_ecef_metres_const(h->tel);
         oskar_convert_ecef_to_baseline_uvw(
                 oskar_telescope_num_stations(h->tel), x, y, z,
-                oskar_telescope_phase_centre_ra_rad(h->tel),
-                oskar_telescope_phase_centre_dec_rad(h->tel),
+                h->beam_ra_rad[beam_index], h->beam_dec_rad[beam_index],
                 oskar_vis_block_num_times(b0),
-                oskar_vis_header_time_start_mjd_utc(h->header),
-                oskar_vis_header_time_inc_sec(h->header) / 86400.0,
+                oskar_vis_header_time_start_mjd_utc(h->header[beam_index]),
+                oskar_vis_header_time_inc_sec(h->header[beam_index]) / 86400.0,
                 oskar_vis_block_start_time_index(b0),
                 oskar_vis_block_baseline_uu_metres(b0),
                 oskar_vis_block_baseline_vv_metres(b0),
@@ -282,7 +694,7 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
     /* Add uncorrelated system noise to the combined visibilities. */
     if (!h->coords_only)
     {
-        oskar_vis_block_add_system_noise(b0, h->header, h->tel,
+        oskar_vis_block_add_system_noise(b0, h->header[beam_index], h->tel,
                 block_index, h->temp, status);
     }
 
@@ -301,6 +713,7 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
 {
     int i;
     if (!h) return;
+    oskar_thread_pool_free(h->thread_pool);
     oskar_interferometer_reset_cache(h, status);
     for (i = 0; i < h->num_gpus; ++i)
     {
@@ -316,15 +729,38 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
     oskar_mutex_free(h->mutex);
     oskar_barrier_free(h->barrier);
     free(h->sky_chunks);
+    free(h->beam_ra_rad);
+    free(h->beam_dec_rad);
+    free(h->station_subset);
     free(h->gpu_ids);
+    free(h->cpu_ids);
     free(h->vis_name);
     free(h->ms_name);
     free(h->settings_path);
+    free(h->vis_cache_dir);
     free(h->d);
     free(h);
 }
 
 
+int oskar_interferometer_max_sources_per_chunk(const oskar_Interferometer* h)
+{
+    return h->max_sources_per_chunk;
+}
+
+
+int oskar_interferometer_max_times_per_block(const oskar_Interferometer* h)
+{
+    return h->max_times_per_block;
+}
+
+
+int oskar_interferometer_num_beams(const oskar_Interferometer* h)
+{
+    return h ? h->num_beams : 0;
+}
+
+
 int oskar_interferometer_num_devices(const oskar_Interferometer* h)
 {
     return h ? h->num_devices : 0;
@@ -346,12 +782,25 @@ int oskar_interferometer_num_vis_blocks(const oskar_Interferometer* h)
 
 void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status)
 {
+    int i;
     free_device_data(h, status);
-    oskar_binary_free(h->vis);
-    oskar_vis_header_free(h->header, status);
+    oskar_station_beam_cache_free(h->beam_cache, status);
+    h->beam_cache = 0;
+    oskar_vis_cache_free(h->vis_cache, status);
+    h->vis_cache = 0;
+    h->estimate.valid = 0;
+    free_vis_interpolation(h);
+    for (i = 0; h->header && i < h->num_beams; ++i)
+    {
+        oskar_binary_free(h->vis[i]);
+        oskar_vis_header_free(h->header[i], status);
 #ifndef OSKAR_NO_MS
-    oskar_ms_close(h->ms);
+        oskar_ms_close(h->ms[i]);
 #endif
+    }
+    free(h->vis);
+    free(h->header);
+    free(h->ms);
     h->vis = 0;
     h->header = 0;
     h->ms = 0;
@@ -368,7 +817,7 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         int device_id, int* status)
 {
     double obs_start_mjd, dt_dump_days;
-    int i_active, time_index_start, time_index_end;
+    int i_beam, i_active, time_index_start, time_index_end;
     int num_channels, num_times_block, total_chunks, total_times;
     DeviceData* d;
     if (*status) return;
@@ -387,11 +836,16 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
     if (device_id >= 0 && device_id < h->num_gpus)
         oskar_device_set(h->gpu_ids[device_id], status);
 
-    /* Clear the visibility block. */
+    /* Clear the visibility blocks. */
     i_active = block_index % 2; /* Index of the active buffer. */
     d = &(h->d[device_id]);
     oskar_timer_resume(d->tmr_compute);
-    oskar_vis_block_clear(d->vis_block, status);
+    for (i_beam = 0; i_beam < h->num_beams; ++i_beam)
+    {
+        oskar_vis_block_clear(d->vis_block[i_beam], status);
+        if (d->vis_chunk)
+            oskar_vis_block_clear(d->vis_chunk[i_beam], status);
+    }
 
     /* Set the visibility block meta-data. */
     total_chunks = h->num_sky_chunks;
@@ -406,8 +860,16 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
     num_times_block = 1 + time_index_end - time_index_start;
 
     /* Set the number of active times in the block. */
-    oskar_vis_block_set_num_times(d->vis_block, num_times_block, status);
-    oskar_vis_block_set_start_time_index(d->vis_block, time_index_start);
+    for (i_beam = 0; i_beam < h->num_beams; ++i_beam)
+    {
+        oskar_vis_block_set_num_times(d->vis_block[i_beam],
+                num_times_block, status);
+        oskar_vis_block_set_start_time_index(d->vis_block[i_beam],
+                time_index_start);
+        if (d->vis_chunk)
+            oskar_vis_block_set_num_times(d->vis_chunk[i_beam],
+                    num_times_block, status);
+    }
 
     /* Go though all possible work units in the block. A work unit is defined
      * as the simulation for one time and one sky chunk. */
@@ -426,6 +888,25 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         i_time       = i_work_unit - i_chunk * num_times_block;
         sim_time_idx = time_index_start + i_time;
 
+        /* Add the stored contribution from the chunk, if it is cached. */
+        if (h->vis_cache && oskar_vis_cache_chunk_cached(h->vis_cache, i_chunk))
+        {
+            if (h->log)
+            {
+                oskar_mutex_lock(h->mutex);
+                oskar_log_message(h->log, 'S', 1, "Time %*i/%i, "
+                        "Chunk %*i/%i [Device %i, cached]",
+                        disp_width(total_times), sim_time_idx + 1,
+                        total_times, disp_width(total_chunks),
+                        i_chunk + 1, total_chunks, device_id);
+                oskar_mutex_unlock(h->mutex);
+            }
+            oskar_timer_resume(d->tmr_copy);
+            read_cached_work_unit(h, d, i_chunk, i_time, sim_time_idx, status);
+            oskar_timer_pause(d->tmr_copy);
+            continue;
+        }
+
         /* Copy sky chunk to device only if different from the previous one. */
         if (i_chunk != d->previous_chunk_index)
         {
@@ -445,31 +926,95 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
             oskar_sky_horizon_clip(d->chunk_clip, d->chunk, d->tel, gast,
                     d->station_work, status);
             oskar_timer_pause(d->tmr_clip);
+
+            /* Record the chunk index of each source above the horizon,
+             * for interpolated station beams. */
+            if (h->beam_cache && oskar_sky_mem_location(sky) == OSKAR_CPU)
+            {
+                int i, j, num_in;
+                const int* mask;
+                int* map;
+                num_in = oskar_sky_num_sources(d->chunk);
+                if ((int)oskar_mem_length(d->source_map) < num_in)
+                    oskar_mem_realloc(d->source_map, num_in, status);
+                mask = oskar_mem_int_const(
+                        oskar_station_work_horizon_mask(d->station_work),
+                        status);
+                map = oskar_mem_int(d->source_map, status);
+                for (i = 0, j = 0; i < num_in; ++i)
+                    if (mask[i]) map[j++] = i;
+            }
         }
 
-        /* Simulate all baselines for all channels for this time and chunk. */
+        /* Group sources into a spatial tree if aggregating sources. */
+        if (d->tree && (h->apply_horizon_clip ||
+                i_chunk != d->previous_chunk_index))
+        {
+            oskar_timer_resume(d->tmr_correlate);
+            oskar_source_tree_build(d->tree, oskar_sky_num_sources(sky),
+                    oskar_sky_l_const(sky), oskar_sky_m_const(sky),
+                    oskar_sky_n_const(sky), status);
+            oskar_timer_pause(d->tmr_correlate);
+        }
+
+        /* Simulate all baselines for all channels for this time and chunk,
+         * for each beam. The sky chunk and horizon clip are shared, as are
+         * the element patterns for each channel, since the source directions
+         * are only re-expressed relative to each beam.
+         * If caching, the contribution from the chunk is kept separately. */
         for (i_channel = 0; i_channel < num_channels; ++i_channel)
         {
-            if (*status) break;
-            if (h->log)
+            if (h->num_beams > 1)
+                oskar_station_work_set_element_pattern_sharing_between_beams(
+                        d->station_work, 1,
+                        oskar_telescope_allow_station_beam_duplication(
+                                d->tel));
+            for (i_beam = 0; i_beam < h->num_beams; ++i_beam)
             {
-                oskar_mutex_lock(h->mutex);
-                oskar_log_message(h->log, 'S', 1, "Time %*i/%i, "
-                        "Chunk %*i/%i, Channel %*i/%i [Device %i, %i sources]",
-                        disp_width(total_times), sim_time_idx + 1, total_times,
-                        disp_width(total_chunks), i_chunk + 1, total_chunks,
-                        disp_width(num_channels), i_channel + 1, num_channels,
-                        device_id, oskar_sky_num_sources(sky));
-                oskar_mutex_unlock(h->mutex);
+                oskar_VisBlock* vis_block;
+                if (*status) break;
+                vis_block = d->vis_chunk ?
+                        d->vis_chunk[i_beam] : d->vis_block[i_beam];
+                if (h->num_beams > 1)
+                    set_beam_directions(h, d, sky, i_beam, status);
+                if (h->log)
+                {
+                    oskar_mutex_lock(h->mutex);
+                    oskar_log_message(h->log, 'S', 1, "Time %*i/%i, "
+                            "Chunk %*i/%i, Channel %*i/%i "
+                            "[Device %i, %i sources]",
+                            disp_width(total_times), sim_time_idx + 1,
+                            total_times, disp_width(total_chunks),
+                            i_chunk + 1, total_chunks,
+                            disp_width(num_channels), i_channel + 1,
+                            num_channels, device_id,
+                            oskar_sky_num_sources(sky));
+                    oskar_mutex_unlock(h->mutex);
+                }
+                sim_baselines(h, d, sky, vis_block, i_beam, i_chunk,
+                        i_channel, i_time, sim_time_idx, status);
             }
-            sim_baselines(h, d, sky, i_channel, i_time, sim_time_idx, status);
         }
+        if (h->num_beams > 1)
+            oskar_station_work_set_element_pattern_sharing_between_beams(
+                    d->station_work, 0, 0);
         d->previous_chunk_index = i_chunk;
+
+        /* Store the contribution from the chunk, and add it to the block. */
+        if (d->vis_chunk)
+        {
+            oskar_timer_resume(d->tmr_copy);
+            write_cached_work_unit(h, d, i_chunk, i_time, sim_time_idx,
+                    status);
+            oskar_timer_pause(d->tmr_copy);
+        }
     }
 
-    /* Copy the visibility block to host memory. */
+    /* Copy the visibility blocks to host memory. */
     oskar_timer_resume(d->tmr_copy);
-    oskar_vis_block_copy(d->vis_block_cpu[i_active], d->vis_block, status);
+    for (i_beam = 0; i_beam < h->num_beams; ++i_beam)
+        oskar_vis_block_copy(d->vis_block_cpu[i_active][i_beam],
+                d->vis_block[i_beam], status);
     oskar_timer_pause(d->tmr_copy);
     oskar_timer_pause(d->tmr_compute);
 }
@@ -520,9 +1065,15 @@ static void* run_blocks(void* arg)
             oskar_interferometer_run_block(h, b, device_id, status);
         if (thread_id == 0 && b > 0)
         {
-            oskar_VisBlock* block;
-            block = oskar_interferometer_finalise_block(h, b - 1, status);
-            oskar_interferometer_write_block(h, block, b - 1, status);
+            int i_beam;
+            for (i_beam = 0; i_beam < h->num_beams; ++i_beam)
+            {
+                oskar_VisBlock* block;
+                block = oskar_interferometer_finalise_beam_block(h, i_beam,
+                        b - 1, status);
+                oskar_interferometer_write_beam_block(h, i_beam, block,
+                        b - 1, status);
+            }
         }
 
         /* Barrier 1: Reset work unit index and print status. */
@@ -546,8 +1097,7 @@ static void* run_blocks(void* arg)
 
 void oskar_interferometer_run(oskar_Interferometer* h, int* status)
 {
-    int i, num_threads;
-    oskar_Thread** threads = 0;
+    int i, num_threads, submit_error = 0;
     ThreadArgs* args = 0;
     if (*status || !h) return;
 
@@ -574,7 +1124,20 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
     /* Set up worker threads. */
     num_threads = h->num_devices + 1;
     oskar_barrier_set_num_threads(h->barrier, num_threads);
-    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+    if (oskar_thread_pool_num_threads(h->thread_pool) != num_threads)
+    {
+        oskar_thread_pool_free(h->thread_pool);
+        h->thread_pool = oskar_thread_pool_create(num_threads);
+        if (h->num_cpu_ids > 0 && oskar_thread_pool_set_affinity(
+                h->thread_pool, h->num_cpu_ids, h->cpu_ids))
+            oskar_log_warning(h->log,
+                    "Unable to set the CPU affinity of worker threads.");
+    }
+    if (!h->thread_pool)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
     args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
     for (i = 0; i < num_threads; ++i)
     {
@@ -604,19 +1167,18 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
     /* Start the worker threads. */
     oskar_interferometer_reset_work_unit_index(h);
     for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+        if (oskar_thread_pool_submit(h->thread_pool, run_blocks,
+                (void*)&args[i]))
+            submit_error = 1;
 
     /* Wait for worker threads to finish. */
-    for (i = 0; i < num_threads; ++i)
-    {
-        oskar_thread_join(threads[i]);
-        oskar_thread_free(threads[i]);
-    }
-    free(threads);
+    oskar_thread_pool_wait(h->thread_pool);
     free(args);
 
     /* Get status code. */
     *status = h->status;
+    if (!*status && submit_error)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
 
     /* Record memory usage. */
     if (h->log && !*status)
@@ -664,22 +1226,39 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
         record_timing(h);
         oskar_log_section(h->log, 'M', "Simulation complete");
         oskar_log_message(h->log, 'M', 0, "Output(s):");
-        if (h->vis_name)
-            oskar_log_value(h->log, 'M', 1,
-                    "OSKAR binary file", "%s", h->vis_name);
-        if (h->ms_name)
-            oskar_log_value(h->log, 'M', 1,
-                    "Measurement Set", "%s", h->ms_name);
+        for (i = 0; i < h->num_beams; ++i)
+        {
+            char* name;
+            if (h->vis_name)
+            {
+                name = beam_file_name(h->vis_name, i);
+                oskar_log_value(h->log, 'M', 1,
+                        "OSKAR binary file", "%s", name);
+                free(name);
+            }
+            if (h->ms_name)
+            {
+                name = beam_file_name(h->ms_name, i);
+                oskar_log_value(h->log, 'M', 1,
+                        "Measurement Set", "%s", name);
+                free(name);
+            }
+        }
 
         /* Write simulation log to the output files. */
         log_data = oskar_log_file_data(h->log, &log_size);
+        for (i = 0; i < h->num_beams; ++i)
+        {
 #ifndef OSKAR_NO_MS
-        if (h->ms)
-            oskar_ms_add_history(h->ms, "OSKAR_LOG", log_data, log_size);
+            if (h->ms[i])
+                oskar_ms_add_history(h->ms[i], "OSKAR_LOG",
+                        log_data, log_size);
 #endif
-        if (h->vis)
-            oskar_binary_write(h->vis, OSKAR_CHAR, OSKAR_TAG_GROUP_RUN,
-                    OSKAR_TAG_RUN_LOG, 0, log_size, log_data, status);
+            if (h->vis[i])
+                oskar_binary_write(h->vis[i], OSKAR_CHAR,
+                        OSKAR_TAG_GROUP_RUN, OSKAR_TAG_RUN_LOG, 0,
+                        log_size, log_data, status);
+        }
         free(log_data);
     }
 
@@ -688,6 +1267,31 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
 }
 
 
+void oskar_interferometer_set_additional_beams(oskar_Interferometer* h,
+        int num_beams, const double* ra_rad, const double* dec_rad,
+        int* status)
+{
+    int i;
+    if (*status || !h) return;
+    if (num_beams < 0)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    oskar_interferometer_reset_cache(h, status);
+    h->num_beams = 1 + num_beams;
+    h->beam_ra_rad = (double*) realloc(h->beam_ra_rad,
+            h->num_beams * sizeof(double));
+    h->beam_dec_rad = (double*) realloc(h->beam_dec_rad,
+            h->num_beams * sizeof(double));
+    for (i = 0; i < num_beams; ++i)
+    {
+        h->beam_ra_rad[i + 1] = ra_rad[i];
+        h->beam_dec_rad[i + 1] = dec_rad[i];
+    }
+}
+
+
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
         int* status)
 {
@@ -710,6 +1314,30 @@ void oskar_interferometer_set_correlation_type(oskar_Interferometer* h,
 }
 
 
+void oskar_interferometer_set_cpu_affinity(oskar_Interferometer* h, int num_cpus,
+        const int* cpu_ids)
+{
+    int i;
+    free(h->cpu_ids);
+    h->cpu_ids = 0;
+    h->num_cpu_ids = 0;
+    if (num_cpus > 0)
+    {
+        h->cpu_ids = (int*) calloc(num_cpus, sizeof(int));
+        if (h->cpu_ids)
+        {
+            h->num_cpu_ids = num_cpus;
+            for (i = 0; i < num_cpus; ++i)
+                h->cpu_ids[i] = cpu_ids[i];
+        }
+    }
+
+    /* Re-create the worker threads with the new affinity when next used. */
+    oskar_thread_pool_free(h->thread_pool);
+    h->thread_pool = 0;
+}
+
+
 void oskar_interferometer_set_force_polarised_ms(oskar_Interferometer* h,
         int value)
 {
@@ -772,6 +1400,13 @@ void oskar_interferometer_set_log(oskar_Interferometer* h, oskar_Log* log)
 }
 
 
+void oskar_interferometer_set_max_host_memory_gb(oskar_Interferometer* h,
+        double value)
+{
+    h->max_host_memory_gb = value;
+}
+
+
 void oskar_interferometer_set_max_sources_per_chunk(oskar_Interferometer* h,
         int value)
 {
@@ -841,6 +1476,11 @@ void oskar_interferometer_set_sky_model(oskar_Interferometer* h,
     free(h->sky_chunks);
     h->sky_chunks = 0;
     h->num_sky_chunks = 0;
+    oskar_station_beam_cache_free(h->beam_cache, status);
+    h->beam_cache = 0;
+    oskar_vis_cache_free(h->vis_cache, status);
+    h->vis_cache = 0;
+    free_vis_interpolation(h);
 
     /* Split up the sky model into chunks and store them. */
     h->num_sources_total = oskar_sky_num_sources(sky);
@@ -861,6 +1501,23 @@ void oskar_interferometer_set_sky_model(oskar_Interferometer* h,
 }
 
 
+void oskar_interferometer_set_station_subset(oskar_Interferometer* h,
+        int num_stations, const int* station_indices, int* status)
+{
+    if (*status || !h) return;
+    if (num_stations < 0)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    h->num_station_subset = num_stations;
+    h->station_subset = (int*) realloc(h->station_subset,
+            num_stations * sizeof(int));
+    if (num_stations > 0)
+        memcpy(h->station_subset, station_indices, num_stations * sizeof(int));
+}
+
+
 void oskar_interferometer_set_telescope_model(oskar_Interferometer* h,
         const oskar_Telescope* model, int* status)
 {
@@ -875,8 +1532,25 @@ void oskar_interferometer_set_telescope_model(oskar_Interferometer* h,
     }
 
     /* Remove any existing telescope model, and copy the new one. */
+    oskar_station_beam_cache_free(h->beam_cache, status);
+    h->beam_cache = 0;
+    oskar_vis_cache_free(h->vis_cache, status);
+    h->vis_cache = 0;
+    free_vis_interpolation(h);
     oskar_telescope_free(h->tel, status);
-    h->tel = oskar_telescope_create_copy(model, OSKAR_CPU, status);
+    if (h->num_station_subset > 0)
+    {
+        /* Copy only the selected stations. */
+        h->tel = oskar_telescope_create_subset(model, h->num_station_subset,
+                h->station_subset, OSKAR_CPU, status);
+        if (*status)
+        {
+            oskar_log_error(h->log, "Invalid station subset.");
+            return;
+        }
+    }
+    else
+        h->tel = oskar_telescope_create_copy(model, OSKAR_CPU, status);
 
     /* Analyse the telescope model. */
     oskar_telescope_analyse(h->tel, status);
@@ -916,6 +1590,31 @@ void oskar_interferometer_set_output_measurement_set(oskar_Interferometer* h,
 }
 
 
+void oskar_interferometer_set_source_aggregation(oskar_Interferometer* h,
+        int value, double tolerance)
+{
+    h->source_aggregation = value;
+    h->aggregation_tolerance = tolerance;
+}
+
+
+void oskar_interferometer_set_nufft(oskar_Interferometer* h, int value,
+        double tolerance)
+{
+    h->nufft = value;
+    h->nufft_tolerance = tolerance;
+}
+
+
+void oskar_interferometer_set_baseline_interpolation(
+        oskar_Interferometer* h, int value, double tolerance)
+{
+    h->vis_interp = value;
+    h->vis_interp_tolerance = tolerance;
+    free_vis_interpolation(h);
+}
+
+
 void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
         double min_jy, double max_jy)
 {
@@ -924,6 +1623,35 @@ void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
 }
 
 
+void oskar_interferometer_set_station_beam_interpolation(
+        oskar_Interferometer* h, int type, double max_drift_rad)
+{
+    h->beam_interp_type = type;
+    h->beam_max_drift_rad = max_drift_rad;
+}
+
+
+void oskar_interferometer_set_station_beam_low_rank(oskar_Interferometer* h,
+        int value, double tolerance)
+{
+    h->beam_low_rank = value;
+    h->beam_low_rank_tolerance = tolerance;
+}
+
+
+void oskar_interferometer_set_vis_cache_directory(oskar_Interferometer* h,
+        const char* dir)
+{
+    int len;
+    len = dir ? (int) strlen(dir) : 0;
+    free(h->vis_cache_dir);
+    h->vis_cache_dir = 0;
+    if (len == 0) return;
+    h->vis_cache_dir = calloc(1 + len, 1);
+    strcpy(h->vis_cache_dir, dir);
+}
+
+
 void oskar_interferometer_set_zero_failed_gaussians(oskar_Interferometer* h,
         int value)
 {
@@ -933,26 +1661,51 @@ void oskar_interferometer_set_zero_failed_gaussians(oskar_Interferometer* h,
 
 const oskar_VisHeader* oskar_interferometer_vis_header(oskar_Interferometer* h)
 {
-    return h->header;
+    return h->header ? h->header[0] : 0;
 }
 
 
 void oskar_interferometer_write_block(oskar_Interferometer* h,
         const oskar_VisBlock* block, int block_index, int* status)
 {
+    oskar_interferometer_write_beam_block(h, 0, block, block_index, status);
+}
+
+
+void oskar_interferometer_write_beam_block(oskar_Interferometer* h,
+        int beam_index, const oskar_VisBlock* block, int block_index,
+        int* status)
+{
+    char* name;
+    const int i = beam_index;
     if (*status) return;
+    if (!h->header || i < 0 || i >= h->num_beams)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
 
     /* Open files only if required, and write the block into them. */
     oskar_timer_resume(h->tmr_write);
 #ifndef OSKAR_NO_MS
-    if (h->ms_name && !h->ms)
-        h->ms = oskar_vis_header_write_ms(h->header, h->ms_name, OSKAR_TRUE,
+    if (h->ms_name && !h->ms[i])
+    {
+        name = beam_file_name(h->ms_name, i);
+        h->ms[i] = oskar_vis_header_write_ms(h->header[i], name, OSKAR_TRUE,
                 h->force_polarised_ms, status);
-    if (h->ms) oskar_vis_block_write_ms(block, h->header, h->ms, status);
+        free(name);
+    }
+    if (h->ms[i])
+        oskar_vis_block_write_ms(block, h->header[i], h->ms[i], status);
 #endif
-    if (h->vis_name && !h->vis)
-        h->vis = oskar_vis_header_write(h->header, h->vis_name, status);
-    if (h->vis) oskar_vis_block_write(block, h->vis, block_index, status);
+    if (h->vis_name && !h->vis[i])
+    {
+        name = beam_file_name(h->vis_name, i);
+        h->vis[i] = oskar_vis_header_write(h->header[i], name, status);
+        free(name);
+    }
+    if (h->vis[i])
+        oskar_vis_block_write(block, h->vis[i], block_index, status);
     oskar_timer_pause(h->tmr_write);
 }
 
@@ -960,20 +1713,26 @@ void oskar_interferometer_write_block(oskar_Interferometer* h,
 /* Private methods. */
 
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
-        oskar_Sky* sky, int channel_index_block, int time_index_block,
+        oskar_Sky* sky, oskar_VisBlock* vis_block, int beam_index,
+        int chunk_index, int channel_index_block, int time_index_block,
         int time_index_simulation, int* status)
 {
     int num_baselines, num_stations, num_src, num_times_block, num_channels;
+    int use_aggregate, use_apparent, use_nufft = 0, autocorr;
     double dt_dump_days, t_start, t_dump, gast, frequency, ra0, dec0;
     const oskar_Mem *x, *y, *z;
     oskar_Mem* alias = 0;
+    oskar_Telescope* tel;
+
+    /* Get the telescope model for the beam. */
+    tel = beam_index > 0 ? d->beam_tel : d->tel;
 
     /* Get dimensions. */
-    num_baselines   = oskar_telescope_num_baselines(d->tel);
-    num_stations    = oskar_telescope_num_stations(d->tel);
+    num_baselines   = oskar_telescope_num_baselines(tel);
+    num_stations    = oskar_telescope_num_stations(tel);
     num_src         = oskar_sky_num_sources(sky);
-    num_times_block = oskar_vis_block_num_times(d->vis_block);
-    num_channels    = oskar_vis_block_num_channels(d->vis_block);
+    num_times_block = oskar_vis_block_num_times(vis_block);
+    num_channels    = oskar_vis_block_num_channels(vis_block);
 
     /* Return if there are no sources in the chunk,
      * or if block time index requested is outside the valid range. */
@@ -990,11 +1749,11 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     oskar_sky_scale_flux_with_frequency(sky, frequency, status);
 
     /* Evaluate station u,v,w coordinates. */
-    ra0 = oskar_telescope_phase_centre_ra_rad(d->tel);
-    dec0 = oskar_telescope_phase_centre_dec_rad(d->tel);
-    x = oskar_telescope_station_true_x_offset_ecef_metres_const(d->tel);
-    y = oskar_telescope_station_true_y_offset_ecef_metres_const(d->tel);
-    z = oskar_telescope_station_true_z_offset_ecef_metres_const(d->tel);
+    ra0 = oskar_telescope_phase_centre_ra_rad(tel);
+    dec0 = oskar_telescope_phase_centre_dec_rad(tel);
+    x = oskar_telescope_station_true_x_offset_ecef_metres_const(tel);
+    y = oskar_telescope_station_true_y_offset_ecef_metres_const(tel);
+    z = oskar_telescope_station_true_z_offset_ecef_metres_const(tel);
     oskar_convert_ecef_to_station_uvw(num_stations, x, y, z, ra0, dec0, gast,
             d->u, d->v, d->w, status);
 
@@ -1009,9 +1768,23 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
 
     /* Evaluate station beam (Jones E: may be matrix). */
     oskar_timer_resume(d->tmr_E);
-    oskar_evaluate_jones_E(d->E, num_src, OSKAR_RELATIVE_DIRECTIONS,
-            oskar_sky_l(sky), oskar_sky_m(sky), oskar_sky_n(sky), d->tel,
-            gast, frequency, d->station_work, time_index_simulation, status);
+    if (h->beam_cache && oskar_jones_mem_location(d->E) == OSKAR_CPU)
+        oskar_station_beam_cache_evaluate(h->beam_cache, d->E, num_src,
+                h->apply_horizon_clip ? d->source_map : 0, d->chunk,
+                chunk_index, channel_index_block, frequency, tel,
+                t_start, h->time_inc_sec, h->num_time_steps,
+                time_index_simulation, d->station_work, status);
+    else if (h->use_beam_low_rank &&
+            oskar_jones_mem_location(d->E) == OSKAR_CPU)
+        oskar_evaluate_jones_E_low_rank(d->E, num_src, oskar_sky_l(sky),
+                oskar_sky_m(sky), oskar_sky_n(sky), tel, gast, frequency,
+                d->station_work, time_index_simulation,
+                h->beam_low_rank_tolerance, 0, status);
+    else
+        oskar_evaluate_jones_E(d->E, num_src, OSKAR_RELATIVE_DIRECTIONS,
+                oskar_sky_l(sky), oskar_sky_m(sky), oskar_sky_n(sky), tel,
+                gast, frequency, d->station_work, time_index_simulation,
+                status);
     oskar_timer_pause(d->tmr_E);
 
 #if 0
@@ -1019,7 +1792,7 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
      * NOTE this is currently only a CPU implementation. */
     if (d->Z)
     {
-        oskar_evaluate_jones_Z(d->Z, num_src, sky, d->tel,
+        oskar_evaluate_jones_Z(d->Z, num_src, sky, tel,
                 &settings->ionosphere, gast, frequency, &(d->workJonesZ),
                 status);
         oskar_timer_resume(d->tmr_join);
@@ -1034,35 +1807,68 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     {
         oskar_timer_resume(d->tmr_E);
         oskar_evaluate_jones_R(d->R, num_src, oskar_sky_ra_rad_const(sky),
-                oskar_sky_dec_rad_const(sky), d->tel, gast, status);
+                oskar_sky_dec_rad_const(sky), tel, gast, status);
         oskar_timer_pause(d->tmr_E);
         oskar_timer_resume(d->tmr_join);
         oskar_jones_join(d->R, d->E, d->R, status);
         oskar_timer_pause(d->tmr_join);
     }
 
+    /* Check if cross-correlations should be predicted using the spatial
+     * tree, which evaluates its own phase factors for each source group. */
+    autocorr = oskar_vis_block_has_auto_correlations(vis_block);
+    use_aggregate = d->tree && !oskar_sky_use_extended(sky) &&
+            oskar_vis_block_has_cross_correlations(vis_block);
+
+    /* Check if cross-correlations should be predicted using the NUFFT.
+     * This is only used for point sources, and if it is expected to be
+     * faster than the direct sum for this sky chunk and time. */
+    if (h->nufft && !d->tree && fringe_phase_only(tel) &&
+            oskar_jones_mem_location(d->E) == OSKAR_CPU &&
+            oskar_vis_block_has_cross_correlations(vis_block) &&
+            !oskar_sky_use_extended(sky))
+        use_nufft = oskar_cross_correlate_nufft_cost(oskar_jones_type(d->E),
+                num_src, sky, tel, d->u, d->v, d->w, frequency,
+                h->nufft_tolerance, status) < 1.0;
+
     /* Evaluate interferometer phase (Jones K: scalar). */
-    oskar_timer_resume(d->tmr_K);
-    oskar_evaluate_jones_K(d->K, num_src, oskar_sky_l_const(sky),
-            oskar_sky_m_const(sky), oskar_sky_n_const(sky), d->u, d->v, d->w,
-            frequency, oskar_sky_I_const(sky),
-            h->source_min_jy, h->source_max_jy, status);
-    oskar_timer_pause(d->tmr_K);
+    if ((!use_nufft && !use_aggregate) || autocorr)
+    {
+        oskar_timer_resume(d->tmr_K);
+        oskar_evaluate_jones_K(d->K, num_src, oskar_sky_l_const(sky),
+                oskar_sky_m_const(sky), oskar_sky_n_const(sky),
+                d->u, d->v, d->w, frequency, oskar_sky_I_const(sky),
+                h->source_min_jy, h->source_max_jy, status);
+        oskar_timer_pause(d->tmr_K);
+    }
 
-    /* Join Jones K with Jones Z*E. */
-    oskar_timer_resume(d->tmr_join);
-    oskar_jones_join(d->J, d->K, d->R ? d->R : d->E, status);
-    oskar_timer_pause(d->tmr_join);
+    /* Check if the apparent brightness of each source can be shared by all
+     * baselines. This is only worthwhile for polarised visibilities
+     * if the direct sum would also evaluate smearing or extended sources. */
+    use_apparent = !d->tree && !use_nufft &&
+            oskar_jones_mem_location(d->E) == OSKAR_CPU &&
+            oskar_type_is_matrix(oskar_jones_type(d->E)) &&
+            common_apparent_brightness(tel) &&
+            (oskar_sky_use_extended(sky) || !fringe_phase_only(tel));
+
+    /* Join Jones K with Jones Z*E, unless only the apparent brightness
+     * is needed. */
+    if ((!use_apparent && !use_nufft && !use_aggregate) || autocorr)
+    {
+        oskar_timer_resume(d->tmr_join);
+        oskar_jones_join(d->J, d->K, d->R ? d->R : d->E, status);
+        oskar_timer_pause(d->tmr_join);
+    }
 
     /* Create alias for auto/cross-correlations. */
     oskar_timer_resume(d->tmr_correlate);
     alias = oskar_mem_create_alias(0, 0, 0, status);
 
     /* Auto-correlate for this time and channel. */
-    if (oskar_vis_block_has_auto_correlations(d->vis_block))
+    if (autocorr)
     {
         oskar_mem_set_alias(alias,
-                oskar_vis_block_auto_correlations(d->vis_block),
+                oskar_vis_block_auto_correlations(vis_block),
                 num_stations *
                 (num_channels * time_index_block + channel_index_block),
                 num_stations, status);
@@ -1070,15 +1876,36 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     }
 
     /* Cross-correlate for this time and channel. */
-    if (oskar_vis_block_has_cross_correlations(d->vis_block))
+    if (oskar_vis_block_has_cross_correlations(vis_block))
     {
+        const oskar_Mem* mask = 0;
+        if (h->interp_stride && oskar_mem_location(d->u) == OSKAR_CPU &&
+                set_baseline_mask(h, d->baseline_mask, time_index_block,
+                        num_times_block, status))
+            mask = d->baseline_mask;
         oskar_mem_set_alias(alias,
-                oskar_vis_block_cross_correlations(d->vis_block),
+                oskar_vis_block_cross_correlations(vis_block),
                 num_baselines *
                 (num_channels * time_index_block + channel_index_block),
                 num_baselines, status);
-        oskar_cross_correlate(alias, num_src, d->J, sky, d->tel,
-                d->u, d->v, d->w, gast, frequency, status);
+        if (use_aggregate)
+            oskar_cross_correlate_aggregate(alias, num_src,
+                    d->R ? d->R : d->E, d->tree, sky, tel,
+                    d->u, d->v, d->w, mask, frequency,
+                    h->source_min_jy, h->source_max_jy,
+                    h->aggregation_tolerance, status);
+        else if (use_nufft)
+            oskar_cross_correlate_nufft(alias, num_src,
+                    d->R ? d->R : d->E, sky, tel, d->u, d->v, d->w, mask,
+                    frequency, h->source_min_jy, h->source_max_jy,
+                    h->nufft_tolerance, status);
+        else if (use_apparent)
+            oskar_cross_correlate_apparent(alias, num_src,
+                    d->R ? d->R : d->E, d->K, sky, tel, d->u, d->v, d->w,
+                    mask, gast, frequency, status);
+        else
+            oskar_cross_correlate(alias, num_src, d->J, sky, tel,
+                    d->u, d->v, d->w, mask, gast, frequency, status);
     }
 
     /* Free alias for auto/cross-correlations. */
@@ -1087,10 +1914,180 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
 }
 
 
+static void read_cached_work_unit(oskar_Interferometer* h, DeviceData* d,
+        int chunk_index, int time_index_block, int time_index_simulation,
+        int* status)
+{
+    int i_beam;
+    oskar_Mem* alias;
+    if (*status) return;
+
+    /* Add the stored contribution for each beam to the block. */
+    alias = oskar_mem_create_alias(0, 0, 0, status);
+    for (i_beam = 0; i_beam < h->num_beams; ++i_beam)
+    {
+        int xc, ac;
+        oskar_VisBlock* b = d->vis_block[i_beam];
+        xc = oskar_vis_block_has_cross_correlations(b);
+        ac = oskar_vis_block_has_auto_correlations(b);
+        oskar_vis_cache_read(h->vis_cache, chunk_index,
+                time_index_simulation * h->num_beams + i_beam,
+                xc ? d->cache_xc : 0, ac ? d->cache_ac : 0, status);
+        if (xc)
+        {
+            time_row(b, 1, time_index_block, alias, status);
+            oskar_mem_add(alias, alias, d->cache_xc,
+                    oskar_mem_length(alias), status);
+        }
+        if (ac)
+        {
+            time_row(b, 0, time_index_block, alias, status);
+            oskar_mem_add(alias, alias, d->cache_ac,
+                    oskar_mem_length(alias), status);
+        }
+    }
+    oskar_mem_free(alias, status);
+}
+
+
+static void write_cached_work_unit(oskar_Interferometer* h, DeviceData* d,
+        int chunk_index, int time_index_block, int time_index_simulation,
+        int* status)
+{
+    int i_beam;
+    oskar_Mem *out, *chunk_xc, *chunk_ac;
+    if (*status) return;
+    out = oskar_mem_create_alias(0, 0, 0, status);
+    chunk_xc = oskar_mem_create_alias(0, 0, 0, status);
+    chunk_ac = oskar_mem_create_alias(0, 0, 0, status);
+    for (i_beam = 0; i_beam < h->num_beams; ++i_beam)
+    {
+        int xc, ac;
+        oskar_VisBlock *b = d->vis_block[i_beam], *c = d->vis_chunk[i_beam];
+        xc = oskar_vis_block_has_cross_correlations(b);
+        ac = oskar_vis_block_has_auto_correlations(b);
+        if (xc)
+        {
+            time_row(b, 1, time_index_block, out, status);
+            time_row(c, 1, time_index_block, chunk_xc, status);
+            oskar_mem_add(out, out, chunk_xc, oskar_mem_length(out), status);
+        }
+        if (ac)
+        {
+            time_row(b, 0, time_index_block, out, status);
+            time_row(c, 0, time_index_block, chunk_ac, status);
+            oskar_mem_add(out, out, chunk_ac, oskar_mem_length(out), status);
+        }
+
+        /* Store the contribution, if the cache has been set up. */
+        if (h->vis_cache)
+            oskar_vis_cache_write(h->vis_cache, chunk_index,
+                    time_index_simulation * h->num_beams + i_beam,
+                    xc ? chunk_xc : 0, ac ? chunk_ac : 0, status);
+
+        /* Clear the contribution from the chunk, ready for the next one. */
+        if (xc) oskar_mem_clear_contents(chunk_xc, status);
+        if (ac) oskar_mem_clear_contents(chunk_ac, status);
+    }
+    oskar_mem_free(out, status);
+    oskar_mem_free(chunk_xc, status);
+    oskar_mem_free(chunk_ac, status);
+}
+
+
+static void time_row(const oskar_VisBlock* block, int cross,
+        int time_index_block, oskar_Mem* alias, int* status)
+{
+    size_t num;
+    num = (size_t) oskar_vis_block_num_channels(block) * (cross ?
+            oskar_vis_block_num_baselines(block) :
+            oskar_vis_block_num_stations(block));
+    oskar_mem_set_alias(alias, cross ?
+            oskar_vis_block_cross_correlations_const(block) :
+            oskar_vis_block_auto_correlations_const(block),
+            num * time_index_block, num, status);
+}
+
+
+static void set_up_vis_cache(oskar_Interferometer* h, int* status)
+{
+    int i;
+    unsigned long obs = 0, settings = 0;
+    unsigned int tel;
+    oskar_CRC* crc_data;
+    if (*status) return;
+
+    /* Hash the observation parameters. */
+    crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    obs = oskar_crc_update(crc_data, obs, &h->freq_start_hz, sizeof(double));
+    obs = oskar_crc_update(crc_data, obs, &h->freq_inc_hz, sizeof(double));
+    obs = oskar_crc_update(crc_data, obs, &h->num_channels, sizeof(int));
+    obs = oskar_crc_update(crc_data, obs, &h->time_start_mjd_utc,
+            sizeof(double));
+    obs = oskar_crc_update(crc_data, obs, &h->time_inc_sec, sizeof(double));
+    obs = oskar_crc_update(crc_data, obs, &h->num_time_steps, sizeof(int));
+    obs = oskar_crc_update(crc_data, obs, &h->num_beams, sizeof(int));
+    obs = oskar_crc_update(crc_data, obs, h->beam_ra_rad,
+            h->num_beams * sizeof(double));
+    obs = oskar_crc_update(crc_data, obs, h->beam_dec_rad,
+            h->num_beams * sizeof(double));
+
+    /* Hash the settings that affect the simulated visibilities. */
+    settings = oskar_crc_update(crc_data, settings, &h->prec, sizeof(int));
+    settings = oskar_crc_update(crc_data, settings, &h->correlation_type, 1);
+    settings = oskar_crc_update(crc_data, settings, &h->apply_horizon_clip,
+            sizeof(int));
+    settings = oskar_crc_update(crc_data, settings, &h->zero_failed_gaussians,
+            sizeof(int));
+    settings = oskar_crc_update(crc_data, settings, &h->source_min_jy,
+            sizeof(double));
+    settings = oskar_crc_update(crc_data, settings, &h->source_max_jy,
+            sizeof(double));
+    settings = oskar_crc_update(crc_data, settings, &h->source_aggregation,
+            sizeof(int));
+    settings = oskar_crc_update(crc_data, settings, &h->aggregation_tolerance,
+            sizeof(double));
+    settings = oskar_crc_update(crc_data, settings, &h->nufft, sizeof(int));
+    settings = oskar_crc_update(crc_data, settings, &h->nufft_tolerance,
+            sizeof(double));
+    settings = oskar_crc_update(crc_data, settings, &h->beam_interp_type,
+            sizeof(int));
+    settings = oskar_crc_update(crc_data, settings, &h->beam_max_drift_rad,
+            sizeof(double));
+    settings = oskar_crc_update(crc_data, settings, &h->use_beam_low_rank,
+            sizeof(int));
+    settings = oskar_crc_update(crc_data, settings,
+            &h->beam_low_rank_tolerance, sizeof(double));
+    settings = oskar_crc_update(crc_data, settings, &h->vis_interp,
+            sizeof(int));
+    settings = oskar_crc_update(crc_data, settings, &h->vis_interp_tolerance,
+            sizeof(double));
+    oskar_crc_free(crc_data);
+
+    /* Create the cache, and check which chunks can be reused. */
+    tel = oskar_vis_cache_hash_telescope(h->tel, status);
+    h->vis_cache = oskar_vis_cache_create(h->vis_cache_dir, h->num_sky_chunks,
+            h->num_time_steps * h->num_beams, tel, (unsigned int) obs,
+            (unsigned int) settings, status);
+    for (i = 0; i < h->num_sky_chunks; ++i)
+        oskar_vis_cache_check_chunk(h->vis_cache, i, h->sky_chunks[i], status);
+    if (*status)
+    {
+        oskar_log_error(h->log, "Unable to set up visibility cache in '%s'.",
+                h->vis_cache_dir);
+        return;
+    }
+    oskar_log_message(h->log, 'M', 0, "Using cached visibilities for "
+            "%d of %d sky chunks.", oskar_vis_cache_num_cached(h->vis_cache),
+            h->num_sky_chunks);
+}
+
+
 static void set_up_vis_header(oskar_Interferometer* h, int* status)
 {
-    int num_stations, vis_type;
+    int i, num_stations, vis_type;
     const double rad2deg = 180.0/M_PI;
+    oskar_VisHeader* hdr;
     int write_autocorr = 0, write_crosscorr = 0;
     if (*status) return;
 
@@ -1110,16 +2107,21 @@ static void set_up_vis_header(oskar_Interferometer* h, int* status)
     vis_type = h->prec | OSKAR_COMPLEX;
     if (oskar_telescope_pol_mode(h->tel) == OSKAR_POL_MODE_FULL)
         vis_type |= OSKAR_MATRIX;
-    h->header = oskar_vis_header_create(vis_type, h->prec,
+    h->header = (oskar_VisHeader**) calloc(h->num_beams,
+            sizeof(oskar_VisHeader*));
+    h->ms = (oskar_MeasurementSet**) calloc(h->num_beams,
+            sizeof(oskar_MeasurementSet*));
+    h->vis = (oskar_Binary**) calloc(h->num_beams, sizeof(oskar_Binary*));
+    hdr = oskar_vis_header_create(vis_type, h->prec,
             h->max_times_per_block, h->num_time_steps, h->num_channels,
             h->num_channels, num_stations, write_autocorr, write_crosscorr,
             status);
 
     /* Add metadata from settings. */
-    oskar_vis_header_set_freq_start_hz(h->header, h->freq_start_hz);
-    oskar_vis_header_set_freq_inc_hz(h->header, h->freq_inc_hz);
-    oskar_vis_header_set_time_start_mjd_utc(h->header, h->time_start_mjd_utc);
-    oskar_vis_header_set_time_inc_sec(h->header, h->time_inc_sec);
+    oskar_vis_header_set_freq_start_hz(hdr, h->freq_start_hz);
+    oskar_vis_header_set_freq_inc_hz(hdr, h->freq_inc_hz);
+    oskar_vis_header_set_time_start_mjd_utc(hdr, h->time_start_mjd_utc);
+    oskar_vis_header_set_time_inc_sec(hdr, h->time_inc_sec);
 
     /* Add settings file contents if defined. */
     if (h->settings_path)
@@ -1127,37 +2129,175 @@ static void set_up_vis_header(oskar_Interferometer* h, int* status)
         oskar_Mem* temp;
         temp = oskar_mem_read_binary_raw(h->settings_path,
                 OSKAR_CHAR, OSKAR_CPU, status);
-        oskar_mem_copy(oskar_vis_header_settings(h->header), temp, status);
+        oskar_mem_copy(oskar_vis_header_settings(hdr), temp, status);
         oskar_mem_free(temp, status);
     }
 
     /* Copy other metadata from telescope model. */
-    oskar_vis_header_set_time_average_sec(h->header,
+    oskar_vis_header_set_time_average_sec(hdr,
             oskar_telescope_time_average_sec(h->tel));
-    oskar_vis_header_set_channel_bandwidth_hz(h->header,
+    oskar_vis_header_set_channel_bandwidth_hz(hdr,
             oskar_telescope_channel_bandwidth_hz(h->tel));
-    oskar_vis_header_set_phase_centre(h->header, 0,
+    oskar_vis_header_set_phase_centre(hdr, 0,
             oskar_telescope_phase_centre_ra_rad(h->tel) * rad2deg,
             oskar_telescope_phase_centre_dec_rad(h->tel) * rad2deg);
-    oskar_vis_header_set_telescope_centre(h->header,
+    oskar_vis_header_set_telescope_centre(hdr,
             oskar_telescope_lon_rad(h->tel) * rad2deg,
             oskar_telescope_lat_rad(h->tel) * rad2deg,
             oskar_telescope_alt_metres(h->tel));
-    oskar_mem_copy(oskar_vis_header_station_x_offset_ecef_metres(h->header),
+    oskar_mem_copy(oskar_vis_header_station_x_offset_ecef_metres(hdr),
             oskar_telescope_station_true_x_offset_ecef_metres_const(h->tel),
             status);
-    oskar_mem_copy(oskar_vis_header_station_y_offset_ecef_metres(h->header),
+    oskar_mem_copy(oskar_vis_header_station_y_offset_ecef_metres(hdr),
             oskar_telescope_station_true_y_offset_ecef_metres_const(h->tel),
             status);
-    oskar_mem_copy(oskar_vis_header_station_z_offset_ecef_metres(h->header),
+    oskar_mem_copy(oskar_vis_header_station_z_offset_ecef_metres(hdr),
             oskar_telescope_station_true_z_offset_ecef_metres_const(h->tel),
             status);
+    h->header[0] = hdr;
+
+    /* Copy the header for each additional beam, with its phase centre. */
+    for (i = 1; i < h->num_beams; ++i)
+    {
+        h->header[i] = oskar_vis_header_create_copy(hdr, status);
+        oskar_vis_header_set_phase_centre(h->header[i], 0,
+                h->beam_ra_rad[i] * rad2deg, h->beam_dec_rad[i] * rad2deg);
+    }
+}
+
+
+/* Returns true if the apparent brightness of each source is the same at
+ * all stations, so that it can be shared by all baselines. */
+static int common_apparent_brightness(const oskar_Telescope* tel)
+{
+    return oskar_telescope_identical_stations(tel) &&
+            oskar_telescope_allow_station_beam_duplication(tel);
+}
+
+
+/* Returns true if, in addition, the fringe phase of a point source is the
+ * only baseline-dependent term (there is no smearing). */
+static int fringe_phase_only(const oskar_Telescope* tel)
+{
+    return common_apparent_brightness(tel) &&
+            oskar_telescope_channel_bandwidth_hz(tel) == 0.0 &&
+            oskar_telescope_time_average_sec(tel) == 0.0;
+}
+
+
+static int can_aggregate_sources(const oskar_Interferometer* h)
+{
+    /* The source tree is built from the directions relative to the
+     * first beam only. */
+    return h->num_beams == 1 && fringe_phase_only(h->tel);
+}
+
+
+static void set_up_vis_interpolation(oskar_Interferometer* h, int* status)
+{
+    int i, num_stations, num_baselines, max_stride = 1;
+    int num_evaluated = 0, num_total = 0;
+    double l, m, n, radius = 0.0;
+    if (*status || !h->tel) return;
+
+    /* Visibilities are only interpolated for cross-correlations on a CPU. */
+    if (h->correlation_type == 'A' || h->coords_only) return;
+
+    /* Find the largest power-of-two stride that fits in a block. */
+    while (2 * max_stride <= h->max_times_per_block - 1) max_stride *= 2;
+    if (max_stride < 2) return;
+
+    /* Find the centre and extent of the sky model, as seen by each beam. */
+    free_vis_interpolation(h);
+    h->interp_l = (double*) calloc(h->num_beams, sizeof(double));
+    h->interp_m = (double*) calloc(h->num_beams, sizeof(double));
+    h->interp_n = (double*) calloc(h->num_beams, sizeof(double));
+    for (i = 0; i < h->num_beams; ++i)
+    {
+        oskar_vis_interpolation_sky_extent(h->num_sky_chunks, h->sky_chunks,
+                h->beam_ra_rad[i], h->beam_dec_rad[i], &l, &m, &n, &radius,
+                status);
+        h->interp_l[i] = l;
+        h->interp_m[i] = m;
+        h->interp_n[i] = n;
+    }
+
+    /* Get the interpolation stride for each baseline. */
+    num_stations = oskar_telescope_num_stations(h->tel);
+    num_baselines = oskar_telescope_num_baselines(h->tel);
+    h->interp_stride = (int*) calloc(num_baselines, sizeof(int));
+    oskar_vis_interpolation_strides(num_stations,
+            oskar_telescope_station_true_x_offset_ecef_metres_const(h->tel),
+            oskar_telescope_station_true_y_offset_ecef_metres_const(h->tel),
+            oskar_telescope_station_true_z_offset_ecef_metres_const(h->tel),
+            h->freq_start_hz + (h->num_channels - 1) * h->freq_inc_hz,
+            radius, h->time_inc_sec, h->vis_interp_tolerance, max_stride,
+            h->interp_stride, status);
+    h->interp_uu = oskar_mem_create(h->prec, OSKAR_CPU, 0, status);
+    h->interp_vv = oskar_mem_create(h->prec, OSKAR_CPU, 0, status);
+    h->interp_ww = oskar_mem_create(h->prec, OSKAR_CPU, 0, status);
+    if (*status)
+    {
+        free_vis_interpolation(h);
+        return;
+    }
+
+    /* Report the fraction of cross-correlations evaluated directly. */
+    for (i = 0; i < num_baselines; ++i)
+    {
+        int t;
+        for (t = 0; t < h->max_times_per_block; ++t, ++num_total)
+            if (oskar_vis_interpolation_required(h->interp_stride[i], t,
+                    h->max_times_per_block)) num_evaluated++;
+    }
+    oskar_log_message(h->log, 'M', 0, "Evaluating %.1f%% of "
+            "cross-correlations directly, and interpolating the rest in time.",
+            100.0 * num_evaluated / num_total);
+}
+
+
+static void free_vis_interpolation(oskar_Interferometer* h)
+{
+    int status = 0;
+    free(h->interp_stride);
+    free(h->interp_l);
+    free(h->interp_m);
+    free(h->interp_n);
+    oskar_mem_free(h->interp_uu, &status);
+    oskar_mem_free(h->interp_vv, &status);
+    oskar_mem_free(h->interp_ww, &status);
+    h->interp_stride = 0;
+    h->interp_l = h->interp_m = h->interp_n = 0;
+    h->interp_uu = h->interp_vv = h->interp_ww = 0;
+}
+
+
+/* Flags the baselines which must be correlated at this time, and returns
+ * true if any can be skipped because they will be interpolated. */
+static int set_baseline_mask(const oskar_Interferometer* h, oskar_Mem* mask,
+        int time_index_block, int num_times_block, int* status)
+{
+    int b, num_baselines, num_skipped = 0;
+    int* m;
+    if (*status) return 0;
+    num_baselines = oskar_telescope_num_baselines(h->tel);
+    if ((int)oskar_mem_length(mask) < num_baselines)
+        oskar_mem_realloc(mask, num_baselines, status);
+    m = oskar_mem_int(mask, status);
+    if (*status) return 0;
+    for (b = 0; b < num_baselines; ++b)
+    {
+        m[b] = oskar_vis_interpolation_required(h->interp_stride[b],
+                time_index_block, num_times_block);
+        if (!m[b]) num_skipped++;
+    }
+    return num_skipped > 0;
 }
 
 
 static void set_up_device_data(oskar_Interferometer* h, int* status)
 {
-    int i, dev_loc, complx, vistype, num_stations, num_src;
+    int i, j, dev_loc, complx, vistype, num_stations, num_src;
     if (*status) return;
 
     /* Get local variables. */
@@ -1203,19 +2343,37 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
             d->tmr_correlate = oskar_timer_create(timer_type);
         }
 
-        /* Visibility blocks. */
+        /* Visibility blocks, one for each beam. */
         if (!d->vis_block)
         {
-            d->vis_block = oskar_vis_block_create_from_header(dev_loc,
-                    h->header, status);
-            d->vis_block_cpu[0] = oskar_vis_block_create_from_header(OSKAR_CPU,
-                    h->header, status);
-            d->vis_block_cpu[1] = oskar_vis_block_create_from_header(OSKAR_CPU,
-                    h->header, status);
+            d->vis_block = (oskar_VisBlock**) calloc(h->num_beams,
+                    sizeof(oskar_VisBlock*));
+            d->vis_block_cpu[0] = (oskar_VisBlock**) calloc(h->num_beams,
+                    sizeof(oskar_VisBlock*));
+            d->vis_block_cpu[1] = (oskar_VisBlock**) calloc(h->num_beams,
+                    sizeof(oskar_VisBlock*));
+            if (h->vis_cache_dir)
+                d->vis_chunk = (oskar_VisBlock**) calloc(h->num_beams,
+                        sizeof(oskar_VisBlock*));
+            for (j = 0; j < h->num_beams; ++j)
+            {
+                d->vis_block[j] = oskar_vis_block_create_from_header(dev_loc,
+                        h->header[j], status);
+                if (d->vis_chunk)
+                    d->vis_chunk[j] = oskar_vis_block_create_from_header(
+                            dev_loc, h->header[j], status);
+                d->vis_block_cpu[0][j] = oskar_vis_block_create_from_header(
+                        OSKAR_CPU, h->header[j], status);
+                d->vis_block_cpu[1][j] = oskar_vis_block_create_from_header(
+                        OSKAR_CPU, h->header[j], status);
+            }
+        }
+        for (j = 0; j < h->num_beams; ++j)
+        {
+            oskar_vis_block_clear(d->vis_block[j], status);
+            oskar_vis_block_clear(d->vis_block_cpu[0][j], status);
+            oskar_vis_block_clear(d->vis_block_cpu[1][j], status);
         }
-        oskar_vis_block_clear(d->vis_block, status);
-        oskar_vis_block_clear(d->vis_block_cpu[0], status);
-        oskar_vis_block_clear(d->vis_block_cpu[1], status);
 
         /* Device scratch memory. */
         if (!d->tel)
@@ -1226,6 +2384,9 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
             d->chunk = oskar_sky_create(h->prec, dev_loc, num_src, status);
             d->chunk_clip = oskar_sky_create(h->prec, dev_loc, num_src, status);
             d->tel = oskar_telescope_create_copy(h->tel, dev_loc, status);
+            if (h->num_beams > 1)
+                d->beam_tel = oskar_telescope_create_copy(h->tel, dev_loc,
+                        status);
             d->J = oskar_jones_create(vistype, dev_loc, num_stations, num_src,
                     status);
             d->R = oskar_type_is_matrix(vistype) ? oskar_jones_create(vistype,
@@ -1237,14 +2398,380 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
             d->Z = 0;
             d->station_work = oskar_station_work_create(h->prec, dev_loc,
                     status);
+            d->source_map = oskar_mem_create(OSKAR_INT, dev_loc, 0, status);
+            d->baseline_mask = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0,
+                    status);
+            if (h->vis_cache_dir)
+            {
+                d->cache_xc = oskar_mem_create(vistype, dev_loc, 0, status);
+                d->cache_ac = oskar_mem_create(vistype, dev_loc, 0, status);
+            }
+            if (dev_loc == OSKAR_CPU && h->source_aggregation &&
+                    can_aggregate_sources(h))
+                d->tree = oskar_source_tree_create(8, status);
         }
     }
 }
 
 
-static void free_device_data(oskar_Interferometer* h, int* status)
+static void set_up_memory_budget(oskar_Interferometer* h, int* status)
+{
+    int i, num_src, num_times, over_host = 0, over_device = 0;
+    size_t host_limit = 0, device_limit = 0, mem_free = 0, mem_total = 0;
+    size_t src_bytes, time_bytes;
+    double nufft_range[6];
+    const double gigabyte = 1024.0 * 1024.0 * 1024.0;
+    MemoryEstimate m;
+    if (*status) return;
+
+    /* Get the extent of the sky model and the array for the NUFFT. */
+    nufft_ranges(h, nufft_range, status);
+    if (*status) return;
+
+    /* Get the memory limits. */
+    if (h->max_host_memory_gb > 0.0)
+        host_limit = (size_t) (h->max_host_memory_gb * gigabyte);
+    for (i = 0; i < h->num_gpus; ++i)
+    {
+        oskar_device_set(h->gpu_ids[i], status);
+        oskar_device_mem_info(&mem_free, &mem_total);
+        if (i == 0 || mem_free < device_limit)
+            device_limit = mem_free;
+    }
+
+    /* Halve the number of sources per chunk or times per block,
+     * whichever uses more memory, until the estimate fits. */
+    num_src = h->max_sources_per_chunk > 0 ? h->max_sources_per_chunk : 1;
+    num_times = h->max_times_per_block > 0 ? h->max_times_per_block : 1;
+    for (;;)
+    {
+        estimate_memory(h, num_src, num_times, nufft_range, &m);
+        over_host = (host_limit > 0 && m.host > host_limit);
+        over_device = (device_limit > 0 && m.device > device_limit);
+        if (!over_host && !over_device) break;
+        src_bytes = m.jones + m.chunk + m.work + m.cache +
+                m.tree + m.nufft + m.low_rank;
+        time_bytes = m.vis + m.vis_host + m.interp;
+        if (num_src > 1 && (src_bytes >= time_bytes || num_times == 1))
+            num_src = (num_src + 1) / 2;
+        else if (num_times > 1)
+            num_times = (num_times + 1) / 2;
+        else
+            break;
+    }
+    memory_estimate_log(h->log, &m, h->num_gpus);
+    if (over_host || over_device)
+    {
+        if (over_host)
+            oskar_log_error(h->log, "Estimated host memory (%.3f GB) "
+                    "exceeds the limit of %.3f GB.",
+                    m.host / gigabyte, host_limit / gigabyte);
+        if (over_device)
+            oskar_log_error(h->log, "Estimated GPU memory (%.3f GB) "
+                    "exceeds the free memory of %.3f GB.",
+                    m.device / gigabyte, device_limit / gigabyte);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+
+    /* Apply the new sizes. */
+    if (num_src != h->max_sources_per_chunk)
+    {
+        oskar_log_warning(h->log, "Reducing maximum sources per "
+                "chunk from %d to %d to fit in available memory.",
+                h->max_sources_per_chunk, num_src);
+        h->max_sources_per_chunk = num_src;
+        rechunk_sky(h, num_src, status);
+    }
+    if (num_times != h->max_times_per_block)
+    {
+        oskar_log_warning(h->log, "Reducing maximum time samples "
+                "per block from %d to %d to fit in available memory.",
+                h->max_times_per_block, num_times);
+        h->max_times_per_block = num_times;
+    }
+}
+
+
+static void estimate_memory(const oskar_Interferometer* h, int num_src,
+        int num_times, const double nufft_range[6], MemoryEstimate* m)
+{
+    int i, num_stations, num_baselines, num_devices, num_corr = 0;
+    int num_spectral = 0, num_chunks, num_classes, capacity, vistype;
+    int use_tree;
+    size_t real_size, complex_size, vis_size, src_size, block, cpu_work;
+    memset(m, 0, sizeof(MemoryEstimate));
+    num_stations = oskar_telescope_num_stations(h->tel);
+    num_baselines = oskar_telescope_num_baselines(h->tel);
+    num_devices = h->num_devices > h->num_gpus ? h->num_devices : h->num_gpus;
+    real_size = oskar_mem_element_size(h->prec);
+    complex_size = 2 * real_size;
+    vis_size = complex_size;
+    vistype = h->prec | OSKAR_COMPLEX;
+    if (oskar_telescope_pol_mode(h->tel) == OSKAR_POL_MODE_FULL)
+    {
+        vis_size *= 4;
+        vistype |= OSKAR_MATRIX;
+    }
+
+    /* Sky model chunks: 18 columns, plus any tabulated spectra. */
+    for (i = 0; i < h->num_sky_chunks; ++i)
+    {
+        const int n = oskar_sky_num_spectral_channels(h->sky_chunks[i]);
+        if (n > num_spectral) num_spectral = n;
+    }
+    src_size = (18 + num_spectral) * real_size;
+    num_chunks = (h->num_sources_total + num_src - 1) / num_src;
+    m->sky = (size_t) num_chunks * num_src * src_size;
+
+    /* Telescope model, including any element pattern data. */
+    m->tel = oskar_telescope_memory_bytes(h->tel);
+    m->tel_copy = m->tel * (h->num_beams > 1 ? 2 : 1);
+
+    /* Jones matrices: J, E, R (if polarised) and K (always scalar). */
+    m->jones = (size_t) num_stations * num_src *
+            ((vis_size > complex_size ? 3 : 2) * vis_size + complex_size);
+    m->chunk = 2 * (size_t) num_src * src_size;
+
+    /* Visibility blocks, one per beam on each device (two if caching the
+     * contribution from each chunk), and two on the host for copy back
+     * and write. */
+    if (h->correlation_type != 'A') num_corr += num_baselines;
+    if (h->correlation_type != 'C') num_corr += num_stations;
+    block = (size_t) num_times * ((size_t) h->num_channels * num_corr *
+            vis_size + 3 * (size_t) num_baselines * real_size);
+    m->vis = (h->vis_cache_dir ? 2 : 1) * h->num_beams * block;
+    m->vis_host = 2 * h->num_beams * block;
+
+    /* Station work buffers: source directions and masks, the array
+     * pattern, a beam per level of station hierarchy, and element weights. */
+    m->work = (size_t) num_src * (8 * real_size + 2 * sizeof(int) +
+            complex_size + oskar_telescope_max_station_depth(h->tel) *
+            vis_size) + 2 * (size_t) oskar_telescope_max_station_size(h->tel) *
+            complex_size;
+
+    /* Station beam cache, one beam per class of station per entry. */
+    if (h->beam_interp_type != OSKAR_BEAM_INTERP_NONE && h->num_beams == 1)
+    {
+        num_classes = oskar_telescope_identical_stations(h->tel) ?
+                1 : num_stations;
+        capacity = 4 * h->num_channels * (num_devices + 1);
+        if (capacity < 4) capacity = 4;
+        m->cache = (size_t) capacity * num_classes * num_src * vis_size;
+    }
+
+    /* Buffers used only on CPU devices for cross-correlations:
+     * the source aggregation tree and its station phase factors,
+     * or the non-uniform FFT grids if the tree is not used, and the
+     * correlator tiles for the matrix product of unsmeared sources. */
+    use_tree = h->source_aggregation && can_aggregate_sources(h);
+    if (h->correlation_type != 'A')
+    {
+        if (use_tree)
+            m->tree = oskar_source_tree_memory_bytes(8, num_src, num_stations);
+        else if (h->nufft && fringe_phase_only(h->tel))
+            m->nufft = oskar_cross_correlate_nufft_memory_bytes(vistype,
+                    num_src, num_baselines, nufft_range, nufft_range + 3,
+                    h->nufft_tolerance);
+        if (oskar_telescope_channel_bandwidth_hz(h->tel) == 0.0 &&
+                oskar_telescope_time_average_sec(h->tel) == 0.0)
+            m->gemm = oskar_cross_correlate_gemm_omp_memory_bytes(vistype,
+                    num_stations);
+    }
+
+    /* Low-rank station beams, if not using the station beam cache. */
+    if (h->use_beam_low_rank && !m->cache)
+        m->low_rank = oskar_evaluate_jones_E_low_rank_memory_bytes(h->tel,
+                vistype, num_src);
+
+    /* Visibility interpolation (see set_up_vis_interpolation()):
+     * the true baseline coordinates and stride for each baseline on the
+     * host, and the baseline mask on each device. */
+    if (h->vis_interp && h->correlation_type != 'A' && !h->coords_only &&
+            num_times >= 5)
+        m->interp = (size_t) num_baselines * (3 * (size_t) num_times *
+                real_size + (1 + num_devices) * sizeof(int));
+
+    /* Totals. */
+    cpu_work = m->tree + m->nufft + m->low_rank + m->gemm;
+    m->device = m->tel_copy + m->jones + m->chunk + m->vis + m->work;
+    m->host = m->sky + m->tel + m->cache + m->interp +
+            num_devices * m->vis_host +
+            (num_devices - h->num_gpus) * (m->device + cpu_work);
+}
+
+
+/* Returns upper bounds on the extent of the source direction cosines
+ * (l, m, n - 1) and of the station (u, v, w) coordinates in wavelengths,
+ * used to estimate the size of the non-uniform FFT grids. */
+static void nufft_ranges(const oskar_Interferometer* h, double range[6],
+        int* status)
+{
+    int i, j, num_stations;
+    double l, m, n, radius = 0.0, extent = 0.0, max_freq_hz;
+    const oskar_Mem* coords[3];
+    memset(range, 0, 6 * sizeof(double));
+    if (*status || !h->nufft || !fringe_phase_only(h->tel)) return;
+
+    /* Each direction cosine varies by at most twice the chord distance
+     * from the centre of the sky model to its furthest source. */
+    oskar_vis_interpolation_sky_extent(h->num_sky_chunks, h->sky_chunks,
+            h->beam_ra_rad[0], h->beam_dec_rad[0], &l, &m, &n, &radius,
+            status);
+    for (i = 0; i < 3; ++i)
+        range[i] = (2.0 * radius < 2.0) ? 2.0 * radius : 2.0;
+
+    /* Each station coordinate varies by at most the size of the array. */
+    num_stations = oskar_telescope_num_stations(h->tel);
+    coords[0] = oskar_telescope_station_true_x_offset_ecef_metres_const(h->tel);
+    coords[1] = oskar_telescope_station_true_y_offset_ecef_metres_const(h->tel);
+    coords[2] = oskar_telescope_station_true_z_offset_ecef_metres_const(h->tel);
+    for (i = 0; i < 3; ++i)
+    {
+        double min_val = 0.0, max_val = 0.0;
+        for (j = 0; j < num_stations; ++j)
+        {
+            const double val = oskar_mem_get_element(coords[i], j, status);
+            if (j == 0 || val < min_val) min_val = val;
+            if (j == 0 || val > max_val) max_val = val;
+        }
+        extent += (max_val - min_val) * (max_val - min_val);
+    }
+    max_freq_hz = h->freq_start_hz + (h->num_channels - 1) * h->freq_inc_hz;
+    if (h->freq_start_hz > max_freq_hz) max_freq_hz = h->freq_start_hz;
+    for (i = 3; i < 6; ++i)
+        range[i] = sqrt(extent) * max_freq_hz / 299792458.0;
+}
+
+
+static void memory_estimate_log(oskar_Log* log, const MemoryEstimate* m,
+        int num_gpus)
+{
+    const double megabyte = 1024.0 * 1024.0;
+    oskar_log_section(log, 'M', "Memory estimate");
+    oskar_log_value(log, 'M', 0, "Sky model chunks", "%.1f MB",
+            m->sky / megabyte);
+    oskar_log_value(log, 'M', 0, "Telescope model", "%.1f MB",
+            m->tel / megabyte);
+    if (m->cache > 0)
+        oskar_log_value(log, 'M', 0, "Station beam cache", "%.1f MB",
+                m->cache / megabyte);
+    if (m->interp > 0)
+        oskar_log_value(log, 'M', 0, "Visibility interpolation", "%.1f MB",
+                m->interp / megabyte);
+    oskar_log_value(log, 'M', 0, "Host visibility blocks per device",
+            "%.1f MB", m->vis_host / megabyte);
+    oskar_log_message(log, 'M', 0, "Per compute device:");
+    oskar_log_value(log, 'M', 1, "Telescope model copies", "%.1f MB",
+            m->tel_copy / megabyte);
+    oskar_log_value(log, 'M', 1, "Jones matrices", "%.1f MB",
+            m->jones / megabyte);
+    oskar_log_value(log, 'M', 1, "Sky chunk buffers", "%.1f MB",
+            m->chunk / megabyte);
+    oskar_log_value(log, 'M', 1, "Visibility blocks", "%.1f MB",
+            m->vis / megabyte);
+    oskar_log_value(log, 'M', 1, "Station work buffers", "%.1f MB",
+            m->work / megabyte);
+    if (m->tree + m->nufft + m->low_rank + m->gemm > 0)
+        oskar_log_message(log, 'M', 0, "Per CPU device:");
+    if (m->tree > 0)
+        oskar_log_value(log, 'M', 1, "Source aggregation tree", "%.1f MB",
+                m->tree / megabyte);
+    if (m->nufft > 0)
+        oskar_log_value(log, 'M', 1, "Non-uniform FFT grids", "%.1f MB",
+                m->nufft / megabyte);
+    if (m->low_rank > 0)
+        oskar_log_value(log, 'M', 1, "Low-rank station beams", "%.1f MB",
+                m->low_rank / megabyte);
+    if (m->gemm > 0)
+        oskar_log_value(log, 'M', 1, "Correlator tile buffers", "%.1f MB",
+                m->gemm / megabyte);
+    if (num_gpus > 0)
+        oskar_log_value(log, 'M', 0, "Total per GPU", "%.1f MB",
+                m->device / megabyte);
+    oskar_log_value(log, 'M', 0, "Total host", "%.1f MB",
+            m->host / megabyte);
+}
+
+
+/* Times the evaluation of one channel and time sample for a sample of
+ * sources, repeated the given number of times after a warm-up pass, and
+ * returns the number of sample sources above the horizon. */
+static int time_sample(oskar_Interferometer* h, DeviceData* d,
+        const oskar_Sky* sample, int time_index, double gast, int num_reps,
+        oskar_Timer* tmr_tree, oskar_Timer* tmr_vis, int* status)
 {
     int i;
+    oskar_Sky* sky = 0;
+    for (i = 0; i <= num_reps && !*status; ++i)
+    {
+        if (i == 1)
+        {
+            reset_device_timers(d);
+            oskar_timer_start(tmr_tree);
+            oskar_timer_pause(tmr_tree);
+            oskar_timer_start(tmr_vis);
+            oskar_timer_pause(tmr_vis);
+        }
+        oskar_timer_resume(d->tmr_copy);
+        oskar_sky_copy(d->chunk, sample, status);
+        oskar_timer_pause(d->tmr_copy);
+        sky = d->chunk;
+        if (h->apply_horizon_clip)
+        {
+            oskar_timer_resume(d->tmr_clip);
+            oskar_sky_horizon_clip(d->chunk_clip, d->chunk, d->tel, gast,
+                    d->station_work, status);
+            oskar_timer_pause(d->tmr_clip);
+            sky = d->chunk_clip;
+        }
+        if (d->tree)
+        {
+            oskar_timer_resume(tmr_tree);
+            oskar_source_tree_build(d->tree, oskar_sky_num_sources(sky),
+                    oskar_sky_l_const(sky), oskar_sky_m_const(sky),
+                    oskar_sky_n_const(sky), status);
+            oskar_timer_pause(tmr_tree);
+        }
+        if (h->num_beams > 1)
+            set_beam_directions(h, d, sky, 0, status);
+        sim_baselines(h, d, sky, d->vis_block[0], 0, 0, 0, 0,
+                time_index, status);
+        oskar_timer_resume(tmr_vis);
+        oskar_vis_block_copy(d->vis_block_cpu[0][0], d->vis_block[0],
+                status);
+        oskar_timer_pause(tmr_vis);
+    }
+    return sky ? oskar_sky_num_sources(sky) : 0;
+}
+
+
+static void rechunk_sky(oskar_Interferometer* h, int max_sources,
+        int* status)
+{
+    int i, num_chunks = 0;
+    oskar_Sky** chunks = 0;
+    for (i = 0; i < h->num_sky_chunks; ++i)
+    {
+        oskar_sky_append_to_set(&num_chunks, &chunks, max_sources,
+                h->sky_chunks[i], status);
+        oskar_sky_free(h->sky_chunks[i], status);
+    }
+    free(h->sky_chunks);
+    h->sky_chunks = chunks;
+    h->num_sky_chunks = num_chunks;
+    oskar_station_beam_cache_free(h->beam_cache, status);
+    h->beam_cache = 0;
+    oskar_vis_cache_free(h->vis_cache, status);
+    h->vis_cache = 0;
+    free_vis_interpolation(h);
+    oskar_log_value(h->log, 'M', 0, "Num. chunks", "%d", h->num_sky_chunks);
+}
+
+
+static void free_device_data(oskar_Interferometer* h, int* status)
+{
+    int i, j;
     if (!h->d) return;
     for (i = 0; i < h->num_devices; ++i)
     {
@@ -1259,16 +2786,31 @@ static void free_device_data(oskar_Interferometer* h, int* status)
         oskar_timer_free(d->tmr_K);
         oskar_timer_free(d->tmr_join);
         oskar_timer_free(d->tmr_correlate);
-        oskar_vis_block_free(d->vis_block_cpu[0], status);
-        oskar_vis_block_free(d->vis_block_cpu[1], status);
-        oskar_vis_block_free(d->vis_block, status);
+        for (j = 0; d->vis_block && j < h->num_beams; ++j)
+        {
+            oskar_vis_block_free(d->vis_block_cpu[0][j], status);
+            oskar_vis_block_free(d->vis_block_cpu[1][j], status);
+            oskar_vis_block_free(d->vis_block[j], status);
+            if (d->vis_chunk)
+                oskar_vis_block_free(d->vis_chunk[j], status);
+        }
+        free(d->vis_block_cpu[0]);
+        free(d->vis_block_cpu[1]);
+        free(d->vis_block);
+        free(d->vis_chunk);
         oskar_mem_free(d->u, status);
         oskar_mem_free(d->v, status);
         oskar_mem_free(d->w, status);
         oskar_sky_free(d->chunk, status);
         oskar_sky_free(d->chunk_clip, status);
         oskar_telescope_free(d->tel, status);
+        oskar_telescope_free(d->beam_tel, status);
         oskar_station_work_free(d->station_work, status);
+        oskar_source_tree_free(d->tree, status);
+        oskar_mem_free(d->source_map, status);
+        oskar_mem_free(d->baseline_mask, status);
+        oskar_mem_free(d->cache_xc, status);
+        oskar_mem_free(d->cache_ac, status);
         oskar_jones_free(d->J, status);
         oskar_jones_free(d->E, status);
         oskar_jones_free(d->K, status);
@@ -1278,6 +2820,84 @@ static void free_device_data(oskar_Interferometer* h, int* status)
 }
 
 
+static void set_beam_directions(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, int beam_index, int* status)
+{
+    int num_failed = 0;
+    double ra0, dec0;
+    if (*status) return;
+
+    /* Point the telescope model for additional beams. */
+    ra0 = h->beam_ra_rad[beam_index];
+    dec0 = h->beam_dec_rad[beam_index];
+    if (beam_index > 0)
+        oskar_telescope_set_phase_centre(d->beam_tel,
+                OSKAR_SPHERICAL_TYPE_EQUATORIAL, ra0, dec0);
+
+    /* Recompute source direction cosines relative to the phase centre.
+     * Extended sources can only be reprojected on the CPU. */
+    oskar_sky_evaluate_relative_directions(sky, ra0, dec0, status);
+    if (oskar_sky_use_extended(sky) && oskar_sky_mem_location(sky) == OSKAR_CPU)
+        oskar_sky_evaluate_gaussian_source_parameters(sky,
+                h->zero_failed_gaussians, ra0, dec0, &num_failed, status);
+}
+
+
+static char* beam_file_name(const char* name, int beam_index)
+{
+    char* out;
+    const char* ext;
+    size_t len, base_len;
+
+    /* The first beam uses the given name. Others insert a beam suffix
+     * before the file extension, if there is one. */
+    len = strlen(name);
+    out = (char*) calloc(len + 16, 1);
+    if (beam_index == 0)
+    {
+        strcpy(out, name);
+        return out;
+    }
+    ext = strrchr(name, '.');
+    if (ext && strchr(ext, '/')) ext = 0;
+    base_len = ext ? (size_t)(ext - name) : len;
+    memcpy(out, name, base_len);
+    sprintf(out + base_len, "_beam%d%s", beam_index, ext ? ext : "");
+    return out;
+}
+
+
+static int num_leaf_elements(const oskar_Station* station)
+{
+    int i, num_elements, total = 0;
+    if (!station || oskar_station_type(station) != OSKAR_STATION_TYPE_AA)
+        return 0;
+    num_elements = oskar_station_num_elements(station);
+    if (!oskar_station_has_child(station))
+        return num_elements;
+    for (i = 0; i < num_elements; ++i)
+        total += num_leaf_elements(oskar_station_child_const(station, i));
+    return total;
+}
+
+
+static void reset_device_timers(DeviceData* d)
+{
+    oskar_timer_start(d->tmr_copy);
+    oskar_timer_start(d->tmr_clip);
+    oskar_timer_start(d->tmr_E);
+    oskar_timer_start(d->tmr_K);
+    oskar_timer_start(d->tmr_join);
+    oskar_timer_start(d->tmr_correlate);
+    oskar_timer_pause(d->tmr_copy);
+    oskar_timer_pause(d->tmr_clip);
+    oskar_timer_pause(d->tmr_E);
+    oskar_timer_pause(d->tmr_K);
+    oskar_timer_pause(d->tmr_join);
+    oskar_timer_pause(d->tmr_correlate);
+}
+
+
 static void record_timing(oskar_Interferometer* h)
 {
     /* Obtain component times. */
@@ -1323,6 +2943,28 @@ static void record_timing(oskar_Interferometer* h)
             (t_correlate / t_compute) * 100.0);
     oskar_log_value(h->log, 'M', 1, "Other", "%4.1f%%",
             ((t_compute - t_components) / t_compute) * 100.0);
+
+    /* Compare with the predicted times, averaged over devices. */
+    if (h->estimate.valid)
+    {
+        const RunTimeEstimate* e = &h->estimate;
+        const double n = (double) h->num_devices;
+        oskar_log_message(h->log, 'M', 0, "Predicted / actual per device:");
+        oskar_log_value(h->log, 'M', 1, "Copy", "%.3f s / %.3f s",
+                e->copy, t_copy / n);
+        oskar_log_value(h->log, 'M', 1, "Horizon clip", "%.3f s / %.3f s",
+                e->clip, t_clip / n);
+        oskar_log_value(h->log, 'M', 1, "Jones E", "%.3f s / %.3f s",
+                e->E, t_E / n);
+        oskar_log_value(h->log, 'M', 1, "Jones K", "%.3f s / %.3f s",
+                e->K, t_K / n);
+        oskar_log_value(h->log, 'M', 1, "Jones join", "%.3f s / %.3f s",
+                e->join, t_join / n);
+        oskar_log_value(h->log, 'M', 1, "Jones correlate", "%.3f s / %.3f s",
+                e->correlate, t_correlate / n);
+        oskar_log_value(h->log, 'M', 1, "Compute", "%.3f s / %.3f s",
+                e->compute, t_compute / n);
+    }
     free(compute_times);
 }
 
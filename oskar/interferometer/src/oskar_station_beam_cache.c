@@ -0,0 +1,567 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "interferometer/oskar_station_beam_cache.h"
+#include "interferometer/private_station_beam_cache.h"
+#include "interferometer/oskar_jones_get_station_pointer.h"
+#include "convert/oskar_convert_mjd_to_gast_fast.h"
+#include "math/oskar_cmath.h"
+#include "telescope/station/oskar_evaluate_station_beam.h"
+
+#include <limits.h>
+#include <stdlib.h>
+
+#define OMEGA_EARTH  7.272205217e-5  /* radians/sec */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static oskar_Mem* get_beam(oskar_StationBeamCache* cache, int chunk_index,
+        int channel_index, int station_class, int epoch, oskar_Sky* chunk,
+        const oskar_Telescope* tel, int type, double frequency_hz,
+        double time_start_mjd_utc, double time_inc_sec, int num_time_steps,
+        oskar_StationWork* work, oskar_StationBeamCacheEntry** entry,
+        int* status);
+static void release_beam(oskar_StationBeamCache* cache,
+        oskar_StationBeamCacheEntry* entry);
+static oskar_StationBeamCacheEntry* get_free_entry(
+        oskar_StationBeamCache* cache);
+static void evaluate_epoch(oskar_Mem* beam, oskar_Sky* chunk,
+        const oskar_Station* station, const oskar_Telescope* tel, int epoch,
+        int epoch_interval, double frequency_hz, double time_start_mjd_utc,
+        double time_inc_sec, int num_time_steps, oskar_StationWork* work,
+        int* status);
+static void interpolate(int interp_type, double f, int num_sources,
+        const int* source_map, int num_components, const oskar_Mem* b_m,
+        const oskar_Mem* b_0, const oskar_Mem* b_1, const oskar_Mem* b_2,
+        oskar_Mem* out, int* status);
+
+
+int oskar_station_beam_cache_epoch_interval(double max_drift_rad,
+        double time_inc_sec)
+{
+    double interval;
+    if (time_inc_sec <= 0.0 || max_drift_rad <= 0.0) return 1;
+    interval = floor(max_drift_rad / (OMEGA_EARTH * time_inc_sec));
+    if (interval < 1.0) return 1;
+    return (interval > (double)INT_MAX) ? INT_MAX : (int) interval;
+}
+
+
+oskar_StationBeamCache* oskar_station_beam_cache_create(
+        const oskar_Telescope* tel, int interp_type, int epoch_interval,
+        int capacity, int* status)
+{
+    int i, j, num_stations;
+    oskar_StationBeamCache* cache = 0;
+    if (*status) return 0;
+
+    /* Create the structure. */
+    num_stations = oskar_telescope_num_stations(tel);
+    cache = (oskar_StationBeamCache*) calloc(1,
+            sizeof(oskar_StationBeamCache));
+    cache->interp_type = interp_type;
+    cache->epoch_interval = epoch_interval > 0 ? epoch_interval : 1;
+    cache->num_stations = num_stations;
+    cache->station_class = (int*) calloc(num_stations, sizeof(int));
+    cache->class_station = (int*) calloc(num_stations, sizeof(int));
+    cache->mutex = oskar_mutex_create();
+
+    /* Group stations with identical beams into classes. */
+    if (oskar_telescope_allow_station_beam_duplication(tel) &&
+            oskar_telescope_identical_stations(tel))
+    {
+        cache->num_classes = num_stations > 0 ? 1 : 0;
+    }
+    else if (oskar_telescope_allow_station_beam_duplication(tel))
+    {
+        for (i = 0; i < num_stations; ++i)
+        {
+            const oskar_Station *a, *b;
+            a = oskar_telescope_station_const(tel, i);
+            for (j = 0; j < cache->num_classes; ++j)
+            {
+                b = oskar_telescope_station_const(tel,
+                        cache->class_station[j]);
+                if (oskar_station_lon_rad(a) == oskar_station_lon_rad(b) &&
+                        oskar_station_lat_rad(a) == oskar_station_lat_rad(b) &&
+                        !oskar_station_different(a, b, status))
+                    break;
+            }
+            if (j == cache->num_classes)
+                cache->class_station[(cache->num_classes)++] = i;
+            cache->station_class[i] = j;
+        }
+    }
+    else
+    {
+        for (i = 0; i < num_stations; ++i)
+        {
+            cache->station_class[i] = i;
+            cache->class_station[i] = i;
+        }
+        cache->num_classes = num_stations;
+    }
+
+    /* Allocate space for the cache entries. */
+    cache->capacity = (capacity > 4 ? capacity : 4) * cache->num_classes;
+    cache->entries = (oskar_StationBeamCacheEntry**) calloc(
+            cache->capacity, sizeof(oskar_StationBeamCacheEntry*));
+    return cache;
+}
+
+
+void oskar_station_beam_cache_evaluate(oskar_StationBeamCache* cache,
+        oskar_Jones* E, int num_sources, const oskar_Mem* source_map,
+        oskar_Sky* chunk, int chunk_index, int channel_index,
+        double frequency_hz, const oskar_Telescope* tel,
+        double time_start_mjd_utc, double time_inc_sec, int num_time_steps,
+        int time_index, oskar_StationWork* work, int* status)
+{
+    int c, i, k, epoch, num_epochs, offset, type, num_components;
+    const int* map = 0;
+    double f;
+    oskar_Mem *E_st, *E_first;
+    oskar_Mem* beams[4];
+    oskar_StationBeamCacheEntry* entries[4];
+    if (*status) return;
+
+    /* Check the location and dimensions. */
+    if (oskar_jones_mem_location(E) != OSKAR_CPU ||
+            oskar_sky_mem_location(chunk) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_jones_num_stations(E) != cache->num_stations ||
+            oskar_telescope_num_stations(tel) != cache->num_stations)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (source_map)
+        map = oskar_mem_int_const(source_map, status);
+
+    /* Find the epochs surrounding the time sample. */
+    epoch = time_index / cache->epoch_interval;
+    f = (double)(time_index - epoch * cache->epoch_interval) /
+            cache->epoch_interval;
+    if (f == 0.0 || cache->interp_type == OSKAR_BEAM_INTERP_NONE)
+    {
+        num_epochs = 1;
+        offset = 0;
+        f = 0.0;
+    }
+    else if (cache->interp_type == OSKAR_BEAM_INTERP_LINEAR)
+    {
+        num_epochs = 2;
+        offset = 0;
+    }
+    else
+    {
+        num_epochs = 4;
+        offset = -1;
+    }
+    type = oskar_mem_type(oskar_jones_mem(E));
+    num_components = oskar_type_is_matrix(type) ? 4 : 1;
+
+    /* Loop over station classes. */
+    E_st = oskar_mem_create_alias(0, 0, 0, status);
+    E_first = oskar_mem_create_alias(0, 0, 0, status);
+    for (c = 0; c < cache->num_classes; ++c)
+    {
+        /* Get the beams at the epochs from the cache. */
+        for (k = 0; k < 4; ++k)
+        {
+            beams[k] = 0;
+            entries[k] = 0;
+        }
+        for (k = 0; k < num_epochs; ++k)
+            beams[k] = get_beam(cache, chunk_index, channel_index, c,
+                    epoch + offset + k, chunk, tel, type, frequency_hz,
+                    time_start_mjd_utc, time_inc_sec, num_time_steps,
+                    work, &entries[k], status);
+
+        /* Interpolate the beam for the first station in the class,
+         * and copy it to the others. */
+        oskar_jones_get_station_pointer(E_first, E,
+                cache->class_station[c], status);
+        if (num_epochs == 1)
+            interpolate(OSKAR_BEAM_INTERP_NONE, 0.0, num_sources, map,
+                    num_components, 0, beams[0], 0, 0, E_first, status);
+        else if (num_epochs == 2)
+            interpolate(OSKAR_BEAM_INTERP_LINEAR, f, num_sources, map,
+                    num_components, 0, beams[0], beams[1], 0, E_first, status);
+        else
+            interpolate(OSKAR_BEAM_INTERP_CUBIC, f, num_sources, map,
+                    num_components, beams[0], beams[1], beams[2], beams[3],
+                    E_first, status);
+        for (i = cache->class_station[c] + 1; i < cache->num_stations; ++i)
+        {
+            if (cache->station_class[i] != c) continue;
+            oskar_jones_get_station_pointer(E_st, E, i, status);
+            oskar_mem_copy_contents(E_st, E_first, 0, 0, num_sources, status);
+        }
+
+        /* Release the beams (or free them, if they were not cached). */
+        for (k = 0; k < num_epochs; ++k)
+        {
+            if (entries[k])
+                release_beam(cache, entries[k]);
+            else
+                oskar_mem_free(beams[k], status);
+        }
+    }
+    oskar_mem_free(E_st, status);
+    oskar_mem_free(E_first, status);
+}
+
+
+int oskar_station_beam_cache_num_evaluations(
+        const oskar_StationBeamCache* cache)
+{
+    return cache ? cache->num_evaluations : 0;
+}
+
+
+void oskar_station_beam_cache_free(oskar_StationBeamCache* cache,
+        int* status)
+{
+    int i;
+    if (!cache) return;
+    for (i = 0; i < cache->num_entries; ++i)
+    {
+        oskar_mem_free(cache->entries[i]->beam, status);
+        free(cache->entries[i]);
+    }
+    oskar_mutex_free(cache->mutex);
+    free(cache->entries);
+    free(cache->station_class);
+    free(cache->class_station);
+    free(cache);
+}
+
+
+static oskar_Mem* get_beam(oskar_StationBeamCache* cache, int chunk_index,
+        int channel_index, int station_class, int epoch, oskar_Sky* chunk,
+        const oskar_Telescope* tel, int type, double frequency_hz,
+        double time_start_mjd_utc, double time_inc_sec, int num_time_steps,
+        oskar_StationWork* work, oskar_StationBeamCacheEntry** entry,
+        int* status)
+{
+    int i;
+    oskar_Mem* beam = 0;
+    oskar_StationBeamCacheEntry* e = 0;
+    const oskar_Station* station;
+    *entry = 0;
+    if (*status) return 0;
+    station = oskar_telescope_station_const(tel,
+            cache->class_station[station_class]);
+
+    /* Look for the beam in the cache. */
+    oskar_mutex_lock(cache->mutex);
+    for (i = 0; i < cache->num_entries; ++i)
+    {
+        oskar_StationBeamCacheEntry* t = cache->entries[i];
+        if (t->state != OSKAR_BEAM_CACHE_EMPTY && t->epoch == epoch &&
+                t->channel == channel_index && t->chunk == chunk_index &&
+                t->station_class == station_class)
+        {
+            e = t;
+            break;
+        }
+    }
+    if (e && e->state == OSKAR_BEAM_CACHE_READY)
+    {
+        e->refs++;
+        e->last_used = ++(cache->counter);
+        oskar_mutex_unlock(cache->mutex);
+        *entry = e;
+        return e->beam;
+    }
+    else if (e)
+    {
+        /* Another thread is evaluating this beam: don't wait for it. */
+        cache->num_evaluations++;
+        oskar_mutex_unlock(cache->mutex);
+        beam = oskar_mem_create(type, OSKAR_CPU, 0, status);
+        evaluate_epoch(beam, chunk, station, tel, epoch,
+                cache->epoch_interval, frequency_hz, time_start_mjd_utc,
+                time_inc_sec, num_time_steps, work, status);
+        return beam;
+    }
+
+    /* Reserve a new cache entry. */
+    e = get_free_entry(cache);
+    e->chunk = chunk_index;
+    e->channel = channel_index;
+    e->station_class = station_class;
+    e->epoch = epoch;
+    e->state = OSKAR_BEAM_CACHE_PENDING;
+    e->refs = 1;
+    e->last_used = ++(cache->counter);
+    cache->num_evaluations++;
+    oskar_mutex_unlock(cache->mutex);
+
+    /* Evaluate the beam outside the lock. */
+    if (!e->beam)
+        e->beam = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    evaluate_epoch(e->beam, chunk, station, tel, epoch,
+            cache->epoch_interval, frequency_hz, time_start_mjd_utc,
+            time_inc_sec, num_time_steps, work, status);
+    oskar_mutex_lock(cache->mutex);
+    e->state = *status ? OSKAR_BEAM_CACHE_EMPTY : OSKAR_BEAM_CACHE_READY;
+    oskar_mutex_unlock(cache->mutex);
+    *entry = e;
+    return e->beam;
+}
+
+
+static void release_beam(oskar_StationBeamCache* cache,
+        oskar_StationBeamCacheEntry* entry)
+{
+    oskar_mutex_lock(cache->mutex);
+    entry->refs--;
+    oskar_mutex_unlock(cache->mutex);
+}
+
+
+/* Must be called with the cache mutex locked. */
+static oskar_StationBeamCacheEntry* get_free_entry(
+        oskar_StationBeamCache* cache)
+{
+    int i;
+    oskar_StationBeamCacheEntry *e = 0, *t;
+
+    /* Use an empty entry, or the least recently used entry if full. */
+    for (i = 0; i < cache->num_entries; ++i)
+    {
+        t = cache->entries[i];
+        if (t->refs > 0) continue;
+        if (t->state == OSKAR_BEAM_CACHE_EMPTY) return t;
+        if (!e || t->last_used < e->last_used) e = t;
+    }
+    if (e && cache->num_entries == cache->capacity) return e;
+
+    /* Add a new entry, expanding the cache if all entries are in use. */
+    if (cache->num_entries == cache->capacity)
+    {
+        cache->capacity *= 2;
+        cache->entries = (oskar_StationBeamCacheEntry**) realloc(
+                cache->entries,
+                cache->capacity * sizeof(oskar_StationBeamCacheEntry*));
+    }
+    e = (oskar_StationBeamCacheEntry*) calloc(1,
+            sizeof(oskar_StationBeamCacheEntry));
+    cache->entries[(cache->num_entries)++] = e;
+    return e;
+}
+
+
+static void evaluate_epoch(oskar_Mem* beam, oskar_Sky* chunk,
+        const oskar_Station* station, const oskar_Telescope* tel, int epoch,
+        int epoch_interval, double frequency_hz, double time_start_mjd_utc,
+        double time_inc_sec, int num_time_steps, oskar_StationWork* work,
+        int* status)
+{
+    int num_sources, time_index;
+    double gast, mjd;
+    if (*status) return;
+
+    /* Get the time of the epoch, which may lie outside the observation. */
+    time_index = epoch * epoch_interval;
+    mjd = time_start_mjd_utc + (time_index + 0.5) * time_inc_sec / 86400.0;
+    gast = oskar_convert_mjd_to_gast_fast(mjd);
+    if (time_index < 0) time_index = 0;
+    if (time_index >= num_time_steps) time_index = num_time_steps - 1;
+
+    /* Evaluate the beam for all sources in the chunk. */
+    num_sources = oskar_sky_num_sources(chunk);
+    if ((int)oskar_mem_length(beam) < num_sources + 1)
+        oskar_mem_realloc(beam, num_sources + 1, status);
+    oskar_evaluate_station_beam(beam, num_sources, OSKAR_RELATIVE_DIRECTIONS,
+            oskar_sky_l(chunk), oskar_sky_m(chunk), oskar_sky_n(chunk),
+            oskar_telescope_phase_centre_ra_rad(tel),
+            oskar_telescope_phase_centre_dec_rad(tel),
+            station, work, time_index, frequency_hz, gast, status);
+}
+
+
+/* Catmull-Rom spline through p_m, p_0, p_1, p_2, evaluated at f in [0, 1]. */
+#define CUBIC(F, P_M, P_0, P_1, P_2) (0.5 * (2.0 * (P_0) +                  \
+        (F) * (((P_1) - (P_M)) +                                           \
+        (F) * ((2.0 * (P_M) - 5.0 * (P_0) + 4.0 * (P_1) - (P_2)) +         \
+        (F) * (3.0 * ((P_0) - (P_1)) + (P_2) - (P_M))))))
+
+/* Phase of a * conj(b). */
+#define PHASE_DIFF(A, B) atan2(A[1] * B[0] - A[0] * B[1],                   \
+        A[0] * B[0] + A[1] * B[1])
+
+/* Interpolates a complex value using its amplitude and unwrapped phase. */
+static void interpolate_complex(int interp_type, double f,
+        const double* z_m, const double* z_0, const double* z_1,
+        const double* z_2, double* out)
+{
+    int cubic;
+    double a_m = 0.0, a_0, a_1, a_2 = 0.0, a, p, d_m = 0.0, d_1, d_2 = 0.0;
+    double re, im, s, c;
+    const double max_step = M_PI / 2.0;
+    cubic = (interp_type == OSKAR_BEAM_INTERP_CUBIC);
+    a_0 = sqrt(z_0[0] * z_0[0] + z_0[1] * z_0[1]);
+    a_1 = sqrt(z_1[0] * z_1[0] + z_1[1] * z_1[1]);
+    d_1 = PHASE_DIFF(z_1, z_0);
+    if (cubic)
+    {
+        a_m = sqrt(z_m[0] * z_m[0] + z_m[1] * z_m[1]);
+        a_2 = sqrt(z_2[0] * z_2[0] + z_2[1] * z_2[1]);
+        d_m = PHASE_DIFF(z_0, z_m);
+        d_2 = PHASE_DIFF(z_2, z_1);
+    }
+
+    /* Interpolate complex values directly if the phase is undefined,
+     * or if it jumps between epochs (the response passes close to a null,
+     * where the unwrapped phase is not a smooth function of time). */
+    if (a_0 == 0.0 || a_1 == 0.0 || fabs(d_1) > max_step || (cubic &&
+            (a_m == 0.0 || a_2 == 0.0 ||
+            fabs(d_m) > max_step || fabs(d_2) > max_step)))
+    {
+        if (cubic)
+        {
+            out[0] = CUBIC(f, z_m[0], z_0[0], z_1[0], z_2[0]);
+            out[1] = CUBIC(f, z_m[1], z_0[1], z_1[1], z_2[1]);
+        }
+        else
+        {
+            out[0] = z_0[0] + f * (z_1[0] - z_0[0]);
+            out[1] = z_0[1] + f * (z_1[1] - z_0[1]);
+        }
+        return;
+    }
+
+    /* Interpolate the amplitude and the phase relative to the first epoch. */
+    if (cubic)
+    {
+        a = CUBIC(f, a_m, a_0, a_1, a_2);
+        p = CUBIC(f, -d_m, 0.0, d_1, d_1 + d_2);
+        if (a < 0.0) a = 0.0;
+    }
+    else
+    {
+        a = a_0 + f * (a_1 - a_0);
+        p = f * d_1;
+    }
+
+    /* Rotate and scale the value at the first epoch. */
+    s = sin(p);
+    c = cos(p);
+    a /= a_0;
+    re = z_0[0] * c - z_0[1] * s;
+    im = z_0[0] * s + z_0[1] * c;
+    out[0] = a * re;
+    out[1] = a * im;
+}
+
+
+static void interpolate(int interp_type, double f, int num_sources,
+        const int* source_map, int num_components, const oskar_Mem* b_m,
+        const oskar_Mem* b_0, const oskar_Mem* b_1, const oskar_Mem* b_2,
+        oskar_Mem* out, int* status)
+{
+    int i, j, k, n_in;
+    const void *p_m = 0, *p_0, *p_1 = 0, *p_2 = 0;
+    void* p_out;
+    if (*status) return;
+    p_out = oskar_mem_void(out);
+    p_0 = oskar_mem_void_const(b_0);
+    if (b_1) p_1 = oskar_mem_void_const(b_1);
+    if (b_m) p_m = oskar_mem_void_const(b_m);
+    if (b_2) p_2 = oskar_mem_void_const(b_2);
+    n_in = 2 * num_components;
+    if (oskar_mem_is_double(out))
+    {
+        double *o = (double*) p_out;
+        const double *z_m = (const double*) p_m, *z_0 = (const double*) p_0;
+        const double *z_1 = (const double*) p_1, *z_2 = (const double*) p_2;
+        for (i = 0; i < num_sources; ++i)
+        {
+            const int s = source_map ? source_map[i] : i;
+            for (j = 0; j < num_components; ++j)
+            {
+                const int o_in = s * n_in + 2 * j;
+                const int o_out = i * n_in + 2 * j;
+                if (interp_type == OSKAR_BEAM_INTERP_NONE)
+                {
+                    o[o_out] = z_0[o_in];
+                    o[o_out + 1] = z_0[o_in + 1];
+                    continue;
+                }
+                interpolate_complex(interp_type, f, z_m ? z_m + o_in : 0,
+                        z_0 + o_in, z_1 + o_in, z_2 ? z_2 + o_in : 0,
+                        o + o_out);
+            }
+        }
+    }
+    else
+    {
+        float *o = (float*) p_out;
+        const float *z_m = (const float*) p_m, *z_0 = (const float*) p_0;
+        const float *z_1 = (const float*) p_1, *z_2 = (const float*) p_2;
+        for (i = 0; i < num_sources; ++i)
+        {
+            const int s = source_map ? source_map[i] : i;
+            for (j = 0; j < num_components; ++j)
+            {
+                double t_m[2] = {0.0, 0.0}, t_0[2], t_1[2] = {0.0, 0.0};
+                double t_2[2] = {0.0, 0.0}, t_out[2];
+                const int o_in = s * n_in + 2 * j;
+                const int o_out = i * n_in + 2 * j;
+                if (interp_type == OSKAR_BEAM_INTERP_NONE)
+                {
+                    o[o_out] = z_0[o_in];
+                    o[o_out + 1] = z_0[o_in + 1];
+                    continue;
+                }
+                for (k = 0; k < 2; ++k)
+                {
+                    t_0[k] = z_0[o_in + k];
+                    t_1[k] = z_1[o_in + k];
+                    if (z_m) t_m[k] = z_m[o_in + k];
+                    if (z_2) t_2[k] = z_2[o_in + k];
+                }
+                interpolate_complex(interp_type, f, t_m, t_0, t_1, t_2, t_out);
+                o[o_out] = (float) t_out[0];
+                o[o_out + 1] = (float) t_out[1];
+            }
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
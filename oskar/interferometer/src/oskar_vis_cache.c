@@ -0,0 +1,613 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "interferometer/oskar_vis_cache.h"
+#include "interferometer/private_vis_cache.h"
+#include "binary/oskar_crc.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "utility/oskar_dir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Maximum number of file handles to keep open at once. */
+#define MAX_OPEN_FILES 64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const char* group = "vis_cache";
+
+static oskar_Binary* get_file(oskar_VisCache* cache, int chunk_index,
+        char mode, int* status);
+static void close_file(oskar_VisCache* cache, oskar_VisCacheChunk* chunk);
+static char* file_name(const oskar_VisCache* cache, int chunk_index);
+static unsigned long hash_int(const oskar_CRC* crc_data, unsigned long crc,
+        int value);
+static unsigned long hash_double(const oskar_CRC* crc_data,
+        unsigned long crc, double value);
+static unsigned long hash_mem(const oskar_CRC* crc_data, unsigned long crc,
+        const oskar_Mem* mem, size_t num_elements, int* status);
+static unsigned long hash_splines(const oskar_CRC* crc_data,
+        unsigned long crc, const oskar_Splines* splines, int* status);
+static unsigned long hash_station(const oskar_CRC* crc_data,
+        unsigned long crc, const oskar_Station* station, int* status);
+
+
+oskar_VisCache* oskar_vis_cache_create(const char* dir, int num_chunks,
+        int num_records, unsigned int telescope_hash,
+        unsigned int observation_hash, unsigned int settings_hash,
+        int* status)
+{
+    oskar_VisCache* cache;
+    if (*status) return 0;
+    if (!dir || strlen(dir) == 0 || num_chunks < 0 || num_records < 1)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return 0;
+    }
+
+    /* Create the cache directory if it does not exist. */
+    if (!oskar_dir_exists(dir) && !oskar_dir_mkpath(dir))
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return 0;
+    }
+
+    /* Allocate and initialise the cache. */
+    cache = (oskar_VisCache*) calloc(1, sizeof(oskar_VisCache));
+    if (!cache)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    cache->dir = (char*) calloc(1 + strlen(dir), sizeof(char));
+    cache->chunks = (oskar_VisCacheChunk*) calloc(num_chunks > 0 ?
+            num_chunks : 1, sizeof(oskar_VisCacheChunk));
+    if (!cache->dir || !cache->chunks)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        free(cache->dir);
+        free(cache->chunks);
+        free(cache);
+        return 0;
+    }
+    strcpy(cache->dir, dir);
+    cache->num_chunks = num_chunks;
+    cache->num_records = num_records;
+    cache->telescope_hash = telescope_hash;
+    cache->observation_hash = observation_hash;
+    cache->settings_hash = settings_hash;
+    cache->mutex = oskar_mutex_create();
+    return cache;
+}
+
+
+int oskar_vis_cache_check_chunk(oskar_VisCache* cache, int chunk_index,
+        const oskar_Sky* chunk, int* status)
+{
+    oskar_VisCacheChunk* c;
+    oskar_Binary* file;
+    char* filename;
+    int i, values[6], local_status = 0;
+    const char* names[] = {"telescope_hash", "observation_hash",
+            "settings_hash", "sky_hash", "num_sources", "complete"};
+    if (*status) return 0;
+    if (chunk_index < 0 || chunk_index >= cache->num_chunks)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return 0;
+    }
+
+    /* Store the hash of the current sources in the chunk. */
+    c = &cache->chunks[chunk_index];
+    close_file(cache, c);
+    if (c->cached) cache->num_cached--;
+    c->cached = 0;
+    c->created = 0;
+    c->num_written = 0;
+    c->num_sources = oskar_sky_num_sources(chunk);
+    c->sky_hash = oskar_vis_cache_hash_sky(chunk, status);
+    if (*status) return 0;
+
+    /* Read the hashes stored in the file, if it exists. */
+    filename = file_name(cache, chunk_index);
+    file = oskar_binary_create(filename, 'r', &local_status);
+    free(filename);
+    for (i = 0; i < 6; ++i)
+        oskar_binary_read_ext_int(file, group, names[i], 0,
+                &values[i], &local_status);
+    oskar_binary_free(file);
+    if (local_status) return 0;
+
+    /* Check that the file is complete and that all hashes match. */
+    c->cached = ((unsigned int) values[0] == cache->telescope_hash &&
+            (unsigned int) values[1] == cache->observation_hash &&
+            (unsigned int) values[2] == cache->settings_hash &&
+            (unsigned int) values[3] == c->sky_hash &&
+            values[4] == c->num_sources && values[5] == cache->num_records);
+    if (c->cached) cache->num_cached++;
+    return c->cached;
+}
+
+
+int oskar_vis_cache_chunk_cached(const oskar_VisCache* cache,
+        int chunk_index)
+{
+    if (!cache || chunk_index < 0 || chunk_index >= cache->num_chunks)
+        return 0;
+    return cache->chunks[chunk_index].cached;
+}
+
+
+int oskar_vis_cache_num_cached(const oskar_VisCache* cache)
+{
+    return cache ? cache->num_cached : 0;
+}
+
+
+void oskar_vis_cache_read(oskar_VisCache* cache, int chunk_index,
+        int record_index, oskar_Mem* cross, oskar_Mem* autos, int* status)
+{
+    oskar_Binary* file;
+    if (*status) return;
+    if (chunk_index < 0 || chunk_index >= cache->num_chunks ||
+            record_index < 0 || record_index >= cache->num_records)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
+    oskar_mutex_lock(cache->mutex);
+    file = get_file(cache, chunk_index, 'r', status);
+    if (cross)
+        oskar_binary_read_mem_ext(file, cross, group, "cross",
+                record_index, status);
+    if (autos)
+        oskar_binary_read_mem_ext(file, autos, group, "auto",
+                record_index, status);
+    oskar_mutex_unlock(cache->mutex);
+}
+
+
+void oskar_vis_cache_write(oskar_VisCache* cache, int chunk_index,
+        int record_index, const oskar_Mem* cross, const oskar_Mem* autos,
+        int* status)
+{
+    oskar_Binary* file;
+    if (*status) return;
+    if (chunk_index < 0 || chunk_index >= cache->num_chunks ||
+            record_index < 0 || record_index >= cache->num_records)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
+    oskar_mutex_lock(cache->mutex);
+    file = get_file(cache, chunk_index, 'w', status);
+    if (cross)
+        oskar_binary_write_mem_ext(file, cross, group, "cross",
+                record_index, 0, status);
+    if (autos)
+        oskar_binary_write_mem_ext(file, autos, group, "auto",
+                record_index, 0, status);
+    if (!*status)
+        cache->chunks[chunk_index].num_written++;
+    oskar_mutex_unlock(cache->mutex);
+}
+
+
+unsigned int oskar_vis_cache_hash_sky(const oskar_Sky* sky, int* status)
+{
+    oskar_CRC* crc_data;
+    unsigned long crc = 0;
+    size_t num_sources, num_spectral;
+    if (*status) return 0;
+    num_sources = (size_t) oskar_sky_num_sources(sky);
+    num_spectral = (size_t) oskar_sky_num_spectral_channels(sky);
+    crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    crc = hash_int(crc_data, crc, oskar_sky_precision(sky));
+    crc = hash_int(crc_data, crc, (int) num_sources);
+    crc = hash_mem(crc_data, crc, oskar_sky_ra_rad_const(sky),
+            num_sources, status);
+    crc = hash_mem(crc_data, crc, oskar_sky_dec_rad_const(sky),
+            num_sources, status);
+    crc = hash_mem(crc_data, crc, oskar_sky_I_const(sky),
+            num_sources, status);
+    crc = hash_mem(crc_data, crc, oskar_sky_Q_const(sky),
+            num_sources, status);
+    crc = hash_mem(crc_data, crc, oskar_sky_U_const(sky),
+            num_sources, status);
+    crc = hash_mem(crc_data, crc, oskar_sky_V_const(sky),
+            num_sources, status);
+    crc = hash_mem(crc_data, crc, oskar_sky_reference_freq_hz_const(sky),
+            num_sources, status);
+    crc = hash_mem(crc_data, crc, oskar_sky_spectral_index_const(sky),
+            num_sources, status);
+    crc = hash_mem(crc_data, crc, oskar_sky_rotation_measure_rad_const(sky),
+            num_sources, status);
+    crc = hash_mem(crc_data, crc, oskar_sky_fwhm_major_rad_const(sky),
+            num_sources, status);
+    crc = hash_mem(crc_data, crc, oskar_sky_fwhm_minor_rad_const(sky),
+            num_sources, status);
+    crc = hash_mem(crc_data, crc, oskar_sky_position_angle_rad_const(sky),
+            num_sources, status);
+    crc = hash_int(crc_data, crc, (int) num_spectral);
+    if (num_spectral > 0)
+    {
+        crc = hash_mem(crc_data, crc, oskar_sky_spectral_freq_hz_const(sky),
+                num_spectral, status);
+        crc = hash_mem(crc_data, crc, oskar_sky_spectral_I_const(sky),
+                num_sources * num_spectral, status);
+    }
+    oskar_crc_free(crc_data);
+    return (unsigned int) crc;
+}
+
+
+unsigned int oskar_vis_cache_hash_telescope(const oskar_Telescope* tel,
+        int* status)
+{
+    oskar_CRC* crc_data;
+    unsigned long crc = 0;
+    int i, num_stations;
+    if (*status) return 0;
+    num_stations = oskar_telescope_num_stations(tel);
+    crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    crc = hash_int(crc_data, crc, oskar_telescope_precision(tel));
+    crc = hash_int(crc_data, crc, oskar_telescope_pol_mode(tel));
+    crc = hash_double(crc_data, crc, oskar_telescope_lon_rad(tel));
+    crc = hash_double(crc_data, crc, oskar_telescope_lat_rad(tel));
+    crc = hash_double(crc_data, crc, oskar_telescope_alt_metres(tel));
+    crc = hash_double(crc_data, crc, oskar_telescope_polar_motion_x_rad(tel));
+    crc = hash_double(crc_data, crc, oskar_telescope_polar_motion_y_rad(tel));
+    crc = hash_int(crc_data, crc, oskar_telescope_phase_centre_coord_type(tel));
+    crc = hash_double(crc_data, crc, oskar_telescope_phase_centre_ra_rad(tel));
+    crc = hash_double(crc_data, crc, oskar_telescope_phase_centre_dec_rad(tel));
+    crc = hash_double(crc_data, crc, oskar_telescope_channel_bandwidth_hz(tel));
+    crc = hash_double(crc_data, crc, oskar_telescope_time_average_sec(tel));
+    crc = hash_double(crc_data, crc, oskar_telescope_uv_filter_min(tel));
+    crc = hash_double(crc_data, crc, oskar_telescope_uv_filter_max(tel));
+    crc = hash_int(crc_data, crc, oskar_telescope_uv_filter_units(tel));
+    crc = hash_int(crc_data, crc,
+            oskar_telescope_allow_station_beam_duplication(tel));
+    crc = hash_int(crc_data, crc,
+            oskar_telescope_enable_numerical_patterns(tel));
+    crc = hash_int(crc_data, crc, num_stations);
+    crc = hash_mem(crc_data, crc,
+            oskar_telescope_station_true_x_offset_ecef_metres_const(tel),
+            num_stations, status);
+    crc = hash_mem(crc_data, crc,
+            oskar_telescope_station_true_y_offset_ecef_metres_const(tel),
+            num_stations, status);
+    crc = hash_mem(crc_data, crc,
+            oskar_telescope_station_true_z_offset_ecef_metres_const(tel),
+            num_stations, status);
+    for (i = 0; i < num_stations; ++i)
+        crc = hash_station(crc_data, crc,
+                oskar_telescope_station_const(tel, i), status);
+    oskar_crc_free(crc_data);
+    return (unsigned int) crc;
+}
+
+
+void oskar_vis_cache_free(oskar_VisCache* cache, int* status)
+{
+    int i;
+    if (!cache) return;
+
+    /* Mark files that hold all records as complete. */
+    for (i = 0; i < cache->num_chunks; ++i)
+    {
+        oskar_VisCacheChunk* c;
+        c = &cache->chunks[i];
+        if (!*status && c->created && c->num_written >= cache->num_records)
+        {
+            oskar_Binary* file;
+            file = get_file(cache, i, 'w', status);
+            oskar_binary_write_ext_int(file, group, "complete", 0,
+                    cache->num_records, status);
+        }
+        close_file(cache, c);
+    }
+    oskar_mutex_free(cache->mutex);
+    free(cache->chunks);
+    free(cache->dir);
+    free(cache);
+}
+
+
+/* Private functions. */
+
+static oskar_Binary* get_file(oskar_VisCache* cache, int chunk_index,
+        char mode, int* status)
+{
+    int i;
+    char* filename;
+    oskar_VisCacheChunk* c;
+    if (*status) return 0;
+
+    /* Return the open handle if it can be used. */
+    c = &cache->chunks[chunk_index];
+    if (c->file && c->mode == mode) return c->file;
+    close_file(cache, c);
+
+    /* Limit the number of files held open. */
+    if (cache->num_open >= MAX_OPEN_FILES)
+        for (i = 0; i < cache->num_chunks; ++i)
+            close_file(cache, &cache->chunks[i]);
+
+    /* Replace the file when it is first written, and append thereafter. */
+    filename = file_name(cache, chunk_index);
+    if (mode == 'w' && c->created)
+        c->file = oskar_binary_create(filename, 'a', status);
+    else
+        c->file = oskar_binary_create(filename, mode, status);
+    free(filename);
+    if (*status) return 0;
+    c->mode = mode;
+    cache->num_open++;
+    if (mode == 'w' && !c->created)
+    {
+        c->created = 1;
+        oskar_binary_write_ext_int(c->file, group, "telescope_hash", 0,
+                (int) cache->telescope_hash, status);
+        oskar_binary_write_ext_int(c->file, group, "observation_hash", 0,
+                (int) cache->observation_hash, status);
+        oskar_binary_write_ext_int(c->file, group, "settings_hash", 0,
+                (int) cache->settings_hash, status);
+        oskar_binary_write_ext_int(c->file, group, "sky_hash", 0,
+                (int) c->sky_hash, status);
+        oskar_binary_write_ext_int(c->file, group, "num_sources", 0,
+                c->num_sources, status);
+    }
+    return c->file;
+}
+
+
+static void close_file(oskar_VisCache* cache, oskar_VisCacheChunk* chunk)
+{
+    if (!chunk->file) return;
+    oskar_binary_free(chunk->file);
+    chunk->file = 0;
+    cache->num_open--;
+}
+
+
+static char* file_name(const oskar_VisCache* cache, int chunk_index)
+{
+    char name[64];
+    sprintf(name, "vis_cache_chunk_%05d.bin", chunk_index);
+    return oskar_dir_get_path(cache->dir, name);
+}
+
+
+static unsigned long hash_int(const oskar_CRC* crc_data, unsigned long crc,
+        int value)
+{
+    return oskar_crc_update(crc_data, crc, &value, sizeof(int));
+}
+
+
+static unsigned long hash_double(const oskar_CRC* crc_data,
+        unsigned long crc, double value)
+{
+    return oskar_crc_update(crc_data, crc, &value, sizeof(double));
+}
+
+
+static unsigned long hash_mem(const oskar_CRC* crc_data, unsigned long crc,
+        const oskar_Mem* mem, size_t num_elements, int* status)
+{
+    oskar_Mem* temp = 0;
+    const oskar_Mem* data;
+    if (*status || !mem) return crc;
+    if (num_elements > oskar_mem_length(mem))
+        num_elements = oskar_mem_length(mem);
+    crc = hash_int(crc_data, crc, oskar_mem_type(mem));
+    if (num_elements == 0) return crc;
+    data = mem;
+    if (oskar_mem_location(mem) != OSKAR_CPU)
+    {
+        temp = oskar_mem_create_copy(mem, OSKAR_CPU, status);
+        data = temp;
+    }
+    if (!*status)
+        crc = oskar_crc_update(crc_data, crc, oskar_mem_void_const(data),
+                num_elements * oskar_mem_element_size(oskar_mem_type(mem)));
+    oskar_mem_free(temp, status);
+    return crc;
+}
+
+
+static unsigned long hash_splines(const oskar_CRC* crc_data,
+        unsigned long crc, const oskar_Splines* splines, int* status)
+{
+    const oskar_Mem *knots_x, *knots_y, *coeff;
+    if (*status || !splines) return crc;
+    crc = hash_int(crc_data, crc, oskar_splines_have_coeffs(splines));
+    if (!oskar_splines_have_coeffs(splines)) return crc;
+    knots_x = oskar_splines_knots_x_theta_const(splines);
+    knots_y = oskar_splines_knots_y_phi_const(splines);
+    coeff = oskar_splines_coeff_const(splines);
+    crc = hash_mem(crc_data, crc, knots_x, oskar_mem_length(knots_x), status);
+    crc = hash_mem(crc_data, crc, knots_y, oskar_mem_length(knots_y), status);
+    return hash_mem(crc_data, crc, coeff, oskar_mem_length(coeff), status);
+}
+
+
+static unsigned long hash_station(const oskar_CRC* crc_data,
+        unsigned long crc, const oskar_Station* station, int* status)
+{
+    int i, j, num_elements, num_element_types;
+    if (*status) return crc;
+
+    /* Hash the meta-data, as compared by oskar_station_different(). */
+    num_elements = oskar_station_num_elements(station);
+    num_element_types = oskar_station_num_element_types(station);
+    crc = hash_int(crc_data, crc, oskar_station_type(station));
+    crc = hash_int(crc_data, crc, oskar_station_normalise_final_beam(station));
+    crc = hash_int(crc_data, crc, oskar_station_beam_coord_type(station));
+    crc = hash_double(crc_data, crc, oskar_station_beam_lon_rad(station));
+    crc = hash_double(crc_data, crc, oskar_station_beam_lat_rad(station));
+    crc = hash_double(crc_data, crc, oskar_station_lon_rad(station));
+    crc = hash_double(crc_data, crc, oskar_station_lat_rad(station));
+    crc = hash_double(crc_data, crc, oskar_station_alt_metres(station));
+    crc = hash_double(crc_data, crc,
+            oskar_station_polar_motion_x_rad(station));
+    crc = hash_double(crc_data, crc,
+            oskar_station_polar_motion_y_rad(station));
+    crc = hash_double(crc_data, crc, oskar_station_rotation_rad(station));
+    crc = hash_int(crc_data, crc, num_elements);
+    crc = hash_int(crc_data, crc, num_element_types);
+    crc = hash_int(crc_data, crc,
+            oskar_station_normalise_array_pattern(station));
+    crc = hash_int(crc_data, crc, oskar_station_enable_array_pattern(station));
+    crc = hash_double(crc_data, crc,
+            oskar_station_array_pattern_nufft_tolerance(station));
+    crc = hash_int(crc_data, crc, oskar_station_array_is_3d(station));
+    crc = hash_int(crc_data, crc,
+            oskar_station_apply_element_errors(station));
+    crc = hash_int(crc_data, crc,
+            oskar_station_apply_element_weight(station));
+    crc = hash_int(crc_data, crc,
+            (int) oskar_station_seed_time_variable_errors(station));
+    crc = hash_double(crc_data, crc,
+            oskar_station_gaussian_beam_fwhm_rad(station));
+    crc = hash_double(crc_data, crc,
+            oskar_station_gaussian_beam_reference_freq_hz(station));
+    crc = hash_int(crc_data, crc, oskar_station_num_permitted_beams(station));
+    crc = hash_mem(crc_data, crc,
+            oskar_station_permitted_beam_az_rad_const(station),
+            oskar_station_num_permitted_beams(station), status);
+    crc = hash_mem(crc_data, crc,
+            oskar_station_permitted_beam_el_rad_const(station),
+            oskar_station_num_permitted_beams(station), status);
+
+    /* Hash the element data. */
+    crc = hash_mem(crc_data, crc,
+            oskar_station_element_true_x_enu_metres_const(station),
+            num_elements, status);
+    crc = hash_mem(crc_data, crc,
+            oskar_station_element_true_y_enu_metres_const(station),
+            num_elements, status);
+    crc = hash_mem(crc_data, crc,
+            oskar_station_element_true_z_enu_metres_const(station),
+            num_elements, status);
+    crc = hash_mem(crc_data, crc,
+            oskar_station_element_gain_const(station), num_elements, status);
+    crc = hash_mem(crc_data, crc,
+            oskar_station_element_gain_error_const(station),
+            num_elements, status);
+    crc = hash_mem(crc_data, crc,
+            oskar_station_element_phase_offset_rad_const(station),
+            num_elements, status);
+    crc = hash_mem(crc_data, crc,
+            oskar_station_element_phase_error_rad_const(station),
+            num_elements, status);
+    crc = hash_mem(crc_data, crc,
+            oskar_station_element_weight_const(station), num_elements, status);
+    crc = hash_mem(crc_data, crc,
+            oskar_station_element_types_const(station), num_elements, status);
+    if (oskar_station_element_mount_types_const(station))
+        crc = oskar_crc_update(crc_data, crc,
+                oskar_station_element_mount_types_const(station),
+                num_elements);
+    for (i = 0; i < num_elements; ++i)
+    {
+        crc = hash_double(crc_data, crc,
+                oskar_station_element_x_alpha_rad(station, i));
+        crc = hash_double(crc_data, crc,
+                oskar_station_element_x_beta_rad(station, i));
+        crc = hash_double(crc_data, crc,
+                oskar_station_element_x_gamma_rad(station, i));
+        crc = hash_double(crc_data, crc,
+                oskar_station_element_y_alpha_rad(station, i));
+        crc = hash_double(crc_data, crc,
+                oskar_station_element_y_beta_rad(station, i));
+        crc = hash_double(crc_data, crc,
+                oskar_station_element_y_gamma_rad(station, i));
+    }
+
+    /* Hash the element models. */
+    for (j = 0; oskar_station_has_element(station) &&
+            j < num_element_types; ++j)
+    {
+        const oskar_Element* e;
+        int num_freq;
+        e = oskar_station_element_const(station, j);
+        num_freq = oskar_element_num_freq(e);
+        crc = hash_int(crc_data, crc, oskar_element_type(e));
+        crc = hash_int(crc_data, crc, oskar_element_taper_type(e));
+        crc = hash_double(crc_data, crc, oskar_element_cosine_power(e));
+        crc = hash_double(crc_data, crc, oskar_element_gaussian_fwhm_rad(e));
+        crc = hash_double(crc_data, crc, oskar_element_dipole_length(e));
+        crc = hash_int(crc_data, crc, oskar_element_dipole_length_units(e));
+        crc = hash_int(crc_data, crc, num_freq);
+        if (num_freq > 0)
+            crc = oskar_crc_update(crc_data, crc,
+                    oskar_element_freqs_hz_const(e),
+                    num_freq * sizeof(double));
+        for (i = 0; i < num_freq; ++i)
+        {
+            const oskar_Splines* splines[10];
+            const oskar_Mem* sph_wave[2];
+            int k;
+            splines[0] = oskar_element_x_h_re_const(e, i);
+            splines[1] = oskar_element_x_h_im_const(e, i);
+            splines[2] = oskar_element_x_v_re_const(e, i);
+            splines[3] = oskar_element_x_v_im_const(e, i);
+            splines[4] = oskar_element_y_h_re_const(e, i);
+            splines[5] = oskar_element_y_h_im_const(e, i);
+            splines[6] = oskar_element_y_v_re_const(e, i);
+            splines[7] = oskar_element_y_v_im_const(e, i);
+            splines[8] = oskar_element_scalar_re_const(e, i);
+            splines[9] = oskar_element_scalar_im_const(e, i);
+            sph_wave[0] = oskar_element_x_spherical_wave_const(e, i);
+            sph_wave[1] = oskar_element_y_spherical_wave_const(e, i);
+            for (k = 0; k < 10; ++k)
+                crc = hash_splines(crc_data, crc, splines[k], status);
+            for (k = 0; k < 2; ++k)
+                if (sph_wave[k])
+                    crc = hash_mem(crc_data, crc, sph_wave[k],
+                            oskar_mem_length(sph_wave[k]), status);
+        }
+    }
+
+    /* Recursively hash child stations. */
+    crc = hash_int(crc_data, crc, oskar_station_has_child(station));
+    for (i = 0; oskar_station_has_child(station) && i < num_elements; ++i)
+        crc = hash_station(crc_data, crc,
+                oskar_station_child_const(station, i), status);
+    return crc;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "interferometer/oskar_vis_interpolation.h"
+#include "math/oskar_cmath.h"
+
+#include <stdlib.h>
+
+#define OMEGA_EARTH  7.272205217e-5  /* radians/sec */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_vis_interpolation_sky_extent(int num_chunks,
+        oskar_Sky* const* chunks, double ra0_rad, double dec0_rad,
+        double* l_c, double* m_c, double* n_c, double* radius, int* status)
+{
+    int c, i;
+    double s[3] = {0.0, 0.0, 0.0}, len, ra, dec, r2_max = 0.0;
+    *l_c = 0.0; *m_c = 0.0; *n_c = 1.0; *radius = 0.0;
+    if (*status) return;
+
+    /* Find the flux-weighted mean source direction. */
+    for (c = 0; c < num_chunks; ++c)
+    {
+        const oskar_Sky* sky = chunks[c];
+        const int num_sources = oskar_sky_num_sources(sky);
+        for (i = 0; i < num_sources; ++i)
+        {
+            double flux;
+            ra = oskar_mem_get_element(oskar_sky_ra_rad_const(sky), i, status);
+            dec = oskar_mem_get_element(oskar_sky_dec_rad_const(sky), i,
+                    status);
+            flux = fabs(oskar_mem_get_element(oskar_sky_I_const(sky), i,
+                    status));
+            s[0] += flux * cos(dec) * cos(ra);
+            s[1] += flux * cos(dec) * sin(ra);
+            s[2] += flux * sin(dec);
+        }
+    }
+    len = sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+    if (len > 0.0)
+    {
+        s[0] /= len; s[1] /= len; s[2] /= len;
+    }
+    else
+    {
+        s[0] = cos(dec0_rad) * cos(ra0_rad);
+        s[1] = cos(dec0_rad) * sin(ra0_rad);
+        s[2] = sin(dec0_rad);
+    }
+
+    /* Find the furthest source from the centre. */
+    for (c = 0; c < num_chunks; ++c)
+    {
+        const oskar_Sky* sky = chunks[c];
+        const int num_sources = oskar_sky_num_sources(sky);
+        for (i = 0; i < num_sources; ++i)
+        {
+            double d[3], r2;
+            ra = oskar_mem_get_element(oskar_sky_ra_rad_const(sky), i, status);
+            dec = oskar_mem_get_element(oskar_sky_dec_rad_const(sky), i,
+                    status);
+            d[0] = cos(dec) * cos(ra) - s[0];
+            d[1] = cos(dec) * sin(ra) - s[1];
+            d[2] = sin(dec) - s[2];
+            r2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+            if (r2 > r2_max) r2_max = r2;
+        }
+    }
+    *radius = sqrt(r2_max);
+
+    /* Convert the centre to direction cosines relative to the phase centre. */
+    ra = atan2(s[1], s[0]);
+    dec = asin(s[2] > 1.0 ? 1.0 : (s[2] < -1.0 ? -1.0 : s[2]));
+    *l_c = cos(dec) * sin(ra - ra0_rad);
+    *m_c = cos(dec0_rad) * sin(dec) -
+            sin(dec0_rad) * cos(dec) * cos(ra - ra0_rad);
+    *n_c = sin(dec0_rad) * sin(dec) +
+            cos(dec0_rad) * cos(dec) * cos(ra - ra0_rad);
+}
+
+
+void oskar_vis_interpolation_strides(int num_stations, const oskar_Mem* x,
+        const oskar_Mem* y, const oskar_Mem* z, double max_frequency_hz,
+        double radius, double time_inc_sec, double tolerance, int max_stride,
+        int* stride, int* status)
+{
+    int p, q, b;
+    double k;
+    if (*status) return;
+    if (oskar_mem_location(x) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Maximum fringe-stopped phase rate per metre of baseline. */
+    k = 2.0 * M_PI * OMEGA_EARTH * radius * max_frequency_hz / 299792458.0;
+    for (p = 0, b = 0; p < num_stations; ++p)
+    {
+        const double xp = oskar_mem_get_element(x, p, status);
+        const double yp = oskar_mem_get_element(y, p, status);
+        const double zp = oskar_mem_get_element(z, p, status);
+        for (q = p + 1; q < num_stations; ++q, ++b)
+        {
+            double dx, dy, dz, rate, samples;
+            int s = 1;
+            dx = oskar_mem_get_element(x, q, status) - xp;
+            dy = oskar_mem_get_element(y, q, status) - yp;
+            dz = oskar_mem_get_element(z, q, status) - zp;
+            rate = k * sqrt(dx * dx + dy * dy + dz * dz);
+
+            /* Number of samples for a phase step of sqrt(8 * tolerance). */
+            samples = (rate > 0.0) ?
+                    sqrt(8.0 * tolerance) / (rate * time_inc_sec) :
+                    (double) max_stride;
+            while (2 * s <= max_stride && 2 * s <= samples) s *= 2;
+            stride[b] = s;
+        }
+    }
+}
+
+
+int oskar_vis_interpolation_required(int stride, int time_index_block,
+        int num_times_block)
+{
+    return (stride <= 1 || time_index_block % stride == 0 ||
+            time_index_block == num_times_block - 1);
+}
+
+
+#define FILL_VIS(FP, NC) {                                                  \
+    FP* v_ = (FP*) oskar_mem_void(vis);                                    \
+    const FP *uu_ = (const FP*) oskar_mem_void_const(uu);                  \
+    const FP *vv_ = (const FP*) oskar_mem_void_const(vv);                  \
+    const FP *ww_ = (const FP*) oskar_mem_void_const(ww);                  \
+    for (b = 0; b < num_baselines; ++b)                                    \
+    {                                                                      \
+        const int s = stride[b];                                           \
+        if (s <= 1) continue;                                              \
+        for (c = 0; c < num_channels; ++c)                                 \
+        {                                                                  \
+            const double k = 2.0 * M_PI *                                  \
+                    (freq_start_hz + c * freq_inc_hz) / 299792458.0;       \
+            for (t = 0; t < num_times; ++t)                                \
+            {                                                              \
+                int t0, t1, i, j;                                          \
+                double f, ph[3], r[3][2], w[2][2];                         \
+                FP *v0, *v1, *vt;                                          \
+                if (oskar_vis_interpolation_required(s, t, num_times))     \
+                    continue;                                              \
+                t0 = (t / s) * s;                                          \
+                t1 = (t0 + s < num_times - 1) ? t0 + s : num_times - 1;    \
+                f = (double)(t - t0) / (double)(t1 - t0);                  \
+                ph[0] = k * (uu_[t0 * num_baselines + b] * l_c +           \
+                        vv_[t0 * num_baselines + b] * m_c +                \
+                        ww_[t0 * num_baselines + b] * (n_c - 1.0));        \
+                ph[1] = k * (uu_[t1 * num_baselines + b] * l_c +           \
+                        vv_[t1 * num_baselines + b] * m_c +                \
+                        ww_[t1 * num_baselines + b] * (n_c - 1.0));        \
+                ph[2] = k * (uu_[t * num_baselines + b] * l_c +            \
+                        vv_[t * num_baselines + b] * m_c +                 \
+                        ww_[t * num_baselines + b] * (n_c - 1.0));         \
+                for (i = 0; i < 3; ++i)                                    \
+                {                                                          \
+                    r[i][0] = cos(ph[i]); r[i][1] = sin(ph[i]);            \
+                }                                                          \
+                /* Combined weights: rotate to the centre at t0 and t1,  */ \
+                /* interpolate, and rotate back at t. */                   \
+                w[0][0] = (1.0 - f) * (r[2][0] * r[0][0] + r[2][1] * r[0][1]); \
+                w[0][1] = (1.0 - f) * (r[2][1] * r[0][0] - r[2][0] * r[0][1]); \
+                w[1][0] = f * (r[2][0] * r[1][0] + r[2][1] * r[1][1]);     \
+                w[1][1] = f * (r[2][1] * r[1][0] - r[2][0] * r[1][1]);     \
+                v0 = &v_[NC * ((t0 * num_channels + c) * num_baselines + b)]; \
+                v1 = &v_[NC * ((t1 * num_channels + c) * num_baselines + b)]; \
+                vt = &v_[NC * ((t * num_channels + c) * num_baselines + b)];  \
+                for (j = 0; j < NC; j += 2)                                \
+                {                                                          \
+                    vt[j] = (FP) (w[0][0] * v0[j] - w[0][1] * v0[j + 1] +  \
+                            w[1][0] * v1[j] - w[1][1] * v1[j + 1]);        \
+                    vt[j + 1] = (FP) (w[0][0] * v0[j + 1] +                \
+                            w[0][1] * v0[j] + w[1][0] * v1[j + 1] +        \
+                            w[1][1] * v1[j]);                              \
+                }                                                          \
+            }                                                              \
+        }                                                                  \
+    }                                                                      \
+    }
+
+void oskar_vis_interpolation_fill(oskar_Mem* vis, int num_times,
+        int num_channels, int num_baselines, const int* stride,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        double l_c, double m_c, double n_c, double freq_start_hz,
+        double freq_inc_hz, int* status)
+{
+    int b, c, t, num_reals;
+    if (*status || num_times < 3) return;
+    if (oskar_mem_location(vis) != OSKAR_CPU ||
+            oskar_mem_location(uu) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_mem_precision(uu) != oskar_mem_precision(vis))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if ((int)oskar_mem_length(vis) < num_times * num_channels * num_baselines
+            || (int)oskar_mem_length(uu) < num_times * num_baselines)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Visibilities on a baseline vary as exp(2 pi i (u l + v m + w (n-1))),
+     * so multiplying by the conjugate phase of the centre stops the fringe
+     * of sources near there. */
+    num_reals = oskar_mem_is_matrix(vis) ? 8 : 2;
+    if (oskar_mem_is_double(vis))
+    {
+        if (num_reals == 8) FILL_VIS(double, 8)
+        else FILL_VIS(double, 2)
+    }
+    else
+    {
+        if (num_reals == 8) FILL_VIS(float, 8)
+        else FILL_VIS(float, 2)
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "interferometer/oskar_evaluate_jones_E.h"
+#include "interferometer/oskar_evaluate_jones_E_low_rank.h"
+#include "interferometer/oskar_jones.h"
+#include "math/oskar_linspace.h"
+#include "math/oskar_meshgrid.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+
+#include "math/oskar_cmath.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Comment out this line to disable benchmark timer printing.
+// #define ALLOW_PRINTING 1
+
+#define D2R (M_PI / 180.0)
+
+static const double lat_rad = -30.0 * D2R;
+
+static double rand_gaussian()
+{
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static oskar_Telescope* create_telescope(int prec, int num_stations,
+        int station_dim, const char* element_type, double gain_std,
+        double phase_std_deg, double rotation_deg, int* status)
+{
+    oskar_Telescope* tel = oskar_telescope_create(prec, OSKAR_CPU,
+            num_stations, status);
+    std::vector<double> x_pos(station_dim);
+    std::vector<double> x(station_dim * station_dim);
+    std::vector<double> y(station_dim * station_dim);
+    oskar_linspace_d(&x_pos[0], -1.5 * (station_dim - 1),
+            1.5 * (station_dim - 1), station_dim);
+    oskar_meshgrid_d(&x[0], &y[0], &x_pos[0], station_dim,
+            &x_pos[0], station_dim);
+    srand(2);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        oskar_station_resize(s, station_dim * station_dim, status);
+        oskar_station_resize_element_types(s, 1, status);
+        oskar_station_set_position(s, 0.0, lat_rad, 0.0);
+        oskar_station_set_rotation_rad(s, rotation_deg * D2R);
+        oskar_element_set_element_type(oskar_station_element(s, 0),
+                element_type, status);
+        for (int j = 0; j < station_dim * station_dim; ++j)
+        {
+            double enu[3] = {x[j], y[j], 0.0};
+            oskar_station_set_element_coords(s, j, enu, enu, status);
+            oskar_station_set_element_errors(s, j,
+                    1.0 + gain_std * rand_gaussian(), 0.2 * gain_std,
+                    phase_std_deg * rand_gaussian(), 0.2 * phase_std_deg,
+                    status);
+        }
+    }
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_phase_centre(tel,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.0, lat_rad);
+    oskar_telescope_set_allow_station_beam_duplication(tel, OSKAR_TRUE);
+    oskar_telescope_analyse(tel, status);
+    return tel;
+}
+
+static void create_directions(int prec, int num_points, oskar_Mem** l,
+        oskar_Mem** m, oskar_Mem** n, int* status)
+{
+    *l = oskar_mem_create(prec, OSKAR_CPU, num_points + 1, status);
+    *m = oskar_mem_create(prec, OSKAR_CPU, num_points + 1, status);
+    *n = oskar_mem_create(prec, OSKAR_CPU, num_points + 1, status);
+    srand(3);
+    for (int i = 0; i < num_points; ++i)
+    {
+        double l_ = 0.3 * ((double)rand() / RAND_MAX - 0.5);
+        double m_ = 0.3 * ((double)rand() / RAND_MAX - 0.5);
+        oskar_mem_set_element_real(*l, i, l_, status);
+        oskar_mem_set_element_real(*m, i, m_, status);
+        oskar_mem_set_element_real(*n, i, sqrt(1.0 - l_*l_ - m_*m_), status);
+    }
+}
+
+static double max_abs_diff(oskar_Jones* a, oskar_Jones* b, int* status)
+{
+    double max_err = 0.0;
+    oskar_Mem *p = oskar_jones_mem(a), *q = oskar_jones_mem(b);
+    int num = (int)oskar_mem_length(p) * (oskar_mem_is_matrix(p) ? 8 : 2);
+    if (oskar_mem_is_double(p))
+    {
+        const double *p_ = oskar_mem_double_const(p, status);
+        const double *q_ = oskar_mem_double_const(q, status);
+        for (int i = 0; i < num; ++i)
+            max_err = std::max(max_err, fabs(p_[i] - q_[i]));
+    }
+    else
+    {
+        const float *p_ = oskar_mem_float_const(p, status);
+        const float *q_ = oskar_mem_float_const(q, status);
+        for (int i = 0; i < num; ++i)
+            max_err = std::max(max_err, (double) fabs(p_[i] - q_[i]));
+    }
+    return max_err;
+}
+
+static void run_test(int prec, int jones_type, const char* element_type,
+        int num_stations, int station_dim, int num_points, double gain_std,
+        double tolerance, double max_err, int max_rank,
+        double rotation_deg = 0.0)
+{
+    int status = 0, rank = -1;
+    const double freq_hz = 100e6, gast = 0.1;
+    oskar_Mem *l, *m, *n;
+    oskar_Telescope* tel = create_telescope(prec, num_stations, station_dim,
+            element_type, gain_std, 57.3 * gain_std, rotation_deg, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_FALSE(oskar_telescope_identical_stations(tel));
+    ASSERT_TRUE(oskar_evaluate_jones_E_low_rank_supported(tel, &status));
+    create_directions(prec, num_points, &l, &m, &n, &status);
+    oskar_StationWork* work = oskar_station_work_create(prec, OSKAR_CPU,
+            &status);
+    oskar_Jones* E_exact = oskar_jones_create(jones_type, OSKAR_CPU,
+            num_stations, num_points, &status);
+    oskar_Jones* E_low_rank = oskar_jones_create(jones_type, OSKAR_CPU,
+            num_stations, num_points, &status);
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+
+    // Evaluate station beams directly, and using the low-rank method.
+    oskar_timer_start(timer);
+    oskar_evaluate_jones_E(E_exact, num_points, OSKAR_RELATIVE_DIRECTIONS,
+            l, m, n, tel, gast, freq_hz, work, 0, &status);
+    double t_exact = oskar_timer_elapsed(timer);
+    oskar_timer_start(timer);
+    oskar_evaluate_jones_E_low_rank(E_low_rank, num_points, l, m, n, tel,
+            gast, freq_hz, work, 0, tolerance, &rank, &status);
+    double t_low_rank = oskar_timer_elapsed(timer);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the results.
+    double err = max_abs_diff(E_exact, E_low_rank, &status);
+    EXPECT_LT(err, max_err);
+    EXPECT_LE(rank, max_rank);
+#ifdef ALLOW_PRINTING
+    printf("Exact: %.3f s, low-rank: %.3f s (rank %d), max error %.3e\n",
+            t_exact, t_low_rank, rank, err);
+#else
+    (void) t_exact;
+    (void) t_low_rank;
+#endif
+
+    // Clean up.
+    oskar_timer_free(timer);
+    oskar_jones_free(E_exact, &status);
+    oskar_jones_free(E_low_rank, &status);
+    oskar_station_work_free(work, &status);
+    oskar_mem_free(l, &status);
+    oskar_mem_free(m, &status);
+    oskar_mem_free(n, &status);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+
+TEST(evaluate_jones_E_low_rank, full_rank_scalar_double)
+{
+    // More stations than elements.
+    run_test(OSKAR_DOUBLE, OSKAR_DOUBLE_COMPLEX, "Isotropic",
+            40, 5, 1000, 0.05, 0.0, 1e-10, 25);
+}
+
+
+TEST(evaluate_jones_E_low_rank, full_rank_matrix_double)
+{
+    // More elements than stations.
+    run_test(OSKAR_DOUBLE, OSKAR_DOUBLE_COMPLEX_MATRIX, "Dipole",
+            10, 6, 1000, 0.05, 0.0, 1e-10, 9);
+}
+
+
+TEST(evaluate_jones_E_low_rank, truncated_scalar_double)
+{
+    run_test(OSKAR_DOUBLE, OSKAR_DOUBLE_COMPLEX, "Isotropic",
+            40, 8, 2000, 0.02, 0.02, 0.05, 39);
+}
+
+
+TEST(evaluate_jones_E_low_rank, truncated_matrix_single)
+{
+    run_test(OSKAR_SINGLE, OSKAR_SINGLE_COMPLEX_MATRIX, "Dipole",
+            40, 8, 2000, 0.02, 0.01, 0.05, 39);
+}
+
+
+TEST(evaluate_jones_E_low_rank, rotated_matrix_double)
+{
+    // Stations which are rotated copies of a template.
+    run_test(OSKAR_DOUBLE, OSKAR_DOUBLE_COMPLEX_MATRIX, "Dipole",
+            10, 6, 1000, 0.05, 0.0, 1e-10, 9, 30.0);
+}
+
+
+TEST(evaluate_jones_E_low_rank, unsupported_mixed_rotation)
+{
+    // Stations with different rotations can not share a low-rank model.
+    int status = 0;
+    oskar_Telescope* tel = create_telescope(OSKAR_DOUBLE, 4, 4,
+            "Dipole", 0.05, 2.9, 0.0, &status);
+    oskar_station_set_rotation_rad(oskar_telescope_station(tel, 1), 0.5);
+    EXPECT_FALSE(oskar_evaluate_jones_E_low_rank_supported(tel, &status));
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
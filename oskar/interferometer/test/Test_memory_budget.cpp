@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "interferometer/oskar_interferometer.h"
+#include "sky/oskar_sky.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdlib>
+
+#define D2R (M_PI / 180.0)
+
+static const double lat_rad = -30.0 * D2R;
+static const int num_stations = 10;
+static const int num_sources = 1000;
+static const int num_times = 100;
+
+static oskar_Interferometer* create_simulator(double max_memory_gb,
+        int* status)
+{
+    // Create a telescope model of single-element stations.
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_stations, status);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        double enu[3] = {0.0, 0.0, 0.0};
+        oskar_station_resize(s, 1, status);
+        oskar_station_resize_element_types(s, 1, status);
+        oskar_station_set_position(s, 1e-4 * i, lat_rad, 0.0);
+        oskar_station_set_element_coords(s, 0, enu, enu, status);
+    }
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_phase_centre(tel,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.0, lat_rad);
+    oskar_telescope_set_allow_station_beam_duplication(tel, 1);
+    oskar_telescope_analyse(tel, status);
+
+    // Create a sky model.
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, status);
+    srand(1);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        double ra = 6.0 * D2R * ((double)rand() / RAND_MAX - 0.5);
+        double dec = lat_rad + 6.0 * D2R * ((double)rand() / RAND_MAX - 0.5);
+        oskar_sky_set_source(sky, i, ra, dec, 1.0, 0.0, 0.0, 0.0,
+                0.0, 0.0, 0.0, 0.0, 0.0, 0.0, status);
+    }
+
+    // Create the simulator.
+    oskar_Interferometer* h = oskar_interferometer_create(OSKAR_DOUBLE,
+            status);
+    oskar_interferometer_set_num_devices(h, 1);
+    oskar_interferometer_set_max_host_memory_gb(h, max_memory_gb);
+    oskar_interferometer_set_max_sources_per_chunk(h, num_sources);
+    oskar_interferometer_set_max_times_per_block(h, num_times);
+    oskar_interferometer_set_observation_time(h, 57000.0, 10.0, num_times);
+    oskar_interferometer_set_observation_frequency(h, 100e6, 1e6, 1);
+    oskar_interferometer_set_telescope_model(h, tel, status);
+    oskar_interferometer_set_sky_model(h, sky, status);
+    oskar_telescope_free(tel, status);
+    oskar_sky_free(sky, status);
+    return h;
+}
+
+TEST(memory_budget, no_limit)
+{
+    int status = 0;
+    oskar_Interferometer* h = create_simulator(0.0, &status);
+    oskar_interferometer_check_init(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(num_sources, oskar_interferometer_max_sources_per_chunk(h));
+    EXPECT_EQ(num_times, oskar_interferometer_max_times_per_block(h));
+    oskar_interferometer_free(h, &status);
+}
+
+TEST(memory_budget, reduce_to_fit)
+{
+    // About 4 MB are needed without a limit, so set a limit of 1 MB.
+    int status = 0;
+    oskar_Interferometer* h = create_simulator(1.0 / 1024.0, &status);
+    oskar_interferometer_check_init(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const int max_src = oskar_interferometer_max_sources_per_chunk(h);
+    const int max_times = oskar_interferometer_max_times_per_block(h);
+    EXPECT_LT(max_src, num_sources);
+    EXPECT_LT(max_times, num_times);
+    EXPECT_GE(max_src, 1);
+    EXPECT_GE(max_times, 1);
+    EXPECT_EQ(max_times, oskar_vis_header_max_times_per_block(
+            oskar_interferometer_vis_header(h)));
+    oskar_interferometer_free(h, &status);
+}
+
+TEST(memory_budget, source_aggregation)
+{
+    // About 4.3 MB are needed by default, and about 1 MB more for the
+    // source tree and its station phase factors, so set a limit in between.
+    int status = 0;
+    const double limit_gb = 4.8 / 1024.0;
+    oskar_Interferometer* h = create_simulator(limit_gb, &status);
+    oskar_interferometer_check_init(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(num_sources, oskar_interferometer_max_sources_per_chunk(h));
+    EXPECT_EQ(num_times, oskar_interferometer_max_times_per_block(h));
+    oskar_interferometer_free(h, &status);
+
+    h = create_simulator(limit_gb, &status);
+    oskar_interferometer_set_source_aggregation(h, 1, 1e-3);
+    oskar_interferometer_check_init(h, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(oskar_interferometer_max_sources_per_chunk(h) *
+            oskar_interferometer_max_times_per_block(h),
+            num_sources * num_times);
+    oskar_interferometer_free(h, &status);
+}
+
+TEST(memory_budget, fail_if_too_small)
+{
+    // The sky model alone needs more than 1 kB.
+    int status = 0;
+    oskar_Interferometer* h = create_simulator(1.0 / (1024.0 * 1024.0),
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_interferometer_check_init(h, &status);
+    EXPECT_EQ((int) OSKAR_ERR_MEMORY_ALLOC_FAILURE, status);
+    status = 0;
+    oskar_interferometer_free(h, &status);
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "interferometer/oskar_interferometer.h"
+#include "sky/oskar_sky.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdlib>
+
+#define D2R (M_PI / 180.0)
+
+static const double lat_rad = -30.0 * D2R;
+static const int num_stations = 6;
+static const int num_beams = 3;
+static const double beam_ra_rad[] = {0.0, 2.0 * D2R, -1.5 * D2R};
+static const double beam_dec_rad[] = {-30.0 * D2R, -29.0 * D2R, -31.5 * D2R};
+
+static oskar_Sky* create_sky(int num_sources, int* status)
+{
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, status);
+    srand(1);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        double ra = 8.0 * D2R * ((double)rand() / RAND_MAX - 0.5);
+        double dec = lat_rad + 8.0 * D2R * ((double)rand() / RAND_MAX - 0.5);
+        oskar_sky_set_source(sky, i, ra, dec, 1.0, 0.5, 0.0, 0.0,
+                0.0, 0.0, 0.0, 0.0, 0.0, 0.0, status);
+    }
+    return sky;
+}
+
+static oskar_Telescope* create_telescope(int* status)
+{
+    // Create stations of dipoles with different layouts, so that
+    // the element patterns are evaluated for each station beam.
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_stations, status);
+    srand(2);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        const int num_elements = 16;
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        oskar_station_resize(s, num_elements, status);
+        oskar_station_resize_element_types(s, 1, status);
+        oskar_element_set_element_type(oskar_station_element(s, 0),
+                "Dipole", status);
+        oskar_station_set_position(s, 1e-4 * i, lat_rad, 0.0);
+        oskar_station_set_normalise_final_beam(s, 1);
+        for (int j = 0; j < num_elements; ++j)
+        {
+            double enu[3];
+            enu[0] = 10.0 * ((double)rand() / RAND_MAX - 0.5);
+            enu[1] = 10.0 * ((double)rand() / RAND_MAX - 0.5);
+            enu[2] = 0.0;
+            oskar_station_set_element_coords(s, j, enu, enu, status);
+        }
+    }
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_allow_station_beam_duplication(tel, OSKAR_TRUE);
+    oskar_telescope_analyse(tel, status);
+    return tel;
+}
+
+static oskar_Interferometer* create_simulator(const oskar_Sky* sky,
+        oskar_Telescope* tel, int* status)
+{
+    oskar_Interferometer* h = oskar_interferometer_create(OSKAR_DOUBLE,
+            status);
+    oskar_interferometer_set_num_devices(h, 1);
+    oskar_interferometer_set_correlation_type(h, "Both", status);
+    oskar_interferometer_set_max_sources_per_chunk(h, 64);
+    oskar_interferometer_set_max_times_per_block(h, 2);
+    oskar_interferometer_set_observation_time(h, 57000.0, 10.0, 2);
+    oskar_interferometer_set_observation_frequency(h, 100e6, 5e6, 2);
+    oskar_interferometer_set_telescope_model(h, tel, status);
+    oskar_interferometer_set_sky_model(h, sky, status);
+    return h;
+}
+
+static void check_same(const oskar_Mem* a, const oskar_Mem* b, int* status)
+{
+    const double* p0 = oskar_mem_double_const(a, status);
+    const double* p1 = oskar_mem_double_const(b, status);
+    double diff = 0.0, max_abs = 0.0;
+    ASSERT_EQ(oskar_mem_length(a), oskar_mem_length(b));
+    for (size_t i = 0; i < 2 * oskar_mem_length(a); ++i)
+    {
+        if (fabs(p0[i] - p1[i]) > diff) diff = fabs(p0[i] - p1[i]);
+        if (fabs(p0[i]) > max_abs) max_abs = fabs(p0[i]);
+    }
+    EXPECT_GT(max_abs, 0.0);
+    EXPECT_LT(diff, 1e-10 * max_abs);
+}
+
+TEST(interferometer, multiple_beams_match_single_beams)
+{
+    int status = 0;
+    oskar_Sky* sky = create_sky(150, &status);
+    oskar_Telescope* tel = create_telescope(&status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Simulate all beams in one run.
+    oskar_telescope_set_phase_centre(tel, OSKAR_SPHERICAL_TYPE_EQUATORIAL,
+            beam_ra_rad[0], beam_dec_rad[0]);
+    oskar_Interferometer* multi = create_simulator(sky, tel, &status);
+    oskar_interferometer_set_additional_beams(multi, num_beams - 1,
+            &beam_ra_rad[1], &beam_dec_rad[1], &status);
+    oskar_interferometer_check_init(multi, &status);
+    oskar_interferometer_reset_work_unit_index(multi);
+    oskar_interferometer_run_block(multi, 0, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_beams, oskar_interferometer_num_beams(multi));
+
+    // Compare each beam with a separate single-beam run.
+    for (int i = 0; i < num_beams; ++i)
+    {
+        oskar_telescope_set_phase_centre(tel,
+                OSKAR_SPHERICAL_TYPE_EQUATORIAL,
+                beam_ra_rad[i], beam_dec_rad[i]);
+        oskar_Interferometer* single = create_simulator(sky, tel, &status);
+        oskar_interferometer_check_init(single, &status);
+        oskar_interferometer_reset_work_unit_index(single);
+        oskar_interferometer_run_block(single, 0, 0, &status);
+        oskar_VisBlock* b0 = oskar_interferometer_finalise_beam_block(
+                multi, i, 0, &status);
+        oskar_VisBlock* b1 = oskar_interferometer_finalise_block(
+                single, 0, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        check_same(oskar_vis_block_cross_correlations_const(b0),
+                oskar_vis_block_cross_correlations_const(b1), &status);
+        check_same(oskar_vis_block_auto_correlations_const(b0),
+                oskar_vis_block_auto_correlations_const(b1), &status);
+        oskar_interferometer_free(single, &status);
+    }
+
+    // Clean up.
+    oskar_interferometer_free(multi, &status);
+    oskar_telescope_free(tel, &status);
+    oskar_sky_free(sky, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
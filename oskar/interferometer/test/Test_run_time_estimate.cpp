@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "interferometer/oskar_interferometer.h"
+#include "sky/oskar_sky.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdlib>
+
+#define D2R (M_PI / 180.0)
+
+static const double lat_rad = -30.0 * D2R;
+static const int num_stations = 10;
+static const int num_sources = 200;
+static const int num_times = 8;
+
+static oskar_Interferometer* create_simulator(int aggregate, int* status)
+{
+    // Create a telescope model of single-element stations.
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_stations, status);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        double enu[3] = {0.0, 0.0, 0.0};
+        oskar_station_resize(s, 1, status);
+        oskar_station_resize_element_types(s, 1, status);
+        oskar_station_set_position(s, 1e-4 * i, lat_rad, 0.0);
+        oskar_station_set_element_coords(s, 0, enu, enu, status);
+    }
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_phase_centre(tel,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.0, lat_rad);
+    oskar_telescope_set_allow_station_beam_duplication(tel, aggregate);
+    oskar_telescope_analyse(tel, status);
+
+    // Create a sky model.
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, status);
+    srand(1);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        double ra = 6.0 * D2R * ((double)rand() / RAND_MAX - 0.5);
+        double dec = lat_rad + 6.0 * D2R * ((double)rand() / RAND_MAX - 0.5);
+        oskar_sky_set_source(sky, i, ra, dec, 1.0, 0.0, 0.0, 0.0,
+                0.0, 0.0, 0.0, 0.0, 0.0, 0.0, status);
+    }
+
+    // Create the simulator.
+    oskar_Interferometer* h = oskar_interferometer_create(OSKAR_DOUBLE,
+            status);
+    oskar_interferometer_set_num_devices(h, 1);
+    oskar_interferometer_set_max_sources_per_chunk(h, num_sources);
+    oskar_interferometer_set_max_times_per_block(h, num_times);
+    oskar_interferometer_set_observation_time(h, 57000.0, 10.0, num_times);
+    oskar_interferometer_set_observation_frequency(h, 100e6, 1e6, 2);
+    oskar_interferometer_set_telescope_model(h, tel, status);
+    oskar_interferometer_set_sky_model(h, sky, status);
+    oskar_interferometer_set_source_aggregation(h, aggregate, 1e-3);
+    oskar_telescope_free(tel, status);
+    oskar_sky_free(sky, status);
+    return h;
+}
+
+static oskar_VisBlock* simulate_block(oskar_Interferometer* h, int* status)
+{
+    oskar_interferometer_check_init(h, status);
+    oskar_interferometer_reset_work_unit_index(h);
+    oskar_interferometer_run_block(h, 0, 0, status);
+    return oskar_interferometer_finalise_block(h, 0, status);
+}
+
+static void check_visibilities(int aggregate)
+{
+    // Simulate the same block with and without a run time estimate first.
+    int status = 0;
+    oskar_Interferometer* h0 = create_simulator(aggregate, &status);
+    oskar_Interferometer* h1 = create_simulator(aggregate, &status);
+    oskar_interferometer_estimate_run_time(h1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_VisBlock* b0 = simulate_block(h0, &status);
+    oskar_VisBlock* b1 = simulate_block(h1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the visibilities are identical.
+    const oskar_Mem* v0 = oskar_vis_block_cross_correlations_const(b0);
+    const oskar_Mem* v1 = oskar_vis_block_cross_correlations_const(b1);
+    ASSERT_EQ(oskar_mem_length(v0), oskar_mem_length(v1));
+    const double* p0 = oskar_mem_double_const(v0, &status);
+    const double* p1 = oskar_mem_double_const(v1, &status);
+    double max_abs = 0.0;
+    for (size_t i = 0; i < 2 * oskar_mem_length(v0); ++i)
+    {
+        EXPECT_DOUBLE_EQ(p0[i], p1[i]);
+        if (fabs(p0[i]) > max_abs) max_abs = fabs(p0[i]);
+    }
+    EXPECT_GT(max_abs, 0.0);
+    oskar_interferometer_free(h0, &status);
+    oskar_interferometer_free(h1, &status);
+}
+
+TEST(run_time_estimate, does_not_change_visibilities)
+{
+    check_visibilities(0);
+}
+
+TEST(run_time_estimate, does_not_change_aggregated_visibilities)
+{
+    // This also fits the scaling of the correlation time with sources.
+    check_visibilities(1);
+}
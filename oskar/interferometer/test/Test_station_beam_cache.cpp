@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "convert/oskar_convert_mjd_to_gast_fast.h"
+#include "interferometer/oskar_evaluate_jones_E.h"
+#include "interferometer/oskar_jones.h"
+#include "interferometer/oskar_station_beam_cache.h"
+#include "math/oskar_linspace.h"
+#include "math/oskar_meshgrid.h"
+#include "sky/oskar_sky.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#define D2R (M_PI / 180.0)
+
+static const double lat_rad = -30.0 * D2R;
+static const double t_start = 57000.0;
+static const double t_inc_sec = 10.0;
+static const int num_times = 120;
+
+static oskar_Telescope* create_telescope(int type, int num_stations,
+        int different, int* status)
+{
+    const int station_dim = 8;
+    oskar_Telescope* tel = oskar_telescope_create(type, OSKAR_CPU,
+            num_stations, status);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        oskar_station_resize(s, station_dim * station_dim, status);
+        oskar_station_resize_element_types(s, 1, status);
+        oskar_station_set_position(s, 0.0, lat_rad, 0.0);
+        oskar_element_set_element_type(oskar_station_element(s, 0),
+                "Isotropic", status);
+
+        // Make every second station larger if required.
+        double size = (different && (i % 2)) ? 50.0 : 35.0;
+        std::vector<double> x_pos(station_dim);
+        std::vector<double> x(station_dim * station_dim);
+        std::vector<double> y(station_dim * station_dim);
+        oskar_linspace_d(&x_pos[0], -size / 2.0, size / 2.0, station_dim);
+        oskar_meshgrid_d(&x[0], &y[0], &x_pos[0], station_dim,
+                &x_pos[0], station_dim);
+        for (int j = 0; j < station_dim * station_dim; ++j)
+        {
+            double enu[3] = {x[j], y[j], 0.0};
+            oskar_station_set_element_coords(s, j, enu, enu, status);
+        }
+    }
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_phase_centre(tel,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.0, lat_rad);
+    oskar_telescope_set_allow_station_beam_duplication(tel, OSKAR_TRUE);
+    oskar_telescope_analyse(tel, status);
+    return tel;
+}
+
+static oskar_Sky* create_sky(int type, int num_sources, int* status)
+{
+    oskar_Sky* sky = oskar_sky_create(type, OSKAR_CPU, num_sources, status);
+    srand(1);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        double ra = 0.0 + 6.0 * D2R * ((double)rand() / RAND_MAX - 0.5);
+        double dec = lat_rad + 6.0 * D2R * ((double)rand() / RAND_MAX - 0.5);
+        oskar_sky_set_source(sky, i, ra, dec, 1.0, 0.0, 0.0, 0.0,
+                0.0, 0.0, 0.0, 0.0, 0.0, 0.0, status);
+    }
+    oskar_sky_evaluate_relative_directions(sky, 0.0, lat_rad, status);
+    return sky;
+}
+
+// Returns the maximum absolute difference between interpolated beams
+// and beams evaluated directly at every time.
+static double run_interpolation(int type, int jones_type, int interp_type,
+        int different, double max_drift_rad, int use_map, int* num_evaluations)
+{
+    int status = 0;
+    const int num_stations = 3, num_sources = 200;
+    const double freq_hz = 100e6;
+    oskar_Telescope* tel = create_telescope(type, num_stations, different,
+            &status);
+    oskar_Sky* sky = create_sky(type, num_sources, &status);
+    oskar_StationWork* work = oskar_station_work_create(type, OSKAR_CPU,
+            &status);
+    int interval = oskar_station_beam_cache_epoch_interval(max_drift_rad,
+            t_inc_sec);
+    oskar_StationBeamCache* cache = oskar_station_beam_cache_create(tel,
+            interp_type, interval, 4, &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Use every second source if using a source map.
+    int num_out = use_map ? num_sources / 2 : num_sources;
+    oskar_Mem* map = oskar_mem_create(OSKAR_INT, OSKAR_CPU, num_out, &status);
+    int* map_ = oskar_mem_int(map, &status);
+    for (int i = 0; i < num_out; ++i)
+        map_[i] = use_map ? 2 * i : i;
+    oskar_Sky* sky_out = oskar_sky_create(type, OSKAR_CPU, num_out, &status);
+    for (int i = 0; i < num_out; ++i)
+    {
+        oskar_mem_copy_contents(oskar_sky_l(sky_out), oskar_sky_l(sky),
+                i, map_[i], 1, &status);
+        oskar_mem_copy_contents(oskar_sky_m(sky_out), oskar_sky_m(sky),
+                i, map_[i], 1, &status);
+        oskar_mem_copy_contents(oskar_sky_n(sky_out), oskar_sky_n(sky),
+                i, map_[i], 1, &status);
+    }
+
+    oskar_Jones* E_direct = oskar_jones_create(jones_type, OSKAR_CPU,
+            num_stations, num_out, &status);
+    oskar_Jones* E_interp = oskar_jones_create(jones_type, OSKAR_CPU,
+            num_stations, num_out, &status);
+    double max_err = 0.0;
+    for (int t = 0; t < num_times; ++t)
+    {
+        double mjd = t_start + (t + 0.5) * t_inc_sec / 86400.0;
+        double gast = oskar_convert_mjd_to_gast_fast(mjd);
+        oskar_evaluate_jones_E(E_direct, num_out, OSKAR_RELATIVE_DIRECTIONS,
+                oskar_sky_l(sky_out), oskar_sky_m(sky_out),
+                oskar_sky_n(sky_out), tel, gast, freq_hz, work, t, &status);
+        oskar_station_beam_cache_evaluate(cache, E_interp, num_out,
+                use_map ? map : 0, sky, 0, 0, freq_hz, tel, t_start,
+                t_inc_sec, num_times, t, work, &status);
+        EXPECT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Compare the results.
+        oskar_Mem* a = oskar_jones_mem(E_direct);
+        oskar_Mem* b = oskar_jones_mem(E_interp);
+        int num_values = num_stations * num_out *
+                (oskar_mem_is_matrix(a) ? 8 : 2);
+        if (oskar_mem_is_double(a))
+        {
+            const double* p = oskar_mem_double_const(a, &status);
+            const double* q = oskar_mem_double_const(b, &status);
+            for (int i = 0; i < num_values; ++i)
+                max_err = std::max(max_err, fabs(p[i] - q[i]));
+        }
+        else
+        {
+            const float* p = oskar_mem_float_const(a, &status);
+            const float* q = oskar_mem_float_const(b, &status);
+            for (int i = 0; i < num_values; ++i)
+                max_err = std::max(max_err, (double) fabs(p[i] - q[i]));
+        }
+    }
+    *num_evaluations = oskar_station_beam_cache_num_evaluations(cache);
+
+    // Clean up.
+    oskar_jones_free(E_direct, &status);
+    oskar_jones_free(E_interp, &status);
+    oskar_mem_free(map, &status);
+    oskar_sky_free(sky, &status);
+    oskar_sky_free(sky_out, &status);
+    oskar_station_work_free(work, &status);
+    oskar_station_beam_cache_free(cache, &status);
+    oskar_telescope_free(tel, &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+    return max_err;
+}
+
+
+TEST(station_beam_cache, epoch_interval)
+{
+    EXPECT_EQ(1, oskar_station_beam_cache_epoch_interval(0.0, 10.0));
+    EXPECT_EQ(1, oskar_station_beam_cache_epoch_interval(1e-4, 10.0));
+    EXPECT_EQ(59, oskar_station_beam_cache_epoch_interval(0.25 * D2R, 1.0));
+    EXPECT_EQ(5, oskar_station_beam_cache_epoch_interval(0.25 * D2R, 10.0));
+}
+
+
+TEST(station_beam_cache, exact_at_every_sample)
+{
+    int num_evaluations = 0;
+    double err = run_interpolation(OSKAR_DOUBLE, OSKAR_DOUBLE_COMPLEX,
+            OSKAR_BEAM_INTERP_CUBIC, 0, 0.0, 0, &num_evaluations);
+    EXPECT_LT(err, 1e-12);
+    EXPECT_EQ(num_times, num_evaluations);
+}
+
+
+TEST(station_beam_cache, linear_scalar_double)
+{
+    int num_evaluations = 0;
+    double err = run_interpolation(OSKAR_DOUBLE, OSKAR_DOUBLE_COMPLEX,
+            OSKAR_BEAM_INTERP_LINEAR, 0, 0.5 * D2R, 0, &num_evaluations);
+    EXPECT_LT(err, 1e-4);
+    int interval = oskar_station_beam_cache_epoch_interval(0.5 * D2R,
+            t_inc_sec);
+    EXPECT_EQ((num_times - 1) / interval + 2, num_evaluations);
+}
+
+
+TEST(station_beam_cache, cubic_scalar_double)
+{
+    int num_evaluations = 0;
+    double err_linear, err_cubic;
+    err_linear = run_interpolation(OSKAR_DOUBLE, OSKAR_DOUBLE_COMPLEX,
+            OSKAR_BEAM_INTERP_LINEAR, 0, 2.0 * D2R, 0, &num_evaluations);
+    err_cubic = run_interpolation(OSKAR_DOUBLE, OSKAR_DOUBLE_COMPLEX,
+            OSKAR_BEAM_INTERP_CUBIC, 0, 2.0 * D2R, 0, &num_evaluations);
+    EXPECT_LT(err_cubic, 0.5 * err_linear);
+    EXPECT_LT(err_cubic, 1e-4);
+    int interval = oskar_station_beam_cache_epoch_interval(2.0 * D2R,
+            t_inc_sec);
+    EXPECT_EQ((num_times - 1) / interval + 4, num_evaluations);
+}
+
+
+TEST(station_beam_cache, cubic_matrix_single_classes)
+{
+    int num_evaluations = 0;
+    double err = run_interpolation(OSKAR_SINGLE, OSKAR_SINGLE_COMPLEX_MATRIX,
+            OSKAR_BEAM_INTERP_CUBIC, 1, 1.0 * D2R, 1, &num_evaluations);
+    EXPECT_LT(err, 1e-3);
+
+    // Two classes of station.
+    int interval = oskar_station_beam_cache_epoch_interval(1.0 * D2R,
+            t_inc_sec);
+    EXPECT_EQ(2 * ((num_times - 1) / interval + 4), num_evaluations);
+}
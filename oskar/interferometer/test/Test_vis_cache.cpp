@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "interferometer/oskar_interferometer.h"
+#include "interferometer/oskar_vis_cache.h"
+#include "sky/oskar_sky.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdio>
+#include <cstdlib>
+
+#define D2R (M_PI / 180.0)
+
+static const double lat_rad = -30.0 * D2R;
+static const int num_stations = 10;
+static const int num_times = 4;
+
+static oskar_Sky* create_sky(int num_sources, int* status)
+{
+    // Sources are generated in the same order for any sky size.
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, status);
+    srand(1);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        double ra = 6.0 * D2R * ((double)rand() / RAND_MAX - 0.5);
+        double dec = lat_rad + 6.0 * D2R * ((double)rand() / RAND_MAX - 0.5);
+        oskar_sky_set_source(sky, i, ra, dec, 1.0, 0.5, 0.0, 0.0,
+                0.0, 0.0, 0.0, 0.0, 0.0, 0.0, status);
+    }
+    return sky;
+}
+
+static oskar_Interferometer* create_simulator(const oskar_Sky* sky,
+        double freq_hz, const char* cache_dir, int* status)
+{
+    // Create a telescope model of single-element stations.
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_stations, status);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        double enu[3] = {0.0, 0.0, 0.0};
+        oskar_station_resize(s, 1, status);
+        oskar_station_resize_element_types(s, 1, status);
+        oskar_station_set_position(s, 1e-4 * i, lat_rad, 0.0);
+        oskar_station_set_element_coords(s, 0, enu, enu, status);
+    }
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_phase_centre(tel,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.0, lat_rad);
+    oskar_telescope_analyse(tel, status);
+
+    // Create the simulator, using 50 sources per chunk.
+    oskar_Interferometer* h = oskar_interferometer_create(OSKAR_DOUBLE,
+            status);
+    oskar_interferometer_set_num_devices(h, 1);
+    oskar_interferometer_set_correlation_type(h, "Both", status);
+    oskar_interferometer_set_max_sources_per_chunk(h, 50);
+    oskar_interferometer_set_max_times_per_block(h, num_times);
+    oskar_interferometer_set_observation_time(h, 57000.0, 10.0, num_times);
+    oskar_interferometer_set_observation_frequency(h, freq_hz, 1e6, 2);
+    oskar_interferometer_set_vis_cache_directory(h, cache_dir);
+    oskar_interferometer_set_telescope_model(h, tel, status);
+    oskar_interferometer_set_sky_model(h, sky, status);
+    oskar_telescope_free(tel, status);
+    return h;
+}
+
+static double max_diff(const oskar_Mem* a, const oskar_Mem* b,
+        double* max_abs, int* status)
+{
+    const double* p0 = oskar_mem_double_const(a, status);
+    const double* p1 = oskar_mem_double_const(b, status);
+    double diff = 0.0;
+    for (size_t i = 0; i < 2 * oskar_mem_length(a); ++i)
+    {
+        if (fabs(p0[i] - p1[i]) > diff) diff = fabs(p0[i] - p1[i]);
+        if (fabs(p0[i]) > *max_abs) *max_abs = fabs(p0[i]);
+    }
+    return diff;
+}
+
+static void check_simulation(const oskar_Sky* sky, double freq_hz,
+        const char* cache_dir)
+{
+    // Simulate the block with and without the cache.
+    int status = 0;
+    oskar_Interferometer* h[2];
+    oskar_VisBlock* b[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        h[i] = create_simulator(sky, freq_hz, i ? cache_dir : "", &status);
+        oskar_interferometer_check_init(h[i], &status);
+        oskar_interferometer_reset_work_unit_index(h[i]);
+        oskar_interferometer_run_block(h[i], 0, 0, &status);
+        b[i] = oskar_interferometer_finalise_block(h[i], 0, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the visibilities agree.
+    double max_abs = 0.0;
+    double xc = max_diff(oskar_vis_block_cross_correlations_const(b[0]),
+            oskar_vis_block_cross_correlations_const(b[1]), &max_abs, &status);
+    double ac = max_diff(oskar_vis_block_auto_correlations_const(b[0]),
+            oskar_vis_block_auto_correlations_const(b[1]), &max_abs, &status);
+    EXPECT_GT(max_abs, 0.0);
+    EXPECT_LT(xc, 1e-12 * max_abs);
+    EXPECT_LT(ac, 1e-12 * max_abs);
+
+    // Freeing the simulator completes the cache files.
+    oskar_interferometer_free(h[0], &status);
+    oskar_interferometer_free(h[1], &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(vis_cache, reuses_matching_chunks)
+{
+    int status = 0;
+    const char* dir = "temp_test_vis_cache";
+    const unsigned int tel_hash = 1, obs_hash = 2, settings_hash = 3;
+    oskar_Sky* sky[2];
+    sky[0] = create_sky(10, &status);
+    sky[1] = create_sky(20, &status);
+
+    // Write all records for the first chunk, but not for the second.
+    oskar_Mem* data = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            6, &status);
+    oskar_Mem* out = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            0, &status);
+    oskar_VisCache* cache = oskar_vis_cache_create(dir, 2, 3,
+            tel_hash, obs_hash, settings_hash, &status);
+    EXPECT_EQ(0, oskar_vis_cache_check_chunk(cache, 0, sky[0], &status));
+    EXPECT_EQ(0, oskar_vis_cache_check_chunk(cache, 1, sky[1], &status));
+    for (int r = 0; r < 3; ++r)
+    {
+        oskar_mem_set_value_real(data, (double) r, 0, 0, &status);
+        oskar_vis_cache_write(cache, 0, r, data, 0, &status);
+    }
+    oskar_vis_cache_write(cache, 1, 0, data, 0, &status);
+    oskar_vis_cache_free(cache, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check that only the complete chunk is reused, and read it back.
+    cache = oskar_vis_cache_create(dir, 2, 3,
+            tel_hash, obs_hash, settings_hash, &status);
+    EXPECT_EQ(1, oskar_vis_cache_check_chunk(cache, 0, sky[0], &status));
+    EXPECT_EQ(0, oskar_vis_cache_check_chunk(cache, 1, sky[1], &status));
+    EXPECT_EQ(1, oskar_vis_cache_num_cached(cache));
+    oskar_vis_cache_read(cache, 0, 2, out, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(6u, oskar_mem_length(out));
+    EXPECT_DOUBLE_EQ(2.0, oskar_mem_double(out, &status)[0]);
+
+    // Check that the chunk is not reused if the sources are different.
+    EXPECT_EQ(0, oskar_vis_cache_check_chunk(cache, 0, sky[1], &status));
+    oskar_vis_cache_free(cache, &status);
+
+    // Check that the chunk is not reused if any other hash is different.
+    cache = oskar_vis_cache_create(dir, 2, 3,
+            tel_hash, obs_hash, settings_hash + 1, &status);
+    EXPECT_EQ(0, oskar_vis_cache_check_chunk(cache, 0, sky[0], &status));
+    oskar_vis_cache_free(cache, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Clean up.
+    oskar_mem_free(data, &status);
+    oskar_mem_free(out, &status);
+    oskar_sky_free(sky[0], &status);
+    oskar_sky_free(sky[1], &status);
+    oskar_dir_remove(dir);
+}
+
+TEST(vis_cache, incremental_sky_updates)
+{
+    int status = 0;
+    const char* dir = "temp_test_vis_cache_sim";
+    if (oskar_dir_exists(dir)) oskar_dir_remove(dir);
+
+    // Simulate the initial sky model, to fill the cache.
+    oskar_Sky* sky = create_sky(200, &status);
+    check_simulation(sky, 100e6, dir);
+
+    // Add sources at the end, and change a source in the second chunk.
+    oskar_sky_free(sky, &status);
+    sky = create_sky(230, &status);
+    oskar_sky_set_source(sky, 60, 0.0, lat_rad, 3.0, 0.0, 0.0, 0.0,
+            0.0, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    check_simulation(sky, 100e6, dir);
+
+    // Check that stored contributions are not used for other frequencies.
+    check_simulation(sky, 120e6, dir);
+    oskar_sky_free(sky, &status);
+    oskar_dir_remove(dir);
+}
+
+TEST(vis_cache, telescope_hash_uses_element_data)
+{
+    int status = 0;
+    const char* filename = "temp_test_vis_cache_coeffs.txt";
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU,
+            1, &status);
+    oskar_Station* s = oskar_telescope_station(tel, 0);
+    oskar_station_resize(s, 1, &status);
+    oskar_station_resize_element_types(s, 1, &status);
+    oskar_Element* e = oskar_station_element(s, 0);
+
+    // Load two sets of coefficients in turn from the same file name:
+    // the hash must depend on the data, not on where it came from.
+    FILE* file = fopen(filename, "w");
+    ASSERT_TRUE(file != NULL);
+    fprintf(file, "1, 0, 0.0, 0.0, 1.0, 0.0\n");
+    fclose(file);
+    oskar_element_load_spherical_wave(e, filename, 1, 100e6, &status);
+    unsigned int hash1 = oskar_vis_cache_hash_telescope(tel, &status);
+    file = fopen(filename, "w");
+    ASSERT_TRUE(file != NULL);
+    fprintf(file, "1, 0, 0.0, 0.0, 0.5, 0.0\n");
+    fclose(file);
+    oskar_element_load_spherical_wave(e, filename, 1, 100e6, &status);
+    unsigned int hash2 = oskar_vis_cache_hash_telescope(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_NE(hash1, hash2);
+
+    // Check that an identical copy has the same hash.
+    oskar_Telescope* copy = oskar_telescope_create_copy(tel, OSKAR_CPU,
+            &status);
+    EXPECT_EQ(hash2, oskar_vis_cache_hash_telescope(copy, &status));
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_telescope_free(copy, &status);
+    oskar_telescope_free(tel, &status);
+    remove(filename);
+}
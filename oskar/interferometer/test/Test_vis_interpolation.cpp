@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "convert/oskar_convert_ecef_to_baseline_uvw.h"
+#include "interferometer/oskar_vis_interpolation.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdlib>
+#include <vector>
+
+#define D2R (M_PI / 180.0)
+
+static const int num_stations = 20;
+static const int num_times = 65;
+static const int num_channels = 2;
+static const int num_sources = 10;
+static const double t_start = 57000.0;
+static const double t_inc_sec = 10.0;
+static const double freq_start_hz = 100e6;
+static const double freq_inc_hz = 20e6;
+static const double ra0 = 10.0 * D2R;
+static const double dec0 = -30.0 * D2R;
+
+static void predict(const oskar_Sky* sky, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* ww, int num_baselines,
+        oskar_Mem* vis)
+{
+    int status = 0;
+    std::vector<double> l(num_sources), m(num_sources), n(num_sources);
+    for (int s = 0; s < num_sources; ++s)
+    {
+        const double ra = oskar_mem_get_element(
+                oskar_sky_ra_rad_const(sky), s, &status);
+        const double dec = oskar_mem_get_element(
+                oskar_sky_dec_rad_const(sky), s, &status);
+        l[s] = cos(dec) * sin(ra - ra0);
+        m[s] = cos(dec0) * sin(dec) - sin(dec0) * cos(dec) * cos(ra - ra0);
+        n[s] = sin(dec0) * sin(dec) + cos(dec0) * cos(dec) * cos(ra - ra0);
+    }
+    const double* u = oskar_mem_double_const(uu, &status);
+    const double* v = oskar_mem_double_const(vv, &status);
+    const double* w = oskar_mem_double_const(ww, &status);
+    double* out = oskar_mem_double(vis, &status);
+    for (int t = 0; t < num_times; ++t)
+    {
+        for (int c = 0; c < num_channels; ++c)
+        {
+            const double k = 2.0 * M_PI *
+                    (freq_start_hz + c * freq_inc_hz) / 299792458.0;
+            for (int b = 0; b < num_baselines; ++b)
+            {
+                const int i = t * num_baselines + b;
+                const int j = (t * num_channels + c) * num_baselines + b;
+                double re = 0.0, im = 0.0;
+                for (int s = 0; s < num_sources; ++s)
+                {
+                    const double p = k * (u[i] * l[s] + v[i] * m[s] +
+                            w[i] * (n[s] - 1.0));
+                    re += cos(p);
+                    im += sin(p);
+                }
+                out[2 * j] = re;
+                out[2 * j + 1] = im;
+            }
+        }
+    }
+}
+
+TEST(vis_interpolation, fringe_stopped_fill)
+{
+    int status = 0;
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    const double tolerance = 1e-3;
+
+    // Create a compact array of stations.
+    srand(1);
+    oskar_Mem *x, *y, *z;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations, &status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations, &status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations, &status);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_mem_double(x, &status)[i] = 300.0 * (rand() / (double)RAND_MAX);
+        oskar_mem_double(y, &status)[i] = 300.0 * (rand() / (double)RAND_MAX);
+        oskar_mem_double(z, &status)[i] = 300.0 * (rand() / (double)RAND_MAX);
+    }
+
+    // Create a sky model with sources a few degrees away from the centre.
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, &status);
+    for (int i = 0; i < num_sources; ++i)
+        oskar_sky_set_source(sky, i,
+                ra0 + (4.0 + 2.0 * (rand() / (double)RAND_MAX)) * D2R,
+                dec0 + (2.0 * (rand() / (double)RAND_MAX)) * D2R,
+                1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    double l_c = 0.0, m_c = 0.0, n_c = 0.0, radius = 0.0;
+    oskar_vis_interpolation_sky_extent(1, &sky, ra0, dec0,
+            &l_c, &m_c, &n_c, &radius, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_GT(l_c, 0.0);
+    EXPECT_GT(radius, 0.0);
+    EXPECT_LT(radius, 2.5 * D2R);
+
+    // Get the interpolation strides.
+    std::vector<int> stride(num_baselines);
+    oskar_vis_interpolation_strides(num_stations, x, y, z,
+            freq_start_hz + (num_channels - 1) * freq_inc_hz, radius,
+            t_inc_sec, tolerance, num_times - 1, &stride[0], &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    int num_interpolated = 0;
+    for (int b = 0; b < num_baselines; ++b)
+    {
+        EXPECT_GE(stride[b], 1);
+        EXPECT_EQ(0, stride[b] & (stride[b] - 1));
+        if (stride[b] > 1) num_interpolated++;
+    }
+    EXPECT_GT(num_interpolated, 0);
+
+    // Predict visibilities at all times.
+    oskar_Mem *uu, *vv, *ww, *work, *vis_ref, *vis;
+    const int num_uvw = num_times * num_baselines;
+    uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_uvw, &status);
+    vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_uvw, &status);
+    ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_uvw, &status);
+    work = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 3 * num_stations,
+            &status);
+    oskar_convert_ecef_to_baseline_uvw(num_stations, x, y, z, ra0, dec0,
+            num_times, t_start, t_inc_sec / 86400.0, 0, uu, vv, ww, work,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    vis_ref = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_times * num_channels * num_baselines, &status);
+    predict(sky, uu, vv, ww, num_baselines, vis_ref);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Discard samples which are not required, and fill them in again.
+    vis = oskar_mem_create_copy(vis_ref, OSKAR_CPU, &status);
+    double* v = oskar_mem_double(vis, &status);
+    for (int t = 0; t < num_times; ++t)
+        for (int c = 0; c < num_channels; ++c)
+            for (int b = 0; b < num_baselines; ++b)
+                if (!oskar_vis_interpolation_required(stride[b], t,
+                        num_times))
+                {
+                    const int j = (t * num_channels + c) * num_baselines + b;
+                    v[2 * j] = v[2 * j + 1] = 0.0;
+                }
+    oskar_vis_interpolation_fill(vis, num_times, num_channels,
+            num_baselines, &stride[0], uu, vv, ww, l_c, m_c, n_c,
+            freq_start_hz, freq_inc_hz, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the errors are within the tolerance, relative to the total flux.
+    const double* r = oskar_mem_double_const(vis_ref, &status);
+    double max_err = 0.0;
+    for (int i = 0; i < num_times * num_channels * num_baselines; ++i)
+    {
+        const double dr = v[2 * i] - r[2 * i];
+        const double di = v[2 * i + 1] - r[2 * i + 1];
+        const double err = sqrt(dr * dr + di * di);
+        if (err > max_err) max_err = err;
+    }
+    EXPECT_LT(max_err, tolerance * num_sources);
+    EXPECT_GT(max_err, 0.0);
+
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(work, &status);
+    oskar_mem_free(vis_ref, &status);
+    oskar_mem_free(vis, &status);
+    oskar_sky_free(sky, &status);
+}
+
+
+TEST(vis_interpolation, required)
+{
+    // Block end-points and multiples of the stride are always required.
+    EXPECT_TRUE(oskar_vis_interpolation_required(4, 0, 10));
+    EXPECT_TRUE(oskar_vis_interpolation_required(4, 8, 10));
+    EXPECT_TRUE(oskar_vis_interpolation_required(4, 9, 10));
+    EXPECT_FALSE(oskar_vis_interpolation_required(4, 5, 10));
+    EXPECT_TRUE(oskar_vis_interpolation_required(1, 5, 10));
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_DFTW_NUFFT_H_
+#define OSKAR_DFTW_NUFFT_H_
+
+/**
+ * @file oskar_dftw_nufft.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Function to perform a weighted DFT using a non-uniform FFT.
+ *
+ * @details
+ * This function evaluates the same sums as oskar_dftw() when its
+ * \p data parameter is NULL, i.e.
+ *
+ *   output_k = sum_i weights_i exp(i wavenumber (x_i x_k + y_i y_k + z_i z_k))
+ *
+ * but uses a type-3 non-uniform FFT (see oskar_nufft3()), so that the cost
+ * scales with the number of input and output points separately, rather than
+ * with their product. The result is accurate to approximately
+ * \p tolerance, relative to the sum of the weight amplitudes.
+ *
+ * The transform may be either 2D or 3D. If either \p z_in or \p z_out
+ * is NULL on input, the transform will be done in 2D.
+ *
+ * This function is only available for data in CPU memory.
+ * The output array must be complex and not a matrix type.
+ *
+ * @param[in] num_in       Number of input points.
+ * @param[in] wavenumber   Wavenumber (2 pi / wavelength).
+ * @param[in] x_in         Array of input x positions.
+ * @param[in] y_in         Array of input y positions.
+ * @param[in] z_in         Array of input z positions.
+ * @param[in] weights_in   Array of complex DFT weights.
+ * @param[in] num_out      Number of output points.
+ * @param[in] x_out        Array of output 1/x positions.
+ * @param[in] y_out        Array of output 1/y positions.
+ * @param[in] z_out        Array of output 1/z positions.
+ * @param[in] tolerance    Required relative accuracy.
+ * @param[out] output      Array of computed output points.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_dftw_nufft(
+        int num_in,
+        double wavenumber,
+        const oskar_Mem* x_in,
+        const oskar_Mem* y_in,
+        const oskar_Mem* z_in,
+        const oskar_Mem* weights_in,
+        int num_out,
+        const oskar_Mem* x_out,
+        const oskar_Mem* y_out,
+        const oskar_Mem* z_out,
+        double tolerance,
+        oskar_Mem* output,
+        int* status);
+
+/**
+ * @brief
+ * Returns the estimated cost of oskar_dftw_nufft() relative to oskar_dftw().
+ *
+ * @details
+ * Returns the estimated cost of evaluating the transform using
+ * oskar_dftw_nufft(), relative to the cost of using oskar_dftw(),
+ * given the extent of the input and output coordinates.
+ * A value below 1 means the non-uniform FFT is expected to be faster.
+ *
+ * DBL_MAX is returned if the data are not in CPU memory, or if the
+ * transform would need too much memory.
+ *
+ * The parameters are as for oskar_dftw_nufft().
+ */
+OSKAR_EXPORT
+double oskar_dftw_nufft_cost(
+        int num_in,
+        double wavenumber,
+        const oskar_Mem* x_in,
+        const oskar_Mem* y_in,
+        const oskar_Mem* z_in,
+        int num_out,
+        const oskar_Mem* x_out,
+        const oskar_Mem* y_out,
+        const oskar_Mem* z_out,
+        double tolerance,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_DFTW_NUFFT_H_ */
@@ -50,6 +50,46 @@ void oskar_fftpack_cfft2f(const int ldim, const int l, const int m,
 OSKAR_EXPORT
 void oskar_fftpack_cfft2i(const int l, const int m, double *wsave);
 
+/**
+ * @brief
+ * Performs multiple 1D backward complex FFTs.
+ *
+ * @details
+ * Transforms \p lot sequences of length \p n in the array \p c,
+ * where successive sequences start \p jump complex elements apart and
+ * elements within each sequence are \p inc complex elements apart.
+ * The transform uses the kernel exp(+i 2 pi j k / n), and is unnormalised.
+ *
+ * The work array must have length at least 2 * lot * n, and the
+ * array \p wsave must have been initialised using oskar_fftpack_cfftmi().
+ */
+OSKAR_EXPORT
+void oskar_fftpack_cfftmb(const int lot, const int jump, const int n,
+        const int inc, double *c, double *wsave, double *work);
+
+/**
+ * @brief
+ * Performs multiple 1D forward complex FFTs.
+ *
+ * @details
+ * As oskar_fftpack_cfftmb(), but uses the kernel exp(-i 2 pi j k / n)
+ * and scales the result by 1 / n.
+ */
+OSKAR_EXPORT
+void oskar_fftpack_cfftmf(const int lot, const int jump, const int n,
+        const int inc, double *c, double *wsave, double *work);
+
+/**
+ * @brief
+ * Initialises the work array for 1D complex FFTs of length \p n.
+ *
+ * @details
+ * The array \p wsave must have length at least
+ * 2 * n + (int)(log(n) / log(2)) + 4.
+ */
+OSKAR_EXPORT
+void oskar_fftpack_cfftmi(const int n, double *wsave);
+
 #ifdef __cplusplus
 }
 #endif
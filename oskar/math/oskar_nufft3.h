@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_NUFFT3_H_
+#define OSKAR_NUFFT3_H_
+
+/**
+ * @file oskar_nufft3.h
+ */
+
+#include <oskar_global.h>
+#include <utility/oskar_vector_types.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Evaluates a 3D type-3 non-uniform FFT.
+ *
+ * @details
+ * This function evaluates the sums
+ *
+ *   f_k = sum_j c_j exp(i sign (s_k x_j + t_k y_j + u_k z_j))
+ *
+ * for num_targets non-uniform target frequencies (s, t, u) and
+ * num_points non-uniform input points (x, y, z), to within a relative
+ * error of approximately \p tolerance, using an upsampled grid,
+ * an "exponential of semicircle" spreading kernel and in-tree FFTs.
+ * The work is multithreaded using OpenMP.
+ *
+ * A set of \p num_trans transforms with the same points and targets is
+ * evaluated at once. The strength of point j for transform t is given
+ * by c[j * num_trans + t], and the result for target k is returned in
+ * f[k * num_trans + t].
+ *
+ * Any of the coordinate arrays may be NULL if the coordinates in that
+ * dimension are all zero. The grid is not used in any dimension for which
+ * the product of the point and target extents is negligible.
+ *
+ * The cost and memory use grows with the product of the extents of the
+ * points and targets in each dimension: see oskar_nufft3_cost().
+ *
+ * @param[in] num_points   Number of input points.
+ * @param[in] x            Input point x coordinates.
+ * @param[in] y            Input point y coordinates.
+ * @param[in] z            Input point z coordinates.
+ * @param[in] num_trans    Number of transforms.
+ * @param[in] c            Input point strengths.
+ * @param[in] num_targets  Number of target frequencies.
+ * @param[in] s            Target s coordinates.
+ * @param[in] t            Target t coordinates.
+ * @param[in] u            Target u coordinates.
+ * @param[in] sign         Sign of the exponent (+1 or -1).
+ * @param[in] tolerance    Required relative accuracy (1e-1 to 1e-14).
+ * @param[out] f           Output values.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_nufft3(int num_points, const double* x, const double* y,
+        const double* z, int num_trans, const double2* c, int num_targets,
+        const double* s, const double* t, const double* u, int sign,
+        double tolerance, double2* f, int* status);
+
+/**
+ * @brief
+ * Returns the estimated cost of a type-3 non-uniform FFT.
+ *
+ * @details
+ * Returns the estimated cost of oskar_nufft3() relative to the cost of
+ * evaluating the same sums directly, given the difference between the
+ * largest and smallest point and target coordinates in each dimension.
+ * A value below 1 means the non-uniform FFT is expected to be faster.
+ *
+ * If \p grid_size is not NULL, it returns the number of cells in the
+ * upsampled grid. Each transform needs 16 bytes per cell.
+ *
+ * @param[in] num_points     Number of input points.
+ * @param[in] num_targets    Number of target frequencies.
+ * @param[in] num_trans      Number of transforms.
+ * @param[in] point_range    Extent of the input point coordinates.
+ * @param[in] target_range   Extent of the target coordinates.
+ * @param[in] tolerance      Required relative accuracy.
+ * @param[out] grid_size     Number of cells in the upsampled grid.
+ */
+OSKAR_EXPORT
+double oskar_nufft3_cost(int num_points, int num_targets, int num_trans,
+        const double point_range[3], const double target_range[3],
+        double tolerance, size_t* grid_size);
+
+/**
+ * @brief
+ * Returns the memory needed by a type-3 non-uniform FFT.
+ *
+ * @details
+ * Returns the number of bytes allocated by oskar_nufft3() for the spreading
+ * and upsampled grids and the point ordering, given the difference between
+ * the largest and smallest point and target coordinates in each dimension.
+ * The output array and the small per-thread FFT work arrays are not included.
+ *
+ * @param[in] num_points     Number of input points.
+ * @param[in] num_trans      Number of transforms.
+ * @param[in] point_range    Extent of the input point coordinates.
+ * @param[in] target_range   Extent of the target coordinates.
+ * @param[in] tolerance      Required relative accuracy.
+ */
+OSKAR_EXPORT
+size_t oskar_nufft3_memory_bytes(int num_points, int num_trans,
+        const double point_range[3], const double target_range[3],
+        double tolerance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_NUFFT3_H_ */
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "math/oskar_dftw_nufft.h"
+#include "math/oskar_nufft3.h"
+
+#include <float.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static double* scaled_copy(const oskar_Mem* in, int n, double scale,
+        int* status);
+static void coord_range(const oskar_Mem* in, int n, double scale,
+        double* range, int* status);
+
+void oskar_dftw_nufft(
+        int num_in,
+        double wavenumber,
+        const oskar_Mem* x_in,
+        const oskar_Mem* y_in,
+        const oskar_Mem* z_in,
+        const oskar_Mem* weights_in,
+        int num_out,
+        const oskar_Mem* x_out,
+        const oskar_Mem* y_out,
+        const oskar_Mem* z_out,
+        double tolerance,
+        oskar_Mem* output,
+        int* status)
+{
+    int i, type, is_3d;
+    double *x = 0, *y = 0, *z = 0, *s = 0, *t = 0, *u = 0;
+    double2 *c = 0, *f = 0;
+    if (*status) return;
+
+    /* Check types and locations. */
+    type = oskar_mem_precision(output);
+    is_3d = (z_in != NULL && z_out != NULL);
+    if (!oskar_mem_is_complex(output) || oskar_mem_is_matrix(output) ||
+            !oskar_mem_is_complex(weights_in) ||
+            oskar_mem_is_matrix(weights_in))
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (oskar_mem_location(output) != OSKAR_CPU ||
+            oskar_mem_location(weights_in) != OSKAR_CPU ||
+            oskar_mem_location(x_in) != OSKAR_CPU ||
+            oskar_mem_location(y_in) != OSKAR_CPU ||
+            oskar_mem_location(x_out) != OSKAR_CPU ||
+            oskar_mem_location(y_out) != OSKAR_CPU ||
+            (is_3d && (oskar_mem_location(z_in) != OSKAR_CPU ||
+                    oskar_mem_location(z_out) != OSKAR_CPU)))
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_mem_precision(weights_in) != type ||
+            oskar_mem_type(x_in) != type || oskar_mem_type(y_in) != type ||
+            oskar_mem_type(x_out) != type || oskar_mem_type(y_out) != type ||
+            (is_3d && (oskar_mem_type(z_in) != type ||
+                    oskar_mem_type(z_out) != type)))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+
+    /* Resize output array if needed. */
+    if ((int)oskar_mem_length(output) < num_out)
+        oskar_mem_realloc(output, (size_t) num_out, status);
+    if (*status || num_out == 0) return;
+    if (num_in == 0)
+    {
+        oskar_mem_clear_contents(output, status);
+        return;
+    }
+
+    /* Scale input positions by the wavenumber, and get the weights. */
+    x = scaled_copy(x_in, num_in, wavenumber, status);
+    y = scaled_copy(y_in, num_in, wavenumber, status);
+    if (is_3d) z = scaled_copy(z_in, num_in, wavenumber, status);
+    c = (double2*) malloc(num_in * sizeof(double2));
+    if (!c) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    else if (type == OSKAR_DOUBLE)
+    {
+        const double2* w = oskar_mem_double2_const(weights_in, status);
+        for (i = 0; i < num_in; ++i) c[i] = w[i];
+    }
+    else
+    {
+        const float2* w = oskar_mem_float2_const(weights_in, status);
+        for (i = 0; i < num_in; ++i)
+        {
+            c[i].x = w[i].x;
+            c[i].y = w[i].y;
+        }
+    }
+
+    /* Evaluate the transform, directly into the output if possible. */
+    if (type == OSKAR_DOUBLE)
+    {
+        oskar_nufft3(num_in, x, y, z, 1, c, num_out,
+                oskar_mem_double_const(x_out, status),
+                oskar_mem_double_const(y_out, status),
+                is_3d ? oskar_mem_double_const(z_out, status) : 0,
+                1, tolerance, oskar_mem_double2(output, status), status);
+    }
+    else
+    {
+        s = scaled_copy(x_out, num_out, 1.0, status);
+        t = scaled_copy(y_out, num_out, 1.0, status);
+        if (is_3d) u = scaled_copy(z_out, num_out, 1.0, status);
+        f = (double2*) malloc(num_out * sizeof(double2));
+        if (!f && !*status) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        oskar_nufft3(num_in, x, y, z, 1, c, num_out, s, t, u,
+                1, tolerance, f, status);
+        if (!*status)
+        {
+            float2* out = oskar_mem_float2(output, status);
+            for (i = 0; i < num_out; ++i)
+            {
+                out[i].x = (float) f[i].x;
+                out[i].y = (float) f[i].y;
+            }
+        }
+    }
+
+    /* Free scratch memory. */
+    free(x);
+    free(y);
+    free(z);
+    free(s);
+    free(t);
+    free(u);
+    free(c);
+    free(f);
+}
+
+double oskar_dftw_nufft_cost(
+        int num_in,
+        double wavenumber,
+        const oskar_Mem* x_in,
+        const oskar_Mem* y_in,
+        const oskar_Mem* z_in,
+        int num_out,
+        const oskar_Mem* x_out,
+        const oskar_Mem* y_out,
+        const oskar_Mem* z_out,
+        double tolerance,
+        int* status)
+{
+    double point_range[3] = {0.0, 0.0, 0.0};
+    double target_range[3] = {0.0, 0.0, 0.0};
+    if (*status || num_in == 0 || num_out == 0) return DBL_MAX;
+    if (oskar_mem_location(x_in) != OSKAR_CPU ||
+            oskar_mem_location(x_out) != OSKAR_CPU)
+        return DBL_MAX;
+    coord_range(x_in, num_in, wavenumber, &point_range[0], status);
+    coord_range(y_in, num_in, wavenumber, &point_range[1], status);
+    coord_range(x_out, num_out, 1.0, &target_range[0], status);
+    coord_range(y_out, num_out, 1.0, &target_range[1], status);
+    if (z_in && z_out)
+    {
+        coord_range(z_in, num_in, wavenumber, &point_range[2], status);
+        coord_range(z_out, num_out, 1.0, &target_range[2], status);
+    }
+    if (*status) return DBL_MAX;
+    return oskar_nufft3_cost(num_in, num_out, 1, point_range, target_range,
+            tolerance, 0);
+}
+
+/* Returns a new array of the values in the input array, times scale. */
+static double* scaled_copy(const oskar_Mem* in, int n, double scale,
+        int* status)
+{
+    int i;
+    double* out;
+    if (*status) return 0;
+    out = (double*) malloc(n * sizeof(double));
+    if (!out)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    if (oskar_mem_type(in) == OSKAR_DOUBLE)
+    {
+        const double* p = oskar_mem_double_const(in, status);
+        for (i = 0; i < n; ++i) out[i] = scale * p[i];
+    }
+    else
+    {
+        const float* p = oskar_mem_float_const(in, status);
+        for (i = 0; i < n; ++i) out[i] = scale * p[i];
+    }
+    return out;
+}
+
+/* Returns the difference between the largest and smallest values. */
+static void coord_range(const oskar_Mem* in, int n, double scale,
+        double* range, int* status)
+{
+    int i;
+    double min_val = DBL_MAX, max_val = -DBL_MAX;
+    if (*status) return;
+    if (oskar_mem_type(in) == OSKAR_DOUBLE)
+    {
+        const double* p = oskar_mem_double_const(in, status);
+        for (i = 0; i < n; ++i)
+        {
+            if (p[i] < min_val) min_val = p[i];
+            if (p[i] > max_val) max_val = p[i];
+        }
+    }
+    else
+    {
+        const float* p = oskar_mem_float_const(in, status);
+        for (i = 0; i < n; ++i)
+        {
+            if (p[i] < min_val) min_val = p[i];
+            if (p[i] > max_val) max_val = p[i];
+        }
+    }
+    *range = n > 0 ? scale * (max_val - min_val) : 0.0;
+}
+
+#ifdef __cplusplus
+}
+#endif
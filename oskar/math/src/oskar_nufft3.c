@@ -0,0 +1,590 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "math/oskar_nufft3.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_fftpack_cfft.h"
+
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The type-3 transform is evaluated as described by Lee & Greengard (2005)
+ * and Barnett et al. (2019). After shifting the points and targets to be
+ * centred on the origin, the point strengths are spread onto a uniform
+ * grid using the "exponential of semicircle" kernel
+ *
+ *   phi(z) = exp(beta (sqrt(1 - z^2) - 1)),  |z| < 1,
+ *
+ * which turns the sum into a type-2 transform from the grid to the
+ * targets. That is evaluated by deconvolving the grid values, padding them
+ * into a larger grid, using an FFT and interpolating at the targets with the
+ * same kernel. The Fourier transform of the kernel is evaluated numerically
+ * to deconvolve it at each step.
+ */
+
+#define MAX_NS 16
+#define MAX_NQ (2 * MAX_NS + 2)
+#define LARGE_GRID 16777216.0
+#define FFT_LOT 16
+
+typedef struct
+{
+    int ns, nq;
+    double sigma, beta;
+    double z[MAX_NQ], wt[MAX_NQ];   /* Quadrature nodes and weights. */
+    int n1[3], n2[3];               /* Spreading and upsampled grid sizes. */
+    double gam[3], h1[3], h2[3];    /* Point scaling and grid spacings. */
+    double size1, size2;            /* Total cells in each grid. */
+} Plan;
+
+static double es_kernel(double z, double beta)
+{
+    return (z > -1.0 && z < 1.0) ? exp(beta * (sqrt(1.0 - z * z) - 1.0)) : 0.0;
+}
+
+/* Returns the integral of the kernel times exp(i k z) over [-1, 1]. */
+static double es_kernel_ft(const Plan* p, double k)
+{
+    int i;
+    double sum = 0.0;
+    for (i = 0; i < p->nq; ++i)
+        sum += p->wt[i] * cos(k * p->z[i]);
+    return sum;
+}
+
+static int next_smooth_even(double n)
+{
+    int m, r;
+    if (n > 1e9) return -1;
+    m = 2 * (int) ceil(n / 2.0);
+    if (m < 2) m = 2;
+    for (;; m += 2)
+    {
+        r = m;
+        while (r % 2 == 0) r /= 2;
+        while (r % 3 == 0) r /= 3;
+        while (r % 5 == 0) r /= 5;
+        if (r == 1) return m;
+    }
+}
+
+static int wrap(int i, int n)
+{
+    i %= n;
+    return i < 0 ? i + n : i;
+}
+
+static void set_up_plan(const double half_x[3], const double half_s[3],
+        double tolerance, double sigma, Plan* p)
+{
+    int d, i, n;
+
+    /* Set the kernel width and shape for the required accuracy. */
+    if (tolerance < 1e-14) tolerance = 1e-14;
+    if (tolerance > 1e-1) tolerance = 1e-1;
+    p->sigma = sigma;
+    if (sigma == 2.0)
+    {
+        p->ns = (int) ceil(-log10(tolerance / 10.0));
+        p->beta = 2.30 * p->ns;
+    }
+    else
+    {
+        p->ns = (int) ceil(-log(tolerance) / (M_PI * sqrt(1.0 - 1.0 / sigma)));
+        p->beta = 0.97 * M_PI * (1.0 - 0.5 / sigma) * p->ns;
+    }
+    if (p->ns < 2) p->ns = 2;
+    if (p->ns > MAX_NS) p->ns = MAX_NS;
+
+    /* Get Gauss-Legendre nodes in (0, 1) for the kernel transform,
+     * and fold the kernel values into the weights. */
+    p->nq = 2 * p->ns + 2;
+    n = 2 * p->nq;
+    for (i = 0; i < p->nq; ++i)
+    {
+        int iter, k;
+        double x, p0, p1, p2, dp = 1.0;
+        x = cos(M_PI * (i + 0.75) / (n + 0.5));
+        for (iter = 0; iter < 100; ++iter)
+        {
+            double dx;
+            p0 = 1.0; p1 = x;
+            for (k = 2; k <= n; ++k)
+            {
+                p2 = ((2 * k - 1) * x * p1 - (k - 1) * p0) / k;
+                p0 = p1; p1 = p2;
+            }
+            dp = n * (x * p1 - p0) / (x * x - 1.0);
+            dx = p1 / dp;
+            x -= dx;
+            if (fabs(dx) < 1e-15) break;
+        }
+        p->z[i] = x;
+        p->wt[i] = 4.0 / ((1.0 - x * x) * dp * dp) * es_kernel(x, p->beta);
+    }
+
+    /* Set grid sizes in each dimension. */
+    p->size1 = p->size2 = 1.0;
+    for (d = 0; d < 3; ++d)
+    {
+        if (half_x[d] * half_s[d] < 0.1 * tolerance)
+        {
+            p->n1[d] = p->n2[d] = 1;
+            p->gam[d] = p->h1[d] = p->h2[d] = 1.0;
+            continue;
+        }
+        p->n1[d] = next_smooth_even(2.0 * sigma * half_x[d] * half_s[d] /
+                M_PI + p->ns + 1);
+        p->n2[d] = next_smooth_even(sigma * p->n1[d] > 2 * p->ns ?
+                sigma * p->n1[d] : 2 * p->ns);
+        if (p->n1[d] < 0 || p->n2[d] < 0)
+        {
+            p->size1 = p->size2 = DBL_MAX;
+            return;
+        }
+        p->gam[d] = p->n1[d] / (2.0 * sigma * half_s[d]);
+        p->h1[d] = 2.0 * M_PI / p->n1[d];
+        p->h2[d] = 2.0 * M_PI / p->n2[d];
+        p->size1 *= p->n1[d];
+        p->size2 *= p->n2[d];
+    }
+}
+
+/* Chooses the upsampling factor: a smaller one is used for large grids. */
+static void plan(const double half_x[3], const double half_s[3],
+        double tolerance, Plan* p)
+{
+    set_up_plan(half_x, half_s, tolerance, 2.0, p);
+    if (p->size2 > LARGE_GRID)
+    {
+        Plan q;
+        set_up_plan(half_x, half_s, tolerance, 1.25, &q);
+        if (q.size2 < p->size2) *p = q;
+    }
+}
+
+/* Evaluates the kernel weights for a position in one dimension,
+ * and returns the index of the first grid point. */
+static int kernel_weights(const Plan* p, int n, double pos, double* ker)
+{
+    int i, i0;
+    if (n == 1)
+    {
+        ker[0] = 1.0;
+        return 0;
+    }
+    i0 = (int) ceil(pos - 0.5 * p->ns);
+    for (i = 0; i < p->ns; ++i)
+        ker[i] = es_kernel((i0 + i - pos) * 2.0 / p->ns, p->beta);
+    return i0;
+}
+
+static void get_range(int num, const double* a, double sign,
+        double* centre, double* half_width)
+{
+    int i;
+    double min_val, max_val;
+    if (!a || num == 0)
+    {
+        *centre = *half_width = 0.0;
+        return;
+    }
+    min_val = max_val = a[0];
+    for (i = 1; i < num; ++i)
+    {
+        if (a[i] < min_val) min_val = a[i];
+        if (a[i] > max_val) max_val = a[i];
+    }
+    *centre = sign * 0.5 * (max_val + min_val);
+    *half_width = 0.5 * (max_val - min_val);
+}
+
+void oskar_nufft3(int num_points, const double* x, const double* y,
+        const double* z, int num_trans, const double2* c, int num_targets,
+        const double* s, const double* t, const double* u, int sign,
+        double tolerance, double2* f, int* status)
+{
+    Plan p;
+    int d, i, k, phase, num_chunks, n_a, n_b, n_c, m_b, m_c;
+    int *chunk_count = 0, *chunk_start = 0, *order = 0;
+    double cx[3], cs[3], half_x[3], half_s[3], scale_x[3], scale_s[3];
+    double sgn, *deconv[3] = {0, 0, 0};
+    double2 *grid = 0, *fine = 0;
+    const double* pts[3];
+    const double* tgts[3];
+    if (*status) return;
+    if (num_targets <= 0 || num_trans <= 0) return;
+    if (num_points <= 0)
+    {
+        memset(f, 0, (size_t) num_targets * num_trans * sizeof(double2));
+        return;
+    }
+
+    /* Get the centre and extent of the points and targets. */
+    pts[0] = x; pts[1] = y; pts[2] = z;
+    tgts[0] = s; tgts[1] = t; tgts[2] = u;
+    sgn = sign < 0 ? -1.0 : 1.0;
+    for (d = 0; d < 3; ++d)
+    {
+        get_range(num_points, pts[d], 1.0, &cx[d], &half_x[d]);
+        get_range(num_targets, tgts[d], sgn, &cs[d], &half_s[d]);
+    }
+
+    /* Set up the grids. */
+    plan(half_x, half_s, tolerance, &p);
+    if (2.0 * p.size2 * num_trans > (double) INT_MAX)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    n_a = p.n1[0]; n_b = p.n1[1]; n_c = p.n1[2];
+    m_b = p.n2[1]; m_c = p.n2[2];
+    for (d = 0; d < 3; ++d)
+    {
+        scale_x[d] = 1.0 / (p.gam[d] * p.h1[d]);
+        scale_s[d] = p.gam[d] * p.h1[d] / p.h2[d];
+        if (p.n1[d] == 1) scale_x[d] = scale_s[d] = 0.0;
+    }
+
+    /* Evaluate the deconvolution factors for the upsampled grid. */
+    for (d = 0; d < 3; ++d)
+    {
+        deconv[d] = (double*) malloc(p.n1[d] * sizeof(double));
+        if (!deconv[d])
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            goto fail;
+        }
+        if (p.n1[d] == 1)
+            deconv[d][0] = 1.0;
+        else
+            for (i = 0; i < p.n1[d]; ++i)
+                deconv[d][i] = 2.0 / (p.ns * es_kernel_ft(&p,
+                        (i - p.n1[d] / 2) * p.ns * p.h2[d] / 2.0));
+    }
+
+    /* Allocate the grids. */
+    grid = (double2*) calloc((size_t) p.size1 * num_trans, sizeof(double2));
+    fine = (double2*) calloc((size_t) p.size2 * num_trans, sizeof(double2));
+    order = (int*) malloc(num_points * sizeof(int));
+    if (!grid || !fine || !order)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        goto fail;
+    }
+
+    /* Sort the points into slabs along the first dimension, so that
+     * alternate slabs can be spread concurrently without overlapping. */
+    num_chunks = (n_a > 1) ? n_a / p.ns : 1;
+    if (num_chunks > 1 && num_chunks % 2) num_chunks--;
+    if (num_chunks < 2) num_chunks = 1;
+    chunk_count = (int*) calloc(num_chunks, sizeof(int));
+    chunk_start = (int*) calloc(num_chunks + 1, sizeof(int));
+    if (!chunk_count || !chunk_start)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        goto fail;
+    }
+    for (i = 0; i < num_points; ++i)
+    {
+        int i0 = 0;
+        if (n_a > 1)
+            i0 = (int) ceil((x[i] - cx[0]) * scale_x[0] - 0.5 * p.ns);
+        i0 = wrap(i0 + n_a / 2, n_a);
+        order[i] = (int) (((long long) i0 * num_chunks) / n_a);
+        chunk_count[order[i]]++;
+    }
+    for (k = 0; k < num_chunks; ++k)
+        chunk_start[k + 1] = chunk_start[k] + chunk_count[k];
+    {
+        int* chunk = order;
+        order = (int*) malloc(num_points * sizeof(int));
+        if (!order)
+        {
+            order = chunk;
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            goto fail;
+        }
+        memset(chunk_count, 0, num_chunks * sizeof(int));
+        for (i = 0; i < num_points; ++i)
+        {
+            k = chunk[i];
+            order[chunk_start[k] + chunk_count[k]++] = i;
+        }
+        free(chunk);
+    }
+
+    /* Spread the point strengths onto the grid. */
+    for (phase = 0; phase < 2; ++phase)
+    {
+        #pragma omp parallel for private(k, d) schedule(dynamic, 1)
+        for (k = phase; k < num_chunks; k += 2)
+        {
+            int j, ia, ib, ic, tr, i0[3], w[3];
+            double ker[3][MAX_NS];
+            for (d = 0; d < 3; ++d) w[d] = (p.n1[d] == 1) ? 1 : p.ns;
+            for (j = chunk_start[k]; j < chunk_start[k + 1]; ++j)
+            {
+                double arg = 0.0, re, im;
+                const int src = order[j];
+                const double2* c_src = &c[(size_t) src * num_trans];
+                for (d = 0; d < 3; ++d)
+                {
+                    const double dx = pts[d] ? pts[d][src] - cx[d] : 0.0;
+                    arg += cs[d] * dx;
+                    i0[d] = kernel_weights(&p, p.n1[d], dx * scale_x[d],
+                            ker[d]) + p.n1[d] / 2;
+                }
+                re = cos(arg); im = sin(arg);
+                for (ia = 0; ia < w[0]; ++ia)
+                {
+                    const int ja = wrap(i0[0] + ia, n_a);
+                    for (ib = 0; ib < w[1]; ++ib)
+                    {
+                        const int jb = wrap(i0[1] + ib, n_b);
+                        const double k_ab = ker[0][ia] * ker[1][ib];
+                        for (ic = 0; ic < w[2]; ++ic)
+                        {
+                            const int jc = wrap(i0[2] + ic, n_c);
+                            const double k_abc = k_ab * ker[2][ic];
+                            double2* g = &grid[(((size_t) ja * n_b + jb) *
+                                    n_c + jc) * num_trans];
+                            for (tr = 0; tr < num_trans; ++tr)
+                            {
+                                const double2 v = c_src[tr];
+                                g[tr].x += k_abc * (v.x * re - v.y * im);
+                                g[tr].y += k_abc * (v.x * im + v.y * re);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /* Deconvolve the grid and pad it into the upsampled grid. */
+    #pragma omp parallel for private(i)
+    for (i = 0; i < n_a; ++i)
+    {
+        int ib, ic, tr;
+        const int ka = wrap(i - n_a / 2, p.n2[0]);
+        for (ib = 0; ib < n_b; ++ib)
+        {
+            const int kb = wrap(ib - n_b / 2, m_b);
+            const double f_ab = deconv[0][i] * deconv[1][ib];
+            for (ic = 0; ic < n_c; ++ic)
+            {
+                const int kc = wrap(ic - n_c / 2, m_c);
+                const double f_abc = f_ab * deconv[2][ic];
+                const double2* g = &grid[(((size_t) i * n_b + ib) *
+                        n_c + ic) * num_trans];
+                double2* h = &fine[(((size_t) ka * m_b + kb) *
+                        m_c + kc) * num_trans];
+                for (tr = 0; tr < num_trans; ++tr)
+                {
+                    h[tr].x = f_abc * g[tr].x;
+                    h[tr].y = f_abc * g[tr].y;
+                }
+            }
+        }
+    }
+    free(grid);
+    grid = 0;
+
+    /* Transform the upsampled grid along each dimension. */
+    for (d = 0; d < 3; ++d)
+    {
+        int n, stride, num_blocks, num_tasks, task, len;
+        double* wsave;
+        n = p.n2[d];
+        if (n == 1) continue;
+        stride = num_trans;
+        for (k = d + 1; k < 3; ++k) stride *= p.n2[k];
+        num_blocks = (int) (p.size2 * num_trans / ((double) n * stride));
+        num_tasks = num_blocks * ((stride + FFT_LOT - 1) / FFT_LOT);
+        len = 2 * n + (int) (log((double) n) / log(2.0)) + 4;
+        wsave = (double*) malloc(len * sizeof(double));
+        if (!wsave)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            goto fail;
+        }
+        oskar_fftpack_cfftmi(n, wsave);
+        #pragma omp parallel private(task)
+        {
+            double* work = (double*) malloc(2 * FFT_LOT * n * sizeof(double));
+            #pragma omp for schedule(dynamic, 1)
+            for (task = 0; task < num_tasks; ++task)
+            {
+                const int tasks_per_block = (stride + FFT_LOT - 1) / FFT_LOT;
+                const int block = task / tasks_per_block;
+                const int r0 = (task % tasks_per_block) * FFT_LOT;
+                const int lot = (stride - r0 < FFT_LOT) ?
+                        stride - r0 : FFT_LOT;
+                if (!work) continue;
+                oskar_fftpack_cfftmb(lot, 1, n, stride, (double*)
+                        &fine[(size_t) block * n * stride + r0], wsave, work);
+            }
+            if (!work)
+            {
+                #pragma omp critical
+                *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            }
+            free(work);
+        }
+        free(wsave);
+        if (*status) goto fail;
+    }
+
+    /* Interpolate the transformed grid at each target. */
+    #pragma omp parallel for private(k, d)
+    for (k = 0; k < num_targets; ++k)
+    {
+        int ia, ib, ic, tr, i0[3], w[3];
+        double ker[3][MAX_NS], arg = 0.0, scale = 1.0, re, im;
+        double2 sum[4], *acc = sum;
+        if (num_trans > 4)
+            acc = (double2*) malloc(num_trans * sizeof(double2));
+        if (!acc)
+        {
+            #pragma omp critical
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            continue;
+        }
+        for (tr = 0; tr < num_trans; ++tr) acc[tr].x = acc[tr].y = 0.0;
+        for (d = 0; d < 3; ++d)
+        {
+            const double sk = tgts[d] ? sgn * tgts[d][k] : 0.0;
+            const double ds = sk - cs[d];
+            arg += sk * cx[d];
+            w[d] = (p.n2[d] == 1) ? 1 : p.ns;
+            i0[d] = kernel_weights(&p, p.n2[d], ds * scale_s[d], ker[d]);
+            if (p.n2[d] > 1)
+                scale *= 2.0 / (p.ns * es_kernel_ft(&p,
+                        ds * p.gam[d] * p.ns * p.h1[d] / 2.0));
+        }
+        for (ia = 0; ia < w[0]; ++ia)
+        {
+            const int ja = wrap(i0[0] + ia, p.n2[0]);
+            for (ib = 0; ib < w[1]; ++ib)
+            {
+                const int jb = wrap(i0[1] + ib, m_b);
+                const double k_ab = ker[0][ia] * ker[1][ib];
+                for (ic = 0; ic < w[2]; ++ic)
+                {
+                    const int jc = wrap(i0[2] + ic, m_c);
+                    const double k_abc = k_ab * ker[2][ic];
+                    const double2* h = &fine[(((size_t) ja * m_b + jb) *
+                            m_c + jc) * num_trans];
+                    for (tr = 0; tr < num_trans; ++tr)
+                    {
+                        acc[tr].x += k_abc * h[tr].x;
+                        acc[tr].y += k_abc * h[tr].y;
+                    }
+                }
+            }
+        }
+        re = scale * cos(arg); im = scale * sin(arg);
+        for (tr = 0; tr < num_trans; ++tr)
+        {
+            double2* out = &f[(size_t) k * num_trans + tr];
+            out->x = acc[tr].x * re - acc[tr].y * im;
+            out->y = acc[tr].x * im + acc[tr].y * re;
+        }
+        if (acc != sum) free(acc);
+    }
+
+fail:
+    for (d = 0; d < 3; ++d) free(deconv[d]);
+    free(grid);
+    free(fine);
+    free(order);
+    free(chunk_count);
+    free(chunk_start);
+}
+
+double oskar_nufft3_cost(int num_points, int num_targets, int num_trans,
+        const double point_range[3], const double target_range[3],
+        double tolerance, size_t* grid_size)
+{
+    Plan p;
+    int d, num_dims = 0;
+    double half_x[3], half_s[3], direct, cost, cells;
+    for (d = 0; d < 3; ++d)
+    {
+        half_x[d] = 0.5 * fabs(point_range[d]);
+        half_s[d] = 0.5 * fabs(target_range[d]);
+    }
+    plan(half_x, half_s, tolerance, &p);
+    if (grid_size)
+        *grid_size = (p.size2 < (double) ((size_t) -1)) ?
+                (size_t) p.size2 : (size_t) -1;
+    if (p.size2 == DBL_MAX || 2.0 * p.size2 * num_trans > (double) INT_MAX)
+        return DBL_MAX;
+    for (d = 0; d < 3; ++d) if (p.n2[d] > 1) num_dims++;
+
+    /* Count operations, taking a complex exponential to cost 20. */
+    direct = (double) num_points * num_targets * (20.0 + 4.0 * num_trans);
+    if (direct <= 0.0) return 1.0;
+    cells = pow((double) p.ns, num_dims);
+    cost = ((double) num_points + num_targets) *
+            (num_dims * p.ns * 20.0 + cells * 4.0 * num_trans);
+    cost += (double) num_targets * num_dims * p.nq * 20.0;
+    cost += p.size2 * num_trans * (5.0 * log(p.size2) / log(2.0) + 4.0);
+    return cost / direct;
+}
+
+size_t oskar_nufft3_memory_bytes(int num_points, int num_trans,
+        const double point_range[3], const double target_range[3],
+        double tolerance)
+{
+    Plan p;
+    int d;
+    double half_x[3], half_s[3], bytes;
+    for (d = 0; d < 3; ++d)
+    {
+        half_x[d] = 0.5 * fabs(point_range[d]);
+        half_s[d] = 0.5 * fabs(target_range[d]);
+    }
+    plan(half_x, half_s, tolerance, &p);
+    bytes = (p.size1 + p.size2) * num_trans * sizeof(double2) +
+            2.0 * num_points * sizeof(int);
+    return (bytes < (double) ((size_t) -1)) ? (size_t) bytes : (size_t) -1;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_dftw.h"
+#include "math/oskar_dftw_nufft.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cmath>
+#include <cstdlib>
+
+static oskar_Mem* random_array(int type, int n, double scale, int* status)
+{
+    oskar_Mem* m = oskar_mem_create(type, OSKAR_CPU, n, status);
+    for (int i = 0; i < n; ++i)
+        oskar_mem_set_element_real(m, i,
+                scale * (rand() / (double)RAND_MAX - 0.5), status);
+    return m;
+}
+
+static double max_error(int type, int is_3d, int num_in, int num_out,
+        double tolerance, int* status)
+{
+    const double wavenumber = 2.0 * M_PI * 100e6 / 299792458.0;
+    double max_err = 0.0, sum_w = 0.0;
+    srand(1);
+
+    // Element positions in a 40 m station, and directions over the sky.
+    oskar_Mem* x_in = random_array(type, num_in, 40.0, status);
+    oskar_Mem* y_in = random_array(type, num_in, 40.0, status);
+    oskar_Mem* z_in = random_array(type, num_in, 1.0, status);
+    oskar_Mem* x_out = random_array(type, num_out, 1.4, status);
+    oskar_Mem* y_out = random_array(type, num_out, 1.4, status);
+    oskar_Mem* z_out = random_array(type, num_out, 1.0, status);
+    oskar_Mem* weights = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_in, status);
+    for (int i = 0; i < num_in; ++i)
+    {
+        double2 w;
+        w.x = rand() / (double)RAND_MAX - 0.5;
+        w.y = rand() / (double)RAND_MAX - 0.5;
+        sum_w += sqrt(w.x * w.x + w.y * w.y);
+        if (type == OSKAR_DOUBLE)
+            oskar_mem_double2(weights, status)[i] = w;
+        else
+        {
+            oskar_mem_float2(weights, status)[i].x = (float) w.x;
+            oskar_mem_float2(weights, status)[i].y = (float) w.y;
+        }
+    }
+
+    // Compare the non-uniform FFT with the DFT.
+    oskar_Mem* out_dft = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_out, status);
+    oskar_Mem* out_nufft = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_out, status);
+    oskar_dftw(num_in, wavenumber, x_in, y_in, is_3d ? z_in : 0, weights,
+            num_out, x_out, y_out, is_3d ? z_out : 0, 0, out_dft, status);
+    oskar_dftw_nufft(num_in, wavenumber, x_in, y_in, is_3d ? z_in : 0,
+            weights, num_out, x_out, y_out, is_3d ? z_out : 0, tolerance,
+            out_nufft, status);
+    for (int i = 0; i < num_out && !*status; ++i)
+    {
+        double2 a = oskar_mem_get_element_complex(out_dft, i, status);
+        double2 b = oskar_mem_get_element_complex(out_nufft, i, status);
+        double err = sqrt(pow(a.x - b.x, 2.0) + pow(a.y - b.y, 2.0)) / sum_w;
+        if (err > max_err) max_err = err;
+    }
+    oskar_mem_free(x_in, status);
+    oskar_mem_free(y_in, status);
+    oskar_mem_free(z_in, status);
+    oskar_mem_free(x_out, status);
+    oskar_mem_free(y_out, status);
+    oskar_mem_free(z_out, status);
+    oskar_mem_free(weights, status);
+    oskar_mem_free(out_dft, status);
+    oskar_mem_free(out_nufft, status);
+    return max_err;
+}
+
+TEST(dftw_nufft, accuracy_2d)
+{
+    int status = 0;
+    double err = max_error(OSKAR_DOUBLE, 0, 500, 2000, 1e-8, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(err, 1e-7);
+    err = max_error(OSKAR_DOUBLE, 0, 500, 2000, 1e-3, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(err, 1e-2);
+}
+
+TEST(dftw_nufft, accuracy_3d)
+{
+    int status = 0;
+    double err = max_error(OSKAR_DOUBLE, 1, 500, 2000, 1e-8, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(err, 1e-7);
+}
+
+TEST(dftw_nufft, accuracy_single)
+{
+    int status = 0;
+    double err = max_error(OSKAR_SINGLE, 0, 500, 2000, 1e-5, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(err, 1e-4);
+}
+
+TEST(dftw_nufft, cost)
+{
+    int status = 0;
+    const double wavenumber = 2.0 * M_PI * 100e6 / 299792458.0;
+    oskar_Mem *x_in, *y_in, *x_out, *y_out;
+
+    // Large station and many directions: non-uniform FFT is cheaper.
+    x_in = random_array(OSKAR_DOUBLE, 5000, 40.0, &status);
+    y_in = random_array(OSKAR_DOUBLE, 5000, 40.0, &status);
+    x_out = random_array(OSKAR_DOUBLE, 100000, 2.0, &status);
+    y_out = random_array(OSKAR_DOUBLE, 100000, 2.0, &status);
+    EXPECT_LT(oskar_dftw_nufft_cost(5000, wavenumber, x_in, y_in, 0,
+            100000, x_out, y_out, 0, 1e-6, &status), 1.0);
+
+    // Few directions: DFT is cheaper.
+    EXPECT_GT(oskar_dftw_nufft_cost(5000, wavenumber, x_in, y_in, 0,
+            10, x_out, y_out, 0, 1e-6, &status), 1.0);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_mem_free(x_in, &status);
+    oskar_mem_free(y_in, &status);
+    oskar_mem_free(x_out, &status);
+    oskar_mem_free(y_out, &status);
+}
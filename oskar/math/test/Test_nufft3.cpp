@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_nufft3.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using std::vector;
+
+static double rand_range(double lo, double hi)
+{
+    return lo + (hi - lo) * rand() / ((double) RAND_MAX);
+}
+
+// Returns the largest error relative to the largest output value.
+static double check_nufft3(int num_points, int num_targets, int num_trans,
+        int num_dims, double x_width, double s_width, int sign,
+        double tolerance)
+{
+    int status = 0;
+    vector<double> x(num_points), y(num_points), z(num_points);
+    vector<double> s(num_targets), t(num_targets), u(num_targets);
+    vector<double2> c(num_points * num_trans), f(num_targets * num_trans);
+    for (int j = 0; j < num_points; ++j)
+    {
+        x[j] = rand_range(0.3, 0.3 + x_width);
+        y[j] = rand_range(-0.5 * x_width, 0.5 * x_width);
+        z[j] = rand_range(-0.1 * x_width, 0.0);
+        for (int k = 0; k < num_trans; ++k)
+        {
+            c[j * num_trans + k].x = rand_range(-1.0, 1.0);
+            c[j * num_trans + k].y = rand_range(-1.0, 1.0);
+        }
+    }
+    for (int k = 0; k < num_targets; ++k)
+    {
+        s[k] = rand_range(-0.5 * s_width, 0.5 * s_width);
+        t[k] = rand_range(-0.2 * s_width, 0.8 * s_width);
+        u[k] = rand_range(-0.1 * s_width, 0.1 * s_width);
+    }
+    oskar_nufft3(num_points, &x[0], num_dims > 1 ? &y[0] : 0,
+            num_dims > 2 ? &z[0] : 0, num_trans, &c[0], num_targets,
+            &s[0], &t[0], &u[0], sign, tolerance, &f[0], &status);
+    EXPECT_EQ(0, status);
+
+    // Compare with direct evaluation.
+    double max_err = 0.0, max_val = 0.0;
+    for (int k = 0; k < num_targets; ++k)
+    {
+        for (int tr = 0; tr < num_trans; ++tr)
+        {
+            double re = 0.0, im = 0.0;
+            for (int j = 0; j < num_points; ++j)
+            {
+                double phase = s[k] * x[j];
+                if (num_dims > 1) phase += t[k] * y[j];
+                if (num_dims > 2) phase += u[k] * z[j];
+                phase *= sign;
+                const double2 v = c[j * num_trans + tr];
+                re += v.x * cos(phase) - v.y * sin(phase);
+                im += v.x * sin(phase) + v.y * cos(phase);
+            }
+            const double2 r = f[k * num_trans + tr];
+            const double err = sqrt(pow(r.x - re, 2) + pow(r.y - im, 2));
+            const double val = sqrt(re * re + im * im);
+            if (err > max_err) max_err = err;
+            if (val > max_val) max_val = val;
+        }
+    }
+    return max_err / max_val;
+}
+
+TEST(nufft3, accuracy_1d)
+{
+    srand(1);
+    EXPECT_LT(check_nufft3(1000, 500, 1, 1, 2.0, 400.0, 1, 1e-6), 1e-5);
+}
+
+TEST(nufft3, accuracy_2d)
+{
+    srand(2);
+    EXPECT_LT(check_nufft3(2000, 300, 2, 2, 0.4, 800.0, -1, 1e-8), 1e-7);
+    EXPECT_LT(check_nufft3(2000, 300, 1, 2, 0.4, 800.0, 1, 1e-3), 1e-2);
+}
+
+TEST(nufft3, accuracy_3d)
+{
+    srand(3);
+    EXPECT_LT(check_nufft3(3000, 400, 4, 3, 0.2, 600.0, 1, 1e-6), 1e-5);
+}
+
+TEST(nufft3, cost)
+{
+    // A large number of points and targets in a small volume.
+    const double x_range[] = {0.2, 0.2, 0.01};
+    const double s_range[] = {2000.0, 2000.0, 100.0};
+    size_t grid_size = 0;
+    double ratio = oskar_nufft3_cost(1000000, 100000, 4,
+            x_range, s_range, 1e-6, &grid_size);
+    EXPECT_LT(ratio, 0.1);
+    EXPECT_GT(grid_size, 0u);
+
+    // Only a few points.
+    ratio = oskar_nufft3_cost(10, 100000, 4,
+            x_range, s_range, 1e-6, &grid_size);
+    EXPECT_GT(ratio, 1.0);
+}
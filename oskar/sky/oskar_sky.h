@@ -62,7 +62,9 @@ enum OSKAR_SKY_TAGS
     OSKAR_SKY_TAG_FWHM_MAJOR = 11,
     OSKAR_SKY_TAG_FWHM_MINOR = 12,
     OSKAR_SKY_TAG_POSITION_ANGLE = 13,
-    OSKAR_SKY_TAG_ROTATION_MEASURE = 14
+    OSKAR_SKY_TAG_ROTATION_MEASURE = 14,
+    OSKAR_SKY_TAG_SPECTRAL_FREQ = 15,
+    OSKAR_SKY_TAG_SPECTRAL_STOKES_I = 16
 };
 
 #ifdef __cplusplus
@@ -72,6 +74,7 @@ enum OSKAR_SKY_TAGS
 #include <sky/oskar_sky_accessors.h>
 #include <sky/oskar_sky_append_to_set.h>
 #include <sky/oskar_sky_append.h>
+#include <sky/oskar_sky_compact.h>
 #include <sky/oskar_sky_copy.h>
 #include <sky/oskar_sky_copy_contents.h>
 #include <sky/oskar_sky_create.h>
@@ -81,7 +84,9 @@ enum OSKAR_SKY_TAGS
 #include <sky/oskar_sky_filter_by_flux.h>
 #include <sky/oskar_sky_filter_by_radius.h>
 #include <sky/oskar_sky_free.h>
+#include <sky/oskar_sky_from_fits_cube.h>
 #include <sky/oskar_sky_from_fits_file.h>
+#include <sky/oskar_sky_from_fits_table.h>
 #include <sky/oskar_sky_from_healpix_ring.h>
 #include <sky/oskar_sky_from_image.h>
 #include <sky/oskar_sky_generate_grid.h>
@@ -96,6 +101,7 @@ enum OSKAR_SKY_TAGS
 #include <sky/oskar_sky_scale_flux_with_frequency.h>
 #include <sky/oskar_sky_set_gaussian_parameters.h>
 #include <sky/oskar_sky_set_source.h>
+#include <sky/oskar_sky_set_spectral_channels.h>
 #include <sky/oskar_sky_set_spectral_index.h>
 #include <sky/oskar_sky_write.h>
 
@@ -344,6 +344,58 @@ oskar_Mem* oskar_sky_rotation_measure_rad(oskar_Sky* sky);
 OSKAR_EXPORT
 const oskar_Mem* oskar_sky_rotation_measure_rad_const(const oskar_Sky* sky);
 
+/**
+ * @brief Returns the number of channels in the tabulated source spectra.
+ *
+ * @details
+ * Returns the number of channels in the tabulated source spectra,
+ * or 0 if the sky model does not contain tabulated spectra.
+ *
+ * @param[in] sky Pointer to sky model.
+ */
+OSKAR_EXPORT
+int oskar_sky_num_spectral_channels(const oskar_Sky* sky);
+
+/**
+ * @brief Returns a handle to the frequencies of the tabulated spectra, in Hz.
+ *
+ * @details
+ * Returns a handle to the frequencies of the tabulated source spectra,
+ * in Hz. These are always held in double precision in host memory.
+ *
+ * @param[in] sky Pointer to sky model.
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_sky_spectral_freq_hz_const(const oskar_Sky* sky);
+
+/**
+ * @brief Returns a handle to the tabulated source Stokes I spectra, in Jy.
+ *
+ * @details
+ * Returns a handle to the tabulated Stokes I spectra, in Jy.
+ *
+ * Values for each source are stored contiguously, so the flux of
+ * source \p s in channel \p c is at index
+ * (s * oskar_sky_num_spectral_channels() + c).
+ *
+ * @param[in] sky Pointer to sky model.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_sky_spectral_I(oskar_Sky* sky);
+
+/**
+ * @brief Returns a handle to the tabulated source Stokes I spectra, in Jy
+ * (const version).
+ *
+ * @details
+ * Returns a handle to the tabulated Stokes I spectra, in Jy
+ * (const version).
+ *
+ * @param[in] sky Pointer to sky model.
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_sky_spectral_I_const(const oskar_Sky* sky);
+
 /**
  * @brief Returns a handle to the source l-direction cosines.
  *
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SKY_COMPACT_H_
+#define OSKAR_SKY_COMPACT_H_
+
+/**
+ * @file oskar_sky_compact.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Merges sky model components that are closer than a given separation.
+ *
+ * @details
+ * This function returns a new sky model in which groups of point sources
+ * closer together than \p max_separation_rad are merged into single
+ * components. The separation would normally be chosen as a small fraction
+ * of the interferometer resolution, lambda_min / B_max, so that the merged
+ * components are unresolved.
+ *
+ * Groups are formed around the brightest remaining source. Each merged
+ * component is placed at the flux-weighted centroid of the group,
+ * and has the sum of the Stokes parameters of all group members at the
+ * reference frequency, which is set to the geometric mean of
+ * \p freq_min_hz and \p freq_max_hz. The spectral index is obtained from a
+ * least-squares fit to the summed spectrum over the same frequency range,
+ * and the rotation measure is the polarised-flux-weighted mean of the group.
+ * Tabulated spectra, if present, are summed exactly.
+ *
+ * Only point sources with positive Stokes I are merged: Gaussian sources
+ * and sources with non-positive flux are copied unchanged.
+ *
+ * If \p max_baseline_m is positive, an estimate of the largest visibility
+ * amplitude error introduced by the merging (at the longest baseline and
+ * highest frequency) is returned in \p vis_error_jy. As each merged
+ * component is at the flux-weighted centroid, the first-order phase error
+ * cancels, and this is given by
+ * 2 pi^2 (B_max / lambda_min)^2 sum_i(S_i d_i^2), where d_i is the angular
+ * distance from each component to its merged position.
+ *
+ * The input sky model must be in host memory.
+ *
+ * @param[in] sky                Input sky model.
+ * @param[in] max_separation_rad Maximum separation of merged components,
+ *                               in radians.
+ * @param[in] freq_min_hz        Lowest frequency of interest, in Hz.
+ * @param[in] freq_max_hz        Highest frequency of interest, in Hz.
+ * @param[in] max_baseline_m     Longest baseline length, in metres.
+ * @param[out] vis_error_jy      If not NULL, predicted visibility error, in Jy.
+ * @param[in,out] status         Status return code.
+ *
+ * @return A handle to the compacted sky model.
+ */
+OSKAR_EXPORT
+oskar_Sky* oskar_sky_compact(const oskar_Sky* sky, double max_separation_rad,
+        double freq_min_hz, double freq_max_hz, double max_baseline_m,
+        double* vis_error_jy, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SKY_COMPACT_H_ */
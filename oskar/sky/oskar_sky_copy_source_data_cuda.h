@@ -191,6 +191,50 @@ void oskar_sky_copy_source_data_cuda_d(int num,
         const double* pa_in,   double* pa_out
         );
 
+/**
+ * @brief
+ * Copies tabulated source spectra based on mask values (single precision).
+ *
+ * @details
+ * Copies the tabulated spectrum of each source wherever the input mask
+ * value is true.
+ *
+ * Note that all arrays must be in device memory.
+ *
+ * @param[in] num       Number of input sources.
+ * @param[in] num_chan  Number of channels in each spectrum.
+ * @param[in] mask      Input mask values.
+ * @param[in] indices   Indices into output array from prefix sum.
+ * @param[in] spec_in   Input spectra.
+ * @param[out] spec_out Output spectra.
+ */
+OSKAR_EXPORT
+void oskar_sky_copy_source_spectra_cuda_f(int num, int num_chan,
+        const int* mask, const int* indices,
+        const float* spec_in, float* spec_out);
+
+/**
+ * @brief
+ * Copies tabulated source spectra based on mask values (double precision).
+ *
+ * @details
+ * Copies the tabulated spectrum of each source wherever the input mask
+ * value is true.
+ *
+ * Note that all arrays must be in device memory.
+ *
+ * @param[in] num       Number of input sources.
+ * @param[in] num_chan  Number of channels in each spectrum.
+ * @param[in] mask      Input mask values.
+ * @param[in] indices   Indices into output array from prefix sum.
+ * @param[in] spec_in   Input spectra.
+ * @param[out] spec_out Output spectra.
+ */
+OSKAR_EXPORT
+void oskar_sky_copy_source_spectra_cuda_d(int num, int num_chan,
+        const int* mask, const int* indices,
+        const double* spec_in, double* spec_out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SKY_FROM_FITS_TABLE_H_
+#define OSKAR_SKY_FROM_FITS_TABLE_H_
+
+/**
+ * @file oskar_sky_from_fits_table.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Loads a sky model from a FITS binary table catalogue.
+ *
+ * @details
+ * This function reads the first table extension of a FITS file into a new
+ * sky model. Columns are read in bulk directly into the sky model arrays,
+ * with conversion from the stored data type to the sky model precision,
+ * and from the physical units given by the TUNITn keywords.
+ *
+ * The names of the columns to use are given in \p column_names, which must
+ * contain 12 entries in the order:
+ * RA, Dec, Stokes I, Q, U, V, reference frequency, spectral index,
+ * rotation measure, FWHM major axis, FWHM minor axis and position angle.
+ * If an entry is NULL or empty, a list of common names is tried
+ * (for example, "RAJ2000" or "Total_flux"), and the parameter is set to
+ * zero if none are found. The RA, Dec and Stokes I columns must exist.
+ *
+ * Unless specified by the TUNITn keywords, angles are assumed to be in
+ * degrees (FWHM values in arcsec), fluxes in Jy and frequencies in Hz.
+ * If no reference frequency column is present, \p default_ref_freq_hz
+ * is used for all sources.
+ *
+ * If the CFITSIO library is thread-safe, ranges of rows are read in
+ * parallel using up to \p num_threads threads.
+ *
+ * @param[in] precision           Enumerated precision of the output sky model.
+ * @param[in] filename            Path to the FITS file to read.
+ * @param[in] column_names        Array of 12 column names (entries may be NULL).
+ * @param[in] default_ref_freq_hz Reference frequency used if no column exists.
+ * @param[in] num_threads         Number of threads to use (0 for all CPUs).
+ * @param[in,out] status          Status return code.
+ *
+ * @return A handle to the new sky model.
+ */
+OSKAR_EXPORT
+oskar_Sky* oskar_sky_from_fits_table(int precision, const char* filename,
+        const char* const* column_names, double default_ref_freq_hz,
+        int num_threads, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SKY_FROM_FITS_TABLE_H_ */
@@ -116,6 +116,10 @@ void oskar_sky_scale_flux_with_frequency_d(int num_sources, double frequency,
  * This function scales all the existing source brightnesses using the spectral
  * index and the given frequency.
  *
+ * If the sky model contains tabulated spectra
+ * (see oskar_sky_set_spectral_channels()), the Stokes I value of each source
+ * is then set by linear interpolation of its spectrum at the given frequency.
+ *
  * @param[in,out] sky The sky model to re-scale.
  * @param[in] frequency The required frequency, in Hz.
  * @param[in,out] status   Status return code.
@@ -115,6 +115,58 @@ void oskar_sky_scale_flux_with_frequency_cuda_d(int num_sources,
         double frequency, double* d_I, double* d_Q, double* d_U, double* d_V,
         double* d_ref_freq, const double* d_sp_index, const double* d_rm);
 
+/**
+ * @brief
+ * CUDA function to interpolate tabulated source spectra
+ * (single precision).
+ *
+ * @details
+ * This function sets the Stokes I value of each source by linear
+ * interpolation between two channels of its tabulated spectrum:
+ *
+ * I = (1 - w) * S[c0] + w * S[c1]
+ *
+ * Note that all pointers are device pointers, and must not be dereferenced
+ * in host code.
+ *
+ * @param[in] num_sources    The number of sources in the input arrays.
+ * @param[in] num_channels   The number of channels in each spectrum.
+ * @param[in] c0             Index of the lower channel.
+ * @param[in] c1             Index of the upper channel.
+ * @param[in] w              Interpolation weight of the upper channel.
+ * @param[in] d_spec         Tabulated source spectra.
+ * @param[out] d_I           Source Stokes I values.
+ */
+OSKAR_EXPORT
+void oskar_sky_interpolate_spectra_cuda_f(int num_sources, int num_channels,
+        int c0, int c1, float w, const float* d_spec, float* d_I);
+
+/**
+ * @brief
+ * CUDA function to interpolate tabulated source spectra
+ * (double precision).
+ *
+ * @details
+ * This function sets the Stokes I value of each source by linear
+ * interpolation between two channels of its tabulated spectrum:
+ *
+ * I = (1 - w) * S[c0] + w * S[c1]
+ *
+ * Note that all pointers are device pointers, and must not be dereferenced
+ * in host code.
+ *
+ * @param[in] num_sources    The number of sources in the input arrays.
+ * @param[in] num_channels   The number of channels in each spectrum.
+ * @param[in] c0             Index of the lower channel.
+ * @param[in] c1             Index of the upper channel.
+ * @param[in] w              Interpolation weight of the upper channel.
+ * @param[in] d_spec         Tabulated source spectra.
+ * @param[out] d_I           Source Stokes I values.
+ */
+OSKAR_EXPORT
+void oskar_sky_interpolate_spectra_cuda_d(int num_sources, int num_channels,
+        int c0, int c1, double w, const double* d_spec, double* d_I);
+
 #ifdef __cplusplus
 }
 #endif
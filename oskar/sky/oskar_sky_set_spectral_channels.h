@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SKY_SET_SPECTRAL_CHANNELS_H_
+#define OSKAR_SKY_SET_SPECTRAL_CHANNELS_H_
+
+/**
+ * @file oskar_sky_set_spectral_channels.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Sets the frequency axis of tabulated source spectra in a sky model.
+ *
+ * @details
+ * This function enables tabulated Stokes I spectra in the sky model,
+ * which can be used to describe spectral-line or other non-power-law
+ * sources. All sources share the same frequency axis, which must be
+ * given in increasing order.
+ *
+ * When the sky model contains tabulated spectra, the Stokes I flux of each
+ * source is obtained by linear interpolation of its spectrum whenever
+ * oskar_sky_scale_flux_with_frequency() is called. (Values outside the
+ * tabulated range are clamped to the end channels.)
+ *
+ * The spectra of sources already in the sky model are initialised from
+ * their Stokes I flux, reference frequency and spectral index.
+ * This can only be done in host memory.
+ *
+ * If \p num_channels is 0, tabulated spectra are disabled.
+ *
+ * @param[in,out] sky        Pointer to sky model.
+ * @param[in] num_channels   Number of frequency channels in the spectra.
+ * @param[in] freq_hz        Channel frequencies, in Hz.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_set_spectral_channels(oskar_Sky* sky, int num_channels,
+        const double* freq_hz, int* status);
+
+/**
+ * @brief
+ * Fills tabulated spectra of sources using their spectral index.
+ *
+ * @details
+ * This function evaluates the Stokes I flux of the given range of sources
+ * at each tabulated frequency, using the reference frequency and spectral
+ * index of each source, and stores the results in the tabulated spectra.
+ *
+ * The sky model must be in host memory.
+ *
+ * @param[in,out] sky        Pointer to sky model.
+ * @param[in] offset         Index of the first source to update.
+ * @param[in] num_sources    Number of sources to update.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_evaluate_power_law_spectra(oskar_Sky* sky, int offset,
+        int num_sources, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SKY_SET_SPECTRAL_CHANNELS_H_ */
@@ -60,6 +60,10 @@ struct oskar_Sky
     oskar_Mem* spectral_index; /**< Spectral index. */
     oskar_Mem* rm_rad;         /**< Rotation measure, in radians / m^2. */
 
+    int num_spectral_channels; /**< Number of channels in tabulated spectra. */
+    oskar_Mem* spectral_freq_hz; /**< Frequencies of tabulated spectra, in Hz (in host memory). */
+    oskar_Mem* spectral_I;     /**< Tabulated Stokes-I spectrum of each source, in Jy. */
+
     double reference_ra_rad;   /**< Reference right ascension, in radians. */
     double reference_dec_rad;  /**< Reference declination, in radians. */
     oskar_Mem* l;              /**< Phase centre relative l-direction cosines. */
@@ -163,6 +163,26 @@ const oskar_Mem* oskar_sky_rotation_measure_rad_const(const oskar_Sky* sky)
     return sky->rm_rad;
 }
 
+int oskar_sky_num_spectral_channels(const oskar_Sky* sky)
+{
+    return sky->num_spectral_channels;
+}
+
+const oskar_Mem* oskar_sky_spectral_freq_hz_const(const oskar_Sky* sky)
+{
+    return sky->spectral_freq_hz;
+}
+
+oskar_Mem* oskar_sky_spectral_I(oskar_Sky* sky)
+{
+    return sky->spectral_I;
+}
+
+const oskar_Mem* oskar_sky_spectral_I_const(const oskar_Sky* sky)
+{
+    return sky->spectral_I;
+}
+
 oskar_Mem* oskar_sky_l(oskar_Sky* sky)
 {
     return sky->l;
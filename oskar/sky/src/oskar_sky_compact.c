@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sky/private_sky.h"
+#include "sky/oskar_sky.h"
+#include "sky/private_sky_scale_flux_with_frequency_inline.h"
+#include "math/oskar_angular_distance.h"
+#include "math/oskar_cmath.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUM_FIT_FREQS 8
+
+enum { RA, DEC, I_, Q_, U_, V_, FREQ, SPIX, RM, MAJ, MIN, PA, NUM_COLS };
+
+typedef struct
+{
+    double key;
+    int index;
+} SortItem;
+
+typedef struct
+{
+    int count, first;
+    double w, x, y, z, Q, U, V, P, P_rm, spix, ra, dec;
+    double S[NUM_FIT_FREQS];
+} Group;
+
+static int compare_items(const void* a, const void* b)
+{
+    const double ka = ((const SortItem*)a)->key;
+    const double kb = ((const SortItem*)b)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+static double power_law(double freq_hz, double I, double ref_freq_hz,
+        double spix)
+{
+    return (ref_freq_hz > 0.0) ? I * pow(freq_hz / ref_freq_hz, spix) : I;
+}
+
+oskar_Sky* oskar_sky_compact(const oskar_Sky* sky, double max_separation_rad,
+        double freq_min_hz, double freq_max_hz, double max_baseline_m,
+        double* vis_error_jy, int* status)
+{
+    int i, j, k, lo, hi, n, num_groups = 0, num_fit, num_channels;
+    int *group = 0, *mergeable = 0;
+    double ref_freq_hz, fit_freq[NUM_FIT_FREQS], *w = 0, error = 0.0;
+    const double* p[NUM_COLS];
+    oskar_Mem* cols[NUM_COLS];
+    SortItem *by_dec = 0, *by_flux = 0;
+    Group* groups = 0;
+    oskar_Sky* out = 0;
+
+    /* Check if safe to proceed. */
+    if (vis_error_jy) *vis_error_jy = 0.0;
+    if (*status) return 0;
+
+    /* Check location and arguments. */
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return 0;
+    }
+    if (freq_max_hz <= 0.0)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return 0;
+    }
+    if (freq_min_hz <= 0.0 || freq_min_hz > freq_max_hz)
+        freq_min_hz = freq_max_hz;
+
+    /* Get double-precision copies of the source parameters. */
+    n = sky->num_sources;
+    cols[RA] = oskar_mem_convert_precision(sky->ra_rad, OSKAR_DOUBLE, status);
+    cols[DEC] = oskar_mem_convert_precision(sky->dec_rad, OSKAR_DOUBLE, status);
+    cols[I_] = oskar_mem_convert_precision(sky->I, OSKAR_DOUBLE, status);
+    cols[Q_] = oskar_mem_convert_precision(sky->Q, OSKAR_DOUBLE, status);
+    cols[U_] = oskar_mem_convert_precision(sky->U, OSKAR_DOUBLE, status);
+    cols[V_] = oskar_mem_convert_precision(sky->V, OSKAR_DOUBLE, status);
+    cols[FREQ] = oskar_mem_convert_precision(sky->reference_freq_hz,
+            OSKAR_DOUBLE, status);
+    cols[SPIX] = oskar_mem_convert_precision(sky->spectral_index,
+            OSKAR_DOUBLE, status);
+    cols[RM] = oskar_mem_convert_precision(sky->rm_rad, OSKAR_DOUBLE, status);
+    cols[MAJ] = oskar_mem_convert_precision(sky->fwhm_major_rad,
+            OSKAR_DOUBLE, status);
+    cols[MIN] = oskar_mem_convert_precision(sky->fwhm_minor_rad,
+            OSKAR_DOUBLE, status);
+    cols[PA] = oskar_mem_convert_precision(sky->pa_rad, OSKAR_DOUBLE, status);
+    for (j = 0; j < NUM_COLS; ++j)
+        p[j] = oskar_mem_double_const(cols[j], status);
+    if (*status) goto fail;
+
+    /* Set the frequencies used for the spectral fit. */
+    ref_freq_hz = sqrt(freq_min_hz * freq_max_hz);
+    num_fit = (freq_max_hz > freq_min_hz) ? NUM_FIT_FREQS : 1;
+    for (k = 0; k < num_fit; ++k)
+        fit_freq[k] = (num_fit == 1) ? freq_max_hz : freq_min_hz *
+                pow(freq_max_hz / freq_min_hz, k / (double)(num_fit - 1));
+
+    /* Sort sources by declination, and by decreasing flux. */
+    group = (int*) malloc(n * sizeof(int));
+    mergeable = (int*) malloc(n * sizeof(int));
+    w = (double*) malloc(n * sizeof(double));
+    by_dec = (SortItem*) malloc(n * sizeof(SortItem));
+    by_flux = (SortItem*) malloc(n * sizeof(SortItem));
+    if (n > 0 && (!group || !mergeable || !w || !by_dec || !by_flux))
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        goto fail;
+    }
+    for (i = 0; i < n; ++i)
+    {
+        group[i] = -1;
+        w[i] = power_law(ref_freq_hz, p[I_][i], p[FREQ][i], p[SPIX][i]);
+        mergeable[i] = (w[i] > 0.0 && p[MAJ][i] == 0.0 && p[MIN][i] == 0.0);
+        by_dec[i].key = p[DEC][i];
+        by_dec[i].index = i;
+        by_flux[i].key = -w[i];
+        by_flux[i].index = i;
+    }
+    qsort(by_dec, n, sizeof(SortItem), compare_items);
+    qsort(by_flux, n, sizeof(SortItem), compare_items);
+
+    /* Group sources around the brightest remaining one. */
+    for (i = 0; i < n; ++i)
+    {
+        const int s = by_flux[i].index;
+        if (group[s] >= 0) continue;
+        group[s] = num_groups;
+        if (mergeable[s] && max_separation_rad > 0.0)
+        {
+            /* Find the first source in the declination band. */
+            const double dec_min = p[DEC][s] - max_separation_rad;
+            const double dec_max = p[DEC][s] + max_separation_rad;
+            lo = 0; hi = n;
+            while (lo < hi)
+            {
+                const int mid = (lo + hi) / 2;
+                if (by_dec[mid].key < dec_min) lo = mid + 1; else hi = mid;
+            }
+            for (j = lo; j < n && by_dec[j].key <= dec_max; ++j)
+            {
+                const int c = by_dec[j].index;
+                if (group[c] >= 0 || !mergeable[c]) continue;
+                if (oskar_angular_distance(p[RA][s], p[RA][c],
+                        p[DEC][s], p[DEC][c]) <= max_separation_rad)
+                    group[c] = num_groups;
+            }
+        }
+        num_groups++;
+    }
+
+    /* Accumulate the properties of each group. */
+    groups = (Group*) calloc(num_groups > 0 ? num_groups : 1, sizeof(Group));
+    if (!groups)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        goto fail;
+    }
+    for (i = 0; i < n; ++i)
+    {
+        double I, Q, U, V, f, P, cos_dec;
+        Group* g = &groups[group[i]];
+        if (g->count++ == 0) g->first = i;
+        if (!mergeable[i]) continue;
+
+        /* Evaluate polarisation at the reference frequency. */
+        I = p[I_][i]; Q = p[Q_][i]; U = p[U_][i]; V = p[V_][i];
+        f = p[FREQ][i];
+        oskar_scale_flux_with_frequency_inline_d(ref_freq_hz,
+                &I, &Q, &U, &V, &f, p[SPIX][i], p[RM][i]);
+        P = sqrt(Q * Q + U * U);
+        cos_dec = cos(p[DEC][i]);
+        g->w += w[i];
+        g->x += w[i] * cos_dec * cos(p[RA][i]);
+        g->y += w[i] * cos_dec * sin(p[RA][i]);
+        g->z += w[i] * sin(p[DEC][i]);
+        g->Q += Q;
+        g->U += U;
+        g->V += V;
+        g->P += P;
+        g->P_rm += P * p[RM][i];
+        g->spix += w[i] * p[SPIX][i];
+        for (k = 0; k < num_fit; ++k)
+            g->S[k] += power_law(fit_freq[k], p[I_][i], p[FREQ][i],
+                    p[SPIX][i]);
+    }
+
+    /* Create the output sky model. */
+    out = oskar_sky_create(oskar_sky_precision(sky), OSKAR_CPU,
+            num_groups, status);
+    out->reference_ra_rad = sky->reference_ra_rad;
+    out->reference_dec_rad = sky->reference_dec_rad;
+    out->use_extended = sky->use_extended;
+    for (j = 0; j < num_groups; ++j)
+    {
+        double spix;
+        Group* g = &groups[j];
+        if (g->count == 1)
+        {
+            /* Copy single sources unchanged. */
+            i = g->first;
+            g->ra = p[RA][i];
+            g->dec = p[DEC][i];
+            oskar_sky_set_source(out, j, p[RA][i], p[DEC][i],
+                    p[I_][i], p[Q_][i], p[U_][i], p[V_][i], p[FREQ][i],
+                    p[SPIX][i], p[RM][i], p[MAJ][i], p[MIN][i], p[PA][i],
+                    status);
+            continue;
+        }
+
+        /* Place the component at the flux-weighted centroid. */
+        g->ra = atan2(g->y, g->x);
+        if (g->ra < 0.0) g->ra += 2.0 * M_PI;
+        g->dec = atan2(g->z, sqrt(g->x * g->x + g->y * g->y));
+
+        /* Fit a spectral index to the summed spectrum. */
+        spix = g->spix / g->w;
+        if (num_fit > 1)
+        {
+            double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+            for (k = 0; k < num_fit; ++k)
+            {
+                const double x = log(fit_freq[k] / ref_freq_hz);
+                const double y = log(g->S[k]);
+                sx += x; sy += y; sxx += x * x; sxy += x * y;
+            }
+            spix = (num_fit * sxy - sx * sy) / (num_fit * sxx - sx * sx);
+        }
+        oskar_sky_set_source(out, j, g->ra, g->dec, g->w, g->Q, g->U, g->V,
+                ref_freq_hz, spix, (g->P > 0.0) ? g->P_rm / g->P : 0.0,
+                0.0, 0.0, 0.0, status);
+    }
+
+    /* Sum tabulated spectra exactly. */
+    num_channels = sky->num_spectral_channels;
+    if (num_channels > 0 && !*status)
+    {
+        double* spec;
+        oskar_Mem* spec_in = oskar_mem_convert_precision(sky->spectral_I,
+                OSKAR_DOUBLE, status);
+        oskar_Mem* spec_out = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+                (size_t) num_groups * num_channels, status);
+        const double* in = oskar_mem_double_const(spec_in, status);
+        oskar_mem_clear_contents(spec_out, status);
+        spec = oskar_mem_double(spec_out, status);
+        oskar_sky_set_spectral_channels(out, num_channels,
+                oskar_mem_double_const(sky->spectral_freq_hz, status), status);
+        if (!*status)
+        {
+            for (i = 0; i < n; ++i)
+                for (k = 0; k < num_channels; ++k)
+                    spec[(size_t) group[i] * num_channels + k] +=
+                            in[(size_t) i * num_channels + k];
+        }
+        oskar_mem_free(spec_in, status);
+        spec_in = oskar_mem_convert_precision(spec_out,
+                oskar_sky_precision(out), status);
+        oskar_mem_copy_contents(out->spectral_I, spec_in, 0, 0,
+                (size_t) num_groups * num_channels, status);
+        oskar_mem_free(spec_in, status);
+        oskar_mem_free(spec_out, status);
+    }
+
+    /* Predict the visibility error on the longest baseline. */
+    if (max_baseline_m > 0.0 && vis_error_jy)
+    {
+        double b;
+        for (i = 0; i < n; ++i)
+        {
+            const Group* g = &groups[group[i]];
+            if (g->count > 1 && mergeable[i])
+            {
+                const double d = oskar_angular_distance(p[RA][i], g->ra,
+                        p[DEC][i], g->dec);
+                error += d * d * power_law(freq_max_hz, p[I_][i],
+                        p[FREQ][i], p[SPIX][i]);
+            }
+        }
+        b = max_baseline_m * freq_max_hz / C0;
+        *vis_error_jy = 2.0 * M_PI * M_PI * b * b * error;
+    }
+
+fail:
+    for (j = 0; j < NUM_COLS; ++j)
+        oskar_mem_free(cols[j], status);
+    free(group);
+    free(mergeable);
+    free(w);
+    free(by_dec);
+    free(by_flux);
+    free(groups);
+    return out;
+}
+
+#ifdef __cplusplus
+}
+#endif
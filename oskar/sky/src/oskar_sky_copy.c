@@ -89,6 +89,14 @@ void oskar_sky_copy(oskar_Sky* dst, const oskar_Sky* src, int* status)
             0, 0, num_sources, status);
     oskar_mem_copy_contents(dst->gaussian_c, src->gaussian_c,
             0, 0, num_sources, status);
+
+    /* Copy tabulated spectra, if present. */
+    dst->num_spectral_channels = src->num_spectral_channels;
+    oskar_mem_copy(dst->spectral_freq_hz, src->spectral_freq_hz, status);
+    oskar_mem_realloc(dst->spectral_I,
+            (size_t) dst->capacity * dst->num_spectral_channels, status);
+    oskar_mem_copy_contents(dst->spectral_I, src->spectral_I, 0, 0,
+            (size_t) num_sources * src->num_spectral_channels, status);
 }
 
 #ifdef __cplusplus
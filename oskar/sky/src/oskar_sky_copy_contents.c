@@ -26,6 +26,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "sky/private_sky.h"
 #include "sky/oskar_sky.h"
 #include "mem/oskar_mem.h"
 
@@ -91,6 +92,31 @@ void oskar_sky_copy_contents(oskar_Sky* dst, const oskar_Sky* src,
     oskar_mem_copy_contents(oskar_sky_gaussian_c(dst),
             oskar_sky_gaussian_c_const(src),
             offset_dst, offset_src, num_sources, status);
+
+    /* Copy tabulated spectra.
+     * Sources without tabulated spectra use their spectral index. */
+    if (src->num_spectral_channels > 0)
+    {
+        int num_channels = src->num_spectral_channels;
+        if (dst->num_spectral_channels == 0)
+            oskar_sky_set_spectral_channels(dst, num_channels,
+                    oskar_mem_double_const(src->spectral_freq_hz, status),
+                    status);
+        else if (dst->num_spectral_channels != num_channels ||
+                oskar_mem_different(dst->spectral_freq_hz,
+                        src->spectral_freq_hz, 0, status))
+        {
+            *status = OSKAR_ERR_DIMENSION_MISMATCH;
+            return;
+        }
+        oskar_mem_copy_contents(dst->spectral_I, src->spectral_I,
+                (size_t) offset_dst * num_channels,
+                (size_t) offset_src * num_channels,
+                (size_t) num_sources * num_channels, status);
+    }
+    else if (dst->num_spectral_channels > 0)
+        oskar_sky_evaluate_power_law_spectra(dst, offset_dst, num_sources,
+                status);
 }
 
 #ifdef __cplusplus
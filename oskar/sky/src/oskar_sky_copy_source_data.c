@@ -48,6 +48,9 @@
 extern "C" {
 #endif
 
+static void copy_source_spectra(const oskar_Sky* in, const int* mask,
+        const oskar_Mem* indices, oskar_Sky* out, int* status);
+
 #define COPY_SOURCE_DATA \
         for (i = 0; i < num_in; ++i) \
             if (mask[i]) \
@@ -330,6 +333,9 @@ void oskar_sky_copy_source_data(const oskar_Sky* in,
         }
     }
 
+    /* Copy tabulated spectra, if present. */
+    copy_source_spectra(in, mask, indices, out, status);
+
     /* Copy metadata. */
     out->use_extended = in->use_extended;
     out->reference_ra_rad = in->reference_ra_rad;
@@ -339,6 +345,75 @@ void oskar_sky_copy_source_data(const oskar_Sky* in,
     out->num_sources = num_out;
 }
 
+static void copy_source_spectra(const oskar_Sky* in, const int* mask,
+        const oskar_Mem* indices, oskar_Sky* out, int* status)
+{
+    int i, c, num_in, num_chan, num_out = 0, location, type;
+    num_chan = in->num_spectral_channels;
+    if (*status || (num_chan == 0 && out->num_spectral_channels == 0))
+        return;
+
+    /* Resize the output spectra if required. */
+    out->num_spectral_channels = num_chan;
+    oskar_mem_copy(out->spectral_freq_hz, in->spectral_freq_hz, status);
+    oskar_mem_realloc(out->spectral_I, (size_t) out->capacity * num_chan,
+            status);
+    if (*status || num_chan == 0) return;
+
+    /* Copy the spectrum of each source that was kept. */
+    num_in = in->num_sources;
+    location = oskar_sky_mem_location(in);
+    type = oskar_sky_precision(in);
+    if (location == OSKAR_CPU)
+    {
+        (void) indices;
+        if (type == OSKAR_DOUBLE)
+        {
+            const double *spec = CDC(in->spectral_I);
+            double *o_spec = CD(out->spectral_I);
+            for (i = 0; i < num_in; ++i)
+            {
+                if (!mask[i]) continue;
+                for (c = 0; c < num_chan; ++c)
+                    o_spec[(size_t) num_out * num_chan + c] =
+                            spec[(size_t) i * num_chan + c];
+                num_out++;
+            }
+        }
+        else
+        {
+            const float *spec = CFC(in->spectral_I);
+            float *o_spec = CF(out->spectral_I);
+            for (i = 0; i < num_in; ++i)
+            {
+                if (!mask[i]) continue;
+                for (c = 0; c < num_chan; ++c)
+                    o_spec[(size_t) num_out * num_chan + c] =
+                            spec[(size_t) i * num_chan + c];
+                num_out++;
+            }
+        }
+    }
+    else if (location == OSKAR_GPU)
+    {
+#ifdef OSKAR_HAVE_CUDA
+        if (type == OSKAR_DOUBLE)
+            oskar_sky_copy_source_spectra_cuda_d(num_in, num_chan, mask,
+                    oskar_mem_int_const(indices, status),
+                    CDC(in->spectral_I), CD(out->spectral_I));
+        else
+            oskar_sky_copy_source_spectra_cuda_f(num_in, num_chan, mask,
+                    oskar_mem_int_const(indices, status),
+                    CFC(in->spectral_I), CF(out->spectral_I));
+        oskar_device_check_error(status);
+#else
+        *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
+#endif
+    }
+    else
+        *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+}
+
 
 #ifdef __cplusplus
 }
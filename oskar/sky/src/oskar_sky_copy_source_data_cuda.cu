@@ -79,6 +79,23 @@ void oskar_sky_copy_source_data_cudak(const int num,
     }
 }
 
+template<typename T>
+__global__
+void oskar_sky_copy_source_spectra_cudak(const int num, const int num_chan,
+        const int* restrict mask, const int* restrict indices,
+        const T* restrict spec_in, T* restrict spec_out)
+{
+    const int i = blockDim.x * blockIdx.x + threadIdx.x;
+    if (i >= num) return;
+    if (mask[i])
+    {
+        const int i_out = indices[i];
+        for (int c = 0; c < num_chan; ++c)
+            spec_out[(size_t) i_out * num_chan + c] =
+                    spec_in[(size_t) i * num_chan + c];
+    }
+}
+
 void oskar_sky_copy_source_data_cuda_f(int num,
         int* num_out, const int* mask, const int* indices,
         const float* ra_in,   float* ra_out,
@@ -150,3 +167,25 @@ void oskar_sky_copy_source_data_cuda_d(int num,
     cudaMemcpy(num_out, &indices[num-1], sizeof(int), cudaMemcpyDeviceToHost);
     (*num_out)++;
 }
+
+void oskar_sky_copy_source_spectra_cuda_f(int num, int num_chan,
+        const int* mask, const int* indices,
+        const float* spec_in, float* spec_out)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num + num_threads - 1) / num_threads;
+    oskar_sky_copy_source_spectra_cudak<float>
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (
+            num, num_chan, mask, indices, spec_in, spec_out);
+}
+
+void oskar_sky_copy_source_spectra_cuda_d(int num, int num_chan,
+        const int* mask, const int* indices,
+        const double* spec_in, double* spec_out)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num + num_threads - 1) / num_threads;
+    oskar_sky_copy_source_spectra_cudak<double>
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (
+            num, num_chan, mask, indices, spec_in, spec_out);
+}
@@ -65,6 +65,7 @@ oskar_Sky* oskar_sky_create(int type, int location, int num_sources,
     model->use_extended = OSKAR_FALSE;
     model->reference_ra_rad = 0.0;
     model->reference_dec_rad = 0.0;
+    model->num_spectral_channels = 0;
 
     /* Initialise the memory. */
     model->ra_rad = oskar_mem_create(type, location, capacity, status);
@@ -85,6 +86,9 @@ oskar_Sky* oskar_sky_create(int type, int location, int num_sources,
     model->gaussian_a = oskar_mem_create(type, location, capacity, status);
     model->gaussian_b = oskar_mem_create(type, location, capacity, status);
     model->gaussian_c = oskar_mem_create(type, location, capacity, status);
+    model->spectral_freq_hz = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0,
+            status);
+    model->spectral_I = oskar_mem_create(type, location, 0, status);
 
     /* Return pointer to sky model. */
     return model;
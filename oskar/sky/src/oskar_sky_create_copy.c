@@ -74,6 +74,9 @@ oskar_Sky* oskar_sky_create_copy(const oskar_Sky* src, int location,
     oskar_mem_copy(model->gaussian_a, src->gaussian_a, status);
     oskar_mem_copy(model->gaussian_b, src->gaussian_b, status);
     oskar_mem_copy(model->gaussian_c, src->gaussian_c, status);
+    model->num_spectral_channels = src->num_spectral_channels;
+    oskar_mem_copy(model->spectral_freq_hz, src->spectral_freq_hz, status);
+    oskar_mem_copy(model->spectral_I, src->spectral_I, status);
 
     /* Return pointer to new sky model. */
     return model;
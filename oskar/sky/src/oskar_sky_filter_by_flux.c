@@ -38,7 +38,7 @@ extern "C" {
 void oskar_sky_filter_by_flux(oskar_Sky* sky, double min_I, double max_I,
         int* status)
 {
-    int location, type, num_sources, in = 0, out = 0;
+    int location, type, num_sources, num_chan, in = 0, out = 0, j;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -57,6 +57,7 @@ void oskar_sky_filter_by_flux(oskar_Sky* sky, double min_I, double max_I,
     location = oskar_sky_mem_location(sky);
     type = oskar_sky_precision(sky);
     num_sources = oskar_sky_num_sources(sky);
+    num_chan = oskar_sky_num_spectral_channels(sky);
 
     /* Filtering is only supported for data in host memory. */
     if (location != OSKAR_CPU)
@@ -68,7 +69,7 @@ void oskar_sky_filter_by_flux(oskar_Sky* sky, double min_I, double max_I,
     if (type == OSKAR_SINGLE)
     {
         float *ra_, *dec_, *I_, *Q_, *U_, *V_, *ref_, *spix_, *rm_;
-        float *l_, *m_, *n_, *maj_, *min_, *pa_, *a_, *b_, *c_;
+        float *l_, *m_, *n_, *maj_, *min_, *pa_, *a_, *b_, *c_, *spec_;
         ra_   = oskar_mem_float(oskar_sky_ra_rad(sky), status);
         dec_  = oskar_mem_float(oskar_sky_dec_rad(sky), status);
         I_    = oskar_mem_float(oskar_sky_I(sky), status);
@@ -87,6 +88,7 @@ void oskar_sky_filter_by_flux(oskar_Sky* sky, double min_I, double max_I,
         a_    = oskar_mem_float(oskar_sky_gaussian_a(sky), status);
         b_    = oskar_mem_float(oskar_sky_gaussian_b(sky), status);
         c_    = oskar_mem_float(oskar_sky_gaussian_c(sky), status);
+        spec_ = oskar_mem_float(oskar_sky_spectral_I(sky), status);
 
         for (in = 0; in < num_sources; ++in)
         {
@@ -111,13 +113,15 @@ void oskar_sky_filter_by_flux(oskar_Sky* sky, double min_I, double max_I,
             a_[out]    = a_[in];
             b_[out]    = b_[in];
             c_[out]    = c_[in];
+            for (j = 0; j < num_chan; ++j)
+                spec_[out * num_chan + j] = spec_[in * num_chan + j];
             out++;
         }
     }
     else if (type == OSKAR_DOUBLE)
     {
         double *ra_, *dec_, *I_, *Q_, *U_, *V_, *ref_, *spix_, *rm_;
-        double *l_, *m_, *n_, *maj_, *min_, *pa_, *a_, *b_, *c_;
+        double *l_, *m_, *n_, *maj_, *min_, *pa_, *a_, *b_, *c_, *spec_;
         ra_   = oskar_mem_double(oskar_sky_ra_rad(sky), status);
         dec_  = oskar_mem_double(oskar_sky_dec_rad(sky), status);
         I_    = oskar_mem_double(oskar_sky_I(sky), status);
@@ -136,6 +140,7 @@ void oskar_sky_filter_by_flux(oskar_Sky* sky, double min_I, double max_I,
         a_    = oskar_mem_double(oskar_sky_gaussian_a(sky), status);
         b_    = oskar_mem_double(oskar_sky_gaussian_b(sky), status);
         c_    = oskar_mem_double(oskar_sky_gaussian_c(sky), status);
+        spec_ = oskar_mem_double(oskar_sky_spectral_I(sky), status);
 
         for (in = 0; in < num_sources; ++in)
         {
@@ -160,6 +165,8 @@ void oskar_sky_filter_by_flux(oskar_Sky* sky, double min_I, double max_I,
             a_[out]    = a_[in];
             b_[out]    = b_[in];
             c_[out]    = c_[in];
+            for (j = 0; j < num_chan; ++j)
+                spec_[out * num_chan + j] = spec_[in * num_chan + j];
             out++;
         }
     }
@@ -38,7 +38,7 @@ extern "C" {
 void oskar_sky_filter_by_radius(oskar_Sky* sky, double inner_radius_rad,
         double outer_radius_rad, double ra0_rad, double dec0_rad, int* status)
 {
-    int type, location, num_sources;
+    int type, location, num_sources, num_chan, j;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -57,6 +57,7 @@ void oskar_sky_filter_by_radius(oskar_Sky* sky, double inner_radius_rad,
     type = oskar_sky_precision(sky);
     location = oskar_sky_mem_location(sky);
     num_sources = oskar_sky_num_sources(sky);
+    num_chan = oskar_sky_num_spectral_channels(sky);
 
     if (location == OSKAR_CPU)
     {
@@ -65,6 +66,7 @@ void oskar_sky_filter_by_radius(oskar_Sky* sky, double inner_radius_rad,
         {
             float *ra_, *dec_, *I_, *Q_, *U_, *V_, *ref_, *spix_, *rm_;
             float *l_, *m_, *n_, *maj_, *min_, *pa_, *a_, *b_, *c_, dist;
+            float *spec_;
             ra_   = oskar_mem_float(oskar_sky_ra_rad(sky), status);
             dec_  = oskar_mem_float(oskar_sky_dec_rad(sky), status);
             I_    = oskar_mem_float(oskar_sky_I(sky), status);
@@ -83,6 +85,7 @@ void oskar_sky_filter_by_radius(oskar_Sky* sky, double inner_radius_rad,
             a_    = oskar_mem_float(oskar_sky_gaussian_a(sky), status);
             b_    = oskar_mem_float(oskar_sky_gaussian_b(sky), status);
             c_    = oskar_mem_float(oskar_sky_gaussian_c(sky), status);
+            spec_ = oskar_mem_float(oskar_sky_spectral_I(sky), status);
 
             for (in = 0, out = 0; in < num_sources; ++in)
             {
@@ -111,6 +114,8 @@ void oskar_sky_filter_by_radius(oskar_Sky* sky, double inner_radius_rad,
                 a_[out]    = a_[in];
                 b_[out]    = b_[in];
                 c_[out]    = c_[in];
+                for (j = 0; j < num_chan; ++j)
+                    spec_[out * num_chan + j] = spec_[in * num_chan + j];
                 out++;
             }
         }
@@ -118,6 +123,7 @@ void oskar_sky_filter_by_radius(oskar_Sky* sky, double inner_radius_rad,
         {
             double *ra_, *dec_, *I_, *Q_, *U_, *V_, *ref_, *spix_, *rm_;
             double *l_, *m_, *n_, *maj_, *min_, *pa_, *a_, *b_, *c_, dist;
+            double *spec_;
             ra_   = oskar_mem_double(oskar_sky_ra_rad(sky), status);
             dec_  = oskar_mem_double(oskar_sky_dec_rad(sky), status);
             I_    = oskar_mem_double(oskar_sky_I(sky), status);
@@ -136,6 +142,7 @@ void oskar_sky_filter_by_radius(oskar_Sky* sky, double inner_radius_rad,
             a_    = oskar_mem_double(oskar_sky_gaussian_a(sky), status);
             b_    = oskar_mem_double(oskar_sky_gaussian_b(sky), status);
             c_    = oskar_mem_double(oskar_sky_gaussian_c(sky), status);
+            spec_ = oskar_mem_double(oskar_sky_spectral_I(sky), status);
 
             for (in = 0, out = 0; in < num_sources; ++in)
             {
@@ -164,6 +171,8 @@ void oskar_sky_filter_by_radius(oskar_Sky* sky, double inner_radius_rad,
                 a_[out]    = a_[in];
                 b_[out]    = b_[in];
                 c_[out]    = c_[in];
+                for (j = 0; j < num_chan; ++j)
+                    spec_[out * num_chan + j] = spec_[in * num_chan + j];
                 out++;
             }
         }
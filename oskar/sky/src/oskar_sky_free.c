@@ -58,6 +58,8 @@ void oskar_sky_free(oskar_Sky* model, int* status)
     oskar_mem_free(model->gaussian_a, status);
     oskar_mem_free(model->gaussian_b, status);
     oskar_mem_free(model->gaussian_c, status);
+    oskar_mem_free(model->spectral_freq_hz, status);
+    oskar_mem_free(model->spectral_I, status);
 
     /* Free the structure itself. */
     free(model);
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sky/oskar_sky.h"
+#include "convert/oskar_convert_brightness_to_jy.h"
+#include "convert/oskar_convert_relative_directions_to_lon_lat.h"
+#include "math/oskar_cmath.h"
+#include <fitsio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_AXES 10
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static int num_freq_channels(const char* filename, int* status);
+static oskar_Mem* read_channel(const char* filename, int channel,
+        double min_abs_val, const char* default_map_units,
+        int override_units, int image_size[2], double image_crval_deg[2],
+        double image_crpix[2], double* image_cellsize_deg, double* freq_hz,
+        int* status);
+static void mark_non_zero(const oskar_Mem* plane, size_t num_pixels,
+        char* mask, int* status);
+static void store_channel(const oskar_Mem* plane, size_t num_pixels,
+        const char* mask, int channel, int num_channels, oskar_Sky* sky,
+        int* status);
+
+oskar_Sky* oskar_sky_from_fits_cube(int precision, const char* filename,
+        double min_abs_val, const char* default_map_units,
+        int override_units, int* status)
+{
+    int c, x, y, num_channels, num_sources = 0, reverse;
+    int image_size[2] = {0, 0};
+    size_t i, num_pixels = 0;
+    double image_crval_deg[2], image_crpix[2], crval[2], cdelt[2];
+    double image_cellsize_deg = 0.0, freq = 0.0;
+    double *freq_hz = 0;
+    char *mask = 0;
+    oskar_Mem* plane;
+    oskar_Sky* sky = 0;
+
+    /* Check if safe to proceed. */
+    if (*status) return 0;
+
+    /* Get the number of channels in the cube. */
+    num_channels = num_freq_channels(filename, status);
+    if (*status) return 0;
+    freq_hz = (double*) calloc(num_channels, sizeof(double));
+    if (!freq_hz)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+
+    /* Read the cube one channel at a time, and mark the pixels that
+     * are non-zero in any channel. */
+    for (c = 0; c < num_channels; ++c)
+    {
+        plane = read_channel(filename, c, min_abs_val, default_map_units,
+                override_units, image_size, image_crval_deg, image_crpix,
+                &image_cellsize_deg, &freq_hz[c], status);
+        if (!mask && !*status)
+        {
+            num_pixels = (size_t)image_size[0] * (size_t)image_size[1];
+            mask = (char*) calloc(num_pixels, sizeof(char));
+            if (!mask) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        }
+        mark_non_zero(plane, num_pixels, mask, status);
+        oskar_mem_free(plane, status);
+        if (*status) break;
+    }
+
+    /* Check pixel size has been defined. */
+    if (!*status && image_cellsize_deg == 0.0)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        fprintf(stderr, "Unknown image pixel size. "
+                "(Ensure all WCS headers are present.)\n");
+    }
+    if (*status)
+    {
+        free(mask);
+        free(freq_hz);
+        return 0;
+    }
+
+    /* Make sure the frequency axis is in increasing order.
+     * The spectra are reversed to match when they are stored. */
+    reverse = (num_channels > 1 && freq_hz[1] < freq_hz[0]);
+    if (reverse)
+    {
+        for (c = 0; c < num_channels / 2; ++c)
+        {
+            const double tmp = freq_hz[c];
+            freq_hz[c] = freq_hz[num_channels - 1 - c];
+            freq_hz[num_channels - 1 - c] = tmp;
+        }
+    }
+
+    /* Get reference pixels and reference values in radians. */
+    crval[0] = image_crval_deg[0] * M_PI / 180.0;
+    crval[1] = image_crval_deg[1] * M_PI / 180.0;
+
+    /* Compute sine of pixel deltas for inverse orthographic projection. */
+    cdelt[0] = -sin(image_cellsize_deg * M_PI / 180.0);
+    cdelt[1] = -cdelt[0];
+
+    /* Create a source for each pixel with a non-zero spectrum. */
+    for (i = 0; i < num_pixels; ++i)
+        if (mask[i]) num_sources++;
+    sky = oskar_sky_create(precision, OSKAR_CPU, num_sources, status);
+    for (y = 0, i = 0, num_sources = 0; y < image_size[1]; ++y)
+    {
+        for (x = 0; x < image_size[0]; ++x, ++i)
+        {
+            double ra, dec, l, m;
+            if (!mask[i]) continue;
+
+            /* Convert pixel positions to RA and Dec values. */
+            l = cdelt[0] * (x + 1 - image_crpix[0]);
+            m = cdelt[1] * (y + 1 - image_crpix[1]);
+            oskar_convert_relative_directions_to_lon_lat_2d_d(1,
+                    &l, &m, crval[0], crval[1], &ra, &dec);
+
+            /* Store the pixel, using the first channel as reference. */
+            oskar_sky_set_source(sky, num_sources++, ra, dec, 0.0, 0.0,
+                    0.0, 0.0, freq_hz[0], 0.0, 0.0, 0.0, 0.0, 0.0, status);
+        }
+    }
+
+    /* Read the cube again, and store the spectrum of each source. */
+    oskar_sky_set_spectral_channels(sky, num_channels, freq_hz, status);
+    for (c = 0; c < num_channels && !*status; ++c)
+    {
+        plane = read_channel(filename, c, min_abs_val, default_map_units,
+                override_units, image_size, image_crval_deg, image_crpix,
+                &image_cellsize_deg, &freq, status);
+        store_channel(plane, num_pixels, mask,
+                reverse ? num_channels - 1 - c : c, num_channels, sky, status);
+        oskar_mem_free(plane, status);
+    }
+
+    /* Free scratch arrays and return sky model. */
+    free(mask);
+    free(freq_hz);
+    return sky;
+}
+
+/* Reads a single channel of the cube, and converts the pixels to Jy. */
+static oskar_Mem* read_channel(const char* filename, int channel,
+        double min_abs_val, const char* default_map_units,
+        int override_units, int image_size[2], double image_crval_deg[2],
+        double image_crpix[2], double* image_cellsize_deg, double* freq_hz,
+        int* status)
+{
+    double beam_area_pixels = 0.0, pixel_area_sr;
+    char* reported_map_units = 0;
+    oskar_Mem* plane;
+    plane = oskar_mem_read_fits_image_plane(filename, 0, channel, 0,
+            image_size, image_crval_deg, image_crpix,
+            image_cellsize_deg, 0, freq_hz, &beam_area_pixels,
+            &reported_map_units, status);
+    pixel_area_sr = pow(*image_cellsize_deg * M_PI / 180.0, 2.0);
+    oskar_convert_brightness_to_jy(plane, beam_area_pixels,
+            pixel_area_sr, *freq_hz, 0.0, min_abs_val,
+            reported_map_units, default_map_units, override_units,
+            status);
+    free(reported_map_units);
+    return plane;
+}
+
+static void mark_non_zero(const oskar_Mem* plane, size_t num_pixels,
+        char* mask, int* status)
+{
+    size_t i;
+    if (*status) return;
+    if (oskar_mem_length(plane) != num_pixels)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (oskar_mem_precision(plane) == OSKAR_SINGLE)
+    {
+        const float* p = oskar_mem_float_const(plane, status);
+        for (i = 0; i < num_pixels; ++i)
+            if (p[i] != 0.0f) mask[i] = 1;
+    }
+    else
+    {
+        const double* p = oskar_mem_double_const(plane, status);
+        for (i = 0; i < num_pixels; ++i)
+            if (p[i] != 0.0) mask[i] = 1;
+    }
+}
+
+/* Stores the marked pixels of a plane as one channel of the source spectra.
+ * The first channel is also used as the reference Stokes I value. */
+static void store_channel(const oskar_Mem* plane, size_t num_pixels,
+        const char* mask, int channel, int num_channels, oskar_Sky* sky,
+        int* status)
+{
+    size_t i, j;
+    double val;
+    const float* p_f = 0;
+    const double* p_d = 0;
+    if (*status) return;
+    if (oskar_mem_length(plane) != num_pixels)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (oskar_mem_precision(plane) == OSKAR_SINGLE)
+        p_f = oskar_mem_float_const(plane, status);
+    else
+        p_d = oskar_mem_double_const(plane, status);
+    if (*status) return;
+    if (oskar_sky_precision(sky) == OSKAR_DOUBLE)
+    {
+        double *spec, *ref;
+        spec = oskar_mem_double(oskar_sky_spectral_I(sky), status);
+        ref = oskar_mem_double(oskar_sky_I(sky), status);
+        for (i = 0, j = 0; i < num_pixels; ++i)
+        {
+            if (!mask[i]) continue;
+            val = p_f ? p_f[i] : p_d[i];
+            spec[(size_t) j * num_channels + channel] = val;
+            if (channel == 0) ref[j] = val;
+            j++;
+        }
+    }
+    else
+    {
+        float *spec, *ref;
+        spec = oskar_mem_float(oskar_sky_spectral_I(sky), status);
+        ref = oskar_mem_float(oskar_sky_I(sky), status);
+        for (i = 0, j = 0; i < num_pixels; ++i)
+        {
+            if (!mask[i]) continue;
+            val = p_f ? p_f[i] : p_d[i];
+            spec[(size_t) j * num_channels + channel] = (float) val;
+            if (channel == 0) ref[j] = (float) val;
+            j++;
+        }
+    }
+}
+
+static int num_freq_channels(const char* filename, int* status)
+{
+    int i, imagetype = 0, naxis = 0, num_channels = 1;
+    long naxes[MAX_AXES];
+    char *ctype[MAX_AXES], ctype_str[MAX_AXES][FLEN_VALUE];
+    fitsfile* fptr = 0;
+    fits_open_file(&fptr, filename, READONLY, status);
+    if (*status || !fptr)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return 0;
+    }
+    fits_get_img_param(fptr, MAX_AXES, &imagetype, &naxis, naxes, status);
+    if (*status || naxis < 2 || naxis > MAX_AXES)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        fits_close_file(fptr, &i);
+        return 0;
+    }
+    for (i = 0; i < naxis; ++i)
+    {
+        ctype[i] = ctype_str[i];
+        ctype_str[i][0] = 0;
+    }
+    fits_read_keys_str(fptr, "CTYPE", 1, naxis, ctype, &i, status);
+    *status = 0;
+    for (i = 0; i < naxis; ++i)
+        if (strncmp(ctype[i], "FREQ", 4) == 0)
+            num_channels = (int) naxes[i];
+    fits_close_file(fptr, status);
+    return num_channels;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sky/private_sky.h"
+#include "sky/oskar_sky.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_thread.h"
+
+#include <fitsio.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUM_COLS 12
+#define MIN_ROWS_PER_TASK 16384
+
+enum { RA, DEC, I_, Q_, U_, V_, FREQ, SPIX, RM, MAJ, MIN, PA };
+
+/* Comma-separated lists of column names to try if none are given. */
+static const char* default_names[NUM_COLS] = {
+        "RA,RAJ2000,RA_DEG,RA_J2000",
+        "DEC,DEJ2000,DEC_DEG,DEC_J2000",
+        "I,STOKES_I,TOTAL_FLUX,INT_FLUX,INT_FLUX_WIDE,FLUX",
+        "Q,STOKES_Q",
+        "U,STOKES_U",
+        "V,STOKES_V",
+        "REF_FREQ,REFERENCE_FREQUENCY,FREQ0",
+        "SPEC_IDX,SPECTRAL_INDEX,SP_INDEX,ALPHA",
+        "RM,ROTATION_MEASURE",
+        "MAJ,MAJOR,FWHM_MAJOR,BMAJ,A_WIDE",
+        "MIN,MINOR,FWHM_MINOR,BMIN,B_WIDE",
+        "PA,POSITION_ANGLE,PA_WIDE"
+};
+
+typedef struct
+{
+    const char* filename;
+    int hdu_num;
+    long first_row, num_rows;
+    const int* colnum;
+    const double* scale;
+    oskar_Mem* const* cols;
+    int status;
+} ReadTask;
+
+static int find_column(fitsfile* fptr, const char* names, int* status);
+static double unit_scale(int col, const char* unit, int* status);
+static void* read_rows(void* arg);
+
+oskar_Sky* oskar_sky_from_fits_table(int precision, const char* filename,
+        const char* const* column_names, double default_ref_freq_hz,
+        int num_threads, int* status)
+{
+    int c, i, hdu_num = 0, num_tasks = 1, colnum[NUM_COLS];
+    long num_rows = 0, rows_per_task;
+    double scale[NUM_COLS];
+    oskar_Mem* cols[NUM_COLS];
+    fitsfile* fptr = 0;
+    oskar_Sky* sky = 0;
+    ReadTask* tasks = 0;
+
+    /* Check if safe to proceed. */
+    if (*status) return 0;
+
+    /* Open the first table and find the columns to read. */
+    fits_open_table(&fptr, filename, READONLY, status);
+    if (*status || !fptr)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return 0;
+    }
+    fits_get_hdu_num(fptr, &hdu_num);
+    fits_get_num_rows(fptr, &num_rows, status);
+    for (c = 0; c < NUM_COLS && !*status; ++c)
+    {
+        char key[FLEN_KEYWORD], unit[FLEN_VALUE];
+        const char* name = column_names ? column_names[c] : 0;
+        const int user_name = (name && strlen(name) > 0);
+        int tmp_status = 0;
+        colnum[c] = find_column(fptr, user_name ? name : default_names[c],
+                status);
+        if (colnum[c] == 0)
+        {
+            if (user_name || c == RA || c == DEC || c == I_)
+                *status = OSKAR_ERR_BAD_SKY_FILE;
+            continue;
+        }
+
+        /* Get the physical units of the column, if present. */
+        unit[0] = 0;
+        fits_make_keyn("TUNIT", colnum[c], key, &tmp_status);
+        fits_read_key(fptr, TSTRING, key, unit, 0, &tmp_status);
+        if (tmp_status) unit[0] = 0;
+        scale[c] = unit_scale(c, unit, status);
+    }
+    fits_close_file(fptr, status);
+    if (*status)
+    {
+        if (*status > 0) *status = OSKAR_ERR_FILE_IO;
+        return 0;
+    }
+
+    /* Create the sky model, and clear columns that will not be read. */
+    sky = oskar_sky_create(precision, OSKAR_CPU, (int)num_rows, status);
+    cols[RA] = sky->ra_rad;
+    cols[DEC] = sky->dec_rad;
+    cols[I_] = sky->I;
+    cols[Q_] = sky->Q;
+    cols[U_] = sky->U;
+    cols[V_] = sky->V;
+    cols[FREQ] = sky->reference_freq_hz;
+    cols[SPIX] = sky->spectral_index;
+    cols[RM] = sky->rm_rad;
+    cols[MAJ] = sky->fwhm_major_rad;
+    cols[MIN] = sky->fwhm_minor_rad;
+    cols[PA] = sky->pa_rad;
+    for (c = 0; c < NUM_COLS; ++c)
+        if (colnum[c] == 0) oskar_mem_clear_contents(cols[c], status);
+    if (colnum[FREQ] == 0)
+        oskar_mem_set_value_real(cols[FREQ], default_ref_freq_hz,
+                0, num_rows, status);
+    if (*status || num_rows == 0) return sky;
+
+    /* Divide the rows between the tasks. */
+    if (num_threads <= 0) num_threads = oskar_get_num_procs();
+    if (fits_is_reentrant())
+    {
+        num_tasks = (int)(num_rows / MIN_ROWS_PER_TASK);
+        if (num_tasks > num_threads) num_tasks = num_threads;
+        if (num_tasks < 1) num_tasks = 1;
+    }
+    rows_per_task = (num_rows + num_tasks - 1) / num_tasks;
+    tasks = (ReadTask*) calloc(num_tasks, sizeof(ReadTask));
+    if (!tasks)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return sky;
+    }
+    for (i = 0; i < num_tasks; ++i)
+    {
+        tasks[i].filename = filename;
+        tasks[i].hdu_num = hdu_num;
+        tasks[i].first_row = i * rows_per_task;
+        tasks[i].num_rows = num_rows - tasks[i].first_row;
+        if (tasks[i].num_rows > rows_per_task)
+            tasks[i].num_rows = rows_per_task;
+        tasks[i].colnum = colnum;
+        tasks[i].scale = scale;
+        tasks[i].cols = cols;
+    }
+
+    /* Read the rows. */
+    if (num_tasks == 1)
+        read_rows(&tasks[0]);
+    else
+    {
+        /* Read in this thread any rows that cannot be queued. */
+        oskar_ThreadPool* pool = oskar_thread_pool_create(num_tasks);
+        for (i = 0; i < num_tasks; ++i)
+            if (oskar_thread_pool_submit(pool, read_rows, &tasks[i]))
+                read_rows(&tasks[i]);
+        if (pool)
+        {
+            oskar_thread_pool_wait(pool);
+            oskar_thread_pool_free(pool);
+        }
+    }
+    for (i = 0; i < num_tasks; ++i)
+        if (tasks[i].status && !*status) *status = tasks[i].status;
+    free(tasks);
+    return sky;
+}
+
+static int find_column(fitsfile* fptr, const char* names, int* status)
+{
+    char buffer[FLEN_VALUE], *token, *next = 0;
+    int colnum = 0;
+    if (strlen(names) >= sizeof(buffer))
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return 0;
+    }
+
+    /* Return the first column that matches one of the names in the list. */
+    strcpy(buffer, names);
+    for (token = buffer; token; token = next)
+    {
+        int tmp_status = 0;
+        next = strchr(token, ',');
+        if (next) *next++ = 0;
+        fits_get_colnum(fptr, CASEINSEN, token, &colnum, &tmp_status);
+        if (!tmp_status) return colnum;
+    }
+    return 0;
+}
+
+static double unit_scale(int col, const char* unit, int* status)
+{
+    char u[FLEN_VALUE];
+    size_t i, len = strlen(unit);
+    for (i = 0; i < len; ++i) u[i] = (char) tolower((unsigned char) unit[i]);
+    u[len] = 0;
+    switch (col)
+    {
+    case RA:
+    case DEC:
+    case PA:
+    case MAJ:
+    case MIN:
+        if (!strncmp(u, "deg", 3))
+            return M_PI / 180.0;
+        if (!strncmp(u, "rad", 3))
+            return 1.0;
+        if (!strncmp(u, "arcmin", 6))
+            return M_PI / 180.0 / 60.0;
+        if (!strncmp(u, "arcsec", 6))
+            return M_PI / 180.0 / 3600.0;
+        if (len == 0)
+            return (col == MAJ || col == MIN) ?
+                    M_PI / 180.0 / 3600.0 : M_PI / 180.0;
+        break;
+    case I_:
+    case Q_:
+    case U_:
+    case V_:
+        if (len == 0 || !strncmp(u, "jy", 2))
+            return 1.0;
+        if (!strncmp(u, "mjy", 3))
+            return 1e-3;
+        if (!strncmp(u, "ujy", 3) || !strncmp(u, "microjy", 7))
+            return 1e-6;
+        break;
+    case FREQ:
+        if (len == 0 || !strcmp(u, "hz"))
+            return 1.0;
+        if (!strcmp(u, "khz"))
+            return 1e3;
+        if (!strcmp(u, "mhz"))
+            return 1e6;
+        if (!strcmp(u, "ghz"))
+            return 1e9;
+        break;
+    default:
+        return 1.0;
+    }
+    *status = OSKAR_ERR_BAD_UNITS;
+    return 1.0;
+}
+
+static void* read_rows(void* arg)
+{
+    int c, anynul = 0;
+    long i;
+    fitsfile* fptr = 0;
+    ReadTask* t = (ReadTask*) arg;
+    int* status = &t->status;
+
+    /* Each task uses its own file handle. */
+    fits_open_file(&fptr, t->filename, READONLY, status);
+    fits_movabs_hdu(fptr, t->hdu_num, 0, status);
+    for (c = 0; c < NUM_COLS && !*status; ++c)
+    {
+        const double s = t->scale[c];
+        if (t->colnum[c] == 0) continue;
+        if (oskar_mem_precision(t->cols[c]) == OSKAR_DOUBLE)
+        {
+            double nul = 0.0;
+            double* p = oskar_mem_double(t->cols[c], status) + t->first_row;
+            fits_read_col(fptr, TDOUBLE, t->colnum[c], t->first_row + 1, 1,
+                    t->num_rows, &nul, p, &anynul, status);
+            if (s != 1.0)
+                for (i = 0; i < t->num_rows; ++i) p[i] *= s;
+        }
+        else
+        {
+            float nul = 0.0f;
+            float* p = oskar_mem_float(t->cols[c], status) + t->first_row;
+            fits_read_col(fptr, TFLOAT, t->colnum[c], t->first_row + 1, 1,
+                    t->num_rows, &nul, p, &anynul, status);
+            if (s != 1.0)
+                for (i = 0; i < t->num_rows; ++i) p[i] *= (float) s;
+        }
+    }
+    if (fptr)
+    {
+        int close_status = 0;
+        fits_close_file(fptr, &close_status);
+    }
+    if (*status > 0) *status = OSKAR_ERR_FILE_IO;
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
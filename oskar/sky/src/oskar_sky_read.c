@@ -26,6 +26,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "sky/private_sky.h"
 #include "sky/oskar_sky.h"
 #include "binary/oskar_binary.h"
 #include "mem/oskar_binary_read_mem.h"
@@ -90,6 +91,24 @@ oskar_Sky* oskar_sky_read(const char* filename, int location, int* status)
     oskar_binary_read_mem(h, oskar_sky_rotation_measure_rad(sky),
             group, OSKAR_SKY_TAG_ROTATION_MEASURE, idx, status);
 
+    /* Read tabulated spectra, if present. */
+    if (!*status)
+    {
+        int tmp_status = 0;
+        oskar_binary_read_mem(h, sky->spectral_freq_hz,
+                group, OSKAR_SKY_TAG_SPECTRAL_FREQ, idx, &tmp_status);
+        if (!tmp_status && oskar_mem_length(sky->spectral_freq_hz) > 0)
+        {
+            sky->num_spectral_channels =
+                    (int) oskar_mem_length(sky->spectral_freq_hz);
+            oskar_binary_read_mem(h, sky->spectral_I,
+                    group, OSKAR_SKY_TAG_SPECTRAL_STOKES_I, idx, status);
+            oskar_mem_realloc(sky->spectral_I,
+                    (size_t) sky->capacity * sky->num_spectral_channels,
+                    status);
+        }
+    }
+
     /* Release the handle. */
     oskar_binary_free(h);
 
@@ -65,6 +65,10 @@ void oskar_sky_resize(oskar_Sky* sky, int num_sources, int* status)
     oskar_mem_realloc(sky->gaussian_a, capacity, status);
     oskar_mem_realloc(sky->gaussian_b, capacity, status);
     oskar_mem_realloc(sky->gaussian_c, capacity, status);
+    if (sky->num_spectral_channels > 0)
+        oskar_mem_realloc(sky->spectral_I,
+                (size_t) capacity * (size_t) sky->num_spectral_channels,
+                status);
 }
 
 #ifdef __cplusplus
@@ -36,6 +36,9 @@
 extern "C" {
 #endif
 
+static void interpolate_spectra(oskar_Sky* sky, double frequency,
+        int* status);
+
 /* Single precision. */
 void oskar_sky_scale_flux_with_frequency_f(int num_sources, float frequency,
         float* I, float* Q, float* U, float* V, float* ref_freq,
@@ -205,6 +208,82 @@ void oskar_sky_scale_flux_with_frequency(oskar_Sky* sky, double frequency,
     }
     else
         *status = OSKAR_ERR_BAD_LOCATION;
+
+    /* Evaluate Stokes I from tabulated spectra, if present. */
+    if (oskar_sky_num_spectral_channels(sky) > 0)
+        interpolate_spectra(sky, frequency, status);
+}
+
+static void interpolate_spectra(oskar_Sky* sky, double frequency,
+        int* status)
+{
+    int i, c0 = 0, c1 = 0, type, location, num_sources, num_channels;
+    double w = 0.0;
+    const double* freq;
+    if (*status) return;
+    type = oskar_sky_precision(sky);
+    location = oskar_sky_mem_location(sky);
+    num_sources = oskar_sky_num_sources(sky);
+    num_channels = oskar_sky_num_spectral_channels(sky);
+
+    /* Find the channels either side of the frequency (clamped at ends). */
+    freq = oskar_mem_double_const(oskar_sky_spectral_freq_hz_const(sky),
+            status);
+    if (frequency >= freq[num_channels - 1])
+        c0 = c1 = num_channels - 1;
+    else if (frequency > freq[0])
+    {
+        while (freq[c0 + 1] <= frequency) c0++;
+        c1 = c0 + 1;
+        w = (frequency - freq[c0]) / (freq[c1] - freq[c0]);
+    }
+
+    /* Interpolate the spectra. */
+    if (location == OSKAR_CPU)
+    {
+        if (type == OSKAR_DOUBLE)
+        {
+            double *I_;
+            const double *spec;
+            I_ = oskar_mem_double(oskar_sky_I(sky), status);
+            spec = oskar_mem_double_const(oskar_sky_spectral_I_const(sky),
+                    status);
+            for (i = 0; i < num_sources; ++i)
+                I_[i] = (1.0 - w) * spec[(size_t) i * num_channels + c0] +
+                        w * spec[(size_t) i * num_channels + c1];
+        }
+        else
+        {
+            float *I_;
+            const float *spec, w_ = (float) w;
+            I_ = oskar_mem_float(oskar_sky_I(sky), status);
+            spec = oskar_mem_float_const(oskar_sky_spectral_I_const(sky),
+                    status);
+            for (i = 0; i < num_sources; ++i)
+                I_[i] = (1.0f - w_) * spec[(size_t) i * num_channels + c0] +
+                        w_ * spec[(size_t) i * num_channels + c1];
+        }
+    }
+    else if (location == OSKAR_GPU)
+    {
+#ifdef OSKAR_HAVE_CUDA
+        if (type == OSKAR_DOUBLE)
+            oskar_sky_interpolate_spectra_cuda_d(num_sources, num_channels,
+                    c0, c1, w, oskar_mem_double_const(
+                            oskar_sky_spectral_I_const(sky), status),
+                    oskar_mem_double(oskar_sky_I(sky), status));
+        else
+            oskar_sky_interpolate_spectra_cuda_f(num_sources, num_channels,
+                    c0, c1, (float) w, oskar_mem_float_const(
+                            oskar_sky_spectral_I_const(sky), status),
+                    oskar_mem_float(oskar_sky_I(sky), status));
+        oskar_device_check_error(status);
+#else
+        *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
+#endif
+    }
+    else
+        *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
 }
 
 #ifdef __cplusplus
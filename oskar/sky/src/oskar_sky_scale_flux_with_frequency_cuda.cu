@@ -59,6 +59,30 @@ void oskar_sky_scale_flux_with_frequency_cudak_d(const int num_sources,
             &I[i], &Q[i], &U[i], &V[i], &ref_freq[i], sp_index[i], rm[i]);
 }
 
+/* Single precision. */
+__global__
+void oskar_sky_interpolate_spectra_cudak_f(const int num_sources,
+        const int num_channels, const int c0, const int c1, const float w,
+        const float* restrict spec, float* restrict I)
+{
+    const int i = blockDim.x * blockIdx.x + threadIdx.x;
+    if (i >= num_sources) return;
+    I[i] = (1.0f - w) * spec[(size_t) i * num_channels + c0] +
+            w * spec[(size_t) i * num_channels + c1];
+}
+
+/* Double precision. */
+__global__
+void oskar_sky_interpolate_spectra_cudak_d(const int num_sources,
+        const int num_channels, const int c0, const int c1, const double w,
+        const double* restrict spec, double* restrict I)
+{
+    const int i = blockDim.x * blockIdx.x + threadIdx.x;
+    if (i >= num_sources) return;
+    I[i] = (1.0 - w) * spec[(size_t) i * num_channels + c0] +
+            w * spec[(size_t) i * num_channels + c1];
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -89,6 +113,28 @@ void oskar_sky_scale_flux_with_frequency_cuda_d(int num_sources,
             d_I, d_Q, d_U, d_V, d_ref_freq, d_sp_index, d_rm);
 }
 
+/* Single precision. */
+void oskar_sky_interpolate_spectra_cuda_f(int num_sources, int num_channels,
+        int c0, int c1, float w, const float* d_spec, float* d_I)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num_sources + num_threads - 1) / num_threads;
+    oskar_sky_interpolate_spectra_cudak_f
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (num_sources, num_channels,
+            c0, c1, w, d_spec, d_I);
+}
+
+/* Double precision. */
+void oskar_sky_interpolate_spectra_cuda_d(int num_sources, int num_channels,
+        int c0, int c1, double w, const double* d_spec, double* d_I)
+{
+    int num_blocks, num_threads = 256;
+    num_blocks = (num_sources + num_threads - 1) / num_threads;
+    oskar_sky_interpolate_spectra_cudak_d
+    OSKAR_CUDAK_CONF(num_blocks, num_threads) (num_sources, num_channels,
+            c0, c1, w, d_spec, d_I);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sky/private_sky.h"
+#include "sky/oskar_sky.h"
+#include "math/oskar_cmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_sky_set_spectral_channels(oskar_Sky* sky, int num_channels,
+        const double* freq_hz, int* status)
+{
+    int i;
+    double* freq;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Check the frequency axis. */
+    if (num_channels < 0)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+    for (i = 1; i < num_channels; ++i)
+    {
+        if (!(freq_hz[i] > freq_hz[i - 1]))
+        {
+            *status = OSKAR_ERR_INVALID_ARGUMENT;
+            return;
+        }
+    }
+
+    /* Store the frequency axis and resize the spectra. */
+    sky->num_spectral_channels = num_channels;
+    oskar_mem_realloc(sky->spectral_freq_hz, num_channels, status);
+    oskar_mem_realloc(sky->spectral_I,
+            (size_t) num_channels * (size_t) sky->capacity, status);
+    if (*status) return;
+    freq = oskar_mem_double(sky->spectral_freq_hz, status);
+    for (i = 0; i < num_channels; ++i)
+        freq[i] = freq_hz[i];
+
+    /* Initialise spectra of existing sources. */
+    if (num_channels > 0 && sky->num_sources > 0)
+        oskar_sky_evaluate_power_law_spectra(sky, 0, sky->num_sources,
+                status);
+}
+
+void oskar_sky_evaluate_power_law_spectra(oskar_Sky* sky, int offset,
+        int num_sources, int* status)
+{
+    int i, c, num_channels;
+    const double* freq;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Check location. */
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    num_channels = sky->num_spectral_channels;
+    freq = oskar_mem_double_const(sky->spectral_freq_hz, status);
+    if (oskar_sky_precision(sky) == OSKAR_DOUBLE)
+    {
+        const double *I_, *ref_, *spix_;
+        double* spec;
+        I_    = oskar_mem_double_const(sky->I, status);
+        ref_  = oskar_mem_double_const(sky->reference_freq_hz, status);
+        spix_ = oskar_mem_double_const(sky->spectral_index, status);
+        spec  = oskar_mem_double(sky->spectral_I, status);
+        for (i = offset; i < offset + num_sources; ++i)
+        {
+            for (c = 0; c < num_channels; ++c)
+                spec[(size_t) i * num_channels + c] = (ref_[i] > 0.0) ?
+                        I_[i] * pow(freq[c] / ref_[i], spix_[i]) : I_[i];
+        }
+    }
+    else
+    {
+        const float *I_, *ref_, *spix_;
+        float* spec;
+        I_    = oskar_mem_float_const(sky->I, status);
+        ref_  = oskar_mem_float_const(sky->reference_freq_hz, status);
+        spix_ = oskar_mem_float_const(sky->spectral_index, status);
+        spec  = oskar_mem_float(sky->spectral_I, status);
+        for (i = offset; i < offset + num_sources; ++i)
+        {
+            for (c = 0; c < num_channels; ++c)
+                spec[(size_t) i * num_channels + c] = (ref_[i] > 0.0f) ?
+                        I_[i] * (float) pow(freq[c] / ref_[i], spix_[i]) :
+                        I_[i];
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -86,6 +86,17 @@ void oskar_sky_write(const char* filename, const oskar_Sky* sky, int* status)
     oskar_binary_write_mem(h, oskar_sky_rotation_measure_rad_const(sky),
             group, OSKAR_SKY_TAG_ROTATION_MEASURE, idx, num_sources, status);
 
+    /* Write tabulated spectra, if present. */
+    if (oskar_sky_num_spectral_channels(sky) > 0)
+    {
+        const int num_channels = oskar_sky_num_spectral_channels(sky);
+        oskar_binary_write_mem(h, oskar_sky_spectral_freq_hz_const(sky),
+                group, OSKAR_SKY_TAG_SPECTRAL_FREQ, idx, num_channels, status);
+        oskar_binary_write_mem(h, oskar_sky_spectral_I_const(sky),
+                group, OSKAR_SKY_TAG_SPECTRAL_STOKES_I, idx,
+                (size_t) num_sources * num_channels, status);
+    }
+
     /* Release the handle. */
     oskar_binary_free(h);
 }
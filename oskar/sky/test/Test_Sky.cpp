@@ -35,7 +35,9 @@
 #include "utility/oskar_timer.h"
 #include "utility/oskar_cl_utils.h"
 
+#include <fitsio.h>
 #include <cstdlib>
+#include <vector>
 #include "math/oskar_cmath.h"
 
 #ifdef OSKAR_HAVE_CUDA
@@ -1238,3 +1240,362 @@ TEST(SkyModel, read_write)
     remove(filename);
 }
 
+
+
+TEST(SkyModel, spectral_channels)
+{
+    int status = 0;
+    const int num_sources = 5, num_channels = 3;
+    const double freqs[] = {100e6, 110e6, 130e6};
+    const char* filename = "test_sky_model_spectra.osm";
+
+    // Create a sky model with power-law sources.
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, &status);
+    for (int i = 0; i < num_sources; ++i)
+        oskar_sky_set_source(sky, i, 0.1 * i, 0.2 * i, 1.0 + i, 0.0, 0.0, 0.0,
+                100e6, -0.7, 0.0, 0.0, 0.0, 0.0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Tabulate the spectra and check they match the power law.
+    oskar_sky_set_spectral_channels(sky, num_channels, freqs, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_channels, oskar_sky_num_spectral_channels(sky));
+    double* spec = oskar_mem_double(oskar_sky_spectral_I(sky), &status);
+    for (int i = 0; i < num_sources; ++i)
+        for (int c = 0; c < num_channels; ++c)
+            EXPECT_NEAR((1.0 + i) * pow(freqs[c] / 100e6, -0.7),
+                    spec[i * num_channels + c], 1e-12);
+
+    // Replace the spectra with something that is not a power law.
+    for (int i = 0; i < num_sources; ++i)
+    {
+        spec[i * num_channels + 0] = 1.0 * i;
+        spec[i * num_channels + 1] = 3.0 * i;
+        spec[i * num_channels + 2] = 2.0 * i;
+    }
+
+    // Spectra must follow sources through flux filtering.
+    oskar_sky_set_source(sky, 2, 0.0, 0.0, 100.0, 0.0, 0.0, 0.0,
+            100e6, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    oskar_sky_filter_by_flux(sky, 0.0, 10.0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_sources - 1, oskar_sky_num_sources(sky));
+    spec = oskar_mem_double(oskar_sky_spectral_I(sky), &status);
+    EXPECT_DOUBLE_EQ(3.0 * 3, spec[2 * num_channels + 1]);
+
+    // Spectra must survive splitting into chunks.
+    int num_chunks = 0;
+    oskar_Sky** chunks = 0;
+    oskar_sky_append_to_set(&num_chunks, &chunks, 3, sky, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(2, num_chunks);
+    ASSERT_EQ(num_channels, oskar_sky_num_spectral_channels(chunks[1]));
+    const double* chunk_spec = oskar_mem_double_const(
+            oskar_sky_spectral_I_const(chunks[1]), &status);
+    EXPECT_DOUBLE_EQ(2.0 * 4, chunk_spec[2]);
+
+    // Check interpolation on a device copy, including clamping at the ends.
+    const double test_freqs[] = {90e6, 105e6, 120e6, 150e6};
+    for (int t = 0; t < 4; ++t)
+    {
+        oskar_Sky* sky_dev = oskar_sky_create_copy(sky, device_loc, &status);
+        oskar_sky_scale_flux_with_frequency(sky_dev, test_freqs[t], &status);
+        oskar_Sky* sky_temp = oskar_sky_create_copy(sky_dev, OSKAR_CPU,
+                &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const double* I = oskar_mem_double_const(oskar_sky_I_const(sky_temp),
+                &status);
+        for (int i = 0; i < oskar_sky_num_sources(sky_temp); ++i)
+        {
+            const int src = i < 2 ? i : i + 1;
+            double expected = 0.0;
+            switch (t)
+            {
+            case 0: expected = 1.0 * src; break;
+            case 1: expected = 2.0 * src; break;
+            case 2: expected = 2.5 * src; break;
+            default: expected = 2.0 * src; break;
+            }
+            EXPECT_NEAR(expected, I[i], 1e-12) << "t=" << t << ", i=" << i;
+        }
+        oskar_sky_free(sky_temp, &status);
+        oskar_sky_free(sky_dev, &status);
+    }
+
+    // Check the spectra are preserved when written to and read from a file.
+    oskar_sky_write(filename, sky, &status);
+    oskar_Sky* sky2 = oskar_sky_read(filename, OSKAR_CPU, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_channels, oskar_sky_num_spectral_channels(sky2));
+    EXPECT_EQ(0, oskar_mem_different(oskar_sky_spectral_freq_hz_const(sky),
+            oskar_sky_spectral_freq_hz_const(sky2), 0, &status));
+    EXPECT_EQ(0, oskar_mem_different(oskar_sky_spectral_I_const(sky),
+            oskar_sky_spectral_I_const(sky2),
+            oskar_sky_num_sources(sky) * num_channels, &status));
+    remove(filename);
+
+    for (int i = 0; i < num_chunks; ++i)
+        oskar_sky_free(chunks[i], &status);
+    free(chunks);
+    oskar_sky_free(sky2, &status);
+    oskar_sky_free(sky, &status);
+}
+
+
+TEST(SkyModel, from_fits_cube)
+{
+    int status = 0;
+    const int size = 8, num_channels = 3;
+    const char* filename = "test_sky_model_cube.fits";
+    long naxes[3] = {size, size, num_channels};
+    fitsfile* fptr = 0;
+    double val;
+
+    // Write a cube with two non-zero pixels and a decreasing frequency axis.
+    std::vector<float> cube(size * size * num_channels, 0.0f);
+    for (int c = 0; c < num_channels; ++c)
+    {
+        cube[c * size * size + 1 * size + 2] = 1.0f + c;
+        cube[c * size * size + 5 * size + 6] = (c == 1) ? 5.0f : 0.0f;
+    }
+    remove(filename);
+    fits_create_file(&fptr, filename, &status);
+    fits_create_img(fptr, FLOAT_IMG, 3, naxes, &status);
+    fits_write_key_str(fptr, "BUNIT", "Jy/pixel", 0, &status);
+    fits_write_key_str(fptr, "CTYPE1", "RA---SIN", 0, &status);
+    fits_write_key_str(fptr, "CTYPE2", "DEC--SIN", 0, &status);
+    fits_write_key_str(fptr, "CTYPE3", "FREQ", 0, &status);
+    val = 10.0; fits_write_key_dbl(fptr, "CRVAL1", val, 10, 0, &status);
+    val = 60.0; fits_write_key_dbl(fptr, "CRVAL2", val, 10, 0, &status);
+    val = 120e6; fits_write_key_dbl(fptr, "CRVAL3", val, 10, 0, &status);
+    val = -0.1; fits_write_key_dbl(fptr, "CDELT1", val, 10, 0, &status);
+    val = 0.1; fits_write_key_dbl(fptr, "CDELT2", val, 10, 0, &status);
+    val = -10e6; fits_write_key_dbl(fptr, "CDELT3", val, 10, 0, &status);
+    val = size / 2 + 1; fits_write_key_dbl(fptr, "CRPIX1", val, 10, 0, &status);
+    fits_write_key_dbl(fptr, "CRPIX2", val, 10, 0, &status);
+    val = 1.0; fits_write_key_dbl(fptr, "CRPIX3", val, 10, 0, &status);
+    fits_write_img(fptr, TFLOAT, 1, size * size * num_channels,
+            &cube[0], &status);
+    fits_close_file(fptr, &status);
+    ASSERT_EQ(0, status);
+
+    // Load the cube and check the spectra are in increasing frequency order.
+    oskar_Sky* sky = oskar_sky_from_fits_cube(OSKAR_DOUBLE, filename,
+            0.0, "Jy/pixel", 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(2, oskar_sky_num_sources(sky));
+    ASSERT_EQ(num_channels, oskar_sky_num_spectral_channels(sky));
+    const double* f = oskar_mem_double_const(
+            oskar_sky_spectral_freq_hz_const(sky), &status);
+    EXPECT_DOUBLE_EQ(100e6, f[0]);
+    EXPECT_DOUBLE_EQ(120e6, f[2]);
+    const double* spec = oskar_mem_double_const(
+            oskar_sky_spectral_I_const(sky), &status);
+    EXPECT_DOUBLE_EQ(3.0, spec[0]);
+    EXPECT_DOUBLE_EQ(2.0, spec[1]);
+    EXPECT_DOUBLE_EQ(1.0, spec[2]);
+    EXPECT_DOUBLE_EQ(0.0, spec[3]);
+    EXPECT_DOUBLE_EQ(5.0, spec[4]);
+    EXPECT_DOUBLE_EQ(0.0, spec[5]);
+    const double* I = oskar_mem_double_const(oskar_sky_I_const(sky), &status);
+    EXPECT_DOUBLE_EQ(3.0, I[0]);
+    EXPECT_DOUBLE_EQ(0.0, I[1]);
+
+    // Check the spectra are the same in single precision.
+    oskar_Sky* sky_f = oskar_sky_from_fits_cube(OSKAR_SINGLE, filename,
+            0.0, "Jy/pixel", 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(2, oskar_sky_num_sources(sky_f));
+    const float* spec_f = oskar_mem_float_const(
+            oskar_sky_spectral_I_const(sky_f), &status);
+    for (int i = 0; i < 2 * num_channels; ++i)
+        EXPECT_FLOAT_EQ((float) spec[i], spec_f[i]);
+
+    oskar_sky_free(sky_f, &status);
+    oskar_sky_free(sky, &status);
+    remove(filename);
+}
+
+
+TEST(SkyModel, compact)
+{
+    int status = 0;
+    const double sep = 1.0 / 3600.0 * M_PI / 180.0; // 1 arcsec.
+    const double ra0 = 1.0, dec0 = -0.5;
+    double error_jy = 0.0;
+
+    // Three unresolved components, one isolated source and one Gaussian.
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU, 5, &status);
+    oskar_sky_set_source(sky, 0, ra0, dec0, 2.0, 0.2, 0.0, 0.0,
+            100e6, -0.7, 0.0, 0.0, 0.0, 0.0, &status);
+    oskar_sky_set_source(sky, 1, ra0 + 0.3 * sep, dec0, 1.0, 0.1, 0.0, 0.0,
+            100e6, -0.7, 0.0, 0.0, 0.0, 0.0, &status);
+    oskar_sky_set_source(sky, 2, ra0, dec0 + 0.5 * sep, 1.0, 0.0, 0.0, 0.1,
+            100e6, -0.7, 0.0, 0.0, 0.0, 0.0, &status);
+    oskar_sky_set_source(sky, 3, ra0, dec0 + 100.0 * sep, 5.0, 0.0, 0.0, 0.0,
+            100e6, -0.7, 0.0, 0.0, 0.0, 0.0, &status);
+    oskar_sky_set_source(sky, 4, ra0, dec0 + 0.2 * sep, 1.0, 0.0, 0.0, 0.0,
+            100e6, -0.7, 0.0, 1e-5, 1e-5, 0.0, &status);
+    oskar_sky_set_use_extended(sky, 1);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Compact the sky model.
+    oskar_Sky* out = oskar_sky_compact(sky, sep, 100e6, 100e6, 1000.0,
+            &error_jy, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(3, oskar_sky_num_sources(out));
+    const double* ra = oskar_mem_double_const(
+            oskar_sky_ra_rad_const(out), &status);
+    const double* dec = oskar_mem_double_const(
+            oskar_sky_dec_rad_const(out), &status);
+    const double* I = oskar_mem_double_const(oskar_sky_I_const(out), &status);
+    const double* Q = oskar_mem_double_const(oskar_sky_Q_const(out), &status);
+    const double* V = oskar_mem_double_const(oskar_sky_V_const(out), &status);
+    const double* spix = oskar_mem_double_const(
+            oskar_sky_spectral_index_const(out), &status);
+    const double* maj = oskar_mem_double_const(
+            oskar_sky_fwhm_major_rad_const(out), &status);
+
+    // Groups are ordered by the flux of their brightest component.
+    EXPECT_DOUBLE_EQ(5.0, I[0]);
+    EXPECT_NEAR(4.0, I[1], 1e-12);
+    EXPECT_NEAR(0.3, Q[1], 1e-12);
+    EXPECT_NEAR(0.1, V[1], 1e-12);
+    EXPECT_NEAR(-0.7, spix[1], 1e-12);
+    EXPECT_NEAR(ra0 + 0.075 * sep, ra[1], 1e-3 * sep);
+    EXPECT_NEAR(dec0 + 0.125 * sep, dec[1], 1e-3 * sep);
+    EXPECT_DOUBLE_EQ(1.0, I[2]);
+    EXPECT_DOUBLE_EQ(1e-5, maj[2]);
+    EXPECT_GT(error_jy, 0.0);
+    EXPECT_LT(error_jy, 4.0 * 2.0 * M_PI * M_PI *
+            pow(1000.0 * 100e6 / 299792458.0 * sep, 2.0));
+    oskar_sky_free(out, &status);
+
+    // Check fitted spectral index of components with different spectra.
+    oskar_sky_set_source(sky, 1, ra0 + 0.3 * sep, dec0, 1.0, 0.0, 0.0, 0.0,
+            100e6, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    out = oskar_sky_compact(sky, sep, 100e6, 200e6, 0.0, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(3, oskar_sky_num_sources(out));
+    spix = oskar_mem_double_const(
+            oskar_sky_spectral_index_const(out), &status);
+    I = oskar_mem_double_const(oskar_sky_I_const(out), &status);
+    const double f = sqrt(100e6 * 200e6) / 100e6;
+    EXPECT_NEAR(3.0 * pow(f, -0.7) + 1.0, I[1], 1e-12);
+    for (double freq = 100e6; freq <= 200e6; freq += 25e6)
+    {
+        const double model = I[1] * pow(freq / (f * 100e6), spix[1]);
+        const double exact = 3.0 * pow(freq / 100e6, -0.7) + 1.0;
+        EXPECT_NEAR(1.0, model / exact, 0.01);
+    }
+    oskar_sky_free(out, &status);
+    oskar_sky_free(sky, &status);
+}
+
+
+TEST(SkyModel, from_fits_table)
+{
+    int status = 0;
+    const int num_sources = 20000;
+    const char* fits_file = "test_sky_model_table.fits";
+    const char* text_file = "test_sky_model_table.osm";
+    char names_buf[3][7][FLEN_VALUE] = {
+            {"RAJ2000", "DEJ2000", "Total_flux", "alpha", "Maj", "Min", "PA"},
+            {"1D", "1D", "1E", "1E", "1E", "1E", "1E"},
+            {"deg", "deg", "mJy", "", "arcsec", "arcsec", "deg"}};
+    char *ttype[7], *tform[7], *tunit[7];
+    for (int i = 0; i < 7; ++i)
+    {
+        ttype[i] = names_buf[0][i];
+        tform[i] = names_buf[1][i];
+        tunit[i] = names_buf[2][i];
+    }
+    fitsfile* fptr = 0;
+
+    // Write a catalogue as a FITS binary table.
+    std::vector<double> ra(num_sources), dec(num_sources);
+    std::vector<float> flux(num_sources), alpha(num_sources);
+    std::vector<float> maj(num_sources), min(num_sources), pa(num_sources);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        ra[i] = 360.0 * i / num_sources;
+        dec[i] = -80.0 + 160.0 * (i % 997) / 997.0;
+        flux[i] = 1.0f + (i % 113);
+        alpha[i] = -0.7f + 0.001f * (i % 101);
+        maj[i] = (i % 7 == 0) ? 20.0f : 0.0f;
+        min[i] = (i % 7 == 0) ? 10.0f : 0.0f;
+        pa[i] = (i % 7 == 0) ? 45.0f : 0.0f;
+    }
+    remove(fits_file);
+    fits_create_file(&fptr, fits_file, &status);
+    fits_create_tbl(fptr, BINARY_TBL, num_sources, 7, ttype, tform, tunit,
+            "CATALOGUE", &status);
+    fits_write_col(fptr, TDOUBLE, 1, 1, 1, num_sources, &ra[0], &status);
+    fits_write_col(fptr, TDOUBLE, 2, 1, 1, num_sources, &dec[0], &status);
+    fits_write_col(fptr, TFLOAT, 3, 1, 1, num_sources, &flux[0], &status);
+    fits_write_col(fptr, TFLOAT, 4, 1, 1, num_sources, &alpha[0], &status);
+    fits_write_col(fptr, TFLOAT, 5, 1, 1, num_sources, &maj[0], &status);
+    fits_write_col(fptr, TFLOAT, 6, 1, 1, num_sources, &min[0], &status);
+    fits_write_col(fptr, TFLOAT, 7, 1, 1, num_sources, &pa[0], &status);
+    fits_close_file(fptr, &status);
+    ASSERT_EQ(0, status);
+
+    // Read the table using the default column names.
+    oskar_Sky* sky = oskar_sky_from_fits_table(OSKAR_DOUBLE, fits_file, 0,
+            150e6, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_sources, oskar_sky_num_sources(sky));
+
+    // Compare against the same catalogue loaded from a text file.
+    oskar_sky_save(text_file, sky, &status);
+    oskar_Sky* sky_text = oskar_sky_load(text_file, OSKAR_DOUBLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_sources, oskar_sky_num_sources(sky_text));
+    const double* r = oskar_mem_double_const(
+            oskar_sky_ra_rad_const(sky), &status);
+    const double* I = oskar_mem_double_const(oskar_sky_I_const(sky), &status);
+    const double* f = oskar_mem_double_const(
+            oskar_sky_reference_freq_hz_const(sky), &status);
+    const double* a = oskar_mem_double_const(
+            oskar_sky_spectral_index_const(sky), &status);
+    const double* b = oskar_mem_double_const(
+            oskar_sky_fwhm_major_rad_const(sky), &status);
+    const double* I_text = oskar_mem_double_const(
+            oskar_sky_I_const(sky_text), &status);
+    const double* b_text = oskar_mem_double_const(
+            oskar_sky_fwhm_major_rad_const(sky_text), &status);
+    for (int i = 0; i < num_sources; i += 997)
+    {
+        EXPECT_NEAR(ra[i] * M_PI / 180.0, r[i], 1e-12);
+        EXPECT_NEAR(flux[i] * 1e-3, I[i], 1e-9);
+        EXPECT_NEAR(alpha[i], a[i], 1e-6);
+        EXPECT_DOUBLE_EQ(150e6, f[i]);
+        EXPECT_NEAR(maj[i] * M_PI / 180.0 / 3600.0, b[i], 1e-12);
+        EXPECT_NEAR(I[i], I_text[i], 1e-6 * I[i]);
+        EXPECT_NEAR(b[i], b_text[i], 1e-6 * b[i] + 1e-15);
+    }
+    oskar_sky_free(sky_text, &status);
+    oskar_sky_free(sky, &status);
+
+    // Check explicit column names in single precision, with one thread.
+    const char* names[] = {"RAJ2000", "DEJ2000", "alpha", 0, 0, 0,
+            0, 0, 0, 0, 0, 0};
+    sky = oskar_sky_from_fits_table(OSKAR_SINGLE, fits_file, names,
+            0.0, 1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const float* I_f = oskar_mem_float_const(oskar_sky_I_const(sky), &status);
+    EXPECT_FLOAT_EQ(alpha[5], I_f[5]);
+    oskar_sky_free(sky, &status);
+
+    // Check that a missing column is reported.
+    names[4] = "NO_SUCH_COLUMN";
+    sky = oskar_sky_from_fits_table(OSKAR_SINGLE, fits_file, names,
+            0.0, 1, &status);
+    EXPECT_EQ((int)OSKAR_ERR_BAD_SKY_FILE, status);
+    status = 0;
+    oskar_sky_free(sky, &status);
+
+    remove(fits_file);
+    remove(text_file);
+}
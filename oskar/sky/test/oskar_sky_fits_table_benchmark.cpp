@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "apps/oskar_option_parser.h"
+#include "sky/oskar_sky.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <fitsio.h>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static void write_catalogue(const char* fits_file, int num_sources,
+        int* status);
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_sky_fits_table_benchmark",
+            OSKAR_VERSION_STR);
+    opt.add_flag("-nsrc", "Number of sources.", 1, "", true);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-t", "Number of threads for the FITS table reader "
+            "(default: number of processors).", 1, "0", false);
+    opt.add_flag("-k", "Keep the catalogue files after the benchmark.");
+    opt.add_flag("-n", "Number of iterations", 1, "1", false);
+    opt.add_flag("-v", "Display verbose output.", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int niter, num_sources, num_threads, status = 0;
+    opt.get("-nsrc")->getInt(num_sources);
+    opt.get("-t")->getInt(num_threads);
+    opt.get("-n")->getInt(niter);
+    int type = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    const char* fits_file = "oskar_sky_fits_table_benchmark.fits";
+    const char* text_file = "oskar_sky_fits_table_benchmark.osm";
+    if (num_sources < 1 || niter < 1)
+    {
+        opt.error("Number of sources and iterations must be positive");
+        return EXIT_FAILURE;
+    }
+
+    if (opt.is_set("-v"))
+    {
+        printf("\n");
+        printf("- Number of sources: %i\n", num_sources);
+        printf("- Precision: %s\n", (type == OSKAR_SINGLE) ? "single" : "double");
+        printf("- FITS reader threads: %i\n", num_threads);
+        printf("- Number of iterations: %i\n", niter);
+        printf("\n");
+    }
+
+    // Write the same catalogue as a FITS binary table and as a text file.
+    write_catalogue(fits_file, num_sources, &status);
+    oskar_Sky* sky = oskar_sky_from_fits_table(type, fits_file, 0,
+            150e6, num_threads, &status);
+    oskar_sky_save(text_file, sky, &status);
+    oskar_sky_free(sky, &status);
+
+    // Time loading each file.
+    std::vector<double> times_fits(niter, 0.0), times_text(niter, 0.0);
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    for (int i = 0; i < niter && !status; ++i)
+    {
+        oskar_timer_start(timer);
+        sky = oskar_sky_from_fits_table(type, fits_file, 0, 150e6,
+                num_threads, &status);
+        times_fits[i] = oskar_timer_elapsed(timer);
+        if (!status && oskar_sky_num_sources(sky) != num_sources)
+            status = OSKAR_ERR_DIMENSION_MISMATCH;
+        oskar_sky_free(sky, &status);
+
+        oskar_timer_start(timer);
+        sky = oskar_sky_load(text_file, type, &status);
+        times_text[i] = oskar_timer_elapsed(timer);
+        if (!status && oskar_sky_num_sources(sky) != num_sources)
+            status = OSKAR_ERR_DIMENSION_MISMATCH;
+        oskar_sky_free(sky, &status);
+    }
+    oskar_timer_free(timer);
+    if (!opt.is_set("-k"))
+    {
+        remove(fits_file);
+        remove(text_file);
+    }
+
+    // Check for errors.
+    if (status)
+    {
+        fprintf(stderr, "ERROR: sky model load failed with code %i: %s\n",
+                status, oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+
+    // Compute averages.
+    double average_fits_sec = 0.0, average_text_sec = 0.0;
+    for (int i = 0; i < niter; ++i)
+    {
+        average_fits_sec += times_fits[i];
+        average_text_sec += times_text[i];
+    }
+    average_fits_sec /= niter;
+    average_text_sec /= niter;
+
+    // Print averages.
+    if (opt.is_set("-v"))
+    {
+        printf("==> FITS table load time per iteration: %f seconds.\n",
+                average_fits_sec);
+        printf("==> Text file load time per iteration: %f seconds.\n",
+                average_text_sec);
+        printf("==> Speed-up: %.2f\n", average_text_sec / average_fits_sec);
+        printf("\n");
+    }
+    else
+    {
+        printf("%f %f\n", average_fits_sec, average_text_sec);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+void write_catalogue(const char* fits_file, int num_sources, int* status)
+{
+    char names_buf[3][7][FLEN_VALUE] = {
+            {"RAJ2000", "DEJ2000", "Total_flux", "alpha", "Maj", "Min", "PA"},
+            {"1D", "1D", "1E", "1E", "1E", "1E", "1E"},
+            {"deg", "deg", "mJy", "", "arcsec", "arcsec", "deg"}};
+    char *ttype[7], *tform[7], *tunit[7];
+    fitsfile* fptr = 0;
+    if (*status) return;
+    for (int i = 0; i < 7; ++i)
+    {
+        ttype[i] = names_buf[0][i];
+        tform[i] = names_buf[1][i];
+        tunit[i] = names_buf[2][i];
+    }
+
+    // Fill the columns with values in sensible ranges.
+    std::vector<double> ra(num_sources), dec(num_sources);
+    std::vector<float> flux(num_sources), alpha(num_sources);
+    std::vector<float> maj(num_sources), min(num_sources), pa(num_sources);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        ra[i] = 360.0 * i / num_sources;
+        dec[i] = -80.0 + 160.0 * (i % 997) / 997.0;
+        flux[i] = 1.0f + (i % 113);
+        alpha[i] = -0.7f + 0.001f * (i % 101);
+        maj[i] = (i % 7 == 0) ? 20.0f : 0.0f;
+        min[i] = (i % 7 == 0) ? 10.0f : 0.0f;
+        pa[i] = (i % 7 == 0) ? 45.0f : 0.0f;
+    }
+
+    // Write the binary table.
+    int fits_status = 0;
+    remove(fits_file);
+    fits_create_file(&fptr, fits_file, &fits_status);
+    fits_create_tbl(fptr, BINARY_TBL, num_sources, 7, ttype, tform, tunit,
+            "CATALOGUE", &fits_status);
+    fits_write_col(fptr, TDOUBLE, 1, 1, 1, num_sources, &ra[0], &fits_status);
+    fits_write_col(fptr, TDOUBLE, 2, 1, 1, num_sources, &dec[0], &fits_status);
+    fits_write_col(fptr, TFLOAT, 3, 1, 1, num_sources, &flux[0], &fits_status);
+    fits_write_col(fptr, TFLOAT, 4, 1, 1, num_sources, &alpha[0], &fits_status);
+    fits_write_col(fptr, TFLOAT, 5, 1, 1, num_sources, &maj[0], &fits_status);
+    fits_write_col(fptr, TFLOAT, 6, 1, 1, num_sources, &min[0], &fits_status);
+    fits_write_col(fptr, TFLOAT, 7, 1, 1, num_sources, &pa[0], &fits_status);
+    if (fptr) fits_close_file(fptr, &fits_status);
+    if (fits_status) *status = OSKAR_ERR_FILE_IO;
+}
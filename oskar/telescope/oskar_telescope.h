@@ -60,6 +60,7 @@ enum OSKAR_POL_MODE_TYPE
 #include <telescope/oskar_telescope_analyse.h>
 #include <telescope/oskar_telescope_create.h>
 #include <telescope/oskar_telescope_create_copy.h>
+#include <telescope/oskar_telescope_create_subset.h>
 #include <telescope/oskar_telescope_duplicate_first_station.h>
 #include <telescope/oskar_telescope_free.h>
 #include <telescope/oskar_telescope_load.h>
@@ -68,7 +69,9 @@ enum OSKAR_POL_MODE_TYPE
 #include <telescope/oskar_telescope_load_station_coords_ecef.h>
 #include <telescope/oskar_telescope_load_station_coords_enu.h>
 #include <telescope/oskar_telescope_load_station_coords_wgs84.h>
+#include <telescope/oskar_telescope_load_station_transforms.h>
 #include <telescope/oskar_telescope_log_summary.h>
+#include <telescope/oskar_telescope_memory_bytes.h>
 #include <telescope/oskar_telescope_resize.h>
 #include <telescope/oskar_telescope_save.h>
 #include <telescope/oskar_telescope_save_layout.h>
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_TELESCOPE_CREATE_SUBSET_H_
+#define OSKAR_TELESCOPE_CREATE_SUBSET_H_
+
+/**
+ * @file oskar_telescope_create_subset.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Creates a telescope model containing a subset of the stations of another.
+ *
+ * @details
+ * This function creates a new telescope model at the specified location,
+ * containing copies of only the listed stations of an existing model,
+ * in the order given, and returns a handle to the new model.
+ * All other telescope meta-data are copied unchanged.
+ *
+ * Each station index must be unique and in range, otherwise the status code
+ * is set to OSKAR_ERR_INVALID_ARGUMENT.
+ *
+ * The telescope model must be deallocated using oskar_telescope_free()
+ * when it is no longer required.
+ *
+ * @param[in] src              Pointer to existing telescope model.
+ * @param[in] num_stations     Number of stations to copy.
+ * @param[in] station_indices  Zero-based indices of the stations to copy.
+ * @param[in] location         Location of new telescope model.
+ * @param[in,out]  status      Status return code.
+ *
+ * @return A handle to the new data structure.
+ */
+OSKAR_EXPORT
+oskar_Telescope* oskar_telescope_create_subset(const oskar_Telescope* src,
+        int num_stations, const int* station_indices, int location,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_TELESCOPE_CREATE_SUBSET_H_ */
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_TELESCOPE_LOAD_STATION_TRANSFORMS_H_
+#define OSKAR_TELESCOPE_LOAD_STATION_TRANSFORMS_H_
+
+/**
+ * @file oskar_telescope_load_station_transforms.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Sets up all stations from templates, using a table of transforms.
+ *
+ * @details
+ * This function reads a table of per-station transforms, and sets every
+ * station in the telescope model to be a transformed copy of one of the
+ * supplied template stations. The positions of the stations in the
+ * telescope model are not changed.
+ *
+ * The file must contain one row for each station in the telescope model.
+ * The columns are:
+ *
+ * -# Template index (zero-based; required).
+ * -# Rotation angle, in degrees, East towards North (default 0).
+ * -# Scale factor for the layout (default 1).
+ * -# Offset of the layout towards East, in metres (default 0).
+ * -# Offset of the layout towards North, in metres (default 0).
+ * -# Standard deviation of horizontal element jitter, in metres (default 0).
+ * -# Random seed for the jitter (default 1).
+ *
+ * See oskar_station_apply_transform() for details of how each transform
+ * is applied.
+ *
+ * @param[in,out] telescope    Pointer to telescope model.
+ * @param[in] filename         Path to the table of station transforms.
+ * @param[in] num_templates    Number of template stations.
+ * @param[in] templates        Array of template station handles.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_telescope_load_station_transforms(oskar_Telescope* telescope,
+        const char* filename, int num_templates,
+        const oskar_Station* const* templates, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_TELESCOPE_LOAD_STATION_TRANSFORMS_H_ */
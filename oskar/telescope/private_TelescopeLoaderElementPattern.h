@@ -55,6 +55,9 @@ private:
     void load_functional_data(int port, oskar_Station* station,
             const std::vector<std::string>& keys,
             const std::vector<std::string>& paths, int* status);
+    void load_spherical_wave_data(int port, oskar_Station* station,
+            const std::vector<std::string>& keys,
+            const std::vector<std::string>& paths, int* status);
     static void parse_filename(const char* s, char** buffer, size_t* buflen,
             int* index, double* freq);
     void update_map(std::map<std::string, std::string>& files,
@@ -67,6 +70,8 @@ private:
     std::string fit_root_scalar;
     std::string root_x;
     std::string root_y;
+    std::string sph_wave_root_x;
+    std::string sph_wave_root_y;
     oskar_Telescope* telescope_;
 };
 
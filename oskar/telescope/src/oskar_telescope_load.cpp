@@ -49,6 +49,8 @@ using std::map;
 using std::string;
 using std::vector;
 
+static const char* station_transforms_file = "station_transforms.txt";
+
 static void load_directories(oskar_Telescope* telescope,
         const string& cwd, oskar_Station* station, int depth,
         const vector<oskar_TelescopeLoadAbstract*>& loaders,
@@ -145,7 +147,35 @@ static void load_directories(oskar_Telescope* telescope,
             }
         }
 
-        if (num_dirs == 1)
+        if (num_dirs > 0 &&
+                oskar_dir_file_exists(cwd.c_str(), station_transforms_file))
+        {
+            // Station directories are templates. Load each of them, then
+            // set up all stations as transformed copies of the templates.
+            vector<oskar_Station*> templates(num_dirs);
+            for (int i = 0; i < num_dirs; ++i)
+            {
+                templates[i] = oskar_station_create(
+                        oskar_telescope_precision(telescope), OSKAR_CPU, 0,
+                        status);
+                load_directories(telescope,
+                        oskar_TelescopeLoadAbstract::get_path(cwd, children[i]),
+                        templates[i], depth + 1, loaders, filemap, log, status);
+            }
+            oskar_telescope_load_station_transforms(telescope,
+                    oskar_TelescopeLoadAbstract::get_path(cwd,
+                            station_transforms_file).c_str(),
+                    num_dirs, &templates[0], status);
+            if (*status)
+            {
+                string s = string("Error loading station transforms in '") +
+                        cwd + string("'.");
+                oskar_log_error(log, "%s", s.c_str());
+            }
+            for (int i = 0; i < num_dirs; ++i)
+                oskar_station_free(templates[i], status);
+        }
+        else if (num_dirs == 1)
         {
             // One station directory. Load and copy it to all the others.
             // Recursive call to load the station.
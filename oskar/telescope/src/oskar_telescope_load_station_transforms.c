@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/oskar_telescope.h"
+#include "telescope/private_telescope.h"
+#include "math/oskar_cmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_telescope_load_station_transforms(oskar_Telescope* telescope,
+        const char* filename, int num_templates,
+        const oskar_Station* const* templates, int* status)
+{
+    int i, num_rows;
+    oskar_Mem *index, *rot, *scale, *dx, *dy, *jitter, *seed;
+    const double *index_, *rot_, *scale_, *dx_, *dy_, *jitter_, *seed_;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Load columns from file. */
+    index = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    rot = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    scale = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    dx = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    dy = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    jitter = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    seed = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    num_rows = (int) oskar_mem_load_ascii(filename, 7, status,
+            index, "", rot, "0.0", scale, "1.0", dx, "0.0", dy, "0.0",
+            jitter, "0.0", seed, "1");
+
+    /* Check there is one row per station. */
+    if (!*status && num_rows != telescope->num_stations)
+        *status = OSKAR_ERR_SETUP_FAIL_TELESCOPE_ENTRIES_MISMATCH;
+    index_ = oskar_mem_double_const(index, status);
+    rot_ = oskar_mem_double_const(rot, status);
+    scale_ = oskar_mem_double_const(scale, status);
+    dx_ = oskar_mem_double_const(dx, status);
+    dy_ = oskar_mem_double_const(dy, status);
+    jitter_ = oskar_mem_double_const(jitter, status);
+    seed_ = oskar_mem_double_const(seed, status);
+
+    /* Replace each station with a transformed copy of its template. */
+    for (i = 0; i < num_rows && !*status; ++i)
+    {
+        double lon, lat, alt;
+        oskar_Station* station;
+        const int t = (int) index_[i];
+        if (t < 0 || t >= num_templates)
+        {
+            *status = OSKAR_ERR_OUT_OF_RANGE;
+            break;
+        }
+
+        /* Keep the station position, which is defined by the layout. */
+        station = telescope->station[i];
+        lon = oskar_station_lon_rad(station);
+        lat = oskar_station_lat_rad(station);
+        alt = oskar_station_alt_metres(station);
+        oskar_station_free(station, status);
+        station = oskar_station_create_copy(templates[t],
+                telescope->mem_location, status);
+        telescope->station[i] = station;
+        oskar_station_set_position(station, lon, lat, alt);
+        oskar_station_apply_transform(station, rot_[i] * M_PI / 180.0,
+                scale_[i], dx_[i], dy_[i], jitter_[i],
+                (unsigned int) seed_[i], (unsigned int) i, status);
+    }
+
+    /* Free memory. */
+    oskar_mem_free(index, status);
+    oskar_mem_free(rot, status);
+    oskar_mem_free(scale, status);
+    oskar_mem_free(dx, status);
+    oskar_mem_free(dy, status);
+    oskar_mem_free(jitter, status);
+    oskar_mem_free(seed, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -48,6 +48,8 @@ TelescopeLoaderElementPattern::TelescopeLoaderElementPattern()
     fit_root_scalar = root_name + "_fit_scalar_";
     root_x = root_name + "_x_";
     root_y = root_name + "_y_";
+    sph_wave_root_x = root_name + "_spherical_wave_x_";
+    sph_wave_root_y = root_name + "_spherical_wave_y_";
 }
 
 TelescopeLoaderElementPattern::~TelescopeLoaderElementPattern()
@@ -108,6 +110,8 @@ void TelescopeLoaderElementPattern::load_element_patterns(
     vector<string> keys_fit_x, keys_fit_y, keys_fit_scalar;
     vector<string> paths_fit_x, paths_fit_y, paths_fit_scalar;
     vector<string> keys_x, keys_y, paths_x, paths_y;
+    vector<string> keys_sph_wave_x, keys_sph_wave_y;
+    vector<string> paths_sph_wave_x, paths_sph_wave_y;
     for (map<string, string>::const_iterator i = filemap.begin();
             i != filemap.end(); ++i)
     {
@@ -127,6 +131,16 @@ void TelescopeLoaderElementPattern::load_element_patterns(
             keys_fit_scalar.push_back(key);
             paths_fit_scalar.push_back(i->second);
         }
+        else if (key.compare(0, sph_wave_root_x.size(), sph_wave_root_x) == 0)
+        {
+            keys_sph_wave_x.push_back(key);
+            paths_sph_wave_x.push_back(i->second);
+        }
+        else if (key.compare(0, sph_wave_root_y.size(), sph_wave_root_y) == 0)
+        {
+            keys_sph_wave_y.push_back(key);
+            paths_sph_wave_y.push_back(i->second);
+        }
         else if (key.compare(0, root_x.size(), root_x) == 0)
         {
             keys_x.push_back(key);
@@ -152,10 +166,15 @@ void TelescopeLoaderElementPattern::load_element_patterns(
     }
 
     // Load fitted X, Y or scalar data.
+    // Spherical wave coefficients are only used for polarised simulations.
     if (oskar_telescope_pol_mode(telescope_) == OSKAR_POL_MODE_FULL)
     {
         load_fitted_data(1, station, keys_fit_x, paths_fit_x, status);
         load_fitted_data(2, station, keys_fit_y, paths_fit_y, status);
+        load_spherical_wave_data(1, station,
+                keys_sph_wave_x, paths_sph_wave_x, status);
+        load_spherical_wave_data(2, station,
+                keys_sph_wave_y, paths_sph_wave_y, status);
     }
     else
         load_fitted_data(0, station, keys_fit_scalar, paths_fit_scalar, status);
@@ -218,6 +237,33 @@ void TelescopeLoaderElementPattern::load_functional_data(int port,
     free(buffer);
 }
 
+void TelescopeLoaderElementPattern::load_spherical_wave_data(int port,
+        oskar_Station* station, const vector<string>& keys,
+        const vector<string>& paths, int* status)
+{
+    size_t buflen = 0;
+    char* buffer = 0;
+    if (*status) return;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        int ind = 0;
+        double freq = 0.0;
+        string key = keys[i];
+        string path = paths[i];
+
+        // Get the element index and frequency from the key.
+        parse_filename(key.c_str(), &buffer, &buflen, &ind, &freq);
+
+        // Load the file.
+        if (*status) break;
+        if (oskar_station_num_element_types(station) < ind + 1)
+            oskar_station_resize_element_types(station, ind + 1, status);
+        oskar_element_load_spherical_wave(oskar_station_element(station, ind),
+                path.c_str(), port, freq, status);
+    }
+    free(buffer);
+}
+
 void TelescopeLoaderElementPattern::parse_filename(const char* s,
         char** buffer, size_t* buflen, int* index, double* freq)
 {
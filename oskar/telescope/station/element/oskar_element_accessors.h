@@ -56,6 +56,12 @@ int oskar_element_has_y_spline_data(const oskar_Element* data);
 OSKAR_EXPORT
 int oskar_element_has_scalar_spline_data(const oskar_Element* data);
 
+OSKAR_EXPORT
+int oskar_element_has_x_spherical_wave_data(const oskar_Element* data);
+
+OSKAR_EXPORT
+int oskar_element_has_y_spherical_wave_data(const oskar_Element* data);
+
 OSKAR_EXPORT
 int oskar_element_num_freq(const oskar_Element* data);
 
@@ -174,6 +180,20 @@ OSKAR_EXPORT
 const oskar_Splines* oskar_element_scalar_im_const(const oskar_Element* data,
         int freq_id);
 
+OSKAR_EXPORT
+oskar_Mem* oskar_element_x_spherical_wave(oskar_Element* data, int freq_id);
+
+OSKAR_EXPORT
+const oskar_Mem* oskar_element_x_spherical_wave_const(
+        const oskar_Element* data, int freq_id);
+
+OSKAR_EXPORT
+oskar_Mem* oskar_element_y_spherical_wave(oskar_Element* data, int freq_id);
+
+OSKAR_EXPORT
+const oskar_Mem* oskar_element_y_spherical_wave_const(
+        const oskar_Element* data, int freq_id);
+
 
 /* Setters. */
 
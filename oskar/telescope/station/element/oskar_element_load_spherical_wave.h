@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_ELEMENT_LOAD_SPHERICAL_WAVE_H_
+#define OSKAR_ELEMENT_LOAD_SPHERICAL_WAVE_H_
+
+/**
+ * @file oskar_element_load_spherical_wave.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Loads spherical wave coefficients for an element pattern from a text file.
+ *
+ * @details
+ * This function loads the coefficients of a spherical wave expansion of
+ * the far-field pattern of one dipole of an element, at one frequency.
+ *
+ * The file must contain one row per mode, with (up to) six columns:
+ *
+ * - The mode degree, l (l >= 1).
+ * - The mode order, m (-l <= m <= l).
+ * - The real and imaginary parts of the TE (magnetic) coefficient.
+ * - The real and imaginary parts of the TM (electric) coefficient.
+ *
+ * The TM coefficient may be omitted, in which case it is set to zero,
+ * as are the coefficients of any modes not listed in the file.
+ * The maximum degree of the expansion is the largest value of l in the file.
+ * See oskar_evaluate_spherical_wave_sum() for the definition of the modes.
+ *
+ * @param[in,out] data   Pointer to element model data structure to fill.
+ * @param[in]  filename  Data file name.
+ * @param[in]  port      Port number to load: 1 for X dipole, 2 for Y dipole.
+ * @param[in]  freq_hz   The frequency in Hz that this data applies to.
+ * @param[in,out] status Status return code.
+ */
+OSKAR_EXPORT
+void oskar_element_load_spherical_wave(oskar_Element* data,
+        const char* filename, int port, double freq_hz, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_ELEMENT_LOAD_SPHERICAL_WAVE_H_ */
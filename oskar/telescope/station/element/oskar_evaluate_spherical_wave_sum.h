@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_EVALUATE_SPHERICAL_WAVE_SUM_H_
+#define OSKAR_EVALUATE_SPHERICAL_WAVE_SUM_H_
+
+/**
+ * @file oskar_evaluate_spherical_wave_sum.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Evaluates an element pattern from spherical wave coefficients
+ * (single precision).
+ *
+ * @details
+ * This function evaluates the far-field pattern of a dipole from the
+ * coefficients of its spherical wave expansion:
+ *
+ * \f{eqnarray*}{
+ * E_{\theta} &=& \sum_{l=1}^{L} \sum_{m=-l}^{l}
+ *      \left( \alpha^{TE}_{lm} \frac{i m \bar{P}_l^{|m|}}{\sin\theta} +
+ *      \alpha^{TM}_{lm} \frac{d\bar{P}_l^{|m|}}{d\theta} \right)
+ *      \frac{e^{i m \phi}}{\sqrt{l(l+1)}} \\
+ * E_{\phi} &=& \sum_{l=1}^{L} \sum_{m=-l}^{l}
+ *      \left( -\alpha^{TE}_{lm} \frac{d\bar{P}_l^{|m|}}{d\theta} +
+ *      \alpha^{TM}_{lm} \frac{i m \bar{P}_l^{|m|}}{\sin\theta} \right)
+ *      \frac{e^{i m \phi}}{\sqrt{l(l+1)}}
+ * \f}
+ *
+ * where \f$ \bar{P}_l^m(\cos\theta) \f$ are the associated Legendre
+ * functions (without the Condon-Shortley phase), normalised by
+ * \f$ \sqrt{\frac{2l+1}{4\pi}\frac{(l-m)!}{(l+m)!}} \f$.
+ *
+ * The Legendre functions are evaluated using stable recurrence relations in
+ * the degree l, and the azimuthal terms using the recurrence
+ * \f$ e^{i(m+1)\phi} = e^{im\phi} e^{i\phi} \f$, so that only one sine and
+ * cosine of each angle is needed per point.
+ *
+ * The coefficients are stored as (TE, TM) pairs, in order of increasing l
+ * and then m, so the TE coefficient for mode (l, m) is at index
+ * 2 * (l * l - 1 + l + m).
+ *
+ * The supplied theta and phi positions of the sources are the <b>modified</b>
+ * source positions. They must be adjusted relative to a dipole with its axis
+ * oriented along the x-direction.
+ *
+ * @param[in] num_points         Number of points.
+ * @param[in] theta              Point position (modified) theta values in rad.
+ * @param[in] phi                Point position (modified) phi values in rad.
+ * @param[in] l_max              Maximum degree of the expansion.
+ * @param[in] alpha              Array of (TE, TM) coefficient pairs.
+ * @param[in] stride             Stride into output arrays (normally 4).
+ * @param[out] E_theta           Response per point in E_theta.
+ * @param[out] E_phi             Response per point in E_phi.
+ * @param[in,out] status         Status return code.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_spherical_wave_sum_f(int num_points, const float* theta,
+        const float* phi, int l_max, const float2* alpha, int stride,
+        float2* E_theta, float2* E_phi, int* status);
+
+/**
+ * @brief
+ * Evaluates an element pattern from spherical wave coefficients
+ * (double precision).
+ *
+ * @details
+ * See oskar_evaluate_spherical_wave_sum_f().
+ *
+ * @param[in] num_points         Number of points.
+ * @param[in] theta              Point position (modified) theta values in rad.
+ * @param[in] phi                Point position (modified) phi values in rad.
+ * @param[in] l_max              Maximum degree of the expansion.
+ * @param[in] alpha              Array of (TE, TM) coefficient pairs.
+ * @param[in] stride             Stride into output arrays (normally 4).
+ * @param[out] E_theta           Response per point in E_theta.
+ * @param[out] E_phi             Response per point in E_phi.
+ * @param[in,out] status         Status return code.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_spherical_wave_sum_d(int num_points, const double* theta,
+        const double* phi, int l_max, const double2* alpha, int stride,
+        double2* E_theta, double2* E_phi, int* status);
+
+/**
+ * @brief
+ * Evaluates an element pattern from spherical wave coefficients.
+ *
+ * @details
+ * This function evaluates the pattern of a dipole from the coefficients
+ * of its spherical wave expansion, writing the E_theta and E_phi components
+ * into a polarised output array.
+ * See oskar_evaluate_spherical_wave_sum_f() for details.
+ *
+ * The maximum degree of the expansion is obtained from the length of the
+ * coefficient array.
+ *
+ * @param[out] pattern           Array of output Jones matrices per source.
+ * @param[in] num_points         Number of points.
+ * @param[in] theta              Point position (modified) theta values in rad.
+ * @param[in] phi                Point position (modified) phi values in rad.
+ * @param[in] alpha              Array of (TE, TM) coefficient pairs.
+ * @param[in] offset             Offset index into output arrays.
+ * @param[in] stride             Stride into output array (normally 4).
+ * @param[in,out] status         Status return code.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_spherical_wave_sum(oskar_Mem* pattern, int num_points,
+        const oskar_Mem* theta, const oskar_Mem* phi, const oskar_Mem* alpha,
+        int offset, int stride, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_EVALUATE_SPHERICAL_WAVE_SUM_H_ */
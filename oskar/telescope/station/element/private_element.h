@@ -79,6 +79,10 @@ struct oskar_Element
     oskar_Splines** y_v_im;
     oskar_Splines** scalar_re;
     oskar_Splines** scalar_im;
+
+    /* Spherical wave coefficients (TE, TM pairs for each l, m), per frequency. */
+    oskar_Mem** sph_wave_x;
+    oskar_Mem** sph_wave_y;
 };
 
 #ifndef OSKAR_ELEMENT_TYPEDEF_
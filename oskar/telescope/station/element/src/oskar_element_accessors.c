@@ -71,6 +71,22 @@ int oskar_element_has_scalar_spline_data(const oskar_Element* data)
             oskar_splines_have_coeffs(data->scalar_im[0]));
 }
 
+int oskar_element_has_x_spherical_wave_data(const oskar_Element* data)
+{
+    int i;
+    for (i = 0; i < data->num_freq; ++i)
+        if (oskar_mem_length(data->sph_wave_x[i]) > 0) return 1;
+    return 0;
+}
+
+int oskar_element_has_y_spherical_wave_data(const oskar_Element* data)
+{
+    int i;
+    for (i = 0; i < data->num_freq; ++i)
+        if (oskar_mem_length(data->sph_wave_y[i]) > 0) return 1;
+    return 0;
+}
+
 int oskar_element_num_freq(const oskar_Element* data)
 {
     return data->num_freq;
@@ -271,6 +287,32 @@ oskar_Splines* oskar_element_scalar_im(oskar_Element* data, int freq_id)
     return data->scalar_im[freq_id];
 }
 
+oskar_Mem* oskar_element_x_spherical_wave(oskar_Element* data, int freq_id)
+{
+    if (freq_id >= data->num_freq) return 0;
+    return data->sph_wave_x[freq_id];
+}
+
+const oskar_Mem* oskar_element_x_spherical_wave_const(
+        const oskar_Element* data, int freq_id)
+{
+    if (freq_id >= data->num_freq) return 0;
+    return data->sph_wave_x[freq_id];
+}
+
+oskar_Mem* oskar_element_y_spherical_wave(oskar_Element* data, int freq_id)
+{
+    if (freq_id >= data->num_freq) return 0;
+    return data->sph_wave_y[freq_id];
+}
+
+const oskar_Mem* oskar_element_y_spherical_wave_const(
+        const oskar_Element* data, int freq_id)
+{
+    if (freq_id >= data->num_freq) return 0;
+    return data->sph_wave_y[freq_id];
+}
+
 const oskar_Splines* oskar_element_scalar_im_const(const oskar_Element* data,
         int freq_id)
 {
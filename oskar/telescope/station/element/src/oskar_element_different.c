@@ -43,6 +43,12 @@ int oskar_element_different(const oskar_Element* a, const oskar_Element* b,
 
     if (a->precision != b->precision) return 1;
 
+    if (a->element_type != b->element_type) return 1;
+    if (a->taper_type != b->taper_type) return 1;
+    if (a->dipole_length != b->dipole_length) return 1;
+    if (a->dipole_length_units != b->dipole_length_units) return 1;
+    if (a->cosine_power != b->cosine_power) return 1;
+    if (a->gaussian_fwhm_rad != b->gaussian_fwhm_rad) return 1;
     if (a->coord_sys != b->coord_sys) return 1;
     if (a->max_radius_rad != b->max_radius_rad) return 1;
     if (a->x_element_type != b->x_element_type) return 1;
@@ -72,6 +78,12 @@ int oskar_element_different(const oskar_Element* a, const oskar_Element* b,
         if (oskar_mem_different(a->filename_scalar[i], b->filename_scalar[i],
                 0, status))
             return 1;
+        if (oskar_mem_different(a->sph_wave_x[i], b->sph_wave_x[i],
+                0, status))
+            return 1;
+        if (oskar_mem_different(a->sph_wave_y[i], b->sph_wave_y[i],
+                0, status))
+            return 1;
     }
 
     /* Elements are the same. */
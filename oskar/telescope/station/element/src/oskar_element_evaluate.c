@@ -33,6 +33,7 @@
 #include "telescope/station/element/oskar_apply_element_taper_gaussian.h"
 #include "telescope/station/element/oskar_evaluate_dipole_pattern.h"
 #include "telescope/station/element/oskar_evaluate_geometric_dipole_pattern.h"
+#include "telescope/station/element/oskar_evaluate_spherical_wave_sum.h"
 #include "convert/oskar_convert_enu_directions_to_theta_phi.h"
 #include "convert/oskar_convert_ludwig3_to_theta_phi_components.h"
 #include "math/oskar_find_closest_match.h"
@@ -45,6 +46,9 @@
 extern "C" {
 #endif
 
+static int closest_sph_wave_freq(double frequency_hz, int num_freq,
+        const double* freqs_hz, oskar_Mem* const* sph_wave);
+
 void oskar_element_evaluate(const oskar_Element* model, oskar_Mem* output,
         double orientation_x, double orientation_y, int num_points,
         const oskar_Mem* x, const oskar_Mem* y, const oskar_Mem* z,
@@ -91,8 +95,20 @@ void oskar_element_evaluate(const oskar_Element* model, oskar_Mem* output,
     /* Evaluate polarised response if output array is matrix type. */
     if (oskar_mem_is_matrix(output))
     {
+        /* Check if spherical wave data present for dipole X. */
+        if (oskar_element_has_x_spherical_wave_data(model))
+        {
+            /* Get the closest frequency with coefficients for dipole X. */
+            freq_id = closest_sph_wave_freq(frequency_hz, model->num_freq,
+                    model->freqs_hz, model->sph_wave_x);
+
+            /* Evaluate spherical wave sum for dipole X. */
+            oskar_evaluate_spherical_wave_sum(output, num_points, theta, phi,
+                    model->sph_wave_x[freq_id], 0, 4, status);
+        }
+
         /* Check if spline data present for dipole X. */
-        if (oskar_element_has_x_spline_data(model))
+        else if (oskar_element_has_x_spline_data(model))
         {
             /* Get the frequency index. */
             freq_id = oskar_find_closest_match_d(frequency_hz,
@@ -130,8 +146,20 @@ void oskar_element_evaluate(const oskar_Element* model, oskar_Mem* output,
         oskar_convert_enu_directions_to_theta_phi(num_points, x, y, z,
                 M_PI_2 - orientation_y, theta, phi, status);
 
+        /* Check if spherical wave data present for dipole Y. */
+        if (oskar_element_has_y_spherical_wave_data(model))
+        {
+            /* Get the closest frequency with coefficients for dipole Y. */
+            freq_id = closest_sph_wave_freq(frequency_hz, model->num_freq,
+                    model->freqs_hz, model->sph_wave_y);
+
+            /* Evaluate spherical wave sum for dipole Y. */
+            oskar_evaluate_spherical_wave_sum(output, num_points, theta, phi,
+                    model->sph_wave_y[freq_id], 2, 4, status);
+        }
+
         /* Check if spline data present for dipole Y. */
-        if (oskar_element_has_y_spline_data(model))
+        else if (oskar_element_has_y_spline_data(model))
         {
             /* Get the frequency index. */
             freq_id = oskar_find_closest_match_d(frequency_hz,
@@ -207,6 +235,28 @@ void oskar_element_evaluate(const oskar_Element* model, oskar_Mem* output,
     }
 }
 
+/* Returns the index of the frequency closest to the one given, for which
+ * spherical wave coefficients have been loaded. Coefficients need not be
+ * present at every frequency if the ports were loaded separately. */
+static int closest_sph_wave_freq(double frequency_hz, int num_freq,
+        const double* freqs_hz, oskar_Mem* const* sph_wave)
+{
+    int i, best = -1;
+    double best_diff = 0.0;
+    for (i = 0; i < num_freq; ++i)
+    {
+        double diff;
+        if (oskar_mem_length(sph_wave[i]) == 0) continue;
+        diff = fabs(freqs_hz[i] - frequency_hz);
+        if (best < 0 || diff < best_diff)
+        {
+            best = i;
+            best_diff = diff;
+        }
+    }
+    return best;
+}
+
 #ifdef __cplusplus
 }
 #endif
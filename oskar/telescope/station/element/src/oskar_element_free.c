@@ -54,6 +54,8 @@ void oskar_element_free(oskar_Element* data, int* status)
         oskar_splines_free(data->y_h_im[i], status);
         oskar_splines_free(data->scalar_re[i], status);
         oskar_splines_free(data->scalar_im[i], status);
+        oskar_mem_free(data->sph_wave_x[i], status);
+        oskar_mem_free(data->sph_wave_y[i], status);
     }
     free(data->freqs_hz);
     free(data->filename_x);
@@ -69,6 +71,8 @@ void oskar_element_free(oskar_Element* data, int* status)
     free(data->y_v_im);
     free(data->scalar_re);
     free(data->scalar_im);
+    free(data->sph_wave_x);
+    free(data->sph_wave_y);
 
     /* Free the structure itself. */
     free(data);
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/element/private_element.h"
+#include "telescope/station/element/oskar_element.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_element_load_spherical_wave(oskar_Element* data,
+        const char* filename, int port, double freq_hz, int* status)
+{
+    oskar_Mem *l, *m, *te_re, *te_im, *tm_re, *tm_im, *coeffs, *filename_mem;
+    const double *l_, *m_, *te_re_, *te_im_, *tm_re_, *tm_im_;
+    int i, j, l_max = 0, num_coeffs, num_rows, type;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Check the port number. */
+    if (port != 1 && port != 2)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+
+    /* Load the columns from the file. */
+    l = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    m = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    te_re = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    te_im = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    tm_re = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    tm_im = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    num_rows = (int) oskar_mem_load_ascii(filename, 6, status,
+            l, "", m, "", te_re, "", te_im, "", tm_re, "0.0", tm_im, "0.0");
+    l_ = oskar_mem_double_const(l, status);
+    m_ = oskar_mem_double_const(m, status);
+    te_re_ = oskar_mem_double_const(te_re, status);
+    te_im_ = oskar_mem_double_const(te_im, status);
+    tm_re_ = oskar_mem_double_const(tm_re, status);
+    tm_im_ = oskar_mem_double_const(tm_im, status);
+
+    /* Find the maximum degree, and check the mode indices. */
+    for (i = 0; i < num_rows && !*status; ++i)
+    {
+        const int l_i = (int) l_[i], m_i = (int) m_[i];
+        if (l_i < 1 || m_i < -l_i || m_i > l_i)
+            *status = OSKAR_ERR_INVALID_ARGUMENT;
+        if (l_i > l_max) l_max = l_i;
+    }
+    if (num_rows == 0 && !*status)
+        *status = OSKAR_ERR_FILE_IO;
+
+    /* Store (TE, TM) coefficient pairs in order of l, then m. */
+    type = oskar_element_precision(data) | OSKAR_COMPLEX;
+    num_coeffs = l_max * (l_max + 2);
+    coeffs = oskar_mem_create(type, OSKAR_CPU, 2 * num_coeffs, status);
+    oskar_mem_clear_contents(coeffs, status);
+    for (i = 0; i < num_rows && !*status; ++i)
+    {
+        const int l_i = (int) l_[i], m_i = (int) m_[i];
+        j = 2 * (l_i * l_i - 1 + l_i + m_i);
+        if (type == OSKAR_DOUBLE_COMPLEX)
+        {
+            double2* c = oskar_mem_double2(coeffs, status);
+            c[j].x = te_re_[i];
+            c[j].y = te_im_[i];
+            c[j + 1].x = tm_re_[i];
+            c[j + 1].y = tm_im_[i];
+        }
+        else
+        {
+            float2* c = oskar_mem_float2(coeffs, status);
+            c[j].x = (float) te_re_[i];
+            c[j].y = (float) te_im_[i];
+            c[j + 1].x = (float) tm_re_[i];
+            c[j + 1].y = (float) tm_im_[i];
+        }
+    }
+
+    /* Check if this frequency has already been set, and get its index if so. */
+    for (i = 0; i < data->num_freq && !*status; ++i)
+    {
+        if (fabs(data->freqs_hz[i] - freq_hz) <= freq_hz * DBL_EPSILON)
+            break;
+    }
+
+    /* Expand arrays to hold data for a new frequency, if needed. */
+    if (i >= data->num_freq && !*status)
+    {
+        i = data->num_freq;
+        oskar_element_resize_freq_data(data, i + 1, status);
+    }
+
+    /* Store the frequency, coefficients and filename. */
+    if (!*status)
+    {
+        data->freqs_hz[i] = freq_hz;
+        oskar_mem_copy(port == 1 ? data->sph_wave_x[i] : data->sph_wave_y[i],
+                coeffs, status);
+        filename_mem = (port == 1) ? data->filename_x[i] : data->filename_y[i];
+        oskar_mem_append_raw(filename_mem, filename, OSKAR_CHAR,
+                OSKAR_CPU, 1 + strlen(filename), status);
+    }
+
+    /* Free scratch arrays. */
+    oskar_mem_free(l, status);
+    oskar_mem_free(m, status);
+    oskar_mem_free(te_re, status);
+    oskar_mem_free(te_im, status);
+    oskar_mem_free(tm_re, status);
+    oskar_mem_free(tm_im, status);
+    oskar_mem_free(coeffs, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
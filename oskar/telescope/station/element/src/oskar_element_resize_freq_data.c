@@ -70,6 +70,10 @@ void oskar_element_resize_freq_data(oskar_Element* model, int size,
             model->y_h_im[i] = oskar_splines_create(precision, loc, status);
             model->scalar_re[i] = oskar_splines_create(precision, loc, status);
             model->scalar_im[i] = oskar_splines_create(precision, loc, status);
+            model->sph_wave_x[i] = oskar_mem_create(
+                    precision | OSKAR_COMPLEX, loc, 0, status);
+            model->sph_wave_y[i] = oskar_mem_create(
+                    precision | OSKAR_COMPLEX, loc, 0, status);
         }
     }
     else if (size < old_size)
@@ -90,6 +94,8 @@ void oskar_element_resize_freq_data(oskar_Element* model, int size,
             oskar_splines_free(model->y_h_im[i], status);
             oskar_splines_free(model->scalar_re[i], status);
             oskar_splines_free(model->scalar_im[i], status);
+            oskar_mem_free(model->sph_wave_x[i], status);
+            oskar_mem_free(model->sph_wave_y[i], status);
         }
         realloc_arrays(model, size, status);
     }
@@ -133,6 +139,10 @@ static void realloc_arrays(oskar_Element* e, int size, int* status)
     if (!e->scalar_re) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
     e->scalar_im = realloc(e->scalar_im, size * sizeof(oskar_Splines*));
     if (!e->scalar_im) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    e->sph_wave_x = realloc(e->sph_wave_x, size * sizeof(oskar_Mem*));
+    if (!e->sph_wave_x) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    e->sph_wave_y = realloc(e->sph_wave_y, size * sizeof(oskar_Mem*));
+    if (!e->sph_wave_y) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
 }
 
 #ifdef __cplusplus
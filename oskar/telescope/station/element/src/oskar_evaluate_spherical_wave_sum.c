@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/element/oskar_evaluate_spherical_wave_sum.h"
+#include "math/oskar_cmath.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Accumulates the contribution of mode (l, S) into the E_theta and
+ * E_phi sums (A and B), given the values of P_l^|m| / sin(theta) (MQ, already
+ * multiplied by S) and dP_l^|m| / d(theta) (D), the azimuthal term E and the
+ * coefficient index J of the TE term for mode (l, 0).
+ */
+#define OSKAR_SPHERICAL_WAVE_MODE(S, MQ, D, E, J) {                        \
+        const int k_ = J + 2 * (S);                                        \
+        const double re_te_ = alpha[k_].x, im_te_ = alpha[k_].y;           \
+        const double re_tm_ = alpha[k_ + 1].x, im_tm_ = alpha[k_ + 1].y;   \
+        const double at_x_ = -(MQ) * im_te_ + (D) * re_tm_;                \
+        const double at_y_ = (MQ) * re_te_ + (D) * im_tm_;                 \
+        const double ap_x_ = -(D) * re_te_ - (MQ) * im_tm_;                \
+        const double ap_y_ = -(D) * im_te_ + (MQ) * re_tm_;                \
+        A.x += at_x_ * E.x - at_y_ * E.y;                                  \
+        A.y += at_x_ * E.y + at_y_ * E.x;                                  \
+        B.x += ap_x_ * E.x - ap_y_ * E.y;                                  \
+        B.y += ap_x_ * E.y + ap_y_ * E.x; }
+
+/* Number of coefficients stored for each mode (l, m). */
+#define NUM_COEFFS 5
+
+/*
+ * Pre-computes the (point-independent) coefficients of the recurrence
+ * relations for the normalised associated Legendre functions, so the
+ * inner loops need only multiplications and additions.
+ *
+ * For m >= 1, with q_l = P_l^m / sin(theta) and x = cos(theta):
+ *   q_m     = sqrt((2m + 1) / 2m) * P_(m-1)^(m-1)
+ *   q_l     = a_lm * (x * q_(l-1) - b_lm * q_(l-2))
+ *   dP_l^m / d(theta) = l * x * q_l - c_lm * q_(l-1)
+ * and for m = 0:
+ *   dP_l^0 / d(theta) = -sqrt(l(l + 1)) * P_l^1
+ *
+ * The mode normalisation 1 / sqrt(l(l + 1)) is folded into the
+ * coefficients of the derivative and of m * q_l, which are stored after
+ * a_lm and b_lm.
+ */
+static double* recurrence_coeffs(int l_max)
+{
+    int l, m, k;
+    const int n = l_max + 1;
+    double* c = (double*) malloc(NUM_COEFFS * n * n * sizeof(double));
+    if (!c) return 0;
+    for (l = 1; l <= l_max; ++l)
+    {
+        const double norm = 1.0 / sqrt(l * (l + 1.0));
+        for (m = 1; m <= l; ++m)
+        {
+            k = NUM_COEFFS * (l * n + m);
+            c[k] = (l == m) ? sqrt((2.0 * m + 1.0) / (2.0 * m)) :
+                    sqrt((4.0 * l * l - 1.0) / ((double)l * l - m * m));
+            c[k + 1] = (l == m) ? 0.0 :
+                    sqrt(((l - 1.0) * (l - 1.0) - m * m) /
+                            (4.0 * (l - 1.0) * (l - 1.0) - 1.0));
+            c[k + 2] = l * norm;
+            c[k + 3] = sqrt((2.0 * l + 1.0) * ((double)l * l - m * m) /
+                    (2.0 * l - 1.0)) * norm;
+            c[k + 4] = m * norm;
+        }
+    }
+    return c;
+}
+
+/* Single precision. */
+void oskar_evaluate_spherical_wave_sum_f(int num_points, const float* theta,
+        const float* phi, int l_max, const float2* alpha, int stride,
+        float2* E_theta, float2* E_phi, int* status)
+{
+    int i;
+    const int n = l_max + 1;
+    double* c;
+
+    /* Get the recurrence coefficients. */
+    if (*status) return;
+    c = recurrence_coeffs(l_max);
+    if (!c)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+
+    #pragma omp parallel for private(i)
+    for (i = 0; i < num_points; ++i)
+    {
+        int l, m, j, i_out;
+        double sin_t, cos_t, p_mm, q0, q1, q2, mq, dp, t;
+        double2 A, B, e_1, e_m, e_c;
+        A.x = A.y = B.x = B.y = 0.0;
+        sin_t = sin((double)theta[i]);
+        cos_t = cos((double)theta[i]);
+        e_1.x = cos((double)phi[i]);
+        e_1.y = sin((double)phi[i]);
+        e_m = e_1;
+        p_mm = 1.0 / sqrt(4.0 * M_PI);
+        for (m = 1; m <= l_max; ++m)
+        {
+            e_c.x = e_m.x;
+            e_c.y = -e_m.y;
+            q0 = 0.0;
+            q1 = c[NUM_COEFFS * (m * n + m)] * p_mm;
+            p_mm = q1 * sin_t;
+            for (l = m; l <= l_max; ++l)
+            {
+                const double* c_lm = &c[NUM_COEFFS * (l * n + m)];
+                if (l > m)
+                {
+                    q2 = c_lm[0] * (cos_t * q1 - c_lm[1] * q0);
+                    q0 = q1;
+                    q1 = q2;
+                }
+                dp = c_lm[2] * cos_t * q1 - c_lm[3] * q0;
+                mq = c_lm[4] * q1;
+                j = 2 * (l * l - 1 + l);
+                OSKAR_SPHERICAL_WAVE_MODE(m, mq, dp, e_m, j)
+                OSKAR_SPHERICAL_WAVE_MODE(-m, -mq, dp, e_c, j)
+                if (m == 1)
+                {
+                    /* Use P_l^1 to get the derivative of P_l^0. */
+                    const double2 e_0 = {1.0, 0.0};
+                    dp = -sin_t * q1;
+                    OSKAR_SPHERICAL_WAVE_MODE(0, 0.0, dp, e_0, j)
+                }
+            }
+
+            /* Get the next azimuthal term. */
+            t = e_m.x * e_1.x - e_m.y * e_1.y;
+            e_m.y = e_m.x * e_1.y + e_m.y * e_1.x;
+            e_m.x = t;
+        }
+        i_out = i * stride;
+        E_theta[i_out].x = (float) A.x;
+        E_theta[i_out].y = (float) A.y;
+        E_phi[i_out].x = (float) B.x;
+        E_phi[i_out].y = (float) B.y;
+    }
+    free(c);
+}
+
+/* Double precision. */
+void oskar_evaluate_spherical_wave_sum_d(int num_points, const double* theta,
+        const double* phi, int l_max, const double2* alpha, int stride,
+        double2* E_theta, double2* E_phi, int* status)
+{
+    int i;
+    const int n = l_max + 1;
+    double* c;
+
+    /* Get the recurrence coefficients. */
+    if (*status) return;
+    c = recurrence_coeffs(l_max);
+    if (!c)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+
+    #pragma omp parallel for private(i)
+    for (i = 0; i < num_points; ++i)
+    {
+        int l, m, j, i_out;
+        double sin_t, cos_t, p_mm, q0, q1, q2, mq, dp, t;
+        double2 A, B, e_1, e_m, e_c;
+        A.x = A.y = B.x = B.y = 0.0;
+        sin_t = sin(theta[i]);
+        cos_t = cos(theta[i]);
+        e_1.x = cos(phi[i]);
+        e_1.y = sin(phi[i]);
+        e_m = e_1;
+        p_mm = 1.0 / sqrt(4.0 * M_PI);
+        for (m = 1; m <= l_max; ++m)
+        {
+            e_c.x = e_m.x;
+            e_c.y = -e_m.y;
+            q0 = 0.0;
+            q1 = c[NUM_COEFFS * (m * n + m)] * p_mm;
+            p_mm = q1 * sin_t;
+            for (l = m; l <= l_max; ++l)
+            {
+                const double* c_lm = &c[NUM_COEFFS * (l * n + m)];
+                if (l > m)
+                {
+                    q2 = c_lm[0] * (cos_t * q1 - c_lm[1] * q0);
+                    q0 = q1;
+                    q1 = q2;
+                }
+                dp = c_lm[2] * cos_t * q1 - c_lm[3] * q0;
+                mq = c_lm[4] * q1;
+                j = 2 * (l * l - 1 + l);
+                OSKAR_SPHERICAL_WAVE_MODE(m, mq, dp, e_m, j)
+                OSKAR_SPHERICAL_WAVE_MODE(-m, -mq, dp, e_c, j)
+                if (m == 1)
+                {
+                    /* Use P_l^1 to get the derivative of P_l^0. */
+                    const double2 e_0 = {1.0, 0.0};
+                    dp = -sin_t * q1;
+                    OSKAR_SPHERICAL_WAVE_MODE(0, 0.0, dp, e_0, j)
+                }
+            }
+
+            /* Get the next azimuthal term. */
+            t = e_m.x * e_1.x - e_m.y * e_1.y;
+            e_m.y = e_m.x * e_1.y + e_m.y * e_1.x;
+            e_m.x = t;
+        }
+        i_out = i * stride;
+        E_theta[i_out] = A;
+        E_phi[i_out] = B;
+    }
+    free(c);
+}
+
+/* Wrapper. */
+void oskar_evaluate_spherical_wave_sum(oskar_Mem* pattern, int num_points,
+        const oskar_Mem* theta, const oskar_Mem* phi, const oskar_Mem* alpha,
+        int offset, int stride, int* status)
+{
+    int precision, type, location, l_max;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Get the meta-data. */
+    precision = oskar_mem_precision(pattern);
+    type = oskar_mem_type(pattern);
+    location = oskar_mem_location(pattern);
+
+    /* Check that all arrays are co-located. */
+    if (oskar_mem_location(theta) != location ||
+            oskar_mem_location(phi) != location ||
+            oskar_mem_location(alpha) != location)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+
+    /* Check that the pattern array is a complex matrix. */
+    if (!oskar_mem_is_complex(pattern) || !oskar_mem_is_matrix(pattern))
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+
+    /* Check that the types match. */
+    if (oskar_mem_type(theta) != precision ||
+            oskar_mem_type(phi) != precision ||
+            oskar_mem_type(alpha) != (precision | OSKAR_COMPLEX))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+
+    /* Get the maximum degree from the number of (TE, TM) pairs. */
+    l_max = (int) floor(sqrt(oskar_mem_length(alpha) / 2 + 1.0) + 0.5) - 1;
+    if (l_max < 1 || 2 * l_max * (l_max + 2) != (int) oskar_mem_length(alpha))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Check the location. */
+    if (location == OSKAR_CPU)
+    {
+        if (type == OSKAR_SINGLE_COMPLEX_MATRIX)
+        {
+            oskar_evaluate_spherical_wave_sum_f(num_points,
+                    oskar_mem_float_const(theta, status),
+                    oskar_mem_float_const(phi, status), l_max,
+                    oskar_mem_float2_const(alpha, status), stride,
+                    oskar_mem_float2(pattern, status) + offset,
+                    oskar_mem_float2(pattern, status) + offset + 1, status);
+        }
+        else if (type == OSKAR_DOUBLE_COMPLEX_MATRIX)
+        {
+            oskar_evaluate_spherical_wave_sum_d(num_points,
+                    oskar_mem_double_const(theta, status),
+                    oskar_mem_double_const(phi, status), l_max,
+                    oskar_mem_double2_const(alpha, status), stride,
+                    oskar_mem_double2(pattern, status) + offset,
+                    oskar_mem_double2(pattern, status) + offset + 1, status);
+        }
+    }
+    else
+    {
+        /* Only a CPU version is currently available. */
+        *status = OSKAR_ERR_BAD_LOCATION;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -60,6 +60,7 @@ enum OSKAR_STATION_TYPE
 #include <telescope/station/element/oskar_element.h>
 #include <telescope/station/oskar_station_accessors.h>
 #include <telescope/station/oskar_station_analyse.h>
+#include <telescope/station/oskar_station_apply_transform.h>
 #include <telescope/station/oskar_station_create_child_stations.h>
 #include <telescope/station/oskar_station_create_copy.h>
 #include <telescope/station/oskar_station_create.h>
@@ -73,6 +74,7 @@ enum OSKAR_STATION_TYPE
 #include <telescope/station/oskar_station_load_layout.h>
 #include <telescope/station/oskar_station_load_mount_types.h>
 #include <telescope/station/oskar_station_load_permitted_beams.h>
+#include <telescope/station/oskar_station_memory_bytes.h>
 #include <telescope/station/oskar_station_override_element_feed_angle.h>
 #include <telescope/station/oskar_station_override_element_gains.h>
 #include <telescope/station/oskar_station_override_element_phases.h>
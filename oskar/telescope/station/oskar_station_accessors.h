@@ -106,6 +106,9 @@ double oskar_station_polar_motion_x_rad(const oskar_Station* model);
 OSKAR_EXPORT
 double oskar_station_polar_motion_y_rad(const oskar_Station* model);
 
+OSKAR_EXPORT
+double oskar_station_rotation_rad(const oskar_Station* model);
+
 OSKAR_EXPORT
 double oskar_station_beam_lon_rad(const oskar_Station* model);
 
@@ -152,6 +155,9 @@ int oskar_station_normalise_array_pattern(const oskar_Station* model);
 OSKAR_EXPORT
 int oskar_station_enable_array_pattern(const oskar_Station* model);
 
+OSKAR_EXPORT
+double oskar_station_array_pattern_nufft_tolerance(const oskar_Station* model);
+
 OSKAR_EXPORT
 int oskar_station_common_element_orientation(const oskar_Station* model);
 
@@ -171,6 +177,11 @@ OSKAR_EXPORT
 double oskar_station_element_x_alpha_rad(const oskar_Station* model,
         int index);
 
+/* Returns the X dipole angle to pass to oskar_element_evaluate(). */
+OSKAR_EXPORT
+double oskar_station_element_x_alpha_eval_rad(const oskar_Station* model,
+        int index);
+
 OSKAR_EXPORT
 double oskar_station_element_x_beta_rad(const oskar_Station* model,
         int index);
@@ -388,6 +399,23 @@ OSKAR_EXPORT
 void oskar_station_set_polar_motion(oskar_Station* model,
         double pm_x_rad, double pm_y_rad);
 
+/**
+ * @brief
+ * Sets the rotation of the station about the zenith.
+ *
+ * @details
+ * Records that the element coordinates of the station are those of an
+ * unrotated template, and that the physical station is rotated
+ * by the given angle (East towards North) about the local vertical.
+ * Beam evaluation then rotates the direction cosines by the opposite angle,
+ * so that stations that differ only by rotation can share the same layout.
+ *
+ * @param[in] model      Pointer to station model.
+ * @param[in] value      Rotation angle, in radians.
+ */
+OSKAR_EXPORT
+void oskar_station_set_rotation_rad(oskar_Station* model, double value);
+
 /**
  * @brief
  * Sets the coordinates of the phase centre.
@@ -450,6 +478,25 @@ void oskar_station_set_normalise_array_pattern(oskar_Station* model, int value);
 OSKAR_EXPORT
 void oskar_station_set_enable_array_pattern(oskar_Station* model, int value);
 
+/**
+ * @brief
+ * Sets the accuracy of array patterns evaluated using a non-uniform FFT.
+ *
+ * @details
+ * If greater than zero, the array pattern of a station with a single
+ * element type and a common element orientation is evaluated using a
+ * type-3 non-uniform FFT, with the given relative accuracy, wherever
+ * that is expected to be faster than the direct sum (default 0, disabled).
+ *
+ * This is only used for data in CPU memory.
+ *
+ * @param[in] model  Pointer to station model.
+ * @param[in] value  Required relative accuracy, or 0 to disable.
+ */
+OSKAR_EXPORT
+void oskar_station_set_array_pattern_nufft_tolerance(oskar_Station* model,
+        double value);
+
 /**
  * @brief
  * Sets the seed used to generate time-variable errors.
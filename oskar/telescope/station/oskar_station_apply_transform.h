@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_STATION_APPLY_TRANSFORM_H_
+#define OSKAR_STATION_APPLY_TRANSFORM_H_
+
+/**
+ * @file oskar_station_apply_transform.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Applies a rotation, scale, offset and random jitter to a station layout.
+ *
+ * @details
+ * This function is used to derive a station from a template station.
+ *
+ * The rotation is not applied to the element coordinates: it is only
+ * recorded in the station model, so that the beam of the unrotated
+ * template can be evaluated using rotated direction cosines.
+ * Stations derived from the same template with the same rotation therefore
+ * remain identical, unless they are perturbed.
+ *
+ * The top-level element coordinates (both "true" and "measured") are
+ * first multiplied by the scale factor, then translated by the given
+ * offset, and finally perturbed in the horizontal plane by random
+ * Gaussian jitter with the given standard deviation.
+ * The offset is specified in the East and North directions, and is rotated
+ * into the (unrotated) frame of the station layout.
+ * The jitter is generated using the seed, with the element index and the
+ * supplied counter as the random generator counters.
+ *
+ * The station model must be in CPU-accessible memory.
+ *
+ * @param[in,out] s            Station model structure to modify.
+ * @param[in] rotation_rad     Station rotation (East towards North), in radians.
+ * @param[in] scale            Scale factor for element coordinates.
+ * @param[in] offset_east_m    Offset of elements towards East, in metres.
+ * @param[in] offset_north_m   Offset of elements towards North, in metres.
+ * @param[in] jitter_m         Standard deviation of random jitter, in metres.
+ * @param[in] seed             Random generator seed.
+ * @param[in] counter          Random generator counter (e.g. station index).
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_station_apply_transform(oskar_Station* s, double rotation_rad,
+        double scale, double offset_east_m, double offset_north_m,
+        double jitter_m, unsigned int seed, unsigned int counter,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_STATION_APPLY_TRANSFORM_H_ */
@@ -100,6 +100,62 @@ OSKAR_EXPORT
 oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
         const oskar_Mem* output_beam, size_t length, int depth, int* status);
 
+OSKAR_EXPORT
+oskar_Mem* oskar_station_work_element_cache(oskar_StationWork* work,
+        const oskar_Mem* output_beam, size_t length, int* status);
+
+/**
+ * @brief Enables or disables sharing of element patterns between stations.
+ *
+ * @details
+ * When enabled, the element pattern evaluated for a station with a
+ * single element type and a common element orientation is kept in the
+ * work buffer, and is copied (rather than evaluated again) for subsequent
+ * stations that use the same element model, element orientation,
+ * station rotation and beam direction.
+ *
+ * Sharing must only be enabled while the source directions, time and
+ * frequency remain unchanged, i.e. while evaluating the beams of all
+ * stations for a single time and channel. Calling this function always
+ * discards any previously cached pattern.
+ *
+ * If \p common_frame is set, stations are assumed to share a common
+ * horizon frame, as for a compact array, so element patterns are also
+ * shared between stations at different locations. Otherwise, the station
+ * longitude and latitude must also match.
+ *
+ * @param[in,out] work         Pointer to work buffer structure.
+ * @param[in]     enable       If true, enable sharing of element patterns.
+ * @param[in]     common_frame If true, ignore differences in station location.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_element_pattern_sharing(oskar_StationWork* work,
+        int enable, int common_frame);
+
+/**
+ * @brief Enables or disables sharing of element patterns between beams.
+ *
+ * @details
+ * When enabled, element patterns are shared between stations as described
+ * for oskar_station_work_set_element_pattern_sharing(), and are also kept
+ * between evaluations made for different beam directions. This is used
+ * when simulating several phase centres at once: the source direction
+ * cosines are then only re-expressed relative to each beam, so the
+ * directions in the horizon frame are unchanged.
+ *
+ * Sharing between beams must only be enabled while the sources, time and
+ * frequency remain unchanged. While it is enabled, calls to
+ * oskar_station_work_set_element_pattern_sharing() have no effect.
+ * Calling this function always discards any previously cached pattern.
+ *
+ * @param[in,out] work         Pointer to work buffer structure.
+ * @param[in]     enable       If true, enable sharing of element patterns.
+ * @param[in]     common_frame If true, ignore differences in station location.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_element_pattern_sharing_between_beams(
+        oskar_StationWork* work, int enable, int common_frame);
+
 #ifdef __cplusplus
 }
 #endif
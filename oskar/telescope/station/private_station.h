@@ -55,6 +55,7 @@ struct oskar_Station
     double alt_metres;            /* Altitude of station above ellipsoid, in metres. */
     double pm_x_rad;              /* Polar motion (x-component) in radians. */
     double pm_y_rad;              /* Polar motion (y-component) in radians. */
+    double rotation_rad;          /* Rotation of the station about the zenith (East towards North), in radians. */
     double beam_lon_rad;          /* Longitude of beam phase centre, in radians. */
     double beam_lat_rad;          /* Latitude of beam phase centre, in radians. */
     int beam_coord_type;          /* Enumerator describing beam spherical coordinate type (from oskar_global.h). */
@@ -71,6 +72,7 @@ struct oskar_Station
     int num_element_types;        /* Number of element types (this is the size of element_pattern array). */
     int normalise_array_pattern;  /* True if the station beam should be normalised by the number of antennas. */
     int enable_array_pattern;     /* True if the array factor should be evaluated. */
+    double array_pattern_nufft_tolerance; /* Accuracy of array factor if using a non-uniform FFT (0 to disable). */
     int common_element_orientation; /* True if elements share a common orientation (auto determined). */
     int array_is_3d;              /* True if array is 3-dimensional (auto determined; default false). */
     int apply_element_errors;     /* True if element gain and phase errors should be applied (auto determined; default false). */
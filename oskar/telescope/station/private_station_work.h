@@ -30,6 +30,7 @@
 #define OSKAR_PRIVATE_STATION_WORK_H_
 
 #include <mem/oskar_mem.h>
+#include <telescope/station/element/oskar_element.h>
 
 struct oskar_StationWork
 {
@@ -39,6 +40,9 @@ struct oskar_StationWork
     oskar_Mem* enu_direction_x;  /* Real scalar. ENU direction cosine. */
     oskar_Mem* enu_direction_y;  /* Real scalar. ENU direction cosine. */
     oskar_Mem* enu_direction_z;  /* Real scalar. ENU direction cosine. */
+    oskar_Mem* rotated_x;        /* Real scalar. Direction cosine in station frame. */
+    oskar_Mem* rotated_y;        /* Real scalar. Direction cosine in station frame. */
+    oskar_Mem* rotated_temp;     /* Real scalar. */
 
     oskar_Mem* theta_modified;   /* Real scalar. */
     oskar_Mem* phi_modified;     /* Real scalar. */
@@ -49,6 +53,21 @@ struct oskar_StationWork
 
     int num_depths;
     oskar_Mem** beam;            /* For hierarchical stations. */
+
+    /* Element pattern shared between stations. */
+    int element_cache_enabled;   /* True if sharing is enabled. */
+    int element_cache_common_frame; /* True to ignore station location. */
+    int element_cache_all_beams; /* True to ignore beam direction. */
+    int element_cache_valid;     /* True if the cached pattern is valid. */
+    oskar_Mem* element_cache;    /* Cached element pattern. */
+    const oskar_Element* element_cache_model; /* Element model used. */
+    const void* element_cache_dir; /* Direction cosine array used. */
+    int element_cache_num_points;
+    double element_cache_x_alpha_rad, element_cache_y_alpha_rad;
+    double element_cache_frequency_hz, element_cache_gast;
+    double element_cache_rotation_rad;
+    double element_cache_lon_rad, element_cache_lat_rad;
+    double element_cache_beam_lon_rad, element_cache_beam_lat_rad;
 };
 
 #ifndef OSKAR_STATION_WORK_TYPEDEF_
@@ -36,6 +36,7 @@
 
 #include "math/oskar_cmath.h"
 #include "math/oskar_dftw.h"
+#include "math/oskar_dftw_nufft.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -48,7 +49,21 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
         const oskar_Station* s, int num_points, const oskar_Mem* x,
         const oskar_Mem* y, const oskar_Mem* z, double gast,
         double frequency_hz, oskar_StationWork* work, int time_index,
-        int depth, int* status);
+        int depth, double rotation_rad, int* status);
+
+static void rotate_directions(int num_points, const oskar_Mem* x,
+        const oskar_Mem* y, double angle_rad, oskar_StationWork* work,
+        int* status);
+
+static void evaluate_common_element(oskar_Mem* beam, const oskar_Station* s,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        const oskar_Mem* z, double gast, double frequency_hz,
+        oskar_StationWork* work, double rotation_rad, int* status);
+
+static void evaluate_array_pattern(oskar_Mem* array, const oskar_Station* s,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        const oskar_Mem* z, double wavenumber, const oskar_Mem* weights,
+        int* status);
 
 
 void oskar_evaluate_station_beam_aperture_array(oskar_Mem* beam,
@@ -58,17 +73,28 @@ void oskar_evaluate_station_beam_aperture_array(oskar_Mem* beam,
         int* status)
 {
     int start;
+    double rotation_rad;
 
     /* Check if safe to proceed. */
     if (*status) return;
 
+    /* If the station is a rotated copy of a template, evaluate the
+     * template beam using direction cosines in the frame of the station. */
+    rotation_rad = oskar_station_rotation_rad(station);
+    if (rotation_rad != 0.0)
+    {
+        rotate_directions(num_points, x, y, -rotation_rad, work, status);
+        x = work->rotated_x;
+        y = work->rotated_y;
+    }
+
     /* Evaluate beam immediately, without chunking, if there are no
      * child stations. */
     if (!oskar_station_has_child(station))
     {
         oskar_evaluate_station_beam_aperture_array_private(beam, station,
                 num_points, x, y, z, gast, frequency_hz, work,
-                time_index, 0, status);
+                time_index, 0, rotation_rad, status);
     }
     else
     {
@@ -96,7 +122,7 @@ void oskar_evaluate_station_beam_aperture_array(oskar_Mem* beam,
             /* Start recursive call at depth 1 (depth 0 is element level). */
             oskar_evaluate_station_beam_aperture_array_private(c_beam, station,
                     chunk_size, c_x, c_y, c_z, gast, frequency_hz, work,
-                    time_index, 1, status);
+                    time_index, 1, rotation_rad, status);
         }
 
         /* Release handles for chunk memory. */
@@ -111,7 +137,7 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
         const oskar_Station* s, int num_points, const oskar_Mem* x,
         const oskar_Mem* y, const oskar_Mem* z, double gast,
         double frequency_hz, oskar_StationWork* work, int time_index,
-        int depth, int* status)
+        int depth, double rotation_rad, int* status)
 {
     double beam_x, beam_y, beam_z, wavenumber;
     oskar_Mem *weights, *weights_error, *theta, *phi, *array;
@@ -132,6 +158,13 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
     /* Compute direction cosines for the beam for this station. */
     oskar_evaluate_beam_horizon_direction(&beam_x, &beam_y, &beam_z, s,
             gast, status);
+    if (rotation_rad != 0.0)
+    {
+        const double c = cos(rotation_rad), t = sin(rotation_rad);
+        const double bx = beam_x, by = beam_y;
+        beam_x = bx * c + by * t;
+        beam_y = -bx * t + by * c;
+    }
 
     /* Evaluate beam if there are no child stations. */
     if (!oskar_station_has_child(s))
@@ -146,10 +179,8 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
                         == OSKAR_ELEMENT_TYPE_ISOTROPIC) )
         {
             /* (Always) evaluate element pattern into the output beam array. */
-            oskar_element_evaluate(oskar_station_element_const(s, 0), beam,
-                    oskar_station_element_x_alpha_rad(s, 0) + M_PI/2.0, /* FIXME Will change: This matches the old convention. */
-                    oskar_station_element_y_alpha_rad(s, 0),
-                    num_points, x, y, z, frequency_hz, theta, phi, status);
+            evaluate_common_element(beam, s, num_points, x, y, z, gast,
+                    frequency_hz, work, rotation_rad, status);
 
             /* Check if array pattern is enabled. */
             if (oskar_station_enable_array_pattern(s))
@@ -158,12 +189,8 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
                 oskar_evaluate_element_weights(weights, weights_error,
                         wavenumber, s, beam_x, beam_y, beam_z,
                         time_index, status);
-                oskar_dftw(num_elements, wavenumber,
-                        oskar_station_element_true_x_enu_metres_const(s),
-                        oskar_station_element_true_y_enu_metres_const(s),
-                        oskar_station_element_true_z_enu_metres_const(s),
-                        weights, num_points, x, y, (is_3d ? z : 0), 0, array,
-                        status);
+                evaluate_array_pattern(array, s, num_points, x, y, z,
+                        wavenumber, weights, status);
 
                 /* Normalise array response if required. */
                 if (oskar_station_normalise_array_pattern(s))
@@ -231,7 +258,7 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
                 oskar_element_evaluate(
                         oskar_station_element_const(s, element_type_idx),
                         element,
-                        oskar_station_element_x_alpha_rad(s, i) + M_PI/2.0, /* FIXME Will change: This matches the old convention. */
+                        oskar_station_element_x_alpha_eval_rad(s, i),
                         oskar_station_element_y_alpha_rad(s, i),
                         num_points, x, y, z, frequency_hz, theta, phi, status);
             }
@@ -289,7 +316,7 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
             oskar_evaluate_station_beam_aperture_array_private(output0,
                     oskar_station_child_const(s, 0), num_points,
                     x, y, z, gast, frequency_hz, work, time_index,
-                    depth + 1, status);
+                    depth + 1, rotation_rad, status);
 
             /* Copy beam for child station 0 into memory for other stations. */
             for (i = 1; i < num_elements; ++i)
@@ -313,7 +340,7 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
                 oskar_evaluate_station_beam_aperture_array_private(output,
                         oskar_station_child_const(s, i), num_points,
                         x, y, z, gast, frequency_hz, work, time_index,
-                        depth + 1, status);
+                        depth + 1, rotation_rad, status);
                 oskar_mem_free(output, status);
             }
         }
@@ -334,6 +361,154 @@ static void oskar_evaluate_station_beam_aperture_array_private(oskar_Mem* beam,
     }
 }
 
+/* Evaluates the element pattern common to all elements in the station,
+ * or copies it from the work buffer if it was already evaluated for another
+ * station with the same element model, orientation and directions. */
+static void evaluate_common_element(oskar_Mem* beam, const oskar_Station* s,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        const oskar_Mem* z, double gast, double frequency_hz,
+        oskar_StationWork* work, double rotation_rad, int* status)
+{
+    double x_alpha, y_alpha, lon, lat, beam_lon, beam_lat;
+    const oskar_Element* element;
+    oskar_Mem* cache;
+    if (*status) return;
+    element = oskar_station_element_const(s, 0);
+    x_alpha = oskar_station_element_x_alpha_eval_rad(s, 0);
+    y_alpha = oskar_station_element_y_alpha_rad(s, 0);
+    if (!work->element_cache_enabled)
+    {
+        oskar_element_evaluate(element, beam, x_alpha, y_alpha,
+                num_points, x, y, z, frequency_hz,
+                work->theta_modified, work->phi_modified, status);
+        return;
+    }
+
+    /* Check if the cached pattern can be used. */
+    lon = work->element_cache_common_frame ? 0.0 : oskar_station_lon_rad(s);
+    lat = work->element_cache_common_frame ? 0.0 : oskar_station_lat_rad(s);
+    beam_lon = oskar_station_beam_lon_rad(s);
+    beam_lat = oskar_station_beam_lat_rad(s);
+    cache = work->element_cache;
+    if (work->element_cache_valid &&
+            oskar_mem_type(cache) == oskar_mem_type(beam) &&
+            work->element_cache_num_points == num_points &&
+            work->element_cache_dir == oskar_mem_void_const(x) &&
+            work->element_cache_x_alpha_rad == x_alpha &&
+            work->element_cache_y_alpha_rad == y_alpha &&
+            work->element_cache_frequency_hz == frequency_hz &&
+            work->element_cache_gast == gast &&
+            work->element_cache_rotation_rad == rotation_rad &&
+            work->element_cache_lon_rad == lon &&
+            work->element_cache_lat_rad == lat &&
+            (work->element_cache_all_beams ||
+                    (work->element_cache_beam_lon_rad == beam_lon &&
+                    work->element_cache_beam_lat_rad == beam_lat)) &&
+            (work->element_cache_model == element ||
+                    !oskar_element_different(work->element_cache_model,
+                            element, status)))
+    {
+        /* If shared between beams, the last point may be the beam
+         * direction, used for normalisation, so update it for a new beam. */
+        if (num_points > 0 && (work->element_cache_beam_lon_rad != beam_lon ||
+                work->element_cache_beam_lat_rad != beam_lat))
+        {
+            oskar_Mem *c, *x1, *y1, *z1;
+            const int i = num_points - 1;
+            c = oskar_mem_create_alias(cache, i, 1, status);
+            x1 = oskar_mem_create_alias(x, i, 1, status);
+            y1 = oskar_mem_create_alias(y, i, 1, status);
+            z1 = oskar_mem_create_alias(z, i, 1, status);
+            oskar_element_evaluate(element, c, x_alpha, y_alpha, 1,
+                    x1, y1, z1, frequency_hz,
+                    work->theta_modified, work->phi_modified, status);
+            oskar_mem_free(c, status);
+            oskar_mem_free(x1, status);
+            oskar_mem_free(y1, status);
+            oskar_mem_free(z1, status);
+            work->element_cache_beam_lon_rad = beam_lon;
+            work->element_cache_beam_lat_rad = beam_lat;
+        }
+        oskar_mem_copy_contents(beam, cache, 0, 0, num_points, status);
+        return;
+    }
+
+    /* Evaluate the element pattern and store it for the next station. */
+    oskar_element_evaluate(element, beam, x_alpha, y_alpha,
+            num_points, x, y, z, frequency_hz,
+            work->theta_modified, work->phi_modified, status);
+    cache = oskar_station_work_element_cache(work, beam, num_points, status);
+    oskar_mem_copy_contents(cache, beam, 0, 0, num_points, status);
+    if (*status) return;
+    work->element_cache_valid = 1;
+    work->element_cache_model = element;
+    work->element_cache_dir = oskar_mem_void_const(x);
+    work->element_cache_num_points = num_points;
+    work->element_cache_x_alpha_rad = x_alpha;
+    work->element_cache_y_alpha_rad = y_alpha;
+    work->element_cache_frequency_hz = frequency_hz;
+    work->element_cache_gast = gast;
+    work->element_cache_rotation_rad = rotation_rad;
+    work->element_cache_lon_rad = lon;
+    work->element_cache_lat_rad = lat;
+    work->element_cache_beam_lon_rad = beam_lon;
+    work->element_cache_beam_lat_rad = beam_lat;
+}
+
+/* Evaluates the array pattern for a separable station beam, using either
+ * a DFT or, where expected to be faster, a non-uniform FFT. */
+static void evaluate_array_pattern(oskar_Mem* array, const oskar_Station* s,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        const oskar_Mem* z, double wavenumber, const oskar_Mem* weights,
+        int* status)
+{
+    int num_elements;
+    double tolerance;
+    const oskar_Mem *x_in, *y_in, *z_in;
+    if (*status) return;
+    num_elements = oskar_station_num_elements(s);
+    tolerance = oskar_station_array_pattern_nufft_tolerance(s);
+    x_in = oskar_station_element_true_x_enu_metres_const(s);
+    y_in = oskar_station_element_true_y_enu_metres_const(s);
+    z_in = oskar_station_element_true_z_enu_metres_const(s);
+    if (!oskar_station_array_is_3d(s)) z = 0;
+    if (tolerance > 0.0 && oskar_mem_location(array) == OSKAR_CPU &&
+            oskar_dftw_nufft_cost(num_elements, wavenumber, x_in, y_in, z_in,
+                    num_points, x, y, z, tolerance, status) < 1.0)
+        oskar_dftw_nufft(num_elements, wavenumber, x_in, y_in, z_in, weights,
+                num_points, x, y, z, tolerance, array, status);
+    else
+        oskar_dftw(num_elements, wavenumber, x_in, y_in, z_in, weights,
+                num_points, x, y, z, 0, array, status);
+}
+
+/* Rotates direction cosines (x, y) about the zenith by the given angle. */
+static void rotate_directions(int num_points, const oskar_Mem* x,
+        const oskar_Mem* y, double angle_rad, oskar_StationWork* work,
+        int* status)
+{
+    const double c = cos(angle_rad), t = sin(angle_rad);
+    oskar_mem_realloc(work->rotated_x, num_points, status);
+    oskar_mem_realloc(work->rotated_y, num_points, status);
+    oskar_mem_realloc(work->rotated_temp, num_points, status);
+
+    /* x' = x cos(a) - y sin(a) */
+    oskar_mem_copy_contents(work->rotated_x, x, 0, 0, num_points, status);
+    oskar_mem_scale_real(work->rotated_x, c, status);
+    oskar_mem_copy_contents(work->rotated_temp, y, 0, 0, num_points, status);
+    oskar_mem_scale_real(work->rotated_temp, -t, status);
+    oskar_mem_add(work->rotated_x, work->rotated_x, work->rotated_temp,
+            num_points, status);
+
+    /* y' = x sin(a) + y cos(a) */
+    oskar_mem_copy_contents(work->rotated_y, y, 0, 0, num_points, status);
+    oskar_mem_scale_real(work->rotated_y, c, status);
+    oskar_mem_copy_contents(work->rotated_temp, x, 0, 0, num_points, status);
+    oskar_mem_scale_real(work->rotated_temp, t, status);
+    oskar_mem_add(work->rotated_y, work->rotated_y, work->rotated_temp,
+            num_points, status);
+}
+
 #ifdef __cplusplus
 }
 #endif
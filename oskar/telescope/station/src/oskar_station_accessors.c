@@ -28,6 +28,7 @@
 
 #include "telescope/station/private_station.h"
 #include "telescope/station/oskar_station_accessors.h"
+#include "math/oskar_cmath.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -86,6 +87,11 @@ double oskar_station_polar_motion_y_rad(const oskar_Station* model)
     return model->pm_y_rad;
 }
 
+double oskar_station_rotation_rad(const oskar_Station* model)
+{
+    return model->rotation_rad;
+}
+
 double oskar_station_beam_lon_rad(const oskar_Station* model)
 {
     return model->beam_lon_rad;
@@ -160,6 +166,11 @@ int oskar_station_enable_array_pattern(const oskar_Station* model)
     return model->enable_array_pattern;
 }
 
+double oskar_station_array_pattern_nufft_tolerance(const oskar_Station* model)
+{
+    return model->array_pattern_nufft_tolerance;
+}
+
 int oskar_station_common_element_orientation(const oskar_Station* model)
 {
     return model->common_element_orientation;
@@ -192,6 +203,13 @@ double oskar_station_element_x_alpha_rad(const oskar_Station* model,
             oskar_mem_void_const(model->element_x_alpha_cpu))[index];
 }
 
+double oskar_station_element_x_alpha_eval_rad(const oskar_Station* model,
+        int index)
+{
+    /* FIXME Will change: This matches the old convention. */
+    return oskar_station_element_x_alpha_rad(model, index) + M_PI/2.0;
+}
+
 double oskar_station_element_x_beta_rad(const oskar_Station* model,
         int index)
 {
@@ -465,6 +483,11 @@ void oskar_station_set_polar_motion(oskar_Station* model,
     }
 }
 
+void oskar_station_set_rotation_rad(oskar_Station* model, double value)
+{
+    model->rotation_rad = value;
+}
+
 void oskar_station_set_phase_centre(oskar_Station* model,
         int beam_coord_type, double beam_longitude_rad,
         double beam_latitude_rad)
@@ -491,6 +514,12 @@ void oskar_station_set_enable_array_pattern(oskar_Station* model, int value)
     model->enable_array_pattern = value;
 }
 
+void oskar_station_set_array_pattern_nufft_tolerance(oskar_Station* model,
+        double value)
+{
+    model->array_pattern_nufft_tolerance = value;
+}
+
 void oskar_station_set_seed_time_variable_errors(oskar_Station* model,
         unsigned int value)
 {
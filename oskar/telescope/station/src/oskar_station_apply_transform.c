@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/private_station.h"
+#include "telescope/station/oskar_station.h"
+#include "math/oskar_random_gaussian.h"
+#include "math/oskar_cmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define APPLY_TRANSFORM(FP, X, Y, Z) { \
+        double r[2]; \
+        for (i = 0; i < s->num_elements; ++i) \
+        { \
+            X[i] = (FP) (X[i] * scale + dx); \
+            Y[i] = (FP) (Y[i] * scale + dy); \
+            Z[i] = (FP) (Z[i] * scale); \
+            if (jitter_m > 0.0) \
+            { \
+                oskar_random_gaussian2(seed, i, counter, r); \
+                X[i] += (FP) (r[0] * jitter_m); \
+                Y[i] += (FP) (r[1] * jitter_m); \
+            } \
+        } }
+
+void oskar_station_apply_transform(oskar_Station* s, double rotation_rad,
+        double scale, double offset_east_m, double offset_north_m,
+        double jitter_m, unsigned int seed, unsigned int counter,
+        int* status)
+{
+    int i, type;
+    double c, t, dx, dy;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Check location. */
+    if (oskar_station_mem_location(s) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Record the rotation, and rotate the offset into the station frame. */
+    s->rotation_rad = rotation_rad;
+    c = cos(rotation_rad);
+    t = sin(rotation_rad);
+    dx = offset_east_m * c + offset_north_m * t;
+    dy = -offset_east_m * t + offset_north_m * c;
+
+    /* Transform the "true" and "measured" coordinates in the same way. */
+    type = oskar_station_precision(s);
+    if (type == OSKAR_DOUBLE)
+    {
+        double *x, *y, *z;
+        x = oskar_mem_double(s->element_true_x_enu_metres, status);
+        y = oskar_mem_double(s->element_true_y_enu_metres, status);
+        z = oskar_mem_double(s->element_true_z_enu_metres, status);
+        APPLY_TRANSFORM(double, x, y, z)
+        x = oskar_mem_double(s->element_measured_x_enu_metres, status);
+        y = oskar_mem_double(s->element_measured_y_enu_metres, status);
+        z = oskar_mem_double(s->element_measured_z_enu_metres, status);
+        APPLY_TRANSFORM(double, x, y, z)
+    }
+    else if (type == OSKAR_SINGLE)
+    {
+        float *x, *y, *z;
+        x = oskar_mem_float(s->element_true_x_enu_metres, status);
+        y = oskar_mem_float(s->element_true_y_enu_metres, status);
+        z = oskar_mem_float(s->element_true_z_enu_metres, status);
+        APPLY_TRANSFORM(float, x, y, z)
+        x = oskar_mem_float(s->element_measured_x_enu_metres, status);
+        y = oskar_mem_float(s->element_measured_y_enu_metres, status);
+        z = oskar_mem_float(s->element_measured_z_enu_metres, status);
+        APPLY_TRANSFORM(float, x, y, z)
+    }
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -114,6 +114,7 @@ oskar_Station* oskar_station_create(int type, int location, int num_elements,
     model->alt_metres = 0.0;
     model->pm_x_rad = 0.0;
     model->pm_y_rad = 0.0;
+    model->rotation_rad = 0.0;
     model->beam_lon_rad = 0.0;
     model->beam_lat_rad = 0.0;
     model->beam_coord_type = OSKAR_SPHERICAL_TYPE_EQUATORIAL;
@@ -130,6 +131,7 @@ oskar_Station* oskar_station_create(int type, int location, int num_elements,
     model->num_element_types = 0;
     model->normalise_array_pattern = OSKAR_FALSE;
     model->enable_array_pattern = OSKAR_TRUE;
+    model->array_pattern_nufft_tolerance = 0.0;
     model->common_element_orientation = OSKAR_TRUE;
     model->array_is_3d = OSKAR_FALSE;
     model->apply_element_errors = OSKAR_FALSE;
@@ -65,6 +65,7 @@ oskar_Station* oskar_station_create_copy(const oskar_Station* src,
     model->alt_metres = src->alt_metres;
     model->pm_x_rad = src->pm_x_rad;
     model->pm_y_rad = src->pm_y_rad;
+    model->rotation_rad = src->rotation_rad;
     model->beam_lon_rad = src->beam_lon_rad;
     model->beam_lat_rad = src->beam_lat_rad;
     model->beam_coord_type = src->beam_coord_type;
@@ -76,6 +77,7 @@ oskar_Station* oskar_station_create_copy(const oskar_Station* src,
     model->num_elements = src->num_elements;
     model->normalise_array_pattern = src->normalise_array_pattern;
     model->enable_array_pattern = src->enable_array_pattern;
+    model->array_pattern_nufft_tolerance = src->array_pattern_nufft_tolerance;
     model->common_element_orientation = src->common_element_orientation;
     model->array_is_3d = src->array_is_3d;
     model->apply_element_errors = src->apply_element_errors;
@@ -54,11 +54,14 @@ int oskar_station_different(const oskar_Station* a, const oskar_Station* b,
             a->beam_lat_rad != b->beam_lat_rad ||
             a->pm_x_rad != b->pm_x_rad ||
             a->pm_y_rad != b->pm_y_rad ||
+            a->rotation_rad != b->rotation_rad ||
             a->identical_children != b->identical_children ||
             a->num_elements != b->num_elements ||
             a->num_element_types != b->num_element_types ||
             a->normalise_array_pattern != b->normalise_array_pattern ||
             a->enable_array_pattern != b->enable_array_pattern ||
+            a->array_pattern_nufft_tolerance !=
+                    b->array_pattern_nufft_tolerance ||
             a->common_element_orientation != b->common_element_orientation ||
             a->array_is_3d != b->array_is_3d ||
             a->apply_element_errors != b->apply_element_errors ||
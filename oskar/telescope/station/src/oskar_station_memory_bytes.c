@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/private_station.h"
+#include "telescope/station/oskar_station.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static size_t mem_bytes(const oskar_Mem* mem)
+{
+    if (!mem) return 0;
+    return oskar_mem_length(mem) * oskar_mem_element_size(oskar_mem_type(mem));
+}
+
+static size_t splines_bytes(const oskar_Splines* splines)
+{
+    if (!splines) return 0;
+    return mem_bytes(oskar_splines_knots_x_theta_const(splines)) +
+            mem_bytes(oskar_splines_knots_y_phi_const(splines)) +
+            mem_bytes(oskar_splines_coeff_const(splines));
+}
+
+static size_t element_bytes(const oskar_Element* e)
+{
+    int i, num_freq;
+    size_t bytes = 0;
+    if (!e) return 0;
+    num_freq = oskar_element_num_freq(e);
+    for (i = 0; i < num_freq; ++i)
+    {
+        bytes += splines_bytes(oskar_element_x_h_re_const(e, i));
+        bytes += splines_bytes(oskar_element_x_h_im_const(e, i));
+        bytes += splines_bytes(oskar_element_x_v_re_const(e, i));
+        bytes += splines_bytes(oskar_element_x_v_im_const(e, i));
+        bytes += splines_bytes(oskar_element_y_h_re_const(e, i));
+        bytes += splines_bytes(oskar_element_y_h_im_const(e, i));
+        bytes += splines_bytes(oskar_element_y_v_re_const(e, i));
+        bytes += splines_bytes(oskar_element_y_v_im_const(e, i));
+        bytes += splines_bytes(oskar_element_scalar_re_const(e, i));
+        bytes += splines_bytes(oskar_element_scalar_im_const(e, i));
+        bytes += mem_bytes(oskar_element_x_spherical_wave_const(e, i));
+        bytes += mem_bytes(oskar_element_y_spherical_wave_const(e, i));
+    }
+    return bytes;
+}
+
+size_t oskar_station_memory_bytes(const oskar_Station* station)
+{
+    int i;
+    size_t bytes = 0;
+    if (!station) return 0;
+
+    /* Element data. */
+    bytes += mem_bytes(station->noise_freq_hz);
+    bytes += mem_bytes(station->noise_rms_jy);
+    bytes += mem_bytes(station->element_true_x_enu_metres);
+    bytes += mem_bytes(station->element_true_y_enu_metres);
+    bytes += mem_bytes(station->element_true_z_enu_metres);
+    bytes += mem_bytes(station->element_measured_x_enu_metres);
+    bytes += mem_bytes(station->element_measured_y_enu_metres);
+    bytes += mem_bytes(station->element_measured_z_enu_metres);
+    bytes += mem_bytes(station->element_gain);
+    bytes += mem_bytes(station->element_gain_error);
+    bytes += mem_bytes(station->element_phase_offset_rad);
+    bytes += mem_bytes(station->element_phase_error_rad);
+    bytes += mem_bytes(station->element_weight);
+    bytes += mem_bytes(station->element_types);
+    bytes += mem_bytes(station->element_types_cpu);
+    bytes += mem_bytes(station->element_mount_types_cpu);
+    bytes += mem_bytes(station->element_x_alpha_cpu);
+    bytes += mem_bytes(station->element_x_beta_cpu);
+    bytes += mem_bytes(station->element_x_gamma_cpu);
+    bytes += mem_bytes(station->element_y_alpha_cpu);
+    bytes += mem_bytes(station->element_y_beta_cpu);
+    bytes += mem_bytes(station->element_y_gamma_cpu);
+    bytes += mem_bytes(station->permitted_beam_az_rad);
+    bytes += mem_bytes(station->permitted_beam_el_rad);
+
+    /* Child stations or element models. */
+    if (station->child)
+    {
+        for (i = 0; i < station->num_elements; ++i)
+            bytes += oskar_station_memory_bytes(station->child[i]);
+    }
+    else if (station->element)
+    {
+        for (i = 0; i < station->num_element_types; ++i)
+            bytes += element_bytes(station->element[i]);
+    }
+    return bytes;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -56,6 +56,9 @@ oskar_StationWork* oskar_station_work_create(int type,
     work->enu_direction_x = oskar_mem_create(type, location, 0, status);
     work->enu_direction_y = oskar_mem_create(type, location, 0, status);
     work->enu_direction_z = oskar_mem_create(type, location, 0, status);
+    work->rotated_x = oskar_mem_create(type, location, 0, status);
+    work->rotated_y = oskar_mem_create(type, location, 0, status);
+    work->rotated_temp = oskar_mem_create(type, location, 0, status);
     work->weights = oskar_mem_create((type | OSKAR_COMPLEX),
             location, 0, status);
     work->weights_error = oskar_mem_create((type | OSKAR_COMPLEX),
@@ -65,6 +68,12 @@ oskar_StationWork* oskar_station_work_create(int type,
     work->normalised_beam = 0;
     work->num_depths = 0;
     work->beam = 0;
+    work->element_cache_enabled = 0;
+    work->element_cache_common_frame = 0;
+    work->element_cache_all_beams = 0;
+    work->element_cache_valid = 0;
+    work->element_cache = 0;
+    work->element_cache_model = 0;
 
     return work;
 }
@@ -81,10 +90,14 @@ void oskar_station_work_free(oskar_StationWork* work, int* status)
     oskar_mem_free(work->enu_direction_x, status);
     oskar_mem_free(work->enu_direction_y, status);
     oskar_mem_free(work->enu_direction_z, status);
+    oskar_mem_free(work->rotated_x, status);
+    oskar_mem_free(work->rotated_y, status);
+    oskar_mem_free(work->rotated_temp, status);
     oskar_mem_free(work->weights, status);
     oskar_mem_free(work->weights_error, status);
     oskar_mem_free(work->array_pattern, status);
     oskar_mem_free(work->normalised_beam, status);
+    oskar_mem_free(work->element_cache, status);
 
     for (i = 0; i < work->num_depths; ++i)
     {
@@ -147,6 +160,31 @@ oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
     return work->beam[depth];
 }
 
+void oskar_station_work_set_element_pattern_sharing(oskar_StationWork* work,
+        int enable, int common_frame)
+{
+    if (work->element_cache_all_beams) return;
+    work->element_cache_enabled = enable;
+    work->element_cache_common_frame = common_frame;
+    work->element_cache_valid = 0;
+}
+
+void oskar_station_work_set_element_pattern_sharing_between_beams(
+        oskar_StationWork* work, int enable, int common_frame)
+{
+    work->element_cache_all_beams = 0;
+    oskar_station_work_set_element_pattern_sharing(work, enable,
+            common_frame);
+    work->element_cache_all_beams = enable;
+}
+
+oskar_Mem* oskar_station_work_element_cache(oskar_StationWork* work,
+        const oskar_Mem* output_beam, size_t length, int* status)
+{
+    get_mem_from_template(&work->element_cache, output_beam, length, status);
+    return work->element_cache;
+}
+
 static void get_mem_from_template(oskar_Mem** b, const oskar_Mem* a,
         size_t length, int* status)
 {
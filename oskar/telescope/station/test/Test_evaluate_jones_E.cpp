@@ -34,6 +34,7 @@
 #include "math/oskar_meshgrid.h"
 #include "math/oskar_evaluate_image_lmn_grid.h"
 #include "interferometer/oskar_evaluate_jones_E.h"
+#include "telescope/station/oskar_evaluate_station_beam.h"
 #include "utility/oskar_get_error_string.h"
 
 #include "math/oskar_cmath.h"
@@ -168,3 +169,134 @@ TEST(evaluate_jones_E, evaluate_e)
     ASSERT_EQ(0, error) << oskar_get_error_string(error);
 }
 
+
+static oskar_Telescope* create_dipole_telescope(int num_stations,
+        int num_elements, double lat_offset_rad, int* status)
+{
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, num_stations, status);
+    srand(2);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        oskar_station_resize(s, num_elements, status);
+        oskar_station_resize_element_types(s, 1, status);
+        oskar_station_set_position(s, 0.0, 0.9 + i * lat_offset_rad, 0.0);
+        oskar_element_set_element_type(oskar_station_element(s, 0),
+                "Dipole", status);
+
+        // Each station has a different layout.
+        for (int j = 0; j < num_elements; ++j)
+        {
+            double enu[3];
+            enu[0] = 40.0 * (rand() / (double)RAND_MAX - 0.5);
+            enu[1] = 40.0 * (rand() / (double)RAND_MAX - 0.5);
+            enu[2] = 0.0;
+            oskar_station_set_element_coords(s, j, enu, enu, status);
+
+            // Rotate all the elements in the last station.
+            if (i == num_stations - 1)
+            {
+                oskar_station_set_element_feed_angle(s, 1, j,
+                        30.0, 0.0, 0.0, status);
+                oskar_station_set_element_feed_angle(s, 0, j,
+                        30.0, 0.0, 0.0, status);
+            }
+        }
+    }
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_phase_centre(tel,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.1, 0.8);
+    oskar_telescope_analyse(tel, status);
+    return tel;
+}
+
+static double max_diff_from_unshared_beams(double lat_offset_rad,
+        int allow_duplication, int* status);
+
+TEST(evaluate_jones_E, element_pattern_sharing)
+{
+    int status = 0;
+
+    // Stations at the same location: shared patterns must be identical.
+    EXPECT_EQ(0.0, max_diff_from_unshared_beams(0.0, 0, &status));
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0.0, max_diff_from_unshared_beams(0.0, 1, &status));
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Stations at different locations: patterns are only shared
+    // if beam duplication is allowed.
+    EXPECT_EQ(0.0, max_diff_from_unshared_beams(1e-4, 0, &status));
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    double diff = max_diff_from_unshared_beams(1e-4, 1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_GT(diff, 0.0);
+    EXPECT_LT(diff, 1e-2); // Beam peak is about 30.
+}
+
+static double max_diff_from_unshared_beams(double lat_offset_rad,
+        int allow_duplication, int* status)
+{
+    const int num_stations = 4, num_elements = 30, num_pts = 500;
+    const double frequency = 100e6, gast = 0.3;
+    double max_diff = 0.0;
+    oskar_Telescope* tel = create_dipole_telescope(num_stations,
+            num_elements, lat_offset_rad, status);
+    oskar_telescope_set_allow_station_beam_duplication(tel,
+            allow_duplication);
+
+    // Create source positions around the phase centre.
+    oskar_Mem* l = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_pts + 1,
+            status);
+    oskar_Mem* m = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_pts + 1,
+            status);
+    oskar_Mem* n = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_pts + 1,
+            status);
+    double *l_ = oskar_mem_double(l, status), *m_ = oskar_mem_double(m, status);
+    double *n_ = oskar_mem_double(n, status);
+    for (int i = 0; i < num_pts; ++i)
+    {
+        l_[i] = 0.6 * (rand() / (double)RAND_MAX - 0.5);
+        m_[i] = 0.6 * (rand() / (double)RAND_MAX - 0.5);
+        n_[i] = sqrt(1.0 - l_[i] * l_[i] - m_[i] * m_[i]);
+    }
+
+    // Evaluate Jones E, sharing element patterns between stations.
+    oskar_Jones* E = oskar_jones_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_CPU, num_stations, num_pts, status);
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, status);
+    oskar_evaluate_jones_E(E, num_pts, OSKAR_RELATIVE_DIRECTIONS,
+            l, m, n, tel, gast, frequency, work, 0, status);
+
+    // Compare against beams evaluated separately for each station.
+    oskar_Mem* beam = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_CPU, num_pts, status);
+    const double* e = oskar_mem_double_const(oskar_jones_mem_const(E),
+            status);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_StationWork* work_st = oskar_station_work_create(OSKAR_DOUBLE,
+                OSKAR_CPU, status);
+        oskar_evaluate_station_beam(beam, num_pts, OSKAR_RELATIVE_DIRECTIONS,
+                l, m, n, oskar_telescope_phase_centre_ra_rad(tel),
+                oskar_telescope_phase_centre_dec_rad(tel),
+                oskar_telescope_station_const(tel, i), work_st, 0,
+                frequency, gast, status);
+        oskar_station_work_free(work_st, status);
+        const double* b = oskar_mem_double_const(beam, status);
+        for (int j = 0; j < 8 * num_pts; ++j)
+        {
+            double diff = fabs(b[j] - e[8 * num_pts * i + j]);
+            if (diff > max_diff) max_diff = diff;
+        }
+    }
+    oskar_mem_free(beam, status);
+    oskar_mem_free(l, status);
+    oskar_mem_free(m, status);
+    oskar_mem_free(n, status);
+    oskar_jones_free(E, status);
+    oskar_station_work_free(work, status);
+    oskar_telescope_free(tel, status);
+    return max_diff;
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/element/oskar_element.h"
+#include "telescope/station/element/oskar_evaluate_spherical_wave_sum.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+TEST(evaluate_spherical_wave_sum, short_dipole)
+{
+    // A single TM mode (l = 1, m = 0) is the pattern of a short dipole
+    // along the z-axis: E_theta = -sqrt(3 / 8 pi) * sin(theta).
+    int status = 0, num_points = 100;
+    std::vector<double> theta(num_points), phi(num_points);
+    std::vector<double2> alpha(2 * 3), E(4 * num_points);
+    for (int i = 0; i < 2 * 3; ++i)
+        alpha[i].x = alpha[i].y = 0.0;
+    alpha[2 * 1 + 1].x = 1.0;
+    for (int i = 0; i < num_points; ++i)
+    {
+        theta[i] = M_PI * i / (num_points - 1);
+        phi[i] = 2.0 * M_PI * (i % 7) / 7.0;
+    }
+    oskar_evaluate_spherical_wave_sum_d(num_points, &theta[0], &phi[0], 1,
+            &alpha[0], 4, &E[0], &E[1], &status);
+    ASSERT_EQ(0, status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        EXPECT_NEAR(-sqrt(3.0 / (8.0 * M_PI)) * sin(theta[i]), E[4*i].x, 1e-12);
+        EXPECT_NEAR(0.0, E[4*i].y, 1e-12);
+        EXPECT_NEAR(0.0, E[4*i + 1].x, 1e-12);
+        EXPECT_NEAR(0.0, E[4*i + 1].y, 1e-12);
+    }
+}
+
+TEST(evaluate_spherical_wave_sum, orthonormality)
+{
+    // The modes are orthonormal, so the integral of the total power
+    // over the sphere must equal the sum of the squared coefficients.
+    int status = 0, l_max = 6, num_theta = 400, num_phi = 64;
+    int num_coeffs = l_max * (l_max + 2);
+    int num_points = num_theta * num_phi;
+    std::vector<double2> alpha(2 * num_coeffs);
+    std::vector<float2> alpha_f(2 * num_coeffs);
+    double sum_coeffs = 0.0;
+    srand(2);
+    for (int i = 0; i < 2 * num_coeffs; ++i)
+    {
+        alpha[i].x = 2.0 * rand() / (double)RAND_MAX - 1.0;
+        alpha[i].y = 2.0 * rand() / (double)RAND_MAX - 1.0;
+        alpha_f[i].x = (float) alpha[i].x;
+        alpha_f[i].y = (float) alpha[i].y;
+        sum_coeffs += alpha[i].x * alpha[i].x + alpha[i].y * alpha[i].y;
+    }
+    std::vector<double> theta(num_points), phi(num_points);
+    std::vector<float> theta_f(num_points), phi_f(num_points);
+    for (int t = 0, i = 0; t < num_theta; ++t)
+    {
+        for (int p = 0; p < num_phi; ++p, ++i)
+        {
+            theta[i] = M_PI * (t + 0.5) / num_theta;
+            phi[i] = 2.0 * M_PI * p / num_phi;
+            theta_f[i] = (float) theta[i];
+            phi_f[i] = (float) phi[i];
+        }
+    }
+    std::vector<double2> E(2 * num_points);
+    std::vector<float2> E_f(2 * num_points);
+    oskar_evaluate_spherical_wave_sum_d(num_points, &theta[0], &phi[0],
+            l_max, &alpha[0], 2, &E[0], &E[1], &status);
+    oskar_evaluate_spherical_wave_sum_f(num_points, &theta_f[0], &phi_f[0],
+            l_max, &alpha_f[0], 2, &E_f[0], &E_f[1], &status);
+    ASSERT_EQ(0, status);
+    double sum_power = 0.0, max_diff = 0.0;
+    double d_omega = (M_PI / num_theta) * (2.0 * M_PI / num_phi);
+    for (int i = 0; i < num_points; ++i)
+    {
+        const double2 e_t = E[2*i], e_p = E[2*i + 1];
+        sum_power += (e_t.x * e_t.x + e_t.y * e_t.y +
+                e_p.x * e_p.x + e_p.y * e_p.y) * sin(theta[i]) * d_omega;
+        double diff = fabs(e_t.x - E_f[2*i].x);
+        if (diff > max_diff) max_diff = diff;
+        diff = fabs(e_p.y - E_f[2*i + 1].y);
+        if (diff > max_diff) max_diff = diff;
+    }
+    EXPECT_NEAR(1.0, sum_power / sum_coeffs, 1e-4);
+    EXPECT_LT(max_diff, 1e-4);
+}
+
+TEST(evaluate_spherical_wave_sum, load)
+{
+    int status = 0;
+    const char* filename = "temp_test_spherical_wave_coeffs.txt";
+    FILE* file = fopen(filename, "w");
+    ASSERT_TRUE(file != NULL);
+    fprintf(file, "# l, m, TE re, TE im, TM re, TM im\n");
+    fprintf(file, "1, 0, 0.0, 0.0, 1.0, 0.0\n");
+    fprintf(file, "2, -1, 0.5, 0.25\n");
+    fclose(file);
+
+    // Load the coefficients for the X dipole.
+    oskar_Element* element = oskar_element_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_element_load_spherical_wave(element, filename, 1, 100e6, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_TRUE(oskar_element_has_x_spherical_wave_data(element));
+    EXPECT_FALSE(oskar_element_has_y_spherical_wave_data(element));
+    EXPECT_EQ(1, oskar_element_num_freq(element));
+
+    // Check the coefficients are stored in the right places.
+    const oskar_Mem* c = oskar_element_x_spherical_wave_const(element, 0);
+    ASSERT_EQ(2 * 2 * (2 + 2), (int) oskar_mem_length(c));
+    const double2* c_ = oskar_mem_double2_const(c, &status);
+    EXPECT_DOUBLE_EQ(1.0, c_[2 * 1 + 1].x);
+    EXPECT_DOUBLE_EQ(0.5, c_[2 * 4].x);
+    EXPECT_DOUBLE_EQ(0.25, c_[2 * 4].y);
+    EXPECT_DOUBLE_EQ(0.0, c_[2 * 4 + 1].x);
+
+    // Check that copies compare as identical.
+    oskar_Element* copy = oskar_element_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_element_copy(copy, element, &status);
+    EXPECT_FALSE(oskar_element_different(element, copy, &status));
+    oskar_element_free(copy, &status);
+
+    // Check that invalid mode indices are rejected.
+    file = fopen(filename, "w");
+    ASSERT_TRUE(file != NULL);
+    fprintf(file, "1, 2, 1.0, 0.0, 0.0, 0.0\n");
+    fclose(file);
+    oskar_element_load_spherical_wave(element, filename, 2, 100e6, &status);
+    EXPECT_EQ((int) OSKAR_ERR_INVALID_ARGUMENT, status);
+    oskar_element_free(element, &status);
+    remove(filename);
+}
+
+TEST(evaluate_spherical_wave_sum, closest_frequency_with_coeffs)
+{
+    int status = 0, num_points = 10;
+    const char* filename = "temp_test_spherical_wave_coeffs_freq.txt";
+    FILE* file = fopen(filename, "w");
+    ASSERT_TRUE(file != NULL);
+    fprintf(file, "1, 0, 0.0, 0.0, 1.0, 0.0\n");
+    fclose(file);
+
+    // Load the X dipole at one frequency and the Y dipole at another,
+    // so neither has coefficients at every frequency.
+    oskar_Element* element = oskar_element_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    oskar_element_load_spherical_wave(element, filename, 1, 100e6, &status);
+    oskar_element_load_spherical_wave(element, filename, 2, 200e6, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(2, oskar_element_num_freq(element));
+
+    // Evaluate near the frequency of the Y dipole: both dipoles must
+    // still use their own (closest available) coefficients.
+    oskar_Mem *x, *y, *z, *theta, *phi, *pattern;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, &status);
+    theta = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    phi = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    pattern = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+            num_points, &status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        const double a = 0.1 * (i + 1);
+        oskar_mem_double(x, &status)[i] = sin(a) * 0.6;
+        oskar_mem_double(y, &status)[i] = sin(a) * 0.8;
+        oskar_mem_double(z, &status)[i] = cos(a);
+    }
+    oskar_element_evaluate(element, pattern, M_PI / 2.0, 0.0, num_points,
+            x, y, z, 190e6, theta, phi, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double2* p = oskar_mem_double2_const(pattern, &status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        EXPECT_GT(fabs(p[4*i].x), 1e-3);
+        EXPECT_GT(fabs(p[4*i + 2].x), 1e-3);
+    }
+
+    // Check that an empty coefficient array is rejected.
+    oskar_Mem* alpha = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, 0,
+            &status);
+    oskar_evaluate_spherical_wave_sum(pattern, num_points, theta, phi,
+            alpha, 0, 4, &status);
+    EXPECT_EQ((int) OSKAR_ERR_DIMENSION_MISMATCH, status);
+    status = 0;
+
+    oskar_mem_free(alpha, &status);
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    oskar_mem_free(theta, &status);
+    oskar_mem_free(phi, &status);
+    oskar_mem_free(pattern, &status);
+    oskar_element_free(element, &status);
+    remove(filename);
+}
@@ -33,6 +33,7 @@
 #include "telescope/station/oskar_evaluate_station_beam_gaussian.h"
 #include "telescope/station/oskar_evaluate_beam_horizon_direction.h"
 #include "utility/oskar_get_error_string.h"
+#include "math/oskar_dftw_nufft.h"
 #include "math/oskar_linspace.h"
 #include "math/oskar_meshgrid.h"
 #include "binary/oskar_binary.h"
@@ -158,6 +159,96 @@ TEST(evaluate_station_beam, test_array_pattern)
 }
 
 
+TEST(evaluate_station_beam, rotated_station)
+{
+    int error = 0, num_elements = 6, size = 21, num_pixels = size * size;
+    double gast = 0.0, frequency = 100e6, rotation_rad = 0.7;
+    double ex[] = {0.0, 3.0, -1.5, 7.0, 2.0, -4.0};
+    double ey[] = {0.0, 1.0, 5.5, -2.0, 8.0, -3.0};
+
+    // Create a template station with an asymmetric layout, and a
+    // copy of it rotated by moving the element coordinates.
+    oskar_Station* tmpl = oskar_station_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_elements, &error);
+    oskar_Station* moved = oskar_station_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_elements, &error);
+    oskar_Station* stations[] = {tmpl, moved};
+    for (int s = 0; s < 2; ++s)
+    {
+        oskar_station_resize_element_types(stations[s], 1, &error);
+        oskar_element_set_element_type(oskar_station_element(stations[s], 0),
+                "Isotropic", &error);
+        oskar_station_set_position(stations[s], 0.0, 0.9, 0.0);
+        oskar_station_set_phase_centre(stations[s],
+                OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.3, 0.6);
+    }
+    for (int i = 0; i < num_elements; ++i)
+    {
+        double c = cos(rotation_rad), t = sin(rotation_rad);
+        double xyz[] = {ex[i], ey[i], 0.0};
+        oskar_station_set_element_coords(tmpl, i, xyz, xyz, &error);
+        xyz[0] = ex[i] * c - ey[i] * t;
+        xyz[1] = ex[i] * t + ey[i] * c;
+        oskar_station_set_element_coords(moved, i, xyz, xyz, &error);
+    }
+
+    // Create a rotated station that keeps the template layout.
+    oskar_Station* rotated = oskar_station_create_copy(tmpl, OSKAR_CPU,
+            &error);
+    oskar_station_apply_transform(rotated, rotation_rad, 1.0, 0.0, 0.0, 0.0,
+            1, 0, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+    EXPECT_DOUBLE_EQ(rotation_rad, oskar_station_rotation_rad(rotated));
+    EXPECT_EQ(1, oskar_station_different(tmpl, rotated, &error));
+
+    // Generate direction cosines above the horizon.
+    oskar_Mem *x, *y, *z, *beam1, *beam2;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_pixels, &error);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_pixels, &error);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_pixels, &error);
+    double *x_ = oskar_mem_double(x, &error);
+    double *y_ = oskar_mem_double(y, &error);
+    double *z_ = oskar_mem_double(z, &error);
+    for (int i = 0; i < num_pixels; ++i)
+    {
+        x_[i] = 1.2 * ((i % size) / (double)(size - 1) - 0.5);
+        y_[i] = 1.2 * ((i / size) / (double)(size - 1) - 0.5);
+        z_[i] = sqrt(1.0 - x_[i] * x_[i] - y_[i] * y_[i]);
+    }
+
+    // Check the beams are the same.
+    beam1 = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, num_pixels,
+            &error);
+    beam2 = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU, num_pixels,
+            &error);
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &error);
+    oskar_evaluate_station_beam_aperture_array(beam1, moved,
+            num_pixels, x, y, z, gast, frequency, work, 0, &error);
+    oskar_evaluate_station_beam_aperture_array(beam2, rotated,
+            num_pixels, x, y, z, gast, frequency, work, 0, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+    const double *b1 = oskar_mem_double_const(beam1, &error);
+    const double *b2 = oskar_mem_double_const(beam2, &error);
+    for (int i = 0; i < 2 * num_pixels; ++i)
+        EXPECT_NEAR(b1[i], b2[i], 1e-10);
+
+    // Check the input direction cosines were not modified.
+    EXPECT_DOUBLE_EQ(1.2 * (1.0 / (size - 1) - 0.5), x_[1]);
+
+    oskar_station_work_free(work, &error);
+    oskar_mem_free(x, &error);
+    oskar_mem_free(y, &error);
+    oskar_mem_free(z, &error);
+    oskar_mem_free(beam1, &error);
+    oskar_mem_free(beam2, &error);
+    oskar_station_free(tmpl, &error);
+    oskar_station_free(moved, &error);
+    oskar_station_free(rotated, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
+
+
 TEST(evaluate_station_beam, gaussian)
 {
     int error = 0;
@@ -315,3 +406,80 @@ TEST(evaluate_station_beam, gaussian)
         oskar_mem_free(beam, &error);
     }
 }
+
+TEST(evaluate_station_beam, nufft_array_pattern)
+{
+    int error = 0, num_elements = 1000, size = 150, num_pixels = size * size;
+    double gast = 0.0, frequency = 100e6;
+
+    // Create a large station with randomly placed dipoles.
+    oskar_Station* station = oskar_station_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_elements, &error);
+    oskar_station_resize_element_types(station, 1, &error);
+    oskar_element_set_element_type(oskar_station_element(station, 0),
+            "Dipole", &error);
+    oskar_station_set_position(station, 0.0, 0.9, 0.0);
+    oskar_station_set_phase_centre(station,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.3, 0.6);
+    srand(3);
+    for (int i = 0; i < num_elements; ++i)
+    {
+        double xyz[3];
+        xyz[0] = 40.0 * (rand() / (double)RAND_MAX - 0.5);
+        xyz[1] = 40.0 * (rand() / (double)RAND_MAX - 0.5);
+        xyz[2] = 0.0;
+        oskar_station_set_element_coords(station, i, xyz, xyz, &error);
+    }
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // Generate direction cosines above the horizon.
+    oskar_Mem *x, *y, *z, *beam1, *beam2;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_pixels, &error);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_pixels, &error);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_pixels, &error);
+    double *x_ = oskar_mem_double(x, &error);
+    double *y_ = oskar_mem_double(y, &error);
+    double *z_ = oskar_mem_double(z, &error);
+    for (int i = 0; i < num_pixels; ++i)
+    {
+        x_[i] = 1.4 * ((i % size) / (double)(size - 1) - 0.5);
+        y_[i] = 1.4 * ((i / size) / (double)(size - 1) - 0.5);
+        z_[i] = sqrt(1.0 - x_[i] * x_[i] - y_[i] * y_[i]);
+    }
+
+    // Check the non-uniform FFT is expected to be faster here.
+    EXPECT_LT(oskar_dftw_nufft_cost(num_elements,
+            2.0 * M_PI * frequency / 299792458.0,
+            oskar_station_element_true_x_enu_metres_const(station),
+            oskar_station_element_true_y_enu_metres_const(station), 0,
+            num_pixels, x, y, 0, 1e-8, &error), 1.0);
+
+    // Evaluate the beam directly, and using the non-uniform FFT.
+    beam1 = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+            num_pixels, &error);
+    beam2 = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+            num_pixels, &error);
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &error);
+    oskar_evaluate_station_beam_aperture_array(beam1, station,
+            num_pixels, x, y, z, gast, frequency, work, 0, &error);
+    oskar_station_set_array_pattern_nufft_tolerance(station, 1e-8);
+    oskar_evaluate_station_beam_aperture_array(beam2, station,
+            num_pixels, x, y, z, gast, frequency, work, 0, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+    const double *b1 = oskar_mem_double_const(beam1, &error);
+    const double *b2 = oskar_mem_double_const(beam2, &error);
+    double max_err = 0.0;
+    for (int i = 0; i < 8 * num_pixels; ++i)
+        if (fabs(b1[i] - b2[i]) > max_err) max_err = fabs(b1[i] - b2[i]);
+    EXPECT_LT(max_err / num_elements, 1e-7);
+
+    oskar_station_work_free(work, &error);
+    oskar_mem_free(x, &error);
+    oskar_mem_free(y, &error);
+    oskar_mem_free(z, &error);
+    oskar_mem_free(beam1, &error);
+    oskar_mem_free(beam2, &error);
+    oskar_station_free(station, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2018, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_get_error_string.h"
+
+TEST(telescope_create_subset, selected_stations)
+{
+    int status = 0;
+    const int num_stations = 10;
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_stations, &status);
+    double* x = oskar_mem_double(
+            oskar_telescope_station_true_x_offset_ecef_metres(tel), &status);
+    double* y = oskar_mem_double(
+            oskar_telescope_station_measured_y_enu_metres(tel), &status);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        x[i] = 10.0 * i;
+        y[i] = -5.0 * i;
+        oskar_station_resize(oskar_telescope_station(tel, i), i + 1, &status);
+    }
+    oskar_telescope_set_phase_centre(tel, OSKAR_SPHERICAL_TYPE_EQUATORIAL,
+            0.5, -0.5);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Select stations out of order.
+    const int ids[] = {7, 2, 5};
+    oskar_Telescope* sub = oskar_telescope_create_subset(tel, 3, ids,
+            OSKAR_CPU, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(3, oskar_telescope_num_stations(sub));
+    EXPECT_EQ(3, oskar_telescope_num_baselines(sub));
+    EXPECT_DOUBLE_EQ(0.5, oskar_telescope_phase_centre_ra_rad(sub));
+    const double* x_sub = oskar_mem_double_const(
+            oskar_telescope_station_true_x_offset_ecef_metres_const(sub),
+            &status);
+    const double* y_sub = oskar_mem_double_const(
+            oskar_telescope_station_measured_y_enu_metres_const(sub),
+            &status);
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_DOUBLE_EQ(10.0 * ids[i], x_sub[i]);
+        EXPECT_DOUBLE_EQ(-5.0 * ids[i], y_sub[i]);
+        EXPECT_EQ(ids[i] + 1, oskar_station_num_elements(
+                oskar_telescope_station_const(sub, i)));
+    }
+    oskar_telescope_free(sub, &status);
+
+    // Check that invalid and repeated indices are rejected.
+    const int bad[] = {1, 1};
+    sub = oskar_telescope_create_subset(tel, 2, bad, OSKAR_CPU, &status);
+    EXPECT_EQ((int)OSKAR_ERR_INVALID_ARGUMENT, status);
+    EXPECT_TRUE(sub == 0);
+    status = 0;
+    const int out_of_range[] = {num_stations};
+    sub = oskar_telescope_create_subset(tel, 1, out_of_range, OSKAR_CPU,
+            &status);
+    EXPECT_EQ((int)OSKAR_ERR_INVALID_ARGUMENT, status);
+    status = 0;
+    oskar_telescope_free(tel, &status);
+}
@@ -32,6 +32,7 @@
 #include "utility/oskar_get_error_string.h"
 #include "mem/oskar_mem.h"
 #include "telescope/oskar_telescope.h"
+#include "math/oskar_cmath.h"
 
 #include <cstdio>
 #include <cstdlib>
@@ -536,6 +537,109 @@ TEST(telescope_model_load_save, test_load_telescope_noise_rms)
 }
 
 
+TEST(telescope_model_load_save, test_station_transforms)
+{
+    int err = 0;
+    FILE* f;
+    char *path, *station_dir;
+    const char* tm = "temp_test_telescope_station_transforms";
+    const char* templates[] = {"template_a", "template_b"};
+    const int num_elements[] = {3, 2};
+
+    // Create a telescope model directory with four stations.
+    if (oskar_dir_exists(tm)) oskar_dir_remove(tm);
+    oskar_dir_mkpath(tm);
+    path = oskar_dir_get_path(tm, "position.txt");
+    f = fopen(path, "w");
+    fprintf(f, "0,0\n");
+    fclose(f);
+    free(path);
+    path = oskar_dir_get_path(tm, "layout.txt");
+    f = fopen(path, "w");
+    for (int i = 0; i < 4; ++i) fprintf(f, "%d,0\n", 100 * i);
+    fclose(f);
+    free(path);
+
+    // Write two station templates.
+    for (int t = 0; t < 2; ++t)
+    {
+        station_dir = oskar_dir_get_path(tm, templates[t]);
+        oskar_dir_mkpath(station_dir);
+        path = oskar_dir_get_path(station_dir, "layout.txt");
+        f = fopen(path, "w");
+        for (int i = 0; i < num_elements[t]; ++i)
+            fprintf(f, "%d,%d\n", i + 1, 2 * i);
+        fclose(f);
+        free(path);
+        free(station_dir);
+    }
+
+    // Write the table of station transforms.
+    path = oskar_dir_get_path(tm, "station_transforms.txt");
+    f = fopen(path, "w");
+    fprintf(f, "0\n");
+    fprintf(f, "0, 90\n");
+    fprintf(f, "1, 0, 2.0, 1.0, -1.0\n");
+    fprintf(f, "0, 90\n");
+    fclose(f);
+    free(path);
+
+    // Load the telescope model.
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, 0, &err);
+    oskar_telescope_set_enable_numerical_patterns(tel, 0);
+    oskar_telescope_load(tel, tm, NULL, &err);
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    ASSERT_EQ(4, oskar_telescope_num_stations(tel));
+
+    // Check the stations.
+    const oskar_Station *s0, *s1, *s2, *s3;
+    s0 = oskar_telescope_station_const(tel, 0);
+    s1 = oskar_telescope_station_const(tel, 1);
+    s2 = oskar_telescope_station_const(tel, 2);
+    s3 = oskar_telescope_station_const(tel, 3);
+    EXPECT_EQ(3, oskar_station_num_elements(s0));
+    EXPECT_EQ(3, oskar_station_num_elements(s1));
+    EXPECT_EQ(2, oskar_station_num_elements(s2));
+    EXPECT_DOUBLE_EQ(0.0, oskar_station_rotation_rad(s0));
+    EXPECT_DOUBLE_EQ(M_PI / 2.0, oskar_station_rotation_rad(s1));
+    EXPECT_EQ(1, oskar_station_different(s0, s1, &err));
+    EXPECT_EQ(0, oskar_station_different(s1, s3, &err));
+    EXPECT_NE(oskar_station_lon_rad(s1), oskar_station_lon_rad(s3));
+
+    // Layout of station 1 is unrotated.
+    const double* x = oskar_mem_double_const(
+            oskar_station_element_true_x_enu_metres_const(s1), &err);
+    const double* y = oskar_mem_double_const(
+            oskar_station_element_true_y_enu_metres_const(s1), &err);
+    EXPECT_DOUBLE_EQ(2.0, x[1]);
+    EXPECT_DOUBLE_EQ(2.0, y[1]);
+
+    // Layout of station 2 is scaled, then offset.
+    x = oskar_mem_double_const(
+            oskar_station_element_measured_x_enu_metres_const(s2), &err);
+    y = oskar_mem_double_const(
+            oskar_station_element_measured_y_enu_metres_const(s2), &err);
+    EXPECT_DOUBLE_EQ(5.0, x[1]);
+    EXPECT_DOUBLE_EQ(3.0, y[1]);
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    oskar_telescope_free(tel, &err);
+
+    // Check that an out-of-range template index is an error.
+    path = oskar_dir_get_path(tm, "station_transforms.txt");
+    f = fopen(path, "w");
+    for (int i = 0; i < 4; ++i) fprintf(f, "%d\n", i);
+    fclose(f);
+    free(path);
+    tel = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &err);
+    oskar_telescope_load(tel, tm, NULL, &err);
+    EXPECT_EQ((int) OSKAR_ERR_OUT_OF_RANGE, err);
+    err = 0;
+    oskar_telescope_free(tel, &err);
+    oskar_dir_remove(tm);
+}
+
+
 static void generate_noisy_telescope(const char* dir, int num_stations,
         const vector<double>& freqs, const vector<double>& noise)
 {
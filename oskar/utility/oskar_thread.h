@@ -42,9 +42,11 @@ extern "C" {
 struct oskar_Mutex;
 struct oskar_Thread;
 struct oskar_Barrier;
+struct oskar_ThreadPool;
 typedef struct oskar_Mutex oskar_Mutex;
 typedef struct oskar_Thread oskar_Thread;
 typedef struct oskar_Barrier oskar_Barrier;
+typedef struct oskar_ThreadPool oskar_ThreadPool;
 
 /**
  * @brief Creates a mutex.
@@ -163,6 +165,101 @@ void oskar_barrier_set_num_threads(oskar_Barrier* barrier, int num_threads);
 OSKAR_EXPORT
 int oskar_barrier_wait(oskar_Barrier* barrier);
 
+/**
+ * @brief Creates a pool of persistent worker threads.
+ *
+ * @details
+ * Creates a pool of worker threads, which are started immediately and
+ * remain idle until tasks are submitted to the pool using
+ * oskar_thread_pool_submit().
+ *
+ * Tasks are started in the order in which they were submitted.
+ * If tasks submitted together must synchronise with each other
+ * (for example, using a barrier), then the pool must contain at least
+ * as many threads as there are tasks.
+ *
+ * The task queue initially has space for at least two tasks per thread.
+ * Returns a null pointer if the pool could not be allocated.
+ *
+ * @param[in] num_threads Number of worker threads in the pool.
+ */
+OSKAR_EXPORT
+oskar_ThreadPool* oskar_thread_pool_create(int num_threads);
+
+/**
+ * @brief Destroys the thread pool.
+ *
+ * @details
+ * Waits for all outstanding tasks to finish, then stops and joins
+ * all worker threads in the pool before releasing its resources.
+ *
+ * @param[in,out] pool Pointer to thread pool.
+ */
+OSKAR_EXPORT
+void oskar_thread_pool_free(oskar_ThreadPool* pool);
+
+/**
+ * @brief Returns the number of worker threads in the pool.
+ *
+ * @details
+ * Returns the number of worker threads in the pool.
+ *
+ * @param[in] pool Pointer to thread pool.
+ */
+OSKAR_EXPORT
+int oskar_thread_pool_num_threads(const oskar_ThreadPool* pool);
+
+/**
+ * @brief Binds the worker threads in the pool to the given CPUs.
+ *
+ * @details
+ * Sets the CPU affinity of the worker threads in the pool.
+ * Worker thread \p i is bound to CPU \p cpu_ids[i % num_cpus].
+ * If \p num_cpus is zero, the affinity of all worker threads is reset
+ * so that they may run on any CPU.
+ *
+ * This is only supported on Linux and Windows:
+ * the function returns 0 on success, or 1 if the affinity could not be set.
+ *
+ * @param[in,out] pool    Pointer to thread pool.
+ * @param[in]     num_cpus Number of CPU IDs in the list.
+ * @param[in]     cpu_ids  List of CPU IDs to use.
+ */
+OSKAR_EXPORT
+int oskar_thread_pool_set_affinity(oskar_ThreadPool* pool, int num_cpus,
+        const int* cpu_ids);
+
+/**
+ * @brief Submits a task to the thread pool.
+ *
+ * @details
+ * Adds a task to the queue of the thread pool. The task function
+ * \p start_routine will be called with \p arg by the next idle
+ * worker thread. The return value of the task function is ignored.
+ *
+ * The function returns 0 on success, or 1 if the task could not be added
+ * (if the pool is null, or the queue could not be enlarged).
+ *
+ * @param[in,out] pool          Pointer to thread pool.
+ * @param[in]     start_routine Task function.
+ * @param[in]     arg           Argument to pass to the task function.
+ */
+OSKAR_EXPORT
+int oskar_thread_pool_submit(oskar_ThreadPool* pool,
+        void *(*start_routine)(void*), void* arg);
+
+/**
+ * @brief Waits for all submitted tasks to finish.
+ *
+ * @details
+ * Blocks the caller until all tasks submitted to the pool have finished.
+ * The worker threads remain available for further tasks.
+ *
+ * @param[in,out] pool Pointer to thread pool.
+ */
+OSKAR_EXPORT
+void oskar_thread_pool_wait(oskar_ThreadPool* pool);
+
 #ifdef __cplusplus
 }
 #endif
@@ -394,6 +394,14 @@ void oskar_scan_binary_file(oskar_Log* log, const char* filename, int* status)
                 {
                     oskar_log_message(log, p, depth, "Rotation measure values");
                 }
+                else if (tag == OSKAR_SKY_TAG_SPECTRAL_FREQ)
+                {
+                    oskar_log_message(log, p, depth, "Spectral channel frequencies");
+                }
+                else if (tag == OSKAR_SKY_TAG_SPECTRAL_STOKES_I)
+                {
+                    oskar_log_message(log, p, depth, "Tabulated Stokes I spectra");
+                }
                 else if (tag == OSKAR_SKY_TAG_FWHM_MAJOR)
                 {
                     oskar_log_message(log, p, depth, "Gaussian FWHM (major) values");
@@ -26,8 +26,13 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* Required for pthread_setaffinity_np(). */
+#endif
+
 #include "utility/oskar_thread.h"
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef OSKAR_OS_WIN
 #define WIN32_LEAN_AND_MEAN
@@ -35,6 +40,9 @@
 #include <process.h>
 #else
 #include <pthread.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
 #endif
 
 
@@ -302,6 +310,195 @@ int oskar_barrier_wait(oskar_Barrier* barrier)
     return 0;
 }
 
+
+/* =========================================================================
+ *  THREAD POOL
+ * =========================================================================*/
+
+struct oskar_ThreadTask
+{
+    void *(*start_routine)(void*);
+    void *arg;
+};
+typedef struct oskar_ThreadTask oskar_ThreadTask;
+
+struct oskar_ThreadPool
+{
+    oskar_ConditionVar var;
+    oskar_Thread** threads;
+    oskar_ThreadTask* tasks;
+    int num_threads, capacity, head, tail, num_busy, finished;
+};
+
+static void* thread_pool_worker(void* arg)
+{
+    oskar_ThreadPool* pool = (oskar_ThreadPool*) arg;
+    oskar_condition_lock(&pool->var);
+    for (;;)
+    {
+        oskar_ThreadTask task;
+
+        /* Release lock and block this thread until there is work to do. */
+        while (pool->head == pool->tail && !pool->finished)
+            oskar_condition_wait(&pool->var);
+        if (pool->head == pool->tail) break;
+
+        /* Take the next task from the front of the queue. */
+        task = pool->tasks[pool->head++];
+        if (pool->head == pool->tail)
+            pool->head = pool->tail = 0;
+        pool->num_busy++;
+
+        /* Run the task without holding the lock. */
+        oskar_condition_unlock(&pool->var);
+        task.start_routine(task.arg);
+        oskar_condition_lock(&pool->var);
+
+        /* Wake up anything waiting for the pool to become idle. */
+        pool->num_busy--;
+        if (pool->head == pool->tail && pool->num_busy == 0)
+            oskar_condition_notify_all(&pool->var);
+    }
+    oskar_condition_unlock(&pool->var);
+    return 0;
+}
+
+oskar_ThreadPool* oskar_thread_pool_create(int num_threads)
+{
+    int i;
+    oskar_ThreadPool* pool;
+    pool = (oskar_ThreadPool*) calloc(1, sizeof(oskar_ThreadPool));
+    if (!pool) return 0;
+    if (num_threads < 1) num_threads = 1;
+
+    /* Reserve space in the queue for two tasks per thread, so that
+     * submitting one task for each thread never needs to enlarge it. */
+    pool->capacity = (2 * num_threads > 16) ? 2 * num_threads : 16;
+    pool->tasks = (oskar_ThreadTask*) calloc(pool->capacity,
+            sizeof(oskar_ThreadTask));
+    pool->threads = (oskar_Thread**) calloc(num_threads,
+            sizeof(oskar_Thread*));
+    if (!pool->tasks || !pool->threads)
+    {
+        free(pool->tasks);
+        free(pool->threads);
+        free(pool);
+        return 0;
+    }
+    oskar_condition_init(&pool->var);
+    pool->num_threads = num_threads;
+    for (i = 0; i < num_threads; ++i)
+        pool->threads[i] = oskar_thread_create(thread_pool_worker,
+                (void*)pool, 0);
+    return pool;
+}
+
+void oskar_thread_pool_free(oskar_ThreadPool* pool)
+{
+    int i;
+    if (!pool) return;
+
+    /* Tell the worker threads to exit once the queue is empty. */
+    oskar_condition_lock(&pool->var);
+    pool->finished = 1;
+    oskar_condition_notify_all(&pool->var);
+    oskar_condition_unlock(&pool->var);
+    for (i = 0; i < pool->num_threads; ++i)
+    {
+        oskar_thread_join(pool->threads[i]);
+        oskar_thread_free(pool->threads[i]);
+    }
+    oskar_condition_uninit(&pool->var);
+    free(pool->threads);
+    free(pool->tasks);
+    free(pool);
+}
+
+int oskar_thread_pool_num_threads(const oskar_ThreadPool* pool)
+{
+    return pool ? pool->num_threads : 0;
+}
+
+int oskar_thread_pool_set_affinity(oskar_ThreadPool* pool, int num_cpus,
+        const int* cpu_ids)
+{
+    int i, error = 0;
+    if (!pool) return 1;
+    for (i = 0; i < pool->num_threads; ++i)
+    {
+#if defined(OSKAR_OS_WIN)
+        DWORD_PTR mask = (DWORD_PTR)(-1);
+        if (num_cpus > 0)
+            mask = ((DWORD_PTR)1) << cpu_ids[i % num_cpus];
+        if (!SetThreadAffinityMask(pool->threads[i]->thread, mask))
+            error = 1;
+#elif defined(__linux__)
+        int j;
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        if (num_cpus > 0)
+            CPU_SET(cpu_ids[i % num_cpus], &cpu_set);
+        else
+            for (j = 0; j < CPU_SETSIZE; ++j) CPU_SET(j, &cpu_set);
+        if (pthread_setaffinity_np(pool->threads[i]->thread,
+                sizeof(cpu_set_t), &cpu_set))
+            error = 1;
+#else
+        (void) num_cpus;
+        (void) cpu_ids;
+        error = 1;
+#endif
+    }
+    return error;
+}
+
+int oskar_thread_pool_submit(oskar_ThreadPool* pool,
+        void *(*start_routine)(void*), void* arg)
+{
+    if (!pool) return 1;
+    oskar_condition_lock(&pool->var);
+
+    /* Make space at the end of the queue if required. */
+    if (pool->tail == pool->capacity)
+    {
+        if (pool->head > 0)
+        {
+            memmove(pool->tasks, pool->tasks + pool->head,
+                    (pool->tail - pool->head) * sizeof(oskar_ThreadTask));
+            pool->tail -= pool->head;
+            pool->head = 0;
+        }
+        else
+        {
+            oskar_ThreadTask* t = (oskar_ThreadTask*) realloc(pool->tasks,
+                    2 * pool->capacity * sizeof(oskar_ThreadTask));
+            if (!t)
+            {
+                oskar_condition_unlock(&pool->var);
+                return 1;
+            }
+            pool->tasks = t;
+            pool->capacity *= 2;
+        }
+    }
+
+    /* Add the task and wake up the worker threads. */
+    pool->tasks[pool->tail].start_routine = start_routine;
+    pool->tasks[pool->tail].arg = arg;
+    pool->tail++;
+    oskar_condition_notify_all(&pool->var);
+    oskar_condition_unlock(&pool->var);
+    return 0;
+}
+
+void oskar_thread_pool_wait(oskar_ThreadPool* pool)
+{
+    oskar_condition_lock(&pool->var);
+    while (pool->head != pool->tail || pool->num_busy > 0)
+        oskar_condition_wait(&pool->var);
+    oskar_condition_unlock(&pool->var);
+}
+
 #ifdef __cplusplus
 }
 #endif
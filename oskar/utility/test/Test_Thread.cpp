@@ -124,3 +124,72 @@ TEST(thread, barriers)
     free(args);
     free(threads);
 }
+
+void* thread_pool_task(void* arg)
+{
+    int* value = (int*) arg;
+    (*value)++;
+    return 0;
+}
+
+TEST(thread, pool_submit_and_wait)
+{
+    const int num_tasks = 1000;
+    int* values = (int*) calloc((size_t) num_tasks, sizeof(int));
+
+    // Create the pool.
+    oskar_ThreadPool* pool = oskar_thread_pool_create(oskar_get_num_procs());
+    ASSERT_EQ(oskar_get_num_procs(), oskar_thread_pool_num_threads(pool));
+
+    // Re-use the same worker threads for several batches of tasks.
+    for (int iter = 0; iter < 3; ++iter)
+    {
+        for (int i = 0; i < num_tasks; ++i)
+            ASSERT_EQ(0, oskar_thread_pool_submit(pool, thread_pool_task,
+                    &values[i]));
+        oskar_thread_pool_wait(pool);
+        for (int i = 0; i < num_tasks; ++i)
+            ASSERT_EQ(iter + 1, values[i]);
+    }
+
+    // Clean up.
+    oskar_thread_pool_free(pool);
+    free(values);
+
+    // Submitting to a null pool must fail.
+    EXPECT_NE(0, oskar_thread_pool_submit(0, thread_pool_task, 0));
+}
+
+TEST(thread, pool_barriers)
+{
+    // Set the number of threads.
+    int num_threads = 8;
+
+    // Create the pool and the shared barrier.
+    oskar_ThreadPool* pool = oskar_thread_pool_create(num_threads);
+    oskar_Barrier* barrier = oskar_barrier_create(num_threads);
+#ifdef __linux__
+    int cpu_id = 0;
+    EXPECT_EQ(0, oskar_thread_pool_set_affinity(pool, 1, &cpu_id));
+    EXPECT_EQ(0, oskar_thread_pool_set_affinity(pool, 0, 0));
+#endif
+
+    // Submit a task for each thread, twice.
+    ThreadArgs* args = (ThreadArgs*)
+            calloc((size_t) num_threads, sizeof(ThreadArgs));
+    for (int iter = 0; iter < 2; ++iter)
+    {
+        for (int i = 0; i < num_threads; ++i)
+        {
+            args[i].barrier = barrier;
+            args[i].thread_id = (int) i;
+            oskar_thread_pool_submit(pool, thread_barriers, (void*)(&args[i]));
+        }
+        oskar_thread_pool_wait(pool);
+    }
+
+    // Clean up.
+    oskar_thread_pool_free(pool);
+    oskar_barrier_free(barrier);
+    free(args);
+}